@@ -163,6 +163,9 @@ macro(write_configtable)
   string(APPEND out "LibXml2 support               : ")
   check_on_or_off("ON" "LIBXML2_FOUND")
 
+  string(APPEND out "zlib compressed pcap traces   : ")
+  check_on_or_off("ON" "ZLIB_FOUND")
+
   string(APPEND out "MPI Support                   : ")
   check_on_or_off("NS3_MPI" "MPI_FOUND")
 
@@ -595,6 +595,7 @@ macro(process_options)
   endif()
 
   set(LIBXML2_FOUND FALSE)
+  set(ZLIB_FOUND FALSE)
   if(${NS3_STATIC})
     # Warn users that they may be using shared libraries, which won't produce a
     # standalone static library
@@ -616,6 +617,14 @@ macro(process_options)
       add_definitions(-DHAVE_LIBXML2)
       include_directories(${LIBXML2_INCLUDE_DIR})
     endif()
+
+    find_package(ZLIB QUIET)
+    if(NOT ${ZLIB_FOUND})
+      set(ZLIB_FOUND_REASON "zlib was not found")
+    else()
+      add_definitions(-DHAVE_ZLIB)
+      include_directories(${ZLIB_INCLUDE_DIRS})
+    endif()
   endif()
 
   set(THREADS_PREFER_PTHREAD_FLAG)
@@ -1141,6 +1150,10 @@ macro(process_options)
   if(${NS3_ASSERT} OR (${build_profile} STREQUAL "debug"))
     add_definitions(-DNS3_ASSERT_ENABLE)
   endif()
+  # Remove the optional trace sources
+  if(${NS3_STRIP_TRACES})
+    add_definitions(-DNS3_STRIP_TRACES_ENABLE)
+  endif()
 
   set(ENABLE_TAP OFF)
   if(${NS3_TAP})
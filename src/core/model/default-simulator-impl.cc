@@ -8,12 +8,16 @@
 
 #include "default-simulator-impl.h"
 
+#include "abort.h"
 #include "assert.h"
+#include "event-profiler.h"
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
+#include "string.h"
 
 #include <cmath>
+#include <fstream>
 
 /**
  * @file
@@ -34,10 +38,18 @@ NS_OBJECT_ENSURE_REGISTERED(DefaultSimulatorImpl);
 TypeId
 DefaultSimulatorImpl::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
-                            .SetParent<SimulatorImpl>()
-                            .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+    static TypeId tid =
+        TypeId("ns3::DefaultSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Core")
+            .AddConstructor<DefaultSimulatorImpl>()
+            .AddAttribute("EventProfile",
+                          "If not empty, measure the wall-clock time spent in the function of "
+                          "each event at each node, and write a report in the folded stack "
+                          "format of the FlameGraph tools to this file at Simulator::Destroy().",
+                          StringValue(""),
+                          MakeStringAccessor(&DefaultSimulatorImpl::m_profileFile),
+                          MakeStringChecker());
     return tid;
 }
 
@@ -51,7 +63,6 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
     m_eventCount = 0;
-    m_eventsWithContextEmpty = true;
     m_mainThreadId = std::this_thread::get_id();
 }
 
@@ -89,6 +100,14 @@ DefaultSimulatorImpl::Destroy()
             ev->Invoke();
         }
     }
+
+    if (m_profiler)
+    {
+        std::ofstream os(m_profileFile);
+        NS_ABORT_MSG_UNLESS(os.is_open(), "Can't open file " << m_profileFile);
+        m_profiler->Report(os);
+        m_profiler.reset();
+    }
 }
 
 void
@@ -130,7 +149,16 @@ DefaultSimulatorImpl::ProcessOneEvent()
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
-    next.impl->Invoke();
+    if (m_profiler && !next.impl->IsCancelled())
+    {
+        m_profiler->Start(next.impl, next.key.m_context);
+        next.impl->Invoke();
+        m_profiler->Stop();
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
     next.impl->Unref();
 
     ProcessEventsWithContext();
@@ -145,22 +173,14 @@ DefaultSimulatorImpl::IsFinished() const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext()
 {
-    if (m_eventsWithContextEmpty)
+    if (m_eventsWithContext.IsEmpty())
     {
         return;
     }
 
-    // swap queues
-    EventsWithContext eventsWithContext;
+    EventInjectionQueue::Entry event;
+    while (m_eventsWithContext.Pop(event))
     {
-        std::unique_lock lock{m_eventsWithContextMutex};
-        m_eventsWithContext.swap(eventsWithContext);
-        m_eventsWithContextEmpty = true;
-    }
-    while (!eventsWithContext.empty())
-    {
-        EventWithContext event = eventsWithContext.front();
-        eventsWithContext.pop_front();
         Scheduler::Event ev;
         ev.impl = event.event;
         ev.key.m_ts = m_currentTs + event.timestamp;
@@ -180,6 +200,10 @@ DefaultSimulatorImpl::Run()
     m_mainThreadId = std::this_thread::get_id();
     ProcessEventsWithContext();
     m_stop = false;
+    if (!m_profileFile.empty() && !m_profiler)
+    {
+        m_profiler = std::make_unique<EventProfiler>();
+    }
 
     while (!m_events->IsEmpty() && !m_stop)
     {
@@ -248,16 +272,8 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
     }
     else
     {
-        EventWithContext ev;
-        ev.context = context;
         // Current time added in ProcessEventsWithContext()
-        ev.timestamp = delay.GetTimeStep();
-        ev.event = event;
-        {
-            std::unique_lock lock{m_eventsWithContextMutex};
-            m_eventsWithContext.push_back(ev);
-            m_eventsWithContextEmpty = false;
-        }
+        m_eventsWithContext.Push(context, delay.GetTimeStep(), event);
     }
 }
 
@@ -380,6 +396,12 @@ DefaultSimulatorImpl::GetContext() const
     return m_currentContext;
 }
 
+EventInjectionQueue::Stats
+DefaultSimulatorImpl::GetInjectionStats() const
+{
+    return m_eventsWithContext.GetStats();
+}
+
 uint64_t
 DefaultSimulatorImpl::GetEventCount() const
 {
@@ -9,10 +9,12 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "event-injection-queue.h"
 #include "simulator-impl.h"
 
 #include <list>
-#include <mutex>
+#include <memory>
+#include <string>
 #include <thread>
 
 /**
@@ -25,6 +27,7 @@ namespace ns3
 {
 
 // Forward
+class EventProfiler;
 class Scheduler;
 
 /**
@@ -67,6 +70,15 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /**
+     * Get the counters of the events scheduled from other threads.
+     *
+     * This method must be called from the simulator thread.
+     *
+     * @returns The injection counters.
+     */
+    EventInjectionQueue::Stats GetInjectionStats() const;
+
   private:
     void DoDispose() override;
 
@@ -75,28 +87,12 @@ class DefaultSimulatorImpl : public SimulatorImpl
     /** Move events from a different context into the main event queue. */
     void ProcessEventsWithContext();
 
-    /** Wrap an event with its execution context. */
-    struct EventWithContext
-    {
-        /** The event context. */
-        uint32_t context;
-        /** Event timestamp. */
-        uint64_t timestamp;
-        /** The event implementation. */
-        EventImpl* event;
-    };
-
-    /** Container type for the events from a different context. */
-    typedef std::list<EventWithContext> EventsWithContext;
-    /** The container of events from a different context. */
-    EventsWithContext m_eventsWithContext;
     /**
-     * Flag \c true if all events with context have been moved to the
-     * primary event queue.
+     * The events scheduled from a different thread; their timestamp
+     * is the delay relative to the time at which they are moved to
+     * the main event queue.
      */
-    bool m_eventsWithContextEmpty;
-    /** Mutex to control access to the list of events with context. */
-    std::mutex m_eventsWithContextMutex;
+    EventInjectionQueue m_eventsWithContext;
 
     /** Container type for the events to run at Simulator::Destroy() */
     typedef std::list<EventId> DestroyEvents;
@@ -125,6 +121,11 @@ class DefaultSimulatorImpl : public SimulatorImpl
 
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
+
+    /** The file of the event profile; empty if profiling is disabled. */
+    std::string m_profileFile;
+    /** The event profiler, if profiling is enabled. */
+    std::unique_ptr<EventProfiler> m_profiler;
 };
 
 } // namespace ns3
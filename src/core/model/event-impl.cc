@@ -10,6 +10,8 @@
 
 #include "log.h"
 
+#include <new>
+
 /**
  * @file
  * @ingroup events
@@ -21,6 +23,123 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+namespace
+{
+
+/** Size granularity of the event storage pool, in bytes. */
+constexpr std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes of the event storage pool. */
+constexpr std::size_t EVENT_POOL_CLASSES = 16;
+/** Maximum number of free blocks cached by each thread, per size class. */
+constexpr std::size_t EVENT_POOL_MAX_FREE = 4096;
+
+/** A released block, linked in the free list of its size class. */
+struct FreeBlock
+{
+    FreeBlock* next; //!< Next free block of the same size class.
+};
+
+/** The per-thread free lists of the event storage pool. */
+struct EventPool
+{
+    FreeBlock* head[EVENT_POOL_CLASSES]; //!< Free list heads, by size class.
+    std::size_t count[EVENT_POOL_CLASSES]; //!< Free list lengths, by size class.
+    bool registered; //!< Whether the release at thread exit is registered.
+    bool exited;     //!< Whether the thread is exiting.
+};
+
+/**
+ * The free lists of the calling thread.  This is trivially
+ * destructible, so it remains valid until the thread really exits.
+ */
+thread_local EventPool g_eventPool = {};
+
+/** Releases the free lists of a thread when the thread exits. */
+struct EventPoolReleaser
+{
+    /** Constructor. */
+    EventPoolReleaser()
+    {
+        g_eventPool.registered = true;
+    }
+
+    /** Destructor: return the cached blocks to the system. */
+    ~EventPoolReleaser()
+    {
+        g_eventPool.exited = true;
+        for (std::size_t i = 0; i < EVENT_POOL_CLASSES; ++i)
+        {
+            while (g_eventPool.head[i] != nullptr)
+            {
+                FreeBlock* block = g_eventPool.head[i];
+                g_eventPool.head[i] = block->next;
+                ::operator delete(block);
+            }
+            g_eventPool.count[i] = 0;
+        }
+    }
+};
+
+/** Registers the release of the free lists of each thread. */
+thread_local EventPoolReleaser g_eventPoolReleaser;
+
+/**
+ * Get the size class of an allocation.
+ *
+ * @param [in] size The allocation size.
+ * @returns The size class; EVENT_POOL_CLASSES if the allocation
+ *          is too large to be pooled.
+ */
+inline std::size_t
+GetSizeClass(std::size_t size)
+{
+    std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+    return sizeClass < EVENT_POOL_CLASSES ? sizeClass : EVENT_POOL_CLASSES;
+}
+
+} // namespace
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+    std::size_t sizeClass = GetSizeClass(size);
+    if (sizeClass < EVENT_POOL_CLASSES)
+    {
+        FreeBlock* block = g_eventPool.head[sizeClass];
+        if (block != nullptr)
+        {
+            g_eventPool.head[sizeClass] = block->next;
+            g_eventPool.count[sizeClass]--;
+            return block;
+        }
+        // Blocks can migrate between threads, so they must always have
+        // the full size of their class.
+        return ::operator new((sizeClass + 1) * EVENT_POOL_GRANULARITY);
+    }
+    return ::operator new(size);
+}
+
+void
+EventImpl::operator delete(void* ptr, std::size_t size)
+{
+    std::size_t sizeClass = GetSizeClass(size);
+    if (sizeClass < EVENT_POOL_CLASSES && !g_eventPool.exited &&
+        g_eventPool.count[sizeClass] < EVENT_POOL_MAX_FREE)
+    {
+        if (!g_eventPool.registered)
+        {
+            // odr-use the releaser to construct it in this thread
+            static_cast<void>(&g_eventPoolReleaser);
+        }
+        auto block = static_cast<FreeBlock*>(ptr);
+        block->next = g_eventPool.head[sizeClass];
+        g_eventPool.head[sizeClass] = block;
+        g_eventPool.count[sizeClass]++;
+        return;
+    }
+    ::operator delete(ptr);
+}
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -56,4 +175,10 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+EventImpl::Function
+EventImpl::GetFunction() const
+{
+    return {nullptr, &typeid(*this)};
+}
+
 } // namespace ns3
@@ -10,7 +10,9 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
+#include <typeinfo>
 
 /**
  * @file
@@ -34,6 +36,21 @@ namespace ns3
 class EventImpl : public SimpleRefCount<EventImpl>
 {
   public:
+    /** Identification of the function run by an event, used for profiling. */
+    struct Function
+    {
+        /** The address of the function, or \c nullptr if not known. */
+        const void* address;
+        /** The type of the function, or of the event if not known. */
+        const std::type_info* type;
+        /** The object a class method is called on, or \c nullptr. */
+        const void* object;
+        /** The representation of the class method pointer, if any. */
+        unsigned char method[2 * sizeof(void*)];
+        /** The size of the class method pointer, or 0. */
+        std::size_t methodSize;
+    };
+
     /** Default constructor. */
     EventImpl();
     /** Destructor. */
@@ -56,6 +73,33 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * Get the function run by Invoke(), to attribute the execution
+     * time of the event when profiling.
+     *
+     * The default implementation only knows the type of the event.
+     *
+     * @returns The function run by this event.
+     */
+    virtual Function GetFunction() const;
+
+    /**
+     * Allocate the storage of an event, reusing a previously released
+     * block of the same size class if available.
+     *
+     * @param [in] size The size of the event object.
+     * @returns A pointer to the allocated storage.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Release the storage of an event to the free list of the calling
+     * thread.
+     *
+     * @param [in] ptr The storage to release.
+     * @param [in] size The size of the event object.
+     */
+    static void operator delete(void* ptr, std::size_t size);
+
   protected:
     /**
      * Implementation for Invoke().
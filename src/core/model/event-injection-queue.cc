@@ -0,0 +1,199 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "event-injection-queue.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <chrono>
+#include <tuple>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventInjectionQueue implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventInjectionQueue");
+
+namespace
+{
+
+/**
+ * Get the wall-clock time used to measure the injection latency.
+ *
+ * @returns The current time, in ns.
+ */
+inline int64_t
+GetWallClockNs()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+} // namespace
+
+EventInjectionQueue::EventInjectionQueue(uint32_t capacity)
+    : m_pushPosition(0),
+      m_popPosition(0),
+      m_overflowing(false),
+      m_pendingIndex(0),
+      m_overflows(0),
+      m_popped(0),
+      m_totalLatency(0),
+      m_maxLatency(0)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    uint64_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_cells = std::make_unique<Cell[]>(size);
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+EventInjectionQueue::~EventInjectionQueue()
+{
+    NS_LOG_FUNCTION(this);
+    Entry entry;
+    while (Pop(entry))
+    {
+        entry.event->Unref();
+    }
+}
+
+void
+EventInjectionQueue::Push(uint32_t context, uint64_t timestamp, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << timestamp << event);
+    int64_t pushTime = GetWallClockNs();
+
+    if (!m_overflowing.load(std::memory_order_acquire))
+    {
+        uint64_t position = m_pushPosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = m_cells[position & m_mask];
+            uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(sequence - position);
+            if (diff == 0)
+            {
+                // The cell is free: claim it
+                if (m_pushPosition.compare_exchange_weak(position,
+                                                         position + 1,
+                                                         std::memory_order_relaxed))
+                {
+                    cell.entry = {context, timestamp, event};
+                    cell.pushTime = pushTime;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (diff < 0)
+            {
+                // The ring is full
+                break;
+            }
+            else
+            {
+                // Another producer claimed the cell first
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::unique_lock lock{m_overflowMutex};
+    m_overflow.emplace_back(Entry{context, timestamp, event}, pushTime);
+    m_overflowing.store(true, std::memory_order_release);
+    m_overflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool
+EventInjectionQueue::IsEmpty() const
+{
+    const Cell& cell = m_cells[m_popPosition & m_mask];
+    return m_pendingIndex == m_pending.size() &&
+           cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1 &&
+           !m_overflowing.load(std::memory_order_acquire);
+}
+
+bool
+EventInjectionQueue::PopRing(Entry& entry, int64_t& pushTime)
+{
+    Cell& cell = m_cells[m_popPosition & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1)
+    {
+        return false;
+    }
+    entry = cell.entry;
+    pushTime = cell.pushTime;
+    cell.sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+    m_popPosition++;
+    return true;
+}
+
+bool
+EventInjectionQueue::Pop(Entry& entry)
+{
+    int64_t pushTime;
+    if (m_pendingIndex < m_pending.size())
+    {
+        // The overflow entries were pushed before the entries in the
+        // ring by the same producer.
+        std::tie(entry, pushTime) = m_pending[m_pendingIndex++];
+    }
+    else if (!PopRing(entry, pushTime))
+    {
+        if (!m_overflowing.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        m_pending.clear();
+        m_pendingIndex = 0;
+        {
+            std::unique_lock lock{m_overflowMutex};
+            m_pending.swap(m_overflow);
+            m_overflowing.store(false, std::memory_order_release);
+        }
+        NS_ASSERT(!m_pending.empty());
+        std::tie(entry, pushTime) = m_pending[m_pendingIndex++];
+    }
+    RecordLatency(pushTime);
+    return true;
+}
+
+void
+EventInjectionQueue::RecordLatency(int64_t pushTime)
+{
+    int64_t latency = GetWallClockNs() - pushTime;
+    m_popped++;
+    m_totalLatency += latency;
+    if (latency > m_maxLatency)
+    {
+        m_maxLatency = latency;
+    }
+}
+
+EventInjectionQueue::Stats
+EventInjectionQueue::GetStats() const
+{
+    Stats stats;
+    stats.events = m_popped;
+    stats.overflows = m_overflows.load(std::memory_order_relaxed);
+    stats.meanLatency = NanoSeconds(m_popped > 0 ? m_totalLatency / (int64_t)m_popped : 0);
+    stats.maxLatency = NanoSeconds(m_maxLatency);
+    return stats;
+}
+
+} // namespace ns3
@@ -0,0 +1,182 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef EVENT_INJECTION_QUEUE_H
+#define EVENT_INJECTION_QUEUE_H
+
+#include "nstime.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventInjectionQueue declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * @ingroup simulator
+ * @brief Queue of the events scheduled from threads other than the
+ * simulator thread.
+ *
+ * Threads reading from sockets or devices (e.g., FdNetDevice or
+ * TapBridge) hand their events to the simulator thread through
+ * Simulator::ScheduleWithContext().  The events are stored in a
+ * bounded lock-free ring with multiple producers and a single
+ * consumer: Push() can be called from any thread, while IsEmpty()
+ * and Pop() must only be called from the simulator thread, which
+ * drains all the pending events at once between two simulation
+ * events.
+ *
+ * If the ring is full, the producers fall back to a mutex-protected
+ * overflow list, so Push() never blocks waiting for the consumer; the
+ * events pushed by a single thread are always popped in order.
+ *
+ * The queue measures the wall-clock latency between Push() and Pop()
+ * of each event, see GetStats().
+ */
+class EventInjectionQueue
+{
+  public:
+    /** An event scheduled from a different thread. */
+    struct Entry
+    {
+        /** The event context. */
+        uint32_t context;
+        /** The event timestamp; its meaning depends on the SimulatorImpl. */
+        uint64_t timestamp;
+        /** The event implementation. */
+        EventImpl* event;
+    };
+
+    /** Injection counters. */
+    struct Stats
+    {
+        uint64_t events;    /**< Number of events popped. */
+        uint64_t overflows; /**< Number of events pushed to the overflow list. */
+        Time meanLatency;   /**< Mean latency between Push() and Pop(). */
+        Time maxLatency;    /**< Maximum latency between Push() and Pop(). */
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param [in] capacity The number of entries of the ring, rounded
+     *             up to a power of two.
+     */
+    explicit EventInjectionQueue(uint32_t capacity = 1024);
+    /** Destructor: release the events which have not been popped. */
+    ~EventInjectionQueue();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    EventInjectionQueue(const EventInjectionQueue&) = delete;
+    EventInjectionQueue& operator=(const EventInjectionQueue&) = delete;
+
+    /**
+     * Add an event to the queue.  This method can be called from
+     * any thread.
+     *
+     * @param [in] context The event context.
+     * @param [in] timestamp The event timestamp.
+     * @param [in] event The event implementation.
+     */
+    void Push(uint32_t context, uint64_t timestamp, EventImpl* event);
+
+    /**
+     * Check whether there are events to pop.  This method must only
+     * be called by the consumer thread.
+     *
+     * @returns \c true if there are no events to pop.
+     */
+    bool IsEmpty() const;
+
+    /**
+     * Remove the oldest event from the queue.  This method must only
+     * be called by the consumer thread.
+     *
+     * @param [out] entry The event removed from the queue.
+     * @returns \c false if the queue was empty.
+     */
+    bool Pop(Entry& entry);
+
+    /**
+     * Get the injection counters.  This method must only be called by
+     * the consumer thread.
+     *
+     * @returns The injection counters.
+     */
+    Stats GetStats() const;
+
+  private:
+    /** A slot of the ring. */
+    struct Cell
+    {
+        /**
+         * Sequence number: equal to the push position when the cell is
+         * free, to the push position plus one when it holds an entry.
+         */
+        std::atomic<uint64_t> sequence;
+        Entry entry;      /**< The event. */
+        int64_t pushTime; /**< Wall-clock time of the Push(), in ns. */
+    };
+
+    /**
+     * Pop the oldest entry from the ring.
+     *
+     * @param [out] entry The entry removed from the ring.
+     * @param [out] pushTime The wall-clock time of the Push(), in ns.
+     * @returns \c false if the ring is empty.
+     */
+    bool PopRing(Entry& entry, int64_t& pushTime);
+
+    /**
+     * Update the latency counters for an entry being popped.
+     *
+     * @param [in] pushTime The wall-clock time of the Push(), in ns.
+     */
+    void RecordLatency(int64_t pushTime);
+
+    /** The ring. */
+    std::unique_ptr<Cell[]> m_cells;
+    /** The ring size minus one. */
+    uint64_t m_mask;
+    /** Next push position, shared by the producers. */
+    alignas(64) std::atomic<uint64_t> m_pushPosition;
+    /** Next pop position, owned by the consumer. */
+    alignas(64) uint64_t m_popPosition;
+
+    /** Whether the overflow list may be non-empty. */
+    std::atomic<bool> m_overflowing;
+    /** Protects m_overflow. */
+    std::mutex m_overflowMutex;
+    /** Entries which did not fit in the ring, with their Push() time. */
+    std::vector<std::pair<Entry, int64_t>> m_overflow;
+    /** Overflow entries moved to the consumer and not yet popped. */
+    std::vector<std::pair<Entry, int64_t>> m_pending;
+    /** Index of the next entry to pop in m_pending. */
+    std::size_t m_pendingIndex;
+
+    /** Number of entries pushed to the overflow list. */
+    std::atomic<uint64_t> m_overflows;
+    /** Number of entries popped. */
+    uint64_t m_popped;
+    /** Sum of the Push() to Pop() latencies, in ns. */
+    int64_t m_totalLatency;
+    /** Maximum Push() to Pop() latency, in ns. */
+    int64_t m_maxLatency;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_INJECTION_QUEUE_H */
@@ -0,0 +1,195 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "event-profiler.h"
+
+#include "demangle.h"
+#include "log.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#if __has_include(<dlfcn.h>)
+#include <dlfcn.h>
+#define NS3_EVENT_PROFILER_DLADDR
+#endif
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+/**
+ * @ingroup simulator
+ * Get the address of the function called through a pointer to a class
+ * method, resolving virtual methods with the object they are called on.
+ *
+ * This relies on the representation of method pointers of the Itanium
+ * C++ ABI (and of its ARM variant), used by GCC and Clang.
+ *
+ * @param [in] function The function run by an event.
+ * @returns The address of the class method, or \c nullptr if unknown.
+ */
+static const void*
+GetMethodAddress(const EventImpl::Function& function)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    struct
+    {
+        std::uintptr_t ptr;
+        std::ptrdiff_t adj;
+    } repr;
+
+    if (function.object == nullptr || function.methodSize != sizeof(repr))
+    {
+        return nullptr;
+    }
+    std::memcpy(&repr, function.method, sizeof(repr));
+#if defined(__arm__) || defined(__aarch64__)
+    bool isVirtual = repr.adj & 1;
+    std::ptrdiff_t adj = repr.adj >> 1;
+    std::uintptr_t offset = repr.ptr;
+#else
+    bool isVirtual = repr.ptr & 1;
+    std::ptrdiff_t adj = repr.adj;
+    std::uintptr_t offset = repr.ptr - 1;
+#endif
+    if (!isVirtual)
+    {
+        return reinterpret_cast<const void*>(repr.ptr);
+    }
+    auto self = static_cast<const char*>(function.object) + adj;
+    auto vtable = *reinterpret_cast<const char* const*>(self);
+    return *reinterpret_cast<const void* const*>(vtable + offset);
+#else
+    return nullptr;
+#endif
+}
+
+std::size_t
+EventProfiler::KeyHash::operator()(const Key& key) const
+{
+    std::size_t h = std::hash<const void*>()(key.address);
+    h = h * 31 + std::hash<const void*>()(key.type);
+    return h * 31 + key.context;
+}
+
+EventProfiler::EventProfiler()
+    : m_current(nullptr)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+EventProfiler::Start(const EventImpl* event, uint32_t context)
+{
+    EventImpl::Function function = event->GetFunction();
+    if (function.address == nullptr && function.methodSize != 0)
+    {
+        // The object may be destroyed by the event, so resolve the method now
+        function.address = GetMethodAddress(function);
+    }
+    m_current = &m_profile[{function.address, function.type, context}];
+    m_start = std::chrono::steady_clock::now();
+}
+
+void
+EventProfiler::Stop()
+{
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    m_current->events++;
+    m_current->elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    m_current = nullptr;
+}
+
+std::string
+EventProfiler::GetFunctionName(const EventImpl::Function& function)
+{
+#ifdef NS3_EVENT_PROFILER_DLADDR
+    Dl_info info;
+    if (function.address != nullptr && dladdr(function.address, &info) != 0)
+    {
+        if (info.dli_sname != nullptr && info.dli_saddr == function.address)
+        {
+            return Demangle(info.dli_sname);
+        }
+        // Functions with internal linkage are not in the dynamic symbol
+        // table: keep them apart with their offset, which addr2line can
+        // resolve.
+        std::ostringstream oss;
+        oss << Demangle(function.type->name()) << " [" << info.dli_fname << "+0x" << std::hex
+            << (static_cast<const char*>(function.address) -
+                static_cast<const char*>(info.dli_fbase))
+            << "]";
+        return oss.str();
+    }
+#endif
+    return Demangle(function.type->name());
+}
+
+void
+EventProfiler::Report(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this);
+
+    // Several keys (e.g., events bound to the same method through
+    // different pointer types) can map to the same name.
+    std::map<std::string, std::map<uint32_t, Entry>> byName;
+    for (const auto& [key, entry] : m_profile)
+    {
+        auto& total = byName[GetFunctionName({key.address, key.type})][key.context];
+        total.events += entry.events;
+        total.elapsed += entry.elapsed;
+    }
+
+    struct Line
+    {
+        uint64_t functionElapsed;
+        uint64_t elapsed;
+        std::string stack;
+    };
+
+    std::vector<Line> lines;
+    for (const auto& [name, contexts] : byName)
+    {
+        uint64_t functionElapsed = 0;
+        for (const auto& [context, entry] : contexts)
+        {
+            functionElapsed += entry.elapsed;
+        }
+        // ';' separates the frames of the folded stacks
+        std::string frame = name;
+        std::replace(frame.begin(), frame.end(), ';', ',');
+        for (const auto& [context, entry] : contexts)
+        {
+            std::string node = context == Simulator::NO_CONTEXT
+                                   ? std::string("no context")
+                                   : "node " + std::to_string(context);
+            lines.push_back({functionElapsed, entry.elapsed, frame + ";" + node});
+        }
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) {
+        return std::tie(b.functionElapsed, b.elapsed, a.stack) <
+               std::tie(a.functionElapsed, a.elapsed, b.stack);
+    });
+    for (const auto& line : lines)
+    {
+        os << line.stack << " " << line.elapsed << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup simulator
+ * @brief Attribute the wall-clock time of the simulation to the
+ * functions run by the events and to the nodes running them.
+ *
+ * The simulator implementation calls Start() just before invoking
+ * an event and Stop() just after; the profiler accumulates the elapsed
+ * time and the number of events for each (function, context) pair.
+ * The functions are only named when the report is written: class
+ * methods and function pointers are resolved to their demangled symbol
+ * name through the dynamic symbol table, lambdas and function objects
+ * are named after their type.  Functions which are not in the dynamic
+ * symbol table (e.g., static functions) are named after their type,
+ * followed by the library and the offset of the function.
+ *
+ * The report uses the folded stack format of the FlameGraph tools
+ * (https://github.com/brendangregg/FlameGraph): each line holds a
+ * function name and a context, separated by a semicolon, and the
+ * elapsed time in ns.  The lines are ranked by the total time of the
+ * function, then by the time of the context, so the head of the
+ * report is also a readable summary of the heaviest functions.
+ */
+class EventProfiler
+{
+  public:
+    /** Constructor. */
+    EventProfiler();
+
+    /**
+     * Start timing an event.
+     *
+     * @param [in] event The event about to be invoked.
+     * @param [in] context The context of the event.
+     */
+    void Start(const EventImpl* event, uint32_t context);
+    /** Stop timing the event passed to the last Start(). */
+    void Stop();
+
+    /**
+     * Write the report.
+     *
+     * @param [in,out] os The output stream.
+     */
+    void Report(std::ostream& os) const;
+
+    /**
+     * Get the name of the function run by an event.
+     *
+     * @param [in] function The function run by the event.
+     * @returns The demangled name of the function.
+     */
+    static std::string GetFunctionName(const EventImpl::Function& function);
+
+  private:
+    /** The key of the profile entries. */
+    struct Key
+    {
+        const void* address;        /**< The function address. */
+        const std::type_info* type; /**< The function type. */
+        uint32_t context;           /**< The event context. */
+
+        /**
+         * Equality operator.
+         *
+         * @param [in] other The other key.
+         * @returns \c true if the keys are equal.
+         */
+        bool operator==(const Key& other) const
+        {
+            return address == other.address && type == other.type && context == other.context;
+        }
+    };
+
+    /** Hash function of the keys. */
+    struct KeyHash
+    {
+        /**
+         * Compute the hash of a key.
+         *
+         * @param [in] key The key.
+         * @returns The hash of the key.
+         */
+        std::size_t operator()(const Key& key) const;
+    };
+
+    /** A profile entry. */
+    struct Entry
+    {
+        uint64_t events;  /**< The number of events. */
+        uint64_t elapsed; /**< The elapsed time, in ns. */
+    };
+
+    /** The profile. */
+    std::unordered_map<Key, Entry, KeyHash> m_profile;
+    /** The entry of the event being timed. */
+    Entry* m_current;
+    /** The start time of the event being timed. */
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
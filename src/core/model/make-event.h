@@ -10,6 +10,7 @@
 
 #include "warnings.h"
 
+#include <cstring>
 #include <functional>
 #include <tuple>
 #include <type_traits>
@@ -126,96 +127,105 @@ struct EventMemberImplObjTraits<T*>
     }
 };
 
-} // namespace internal
-
-template <typename MEM, typename OBJ, typename... Ts>
-std::enable_if_t<std::is_member_pointer_v<MEM>, EventImpl*>
-MakeEvent(MEM mem_ptr, OBJ obj, Ts... args)
+/**
+ * @ingroup events
+ * An EventImpl which invokes a callable object with bound arguments.
+ *
+ * The callable object and the arguments are stored by value in the
+ * event itself, rather than in a separately allocated closure (such as
+ * a \c std::function), so creating an event takes a single allocation,
+ * which is served by the EventImpl storage pool unless the captured
+ * state is very large.
+ *
+ * @tparam F \explicit The callable type: a function pointer, a class
+ *           method pointer or a function object.
+ * @tparam Ts \explicit The types of the bound arguments.  For a class
+ *           method, the first one is the object.
+ */
+template <typename F, typename... Ts>
+class BoundEventImpl : public EventImpl
 {
-    class EventMemberImpl : public EventImpl
+  public:
+    BoundEventImpl() = delete;
+
+    /**
+     * Constructor.
+     *
+     * @param [in] function The callable object.
+     * @param [in] args The arguments to pass to \pname{function}.
+     */
+    BoundEventImpl(F function, Ts... args)
+        : m_function(function),
+          m_arguments(args...)
     {
-      public:
-        EventMemberImpl() = delete;
+    }
 
-        EventMemberImpl(OBJ obj, MEM function, Ts... args)
-            : m_function(std::bind(function, obj, args...))
+    // Inherited from EventImpl
+    Function GetFunction() const override
+    {
+        if constexpr (std::is_pointer_v<F> && std::is_function_v<std::remove_pointer_t<F>>)
         {
+            return {reinterpret_cast<const void*>(m_function), &typeid(F)};
         }
-
-      protected:
-        ~EventMemberImpl() override
+        else if constexpr (std::is_member_function_pointer_v<F> && sizeof...(Ts) > 0 &&
+                           sizeof(F) <= sizeof(Function::method))
         {
+            const auto& object = std::get<0>(m_arguments);
+            if constexpr (requires { &*object; })
+            {
+                // The method pointer is only decoded by the profiler
+                Function function{nullptr, &typeid(F), &*object, {}, sizeof(F)};
+                std::memcpy(function.method, &m_function, sizeof(F));
+                return function;
+            }
+            else
+            {
+                return {nullptr, &typeid(F)};
+            }
         }
-
-      private:
-        void Notify() override
+        else
         {
-            m_function();
+            return {nullptr, &typeid(F)};
         }
+    }
+
+  protected:
+    ~BoundEventImpl() override
+    {
+    }
 
-        std::function<void()> m_function;
-    }* ev = new EventMemberImpl(obj, mem_ptr, args...);
+  private:
+    void Notify() override
+    {
+        std::apply([this](auto&... args) { std::invoke(m_function, args...); }, m_arguments);
+    }
+
+    F m_function;                  //!< The callable object.
+    std::tuple<Ts...> m_arguments; //!< The bound arguments.
+};
+
+} // namespace internal
 
-    return ev;
+template <typename MEM, typename OBJ, typename... Ts>
+std::enable_if_t<std::is_member_pointer_v<MEM>, EventImpl*>
+MakeEvent(MEM mem_ptr, OBJ obj, Ts... args)
+{
+    return new internal::BoundEventImpl<MEM, OBJ, Ts...>(mem_ptr, obj, args...);
 }
 
 template <typename... Us, typename... Ts>
 EventImpl*
 MakeEvent(void (*f)(Us...), Ts... args)
 {
-    class EventFunctionImpl : public EventImpl
-    {
-      public:
-        EventFunctionImpl(void (*function)(Us...), Ts... args)
-            : m_function(function),
-              m_arguments(args...)
-        {
-        }
-
-      protected:
-        ~EventFunctionImpl() override
-        {
-        }
-
-      private:
-        void Notify() override
-        {
-            std::apply([this](Ts... args) { (*m_function)(args...); }, m_arguments);
-        }
-
-        void (*m_function)(Us...);
-        std::tuple<std::remove_reference_t<Ts>...> m_arguments;
-    }* ev = new EventFunctionImpl(f, args...);
-
-    return ev;
+    using Impl = internal::BoundEventImpl<void (*)(Us...), std::remove_reference_t<Ts>...>;
+    return new Impl(f, args...);
 }
 
 template <typename T>
 EventImpl*
 MakeEvent(T function)
 {
-    class EventImplFunctional : public EventImpl
-    {
-      public:
-        EventImplFunctional(T function)
-            : m_function(function)
-        {
-        }
-
-        ~EventImplFunctional() override
-        {
-        }
-
-      private:
-        void Notify() override
-        {
-            m_function();
-        }
-
-        T m_function;
-    }* ev = new EventImplFunctional(function);
-
-    return ev;
+    return new internal::BoundEventImpl<T>(function);
 }
 
 } // namespace ns3
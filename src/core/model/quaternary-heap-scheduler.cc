@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "quaternary-heap-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * @file
+ * @ingroup scheduler
+ * Implementation of ns3::QuaternaryHeapScheduler class.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("QuaternaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(QuaternaryHeapScheduler);
+
+namespace
+{
+
+/** Number of children of each heap item. */
+constexpr std::size_t HEAP_ARITY = 4;
+
+} // namespace
+
+TypeId
+QuaternaryHeapScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::QuaternaryHeapScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<QuaternaryHeapScheduler>();
+    return tid;
+}
+
+QuaternaryHeapScheduler::QuaternaryHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+QuaternaryHeapScheduler::~QuaternaryHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+QuaternaryHeapScheduler::SiftUp(std::size_t index, const EventKey& key, EventImpl* impl)
+{
+    NS_LOG_FUNCTION(this << index);
+    while (index > 0)
+    {
+        std::size_t parent = (index - 1) / HEAP_ARITY;
+        if (!(key < m_keys[parent]))
+        {
+            break;
+        }
+        m_keys[index] = m_keys[parent];
+        m_impls[index] = m_impls[parent];
+        index = parent;
+    }
+    m_keys[index] = key;
+    m_impls[index] = impl;
+}
+
+void
+QuaternaryHeapScheduler::SiftDown(std::size_t index, const EventKey& key, EventImpl* impl)
+{
+    NS_LOG_FUNCTION(this << index);
+    const std::size_t size = m_keys.size();
+    while (true)
+    {
+        std::size_t first = index * HEAP_ARITY + 1;
+        if (first >= size)
+        {
+            break;
+        }
+        std::size_t last = std::min(first + HEAP_ARITY, size);
+        std::size_t smallest = first;
+        for (std::size_t child = first + 1; child < last; ++child)
+        {
+            if (m_keys[child] < m_keys[smallest])
+            {
+                smallest = child;
+            }
+        }
+        if (!(m_keys[smallest] < key))
+        {
+            break;
+        }
+        m_keys[index] = m_keys[smallest];
+        m_impls[index] = m_impls[smallest];
+        index = smallest;
+    }
+    m_keys[index] = key;
+    m_impls[index] = impl;
+}
+
+void
+QuaternaryHeapScheduler::RemoveAt(std::size_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    EventKey key = m_keys.back();
+    EventImpl* impl = m_impls.back();
+    m_keys.pop_back();
+    m_impls.pop_back();
+    if (index == m_keys.size())
+    {
+        return;
+    }
+    // The last item can be smaller than the parent of the hole if it
+    // lies in a different subtree.
+    if (index > 0 && key < m_keys[(index - 1) / HEAP_ARITY])
+    {
+        SiftUp(index, key, impl);
+    }
+    else
+    {
+        SiftDown(index, key, impl);
+    }
+}
+
+void
+QuaternaryHeapScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << &ev);
+    m_keys.emplace_back();
+    m_impls.emplace_back();
+    SiftUp(m_keys.size() - 1, ev.key, ev.impl);
+}
+
+bool
+QuaternaryHeapScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_keys.empty();
+}
+
+Scheduler::Event
+QuaternaryHeapScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return {m_impls.front(), m_keys.front()};
+}
+
+Scheduler::Event
+QuaternaryHeapScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Event next = {m_impls.front(), m_keys.front()};
+    RemoveAt(0);
+    return next;
+}
+
+void
+QuaternaryHeapScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << &ev);
+    uint32_t uid = ev.key.m_uid;
+    for (std::size_t i = 0; i < m_keys.size(); i++)
+    {
+        if (uid == m_keys[i].m_uid)
+        {
+            NS_ASSERT(m_impls[i] == ev.impl);
+            RemoveAt(i);
+            return;
+        }
+    }
+    NS_ASSERT(false);
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef QUATERNARY_HEAP_SCHEDULER_H
+#define QUATERNARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup scheduler
+ * ns3::QuaternaryHeapScheduler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup scheduler
+ * @brief A cache-friendly 4-ary heap event scheduler
+ *
+ * This is an implicit heap in which every item has four children
+ * instead of two: the heap is half as deep as a binary heap, and the
+ * four children compared at each level of RemoveNext() are adjacent
+ * in memory.
+ *
+ * The event keys (timestamp, uid, context) are stored contiguously in
+ * a `std::vector`, separately from the EventImpl pointers, which are
+ * kept in a parallel `std::vector`: the comparisons only touch the
+ * key array, so four 16-byte keys fit in a single cache line, and
+ * the EventImpl objects are never dereferenced while the heap is
+ * reorganized.  Items are moved into a hole rather than swapped,
+ * which halves the number of writes.
+ *
+ * Together with the pooled storage of the EventImpl objects, this
+ * avoids any allocation in steady state: the vectors only grow when
+ * the event population reaches a new maximum.
+ *
+ * @par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | Logarithmic     | Heapify
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Heap kept sorted
+ * Remove()     | Linear          | Search, heapify
+ * RemoveNext() | Logarithmic     | Heapify
+ *
+ * @par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 6 x `sizeof (*)`<br/>(48 bytes)  | Two `std::vector`
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class QuaternaryHeapScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    QuaternaryHeapScheduler();
+    /** Destructor. */
+    ~QuaternaryHeapScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /**
+     * Move an item up to its proper position.
+     *
+     * @param [in] index The index of the hole to fill.
+     * @param [in] key The key of the item to place.
+     * @param [in] impl The event of the item to place.
+     */
+    void SiftUp(std::size_t index, const EventKey& key, EventImpl* impl);
+    /**
+     * Move an item down to its proper position.
+     *
+     * @param [in] index The index of the hole to fill.
+     * @param [in] key The key of the item to place.
+     * @param [in] impl The event of the item to place.
+     */
+    void SiftDown(std::size_t index, const EventKey& key, EventImpl* impl);
+    /**
+     * Remove the item at a given index.
+     *
+     * @param [in] index The index of the item to remove.
+     */
+    void RemoveAt(std::size_t index);
+
+    /** The event keys, managed as a 4-ary heap rooted at index 0. */
+    std::vector<EventKey> m_keys;
+    /** The events, at the same index as their key. */
+    std::vector<EventImpl*> m_impls;
+};
+
+} // namespace ns3
+
+#endif /* QUATERNARY_HEAP_SCHEDULER_H */
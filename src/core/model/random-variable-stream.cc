@@ -27,7 +27,9 @@
 #include <algorithm> // upper_bound
 #include <cmath>
 #include <iostream>
+#include <mutex>
 #include <numbers>
+#include <unordered_set>
 
 /**
  * @file
@@ -67,17 +69,71 @@ RandomVariableStream::GetTypeId()
     return tid;
 }
 
+namespace
+{
+
+/**
+ * @ingroup randomvariable
+ * The live RandomVariableStream instances, for AdvanceAllSubstreams().
+ */
+struct StreamRegistry
+{
+    std::mutex mutex;                                /**< Protects streams. */
+    std::unordered_set<RandomVariableStream*> streams; /**< The instances. */
+};
+
+/**
+ * @ingroup randomvariable
+ * Get the registry of the live RandomVariableStream instances.
+ *
+ * The registry is never destroyed, as streams may be destroyed by the
+ * static destructors of other compilation units.
+ *
+ * @returns The registry.
+ */
+StreamRegistry&
+GetStreamRegistry()
+{
+    static auto registry = new StreamRegistry;
+    return *registry;
+}
+
+} // namespace
+
 RandomVariableStream::RandomVariableStream()
     : m_rng(nullptr)
 {
     NS_LOG_FUNCTION(this);
+    StreamRegistry& registry = GetStreamRegistry();
+    std::unique_lock lock{registry.mutex};
+    registry.streams.insert(this);
 }
 
 RandomVariableStream::~RandomVariableStream()
 {
+    StreamRegistry& registry = GetStreamRegistry();
+    {
+        std::unique_lock lock{registry.mutex};
+        registry.streams.erase(this);
+    }
     delete m_rng;
 }
 
+void
+RandomVariableStream::AdvanceAllSubstreams(uint64_t substreams)
+{
+    NS_LOG_FUNCTION(substreams);
+    StreamRegistry& registry = GetStreamRegistry();
+    std::unique_lock lock{registry.mutex};
+    for (auto stream : registry.streams)
+    {
+        if (stream->m_rng != nullptr)
+        {
+            stream->m_rng->AdvanceSubstreams(substreams);
+        }
+    }
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
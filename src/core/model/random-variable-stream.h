@@ -143,6 +143,18 @@ class RandomVariableStream : public Object
     // The base implementation returns `(uint32_t)GetValue()`
     virtual uint32_t GetInteger();
 
+    /**
+     * @brief Move all the existing streams forward by whole substreams.
+     *
+     * After this call, the streams draw the values which they would
+     * draw had they been created with a run number larger by
+     * \pname{substreams}.  This is used to make simulations forked from
+     * the same state diverge, see SimulationCheckpoint::Fork().
+     *
+     * @param [in] substreams The number of substreams to skip.
+     */
+    static void AdvanceAllSubstreams(uint64_t substreams);
+
   protected:
     /**
      * @brief Get the pointer to the underlying RngStream.
@@ -19,6 +19,7 @@
 #include "synchronizer.h"
 #include "wall-clock-synchronizer.h"
 
+#include <algorithm>
 #include <cmath>
 #include <mutex>
 #include <thread>
@@ -92,6 +93,7 @@ void
 RealtimeSimulatorImpl::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    ProcessEventsWithContext();
     while (!m_events->IsEmpty())
     {
         Scheduler::Event next = m_events->RemoveNext();
@@ -194,6 +196,14 @@ RealtimeSimulatorImpl::ProcessOneEvent()
         {
             std::unique_lock lock{m_mutex};
             //
+            // This next line resets the synchronizer so that any future event will
+            // cause it to interrupt.  It must be done before looking for the events
+            // scheduled by other threads, which do not take the critical section:
+            // an event injected after the check below will interrupt the wait.
+            //
+            m_synchronizer->SetCondition(false);
+            ProcessEventsWithContext();
+            //
             // Since we are in realtime mode, the time to delay has got to be the
             // difference between the current realtime and the timestamp of the next
             // event.  Since m_currentTs is actually the timestamp of the last event we
@@ -239,10 +249,9 @@ RealtimeSimulatorImpl::ProcessOneEvent()
             // We've figured out how long we need to delay in order to pace the
             // simulation time with the real time.  We're going to sleep, but need
             // to work with the synchronizer to make sure we're awakened if something
-            // external happens (like a packet is received).  This next line resets
-            // the synchronizer so that any future event will cause it to interrupt.
+            // external happens (like a packet is received): the condition has been
+            // reset above.
             //
-            m_synchronizer->SetCondition(false);
         }
 
         //
@@ -396,6 +405,30 @@ RealtimeSimulatorImpl::IsFinished() const
     return rc;
 }
 
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext()
+{
+    if (m_eventsWithContext.IsEmpty())
+    {
+        return;
+    }
+
+    EventInjectionQueue::Entry event;
+    while (m_eventsWithContext.Pop(event))
+    {
+        Scheduler::Event ev;
+        ev.impl = event.event;
+        // The realtime clock was read before the event was pushed, and the
+        // simulation may have advanced since then; do not go back in time.
+        ev.key.m_ts = std::max(event.timestamp, m_currentTs);
+        ev.key.m_context = event.context;
+        ev.key.m_uid = m_uid;
+        m_uid++;
+        m_unscheduledEvents++;
+        m_events->Insert(ev);
+    }
+}
+
 //
 // Peeks into event list.  Should be called with critical section locked.
 //
@@ -432,6 +465,7 @@ RealtimeSimulatorImpl::Run()
         {
             std::unique_lock lock{m_mutex};
 
+            ProcessEventsWithContext();
             if (!m_events->IsEmpty())
             {
                 process = true;
@@ -531,6 +565,18 @@ RealtimeSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay,
 {
     NS_LOG_FUNCTION(this << context << delay << impl);
 
+    if (m_running && m_main != std::this_thread::get_id())
+    {
+        //
+        // We're pacing and have a meaningful realtime clock: hand the event
+        // to the simulator thread without taking the critical section.
+        //
+        uint64_t ts = m_synchronizer->GetCurrentRealtime() + delay.GetTimeStep();
+        m_eventsWithContext.Push(context, ts, impl);
+        m_synchronizer->Signal();
+        return;
+    }
+
     {
         std::unique_lock lock{m_mutex};
         uint64_t ts;
@@ -791,6 +837,12 @@ RealtimeSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+EventInjectionQueue::Stats
+RealtimeSimulatorImpl::GetInjectionStats() const
+{
+    return m_eventsWithContext.GetStats();
+}
+
 void
 RealtimeSimulatorImpl::SetSynchronizationMode(SynchronizationMode mode)
 {
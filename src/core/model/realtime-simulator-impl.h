@@ -9,12 +9,14 @@
 
 #include "assert.h"
 #include "event-impl.h"
+#include "event-injection-queue.h"
 #include "log.h"
 #include "ptr.h"
 #include "scheduler.h"
 #include "simulator-impl.h"
 #include "synchronizer.h"
 
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <thread>
@@ -152,6 +154,16 @@ class RealtimeSimulatorImpl : public SimulatorImpl
      */
     Time GetHardLimit() const;
 
+    /**
+     * Get the counters of the events scheduled with
+     * ScheduleWithContext() from other threads.
+     *
+     * This method must be called from the simulator thread.
+     *
+     * @returns The injection counters.
+     */
+    EventInjectionQueue::Stats GetInjectionStats() const;
+
   private:
     /**
      * Is the simulator running?
@@ -170,6 +182,11 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     uint64_t NextTs() const;
     /** Process the next event. */
     void ProcessOneEvent();
+    /**
+     * Move the events scheduled from other threads into the event list.
+     * Should be called with critical section locked.
+     */
+    void ProcessEventsWithContext();
     /** Destructor implementation. */
     void DoDispose() override;
 
@@ -180,7 +197,7 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     /** Has the stopping condition been reached? */
     bool m_stop;
     /** Is the simulator currently running. */
-    bool m_running;
+    std::atomic<bool> m_running;
 
     /**
      * @name Mutex-protected variables.
@@ -207,6 +224,12 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     /** Mutex to control access to key state. */
     mutable std::mutex m_mutex;
 
+    /**
+     * The events scheduled with ScheduleWithContext() from other threads
+     * while the simulator is running; their timestamp is absolute.
+     */
+    EventInjectionQueue m_eventsWithContext;
+
     /** The synchronizer in use to track real time. */
     Ptr<Synchronizer> m_synchronizer;
 
@@ -386,6 +386,12 @@ RngStream::RngStream(const RngStream& r)
     }
 }
 
+void
+RngStream::AdvanceSubstreams(uint64_t substreams)
+{
+    AdvanceNthBy(substreams, 76, m_currentState);
+}
+
 void
 RngStream::AdvanceNthBy(uint64_t nth, int by, double state[6])
 {
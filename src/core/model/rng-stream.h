@@ -59,6 +59,16 @@ class RngStream
      * @returns The next random.
      */
     double RandU01();
+    /**
+     * Move this stream forward by whole substreams.
+     *
+     * The values drawn from the stream after this call are those which
+     * a stream constructed with a \pname{substream} value larger by
+     * \pname{substreams} would draw after the same number of values.
+     *
+     * @param [in] substreams The number of substreams to skip.
+     */
+    void AdvanceSubstreams(uint64_t substreams);
 
   private:
     /**
@@ -0,0 +1,110 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "simulation-checkpoint.h"
+
+#include "abort.h"
+#include "fatal-error.h"
+#include "log.h"
+#include "random-variable-stream.h"
+#include "rng-seed-manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#ifndef __WIN32__
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::SimulationCheckpoint implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SimulationCheckpoint");
+
+uint32_t SimulationCheckpoint::m_failedRuns = 0;
+
+uint32_t
+SimulationCheckpoint::Fork(uint32_t runs, uint32_t jobs)
+{
+    NS_LOG_FUNCTION(runs << jobs);
+#ifdef __WIN32__
+    NS_FATAL_ERROR("SimulationCheckpoint::Fork() is not supported on Windows");
+#else
+    NS_ABORT_MSG_IF(runs == 0, "At least one run must be forked");
+    if (jobs == 0)
+    {
+        jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // Do not let the runs flush the output buffered before the fork
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    uint64_t baseRun = RngSeedManager::GetRun();
+    std::map<pid_t, uint32_t> running;
+    uint32_t next = 0;
+    m_failedRuns = 0;
+    while (next < runs || !running.empty())
+    {
+        if (next < runs && running.size() < jobs)
+        {
+            pid_t pid = ::fork();
+            NS_ABORT_MSG_IF(pid == -1, "fork() failed: " << std::strerror(errno));
+            if (pid == 0)
+            {
+                RandomVariableStream::AdvanceAllSubstreams(next);
+                RngSeedManager::SetRun(baseRun + next);
+                m_failedRuns = 0;
+                return next;
+            }
+            NS_LOG_INFO("Forked run " << next << " as process " << pid);
+            running[pid] = next++;
+            continue;
+        }
+
+        int status;
+        pid_t pid = ::waitpid(-1, &status, 0);
+        if (pid == -1)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "waitpid() failed: " << std::strerror(errno));
+            continue;
+        }
+        auto it = running.find(pid);
+        if (it == running.end())
+        {
+            // A child process not forked by us
+            continue;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            NS_LOG_WARN("Run " << it->second << " failed with status " << status);
+            m_failedRuns++;
+        }
+        running.erase(it);
+    }
+    return CHECKPOINT;
+#endif
+}
+
+uint32_t
+SimulationCheckpoint::GetFailedRuns()
+{
+    return m_failedRuns;
+}
+
+} // namespace ns3
@@ -0,0 +1,101 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef SIMULATION_CHECKPOINT_H
+#define SIMULATION_CHECKPOINT_H
+
+#include <limits>
+#include <stdint.h>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::SimulationCheckpoint declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup simulator
+ * @brief Fork several runs of a simulation from its current state.
+ *
+ * Parameter sweeps often share a long warm-up phase (association,
+ * routing convergence, TCP slow start) before the part of the
+ * simulation which is actually measured.  Fork() takes a checkpoint of
+ * the whole simulation at the end of the warm-up, and continues it in
+ * several processes: each run starts from the very same scheduler
+ * contents, nodes, channels, attribute values and random stream
+ * positions, without replaying the warm-up.
+ *
+ * The checkpoint is the memory image of the process, copied on write
+ * by the operating system, so it captures any state, including the
+ * events bound to arbitrary functions and objects, which could not be
+ * serialized:
+ *
+ * \code{.cc}
+ *   Simulator::Stop(Seconds(1800));
+ *   Simulator::Run();
+ *   uint32_t run = SimulationCheckpoint::Fork(8);
+ *   if (run == SimulationCheckpoint::CHECKPOINT)
+ *   {
+ *       // All the runs have completed
+ *       return SimulationCheckpoint::GetFailedRuns() == 0 ? 0 : 1;
+ *   }
+ *   // Configure run and its output files, then
+ *   Simulator::Stop(Seconds(600));
+ *   Simulator::Run();
+ *   Simulator::Destroy();
+ * \endcode
+ *
+ * The runs diverge through their random variables: in run \c i, all
+ * the existing streams are moved forward by \c i substreams, and the
+ * RngRun global value is incremented by \c i, so that run \c i draws
+ * the values which the streams would draw with a run number larger by
+ * \c i; run 0 continues exactly as the original simulation would have.
+ *
+ * Fork() must be called from the thread running the simulation, with
+ * a single-threaded simulator implementation (e.g., the
+ * DefaultSimulatorImpl), either between two calls to Simulator::Run()
+ * or from an event.  Files opened before the fork, such as trace files,
+ * are shared by the runs, so the per-run output should be opened after
+ * it.  This is only supported on POSIX systems.
+ */
+class SimulationCheckpoint
+{
+  public:
+    /** The value returned by Fork() in the process holding the checkpoint. */
+    static constexpr uint32_t CHECKPOINT = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * Continue the simulation in several processes.
+     *
+     * The calling process holds the checkpoint: it forks one process
+     * per run, running at most \pname{jobs} of them at a time, and waits
+     * for all of them to complete before returning.
+     *
+     * @param [in] runs The number of runs.
+     * @param [in] jobs The maximum number of concurrent runs, or 0 to
+     *             use the number of hardware threads.
+     * @returns The index of the run, in [0, \pname{runs}), in the forked
+     *          processes, and CHECKPOINT in the calling process.
+     */
+    static uint32_t Fork(uint32_t runs, uint32_t jobs = 0);
+
+    /**
+     * Get the number of runs of the last Fork() which did not exit with
+     * a zero status.
+     *
+     * @returns The number of failed runs.
+     */
+    static uint32_t GetFailedRuns();
+
+  private:
+    /** The number of failed runs of the last Fork(). */
+    static uint32_t m_failedRuns;
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_CHECKPOINT_H */
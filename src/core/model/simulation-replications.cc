@@ -0,0 +1,267 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "simulation-replications.h"
+
+#include "abort.h"
+#include "global-value.h"
+#include "log.h"
+#include "simulation-checkpoint.h"
+#include "system-path.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::SimulationReplications implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SimulationReplications");
+
+/**
+ * @ingroup simulator
+ * @brief The number of replications forked by SimulationReplications::Start().
+ */
+static GlobalValue g_replications("Replications",
+                                  "The number of independent replications of the simulation",
+                                  UintegerValue(1),
+                                  MakeUintegerChecker<uint32_t>(1));
+
+/**
+ * @ingroup simulator
+ * @brief The maximum number of replications running at the same time.
+ */
+static GlobalValue g_replicationJobs("ReplicationJobs",
+                                     "The maximum number of concurrent replications, "
+                                     "0 for the number of hardware threads",
+                                     UintegerValue(0),
+                                     MakeUintegerChecker<uint32_t>());
+
+namespace
+{
+
+/**
+ * Get the registered Mergers.
+ *
+ * @returns The Merger of each kind of output.
+ */
+std::map<std::string, SimulationReplications::Merger>&
+GetMergers()
+{
+    static std::map<std::string, SimulationReplications::Merger> mergers;
+    return mergers;
+}
+
+/**
+ * The 0.975 quantiles of the Student t distribution for 1 to 30 degrees
+ * of freedom.
+ */
+const double g_studentQuantiles[] = {
+    12.706205, 4.302653, 3.182446, 2.776445, 2.570582, 2.446912, 2.364624, 2.306004,
+    2.262157,  2.228139, 2.200985, 2.178813, 2.160369, 2.144787, 2.131450, 2.119905,
+    2.109816,  2.100922, 2.093024, 2.085963, 2.079614, 2.073873, 2.068658, 2.063899,
+    2.059539,  2.055529, 2.051831, 2.048407, 2.045230, 2.042272,
+};
+
+/**
+ * Get the 0.975 quantile of the Student t distribution.
+ *
+ * @param [in] dof The number of degrees of freedom.
+ * @returns The quantile.
+ */
+double
+GetStudentQuantile(uint32_t dof)
+{
+    if (dof <= 30)
+    {
+        return g_studentQuantiles[dof - 1];
+    }
+    // Cornish-Fisher expansion around the normal quantile
+    const double z = 1.959964;
+    double z3 = z * z * z;
+    double z5 = z3 * z * z;
+    return z + (z3 + z) / (4.0 * dof) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * dof * dof);
+}
+
+} // namespace
+
+uint32_t SimulationReplications::m_replication = SimulationReplications::NONE;
+std::string SimulationReplications::m_manifest;
+
+bool
+SimulationReplications::Start()
+{
+    UintegerValue replications;
+    UintegerValue jobs;
+    g_replications.GetValue(replications);
+    g_replicationJobs.GetValue(jobs);
+    if (replications.Get() <= 1 || m_replication != NONE)
+    {
+        return true;
+    }
+    NS_LOG_FUNCTION(replications.Get() << jobs.Get());
+    if (Fork(replications.Get(), jobs.Get()) != NONE)
+    {
+        return true;
+    }
+    uint32_t failed = GetFailedReplications();
+    std::clog << replications.Get() - failed << " of " << replications.Get()
+              << " replications completed" << std::endl;
+    return false;
+}
+
+uint32_t
+SimulationReplications::GetFailedReplications()
+{
+    return SimulationCheckpoint::GetFailedRuns();
+}
+
+uint32_t
+SimulationReplications::Fork(uint32_t replications, uint32_t jobs)
+{
+    NS_LOG_FUNCTION(replications << jobs);
+    NS_ABORT_MSG_IF(m_replication != NONE, "Replications cannot be forked by a replication");
+
+    // The temporary directory names only vary every second
+    m_manifest = SystemPath::MakeTemporaryDirectoryName() + ".replications." +
+                 std::to_string(std::random_device()());
+    SystemPath::MakeDirectories(m_manifest);
+
+    uint32_t replication = SimulationCheckpoint::Fork(replications, jobs);
+    if (replication != SimulationCheckpoint::CHECKPOINT)
+    {
+        m_replication = replication;
+        return replication;
+    }
+
+    Merge(replications);
+    std::error_code ec;
+    std::filesystem::remove_all(m_manifest, ec);
+    m_manifest.clear();
+    return NONE;
+}
+
+uint32_t
+SimulationReplications::GetReplication()
+{
+    return m_replication;
+}
+
+std::string
+SimulationReplications::GetOutputFileName(const std::string& kind, const std::string& fileName)
+{
+    NS_LOG_FUNCTION(kind << fileName);
+    if (m_replication == NONE)
+    {
+        return fileName;
+    }
+
+    // Insert the replication before the extension of the last component
+    std::string suffix = "-rep" + std::to_string(m_replication);
+    std::size_t dot = fileName.find_last_of('.');
+    std::size_t slash = fileName.find_last_of("/\\");
+    std::string name;
+    if (dot == std::string::npos || dot == 0 || (slash != std::string::npos && dot < slash + 2))
+    {
+        name = fileName + suffix;
+    }
+    else
+    {
+        name = fileName.substr(0, dot) + suffix + fileName.substr(dot);
+    }
+
+    std::ofstream manifest(m_manifest + "/" + std::to_string(m_replication), std::ios::app);
+    manifest << kind << '\t' << fileName << '\t' << name << '\n';
+    NS_ABORT_MSG_IF(!manifest, "Cannot record the output " << name);
+    return name;
+}
+
+void
+SimulationReplications::AddMerger(const std::string& kind, Merger merger)
+{
+    NS_LOG_FUNCTION(kind);
+    GetMergers()[kind] = merger;
+}
+
+void
+SimulationReplications::Merge(uint32_t replications)
+{
+    NS_LOG_FUNCTION(replications);
+
+    // The outputs of the replications, by kind and merged file name
+    std::map<std::pair<std::string, std::string>, std::vector<std::string>> outputs;
+    for (uint32_t i = 0; i < replications; ++i)
+    {
+        std::ifstream manifest(m_manifest + "/" + std::to_string(i));
+        std::string kind;
+        std::string fileName;
+        std::string name;
+        while (std::getline(manifest, kind, '\t') && std::getline(manifest, fileName, '\t') &&
+               std::getline(manifest, name))
+        {
+            auto& names = outputs[{kind, fileName}];
+            if (SystemPath::Exists(name) &&
+                std::find(names.begin(), names.end(), name) == names.end())
+            {
+                names.push_back(name);
+            }
+        }
+    }
+
+    for (const auto& [output, names] : outputs)
+    {
+        const auto& [kind, fileName] = output;
+        auto merger = GetMergers().find(kind);
+        if (merger == GetMergers().end())
+        {
+            NS_LOG_WARN("No merger for the " << kind << " output " << fileName);
+            continue;
+        }
+        NS_LOG_INFO("Merging " << names.size() << " outputs into " << fileName);
+        merger->second(fileName, names);
+    }
+}
+
+SimulationReplications::Summary
+SimulationReplications::Summarize(const std::vector<double>& values)
+{
+    Summary summary{static_cast<uint32_t>(values.size()), 0, 0, 0, 0, 0};
+    if (values.empty())
+    {
+        return summary;
+    }
+    summary.min = *std::min_element(values.begin(), values.end());
+    summary.max = *std::max_element(values.begin(), values.end());
+    for (double value : values)
+    {
+        summary.mean += value;
+    }
+    summary.mean /= values.size();
+    if (values.size() > 1)
+    {
+        double sum = 0;
+        for (double value : values)
+        {
+            sum += (value - summary.mean) * (value - summary.mean);
+        }
+        summary.stddev = std::sqrt(sum / (values.size() - 1));
+        summary.halfWidth =
+            GetStudentQuantile(values.size() - 1) * summary.stddev / std::sqrt(values.size());
+    }
+    return summary;
+}
+
+} // namespace ns3
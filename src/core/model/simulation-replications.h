@@ -0,0 +1,163 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef SIMULATION_REPLICATIONS_H
+#define SIMULATION_REPLICATIONS_H
+
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::SimulationReplications declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup simulator
+ * @brief Run independent replications of a simulation in parallel.
+ *
+ * Setting the \c Replications global value (e.g., with
+ * \c --Replications=100 on the command line) to more than one turns a
+ * simulation script calling Start() into a batch of independent
+ * replications: Start() forks the process, once the topology has been
+ * built, into one process per replication, running at most
+ * \c ReplicationJobs of them at a time (all the hardware threads by
+ * default).  Replication \c i uses the run number RngRun + \c i, as
+ * described in SimulationCheckpoint::Fork().
+ *
+ * The outputs of the replications are written to separate files, and
+ * merged once they have all completed: the models writing output files
+ * call GetOutputFileName(), which gives a replication its own file
+ * name, and register with AddMerger() the function merging the files
+ * of the replications into the file named by the script, with
+ * confidence intervals (see Summarize()).  The FlowMonitor XML files
+ * and the OmnetDataOutput files of the stats module are merged this
+ * way.  Start() then returns \c false in the initial process, which
+ * must not run the simulation, and is expected to exit:
+ *
+ * \code{.cc}
+ *   if (!SimulationReplications::Start())
+ *   {
+ *       return SimulationReplications::GetFailedReplications() == 0 ? 0 : 1;
+ *   }
+ *   Simulator::Run();
+ * \endcode
+ */
+class SimulationReplications
+{
+  public:
+    /**
+     * Merge the output files of the replications.
+     *
+     * The arguments are the name of the merged file, as requested by
+     * the script, and the names of the files of the replications.
+     */
+    using Merger = std::function<void(const std::string&, const std::vector<std::string>&)>;
+
+    /** The statistics of a value across the replications. */
+    struct Summary
+    {
+        uint32_t count;   /**< Number of replications. */
+        double mean;      /**< Sample mean. */
+        double stddev;    /**< Sample standard deviation. */
+        double min;       /**< Minimum value. */
+        double max;       /**< Maximum value. */
+        double halfWidth; /**< Half width of the 95% confidence interval of the mean. */
+    };
+
+    /** The value returned by GetReplication() outside of a replication. */
+    static constexpr uint32_t NONE = 0xffffffff;
+
+    /**
+     * Fork the replications requested by the \c Replications global
+     * value, and wait for them.
+     *
+     * @returns \c true in the processes which must run the simulation,
+     *          i.e., the replications, or the calling process if a single
+     *          replication is requested; \c false in the calling process,
+     *          once the outputs of the replications are merged.
+     */
+    static bool Start();
+
+    /**
+     * Get the number of replications which failed, in the process which
+     * forked them.
+     *
+     * @returns The number of replications of the last Fork() which
+     *          exited with a non-zero status or were killed.
+     */
+    static uint32_t GetFailedReplications();
+
+    /**
+     * Fork replications of the simulation and wait for them.
+     *
+     * @param [in] replications The number of replications.
+     * @param [in] jobs The maximum number of concurrent replications, or
+     *             0 to use the number of hardware threads.
+     * @returns The index of the replication in the forked processes, and
+     *          NONE in the calling process, once the outputs of the
+     *          replications are merged.
+     */
+    static uint32_t Fork(uint32_t replications, uint32_t jobs);
+
+    /**
+     * Get the index of the current replication.
+     *
+     * @returns The index of the replication, or NONE.
+     */
+    static uint32_t GetReplication();
+
+    /**
+     * Get the name of an output file of the current replication.
+     *
+     * Outside of a replication, the name is returned unchanged.  In
+     * replication \c i, "-rep<i>" is inserted before the extension of
+     * the file name, and the file is recorded to be merged into
+     * \pname{fileName} with the Merger of \pname{kind}.
+     *
+     * @param [in] kind The kind of output, which selects the Merger.
+     * @param [in] fileName The name of the output file.
+     * @returns The name of the file to write.
+     */
+    static std::string GetOutputFileName(const std::string& kind, const std::string& fileName);
+
+    /**
+     * Register the Merger of a kind of output.
+     *
+     * @param [in] kind The kind of output.
+     * @param [in] merger The function merging the outputs.
+     */
+    static void AddMerger(const std::string& kind, Merger merger);
+
+    /**
+     * Compute the statistics of a value across the replications.
+     *
+     * The confidence interval uses the Student t distribution.
+     *
+     * @param [in] values The value in each replication.
+     * @returns The statistics of the values.
+     */
+    static Summary Summarize(const std::vector<double>& values);
+
+  private:
+    /**
+     * Merge the outputs recorded by the replications.
+     *
+     * @param [in] replications The number of replications.
+     */
+    static void Merge(uint32_t replications);
+
+    static uint32_t m_replication; //!< The index of the current replication.
+    static std::string m_manifest; //!< The directory of the output records.
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_REPLICATIONS_H */
@@ -11,7 +11,9 @@
 
 #include "callback.h"
 
-#include <list>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 /**
  * @file
@@ -36,6 +38,21 @@ namespace ns3
  * calling the \c operator() form with the appropriate
  * number of arguments.
  *
+ * Trace sources are invoked on the hot paths of the models, and most
+ * of them are never connected: a TracedCallback is a single pointer,
+ * null until the first Callback is connected, so that invoking an
+ * unconnected trace source costs a single test.  The connected
+ * Callbacks are then stored in a contiguous array.  Callbacks can be
+ * connected and disconnected while the chain is invoked, including by
+ * the Callbacks of the chain: a Callback connected by the chain itself
+ * is invoked in the same call, a Callback disconnected before its turn
+ * is not.  The Callbacks disconnected during an invocation are only
+ * removed from the array, and released, when it returns.
+ *
+ * A trace source shared by several nodes, such as the one of a channel,
+ * may be invoked concurrently by the threads of a parallel simulator,
+ * as long as its Callbacks are not connected or disconnected meanwhile.
+ *
  * @tparam Ts \explicit Types of the functor arguments.
  */
 template <typename... Ts>
@@ -44,6 +61,27 @@ class TracedCallback
   public:
     /** Constructor. */
     TracedCallback();
+    /**
+     * Copy constructor.
+     *
+     * @param [in] o The TracedCallback to copy.
+     */
+    TracedCallback(const TracedCallback& o);
+    /**
+     * Copy assignment operator.
+     *
+     * @param [in] o The TracedCallback to copy.
+     * @returns This TracedCallback.
+     */
+    TracedCallback& operator=(const TracedCallback& o);
+    /** Move constructor. */
+    TracedCallback(TracedCallback&&) = default;
+    /**
+     * Move assignment operator.
+     *
+     * @returns This TracedCallback.
+     */
+    TracedCallback& operator=(TracedCallback&&) = default;
     /**
      * Append a Callback to the chain (without a context).
      *
@@ -98,15 +136,121 @@ class TracedCallback
 
   private:
     /**
-     * Container type for holding the chain of Callbacks.
+     * Container for holding the chain of Callbacks.
      *
-     * @tparam Ts \deduced Types of the functor arguments.
+     * While the chain is invoked, a disconnected Callback is replaced by
+     * a null Callback in the array, and kept alive until the outermost
+     * invocation returns, as it may be the one being run.
+     */
+    struct CallbackList
+    {
+        std::vector<Callback<void, Ts...>> callbacks;    //!< The chain of Callbacks.
+        std::vector<Callback<void, Ts...>> disconnected; //!< Disconnected during invocation.
+        std::atomic<uint32_t> invocations{0};            //!< Invocations running.
+    };
+
+    /** The chain of Callbacks, allocated on the first connection. */
+    std::unique_ptr<CallbackList> m_callbackList;
+};
+
+/**
+ * @ingroup tracing
+ * @brief A trace source removed at compile time.
+ *
+ * StrippedTracedCallback has the API of TracedCallback, but does
+ * nothing when invoked, so that the compiler removes the invocations
+ * and the computation of their arguments.  The trace source is still
+ * registered in the TypeId of its class, so that the Config paths
+ * naming it still resolve, but connecting a Callback to it is a fatal
+ * error, as the Callback would never be called.
+ *
+ * @tparam Ts \explicit Types of the functor arguments.
+ */
+template <typename... Ts>
+class StrippedTracedCallback
+{
+  public:
+    /**
+     * Abort, as the Callback would never be called.
+     *
+     * @param [in] callback Callback to connect.
+     */
+    void ConnectWithoutContext([[maybe_unused]] const CallbackBase& callback)
+    {
+        NS_FATAL_ERROR("Connecting to a trace source stripped by NS3_STRIP_TRACES");
+    }
+
+    /**
+     * Abort, as the Callback would never be called.
+     *
+     * @param [in] callback Callback to connect.
+     * @param [in] path Context path.
+     */
+    void Connect([[maybe_unused]] const CallbackBase& callback, std::string path)
+    {
+        NS_FATAL_ERROR("Connecting to " << path << ", a trace source stripped by NS3_STRIP_TRACES");
+    }
+
+    /**
+     * Do nothing.
+     *
+     * @param [in] callback Callback to remove.
+     */
+    void DisconnectWithoutContext([[maybe_unused]] const CallbackBase& callback)
+    {
+    }
+
+    /**
+     * Do nothing.
+     *
+     * @param [in] callback Callback to remove.
+     * @param [in] path Context path.
+     */
+    void Disconnect([[maybe_unused]] const CallbackBase& callback,
+                 [[maybe_unused]] std::string path)
+    {
+    }
+
+    /**
+     * Do nothing.
+     *
+     * @param [in] args The arguments to the functor
      */
-    typedef std::list<Callback<void, Ts...>> CallbackList;
-    /** The chain of Callbacks. */
-    CallbackList m_callbackList;
+    void operator()([[maybe_unused]] Ts... args) const
+    {
+    }
+
+    /**
+     * @brief Checks if the Callbacks list is empty.
+     * @return Always true.
+     */
+    constexpr bool IsEmpty() const
+    {
+        return true;
+    }
 };
 
+/**
+ * @ingroup tracing
+ * @brief A trace source which can be removed at compile time.
+ *
+ * The models declare as OptionalTracedCallback the trace sources which
+ * are invoked on their hot paths but not needed by the helpers (e.g.,
+ * the physical layer transmission and reception events), instead of a
+ * TracedCallback.  Configuring ns-3 with \c NS3_STRIP_TRACES turns
+ * them into StrippedTracedCallback, which removes their cost entirely
+ * but also their output.
+ *
+ * @tparam Ts \explicit Types of the functor arguments.
+ */
+#ifdef NS3_STRIP_TRACES_ENABLE
+template <typename... Ts>
+using OptionalTracedCallback = StrippedTracedCallback<Ts...>;
+#else
+template <typename... Ts>
+using OptionalTracedCallback = TracedCallback<Ts...>;
+#endif
+
 } // namespace ns3
 
 /********************************************************************
@@ -122,6 +266,35 @@ TracedCallback<Ts...>::TracedCallback()
 {
 }
 
+template <typename... Ts>
+TracedCallback<Ts...>::TracedCallback(const TracedCallback& o)
+    : m_callbackList()
+{
+    *this = o;
+}
+
+template <typename... Ts>
+TracedCallback<Ts...>&
+TracedCallback<Ts...>::operator=(const TracedCallback& o)
+{
+    if (this != &o)
+    {
+        m_callbackList.reset();
+        if (!o.IsEmpty())
+        {
+            m_callbackList = std::make_unique<CallbackList>();
+            for (const auto& cb : o.m_callbackList->callbacks)
+            {
+                if (!cb.IsNull())
+                {
+                    m_callbackList->callbacks.push_back(cb);
+                }
+            }
+        }
+    }
+    return *this;
+}
+
 template <typename... Ts>
 void
 TracedCallback<Ts...>::ConnectWithoutContext(const CallbackBase& callback)
@@ -131,7 +304,11 @@ TracedCallback<Ts...>::ConnectWithoutContext(const CallbackBase& callback)
     {
         NS_FATAL_ERROR_NO_MSG();
     }
-    m_callbackList.push_back(cb);
+    if (!m_callbackList)
+    {
+        m_callbackList = std::make_unique<CallbackList>();
+    }
+    m_callbackList->callbacks.push_back(cb);
 }
 
 template <typename... Ts>
@@ -144,23 +321,40 @@ TracedCallback<Ts...>::Connect(const CallbackBase& callback, std::string path)
         NS_FATAL_ERROR("when connecting to " << path);
     }
     Callback<void, Ts...> realCb = cb.Bind(path);
-    m_callbackList.push_back(realCb);
+    if (!m_callbackList)
+    {
+        m_callbackList = std::make_unique<CallbackList>();
+    }
+    m_callbackList->callbacks.push_back(realCb);
 }
 
 template <typename... Ts>
 void
 TracedCallback<Ts...>::DisconnectWithoutContext(const CallbackBase& callback)
 {
-    for (auto i = m_callbackList.begin(); i != m_callbackList.end(); /* empty */)
+    // The array is kept when it becomes empty, as the chain may be
+    // being invoked
+    if (!m_callbackList)
     {
-        if ((*i).IsEqual(callback))
+        return;
+    }
+    CallbackList& list = *m_callbackList;
+    for (auto i = list.callbacks.begin(); i != list.callbacks.end(); /* empty */)
+    {
+        if (i->IsNull() || !i->IsEqual(callback))
         {
-            i = m_callbackList.erase(i);
+            i++;
         }
-        else
+        else if (list.invocations.load(std::memory_order_relaxed) > 0)
         {
+            list.disconnected.push_back(*i);
+            *i = Callback<void, Ts...>();
             i++;
         }
+        else
+        {
+            i = list.callbacks.erase(i);
+        }
     }
 }
 
@@ -181,9 +375,25 @@ template <typename... Ts>
 void
 TracedCallback<Ts...>::operator()(Ts... args) const
 {
-    for (auto i = m_callbackList.begin(); i != m_callbackList.end(); i++)
+    if (!m_callbackList)
+    {
+        return;
+    }
+    // Index the array, which the Callbacks may extend
+    CallbackList& list = *m_callbackList;
+    list.invocations.fetch_add(1, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < list.callbacks.size(); i++)
+    {
+        if (!list.callbacks[i].IsNull())
+        {
+            list.callbacks[i](args...);
+        }
+    }
+    if (list.invocations.fetch_sub(1, std::memory_order_relaxed) == 1 &&
+        !list.disconnected.empty())
     {
-        (*i)(args...);
+        std::erase_if(list.callbacks, [](const auto& cb) { return cb.IsNull(); });
+        list.disconnected.clear();
     }
 }
 
@@ -191,7 +401,8 @@ template <typename... Ts>
 bool
 TracedCallback<Ts...>::IsEmpty() const
 {
-    return m_callbackList.empty();
+    return !m_callbackList ||
+           m_callbackList->callbacks.size() == m_callbackList->disconnected.size();
 }
 
 } // namespace ns3
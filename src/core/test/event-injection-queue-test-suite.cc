@@ -0,0 +1,138 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/event-injection-queue.h"
+#include "ns3/make-event.h"
+#include "ns3/test.h"
+
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup core-tests
+ * EventInjectionQueue test suite.
+ */
+
+/**
+ * @ingroup core-tests
+ * @defgroup event-injection-queue-tests EventInjectionQueue test suite
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup event-injection-queue-tests
+ *
+ * @brief Check that the events pushed by several threads are all
+ * popped, in order for each thread, both when they fit in the ring
+ * and when they overflow it.
+ */
+class EventInjectionQueueTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param capacity The ring capacity.
+     * @param consumeWhilePushing Whether to pop the events while the
+     *        producers are running, or only after they have finished.
+     */
+    EventInjectionQueueTestCase(uint32_t capacity, bool consumeWhilePushing);
+
+  private:
+    void DoRun() override;
+
+    uint32_t m_capacity;        //!< The ring capacity.
+    bool m_consumeWhilePushing; //!< Whether to pop the events concurrently.
+};
+
+EventInjectionQueueTestCase::EventInjectionQueueTestCase(uint32_t capacity,
+                                                         bool consumeWhilePushing)
+    : TestCase("Capacity " + std::to_string(capacity) +
+               (consumeWhilePushing ? ", concurrent consumer" : ", deferred consumer")),
+      m_capacity(capacity),
+      m_consumeWhilePushing(consumeWhilePushing)
+{
+}
+
+void
+EventInjectionQueueTestCase::DoRun()
+{
+    const uint32_t nThreads = 4;
+    const uint32_t nEvents = 5000;
+    EventInjectionQueue queue(m_capacity);
+
+    std::vector<std::thread> producers;
+    for (uint32_t t = 0; t < nThreads; ++t)
+    {
+        producers.emplace_back([&queue, t]() {
+            for (uint32_t i = 0; i < nEvents; ++i)
+            {
+                queue.Push(t, i, MakeEvent([]() {}));
+            }
+        });
+    }
+
+    std::vector<uint64_t> next(nThreads, 0);
+    uint64_t popped = 0;
+    bool inOrder = true;
+    auto drain = [&]() {
+        EventInjectionQueue::Entry entry;
+        while (queue.Pop(entry))
+        {
+            inOrder = inOrder && entry.timestamp == next[entry.context];
+            next[entry.context] = entry.timestamp + 1;
+            entry.event->Unref();
+            popped++;
+        }
+    };
+    if (m_consumeWhilePushing)
+    {
+        while (popped < nThreads * nEvents)
+        {
+            drain();
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    drain();
+
+    NS_TEST_EXPECT_MSG_EQ(inOrder, true, "Events of a thread popped out of order");
+    NS_TEST_EXPECT_MSG_EQ(popped, nThreads * nEvents, "Wrong number of events popped");
+    NS_TEST_EXPECT_MSG_EQ(queue.IsEmpty(), true, "Queue not empty after draining");
+
+    auto stats = queue.GetStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.events, popped, "Wrong event counter");
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(stats.meanLatency, stats.maxLatency, "Inconsistent latency");
+    if (!m_consumeWhilePushing)
+    {
+        NS_TEST_EXPECT_MSG_EQ(stats.overflows,
+                              nThreads * nEvents - m_capacity,
+                              "Wrong overflow counter");
+    }
+}
+
+/**
+ * @ingroup event-injection-queue-tests
+ *
+ * @brief EventInjectionQueue test suite.
+ */
+class EventInjectionQueueTestSuite : public TestSuite
+{
+  public:
+    EventInjectionQueueTestSuite()
+        : TestSuite("event-injection-queue")
+    {
+        AddTestCase(new EventInjectionQueueTestCase(64, true), TestCase::Duration::QUICK);
+        AddTestCase(new EventInjectionQueueTestCase(1024, false), TestCase::Duration::QUICK);
+        AddTestCase(new EventInjectionQueueTestCase(1 << 15, true), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization
+static EventInjectionQueueTestSuite g_eventInjectionQueueTestSuite;
@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/rng-stream.h"
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup core-tests
+ * SimulationCheckpoint test suite.
+ */
+
+/**
+ * @ingroup core-tests
+ * @defgroup simulation-checkpoint-tests SimulationCheckpoint test suite
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup simulation-checkpoint-tests
+ *
+ * @brief Check that advancing a stream by whole substreams is the same
+ * as constructing it with a larger substream value.
+ */
+class RngStreamAdvanceTestCase : public TestCase
+{
+  public:
+    RngStreamAdvanceTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RngStreamAdvanceTestCase::RngStreamAdvanceTestCase()
+    : TestCase("Check RngStream::AdvanceSubstreams")
+{
+}
+
+void
+RngStreamAdvanceTestCase::DoRun()
+{
+    RngStream advanced(1, 42, 2);
+    advanced.AdvanceSubstreams(5);
+    RngStream expected(1, 42, 7);
+    for (int i = 0; i < 10; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(advanced.RandU01(), expected.RandU01(), "Wrong value " << i);
+    }
+}
+
+/**
+ * @ingroup simulation-checkpoint-tests
+ *
+ * @brief Check that the runs forked from a checkpoint share the state
+ * of the simulation and diverge through their random variables.
+ */
+class SimulationCheckpointForkTestCase : public TestCase
+{
+  public:
+    SimulationCheckpointForkTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Draw the values of a run.
+     *
+     * @param [in] variable A variable created before the fork.
+     * @returns The simulation time and the values drawn from
+     *          \pname{variable} and from a variable created after the fork.
+     */
+    std::vector<double> Draw(Ptr<UniformRandomVariable> variable);
+};
+
+SimulationCheckpointForkTestCase::SimulationCheckpointForkTestCase()
+    : TestCase("Check SimulationCheckpoint::Fork")
+{
+}
+
+std::vector<double>
+SimulationCheckpointForkTestCase::Draw(Ptr<UniformRandomVariable> variable)
+{
+    Simulator::Run();
+    std::vector<double> values{Simulator::Now().GetSeconds()};
+    auto created = CreateObject<UniformRandomVariable>();
+    for (int i = 0; i < 4; ++i)
+    {
+        values.push_back(variable->GetValue());
+        values.push_back(created->GetValue());
+    }
+    return values;
+}
+
+void
+SimulationCheckpointForkTestCase::DoRun()
+{
+    const uint32_t runs = 3;
+    uint64_t baseRun = RngSeedManager::GetRun();
+    auto variable = CreateObject<UniformRandomVariable>();
+
+    // Warm-up: some events draw values, one event is left pending
+    for (int i = 1; i <= 5; ++i)
+    {
+        Simulator::Schedule(Seconds(i), [variable]() { variable->GetValue(); });
+    }
+    Simulator::Schedule(Seconds(20), []() {});
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    uint32_t run = SimulationCheckpoint::Fork(runs, 2);
+    if (run != SimulationCheckpoint::CHECKPOINT)
+    {
+        std::ofstream os(CreateTempDirFilename("run-" + std::to_string(run)));
+        os.precision(17);
+        os << RngSeedManager::GetRun() - baseRun << std::endl;
+        for (double value : Draw(variable))
+        {
+            os << value << std::endl;
+        }
+        os.close();
+        // Exit the forked test runner; the last run reports a failure
+        std::_Exit(run == runs - 1 ? 3 : 0);
+    }
+
+    NS_TEST_EXPECT_MSG_EQ(SimulationCheckpoint::GetFailedRuns(), 1, "Wrong number of failures");
+    NS_TEST_EXPECT_MSG_EQ(RngSeedManager::GetRun(), baseRun, "Run number changed");
+
+    // The checkpoint continues exactly as run 0
+    std::vector<double> expected = Draw(variable);
+    Simulator::Destroy();
+
+    std::vector<std::vector<double>> values(runs);
+    for (uint32_t i = 0; i < runs; ++i)
+    {
+        std::ifstream is(CreateTempDirFilename("run-" + std::to_string(i)));
+        NS_TEST_ASSERT_MSG_EQ(is.is_open(), true, "Run " << i << " wrote no output");
+        uint64_t runOffset;
+        is >> runOffset;
+        NS_TEST_EXPECT_MSG_EQ(runOffset, i, "Wrong run number in run " << i);
+        double value;
+        while (is >> value)
+        {
+            values[i].push_back(value);
+        }
+        NS_TEST_ASSERT_MSG_EQ(values[i].size(), expected.size(), "Wrong output of run " << i);
+        NS_TEST_EXPECT_MSG_EQ(values[i][0], 20, "Pending event lost in run " << i);
+    }
+    for (std::size_t j = 0; j < expected.size(); ++j)
+    {
+        NS_TEST_EXPECT_MSG_EQ(values[0][j], expected[j], "Run 0 diverged at " << j);
+    }
+    for (std::size_t j = 1; j < expected.size(); ++j)
+    {
+        NS_TEST_EXPECT_MSG_NE(values[1][j], values[0][j], "Runs 0 and 1 equal at " << j);
+        NS_TEST_EXPECT_MSG_NE(values[2][j], values[1][j], "Runs 1 and 2 equal at " << j);
+    }
+}
+
+/**
+ * @ingroup simulation-checkpoint-tests
+ *
+ * @brief SimulationCheckpoint test suite.
+ */
+class SimulationCheckpointTestSuite : public TestSuite
+{
+  public:
+    SimulationCheckpointTestSuite()
+        : TestSuite("simulation-checkpoint")
+    {
+        AddTestCase(new RngStreamAdvanceTestCase(), TestCase::Duration::QUICK);
+#ifndef __WIN32__
+        AddTestCase(new SimulationCheckpointForkTestCase(), TestCase::Duration::QUICK);
+#endif
+    }
+};
+
+/// Static variable for test initialization
+static SimulationCheckpointTestSuite g_simulationCheckpointTestSuite;
@@ -0,0 +1,173 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/config.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulation-replications.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup core-tests
+ * SimulationReplications test suite.
+ */
+
+/**
+ * @ingroup core-tests
+ * @defgroup simulation-replications-tests SimulationReplications test suite
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup simulation-replications-tests
+ *
+ * @brief Check the confidence intervals of the merged outputs.
+ */
+class SimulationReplicationsSummaryTestCase : public TestCase
+{
+  public:
+    SimulationReplicationsSummaryTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SimulationReplicationsSummaryTestCase::SimulationReplicationsSummaryTestCase()
+    : TestCase("Check SimulationReplications::Summarize")
+{
+}
+
+void
+SimulationReplicationsSummaryTestCase::DoRun()
+{
+    auto summary = SimulationReplications::Summarize({2, 4, 1, 5, 3});
+    NS_TEST_EXPECT_MSG_EQ(summary.count, 5, "Wrong count");
+    NS_TEST_EXPECT_MSG_EQ_TOL(summary.mean, 3, 1e-12, "Wrong mean");
+    NS_TEST_EXPECT_MSG_EQ_TOL(summary.stddev, 1.581139, 1e-6, "Wrong standard deviation");
+    NS_TEST_EXPECT_MSG_EQ(summary.min, 1, "Wrong minimum");
+    NS_TEST_EXPECT_MSG_EQ(summary.max, 5, "Wrong maximum");
+    NS_TEST_EXPECT_MSG_EQ_TOL(summary.halfWidth, 1.963243, 1e-5, "Wrong confidence interval");
+
+    std::vector<double> values(100);
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = i % 2;
+    }
+    summary = SimulationReplications::Summarize(values);
+    // t(99) = 1.9842
+    NS_TEST_EXPECT_MSG_EQ_TOL(summary.halfWidth, 1.9842 * 0.502519 / 10, 1e-4, "Wrong interval");
+
+    summary = SimulationReplications::Summarize({7});
+    NS_TEST_EXPECT_MSG_EQ(summary.mean, 7, "Wrong mean of a single value");
+    NS_TEST_EXPECT_MSG_EQ(summary.halfWidth, 0, "Wrong interval of a single value");
+}
+
+/**
+ * @ingroup simulation-replications-tests
+ *
+ * @brief Check that the outputs of the replications are merged.
+ */
+class SimulationReplicationsForkTestCase : public TestCase
+{
+  public:
+    SimulationReplicationsForkTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SimulationReplicationsForkTestCase::SimulationReplicationsForkTestCase()
+    : TestCase("Check SimulationReplications::Start")
+{
+}
+
+void
+SimulationReplicationsForkTestCase::DoRun()
+{
+    const uint32_t replications = 3;
+    uint64_t baseRun = RngSeedManager::GetRun();
+    std::string fileName = CreateTempDirFilename("output.txt");
+    NS_TEST_EXPECT_MSG_EQ(SimulationReplications::GetOutputFileName("test", fileName),
+                          fileName,
+                          "Output renamed outside of a replication");
+
+    std::string merged;
+    std::vector<std::string> inputs;
+    SimulationReplications::AddMerger(
+        "test",
+        [&merged, &inputs](const std::string& output, const std::vector<std::string>& names) {
+            merged = output;
+            inputs = names;
+        });
+
+    // A single replication runs in the calling process
+    NS_TEST_EXPECT_MSG_EQ(SimulationReplications::Start(), true, "Single replication not run");
+    NS_TEST_EXPECT_MSG_EQ(SimulationReplications::GetReplication(),
+                          SimulationReplications::NONE,
+                          "Replication forked");
+
+    Config::SetGlobal("Replications", UintegerValue(replications));
+    Config::SetGlobal("ReplicationJobs", UintegerValue(2));
+    bool run = SimulationReplications::Start();
+    Config::SetGlobal("Replications", UintegerValue(1));
+    Config::SetGlobal("ReplicationJobs", UintegerValue(0));
+    if (run)
+    {
+        uint32_t replication = SimulationReplications::GetReplication();
+        std::ofstream os(SimulationReplications::GetOutputFileName("test", fileName));
+        os << replication << " " << RngSeedManager::GetRun() - baseRun << std::endl;
+        os.close();
+        // Outputs without merger are ignored
+        SimulationReplications::GetOutputFileName("unknown", fileName);
+        std::_Exit(0);
+    }
+
+    NS_TEST_EXPECT_MSG_EQ(SimulationReplications::GetReplication(),
+                          SimulationReplications::NONE,
+                          "Replication index set in the initial process");
+    NS_TEST_EXPECT_MSG_EQ(SimulationReplications::GetFailedReplications(),
+                          0,
+                          "Replications failed");
+    NS_TEST_EXPECT_MSG_EQ(merged, fileName, "Wrong merged output");
+    NS_TEST_ASSERT_MSG_EQ(inputs.size(), replications, "Wrong number of outputs");
+    for (uint32_t i = 0; i < replications; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(inputs[i],
+                              CreateTempDirFilename("output-rep" + std::to_string(i) + ".txt"),
+                              "Wrong output name of replication " << i);
+        std::ifstream is(inputs[i]);
+        uint32_t index = replications;
+        uint64_t runOffset = 0;
+        is >> index >> runOffset;
+        NS_TEST_EXPECT_MSG_EQ(index, i, "Wrong output of replication " << i);
+        NS_TEST_EXPECT_MSG_EQ(runOffset, i, "Wrong run number of replication " << i);
+    }
+}
+
+/**
+ * @ingroup simulation-replications-tests
+ *
+ * @brief SimulationReplications test suite.
+ */
+class SimulationReplicationsTestSuite : public TestSuite
+{
+  public:
+    SimulationReplicationsTestSuite()
+        : TestSuite("simulation-replications")
+    {
+        AddTestCase(new SimulationReplicationsSummaryTestCase(), TestCase::Duration::QUICK);
+#ifndef __WIN32__
+        AddTestCase(new SimulationReplicationsForkTestCase(), TestCase::Duration::QUICK);
+#endif
+    }
+};
+
+/// Static variable for test initialization
+static SimulationReplicationsTestSuite g_simulationReplicationsTestSuite;
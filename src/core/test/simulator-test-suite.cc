@@ -6,13 +6,19 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/default-simulator-impl.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/quaternary-heap-scheduler.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
 
+#include <fstream>
+#include <sstream>
+
 using namespace ns3;
 
 /**
@@ -703,6 +709,79 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check that the event profiler of DefaultSimulatorImpl names
+ * the functions run by the events and the nodes running them.
+ */
+class SimulatorEventProfileTestCase : public TestCase
+{
+  public:
+    SimulatorEventProfileTestCase();
+
+    /**
+     * Test event.
+     * @param value Event parameter.
+     */
+    void EventA(int value);
+
+  private:
+    void DoRun() override;
+};
+
+SimulatorEventProfileTestCase::SimulatorEventProfileTestCase()
+    : TestCase("Check the event profile")
+{
+}
+
+void
+SimulatorEventProfileTestCase::EventA(int /* value */)
+{
+}
+
+/** Test event. */
+static void
+ProfiledEvent()
+{
+}
+
+void
+SimulatorEventProfileTestCase::DoRun()
+{
+    std::string file = CreateTempDirFilename("events.folded");
+    ObjectFactory factory;
+    factory.SetTypeId(DefaultSimulatorImpl::GetTypeId());
+    factory.Set("EventProfile", StringValue(file));
+    Simulator::SetImplementation(factory.Create<SimulatorImpl>());
+
+    Simulator::ScheduleWithContext(3, Seconds(1), &SimulatorEventProfileTestCase::EventA, this, 1);
+    Simulator::ScheduleWithContext(3, Seconds(2), &SimulatorEventProfileTestCase::EventA, this, 2);
+    Simulator::ScheduleWithContext(7, Seconds(3), &ProfiledEvent);
+    Simulator::Schedule(Seconds(4), []() {});
+    Simulator::Run();
+    Simulator::Destroy();
+
+    std::ifstream is(file);
+    NS_TEST_ASSERT_MSG_EQ(is.is_open(), true, "The event profile was not written");
+    std::ostringstream report;
+    report << is.rdbuf();
+    std::string text = report.str();
+    NS_TEST_EXPECT_MSG_NE(text.find("SimulatorEventProfileTestCase::EventA(int);node 3 "),
+                          std::string::npos,
+                          "Class method not found in " << text);
+    // ProfiledEvent() has internal linkage, so it is not in the dynamic symbol table
+    NS_TEST_EXPECT_MSG_NE(text.find("void (*)() ["),
+                          std::string::npos,
+                          "Function not found in " << text);
+    NS_TEST_EXPECT_MSG_NE(text.find("];node 7 "),
+                          std::string::npos,
+                          "Function not found in " << text);
+    NS_TEST_EXPECT_MSG_NE(text.find("no context"),
+                          std::string::npos,
+                          "Event without context not found in " << text);
+}
+
 /**
  * @ingroup simulator-tests
  *
@@ -726,6 +805,9 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+        factory.SetTypeId(QuaternaryHeapScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+        AddTestCase(new SimulatorEventProfileTestCase(), TestCase::Duration::QUICK);
     }
 };
 
@@ -7,6 +7,9 @@
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 
+#include <memory>
+#include <utility>
+
 using namespace ns3;
 
 /**
@@ -122,6 +125,143 @@ BasicTracedCallbackTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(m_two, true, "Callback CbTwo not called");
 }
 
+/**
+ * @ingroup tracedcallback-tests
+ *
+ * TracedCallback Test case, check the storage of the chain of Callbacks
+ * and the stripped trace sources.
+ */
+class ChainTracedCallbackTestCase : public TestCase
+{
+  public:
+    ChainTracedCallbackTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback counting its calls.
+     * @param value The value traced.
+     */
+    void Count(uint32_t value);
+
+    /**
+     * Callback counting its calls with a context.
+     * @param context The context.
+     * @param value The value traced.
+     */
+    void CountWithContext(std::string context, uint32_t value);
+
+    uint32_t m_count; //!< The number of calls of the Callbacks.
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase()
+    : TestCase("Check the TracedCallback chain storage")
+{
+}
+
+void
+ChainTracedCallbackTestCase::Count(uint32_t /* value */)
+{
+    m_count++;
+}
+
+void
+ChainTracedCallbackTestCase::CountWithContext(std::string context, uint32_t /* value */)
+{
+    NS_TEST_EXPECT_MSG_EQ(context, "path", "Wrong context");
+    m_count++;
+}
+
+void
+ChainTracedCallbackTestCase::DoRun()
+{
+    // An unconnected trace source is a null pointer
+    TracedCallback<uint32_t> trace;
+    NS_TEST_EXPECT_MSG_EQ(sizeof(trace), sizeof(void*), "TracedCallback not compact");
+    NS_TEST_EXPECT_MSG_EQ(trace.IsEmpty(), true, "Trace source not empty");
+    m_count = 0;
+    trace(1);
+    NS_TEST_EXPECT_MSG_EQ(m_count, 0, "Callback unexpectedly called");
+
+    // A Callback connected by the chain is invoked in the same call
+    auto count = MakeCallback(&ChainTracedCallbackTestCase::Count, this);
+    Callback<void, uint32_t> connect([&trace, count](uint32_t) {
+        for (int i = 0; i < 8; ++i)
+        {
+            trace.ConnectWithoutContext(count);
+        }
+    });
+    trace.ConnectWithoutContext(connect);
+    trace(1);
+    NS_TEST_EXPECT_MSG_EQ(m_count, 8, "Callbacks connected by the chain not called");
+    trace.DisconnectWithoutContext(connect);
+    trace.Connect(MakeCallback(&ChainTracedCallbackTestCase::CountWithContext, this), "path");
+
+    // Copies have their own chain
+    TracedCallback<uint32_t> copy = trace;
+    trace.DisconnectWithoutContext(count);
+    m_count = 0;
+    copy(1);
+    NS_TEST_EXPECT_MSG_EQ(m_count, 9, "Wrong number of calls of the copy");
+    m_count = 0;
+    trace(1);
+    NS_TEST_EXPECT_MSG_EQ(m_count, 1, "Wrong number of calls");
+    trace.Disconnect(MakeCallback(&ChainTracedCallbackTestCase::CountWithContext, this), "path");
+    NS_TEST_EXPECT_MSG_EQ(trace.IsEmpty(), true, "Trace source not empty");
+
+    // A Callback disconnecting itself is kept alive until the invocation
+    // returns, and the next Callback is still invoked
+    uint32_t selfCalls = 0;
+    Callback<void, uint32_t> self;
+    std::weak_ptr<int> selfToken;
+    {
+        auto token = std::make_shared<int>(0);
+        selfToken = token;
+        self = Callback<void, uint32_t>([this, &trace, &self, &selfCalls, &selfToken, token](
+                                            uint32_t) {
+            selfCalls++;
+            {
+                auto cb = std::exchange(self, Callback<void, uint32_t>());
+                trace.DisconnectWithoutContext(cb);
+            }
+            NS_TEST_EXPECT_MSG_EQ(selfToken.expired(), false, "Running Callback released");
+        });
+    }
+    trace.ConnectWithoutContext(self);
+    trace.ConnectWithoutContext(count);
+    m_count = 0;
+    trace(1);
+    NS_TEST_EXPECT_MSG_EQ(selfCalls, 1, "Wrong number of calls of the Callback");
+    NS_TEST_EXPECT_MSG_EQ(m_count, 1, "Callback following a disconnected one not called");
+    NS_TEST_EXPECT_MSG_EQ(selfToken.expired(), true, "Disconnected Callback not released");
+    trace(1);
+    NS_TEST_EXPECT_MSG_EQ(selfCalls, 1, "Disconnected Callback called");
+    NS_TEST_EXPECT_MSG_EQ(m_count, 2, "Wrong number of calls");
+
+    // A Callback disconnected by the chain before its turn is not invoked
+    Callback<void, uint32_t> disconnect([this, &trace, count](uint32_t) {
+        trace.DisconnectWithoutContext(count);
+        NS_TEST_EXPECT_MSG_EQ(trace.IsEmpty(), false, "Trace source empty");
+    });
+    trace.DisconnectWithoutContext(count);
+    trace.ConnectWithoutContext(disconnect);
+    trace.ConnectWithoutContext(count);
+    m_count = 0;
+    trace(1);
+    NS_TEST_EXPECT_MSG_EQ(m_count, 0, "Disconnected Callback called");
+    trace.DisconnectWithoutContext(disconnect);
+    NS_TEST_EXPECT_MSG_EQ(trace.IsEmpty(), true, "Trace source not empty");
+
+    // Stripped trace sources do nothing; connecting to them is a fatal error
+    StrippedTracedCallback<uint32_t> stripped;
+    stripped.DisconnectWithoutContext(count);
+    m_count = 0;
+    stripped(1);
+    NS_TEST_EXPECT_MSG_EQ(m_count, 0, "Stripped trace source called a Callback");
+    NS_TEST_EXPECT_MSG_EQ(stripped.IsEmpty(), true, "Stripped trace source not empty");
+}
+
 /**
  * @ingroup tracedcallback-tests
  *
@@ -137,6 +277,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite()
     : TestSuite("traced-callback", Type::UNIT)
 {
     AddTestCase(new BasicTracedCallbackTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new ChainTracedCallbackTestCase, TestCase::Duration::QUICK);
 }
 
 static TracedCallbackTestSuite
@@ -211,6 +211,44 @@ CsmaHelper::EnableAsciiInternal(Ptr<OutputStreamWrapper> stream,
                     MakeBoundCallback(&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+CsmaHelper::EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd)
+{
+    Ptr<CsmaNetDevice> device = nd->GetObject<CsmaNetDevice>();
+    if (!device)
+    {
+        NS_LOG_INFO("Device " << device << " not of type ns3::CsmaNetDevice");
+        return;
+    }
+
+    //
+    // The same events as the ascii traces, without packet printing.
+    //
+    BinaryTraceHelper binaryTraceHelper;
+    binaryTraceHelper.HookDefaultSink<CsmaNetDevice>(device,
+                                                     "MacRx",
+                                                     file,
+                                                     BinaryTraceRecord::RECEIVE,
+                                                     device);
+
+    Ptr<Queue<Packet>> queue = device->GetQueue();
+    binaryTraceHelper.HookDefaultSink<Queue<Packet>>(queue,
+                                                     "Enqueue",
+                                                     file,
+                                                     BinaryTraceRecord::ENQUEUE,
+                                                     device);
+    binaryTraceHelper.HookDefaultSink<Queue<Packet>>(queue,
+                                                     "Drop",
+                                                     file,
+                                                     BinaryTraceRecord::DROP,
+                                                     device);
+    binaryTraceHelper.HookDefaultSink<Queue<Packet>>(queue,
+                                                     "Dequeue",
+                                                     file,
+                                                     BinaryTraceRecord::DEQUEUE,
+                                                     device);
+}
+
 NetDeviceContainer
 CsmaHelper::Install(Ptr<Node> node) const
 {
@@ -28,12 +28,14 @@ class Packet;
  * @brief build a set of CsmaNetDevice objects
  *
  * Normally we eschew multiple inheritance, however, the classes
- * PcapUserHelperForDevice and AsciiTraceUserHelperForDevice are
- * treated as "mixins".  A mixin is a self-contained class that
+ * PcapUserHelperForDevice, AsciiTraceUserHelperForDevice and
+ * BinaryTraceHelperForDevice are treated as "mixins".  A mixin is a self-contained class that
  * encapsulates a general attribute or a set of functionality that
  * may be of interest to many other classes.
  */
-class CsmaHelper : public PcapHelperForDevice, public AsciiTraceHelperForDevice
+class CsmaHelper : public PcapHelperForDevice,
+                   public AsciiTraceHelperForDevice,
+                   public BinaryTraceHelperForDevice
 {
   public:
     /**
@@ -243,6 +245,17 @@ class CsmaHelper : public PcapHelperForDevice, public AsciiTraceHelperForDevice
                              Ptr<NetDevice> nd,
                              bool explicitFilename) override;
 
+    /**
+     * @brief Enable binary trace output on the indicated net device.
+     *
+     * NetDevice-specific implementation mechanism for hooking the trace and
+     * writing to the trace file.
+     *
+     * @param file The binary trace writer.
+     * @param nd Net device for which you want to enable tracing.
+     */
+    void EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd) override;
+
     ObjectFactory m_queueFactory;   //!< factory for the queues
     ObjectFactory m_deviceFactory;  //!< factory for the NetDevices
     ObjectFactory m_channelFactory; //!< factory for the channel
@@ -10,11 +10,14 @@
 
 #include "ns3/double.h"
 #include "ns3/log.h"
+#include "ns3/simulation-replications.h"
 #include "ns3/simulator.h"
 
 #include <fstream>
 #include <limits>
+#include <set>
 #include <sstream>
+#include <string>
 
 #define PERIODIC_CHECK_INTERVAL (Seconds(1))
 
@@ -521,12 +524,197 @@ void
 FlowMonitor::SerializeToXmlFile(std::string fileName, bool enableHistograms, bool enableProbes)
 {
     NS_LOG_FUNCTION(this << fileName << enableHistograms << enableProbes);
-    std::ofstream os(fileName, std::ios::out | std::ios::binary);
+    std::ofstream os(SimulationReplications::GetOutputFileName("FlowMonitor", fileName),
+                     std::ios::out | std::ios::binary);
     os << "<?xml version=\"1.0\" ?>\n";
     SerializeToXmlStream(os, 0, enableHistograms, enableProbes);
     os.close();
 }
 
+/**
+ * Parse the attributes of an XML element written by the FlowMonitor.
+ *
+ * @param line The line of the element.
+ * @returns The name and value of each attribute.
+ */
+static std::vector<std::pair<std::string, std::string>>
+ParseXmlAttributes(const std::string& line)
+{
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::size_t pos = 0;
+    while (true)
+    {
+        std::size_t equal = line.find("=\"", pos);
+        if (equal == std::string::npos)
+        {
+            break;
+        }
+        std::size_t start = line.find_last_of(" \t", equal) + 1;
+        std::size_t end = line.find('"', equal + 2);
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        attributes.emplace_back(line.substr(start, equal - start),
+                                line.substr(equal + 2, end - equal - 2));
+        pos = end + 1;
+    }
+    return attributes;
+}
+
+void
+FlowMonitor::MergeReplications(const std::string& output, const std::vector<std::string>& inputs)
+{
+    NS_LOG_FUNCTION(output << inputs.size());
+
+    // The flow ids depend on the order in which each replication saw the
+    // flows, so the flows are matched by their classifier and attributes
+    // (e.g., the 5-tuple), in order of first appearance
+    std::vector<std::pair<std::string, std::string>> flows;
+    std::map<std::pair<std::string, std::string>, std::size_t> flowIndexes;
+    // The values of the statistics of each flow, in order of appearance
+    std::vector<std::vector<std::string>> names;
+    std::vector<std::map<std::string, std::vector<double>>> values;
+    for (const auto& input : inputs)
+    {
+        std::ifstream is(input);
+        std::string line;
+        bool inFlowStats = false;
+        std::string classifier;
+        FlowId flowId = 0;
+        // The statistics of each flow of the file, and its classifier entry
+        std::map<FlowId, std::vector<std::pair<std::string, double>>> statistics;
+        std::map<FlowId, std::pair<std::string, std::string>> classified;
+        while (std::getline(is, line))
+        {
+            std::size_t first = line.find_first_not_of(' ');
+            std::string element = first == std::string::npos ? "" : line.substr(first);
+            auto attributes = ParseXmlAttributes(element);
+            if (element.starts_with("<FlowStats>"))
+            {
+                inFlowStats = true;
+            }
+            else if (element.starts_with("</FlowStats>"))
+            {
+                inFlowStats = false;
+            }
+            else if (element.find("FlowClassifier>") != std::string::npos)
+            {
+                classifier = element.starts_with("</") ? "" : element.substr(1, element.size() - 2);
+            }
+            else if (element.starts_with("<Flow ") && !attributes.empty() &&
+                     (inFlowStats || !classifier.empty()))
+            {
+                flowId = std::stoul(attributes[0].second);
+                if (!classifier.empty())
+                {
+                    // The attributes of the flow but its id
+                    std::string key = element.substr(element.find(' ', 6) + 1);
+                    key = key.substr(0, key.find_last_not_of("/> ") + 1);
+                    classified.emplace(flowId, std::make_pair(classifier, key));
+                    continue;
+                }
+                for (std::size_t j = 1; j < attributes.size(); ++j)
+                {
+                    // Times are written as "+1.5e+09ns"
+                    statistics[flowId].emplace_back(
+                        attributes[j].first,
+                        std::strtod(attributes[j].second.c_str(), nullptr));
+                }
+            }
+            else if (inFlowStats &&
+                     (element.starts_with("<packetsDropped ") ||
+                      element.starts_with("<bytesDropped ")) &&
+                     attributes.size() == 2)
+            {
+                std::string name = element.substr(1, element.find(' ') - 1);
+                statistics[flowId].emplace_back(name + "." + attributes[0].second,
+                                                std::strtod(attributes[1].second.c_str(), nullptr));
+            }
+            else if (!classifier.empty() && element.starts_with("<Dscp ") &&
+                     attributes.size() == 2)
+            {
+                statistics[flowId].emplace_back("dscp." + attributes[0].second,
+                                                std::strtod(attributes[1].second.c_str(), nullptr));
+            }
+        }
+
+        for (const auto& [id, flowStatistics] : statistics)
+        {
+            auto entry = classified.find(id);
+            NS_ABORT_MSG_IF(entry == classified.end(),
+                            "Flow " << id << " of " << input << " has no classifier entry");
+            auto [index, inserted] = flowIndexes.emplace(entry->second, flows.size());
+            if (inserted)
+            {
+                flows.push_back(entry->second);
+                names.emplace_back();
+                values.emplace_back();
+            }
+            for (const auto& [name, value] : flowStatistics)
+            {
+                auto [it, added] = values[index->second].emplace(name, std::vector<double>());
+                if (added)
+                {
+                    names[index->second].push_back(name);
+                }
+                it->second.push_back(value);
+            }
+        }
+    }
+
+    // The merged flows are numbered in order of first appearance
+    std::ofstream os(output, std::ios::out | std::ios::binary);
+    os.precision(12);
+    os << "<?xml version=\"1.0\" ?>\n";
+    os << "<FlowMonitorReplications replications=\"" << inputs.size() << "\">\n";
+    os << "  <FlowStats>\n";
+    for (std::size_t i = 0; i < flows.size(); ++i)
+    {
+        os << "    <Flow flowId=\"" << i + 1 << "\" replications=\""
+           << values[i][names[i].front()].size() << "\">\n";
+        for (const auto& name : names[i])
+        {
+            auto summary = SimulationReplications::Summarize(values[i][name]);
+            os << "      <Statistic name=\"" << name << "\" count=\"" << summary.count
+               << "\" mean=\"" << summary.mean << "\" stddev=\"" << summary.stddev << "\" min=\""
+               << summary.min << "\" max=\"" << summary.max << "\" ci95=\"" << summary.halfWidth
+               << "\" />\n";
+        }
+        os << "    </Flow>\n";
+    }
+    os << "  </FlowStats>\n";
+    std::set<std::string> classifiers;
+    for (const auto& flow : flows)
+    {
+        classifiers.insert(flow.first);
+    }
+    for (const auto& classifier : classifiers)
+    {
+        os << "  <" << classifier << ">\n";
+        for (std::size_t i = 0; i < flows.size(); ++i)
+        {
+            if (flows[i].first == classifier)
+            {
+                os << "    <Flow flowId=\"" << i + 1 << "\" " << flows[i].second << " />\n";
+            }
+        }
+        os << "  </" << classifier << ">\n";
+    }
+    os << "</FlowMonitorReplications>\n";
+}
+
+/**
+ * Register the merger of the XML files of the replications.
+ */
+static struct FlowMonitorMergerRegistration
+{
+    FlowMonitorMergerRegistration()
+    {
+        SimulationReplications::AddMerger("FlowMonitor", &FlowMonitor::MergeReplications);
+    }
+} g_flowMonitorMergerRegistration; //!< Static variable for registration
+
 void
 FlowMonitor::ResetAllStats()
 {
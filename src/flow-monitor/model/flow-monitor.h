@@ -267,6 +267,23 @@ class FlowMonitor : public Object
     /// @param enableProbes if true, include also the per-probe/flow pair statistics in the output
     void SerializeToXmlFile(std::string fileName, bool enableHistograms, bool enableProbes);
 
+    /// Merges the XML files written by the replications of a simulation
+    ///
+    /// Each attribute of each flow of the input files, and each number of
+    /// packets and bytes dropped, is summarized with the number of
+    /// replications where the flow appears, the mean, standard deviation,
+    /// minimum, maximum and half width of the 95% confidence interval of
+    /// its values; the times are in nanoseconds.  The flow ids depend on the
+    /// order in which each replication saw the flows, so the flows are
+    /// matched by their flow classifier entry (e.g., their 5-tuple), and
+    /// renumbered in order of first appearance; the numbers of packets of
+    /// each DSCP are summarized as the other statistics.
+    /// @param output name of the merged file
+    /// @param inputs names of the files of the replications
+    /// @see SimulationReplications
+    static void MergeReplications(const std::string& output,
+                                  const std::vector<std::string>& inputs);
+
     /// Reset all the statistics
     void ResetAllStats();
 
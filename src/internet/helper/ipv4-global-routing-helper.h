@@ -75,6 +75,8 @@ class Ipv4GlobalRoutingHelper : public Ipv4RoutingHelper
      * its representation of the global topology before recomputing routes.
      * Users must first call PopulateRoutingTables() and then may subsequently
      * call RecomputeRoutingTables() at any later time in the simulation.
+     * If the GlobalValue GlobalRoutingIncremental is true, only the routes
+     * of the routers affected by the changes of the topology are recomputed.
      *
      */
     static void RecomputeRoutingTables();
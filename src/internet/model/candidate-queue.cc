@@ -47,20 +47,25 @@ operator<<(std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream&
 operator<<(std::ostream& os, const CandidateQueue& q)
 {
-    const CandidateQueue::CandidateList_t& list = q.m_candidates;
+    std::vector<CandidateQueue::Candidate> candidates = q.m_heap;
+    std::sort(candidates.begin(), candidates.end(), &CandidateQueue::CompareCandidates);
 
     os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-    for (auto iter = list.begin(); iter != list.end(); iter++)
+    for (const auto& candidate : candidates)
     {
-        os << "<" << (*iter)->GetVertexId() << ", " << (*iter)->GetDistanceFromRoot() << ", "
-           << (*iter)->GetVertexType() << ">" << std::endl;
+        os << "<" << candidate.vertex->GetVertexId() << ", "
+           << candidate.vertex->GetDistanceFromRoot() << ", "
+           << candidate.vertex->GetVertexType() << ">" << std::endl;
     }
     os << "*** CandidateQueue End ***";
     return os;
 }
 
 CandidateQueue::CandidateQueue()
-    : m_candidates()
+    : m_heap(),
+      m_positions(),
+      m_firstOrder(0),
+      m_lastOrder(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -75,7 +80,7 @@ void
 CandidateQueue::Clear()
 {
     NS_LOG_FUNCTION(this);
-    while (!m_candidates.empty())
+    while (!m_heap.empty())
     {
         SPFVertex* p = Pop();
         delete p;
@@ -88,24 +93,31 @@ CandidateQueue::Push(SPFVertex* vNew)
 {
     NS_LOG_FUNCTION(this << vNew);
 
-    auto i = std::upper_bound(m_candidates.begin(),
-                              m_candidates.end(),
-                              vNew,
-                              &CandidateQueue::CompareSPFVertex);
-    m_candidates.insert(i, vNew);
+    m_heap.push_back({vNew,
+                      vNew->GetDistanceFromRoot(),
+                      vNew->GetVertexType() == SPFVertex::VertexRouter,
+                      m_lastOrder++});
+    m_positions.emplace(vNew->GetVertexId(), m_heap.size() - 1);
+    SiftUp(m_heap.size() - 1);
 }
 
 SPFVertex*
 CandidateQueue::Pop()
 {
     NS_LOG_FUNCTION(this);
-    if (m_candidates.empty())
+    if (m_heap.empty())
     {
         return nullptr;
     }
 
-    SPFVertex* v = m_candidates.front();
-    m_candidates.pop_front();
+    SPFVertex* v = m_heap.front().vertex;
+    Swap(0, m_heap.size() - 1);
+    Unindex(v);
+    m_heap.pop_back();
+    if (!m_heap.empty())
+    {
+        SiftDown(0);
+    }
     return v;
 }
 
@@ -113,44 +125,68 @@ SPFVertex*
 CandidateQueue::Top() const
 {
     NS_LOG_FUNCTION(this);
-    if (m_candidates.empty())
+    if (m_heap.empty())
     {
         return nullptr;
     }
 
-    return m_candidates.front();
+    return m_heap.front().vertex;
 }
 
 bool
 CandidateQueue::Empty() const
 {
     NS_LOG_FUNCTION(this);
-    return m_candidates.empty();
+    return m_heap.empty();
 }
 
 uint32_t
 CandidateQueue::Size() const
 {
     NS_LOG_FUNCTION(this);
-    return m_candidates.size();
+    return m_heap.size();
 }
 
 SPFVertex*
 CandidateQueue::Find(const Ipv4Address addr) const
 {
     NS_LOG_FUNCTION(this);
-    auto i = m_candidates.begin();
-
-    for (; i != m_candidates.end(); i++)
+    // the first one in the order of the queue, if several vertices have this ID
+    const Candidate* found = nullptr;
+    auto range = m_positions.equal_range(addr);
+    for (auto i = range.first; i != range.second; i++)
     {
-        SPFVertex* v = *i;
-        if (v->GetVertexId() == addr)
+        const Candidate& candidate = m_heap[i->second];
+        if (!found || CompareCandidates(candidate, *found))
         {
-            return v;
+            found = &candidate;
         }
     }
+    return found ? found->vertex : nullptr;
+}
+
+void
+CandidateQueue::Update(SPFVertex* vertex)
+{
+    NS_LOG_FUNCTION(this << vertex);
 
-    return nullptr;
+    std::size_t i = GetPosition(vertex);
+    Candidate& candidate = m_heap[i];
+    uint32_t distance = vertex->GetDistanceFromRoot();
+    // as a stable sort would do, the vertex goes after the vertices of its
+    // new priority if it was after them, and before them otherwise
+    if (distance < candidate.distance)
+    {
+        candidate.distance = distance;
+        candidate.order = m_lastOrder++;
+        SiftUp(i);
+    }
+    else if (distance > candidate.distance)
+    {
+        candidate.distance = distance;
+        candidate.order = --m_firstOrder;
+        SiftDown(i);
+    }
 }
 
 void
@@ -158,7 +194,27 @@ CandidateQueue::Reorder()
 {
     NS_LOG_FUNCTION(this);
 
-    m_candidates.sort(&CandidateQueue::CompareSPFVertex);
+    // sort by the new priorities, keeping the current order between the
+    // vertices of equal priority
+    std::sort(m_heap.begin(), m_heap.end(), [](const Candidate& c1, const Candidate& c2) {
+        uint32_t d1 = c1.vertex->GetDistanceFromRoot();
+        uint32_t d2 = c2.vertex->GetDistanceFromRoot();
+        if (d1 != d2 || c1.router != c2.router)
+        {
+            return d1 < d2 || (d1 == d2 && !c1.router);
+        }
+        return CompareCandidates(c1, c2);
+    });
+    // a sorted vector is a binary heap
+    m_positions.clear();
+    m_firstOrder = 0;
+    m_lastOrder = 0;
+    for (std::size_t i = 0; i < m_heap.size(); i++)
+    {
+        m_heap[i].distance = m_heap[i].vertex->GetDistanceFromRoot();
+        m_heap[i].order = m_lastOrder++;
+        m_positions.emplace(m_heap[i].vertex->GetVertexId(), i);
+    }
     NS_LOG_LOGIC("After reordering the CandidateQueue");
     NS_LOG_LOGIC(*this);
 }
@@ -171,24 +227,107 @@ CandidateQueue::Reorder()
  * This ordering is necessary for implementing ECMP
  */
 bool
-CandidateQueue::CompareSPFVertex(const SPFVertex* v1, const SPFVertex* v2)
+CandidateQueue::CompareCandidates(const Candidate& c1, const Candidate& c2)
+{
+    if (c1.distance != c2.distance)
+    {
+        return c1.distance < c2.distance;
+    }
+    if (c1.router != c2.router)
+    {
+        return !c1.router;
+    }
+    return c1.order < c2.order;
+}
+
+void
+CandidateQueue::SiftUp(std::size_t i)
+{
+    while (i > 0)
+    {
+        std::size_t parent = (i - 1) / 2;
+        if (!CompareCandidates(m_heap[i], m_heap[parent]))
+        {
+            break;
+        }
+        Swap(i, parent);
+        i = parent;
+    }
+}
+
+void
+CandidateQueue::SiftDown(std::size_t i)
 {
-    NS_LOG_FUNCTION(&v1 << &v2);
+    for (;;)
+    {
+        std::size_t first = i;
+        for (std::size_t child = 2 * i + 1; child <= 2 * i + 2 && child < m_heap.size(); child++)
+        {
+            if (CompareCandidates(m_heap[child], m_heap[first]))
+            {
+                first = child;
+            }
+        }
+        if (first == i)
+        {
+            break;
+        }
+        Swap(i, first);
+        i = first;
+    }
+}
 
-    bool result = false;
-    if (v1->GetDistanceFromRoot() < v2->GetDistanceFromRoot())
+void
+CandidateQueue::Swap(std::size_t i, std::size_t j)
+{
+    if (i == j)
     {
-        result = true;
+        return;
     }
-    else if (v1->GetDistanceFromRoot() == v2->GetDistanceFromRoot())
+    auto findPosition = [this](std::size_t k) {
+        auto range = m_positions.equal_range(m_heap[k].vertex->GetVertexId());
+        auto p = range.first;
+        while (p->second != k)
+        {
+            p++;
+        }
+        return p;
+    };
+    auto pi = findPosition(i);
+    auto pj = findPosition(j);
+    pi->second = j;
+    pj->second = i;
+    std::swap(m_heap[i], m_heap[j]);
+}
+
+void
+CandidateQueue::Unindex(SPFVertex* vertex)
+{
+    auto range = m_positions.equal_range(vertex->GetVertexId());
+    for (auto p = range.first; p != range.second; p++)
+    {
+        if (m_heap[p->second].vertex == vertex)
+        {
+            m_positions.erase(p);
+            return;
+        }
+    }
+    NS_ASSERT_MSG(false, "Vertex " << vertex->GetVertexId() << " not in the queue");
+}
+
+std::size_t
+CandidateQueue::GetPosition(const SPFVertex* vertex) const
+{
+    auto range = m_positions.equal_range(vertex->GetVertexId());
+    for (auto p = range.first; p != range.second; p++)
     {
-        if (v1->GetVertexType() == SPFVertex::VertexNetwork &&
-            v2->GetVertexType() == SPFVertex::VertexRouter)
+        if (m_heap[p->second].vertex == vertex)
         {
-            result = true;
+            return p->second;
         }
     }
-    return result;
+    NS_ASSERT_MSG(false, "Vertex " << vertex->GetVertexId() << " not in the queue");
+    return 0;
 }
 
 } // namespace ns3
@@ -11,8 +11,9 @@
 
 #include "ns3/ipv4-address.h"
 
-#include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -34,9 +35,14 @@ class SPFVertex;
  * priority queue.
  *
  * Although a STL priority_queue almost does what we want, the requirement
- * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple
- * enhanced priority queue.
+ * for a Find () operation and the dynamic nature of the data led us to
+ * implement this enhanced priority queue: a binary heap, whose vertices are
+ * also indexed by their vertex ID, and whose entries can be moved when the
+ * distance of a vertex changes (see Update ()).
+ *
+ * At equal distance, the network vertices are popped before the router
+ * vertices, and the vertices of the same type in the order they were
+ * pushed, as if the queue was a sorted list.
  */
 class CandidateQueue
 {
@@ -133,6 +139,18 @@ class CandidateQueue
      */
     SPFVertex* Find(const Ipv4Address addr) const;
 
+    /**
+     * @brief Move a Shortest Path First Vertex pointer of the queue after the
+     * value of its field m_distanceFromRoot changed.
+     *
+     * This is equivalent to Reorder () when only this vertex changed, in
+     * O(log n) instead of O(n log n).
+     *
+     * @see SPFVertex
+     * @param vertex The Shortest Path First Vertex, which must be in the queue.
+     */
+    void Update(SPFVertex* vertex);
+
     /**
      * @brief Reorders the Candidate Queue according to the priority scheme.
      *
@@ -150,20 +168,69 @@ class CandidateQueue
 
   private:
     /**
-     * @brief return true if v1 < v2
+     * @brief A vertex of the queue, with the priority it was queued with.
+     */
+    struct Candidate
+    {
+        SPFVertex* vertex; //!< the vertex
+        uint32_t distance; //!< the distance of the vertex from the root, when queued
+        bool router;       //!< whether the vertex is a router vertex
+        int64_t order;     //!< the order of the vertex among those of the same priority
+    };
+
+    /**
+     * @brief return true if c1 < c2
      *
      * SPFVertex items are added into the queue according to the ordering
-     * defined by this method. If v1 should be popped before v2, this
+     * defined by this method. If c1 should be popped before c2, this
      * method return true; false otherwise
      *
-     * @param v1 first operand
-     * @param v2 second operand
-     * @return True if v1 should be popped before v2; false otherwise
+     * @param c1 first operand
+     * @param c2 second operand
+     * @return True if c1 should be popped before c2; false otherwise
+     */
+    static bool CompareCandidates(const Candidate& c1, const Candidate& c2);
+
+    /**
+     * @brief Move an entry of the heap towards the top, to its place.
+     *
+     * @param i the index of the entry in the heap
+     */
+    void SiftUp(std::size_t i);
+
+    /**
+     * @brief Move an entry of the heap towards the bottom, to its place.
+     *
+     * @param i the index of the entry in the heap
+     */
+    void SiftDown(std::size_t i);
+
+    /**
+     * @brief Swap two entries of the heap.
+     *
+     * @param i the index of the first entry
+     * @param j the index of the second entry
+     */
+    void Swap(std::size_t i, std::size_t j);
+
+    /**
+     * @brief Remove the entry of a vertex from the index of the vertex IDs.
+     *
+     * @param vertex the vertex
+     */
+    void Unindex(SPFVertex* vertex);
+
+    /**
+     * @param vertex a vertex of the queue
+     * @returns the index of the entry of the vertex in the heap
      */
-    static bool CompareSPFVertex(const SPFVertex* v1, const SPFVertex* v2);
+    std::size_t GetPosition(const SPFVertex* vertex) const;
 
-    typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-    CandidateList_t m_candidates;                  //!< SPFVertex candidates
+    std::vector<Candidate> m_heap; //!< SPFVertex candidates, as a binary heap
+    /// the index in the heap of the candidates, by vertex ID
+    std::unordered_multimap<Ipv4Address, std::size_t, Ipv4AddressHash> m_positions;
+    int64_t m_firstOrder; //!< the order before those of all candidates
+    int64_t m_lastOrder;  //!< the order after those of all candidates
 
     /**
      * @brief Stream insertion operator.
@@ -0,0 +1,298 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "compact-route-table.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+/**
+ * @file
+ * @ingroup internet
+ * ns3::CompactRouteDestinations and ns3::CompactRouteTable implementations.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CompactRouteTable");
+
+uint32_t
+CompactRouteDestinations::GetId(Ipv4Address network, Ipv4Mask mask)
+{
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_ids.emplace(GetKey(network, mask), m_destinations.size());
+    if (inserted)
+    {
+        m_destinations.emplace_back(network, mask);
+        m_index.Insert(DestinationIndex::GetKey(network),
+                       std::countl_one(mask.Get()),
+                       it->second);
+    }
+    return it->second;
+}
+
+bool
+CompactRouteDestinations::Find(Ipv4Address network, Ipv4Mask mask, uint32_t& id)
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_ids.find(GetKey(network, mask));
+    if (it == m_ids.end())
+    {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+uint32_t
+CompactRouteDestinations::GetN() const
+{
+    return m_destinations.size();
+}
+
+Ipv4Address
+CompactRouteDestinations::GetNetwork(uint32_t id) const
+{
+    NS_ASSERT(id < m_destinations.size());
+    return m_destinations[id].first;
+}
+
+Ipv4Mask
+CompactRouteDestinations::GetMask(uint32_t id) const
+{
+    NS_ASSERT(id < m_destinations.size());
+    return m_destinations[id].second;
+}
+
+uint64_t
+CompactRouteDestinations::GetKey(Ipv4Address network, Ipv4Mask mask)
+{
+    return (uint64_t(network.Get()) << 32) | mask.Get();
+}
+
+CompactRouteTable::CompactRouteTable(CompactRouteDestinations* destinations)
+    : m_destinations(destinations)
+{
+    NS_LOG_FUNCTION(this << destinations);
+    Clear();
+}
+
+void
+CompactRouteTable::Add(Ipv4Address network,
+                       Ipv4Mask mask,
+                       Ipv4Address gateway,
+                       uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << mask << gateway << interface);
+    uint32_t id = m_destinations->GetId(network, mask);
+    if (id >= m_groupIds.size())
+    {
+        m_groupIds.resize(id + 1, 0);
+    }
+    NextHops nextHops = m_groups[m_groupIds[id]];
+    nextHops.emplace_back(gateway, interface);
+    SetNextHops(id, nextHops);
+    m_nRoutes++;
+    m_first = std::min(m_first, id);
+    m_cursorValid = false;
+}
+
+bool
+CompactRouteTable::Remove(Ipv4Address network,
+                          Ipv4Mask mask,
+                          Ipv4Address gateway,
+                          uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << mask << gateway << interface);
+    uint32_t id;
+    if (!m_destinations->Find(network, mask, id) || id >= m_groupIds.size())
+    {
+        return false;
+    }
+    NextHops nextHops = m_groups[m_groupIds[id]];
+    auto it = std::find(nextHops.begin(), nextHops.end(), std::make_pair(gateway, interface));
+    if (it == nextHops.end())
+    {
+        return false;
+    }
+    nextHops.erase(it);
+    SetNextHops(id, nextHops);
+    m_nRoutes--;
+    m_cursorValid = false;
+    if (m_nRoutes == 0)
+    {
+        Clear();
+    }
+    return true;
+}
+
+void
+CompactRouteTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_groupIds.clear();
+    m_groups.assign(1, NextHops());
+    m_groupIndex.clear();
+    m_groupIndex.emplace(NextHops(), 0);
+    m_nRoutes = 0;
+    m_first = 0;
+    m_cursorValid = false;
+    m_matches.clear();
+}
+
+uint32_t
+CompactRouteTable::GetNRoutes() const
+{
+    return m_nRoutes;
+}
+
+Ipv4RoutingTableEntry
+CompactRouteTable::GetRoute(uint32_t i) const
+{
+    NS_LOG_FUNCTION(this << i);
+    Seek(i);
+    const auto& nextHop = m_groups[m_groupIds[m_cursorId]][m_cursorNextHop];
+    return Ipv4RoutingTableEntry::CreateNetworkRouteTo(m_destinations->GetNetwork(m_cursorId),
+                                                       m_destinations->GetMask(m_cursorId),
+                                                       nextHop.first,
+                                                       nextHop.second);
+}
+
+void
+CompactRouteTable::RemoveRoute(uint32_t i)
+{
+    NS_LOG_FUNCTION(this << i);
+    Seek(i);
+    NextHops nextHops = m_groups[m_groupIds[m_cursorId]];
+    nextHops.erase(nextHops.begin() + m_cursorNextHop);
+    SetNextHops(m_cursorId, nextHops);
+    m_nRoutes--;
+    m_cursorValid = false;
+    if (m_nRoutes == 0)
+    {
+        Clear();
+    }
+}
+
+void
+CompactRouteTable::GetMatchingRoutes(Ipv4Address address,
+                                     std::vector<Ipv4RoutingTableEntry*>& routes) const
+{
+    m_matches.clear();
+    m_destinations->ForEachMatch(address, [this](uint32_t id) {
+        if (id >= m_groupIds.size())
+        {
+            return;
+        }
+        for (const auto& nextHop : m_groups[m_groupIds[id]])
+        {
+            m_matches.push_back(
+                Ipv4RoutingTableEntry::CreateNetworkRouteTo(m_destinations->GetNetwork(id),
+                                                            m_destinations->GetMask(id),
+                                                            nextHop.first,
+                                                            nextHop.second));
+        }
+    });
+    routes.clear();
+    for (auto& route : m_matches)
+    {
+        routes.push_back(&route);
+    }
+}
+
+uint32_t
+CompactRouteTable::GetNGroups() const
+{
+    return m_groups.size();
+}
+
+void
+CompactRouteTable::SetNextHops(uint32_t id, const NextHops& nextHops)
+{
+    auto it = m_groupIndex.find(nextHops);
+    if (it == m_groupIndex.end())
+    {
+        if (m_groups.size() > std::numeric_limits<uint16_t>::max())
+        {
+            CollectGroups();
+            NS_ABORT_MSG_IF(m_groups.size() > std::numeric_limits<uint16_t>::max(),
+                            "Too many distinct groups of next hops in a compact routing table");
+        }
+        it = m_groupIndex.emplace(nextHops, m_groups.size()).first;
+        m_groups.push_back(nextHops);
+    }
+    m_groupIds[id] = it->second;
+}
+
+void
+CompactRouteTable::CollectGroups()
+{
+    NS_LOG_FUNCTION(this);
+    // Renumber the groups still in use, in their order of creation
+    std::vector<uint16_t> renumbered(m_groups.size(), 0);
+    for (uint16_t groupId : m_groupIds)
+    {
+        renumbered[groupId] = 1;
+    }
+    std::vector<NextHops> groups(1);
+    m_groupIndex.clear();
+    m_groupIndex.emplace(NextHops(), 0);
+    for (std::size_t i = 1; i < m_groups.size(); i++)
+    {
+        if (renumbered[i])
+        {
+            renumbered[i] = groups.size();
+            m_groupIndex.emplace(m_groups[i], groups.size());
+            groups.push_back(std::move(m_groups[i]));
+        }
+    }
+    m_groups = std::move(groups);
+    for (auto& groupId : m_groupIds)
+    {
+        groupId = renumbered[groupId];
+    }
+    NS_LOG_LOGIC(m_groups.size() << " groups of next hops in use");
+}
+
+void
+CompactRouteTable::Seek(uint32_t i) const
+{
+    NS_ASSERT_MSG(i < m_nRoutes, "Route " << i << " out of " << m_nRoutes);
+    if (!m_cursorValid || i < m_cursor)
+    {
+        // Restart from the first destination having a route
+        while (m_groupIds[m_first] == 0)
+        {
+            m_first++;
+        }
+        m_cursorValid = true;
+        m_cursor = 0;
+        m_cursorId = m_first;
+        m_cursorNextHop = 0;
+    }
+    while (m_cursor < i)
+    {
+        uint32_t remaining = m_groups[m_groupIds[m_cursorId]].size() - m_cursorNextHop;
+        if (i - m_cursor < remaining)
+        {
+            m_cursorNextHop += i - m_cursor;
+            m_cursor = i;
+            break;
+        }
+        m_cursor += remaining;
+        m_cursorNextHop = 0;
+        do
+        {
+            m_cursorId++;
+        } while (m_groupIds[m_cursorId] == 0);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,277 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef COMPACT_ROUTE_TABLE_H
+#define COMPACT_ROUTE_TABLE_H
+
+#include "ipv4-routing-table-entry.h"
+#include "prefix-trie.h"
+
+#include "ns3/ipv4-address.h"
+
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup internet
+ * ns3::CompactRouteDestinations and ns3::CompactRouteTable declarations.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup internet
+ *
+ * @brief The destinations of the compact routing tables, numbered in
+ * their order of insertion.
+ *
+ * The destinations are shared by all the CompactRouteTable of a
+ * simulation.  A destination is added when the first route to it is
+ * added to a table, and is kept until the table of destinations is
+ * destroyed, so that its number can index the arrays of the tables.
+ *
+ * GetId() and Find() may be called concurrently, e.g., by the threads
+ * calculating the global routes.  The other methods must not be called
+ * concurrently with GetId().
+ */
+class CompactRouteDestinations
+{
+  public:
+    CompactRouteDestinations() = default;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    CompactRouteDestinations(const CompactRouteDestinations&) = delete;
+    CompactRouteDestinations& operator=(const CompactRouteDestinations&) = delete;
+
+    /**
+     * Get the number of a destination, adding the destination if needed.
+     *
+     * @param network The network of the destination.
+     * @param mask The mask of the destination.
+     * @returns The number of the destination.
+     */
+    uint32_t GetId(Ipv4Address network, Ipv4Mask mask);
+
+    /**
+     * Find the number of a destination.
+     *
+     * @param network The network of the destination.
+     * @param mask The mask of the destination.
+     * @param [out] id The number of the destination, if found.
+     * @returns true if the destination was found.
+     */
+    bool Find(Ipv4Address network, Ipv4Mask mask, uint32_t& id);
+
+    /**
+     * @returns The number of destinations.
+     */
+    uint32_t GetN() const;
+
+    /**
+     * @param id The number of a destination.
+     * @returns The network of the destination.
+     */
+    Ipv4Address GetNetwork(uint32_t id) const;
+
+    /**
+     * @param id The number of a destination.
+     * @returns The mask of the destination.
+     */
+    Ipv4Mask GetMask(uint32_t id) const;
+
+    /**
+     * Visit the destinations matching an address, from the longest mask.
+     *
+     * @tparam F The type of the visitor.
+     * @param address The address.
+     * @param visitor The visitor, called as visitor(id) for each matching
+     * destination.
+     */
+    template <typename F>
+    void ForEachMatch(Ipv4Address address, F visitor) const;
+
+  private:
+    /// The index of the destinations by prefix
+    typedef PrefixTrie<uint32_t, 4> DestinationIndex;
+
+    /**
+     * @param network The network of a destination.
+     * @param mask The mask of the destination.
+     * @returns The key of the destination in m_ids.
+     */
+    static uint64_t GetKey(Ipv4Address network, Ipv4Mask mask);
+
+    std::vector<std::pair<Ipv4Address, Ipv4Mask>> m_destinations; //!< Destinations, by number
+    std::unordered_map<uint64_t, uint32_t> m_ids; //!< Numbers of the destinations, by key
+    DestinationIndex m_index; //!< Numbers of the destinations, by leading ones of their mask
+    std::mutex m_mutex;       //!< Mutex of the insertions
+};
+
+/**
+ * @ingroup internet
+ *
+ * @brief A routing table storing, for each destination of a
+ * CompactRouteDestinations, the index of the group of its next hops.
+ *
+ * The group of next hops of a destination is the list of the gateways
+ * and interfaces of its routes, in their order of insertion.  The groups
+ * are stored once per table: the routes of a router to thousands of
+ * destinations usually share a few groups, e.g., one per set of
+ * equal-cost neighbors.  A table thus costs two bytes per destination of
+ * the simulation, instead of one heap allocated Ipv4RoutingTableEntry
+ * and its index per route.
+ *
+ * The routes are numbered by destination number, then in their order of
+ * insertion.  A table holds at most 65535 distinct groups.
+ */
+class CompactRouteTable
+{
+  public:
+    /**
+     * Constructor
+     *
+     * @param destinations The destinations shared with the other tables.
+     */
+    CompactRouteTable(CompactRouteDestinations* destinations);
+
+    /**
+     * Add a route.
+     *
+     * @param network The network of the destination.
+     * @param mask The mask of the destination.
+     * @param gateway The gateway.
+     * @param interface The interface.
+     */
+    void Add(Ipv4Address network, Ipv4Mask mask, Ipv4Address gateway, uint32_t interface);
+
+    /**
+     * Remove the first route equal to a route.
+     *
+     * @param network The network of the destination.
+     * @param mask The mask of the destination.
+     * @param gateway The gateway.
+     * @param interface The interface.
+     * @returns true if a route was found and removed.
+     */
+    bool Remove(Ipv4Address network, Ipv4Mask mask, Ipv4Address gateway, uint32_t interface);
+
+    /**
+     * Remove all the routes.
+     */
+    void Clear();
+
+    /**
+     * @returns The number of routes.
+     */
+    uint32_t GetNRoutes() const;
+
+    /**
+     * Get a route.  Getting the routes in sequence is done in constant
+     * amortized time.
+     *
+     * @param i The number of the route.
+     * @returns The route.
+     */
+    Ipv4RoutingTableEntry GetRoute(uint32_t i) const;
+
+    /**
+     * Remove a route.
+     *
+     * @param i The number of the route.
+     */
+    void RemoveRoute(uint32_t i);
+
+    /**
+     * Get the routes whose destination matches an address.
+     *
+     * @param address The address.
+     * @param [out] routes The matching routes, by decreasing length of the
+     * leading ones of their mask, then in the order of the table.  They are
+     * valid until the next call.
+     */
+    void GetMatchingRoutes(Ipv4Address address, std::vector<Ipv4RoutingTableEntry*>& routes) const;
+
+    /**
+     * @returns The number of groups of next hops stored, including the
+     * empty group.
+     */
+    uint32_t GetNGroups() const;
+
+  private:
+    /// The next hops of a destination: the gateways and interfaces
+    typedef std::vector<std::pair<Ipv4Address, uint32_t>> NextHops;
+
+    /**
+     * Set the next hops of a destination.
+     *
+     * @param id The number of the destination.
+     * @param nextHops The next hops.
+     */
+    void SetNextHops(uint32_t id, const NextHops& nextHops);
+
+    /**
+     * Remove the groups of next hops no longer used by any destination.
+     */
+    void CollectGroups();
+
+    /**
+     * Move the cursor to a route.
+     *
+     * @param i The number of the route.
+     */
+    void Seek(uint32_t i) const;
+
+    CompactRouteDestinations* m_destinations; //!< The destinations
+    std::vector<uint16_t> m_groupIds;         //!< The groups, by destination number
+    std::vector<NextHops> m_groups;           //!< The groups, the first one being empty
+    std::map<NextHops, uint16_t> m_groupIndex; //!< The numbers of the groups
+    uint32_t m_nRoutes;                        //!< The number of routes
+
+    /// No destination before this one has a route
+    mutable uint32_t m_first;
+    /// Whether the cursor is valid
+    mutable bool m_cursorValid;
+    /// The number of the route at the cursor
+    mutable uint32_t m_cursor;
+    /// The destination of the route at the cursor
+    mutable uint32_t m_cursorId;
+    /// The index of the next hop of the route at the cursor
+    mutable uint32_t m_cursorNextHop;
+    /// The routes returned by GetMatchingRoutes
+    mutable std::vector<Ipv4RoutingTableEntry> m_matches;
+};
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+template <typename F>
+void
+CompactRouteDestinations::ForEachMatch(Ipv4Address address, F visitor) const
+{
+    // The destinations are indexed by the leading ones of their mask, the
+    // other bits of a non-contiguous mask being checked here
+    m_index.ForEachMatch(DestinationIndex::GetKey(address),
+                         [this, address, &visitor](uint8_t, const std::vector<uint32_t>& ids) {
+                             for (uint32_t id : ids)
+                             {
+                                 const auto& destination = m_destinations[id];
+                                 if (destination.second.IsMatch(address, destination.first))
+                                 {
+                                     visitor(id);
+                                 }
+                             }
+                             return false;
+                         });
+}
+
+} // namespace ns3
+
+#endif /* COMPACT_ROUTE_TABLE_H */
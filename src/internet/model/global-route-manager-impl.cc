@@ -18,14 +18,22 @@
 #include "ipv4.h"
 
 #include "ns3/assert.h"
+#include "ns3/boolean.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <iterator>
 #include <queue>
+#include <set>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -34,6 +42,75 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("GlobalRouteManagerImpl");
 
+/**
+ * @ingroup globalrouting
+ * @brief The number of threads calculating the SPF trees of the routers.
+ *
+ * The SPF trees of several routers are calculated at the same time when
+ * this is not 1; the logging of the global routing must then be disabled.
+ */
+static GlobalValue g_globalRoutingThreads("GlobalRoutingThreads",
+                                          "The number of threads calculating the global routes, "
+                                          "0 for the number of hardware threads",
+                                          UintegerValue(1),
+                                          MakeUintegerChecker<uint32_t>());
+
+/**
+ * @ingroup globalrouting
+ * @brief Whether the SPF trees of the routers are kept for the incremental
+ * updates of GlobalRouteManagerImpl::UpdateRoutes ().
+ */
+static GlobalValue g_globalRoutingIncremental("GlobalRoutingIncremental",
+                                              "Keep the SPF trees of the routers, so that the "
+                                              "global routes are updated incrementally after a "
+                                              "change of the links",
+                                              BooleanValue(false),
+                                              MakeBooleanChecker());
+
+namespace
+{
+
+/**
+ * @brief Compare two Global Routing Link State Advertisements, except for
+ * their SPF status.
+ *
+ * @param a the first LSA
+ * @param b the second LSA
+ * @returns true if the LSAs have the same contents
+ */
+bool
+IsSameLSA(const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+    if (a->GetLSType() != b->GetLSType() || a->GetLinkStateId() != b->GetLinkStateId() ||
+        a->GetAdvertisingRouter() != b->GetAdvertisingRouter() ||
+        a->GetNetworkLSANetworkMask() != b->GetNetworkLSANetworkMask() ||
+        a->GetNLinkRecords() != b->GetNLinkRecords() ||
+        a->GetNAttachedRouters() != b->GetNAttachedRouters())
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->GetNLinkRecords(); i++)
+    {
+        GlobalRoutingLinkRecord* la = a->GetLinkRecord(i);
+        GlobalRoutingLinkRecord* lb = b->GetLinkRecord(i);
+        if (la->GetLinkType() != lb->GetLinkType() || la->GetLinkId() != lb->GetLinkId() ||
+            la->GetLinkData() != lb->GetLinkData() || la->GetMetric() != lb->GetMetric())
+        {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < a->GetNAttachedRouters(); i++)
+    {
+        if (a->GetAttachedRouter(i) != b->GetAttachedRouter(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 /**
  * @brief Stream insertion operator.
  *
@@ -458,9 +535,23 @@ GlobalRouteManagerLSDB::Insert(Ipv4Address addr, GlobalRoutingLSA* lsa)
     {
         m_extdatabase.push_back(lsa);
     }
-    else
+    else if (m_database.insert(LSDBPair_t(addr, lsa)).second)
     {
-        m_database.insert(LSDBPair_t(addr, lsa));
+        // Index the LSA under the LinkData of its TransitNetwork link records,
+        // where GetLSAByLinkData () would find it
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
+            if (lr->GetLinkType() != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+                continue;
+            }
+            auto [it, inserted] = m_linkDataIndex.emplace(lr->GetLinkData(), lsa);
+            if (!inserted && addr < it->second->GetLinkStateId())
+            {
+                it->second = lsa;
+            }
+        }
     }
 }
 
@@ -485,12 +576,10 @@ GlobalRouteManagerLSDB::GetLSA(Ipv4Address addr) const
     //
     // Look up an LSA by its address.
     //
-    for (auto i = m_database.begin(); i != m_database.end(); i++)
+    auto i = m_database.find(addr);
+    if (i != m_database.end())
     {
-        if (i->first == addr)
-        {
-            return i->second;
-        }
+        return i->second;
     }
     return nullptr;
 }
@@ -500,23 +589,55 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
 {
     NS_LOG_FUNCTION(this << addr);
     //
-    // Look up an LSA by its address.
+    // Look up an LSA by the LinkData of its TransitNetwork link records.
     //
-    for (auto i = m_database.begin(); i != m_database.end(); i++)
+    auto i = m_linkDataIndex.find(addr);
+    if (i != m_linkDataIndex.end())
     {
-        GlobalRoutingLSA* temp = i->second;
-        // Iterate among temp's Link Records
-        for (uint32_t j = 0; j < temp->GetNLinkRecords(); j++)
+        return i->second;
+    }
+    return nullptr;
+}
+
+std::vector<Ipv4Address>
+GlobalRouteManagerLSDB::GetChangedLSAs(const GlobalRouteManagerLSDB& other) const
+{
+    NS_LOG_FUNCTION(this << &other);
+    std::vector<Ipv4Address> changed;
+    auto i = m_database.begin();
+    auto j = other.m_database.begin();
+    while (i != m_database.end() || j != other.m_database.end())
+    {
+        if (j == other.m_database.end() || (i != m_database.end() && i->first < j->first))
+        {
+            changed.push_back(i++->first);
+        }
+        else if (i == m_database.end() || j->first < i->first)
+        {
+            changed.push_back(j++->first);
+        }
+        else
         {
-            GlobalRoutingLinkRecord* lr = temp->GetLinkRecord(j);
-            if (lr->GetLinkType() == GlobalRoutingLinkRecord::TransitNetwork &&
-                lr->GetLinkData() == addr)
+            if (!IsSameLSA(i->second, j->second))
             {
-                return temp;
+                changed.push_back(i->first);
             }
+            i++;
+            j++;
         }
     }
-    return nullptr;
+    return changed;
+}
+
+bool
+GlobalRouteManagerLSDB::HasSameExtLSAs(const GlobalRouteManagerLSDB& other) const
+{
+    NS_LOG_FUNCTION(this << &other);
+    return std::equal(m_extdatabase.begin(),
+                      m_extdatabase.end(),
+                      other.m_extdatabase.begin(),
+                      other.m_extdatabase.end(),
+                      &IsSameLSA);
 }
 
 // ---------------------------------------------------------------------------
@@ -526,16 +647,25 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
 // ---------------------------------------------------------------------------
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl()
-    : m_spfroot(nullptr)
+    : m_spfroot(nullptr),
+      m_ownLsdb(true)
 {
     NS_LOG_FUNCTION(this);
     m_lsdb = new GlobalRouteManagerLSDB();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb)
+    : m_spfroot(nullptr),
+      m_lsdb(lsdb),
+      m_ownLsdb(false)
+{
+    NS_LOG_FUNCTION(this << lsdb);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
+    if (m_lsdb && m_ownLsdb)
     {
         delete m_lsdb;
     }
@@ -564,19 +694,8 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes()
         {
             continue;
         }
-        Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-        uint32_t j = 0;
-        uint32_t nRoutes = gr->GetNRoutes();
-        NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes from node " << node->GetId());
-        // Each time we delete route 0, the route index shifts downward
-        // We can delete all routes if we delete the route numbered 0
-        // nRoutes times
-        for (j = 0; j < nRoutes; j++)
-        {
-            NS_LOG_LOGIC("Deleting global route " << j << " from node " << node->GetId());
-            gr->RemoveRoute(0);
-        }
-        NS_LOG_LOGIC("Deleted " << j << " global routes from node " << node->GetId());
+        NS_LOG_LOGIC("Deleting global routes from node " << node->GetId());
+        DeleteRoutes(router->GetRoutingProtocol());
     }
     if (m_lsdb)
     {
@@ -584,6 +703,23 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes()
         delete m_lsdb;
         m_lsdb = new GlobalRouteManagerLSDB();
     }
+    m_spfTrees.clear();
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes(Ptr<Ipv4GlobalRouting> routing)
+{
+    NS_LOG_FUNCTION(routing);
+    uint32_t j = 0;
+    uint32_t nRoutes = routing->GetNRoutes();
+    // Each time we delete route 0, the route index shifts downward
+    // We can delete all routes if we delete the route numbered 0
+    // nRoutes times
+    for (j = 0; j < nRoutes; j++)
+    {
+        routing->RemoveRoute(0);
+    }
+    NS_LOG_LOGIC("Deleted " << j << " global routes");
 }
 
 //
@@ -681,36 +817,467 @@ void
 GlobalRouteManagerImpl::InitializeRoutes()
 {
     NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("About to start SPF calculation");
+    m_spfTrees.clear();
+    CalculateRoutes(GetSPFRoots());
+    NS_LOG_INFO("Finished SPF calculation");
+}
+
+std::vector<GlobalRouteManagerImpl::SPFRoot>
+GlobalRouteManagerImpl::GetSPFRoots() const
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<SPFRoot> roots;
+    uint32_t systemId = Simulator::GetSystemId();
     //
-    // Walk the list of nodes in the system.
+    // Walk the list of nodes in the system, looking for the GlobalRouter
+    // interface that indicates that the node is participating in routing.
     //
-    NS_LOG_INFO("About to start SPF calculation");
     for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
     {
         Ptr<Node> node = *i;
-        //
-        // Look for the GlobalRouter interface that indicates that the node is
-        // participating in routing.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        uint32_t systemId = Simulator::GetSystemId();
         // Ignore nodes that are not assigned to our systemId (distributed sim)
         if (node->GetSystemId() != systemId)
         {
             continue;
         }
-
-        //
-        // if the node has a global router interface, then run the global routing
-        // algorithms.
-        //
+        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
         if (rtr && rtr->GetNumLSAs())
         {
-            SPFCalculate(rtr->GetRouterId());
+            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+            NS_ASSERT_MSG(ipv4, "GetSPFRoots (): GetObject for <Ipv4> interface failed");
+            roots.push_back({rtr->GetRouterId(), ipv4, rtr->GetRoutingProtocol()});
         }
     }
-    NS_LOG_INFO("Finished SPF calculation");
+    return roots;
+}
+
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::GetSPFRoot(Ipv4Address routerId) const
+{
+    NS_LOG_FUNCTION(this << routerId);
+    for (const auto& root : GetSPFRoots())
+    {
+        if (root.routerId == routerId)
+        {
+            return root;
+        }
+    }
+    return {routerId, nullptr, nullptr};
+}
+
+//
+// The SPF trees of the roots only read the LSDB, and each of them only
+// writes the routes of its own root: they are calculated by several
+// threads, each one with its own GlobalRouteManagerImpl borrowing the LSDB.
+// The pointers to the routers were gathered beforehand by GetSPFRoots (),
+// so that the threads do not touch the shared objects of the simulation.
+//
+void
+GlobalRouteManagerImpl::CalculateRoutes(const std::vector<SPFRoot>& roots)
+{
+    NS_LOG_FUNCTION(this << roots.size());
+    UintegerValue threadsValue;
+    g_globalRoutingThreads.GetValue(threadsValue);
+    BooleanValue incrementalValue;
+    g_globalRoutingIncremental.GetValue(incrementalValue);
+    bool record = incrementalValue.Get();
+
+    std::size_t nThreads = threadsValue.Get();
+    if (nThreads == 0)
+    {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    nThreads = std::min(nThreads, roots.size());
+
+    std::vector<SPFTree> trees(record ? roots.size() : 0);
+    if (nThreads <= 1)
+    {
+        for (std::size_t i = 0; i < roots.size(); i++)
+        {
+            SPFCalculate(roots[i], record ? &trees[i] : nullptr);
+        }
+    }
+    else
+    {
+        NS_LOG_INFO("Calculating " << roots.size() << " SPF trees with " << nThreads
+                                   << " threads");
+        std::atomic<std::size_t> next(0);
+        auto work = [&]() {
+            GlobalRouteManagerImpl worker(m_lsdb);
+            for (std::size_t i = next++; i < roots.size(); i = next++)
+            {
+                worker.SPFCalculate(roots[i], record ? &trees[i] : nullptr);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < nThreads; i++)
+        {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    for (std::size_t i = 0; i < trees.size(); i++)
+    {
+        m_spfTrees[roots[i].routerId] = std::move(trees[i]);
+    }
+}
+
+//
+// When only a few links change, most of the SPF trees are not changed: the
+// routes of their roots to the destinations advertised by the LSAs that
+// changed are updated, and only the other roots calculate their SPF tree
+// again.  A tree is affected by a link on which it depends (a link of the
+// tree, or a link whose data gives a next hop from the root) being removed,
+// or by a new link possibly giving a path not longer than the tree's one.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    BooleanValue incremental;
+    g_globalRoutingIncremental.GetValue(incremental);
+    if (!incremental.Get() || m_spfTrees.empty())
+    {
+        DeleteGlobalRoutes();
+        BuildGlobalRoutingDatabase();
+        InitializeRoutes();
+        return;
+    }
+
+    GlobalRouteManagerLSDB* oldLsdb = m_lsdb;
+    m_lsdb = new GlobalRouteManagerLSDB();
+    BuildGlobalRoutingDatabase();
+    std::vector<SPFRoot> roots = GetSPFRoots();
+
+    bool sameRoots = roots.size() == m_spfTrees.size() &&
+                     std::all_of(roots.begin(), roots.end(), [this](const SPFRoot& root) {
+                         return m_spfTrees.count(root.routerId);
+                     });
+    if (!sameRoots || !m_lsdb->HasSameExtLSAs(*oldLsdb))
+    {
+        NS_LOG_LOGIC("Routers or external LSAs changed, calculating all the routes");
+        delete oldLsdb;
+        for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+        {
+            Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter>();
+            if (router)
+            {
+                DeleteRoutes(router->GetRoutingProtocol());
+            }
+        }
+        m_spfTrees.clear();
+        CalculateRoutes(roots);
+        return;
+    }
+
+    std::vector<Ipv4Address> changed = m_lsdb->GetChangedLSAs(*oldLsdb);
+    NS_LOG_LOGIC(changed.size() << " LSAs changed");
+    if (changed.empty())
+    {
+        delete oldLsdb;
+        return;
+    }
+
+    //
+    // The links of the LSAs that changed, and of the networks whose attached
+    // routers are found through the transit links that changed.
+    //
+    std::set<Ipv4Address> compared(changed.begin(), changed.end());
+    for (Ipv4Address id : changed)
+    {
+        for (const GlobalRouteManagerLSDB* lsdb : {oldLsdb, m_lsdb})
+        {
+            GlobalRoutingLSA* lsa = lsdb->GetLSA(id);
+            if (!lsa || lsa->GetLSType() != GlobalRoutingLSA::RouterLSA)
+            {
+                continue;
+            }
+            for (uint32_t i = 0; i < lsa->GetNLinkRecords(); i++)
+            {
+                GlobalRoutingLinkRecord* l = lsa->GetLinkRecord(i);
+                if (l->GetLinkType() == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                    compared.insert(l->GetLinkId());
+                }
+            }
+        }
+    }
+    std::vector<SPFLink> oldLinks;
+    std::vector<SPFLink> newLinks;
+    for (Ipv4Address id : compared)
+    {
+        GetSPFLinks(oldLsdb, oldLsdb->GetLSA(id), oldLinks);
+        GetSPFLinks(m_lsdb, m_lsdb->GetLSA(id), newLinks);
+    }
+    auto compareLinks = [](const SPFLink& a, const SPFLink& b) {
+        return std::tie(a.from, a.to, a.metric, a.data) < std::tie(b.from, b.to, b.metric, b.data);
+    };
+    std::sort(oldLinks.begin(), oldLinks.end(), compareLinks);
+    std::sort(newLinks.begin(), newLinks.end(), compareLinks);
+    std::vector<SPFLink> removed;
+    std::vector<SPFLink> added;
+    std::set_difference(oldLinks.begin(),
+                        oldLinks.end(),
+                        newLinks.begin(),
+                        newLinks.end(),
+                        std::back_inserter(removed),
+                        compareLinks);
+    std::set_difference(newLinks.begin(),
+                        newLinks.end(),
+                        oldLinks.begin(),
+                        oldLinks.end(),
+                        std::back_inserter(added),
+                        compareLinks);
+    NS_LOG_LOGIC(removed.size() << " links removed, " << added.size() << " links added");
+
+    std::vector<SPFRoot> affected;
+    for (const auto& root : roots)
+    {
+        const SPFTree& tree = m_spfTrees[root.routerId];
+        // The trees of the stub routers are not kept
+        if (tree.empty() || IsSPFTreeAffected(root.routerId, tree, changed, removed, added) ||
+            !UpdateSPFTreeRoutes(root, tree, changed, oldLsdb))
+        {
+            DeleteRoutes(root.routing);
+            affected.push_back(root);
+        }
+    }
+    NS_LOG_INFO("Calculating " << affected.size() << " of " << roots.size() << " SPF trees");
+    delete oldLsdb;
+    CalculateRoutes(affected);
+}
+
+void
+GlobalRouteManagerImpl::GetSPFLinks(const GlobalRouteManagerLSDB* lsdb,
+                                    const GlobalRoutingLSA* lsa,
+                                    std::vector<SPFLink>& links)
+{
+    if (!lsa)
+    {
+        return;
+    }
+    if (lsa->GetLSType() == GlobalRoutingLSA::RouterLSA)
+    {
+        for (uint32_t i = 0; i < lsa->GetNLinkRecords(); i++)
+        {
+            GlobalRoutingLinkRecord* l = lsa->GetLinkRecord(i);
+            if (l->GetLinkType() == GlobalRoutingLinkRecord::PointToPoint ||
+                l->GetLinkType() == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+                links.push_back(
+                    {lsa->GetLinkStateId(), l->GetLinkId(), l->GetMetric(), l->GetLinkData()});
+            }
+        }
+    }
+    else if (lsa->GetLSType() == GlobalRoutingLSA::NetworkLSA)
+    {
+        for (uint32_t i = 0; i < lsa->GetNAttachedRouters(); i++)
+        {
+            Ipv4Address attached = lsa->GetAttachedRouter(i);
+            GlobalRoutingLSA* w_lsa = lsdb->GetLSAByLinkData(attached);
+            if (w_lsa)
+            {
+                links.push_back({lsa->GetLinkStateId(), w_lsa->GetLinkStateId(), 0, attached});
+            }
+        }
+    }
+}
+
+bool
+GlobalRouteManagerImpl::IsSPFTreeAffected(Ipv4Address root,
+                                          const SPFTree& tree,
+                                          const std::vector<Ipv4Address>& changed,
+                                          const std::vector<SPFLink>& removed,
+                                          const std::vector<SPFLink>& added) const
+{
+    NS_LOG_FUNCTION(this << root);
+    auto findVertex = [&tree](Ipv4Address id) -> const SPFTreeVertex* {
+        auto it = tree.find(id);
+        return it == tree.end() ? nullptr : &it->second;
+    };
+    auto isParent = [](const SPFTreeVertex* vertex, Ipv4Address id) {
+        return vertex &&
+               std::find(vertex->parents.begin(), vertex->parents.end(), id) !=
+                   vertex->parents.end();
+    };
+    // The next hops from the root are given by the links to the root and to
+    // its children
+    auto isNextHopLink = [&](const SPFLink& link) {
+        return link.to == root || isParent(findVertex(link.to), root);
+    };
+
+    for (Ipv4Address id : changed)
+    {
+        if (id == root || (findVertex(id) && !m_lsdb->GetLSA(id)))
+        {
+            return true;
+        }
+    }
+    for (const auto& link : removed)
+    {
+        if (isNextHopLink(link) || isParent(findVertex(link.to), link.from))
+        {
+            return true;
+        }
+    }
+    for (const auto& link : added)
+    {
+        if (isNextHopLink(link))
+        {
+            return true;
+        }
+        const SPFTreeVertex* from = findVertex(link.from);
+        if (!from)
+        {
+            continue;
+        }
+        const SPFTreeVertex* to = findVertex(link.to);
+        if (!to || from->distance + link.metric <= to->distance)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+GlobalRouteManagerImpl::UpdateSPFTreeRoutes(const SPFRoot& root,
+                                            const SPFTree& tree,
+                                            const std::vector<Ipv4Address>& changed,
+                                            const GlobalRouteManagerLSDB* oldLsdb) const
+{
+    NS_LOG_FUNCTION(this << root.routerId);
+    if (!root.routing)
+    {
+        return true;
+    }
+    // The routes of a vertex follow each other in the table, from the
+    // route whose rank was kept with the vertex, and keep their place,
+    // as the order of the table decides the route used among the matching
+    // ones
+    struct Update
+    {
+        const SPFTreeVertex* vertex;
+        std::vector<Ipv4RoutingTableEntry> oldHostRoutes;
+        std::vector<Ipv4RoutingTableEntry> oldNetworkRoutes;
+        std::vector<Ipv4RoutingTableEntry> newHostRoutes;
+        std::vector<Ipv4RoutingTableEntry> newNetworkRoutes;
+    };
+    std::vector<Update> updates;
+    for (Ipv4Address id : changed)
+    {
+        auto it = tree.find(id);
+        if (id == root.routerId || it == tree.end())
+        {
+            continue;
+        }
+        Update& update = updates.emplace_back();
+        update.vertex = &it->second;
+        GetSPFTreeRoutes(oldLsdb->GetLSA(id),
+                         it->second.exits,
+                         update.oldHostRoutes,
+                         update.oldNetworkRoutes);
+        GetSPFTreeRoutes(m_lsdb->GetLSA(id),
+                         it->second.exits,
+                         update.newHostRoutes,
+                         update.newNetworkRoutes);
+        if ((update.oldHostRoutes.empty() && !update.newHostRoutes.empty()) ||
+            (update.oldNetworkRoutes.empty() && !update.newNetworkRoutes.empty()))
+        {
+            NS_LOG_LOGIC("No place for the new routes of router " << root.routerId << " to "
+                                                                  << id);
+            return false;
+        }
+    }
+    for (const auto& update : updates)
+    {
+        if (!update.oldHostRoutes.empty())
+        {
+            root.routing->ReplaceHostRoutes(update.vertex->hostRank,
+                                            update.oldHostRoutes,
+                                            update.newHostRoutes);
+        }
+        if (!update.oldNetworkRoutes.empty())
+        {
+            root.routing->ReplaceNetworkRoutes(update.vertex->networkRank,
+                                               update.oldNetworkRoutes,
+                                               update.newNetworkRoutes);
+        }
+    }
+    return true;
+}
+
+void
+GlobalRouteManagerImpl::GetSPFTreeRoutes(const GlobalRoutingLSA* lsa,
+                                         const std::vector<SPFVertex::NodeExit_t>& exits,
+                                         std::vector<Ipv4RoutingTableEntry>& hostRoutes,
+                                         std::vector<Ipv4RoutingTableEntry>& networkRoutes)
+{
+    if (!lsa)
+    {
+        return;
+    }
+    auto addNetworkRoute = [&](Ipv4Address network, Ipv4Mask mask) {
+        network = network.CombineMask(mask);
+        for (const auto& [nextHop, outIf] : exits)
+        {
+            if (outIf >= 0)
+            {
+                networkRoutes.push_back(
+                    Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, mask, nextHop, outIf));
+            }
+        }
+    };
+    // The routes added by SPFIntraAddRouter (), SPFIntraAddStub () and
+    // SPFIntraAddTransit ()
+    if (lsa->GetLSType() == GlobalRoutingLSA::RouterLSA)
+    {
+        for (uint32_t i = 0; i < lsa->GetNLinkRecords(); i++)
+        {
+            GlobalRoutingLinkRecord* l = lsa->GetLinkRecord(i);
+            if (l->GetLinkType() == GlobalRoutingLinkRecord::StubNetwork)
+            {
+                addNetworkRoute(l->GetLinkId(), Ipv4Mask(l->GetLinkData().Get()));
+                continue;
+            }
+            if (l->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
+            {
+                continue;
+            }
+            for (const auto& [nextHop, outIf] : exits)
+            {
+                if (outIf >= 0)
+                {
+                    hostRoutes.push_back(
+                        Ipv4RoutingTableEntry::CreateHostRouteTo(l->GetLinkData(), nextHop, outIf));
+                }
+            }
+        }
+    }
+    else if (lsa->GetLSType() == GlobalRoutingLSA::NetworkLSA)
+    {
+        addNetworkRoute(lsa->GetLinkStateId(), lsa->GetNetworkLSANetworkMask());
+    }
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetSPFStatus(const GlobalRoutingLSA* lsa) const
+{
+    auto it = m_spfStatus.find(lsa);
+    return it == m_spfStatus.end() ? GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED : it->second;
+}
+
+void
+GlobalRouteManagerImpl::SetSPFStatus(const GlobalRoutingLSA* lsa,
+                                     GlobalRoutingLSA::SPFStatus status)
+{
+    m_spfStatus[lsa] = status;
 }
 
 //
@@ -816,7 +1383,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
         // If the link is to a router that is already in the shortest path first tree
         // then we have it covered -- ignore it.
         //
-        if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
+        if (GetSPFStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
         {
             NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " already in SPF tree");
             continue;
@@ -840,7 +1407,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
         NS_LOG_LOGIC("Considering w_lsa " << w_lsa->GetLinkStateId());
 
         // Is there already vertex w in candidate list?
-        if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+        if (GetSPFStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
             // Calculate nexthop to w
             // We need to figure out how to actually get to the new router represented
@@ -852,7 +1419,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
             w = new SPFVertex(w_lsa);
             if (SPFNexthopCalculation(v, w, l, distance))
             {
-                w_lsa->SetStatus(GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+                SetSPFStatus(w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
                 // root node).
@@ -869,7 +1436,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
                                   << "return false, but it does now!");
             }
         }
-        else if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+        else if (GetSPFStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
             //
             // We have already considered the link represented by <w>.  What wse have to
@@ -941,7 +1508,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
                     // If we've changed the cost to get to the vertex represented by <w>, we
                     // must reorder the priority queue keyed to that cost.
                     //
-                    candidate.Reorder();
+                    candidate.Update(cw);
                 }
             } // new lower cost path found
         }     // end W is already on the candidate list
@@ -1292,9 +1859,7 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<GlobalRouter> router = rlsa->GetNode()->GetObject<GlobalRouter>();
-                    NS_ASSERT(router);
-                    Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
+                    Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
                     NS_ASSERT(gr);
                     gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
                                           Ipv4Mask("0.0.0.0"),
@@ -1312,17 +1877,29 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
     return false;
 }
 
-// quagga ospf_spf_calculate
 void
 GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
+    SPFCalculate(GetSPFRoot(root), nullptr);
+}
+
+// quagga ospf_spf_calculate
+void
+GlobalRouteManagerImpl::SPFCalculate(const SPFRoot& spfRoot, SPFTree* tree)
+{
+    NS_LOG_FUNCTION(this << spfRoot.routerId << tree);
 
+    Ipv4Address root = spfRoot.routerId;
+    m_spfrootIpv4 = spfRoot.ipv4;
+    m_spfrootRouting = spfRoot.routing;
     SPFVertex* v;
     //
-    // Initialize the Link State Database.
+    // Initialize the SPF status of the LSAs, kept aside from the LSDB, which
+    // may be shared with other threads.
     //
-    m_lsdb->Initialize();
+    m_spfStatus.clear();
+    m_spfRouteRanks.clear();
     //
     // The candidate queue is a priority queue of SPFVertex objects, with the top
     // of the queue being the closest vertex in terms of distance from the root
@@ -1342,7 +1919,7 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     //
     m_spfroot = v;
     v->SetDistanceFromRoot(0);
-    v->GetLSA()->SetStatus(GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+    SetSPFStatus(v->GetLSA(), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
     NS_LOG_LOGIC("Starting SPFCalculate for node " << root);
 
     //
@@ -1352,10 +1929,13 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     // reached.  Instead, short-circuit this computation and just install
     // a default route in the CheckForStubNode() method.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (m_spfrootRouting && CheckForStubNode(root))
     {
         NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
         delete m_spfroot;
+        m_spfroot = nullptr;
+        m_spfrootIpv4 = nullptr;
+        m_spfrootRouting = nullptr;
         return;
     }
 
@@ -1403,7 +1983,7 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
         // Update the status field of the vertex to indicate that it is in the SPF
         // tree.
         //
-        v->GetLSA()->SetStatus(GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+        SetSPFStatus(v->GetLSA(), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
         //
         // The current vertex has a parent pointer.  By calling this rather oddly
         // named method (blame quagga) we add the current vertex to the list of
@@ -1470,6 +2050,44 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
         ProcessASExternals(m_spfroot, extlsa);
     }
 
+    //
+    // Keep the distances, parents and exits of the vertices, for the
+    // incremental updates of the routes.
+    //
+    if (tree)
+    {
+        std::vector<SPFVertex*> stack{m_spfroot};
+        while (!stack.empty())
+        {
+            SPFVertex* vertex = stack.back();
+            stack.pop_back();
+            auto [it, inserted] = tree->try_emplace(vertex->GetVertexId());
+            if (!inserted)
+            {
+                continue;
+            }
+            SPFTreeVertex& treeVertex = it->second;
+            treeVertex.distance = vertex->GetDistanceFromRoot();
+            for (uint32_t i = 0; vertex->GetParent(i); i++)
+            {
+                treeVertex.parents.push_back(vertex->GetParent(i)->GetVertexId());
+            }
+            for (uint32_t i = 0; i < vertex->GetNRootExitDirections(); i++)
+            {
+                treeVertex.exits.push_back(vertex->GetRootExitDirection(i));
+            }
+            auto ranks = m_spfRouteRanks.find(vertex->GetVertexId());
+            if (ranks != m_spfRouteRanks.end())
+            {
+                std::tie(treeVertex.hostRank, treeVertex.networkRank) = ranks->second;
+            }
+            for (uint32_t i = 0; i < vertex->GetNChildren(); i++)
+            {
+                stack.push_back(vertex->GetChild(i));
+            }
+        }
+    }
+
     //
     // We're all done setting the routing information for the node at the root of
     // the SPF tree.  Delete all of the vertices and corresponding resources.  Go
@@ -1477,6 +2095,8 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     //
     delete m_spfroot;
     m_spfroot = nullptr;
+    m_spfrootIpv4 = nullptr;
+    m_spfrootRouting = nullptr;
 }
 
 void
@@ -1490,6 +2110,10 @@ GlobalRouteManagerImpl::ProcessASExternals(SPFVertex* v, GlobalRoutingLSA* extls
     {
         GlobalRoutingLSA* rlsa = v->GetLSA();
         NS_LOG_LOGIC("Processing router LSA with id " << rlsa->GetLinkStateId());
+        if (m_spfrootRouting)
+        {
+            m_spfRouteRanks[v->GetVertexId()].second = m_spfrootRouting->GetNextRouteRank();
+        }
         if ((rlsa->GetLinkStateId()) == (extlsa->GetAdvertisingRouter()))
         {
             NS_LOG_LOGIC("Found advertising router to destination");
@@ -1533,105 +2157,47 @@ GlobalRouteManagerImpl::SPFAddASExternal(GlobalRoutingLSA* extlsa, SPFVertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The routing information is written to the router at the root of the SPF
+    // tree, found by GetSPFRoots ().  Without it (e.g., in the unit tests of the
+    // LSDB), there is nothing to write.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+    if (!gr)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
-        {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
-        }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() != routerId)
-        {
-            continue;
-        }
-
-        NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-        //
-        // Routing information is updated using the Ipv4 interface.  We need to QI
-        // for that interface.  If the node is acting as an IP version 4 router, it
-        // should absolutely have an Ipv4 interface.
-        //
-        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-        NS_ASSERT_MSG(ipv4,
-                      "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                      "QI for <Ipv4> interface failed");
-        //
-        // Get the Global Router Link State Advertisement from the vertex we're
-        // adding the routes to.  The LSA will have a number of attached Global Router
-        // Link Records corresponding to links off of that vertex / node.  We're going
-        // to be interested in the records corresponding to point-to-point links.
-        //
-        NS_ASSERT_MSG(v->GetLSA(),
-                      "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                      "Expected valid LSA in SPFVertex* v");
-        Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-        Ipv4Address tempip = extlsa->GetLinkStateId();
-        tempip = tempip.CombineMask(tempmask);
-
-        //
-        // Here's why we did all of that work.  We're going to add a host route to the
-        // host address found in the m_linkData field of the point-to-point link
-        // record.  In the case of a point-to-point link, this is the local IP address
-        // of the node connected to the link.  Each of these point-to-point links
-        // will correspond to a local interface that has an IP address to which
-        // the node at the root of the SPF tree can send packets.  The vertex <v>
-        // (corresponding to the node that has these links and interfaces) has
-        // an m_nextHop address precalculated for us that is the address to which the
-        // root node should send packets to be forwarded to these IP addresses.
-        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-        // which the packets should be send for forwarding.
-        //
-        Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-        if (!router)
+        NS_LOG_LOGIC("Can't find root node " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for router " << routerId);
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = extlsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+    {
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            continue;
+            gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " add external network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface "
+                                   << outIf);
         }
-        Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-        NS_ASSERT(gr);
-        // walk through all next-hop-IPs and out-going-interfaces for reaching
-        // the stub network gateway 'v' from the root node
-        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+        else
         {
-            SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-            Ipv4Address nextHop = exit.first;
-            int32_t outIf = exit.second;
-            if (outIf >= 0)
-            {
-                gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                       << " add external network route to " << tempip
-                                       << " using next hop " << nextHop << " via interface "
-                                       << outIf);
-            }
-            else
-            {
-                NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                       << " NOT able to add network route to " << tempip
-                                       << " using next hop " << nextHop
-                                       << " since outgoing interface id is negative");
-            }
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
         }
-        return;
-    } // for
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
@@ -1646,6 +2212,10 @@ GlobalRouteManagerImpl::SPFProcessStubs(SPFVertex* v)
     {
         GlobalRoutingLSA* rlsa = v->GetLSA();
         NS_LOG_LOGIC("Processing router LSA with id " << rlsa->GetLinkStateId());
+        if (m_spfrootRouting)
+        {
+            m_spfRouteRanks[v->GetVertexId()].second = m_spfrootRouting->GetNextRouteRank();
+        }
         for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
         {
             NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
@@ -1690,118 +2260,58 @@ GlobalRouteManagerImpl::SPFIntraAddStub(GlobalRoutingLinkRecord* l, SPFVertex* v
     NS_LOG_LOGIC("Stub is on remote host: " << v->GetVertexId() << "; installing");
     //
     // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // going to write the actual routing table entries.  Its routing protocol
+    // was found by GetSPFRoots () before the calculation of the tree.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
+    Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+    if (!gr)
+    {
+        NS_LOG_LOGIC("Can't find root node " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for router " << routerId);
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask(l->GetLinkData().Get());
+    Ipv4Address tempip = l->GetLinkId();
+    tempip = tempip.CombineMask(tempmask);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The vertex <v> (corresponding to the node that has the stub network) has
+    // the next hops and the outbound interfaces precalculated for us, through
+    // which the root node should send packets to be forwarded to the network.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " add network route to "
+                                   << tempip << " using next hop " << nextHop
+                                   << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is a wrapper around GetInterfaceForPrefix() of the node at the root
+// of the SPF tree.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
@@ -1810,67 +2320,18 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
 {
     NS_LOG_FUNCTION(this << a << amask);
     //
-    // We have an IP address <a> and a vertex ID of the root of the SPF tree.
-    // The question is what interface index does this address correspond to.
-    // The answer is a little complicated since we have to find a pointer to
-    // the node corresponding to the vertex ID, find the Ipv4 interface on that
-    // node in order to iterate the interfaces and find the one corresponding to
-    // the address in question.
-    //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
-    //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
+    // We have an IP address <a> and the Ipv4 interface of the node at the
+    // root of the SPF tree, found by GetSPFRoots ().  Look through the
+    // interfaces on this node for one that has the IP address we're looking
+    // for.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_spfrootIpv4)
     {
-        Ptr<Node> node = *i;
-
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-        //
-        // If the node doesn't have a GlobalRouter interface it can't be the one
-        // we're interested in.
-        //
-        if (!rtr)
-        {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
-        }
+        NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node "
+                     << (m_spfroot ? m_spfroot->GetVertexId() : Ipv4Address()));
+        return -1;
     }
-    //
-    // Couldn't find it.
-    //
-    NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node " << routerId);
-    return -1;
+    return m_spfrootIpv4->GetInterfaceForPrefix(a, amask);
 }
 
 //
@@ -1897,138 +2358,88 @@ GlobalRouteManagerImpl::SPFIntraAddRouter(SPFVertex* v)
     NS_ASSERT_MSG(m_spfroot, "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
     //
     // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // going to write the actual routing table entries.  Its routing protocol
+    // was found by GetSPFRoots () before the calculation of the tree.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
+    Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+    if (!gr)
+    {
+        NS_LOG_LOGIC("Can't find root node " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for router " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
-    {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in SPFVertex* v");
+    m_spfRouteRanks[v->GetVertexId()].first = gr->GetNextRouteRank();
 
-        if (!rtr)
-        {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
-        }
+    uint32_t nLinkRecords = lsa->GetNLinkRecords();
+    //
+    // Iterate through the link records on the vertex to which we're going to add
+    // routes.  To make sure we're being clear, we're going to add routing table
+    // entries to the tables on the node corresponding to the root of the SPF tree.
+    // These entries will have routes to the IP addresses we find from looking at
+    // the local side of the point-to-point links found on the node described by
+    // the vertex <v>.
+    //
+    NS_LOG_LOGIC(" Router " << routerId << " found " << nLinkRecords << " link records in LSA "
+                            << lsa << "with LinkStateId " << lsa->GetLinkStateId());
+    for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // We are only concerned about point-to-point links
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() != routerId)
+        GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
+        if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
         {
             continue;
         }
-
-        NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-        //
-        // Routing information is updated using the Ipv4 interface.  We need to
-        // GetObject for that interface.  If the node is acting as an IP version 4
-        // router, it should absolutely have an Ipv4 interface.
         //
-        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-        NS_ASSERT_MSG(ipv4,
-                      "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                      "GetObject for <Ipv4> interface failed");
-        //
-        // Get the Global Router Link State Advertisement from the vertex we're
-        // adding the routes to.  The LSA will have a number of attached Global Router
-        // Link Records corresponding to links off of that vertex / node.  We're going
-        // to be interested in the records corresponding to point-to-point links.
-        //
-        GlobalRoutingLSA* lsa = v->GetLSA();
-        NS_ASSERT_MSG(lsa,
-                      "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                      "Expected valid LSA in SPFVertex* v");
-
-        uint32_t nLinkRecords = lsa->GetNLinkRecords();
-        //
-        // Iterate through the link records on the vertex to which we're going to add
-        // routes.  To make sure we're being clear, we're going to add routing table
-        // entries to the tables on the node corresponding to the root of the SPF tree.
-        // These entries will have routes to the IP addresses we find from looking at
-        // the local side of the point-to-point links found on the node described by
-        // the vertex <v>.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                              << " link records in LSA " << lsa << "with LinkStateId "
-                              << lsa->GetLinkStateId());
-        for (uint32_t j = 0; j < nLinkRecords; ++j)
+        // walk through all available exit directions due to ECMP,
+        // and add host route for each of the exit direction toward
+        // the vertex 'v'
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            //
-            // We are only concerned about point-to-point links
-            //
-            GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
-            if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
+            SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
             {
-                continue;
+                gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " adding host route to "
+                                       << lr->GetLinkData() << " using next hop " << nextHop
+                                       << " and outgoing interface " << outIf);
             }
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
+            else
             {
-                continue;
+                NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                       << " NOT able to add host route to " << lr->GetLinkData()
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative " << outIf);
             }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " adding host route to " << lr->GetLinkData()
-                                           << " using next hop " << nextHop
-                                           << " and outgoing interface " << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add host route to " << lr->GetLinkData()
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
-            } // for all routes from the root the vertex 'v'
-        }
-        //
-        // Done adding the routes for the selected node.
-        //
-        return;
+        } // for all routes from the root the vertex 'v'
     }
 }
 
@@ -2040,98 +2451,53 @@ GlobalRouteManagerImpl::SPFIntraAddTransit(SPFVertex* v)
     NS_ASSERT_MSG(m_spfroot, "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
     //
     // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // going to write the actual routing table entries.  Its routing protocol
+    // was found by GetSPFRoots () before the calculation of the tree.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
+    Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+    if (!gr)
+    {
+        NS_LOG_LOGIC("Can't find root node " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("setting routes for router " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to: the network LSA of a transit network.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                  "Expected valid LSA in SPFVertex* v");
+    m_spfRouteRanks[v->GetVertexId()].second = gr->GetNextRouteRank();
+    Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = lsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+    // walk through all available exit directions due to ECMP,
+    // and add host route for each of the exit direction toward
+    // the vertex 'v'
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
 
-        if (!rtr)
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " add network route to "
+                                   << tempip << " using next hop " << nextHop
+                                   << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
-            }
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative " << outIf);
         }
     }
 }
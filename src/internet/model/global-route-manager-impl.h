@@ -11,6 +11,7 @@
 #define GLOBAL_ROUTE_MANAGER_IMPL_H
 
 #include "global-router-interface.h"
+#include "ipv4-routing-table-entry.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/object.h"
@@ -20,6 +21,7 @@
 #include <map>
 #include <queue>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -28,6 +30,7 @@ namespace ns3
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -628,6 +631,29 @@ class GlobalRouteManagerLSDB
      */
     GlobalRoutingLSA* GetLSAByLinkData(Ipv4Address addr) const;
 
+    /**
+     * @brief Get the Link State Advertisements that differ from those of
+     * another database.
+     *
+     * External Link State Advertisements are not compared; see
+     * HasSameExtLSAs ().
+     *
+     * @param other the other database
+     * @returns the link state IDs of the LSAs that are only in one of the
+     * databases, or whose contents differ, in increasing order.
+     */
+    std::vector<Ipv4Address> GetChangedLSAs(const GlobalRouteManagerLSDB& other) const;
+
+    /**
+     * @brief Compare the External Link State Advertisements with those of
+     * another database.
+     *
+     * @param other the other database
+     * @returns true if the databases have the same External LSAs, in the
+     * same order.
+     */
+    bool HasSameExtLSAs(const GlobalRouteManagerLSDB& other) const;
+
     /**
      * @brief Set all LSA flags to an initialized state, for SPF computation
      *
@@ -670,6 +696,9 @@ class GlobalRouteManagerLSDB
     LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
     std::vector<GlobalRoutingLSA*>
         m_extdatabase; //!< database of External Link State Advertisements
+    /// the LSAs with the lowest link state ID having a TransitNetwork link
+    /// record, by the LinkData field of the record
+    std::unordered_map<Ipv4Address, GlobalRoutingLSA*, Ipv4AddressHash> m_linkDataIndex;
 };
 
 /**
@@ -714,6 +743,23 @@ class GlobalRouteManagerImpl
      */
     virtual void InitializeRoutes();
 
+    /**
+     * @brief Recompute the routes after a change of the links.
+     *
+     * If the GlobalValue GlobalRoutingIncremental is true and the SPF trees
+     * of the routers were kept by InitializeRoutes (), the routing database
+     * is built again and compared with the previous one.  Only the routers
+     * whose SPF tree is affected by the LSAs that changed calculate their
+     * tree and their routes again; the other routers only update their routes
+     * to the destinations advertised by the LSAs that changed.  The resulting
+     * routes are those of a complete recomputation, though the routes updated
+     * are placed after the others in the routing tables.
+     *
+     * Otherwise, this is DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+     * and InitializeRoutes ().
+     */
+    virtual void UpdateRoutes();
+
     /**
      * @brief Debugging routine; allow client code to supply a pre-built LSDB
      * @param lsdb the pre-built LSDB
@@ -727,8 +773,174 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /**
+     * @brief A router at the root of the SPF calculations, with the node
+     * the routes are written to.
+     */
+    struct SPFRoot
+    {
+        Ipv4Address routerId;           //!< the router ID
+        Ptr<Ipv4> ipv4;                 //!< the IPv4 stack of the node, if found
+        Ptr<Ipv4GlobalRouting> routing; //!< the global routing of the node, if found
+    };
+
+    /**
+     * @brief A vertex of an SPF tree, as kept for the incremental updates.
+     */
+    struct SPFTreeVertex
+    {
+        uint32_t distance;                        //!< the distance from the root
+        std::vector<Ipv4Address> parents;         //!< the vertex IDs of the parents
+        std::vector<SPFVertex::NodeExit_t> exits; //!< the exit directions from the root
+        uint64_t hostRank{0};    //!< the rank of the first host route of the root to the vertex
+        uint64_t networkRank{0}; //!< the rank of the first network route of the root to the vertex
+    };
+
+    /// The vertices of an SPF tree by vertex ID, empty for a stub router
+    typedef std::unordered_map<Ipv4Address, SPFTreeVertex, Ipv4AddressHash> SPFTree;
+
+    /**
+     * @brief A link from a vertex to another one, as followed by SPFNext ().
+     */
+    struct SPFLink
+    {
+        Ipv4Address from; //!< the vertex ID of the origin
+        Ipv4Address to;   //!< the vertex ID of the destination
+        uint32_t metric;  //!< the metric of the link
+        Ipv4Address data; //!< the LinkData of the link record, or the attached router
+    };
+
+    /**
+     * @brief Construct a Global Route Manager calculating the routes on the
+     * LSDB of another one, e.g., in another thread.
+     *
+     * @param lsdb the LSDB, which is not released by this manager
+     */
+    GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb);
+
     SPFVertex* m_spfroot;           //!< the root node
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    bool m_ownLsdb;                 //!< whether the LSDB is released by this manager
+    Ptr<Ipv4> m_spfrootIpv4;        //!< the IPv4 stack of the node of the root node
+    Ptr<Ipv4GlobalRouting> m_spfrootRouting; //!< the global routing of the node of the root node
+    /// the status of the LSAs in the current SPF calculation, if not LSA_SPF_NOT_EXPLORED
+    std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_spfStatus;
+    /// the ranks of the first host and network routes to the vertices in the current SPF
+    /// calculation, by vertex ID
+    std::unordered_map<Ipv4Address, std::pair<uint64_t, uint64_t>, Ipv4AddressHash>
+        m_spfRouteRanks;
+    std::map<Ipv4Address, SPFTree> m_spfTrees; //!< the SPF trees kept, by root router ID
+
+    /**
+     * @brief Get the routers at the root of the SPF calculations of this
+     * system, i.e., those exporting LSAs.
+     *
+     * @returns the routers, in the order of their node
+     */
+    std::vector<SPFRoot> GetSPFRoots() const;
+
+    /**
+     * @brief Get a router at the root of an SPF calculation.
+     *
+     * @param routerId the router ID
+     * @returns the router, without node if none has this router ID
+     */
+    SPFRoot GetSPFRoot(Ipv4Address routerId) const;
+
+    /**
+     * @brief Calculate the SPF trees and the routes of routers.
+     *
+     * The trees are calculated by the number of threads of the GlobalValue
+     * GlobalRoutingThreads, and kept if GlobalRoutingIncremental is true.
+     *
+     * @param roots the routers
+     */
+    void CalculateRoutes(const std::vector<SPFRoot>& roots);
+
+    /**
+     * @brief Delete the routes of a global routing.
+     *
+     * @param routing the global routing
+     */
+    static void DeleteRoutes(Ptr<Ipv4GlobalRouting> routing);
+
+    /**
+     * @brief Get the links followed by SPFNext () from the vertex of a LSA.
+     *
+     * @param lsdb the LSDB of the LSA
+     * @param lsa the LSA, possibly null
+     * @param links the links, to which those of the LSA are added
+     */
+    static void GetSPFLinks(const GlobalRouteManagerLSDB* lsdb,
+                            const GlobalRoutingLSA* lsa,
+                            std::vector<SPFLink>& links);
+
+    /**
+     * @brief Test if an SPF tree may be changed by a change of the LSDB.
+     *
+     * @param root the router ID of the root
+     * @param tree the SPF tree
+     * @param changed the link state IDs of the LSAs that changed
+     * @param removed the links that are no longer in the LSDB
+     * @param added the links that are new in the LSDB
+     * @returns true if the tree must be calculated again
+     */
+    bool IsSPFTreeAffected(Ipv4Address root,
+                           const SPFTree& tree,
+                           const std::vector<Ipv4Address>& changed,
+                           const std::vector<SPFLink>& removed,
+                           const std::vector<SPFLink>& added) const;
+
+    /**
+     * @brief Update the routes of a router whose SPF tree is not changed to
+     * the destinations advertised by the LSAs that changed.
+     *
+     * @param root the router
+     * @param tree the SPF tree of the router
+     * @param changed the link state IDs of the LSAs that changed
+     * @param oldLsdb the previous LSDB
+     * @returns false if an LSA advertises destinations of a kind it did not
+     * advertise before, whose routes have no place in the table yet: the
+     * SPF tree must then be calculated again
+     */
+    bool UpdateSPFTreeRoutes(const SPFRoot& root,
+                             const SPFTree& tree,
+                             const std::vector<Ipv4Address>& changed,
+                             const GlobalRouteManagerLSDB* oldLsdb) const;
+
+    /**
+     * @brief Get the routes of a router to the destinations advertised by
+     * the LSA of a vertex of its SPF tree, in the order SPFCalculate ()
+     * adds them.
+     *
+     * @param lsa the LSA of the vertex
+     * @param exits the exit directions of the vertex
+     * @param [out] hostRoutes the host routes
+     * @param [out] networkRoutes the network routes
+     */
+    static void GetSPFTreeRoutes(const GlobalRoutingLSA* lsa,
+                                 const std::vector<SPFVertex::NodeExit_t>& exits,
+                                 std::vector<Ipv4RoutingTableEntry>& hostRoutes,
+                                 std::vector<Ipv4RoutingTableEntry>& networkRoutes);
+
+    /**
+     * @brief Get the status of a LSA in the current SPF calculation.
+     *
+     * @param lsa the LSA
+     * @returns the status
+     */
+    GlobalRoutingLSA::SPFStatus GetSPFStatus(const GlobalRoutingLSA* lsa) const;
+
+    /**
+     * @brief Set the status of a LSA in the current SPF calculation.
+     *
+     * The status is kept by the Global Route Manager rather than in the LSA,
+     * so that several managers calculate SPF trees on the same LSDB.
+     *
+     * @param lsa the LSA
+     * @param status the status
+     */
+    void SetSPFStatus(const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
 
     /**
      * @brief Test if a node is a stub, from an OSPF sense.
@@ -750,6 +962,15 @@ class GlobalRouteManagerImpl
      */
     void SPFCalculate(Ipv4Address root);
 
+    /**
+     * @brief Calculate the shortest path first (SPF) tree
+     *
+     * Equivalent to quagga ospf_spf_calculate
+     * @param root the root node
+     * @param tree the tree to keep the vertices of the SPF tree in, if any
+     */
+    void SPFCalculate(const SPFRoot& root, SPFTree* tree);
+
     /**
      * @brief Process Stub nodes
      *
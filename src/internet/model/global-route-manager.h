@@ -59,6 +59,14 @@ class GlobalRouteManager
      * per-node forwarding tables
      */
     static void InitializeRoutes();
+
+    /**
+     * @brief Recompute the routes after a change of the links, only for the
+     * routers affected by the change if GlobalRoutingIncremental is true.
+     *
+     * @see GlobalRouteManagerImpl::UpdateRoutes
+     */
+    static void UpdateRoutes();
 };
 
 } // namespace ns3
@@ -13,6 +13,8 @@
 
 #include "ns3/log.h"
 
+#include <bit>
+
 namespace ns3
 {
 
@@ -21,9 +23,11 @@ NS_LOG_COMPONENT_DEFINE("Ipv4EndPointDemux");
 Ipv4EndPointDemux::Ipv4EndPointDemux()
     : m_ephemeral(49152),
       m_portLast(65535),
-      m_portFirst(49152)
+      m_portFirst(49152),
+      m_sequence(0)
 {
     NS_LOG_FUNCTION(this);
+    m_portsInUse.resize(65536 / 64, 0);
 }
 
 Ipv4EndPointDemux::~Ipv4EndPointDemux()
@@ -32,6 +36,7 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv4EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
@@ -41,24 +46,21 @@ bool
 Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
 {
     NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        if ((*i)->GetLocalPort() == port)
-        {
-            return true;
-        }
-    }
-    return false;
+    return (m_portsInUse[port / 64] >> (port % 64)) & 1;
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto it = m_ports.find(port);
+    if (it == m_ports.end())
+    {
+        return false;
+    }
+    for (Ipv4EndPoint* endP : it->second)
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        if (endP->GetLocalAddress() == addr && endP->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -77,9 +79,7 @@ Ipv4EndPointDemux::Allocate()
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(endPoint);
 }
 
 Ipv4EndPoint*
@@ -93,9 +93,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(endPoint);
 }
 
 Ipv4EndPoint*
@@ -116,9 +114,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(endPoint);
 }
 
 Ipv4EndPoint*
@@ -129,38 +125,46 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // Only the endpoints indexed under the same peer can be duplicates
+    if (const EndPoints* indexed = GetIndexed(localPort, peerAddress, peerPort))
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (Ipv4EndPoint* endP : *indexed)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if (endP->GetLocalPort() == localPort && endP->GetLocalAddress() == localAddress &&
+                endP->GetPeerPort() == peerPort && endP->GetPeerAddress() == peerAddress &&
+                (endP->GetBoundNetDevice() == boundNetDevice || !endP->GetBoundNetDevice()))
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     auto endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
-
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-
-    return endPoint;
+    return Insert(endPoint);
 }
 
 void
 Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this << endPoint);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto it = m_positions.find(endPoint);
+    if (it == m_positions.end())
     {
-        if (*i == endPoint)
-        {
-            delete endPoint;
-            m_endPoints.erase(i);
-            break;
-        }
+        return;
+    }
+    m_endPoints.erase(it->second);
+    m_positions.erase(it);
+    Unindex(endPoint);
+    auto port = m_ports.find(endPoint->GetLocalPort());
+    port->second.erase(endPoint);
+    if (port->second.empty())
+    {
+        m_portsInUse[port->first / 64] &= ~(uint64_t(1) << (port->first % 64));
+        m_ports.erase(port);
     }
+    endPoint->m_demux = nullptr;
+    delete endPoint;
 }
 
 /*
@@ -200,9 +204,36 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval4; // Exact match on all 4
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // Only the endpoints connected to the source of the packet, and those which
+    // may match any peer, can match the packet
+    const EndPoints* connected = GetIndexed(dport, saddr, sport);
+    const EndPoints* unconnected = GetIndexed(dport, Ipv4Address::GetAny(), 0);
+    const EndPoints none;
+    if (!connected || connected == unconnected)
     {
-        Ipv4EndPoint* endP = *i;
+        connected = &none;
+    }
+    if (!unconnected)
+    {
+        unconnected = &none;
+    }
+    // Visit the endpoints of both buckets in their order of insertion, as if
+    // scanning the list of all the endpoints
+    auto connectedIt = connected->begin();
+    auto unconnectedIt = unconnected->begin();
+    while (connectedIt != connected->end() || unconnectedIt != unconnected->end())
+    {
+        Ipv4EndPoint* endP;
+        if (unconnectedIt == unconnected->end() ||
+            (connectedIt != connected->end() &&
+             (*connectedIt)->m_sequence < (*unconnectedIt)->m_sequence))
+        {
+            endP = *connectedIt++;
+        }
+        else
+        {
+            endP = *unconnectedIt++;
+        }
 
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
@@ -395,25 +426,131 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
     return generic;
 }
 
-uint16_t
-Ipv4EndPointDemux::AllocateEphemeralPort()
+std::size_t
+Ipv4EndPointDemux::ConnectionKeyHash::operator()(const ConnectionKey& key) const
 {
-    // Similar to counting up logic in netinet/in_pcb.c
-    NS_LOG_FUNCTION(this);
-    uint16_t port = m_ephemeral;
-    int count = m_portLast - m_portFirst;
-    do
+    uint64_t ports = (uint64_t(key.localPort) << 16) | key.peerPort;
+    return std::hash<uint64_t>()((uint64_t(key.peerAddress.Get()) << 32) | ports);
+}
+
+Ipv4EndPoint*
+Ipv4EndPointDemux::Insert(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    m_positions[endPoint] = m_endPoints.insert(m_endPoints.end(), endPoint);
+    uint16_t port = endPoint->GetLocalPort();
+    m_ports[port].insert(endPoint);
+    m_portsInUse[port / 64] |= uint64_t(1) << (port % 64);
+    endPoint->m_demux = this;
+    endPoint->m_sequence = m_sequence++;
+    Index(endPoint);
+    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    EndPoints* endPoints;
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv4Address::GetAny())
+    {
+        ConnectionKey key{endPoint->GetLocalPort(),
+                          endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort()};
+        endPoints = &m_connected[key];
+    }
+    else
+    {
+        endPoints = &m_unconnected[endPoint->GetLocalPort()];
+    }
+    // Keep the endpoints in their order of insertion in the demux, also when
+    // their peer is set later, so that the lookups visit them in that order
+    auto it = endPoints->rbegin();
+    while (it != endPoints->rend() && (*it)->m_sequence > endPoint->m_sequence)
+    {
+        it++;
+    }
+    endPoints->insert(it.base(), endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unindex(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv4Address::GetAny())
     {
-        if (count-- < 0)
+        ConnectionKey key{endPoint->GetLocalPort(),
+                          endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort()};
+        auto it = m_connected.find(key);
+        it->second.remove(endPoint);
+        if (it->second.empty())
         {
-            return 0;
+            m_connected.erase(it);
         }
-        ++port;
-        if (port < m_portFirst || port > m_portLast)
+    }
+    else
+    {
+        auto it = m_unconnected.find(endPoint->GetLocalPort());
+        it->second.remove(endPoint);
+        if (it->second.empty())
+        {
+            m_unconnected.erase(it);
+        }
+    }
+}
+
+const Ipv4EndPointDemux::EndPoints*
+Ipv4EndPointDemux::GetIndexed(uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort) const
+{
+    if (peerPort != 0 && peerAddress != Ipv4Address::GetAny())
+    {
+        auto it = m_connected.find({localPort, peerAddress, peerPort});
+        return it != m_connected.end() ? &it->second : nullptr;
+    }
+    auto it = m_unconnected.find(localPort);
+    return it != m_unconnected.end() ? &it->second : nullptr;
+}
+
+uint16_t
+Ipv4EndPointDemux::FindFreePort(uint16_t first, uint16_t last) const
+{
+    uint32_t port = first;
+    while (port <= last)
+    {
+        // The free ports of the word of the bitmap, from the current one
+        uint64_t free = ~m_portsInUse[port / 64] >> (port % 64);
+        if (free != 0)
         {
-            port = m_portFirst;
+            port += std::countr_zero(free);
+            return port <= last ? port : 0;
         }
-    } while (LookupPortLocal(port));
+        port += 64 - port % 64;
+    }
+    return 0;
+}
+
+uint16_t
+Ipv4EndPointDemux::AllocateEphemeralPort()
+{
+    // Similar to counting up logic in netinet/in_pcb.c, the ports in use being
+    // found in the bitmap
+    NS_LOG_FUNCTION(this);
+    uint16_t start = m_ephemeral + 1;
+    if (start < m_portFirst || start > m_portLast)
+    {
+        start = m_portFirst;
+    }
+    uint16_t port = FindFreePort(start, m_portLast);
+    if (port == 0 && start > m_portFirst)
+    {
+        port = FindFreePort(m_portFirst, start - 1);
+    }
+    if (port == 0)
+    {
+        return 0;
+    }
     m_ephemeral = port;
     return port;
 }
@@ -15,6 +15,9 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ns3
 {
@@ -31,6 +34,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed in hash tables, so that a lookup only examines
+ * the endpoints connected to the source of the packet, by local port, peer
+ * address and peer port, and the endpoints which may match any peer, by
+ * local port.  Both are visited in the order in which the endpoints were
+ * inserted, as in the list of all the endpoints.  The local ports in use are
+ * tracked in a bitmap, from which the ephemeral ports are allocated.
  */
 
 class Ipv4EndPointDemux
@@ -160,6 +170,79 @@ class Ipv4EndPointDemux
     void DeAllocate(Ipv4EndPoint* endPoint);
 
   private:
+    friend class Ipv4EndPoint;
+
+    /**
+     * @brief Key of the connected endpoints, i.e., whose peer address and
+     * port are both set.
+     */
+    struct ConnectionKey
+    {
+        uint16_t localPort;      //!< The local port.
+        Ipv4Address peerAddress; //!< The peer address.
+        uint16_t peerPort;       //!< The peer port.
+
+        /**
+         * @param other Another key.
+         * @returns true if the keys are equal.
+         */
+        bool operator==(const ConnectionKey& other) const = default;
+    };
+
+    /**
+     * @brief Hash function of the keys of the connected endpoints.
+     */
+    struct ConnectionKeyHash
+    {
+        /**
+         * @param key The key.
+         * @returns The hash of the key.
+         */
+        std::size_t operator()(const ConnectionKey& key) const;
+    };
+
+    /**
+     * @brief Add a new endpoint to the demux.
+     * @param endPoint the end point
+     * @return the end point
+     */
+    Ipv4EndPoint* Insert(Ipv4EndPoint* endPoint);
+
+    /**
+     * @brief Add an endpoint to the index of its peer, called when the endpoint
+     * is inserted, and when its peer is set.  The endpoint is placed after the
+     * endpoints inserted before it.
+     * @param endPoint the end point
+     */
+    void Index(Ipv4EndPoint* endPoint);
+
+    /**
+     * @brief Remove an endpoint from the index of its peer, called when the
+     * endpoint is removed, and before its peer is set.
+     * @param endPoint the end point
+     */
+    void Unindex(Ipv4EndPoint* endPoint);
+
+    /**
+     * @brief Get the endpoints indexed under the same peer as the given
+     * local port, peer address and peer port.
+     * @param localPort local port
+     * @param peerAddress peer address
+     * @param peerPort peer port
+     * @return the endpoints, or nullptr if none
+     */
+    const EndPoints* GetIndexed(uint16_t localPort,
+                                Ipv4Address peerAddress,
+                                uint16_t peerPort) const;
+
+    /**
+     * @brief Find the first local port not in use in a range.
+     * @param first the first port of the range
+     * @param last the last port of the range
+     * @returns the port, or 0 if all the ports of the range are in use
+     */
+    uint16_t FindFreePort(uint16_t first, uint16_t last) const;
+
     /**
      * @brief Allocate an ephemeral port.
      * @returns the ephemeral port
@@ -185,6 +268,36 @@ class Ipv4EndPointDemux
      * @brief A list of IPv4 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * @brief The connected endpoints, by local port and peer.
+     */
+    std::unordered_map<ConnectionKey, EndPoints, ConnectionKeyHash> m_connected;
+
+    /**
+     * @brief The other endpoints, which may match any peer, by local port.
+     */
+    std::unordered_map<uint16_t, EndPoints> m_unconnected;
+
+    /**
+     * @brief All the endpoints, by local port.
+     */
+    std::unordered_map<uint16_t, std::unordered_set<Ipv4EndPoint*>> m_ports;
+
+    /**
+     * @brief The position of the endpoints in the list of the endpoints.
+     */
+    std::unordered_map<Ipv4EndPoint*, EndPointsI> m_positions;
+
+    /**
+     * @brief The bitmap of the local ports in use.
+     */
+    std::vector<uint64_t> m_portsInUse;
+
+    /**
+     * @brief The order of insertion of the next endpoint.
+     */
+    uint64_t m_sequence;
 };
 
 } // namespace ns3
@@ -23,6 +23,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * @ingroup ipv4
@@ -180,6 +181,8 @@ class Ipv4EndPoint
     bool IsRxEnabled() const;
 
   private:
+    friend class Ipv4EndPointDemux;
+
     /**
      * @brief The local address.
      */
@@ -224,6 +227,16 @@ class Ipv4EndPoint
      * @brief true if the endpoint can receive packets.
      */
     bool m_rxEnabled;
+
+    /**
+     * @brief The demux indexing the endpoint by its peer (if any).
+     */
+    Ipv4EndPointDemux* m_demux;
+
+    /**
+     * @brief The order of insertion of the endpoint in its demux.
+     */
+    uint64_t m_sequence;
 };
 
 } // namespace ns3
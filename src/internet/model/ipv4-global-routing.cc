@@ -10,6 +10,7 @@
 #include "ipv4-route.h"
 #include "ipv4-routing-table-entry.h"
 
+#include "ns3/abort.h"
 #include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/names.h"
@@ -17,9 +18,13 @@
 #include "ns3/node.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/simulation-singleton.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
+#include <bit>
 #include <iomanip>
+#include <tuple>
 #include <vector>
 
 namespace ns3
@@ -47,13 +52,22 @@ Ipv4GlobalRouting::GetTypeId()
                           "Interface notification events (up/down, or add/remove address)",
                           BooleanValue(false),
                           MakeBooleanAccessor(&Ipv4GlobalRouting::m_respondToInterfaceEvents),
+                          MakeBooleanChecker())
+            .AddAttribute("CompactRoutes",
+                          "Set to true to store the routes in compact routing tables, sharing "
+                          "the destinations among all the nodes, for the large topologies",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&Ipv4GlobalRouting::SetCompactRoutes,
+                                              &Ipv4GlobalRouting::GetCompactRoutes),
                           MakeBooleanChecker());
     return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_compactRoutes(false),
+      m_routeRank(0)
 {
     NS_LOG_FUNCTION(this);
 
@@ -69,18 +83,30 @@ void
 Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
 {
     NS_LOG_FUNCTION(this << dest << nextHop << interface);
+    if (m_compactRoutes)
+    {
+        m_compactHostRoutes->Add(dest, Ipv4Mask::GetOnes(), nextHop, interface);
+        return;
+    }
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    IndexRoute(m_hostRouteIndex, route);
 }
 
 void
 Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
 {
     NS_LOG_FUNCTION(this << dest << interface);
+    if (m_compactRoutes)
+    {
+        m_compactHostRoutes->Add(dest, Ipv4Mask::GetOnes(), Ipv4Address::GetZero(), interface);
+        return;
+    }
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    IndexRoute(m_hostRouteIndex, route);
 }
 
 void
@@ -90,18 +116,30 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
                                      uint32_t interface)
 {
     NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
+    if (m_compactRoutes)
+    {
+        m_compactNetworkRoutes->Add(network, networkMask, nextHop, interface);
+        return;
+    }
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    IndexRoute(m_networkRouteIndex, route);
 }
 
 void
 Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface)
 {
     NS_LOG_FUNCTION(this << network << networkMask << interface);
+    if (m_compactRoutes)
+    {
+        m_compactNetworkRoutes->Add(network, networkMask, Ipv4Address::GetZero(), interface);
+        return;
+    }
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    IndexRoute(m_networkRouteIndex, route);
 }
 
 void
@@ -111,9 +149,71 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
                                         uint32_t interface)
 {
     NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
+    if (m_compactRoutes)
+    {
+        m_compactASexternalRoutes->Add(network, networkMask, nextHop, interface);
+        return;
+    }
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    IndexRoute(m_ASexternalRouteIndex, route);
+}
+
+void
+Ipv4GlobalRouting::IndexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route)
+{
+    IndexRoute(index, route, m_routeRank);
+    m_routeRank += RANK_SPACING;
+}
+
+void
+Ipv4GlobalRouting::IndexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route, uint64_t rank)
+{
+    // a route is indexed by the leading ones of its mask, the other bits
+    // of a non-contiguous mask being checked by the lookup
+    index.Insert(RouteIndex::GetKey(route->GetDestNetwork()),
+                 std::countl_one(route->GetDestNetworkMask().Get()),
+                 std::make_pair(route, rank));
+}
+
+uint64_t
+Ipv4GlobalRouting::UnindexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route)
+{
+    uint64_t rank = 0;
+    bool found = index.RemoveIf(RouteIndex::GetKey(route->GetDestNetwork()),
+                                std::countl_one(route->GetDestNetworkMask().Get()),
+                                [route, &rank](const auto& indexed) {
+                                    if (indexed.first != route)
+                                    {
+                                        return false;
+                                    }
+                                    rank = indexed.second;
+                                    return true;
+                                });
+    NS_ASSERT_MSG(found, "Route " << *route << " not indexed");
+    return rank;
+}
+
+void
+Ipv4GlobalRouting::GetMatchingRoutes(const RouteIndex& index,
+                                     Ipv4Address dest,
+                                     std::vector<Ipv4RoutingTableEntry*>& routes) const
+{
+    std::vector<std::pair<Ipv4RoutingTableEntry*, uint64_t>> matches;
+    index.ForEachMatch(RouteIndex::GetKey(dest), [&matches](uint8_t, const auto& indexed) {
+        matches.insert(matches.end(), indexed.begin(), indexed.end());
+        return false;
+    });
+    // the routes of several prefixes are merged back in the order of the container
+    std::sort(matches.begin(), matches.end(), [](const auto& a, const auto& b) {
+        return a.second < b.second;
+    });
+    routes.clear();
+    for (const auto& match : matches)
+    {
+        routes.push_back(match.first);
+    }
 }
 
 Ptr<Ipv4Route>
@@ -126,8 +226,19 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
     RouteVec_t allRoutes;
 
+    // the candidate routes of the containers, from their indexes
+    std::vector<Ipv4RoutingTableEntry*> routes;
+
     NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    if (m_compactRoutes)
+    {
+        m_compactHostRoutes->GetMatchingRoutes(dest, routes);
+    }
+    else
+    {
+        GetMatchingRoutes(m_hostRouteIndex, dest, routes);
+    }
+    for (auto i = routes.begin(); i != routes.end(); i++)
     {
         NS_ASSERT((*i)->IsHost());
         if ((*i)->GetDest() == dest)
@@ -147,7 +258,15 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     if (allRoutes.empty()) // if no host route is found
     {
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        if (m_compactRoutes)
+        {
+            m_compactNetworkRoutes->GetMatchingRoutes(dest, routes);
+        }
+        else
+        {
+            GetMatchingRoutes(m_networkRouteIndex, dest, routes);
+        }
+        for (auto j = routes.begin(); j != routes.end(); j++)
         {
             Ipv4Mask mask = (*j)->GetDestNetworkMask();
             Ipv4Address entry = (*j)->GetDestNetwork();
@@ -168,7 +287,15 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        if (m_compactRoutes)
+        {
+            m_compactASexternalRoutes->GetMatchingRoutes(dest, routes);
+        }
+        else
+        {
+            GetMatchingRoutes(m_ASexternalRouteIndex, dest, routes);
+        }
+        for (auto k = routes.begin(); k != routes.end(); k++)
         {
             Ipv4Mask mask = (*k)->GetDestNetworkMask();
             Ipv4Address entry = (*k)->GetDestNetwork();
@@ -219,10 +346,36 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+Ipv4RoutingTableEntry
+Ipv4GlobalRouting::GetRouteEntry(uint32_t index) const
+{
+    NS_LOG_FUNCTION(this << index);
+    if (!m_compactRoutes)
+    {
+        return *GetRoute(index);
+    }
+    for (const auto* table :
+         {&m_compactHostRoutes, &m_compactNetworkRoutes, &m_compactASexternalRoutes})
+    {
+        if (index < (*table)->GetNRoutes())
+        {
+            return (*table)->GetRoute(index);
+        }
+        index -= (*table)->GetNRoutes();
+    }
+    NS_ASSERT(false);
+    return Ipv4RoutingTableEntry();
+}
+
 uint32_t
 Ipv4GlobalRouting::GetNRoutes() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_compactRoutes)
+    {
+        return m_compactHostRoutes->GetNRoutes() + m_compactNetworkRoutes->GetNRoutes() +
+               m_compactASexternalRoutes->GetNRoutes();
+    }
     uint32_t n = 0;
     n += m_hostRoutes.size();
     n += m_networkRoutes.size();
@@ -234,6 +387,11 @@ Ipv4RoutingTableEntry*
 Ipv4GlobalRouting::GetRoute(uint32_t index) const
 {
     NS_LOG_FUNCTION(this << index);
+    if (m_compactRoutes)
+    {
+        m_compactRoute = GetRouteEntry(index);
+        return &m_compactRoute;
+    }
     if (index < m_hostRoutes.size())
     {
         uint32_t tmp = 0;
@@ -278,6 +436,21 @@ void
 Ipv4GlobalRouting::RemoveRoute(uint32_t index)
 {
     NS_LOG_FUNCTION(this << index);
+    if (m_compactRoutes)
+    {
+        for (const auto* table :
+             {&m_compactHostRoutes, &m_compactNetworkRoutes, &m_compactASexternalRoutes})
+        {
+            if (index < (*table)->GetNRoutes())
+            {
+                (*table)->RemoveRoute(index);
+                return;
+            }
+            index -= (*table)->GetNRoutes();
+        }
+        NS_ASSERT(false);
+        return;
+    }
     if (index < m_hostRoutes.size())
     {
         uint32_t tmp = 0;
@@ -286,6 +459,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             if (tmp == index)
             {
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+                UnindexRoute(m_hostRouteIndex, *i);
                 delete *i;
                 m_hostRoutes.erase(i);
                 NS_LOG_LOGIC("Done removing host route "
@@ -302,6 +476,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
+            UnindexRoute(m_networkRouteIndex, *j);
             delete *j;
             m_networkRoutes.erase(j);
             NS_LOG_LOGIC("Done removing network route "
@@ -317,6 +492,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
+            UnindexRoute(m_ASexternalRouteIndex, *k);
             delete *k;
             m_ASexternalRoutes.erase(k);
             NS_LOG_LOGIC("Done removing network route "
@@ -328,6 +504,157 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
     NS_ASSERT(false);
 }
 
+bool
+Ipv4GlobalRouting::RemoveHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << dest << nextHop << interface);
+    if (m_compactRoutes)
+    {
+        return m_compactHostRoutes->Remove(dest, Ipv4Mask::GetOnes(), nextHop, interface);
+    }
+    auto i = std::find_if(m_hostRoutes.begin(), m_hostRoutes.end(), [&](const auto* route) {
+        return route->GetDest() == dest && route->GetGateway() == nextHop &&
+               route->GetInterface() == interface;
+    });
+    if (i == m_hostRoutes.end())
+    {
+        return false;
+    }
+    UnindexRoute(m_hostRouteIndex, *i);
+    delete *i;
+    m_hostRoutes.erase(i);
+    return true;
+}
+
+bool
+Ipv4GlobalRouting::RemoveNetworkRouteTo(Ipv4Address network,
+                                        Ipv4Mask networkMask,
+                                        Ipv4Address nextHop,
+                                        uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
+    if (m_compactRoutes)
+    {
+        return m_compactNetworkRoutes->Remove(network, networkMask, nextHop, interface);
+    }
+    auto j = std::find_if(m_networkRoutes.begin(), m_networkRoutes.end(), [&](const auto* route) {
+        return route->GetDestNetwork() == network && route->GetDestNetworkMask() == networkMask &&
+               route->GetGateway() == nextHop && route->GetInterface() == interface;
+    });
+    if (j == m_networkRoutes.end())
+    {
+        return false;
+    }
+    UnindexRoute(m_networkRouteIndex, *j);
+    delete *j;
+    m_networkRoutes.erase(j);
+    return true;
+}
+
+uint64_t
+Ipv4GlobalRouting::GetNextRouteRank() const
+{
+    return m_routeRank;
+}
+
+void
+Ipv4GlobalRouting::ReplaceHostRoutes(uint64_t rank,
+                                     const std::vector<Ipv4RoutingTableEntry>& oldRoutes,
+                                     const std::vector<Ipv4RoutingTableEntry>& newRoutes)
+{
+    NS_LOG_FUNCTION(this << rank << oldRoutes.size() << newRoutes.size());
+    ReplaceRoutes(m_hostRoutes,
+                  m_hostRouteIndex,
+                  m_compactHostRoutes.get(),
+                  rank,
+                  oldRoutes,
+                  newRoutes);
+}
+
+void
+Ipv4GlobalRouting::ReplaceNetworkRoutes(uint64_t rank,
+                                        const std::vector<Ipv4RoutingTableEntry>& oldRoutes,
+                                        const std::vector<Ipv4RoutingTableEntry>& newRoutes)
+{
+    NS_LOG_FUNCTION(this << rank << oldRoutes.size() << newRoutes.size());
+    ReplaceRoutes(m_networkRoutes,
+                  m_networkRouteIndex,
+                  m_compactNetworkRoutes.get(),
+                  rank,
+                  oldRoutes,
+                  newRoutes);
+}
+
+void
+Ipv4GlobalRouting::ReplaceRoutes(std::list<Ipv4RoutingTableEntry*>& routes,
+                                 RouteIndex& index,
+                                 CompactRouteTable* compactRoutes,
+                                 uint64_t rank,
+                                 const std::vector<Ipv4RoutingTableEntry>& oldRoutes,
+                                 const std::vector<Ipv4RoutingTableEntry>& newRoutes)
+{
+    NS_ASSERT_MSG(!oldRoutes.empty(), "No route to replace");
+    if (m_compactRoutes)
+    {
+        for (const auto& route : oldRoutes)
+        {
+            compactRoutes->Remove(route.GetDestNetwork(),
+                                  route.GetDestNetworkMask(),
+                                  route.GetGateway(),
+                                  route.GetInterface());
+        }
+        for (const auto& route : newRoutes)
+        {
+            compactRoutes->Add(route.GetDestNetwork(),
+                               route.GetDestNetworkMask(),
+                               route.GetGateway(),
+                               route.GetInterface());
+        }
+        return;
+    }
+
+    // the first old route is told apart from the routes equal to it by its rank
+    Ipv4RoutingTableEntry* first = nullptr;
+    index.ForEachMatch(RouteIndex::GetKey(oldRoutes[0].GetDestNetwork()),
+                       [&first, rank](uint8_t, const auto& indexed) {
+                           for (const auto& [route, r] : indexed)
+                           {
+                               if (r == rank)
+                               {
+                                   first = route;
+                                   return true;
+                               }
+                           }
+                           return false;
+                       });
+    NS_ABORT_MSG_IF(!first, "No route of rank " << rank);
+    NS_ABORT_MSG_IF(rank % RANK_SPACING + newRoutes.size() > RANK_SPACING,
+                    "Too many routes replaced at once");
+
+    auto position = std::find(routes.begin(), routes.end(), first);
+    for (const auto& oldRoute : oldRoutes)
+    {
+        NS_ABORT_MSG_IF(position == routes.end() ||
+                            (*position)->GetDest() != oldRoute.GetDest() ||
+                            (*position)->GetDestNetworkMask() != oldRoute.GetDestNetworkMask() ||
+                            (*position)->GetGateway() != oldRoute.GetGateway() ||
+                            (*position)->GetInterface() != oldRoute.GetInterface(),
+                        "Route " << oldRoute << " not found at its place");
+        UnindexRoute(index, *position);
+        delete *position;
+        position = routes.erase(position);
+    }
+
+    // the ranks of the appended routes are spaced by RANK_SPACING, so the
+    // ranks of the new routes do not reach the rank of the next route
+    for (const auto& newRoute : newRoutes)
+    {
+        auto route = new Ipv4RoutingTableEntry(newRoute);
+        routes.insert(position, route);
+        IndexRoute(index, route, rank++);
+    }
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams(int64_t stream)
 {
@@ -336,6 +663,30 @@ Ipv4GlobalRouting::AssignStreams(int64_t stream)
     return 1;
 }
 
+void
+Ipv4GlobalRouting::SetCompactRoutes(bool compactRoutes)
+{
+    NS_LOG_FUNCTION(this << compactRoutes);
+    NS_ABORT_MSG_IF(compactRoutes != m_compactRoutes && GetNRoutes() > 0,
+                    "The storage of the routes cannot be changed once routes are added");
+    m_compactRoutes = compactRoutes;
+    if (m_compactRoutes && !m_compactHostRoutes)
+    {
+        // the shared destinations are created here, before the routes may
+        // be added concurrently by GlobalRouteManager
+        auto destinations = SimulationSingleton<CompactRouteDestinations>::Get();
+        m_compactHostRoutes = std::make_unique<CompactRouteTable>(destinations);
+        m_compactNetworkRoutes = std::make_unique<CompactRouteTable>(destinations);
+        m_compactASexternalRoutes = std::make_unique<CompactRouteTable>(destinations);
+    }
+}
+
+bool
+Ipv4GlobalRouting::GetCompactRoutes() const
+{
+    return m_compactRoutes;
+}
+
 void
 Ipv4GlobalRouting::DoDispose()
 {
@@ -353,6 +704,13 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_hostRouteIndex.Clear();
+    m_networkRouteIndex.Clear();
+    m_ASexternalRouteIndex.Clear();
+    m_compactHostRoutes.reset();
+    m_compactNetworkRoutes.reset();
+    m_compactASexternalRoutes.reset();
+    m_compactRoutes = false;
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -383,7 +741,7 @@ Ipv4GlobalRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit
             std::ostringstream gw;
             std::ostringstream mask;
             std::ostringstream flags;
-            Ipv4RoutingTableEntry route = GetRoute(j);
+            Ipv4RoutingTableEntry route = GetRouteEntry(j);
             dest << route.GetDest();
             *os << std::setw(16) << dest.str();
             gw << route.GetGateway();
@@ -521,9 +879,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp(uint32_t i)
     NS_LOG_FUNCTION(this << i);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::UpdateRoutes();
     }
 }
 
@@ -533,9 +889,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown(uint32_t i)
     NS_LOG_FUNCTION(this << i);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::UpdateRoutes();
     }
 }
 
@@ -545,9 +899,7 @@ Ipv4GlobalRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress add
     NS_LOG_FUNCTION(this << interface << address);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::UpdateRoutes();
     }
 }
 
@@ -557,9 +909,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
     NS_LOG_FUNCTION(this << interface << address);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::UpdateRoutes();
     }
 }
 
@@ -7,16 +7,20 @@
 #ifndef IPV4_GLOBAL_ROUTING_H
 #define IPV4_GLOBAL_ROUTING_H
 
+#include "compact-route-table.h"
 #include "ipv4-header.h"
 #include "ipv4-routing-protocol.h"
 #include "ipv4.h"
+#include "prefix-trie.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
 
 #include <list>
+#include <memory>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -54,6 +58,17 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * With the CompactRoutes attribute, the routes are stored in
+ * CompactRouteTable instead of one Ipv4RoutingTableEntry per route: the
+ * destinations are numbered once for all the nodes, and each node stores
+ * a small index per destination into its deduplicated groups of next
+ * hops.  This is meant for the topologies of thousands of nodes, whose
+ * global routes grow quadratically.  GetRoute() then returns a pointer
+ * valid until its next call (GetRouteEntry() returns a copy), and the
+ * matching network routes are
+ * considered from the longest prefix instead of in their order of
+ * insertion.
+ *
  * @see Ipv4RoutingProtocol
  * @see GlobalRouteManager
  */
@@ -182,6 +197,12 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      * Similarly, if the default route has been set, calling RemoveRoute (0) will
      * remove the default route.
      *
+     * With the CompactRoutes attribute, the table has no Ipv4RoutingTableEntry:
+     * the entry is rebuilt in a buffer of this object at each call, so the
+     * returned pointer is only valid until the next call of GetRoute, and
+     * modifying the entry does not modify the table.  Use GetRouteEntry to
+     * keep several routes at once.
+     *
      * @param i The index (into the routing table) of the route to retrieve.  If
      * the default route has been set, it will occupy index zero.
      * @return If route is set, a pointer to that Ipv4RoutingTableEntry is returned, otherwise
@@ -192,6 +213,17 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     Ipv4RoutingTableEntry* GetRoute(uint32_t i) const;
 
+    /**
+     * @brief Get a copy of a route from the global unicast routing table.
+     *
+     * Same as GetRoute, but the route is returned by value, so that it
+     * remains valid whether the CompactRoutes attribute is set or not.
+     *
+     * @param i The index (into the routing table) of the route to retrieve.
+     * @return The route.
+     */
+    Ipv4RoutingTableEntry GetRouteEntry(uint32_t i) const;
+
     /**
      * @brief Remove a route from the global unicast routing table.
      *
@@ -210,6 +242,76 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     void RemoveRoute(uint32_t i);
 
+    /**
+     * @brief Remove a host route from the global routing table.
+     *
+     * @param dest The Ipv4Address destination of the route.
+     * @param nextHop The Ipv4Address of the next hop in the route.
+     * @param interface The network interface index of the route.
+     * @returns true if a route was found and removed
+     *
+     * @see Ipv4GlobalRouting::AddHostRouteTo
+     */
+    bool RemoveHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface);
+
+    /**
+     * @brief Remove a network route from the global routing table.
+     *
+     * @param network The Ipv4Address network of the route.
+     * @param networkMask The Ipv4Mask of the network.
+     * @param nextHop The next hop in the route to the destination network.
+     * @param interface The network interface index of the route.
+     * @returns true if a route was found and removed
+     *
+     * @see Ipv4GlobalRouting::AddNetworkRouteTo
+     */
+    bool RemoveNetworkRouteTo(Ipv4Address network,
+                              Ipv4Mask networkMask,
+                              Ipv4Address nextHop,
+                              uint32_t interface);
+
+    /**
+     * @brief Get the rank of the next route appended to the table.
+     *
+     * The rank identifies the routes appended from then on, until other
+     * routes are appended, for ReplaceHostRoutes () and ReplaceNetworkRoutes ().
+     *
+     * @returns the rank of the next route appended
+     */
+    uint64_t GetNextRouteRank() const;
+
+    /**
+     * @brief Replace host routes of the global routing table in place.
+     *
+     * The old routes, which must follow each other in the table from the
+     * route of the given rank, are removed, and the new routes are
+     * inserted, in their order, at their position, so that the first of
+     * them gets the same rank: the order of the table decides which route
+     * is used when RandomEcmpRouting is false.  The compact routing tables
+     * keep the routes in the order of their destinations, the new routes
+     * being appended to the routes of their destination.
+     *
+     * @param rank The rank of the first old route, as returned by
+     * GetNextRouteRank () before it was appended.
+     * @param oldRoutes The host routes to remove, not empty.
+     * @param newRoutes The host routes to add.
+     */
+    void ReplaceHostRoutes(uint64_t rank,
+                           const std::vector<Ipv4RoutingTableEntry>& oldRoutes,
+                           const std::vector<Ipv4RoutingTableEntry>& newRoutes);
+
+    /**
+     * @brief Replace network routes of the global routing table in place.
+     *
+     * @param rank The rank of the first old route.
+     * @param oldRoutes The network routes to remove, not empty.
+     * @param newRoutes The network routes to add.
+     * @see ReplaceHostRoutes
+     */
+    void ReplaceNetworkRoutes(uint64_t rank,
+                              const std::vector<Ipv4RoutingTableEntry>& oldRoutes,
+                              const std::vector<Ipv4RoutingTableEntry>& newRoutes);
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -220,6 +322,22 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     int64_t AssignStreams(int64_t stream);
 
+    /**
+     * @brief Set whether the routes are stored in compact routing tables.
+     *
+     * This can only be changed while the routing table is empty.
+     *
+     * @param compactRoutes true to store the routes in compact routing tables
+     * @see CompactRouteTable
+     */
+    void SetCompactRoutes(bool compactRoutes);
+
+    /**
+     * @brief Get whether the routes are stored in compact routing tables.
+     * @returns true if the routes are stored in compact routing tables
+     */
+    bool GetCompactRoutes() const;
+
   protected:
     void DoDispose() override;
 
@@ -232,6 +350,8 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     bool m_respondToInterfaceEvents;
     /// A uniform random number generator for randomly routing packets among ECMP
     Ptr<UniformRandomVariable> m_rand;
+    /// Set to true if the routes are stored in the compact routing tables
+    bool m_compactRoutes;
 
     /// container of Ipv4RoutingTableEntry (routes to hosts)
     typedef std::list<Ipv4RoutingTableEntry*> HostRoutes;
@@ -254,6 +374,63 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
     typedef std::list<Ipv4RoutingTableEntry*>::iterator ASExternalRoutesI;
 
+    /// index of the routes of a container by destination prefix, with their rank in the container
+    typedef PrefixTrie<std::pair<Ipv4RoutingTableEntry*, uint64_t>, 4> RouteIndex;
+
+    /// spacing of the ranks of the appended routes, leaving room for the
+    /// routes replacing them in place
+    static constexpr uint64_t RANK_SPACING = 1 << 16;
+
+    /**
+     * @brief Index a route appended to a container.
+     * @param index the index of the container
+     * @param route the route
+     */
+    void IndexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route);
+
+    /**
+     * @brief Index a route with a given rank.
+     * @param index the index of the container
+     * @param route the route
+     * @param rank the rank of the route in the container
+     */
+    void IndexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route, uint64_t rank);
+
+    /**
+     * @brief Remove a route from the index of its container.
+     * @param index the index of the container
+     * @param route the route
+     * @returns the rank of the route in the container
+     */
+    uint64_t UnindexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route);
+
+    /**
+     * @brief Replace routes of a container in place.
+     * @param routes the container
+     * @param index the index of the container
+     * @param compactRoutes the compact routing table used instead of the container
+     * @param rank the rank of the first route to remove
+     * @param oldRoutes the routes to remove
+     * @param newRoutes the routes to add
+     * @see ReplaceHostRoutes
+     */
+    void ReplaceRoutes(std::list<Ipv4RoutingTableEntry*>& routes,
+                       RouteIndex& index,
+                       CompactRouteTable* compactRoutes,
+                       uint64_t rank,
+                       const std::vector<Ipv4RoutingTableEntry>& oldRoutes,
+                       const std::vector<Ipv4RoutingTableEntry>& newRoutes);
+
+    /**
+     * @brief Get the routes of an index matching a destination.
+     * @param index the index of a container
+     * @param dest destination address
+     * @param [out] routes the matching routes, in the order of the container
+     */
+    void GetMatchingRoutes(const RouteIndex& index,
+                           Ipv4Address dest,
+                           std::vector<Ipv4RoutingTableEntry*>& routes) const;
+
     /**
      * @brief Lookup in the forwarding table for destination.
      * @param dest destination address
@@ -266,6 +443,17 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    RouteIndex m_hostRouteIndex;       //!< Index of the routes to hosts
+    RouteIndex m_networkRouteIndex;    //!< Index of the routes to networks
+    RouteIndex m_ASexternalRouteIndex; //!< Index of the external routes
+    uint64_t m_routeRank;              //!< Rank of insertion of the next route
+
+    std::unique_ptr<CompactRouteTable> m_compactHostRoutes;       //!< Compact routes to hosts
+    std::unique_ptr<CompactRouteTable> m_compactNetworkRoutes;    //!< Compact routes to networks
+    std::unique_ptr<CompactRouteTable> m_compactASexternalRoutes; //!< Compact external routes
+    /// The compact route returned by GetRoute, overwritten by each call
+    mutable Ipv4RoutingTableEntry m_compactRoute;
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
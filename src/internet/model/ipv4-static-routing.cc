@@ -47,7 +47,8 @@ Ipv4StaticRouting::GetTypeId()
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting()
-    : m_ipv4(nullptr)
+    : m_unindexedRoutes(0),
+      m_ipv4(nullptr)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -67,8 +68,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
 
     if (!LookupRoute(route, metric))
     {
-        auto routePtr = new Ipv4RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertNetworkRoute(new Ipv4RoutingTableEntry(route), metric);
     }
 }
 
@@ -84,9 +84,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
         Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     if (!LookupRoute(route, metric))
     {
-        auto routePtr = new Ipv4RoutingTableEntry(route);
-
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertNetworkRoute(new Ipv4RoutingTableEntry(route), metric);
     }
 }
 
@@ -141,7 +139,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Address network("224.0.0.0");
     Ipv4Mask networkMask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    InsertNetworkRoute(route, 0);
 }
 
 uint32_t
@@ -228,6 +226,38 @@ Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metr
     return false;
 }
 
+void
+Ipv4StaticRouting::InsertNetworkRoute(Ipv4RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    Ipv4Mask mask = route->GetDestNetworkMask();
+    int length = NetworkRouteIndex::GetContiguousLength(NetworkRouteIndex::GetKey(mask));
+    if (length == mask.GetPrefixLength())
+    {
+        m_networkRouteIndex.Insert(NetworkRouteIndex::GetKey(route->GetDestNetwork()),
+                                   length,
+                                   m_networkRoutes.back());
+    }
+    else
+    {
+        m_unindexedRoutes++;
+    }
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute(NetworkRoutesI it)
+{
+    Ipv4Mask mask = it->first->GetDestNetworkMask();
+    if (!m_networkRouteIndex.Remove(NetworkRouteIndex::GetKey(it->first->GetDestNetwork()),
+                                    mask.GetPrefixLength(),
+                                    *it))
+    {
+        m_unindexedRoutes--;
+    }
+    delete it->first;
+    return m_networkRoutes.erase(it);
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -250,56 +280,85 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
         return rtentry;
     }
 
-    for (auto i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
-    {
-        Ipv4RoutingTableEntry* j = i->first;
-        uint32_t metric = i->second;
-        Ipv4Mask mask = (j)->GetDestNetworkMask();
+    // Consider a route, in the order of the forwarding table: the longest
+    // mask wins, then the lowest metric.  Returns true for a host route,
+    // which ends the search.
+    Ipv4RoutingTableEntry* route = nullptr;
+    auto consider = [&](Ipv4RoutingTableEntry* j, uint32_t metric) {
+        Ipv4Mask mask = j->GetDestNetworkMask();
         uint16_t masklen = mask.GetPrefixLength();
-        Ipv4Address entry = (j)->GetDestNetwork();
+        Ipv4Address entry = j->GetDestNetwork();
         NS_LOG_LOGIC("Searching for route to " << dest << ", checking against route to " << entry
                                                << "/" << masklen);
-        if (mask.IsMatch(dest, entry))
+        if (!mask.IsMatch(dest, entry))
         {
-            NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
-                                                       << ", metric " << metric);
-            if (oif)
-            {
-                if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-                NS_LOG_LOGIC("Previous match longer, skipping");
-                continue;
-            }
-            if (masklen > longest_mask) // Reset metric if longer masklen
+            return false;
+        }
+        NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
+                                                   << ", metric " << metric);
+        if (oif)
+        {
+            if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
             {
-                shortest_metric = 0xffffffff;
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                return false;
             }
-            longest_mask = masklen;
-            if (metric > shortest_metric)
+        }
+        if (masklen < longest_mask) // Not interested if got shorter mask
+        {
+            NS_LOG_LOGIC("Previous match longer, skipping");
+            return false;
+        }
+        if (masklen > longest_mask) // Reset metric if longer masklen
+        {
+            shortest_metric = 0xffffffff;
+        }
+        longest_mask = masklen;
+        if (metric > shortest_metric)
+        {
+            NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
+            return false;
+        }
+        shortest_metric = metric;
+        route = j;
+        return masklen == 32;
+    };
+
+    if (m_unindexedRoutes == 0)
+    {
+        // The routes of the longest matching prefix, in the order of the
+        // table, unless none is on the requested interface
+        auto visit = [&](uint8_t, const auto& routes) {
+            for (const auto& [j, metric] : routes)
             {
-                NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
-                continue;
+                if (consider(j, metric))
+                {
+                    break;
+                }
             }
-            shortest_metric = metric;
-            Ipv4RoutingTableEntry* route = (j);
-            uint32_t interfaceIdx = route->GetInterface();
-            rtentry = Create<Ipv4Route>();
-            rtentry->SetDestination(route->GetDest());
-            rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
-            rtentry->SetGateway(route->GetGateway());
-            rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-            if (masklen == 32)
+            return route != nullptr;
+        };
+        m_networkRouteIndex.ForEachMatch(NetworkRouteIndex::GetKey(dest), visit);
+    }
+    else
+    {
+        for (auto i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
+        {
+            if (consider(i->first, i->second))
             {
                 break;
             }
         }
     }
+    if (route)
+    {
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(route->GetDest());
+        rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
+        rtentry->SetGateway(route->GetGateway());
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+    }
     if (rtentry)
     {
         NS_LOG_LOGIC("Matching route via " << rtentry->GetGateway() << " at the end");
@@ -446,8 +505,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
-            delete j->first;
-            m_networkRoutes.erase(j);
+            EraseNetworkRoute(j);
             return;
         }
         tmp++;
@@ -581,6 +639,8 @@ Ipv4StaticRouting::DoDispose()
     {
         delete (j->first);
     }
+    m_networkRouteIndex.Clear();
+    m_unindexedRoutes = 0;
     for (auto i = m_multicastRoutes.begin(); i != m_multicastRoutes.end();
          i = m_multicastRoutes.erase(i))
     {
@@ -620,8 +680,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
@@ -665,8 +724,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkMask() == networkMask)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
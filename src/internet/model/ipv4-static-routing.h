@@ -13,6 +13,7 @@
 #include "ipv4-header.h"
 #include "ipv4-routing-protocol.h"
 #include "ipv4.h"
+#include "prefix-trie.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ptr.h"
@@ -370,6 +371,23 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
     /// Iterator for container for the multicast routes
     typedef std::list<Ipv4MulticastRoutingTableEntry*>::iterator MulticastRoutesI;
 
+    /// Index of the network routes by destination prefix
+    typedef PrefixTrie<std::pair<Ipv4RoutingTableEntry*, uint32_t>, 4> NetworkRouteIndex;
+
+    /**
+     * @brief Append a route to the forwarding table for network, and index it.
+     * @param route route, owned by the table
+     * @param metric metric of route
+     */
+    void InsertNetworkRoute(Ipv4RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * @brief Remove a route from the forwarding table for network and its index, and delete it.
+     * @param it iterator to the route
+     * @return iterator to the next route
+     */
+    NetworkRoutesI EraseNetworkRoute(NetworkRoutesI it);
+
     /**
      * @brief Checks if a route is already present in the forwarding table.
      * @param route route
@@ -400,6 +418,18 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * @brief the longest prefix match index of the forwarding table for
+     * network, holding the routes whose mask is contiguous.
+     */
+    NetworkRouteIndex m_networkRouteIndex;
+
+    /**
+     * @brief the number of routes whose mask is not contiguous, which
+     * are looked up by a linear search of the forwarding table.
+     */
+    uint32_t m_unindexedRoutes;
+
     /**
      * @brief the forwarding table for multicast.
      */
@@ -12,6 +12,8 @@
 
 #include "ns3/log.h"
 
+#include <bit>
+
 namespace ns3
 {
 
@@ -20,9 +22,11 @@ NS_LOG_COMPONENT_DEFINE("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux()
     : m_ephemeral(49152),
       m_portFirst(49152),
-      m_portLast(65535)
+      m_portLast(65535),
+      m_sequence(0)
 {
     NS_LOG_FUNCTION(this);
+    m_portsInUse.resize(65536 / 64, 0);
 }
 
 Ipv6EndPointDemux::~Ipv6EndPointDemux()
@@ -31,6 +35,7 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv6EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
@@ -40,24 +45,21 @@ bool
 Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
 {
     NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        if ((*i)->GetLocalPort() == port)
-        {
-            return true;
-        }
-    }
-    return false;
+    return (m_portsInUse[port / 64] >> (port % 64)) & 1;
 }
 
 bool
 Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto it = m_ports.find(port);
+    if (it == m_ports.end())
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        return false;
+    }
+    for (Ipv6EndPoint* endP : it->second)
+    {
+        if (endP->GetLocalAddress() == addr && endP->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -76,9 +78,7 @@ Ipv6EndPointDemux::Allocate()
         return nullptr;
     }
     auto endPoint = new Ipv6EndPoint(Ipv6Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(endPoint);
 }
 
 Ipv6EndPoint*
@@ -92,9 +92,7 @@ Ipv6EndPointDemux::Allocate(Ipv6Address address)
         return nullptr;
     }
     auto endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(endPoint);
 }
 
 Ipv6EndPoint*
@@ -115,9 +113,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv6Address address,
         return nullptr;
     }
     auto endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(endPoint);
 }
 
 Ipv6EndPoint*
@@ -128,38 +124,46 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // Only the endpoints indexed under the same peer can be duplicates
+    if (const EndPoints* indexed = GetIndexed(localPort, peerAddress, peerPort))
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (Ipv6EndPoint* endP : *indexed)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if (endP->GetLocalPort() == localPort && endP->GetLocalAddress() == localAddress &&
+                endP->GetPeerPort() == peerPort && endP->GetPeerAddress() == peerAddress &&
+                (endP->GetBoundNetDevice() == boundNetDevice || !endP->GetBoundNetDevice()))
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     auto endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
-
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-
-    return endPoint;
+    return Insert(endPoint);
 }
 
 void
 Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto it = m_positions.find(endPoint);
+    if (it == m_positions.end())
     {
-        if (*i == endPoint)
-        {
-            delete endPoint;
-            m_endPoints.erase(i);
-            break;
-        }
+        return;
+    }
+    m_endPoints.erase(it->second);
+    m_positions.erase(it);
+    Unindex(endPoint);
+    auto port = m_ports.find(endPoint->GetLocalPort());
+    port->second.erase(endPoint);
+    if (port->second.empty())
+    {
+        m_portsInUse[port->first / 64] &= ~(uint64_t(1) << (port->first % 64));
+        m_ports.erase(port);
     }
+    endPoint->m_demux = nullptr;
+    delete endPoint;
 }
 
 /*
@@ -182,9 +186,36 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     EndPoints retval4; /* Exact match on all 4 */
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // Only the endpoints connected to the source of the packet, and those which
+    // may match any peer, can match the packet
+    const EndPoints* connected = GetIndexed(dport, saddr, sport);
+    const EndPoints* unconnected = GetIndexed(dport, Ipv6Address::GetAny(), 0);
+    const EndPoints none;
+    if (!connected || connected == unconnected)
+    {
+        connected = &none;
+    }
+    if (!unconnected)
     {
-        Ipv6EndPoint* endP = *i;
+        unconnected = &none;
+    }
+    // Visit the endpoints of both buckets in their order of insertion, as if
+    // scanning the list of all the endpoints
+    auto connectedIt = connected->begin();
+    auto unconnectedIt = unconnected->begin();
+    while (connectedIt != connected->end() || unconnectedIt != unconnected->end())
+    {
+        Ipv6EndPoint* endP;
+        if (unconnectedIt == unconnected->end() ||
+            (connectedIt != connected->end() &&
+             (*connectedIt)->m_sequence < (*unconnectedIt)->m_sequence))
+        {
+            endP = *connectedIt++;
+        }
+        else
+        {
+            endP = *unconnectedIt++;
+        }
 
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
@@ -337,24 +368,132 @@ Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src
     return generic;
 }
 
-uint16_t
-Ipv6EndPointDemux::AllocateEphemeralPort()
+std::size_t
+Ipv6EndPointDemux::ConnectionKeyHash::operator()(const ConnectionKey& key) const
 {
-    NS_LOG_FUNCTION(this);
-    uint16_t port = m_ephemeral;
-    int count = m_portLast - m_portFirst;
-    do
+    std::size_t hash = Ipv6AddressHash()(key.peerAddress);
+    uint32_t ports = (uint32_t(key.localPort) << 16) | key.peerPort;
+    return hash ^ (ports + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+Ipv6EndPoint*
+Ipv6EndPointDemux::Insert(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    m_positions[endPoint] = m_endPoints.insert(m_endPoints.end(), endPoint);
+    uint16_t port = endPoint->GetLocalPort();
+    m_ports[port].insert(endPoint);
+    m_portsInUse[port / 64] |= uint64_t(1) << (port % 64);
+    endPoint->m_demux = this;
+    endPoint->m_sequence = m_sequence++;
+    Index(endPoint);
+    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    return endPoint;
+}
+
+void
+Ipv6EndPointDemux::Index(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    EndPoints* endPoints;
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv6Address::GetAny())
+    {
+        ConnectionKey key{endPoint->GetLocalPort(),
+                          endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort()};
+        endPoints = &m_connected[key];
+    }
+    else
+    {
+        endPoints = &m_unconnected[endPoint->GetLocalPort()];
+    }
+    // Keep the endpoints in their order of insertion in the demux, also when
+    // their peer is set later, so that the lookups visit them in that order
+    auto it = endPoints->rbegin();
+    while (it != endPoints->rend() && (*it)->m_sequence > endPoint->m_sequence)
     {
-        if (count-- < 0)
+        it++;
+    }
+    endPoints->insert(it.base(), endPoint);
+}
+
+void
+Ipv6EndPointDemux::Unindex(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv6Address::GetAny())
+    {
+        ConnectionKey key{endPoint->GetLocalPort(),
+                          endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort()};
+        auto it = m_connected.find(key);
+        it->second.remove(endPoint);
+        if (it->second.empty())
         {
-            return 0;
+            m_connected.erase(it);
         }
-        ++port;
-        if (port < m_portFirst || port > m_portLast)
+    }
+    else
+    {
+        auto it = m_unconnected.find(endPoint->GetLocalPort());
+        it->second.remove(endPoint);
+        if (it->second.empty())
+        {
+            m_unconnected.erase(it);
+        }
+    }
+}
+
+const Ipv6EndPointDemux::EndPoints*
+Ipv6EndPointDemux::GetIndexed(uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort) const
+{
+    if (peerPort != 0 && peerAddress != Ipv6Address::GetAny())
+    {
+        auto it = m_connected.find({localPort, peerAddress, peerPort});
+        return it != m_connected.end() ? &it->second : nullptr;
+    }
+    auto it = m_unconnected.find(localPort);
+    return it != m_unconnected.end() ? &it->second : nullptr;
+}
+
+uint16_t
+Ipv6EndPointDemux::FindFreePort(uint16_t first, uint16_t last) const
+{
+    uint32_t port = first;
+    while (port <= last)
+    {
+        // The free ports of the word of the bitmap, from the current one
+        uint64_t free = ~m_portsInUse[port / 64] >> (port % 64);
+        if (free != 0)
         {
-            port = m_portFirst;
+            port += std::countr_zero(free);
+            return port <= last ? port : 0;
         }
-    } while (LookupPortLocal(port));
+        port += 64 - port % 64;
+    }
+    return 0;
+}
+
+uint16_t
+Ipv6EndPointDemux::AllocateEphemeralPort()
+{
+    // Similar to counting up logic in netinet/in_pcb.c, the ports in use being
+    // found in the bitmap
+    NS_LOG_FUNCTION(this);
+    uint16_t start = m_ephemeral + 1;
+    if (start < m_portFirst || start > m_portLast)
+    {
+        start = m_portFirst;
+    }
+    uint16_t port = FindFreePort(start, m_portLast);
+    if (port == 0 && start > m_portFirst)
+    {
+        port = FindFreePort(m_portFirst, start - 1);
+    }
+    if (port == 0)
+    {
+        return 0;
+    }
     m_ephemeral = port;
     return port;
 }
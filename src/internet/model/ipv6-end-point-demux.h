@@ -15,6 +15,9 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ns3
 {
@@ -25,6 +28,10 @@ class Ipv6EndPoint;
  * @ingroup ipv6
  *
  * @brief Demultiplexer for end points.
+ *
+ * As for ns3::Ipv4EndPointDemux, the endpoints are indexed in hash tables,
+ * by local port and peer for the connected endpoints, and by local port for
+ * the others, and the local ports in use are tracked in a bitmap.
  */
 class Ipv6EndPointDemux
 {
@@ -150,6 +157,79 @@ class Ipv6EndPointDemux
     EndPoints GetEndPoints() const;
 
   private:
+    friend class Ipv6EndPoint;
+
+    /**
+     * @brief Key of the connected endpoints, i.e., whose peer address and
+     * port are both set.
+     */
+    struct ConnectionKey
+    {
+        uint16_t localPort;      //!< The local port.
+        Ipv6Address peerAddress; //!< The peer address.
+        uint16_t peerPort;       //!< The peer port.
+
+        /**
+         * @param other Another key.
+         * @returns true if the keys are equal.
+         */
+        bool operator==(const ConnectionKey& other) const = default;
+    };
+
+    /**
+     * @brief Hash function of the keys of the connected endpoints.
+     */
+    struct ConnectionKeyHash
+    {
+        /**
+         * @param key The key.
+         * @returns The hash of the key.
+         */
+        std::size_t operator()(const ConnectionKey& key) const;
+    };
+
+    /**
+     * @brief Add a new endpoint to the demux.
+     * @param endPoint the end point
+     * @return the end point
+     */
+    Ipv6EndPoint* Insert(Ipv6EndPoint* endPoint);
+
+    /**
+     * @brief Add an endpoint to the index of its peer, called when the endpoint
+     * is inserted, and when its peer is set.  The endpoint is placed after the
+     * endpoints inserted before it.
+     * @param endPoint the end point
+     */
+    void Index(Ipv6EndPoint* endPoint);
+
+    /**
+     * @brief Remove an endpoint from the index of its peer, called when the
+     * endpoint is removed, and before its peer is set.
+     * @param endPoint the end point
+     */
+    void Unindex(Ipv6EndPoint* endPoint);
+
+    /**
+     * @brief Get the endpoints indexed under the same peer as the given
+     * local port, peer address and peer port.
+     * @param localPort local port
+     * @param peerAddress peer address
+     * @param peerPort peer port
+     * @return the endpoints, or nullptr if none
+     */
+    const EndPoints* GetIndexed(uint16_t localPort,
+                                Ipv6Address peerAddress,
+                                uint16_t peerPort) const;
+
+    /**
+     * @brief Find the first local port not in use in a range.
+     * @param first the first port of the range
+     * @param last the last port of the range
+     * @returns the port, or 0 if all the ports of the range are in use
+     */
+    uint16_t FindFreePort(uint16_t first, uint16_t last) const;
+
     /**
      * @brief Allocate a ephemeral port.
      * @return a port
@@ -175,6 +255,36 @@ class Ipv6EndPointDemux
      * @brief A list of IPv6 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * @brief The connected endpoints, by local port and peer.
+     */
+    std::unordered_map<ConnectionKey, EndPoints, ConnectionKeyHash> m_connected;
+
+    /**
+     * @brief The other endpoints, which may match any peer, by local port.
+     */
+    std::unordered_map<uint16_t, EndPoints> m_unconnected;
+
+    /**
+     * @brief All the endpoints, by local port.
+     */
+    std::unordered_map<uint16_t, std::unordered_set<Ipv6EndPoint*>> m_ports;
+
+    /**
+     * @brief The position of the endpoints in the list of the endpoints.
+     */
+    std::unordered_map<Ipv6EndPoint*, EndPointsI> m_positions;
+
+    /**
+     * @brief The bitmap of the local ports in use.
+     */
+    std::vector<uint64_t> m_portsInUse;
+
+    /**
+     * @brief The order of insertion of the next endpoint.
+     */
+    uint64_t m_sequence;
 };
 
 } /* namespace ns3 */
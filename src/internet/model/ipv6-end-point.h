@@ -23,6 +23,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * @ingroup ipv6
@@ -184,6 +185,8 @@ class Ipv6EndPoint
     bool IsRxEnabled() const;
 
   private:
+    friend class Ipv6EndPointDemux;
+
     /**
      * @brief The local address.
      */
@@ -228,6 +231,16 @@ class Ipv6EndPoint
      * @brief true if the endpoint can receive packets.
      */
     bool m_rxEnabled;
+
+    /**
+     * @brief The demux indexing the endpoint by its peer (if any).
+     */
+    Ipv6EndPointDemux* m_demux;
+
+    /**
+     * @brief The order of insertion of the endpoint in its demux.
+     */
+    uint64_t m_sequence;
 };
 
 } /* namespace ns3 */
@@ -38,7 +38,8 @@ Ipv6StaticRouting::GetTypeId()
 }
 
 Ipv6StaticRouting::Ipv6StaticRouting()
-    : m_ipv6(nullptr)
+    : m_unindexedRoutes(0),
+      m_ipv6(nullptr)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -170,8 +171,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
 
     if (!LookupRoute(route, metric))
     {
-        auto routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertNetworkRoute(new Ipv6RoutingTableEntry(route), metric);
     }
 }
 
@@ -197,8 +197,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
                                                                               prefixToUse);
     if (!LookupRoute(route, metric))
     {
-        auto routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertNetworkRoute(new Ipv6RoutingTableEntry(route), metric);
     }
 }
 
@@ -214,8 +213,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
         Ipv6RoutingTableEntry::CreateNetworkRouteTo(network, networkPrefix, interface);
     if (!LookupRoute(route, metric))
     {
-        auto routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertNetworkRoute(new Ipv6RoutingTableEntry(route), metric);
     }
 }
 
@@ -257,7 +255,7 @@ Ipv6StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv6Address network = Ipv6Address("ff00::"); /* RFC 3513 */
     Ipv6Prefix networkMask = Ipv6Prefix(8);
     *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    InsertNetworkRoute(route, 0);
 }
 
 uint32_t
@@ -368,6 +366,38 @@ Ipv6StaticRouting::LookupRoute(const Ipv6RoutingTableEntry& route, uint32_t metr
     return false;
 }
 
+void
+Ipv6StaticRouting::InsertNetworkRoute(Ipv6RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    Ipv6Prefix prefix = route->GetDestNetworkPrefix();
+    int length = NetworkRouteIndex::GetContiguousLength(NetworkRouteIndex::GetKey(prefix));
+    if (length == prefix.GetPrefixLength())
+    {
+        m_networkRouteIndex.Insert(NetworkRouteIndex::GetKey(route->GetDestNetwork()),
+                                   length,
+                                   m_networkRoutes.back());
+    }
+    else
+    {
+        m_unindexedRoutes++;
+    }
+}
+
+Ipv6StaticRouting::NetworkRoutesI
+Ipv6StaticRouting::EraseNetworkRoute(NetworkRoutesI it)
+{
+    Ipv6Prefix prefix = it->first->GetDestNetworkPrefix();
+    if (!m_networkRouteIndex.Remove(NetworkRouteIndex::GetKey(it->first->GetDestNetwork()),
+                                    prefix.GetPrefixLength(),
+                                    *it))
+    {
+        m_unindexedRoutes--;
+    }
+    delete it->first;
+    return m_networkRoutes.erase(it);
+}
+
 Ptr<Ipv6Route>
 Ipv6StaticRouting::LookupStatic(Ipv6Address dst, Ptr<NetDevice> interface)
 {
@@ -391,10 +421,11 @@ Ipv6StaticRouting::LookupStatic(Ipv6Address dst, Ptr<NetDevice> interface)
         return rtentry;
     }
 
-    for (auto it = m_networkRoutes.begin(); it != m_networkRoutes.end(); it++)
-    {
-        Ipv6RoutingTableEntry* j = it->first;
-        uint32_t metric = it->second;
+    // Consider a route, in the order of the forwarding table: the longest
+    // prefix wins, then the lowest metric.  Returns true for a host route,
+    // which ends the search.
+    Ipv6RoutingTableEntry* route = nullptr;
+    auto consider = [&](Ipv6RoutingTableEntry* j, uint32_t metric) {
         Ipv6Prefix mask = j->GetDestNetworkPrefix();
         uint16_t maskLen = mask.GetPrefixLength();
         Ipv6Address entry = j->GetDestNetwork();
@@ -402,61 +433,90 @@ Ipv6StaticRouting::LookupStatic(Ipv6Address dst, Ptr<NetDevice> interface)
         NS_LOG_LOGIC("Searching for route to " << dst << ", mask length " << maskLen << ", metric "
                                                << metric);
 
-        if (mask.IsMatch(dst, entry))
+        if (!mask.IsMatch(dst, entry))
         {
-            NS_LOG_LOGIC("Found global network route " << *j << ", mask length " << maskLen
-                                                       << ", metric " << metric);
-
-            /* if interface is given, check the route will output on this interface */
-            if (!interface || interface == m_ipv6->GetNetDevice(j->GetInterface()))
-            {
-                if (maskLen < longestMask)
-                {
-                    NS_LOG_LOGIC("Previous match longer, skipping");
-                    continue;
-                }
+            return false;
+        }
+        NS_LOG_LOGIC("Found global network route " << *j << ", mask length " << maskLen
+                                                   << ", metric " << metric);
 
-                if (maskLen > longestMask)
-                {
-                    shortestMetric = 0xffffffff;
-                }
+        /* if interface is given, check the route will output on this interface */
+        if (interface && interface != m_ipv6->GetNetDevice(j->GetInterface()))
+        {
+            return false;
+        }
+        if (maskLen < longestMask)
+        {
+            NS_LOG_LOGIC("Previous match longer, skipping");
+            return false;
+        }
 
-                longestMask = maskLen;
-                if (metric > shortestMetric)
-                {
-                    NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
-                    continue;
-                }
+        if (maskLen > longestMask)
+        {
+            shortestMetric = 0xffffffff;
+        }
 
-                shortestMetric = metric;
-                Ipv6RoutingTableEntry* route = j;
-                uint32_t interfaceIdx = route->GetInterface();
-                rtentry = Create<Ipv6Route>();
+        longestMask = maskLen;
+        if (metric > shortestMetric)
+        {
+            NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
+            return false;
+        }
 
-                if (route->GetGateway().IsAny() || !route->GetDest().IsAny())
-                {
-                    rtentry->SetSource(
-                        m_ipv6->SourceAddressSelection(interfaceIdx, route->GetDest()));
-                }
-                else
-                {
-                    // Default route
-                    rtentry->SetSource(m_ipv6->SourceAddressSelection(
-                        interfaceIdx,
-                        route->GetPrefixToUse().IsAny() ? dst : route->GetPrefixToUse()));
-                }
+        shortestMetric = metric;
+        route = j;
+        return maskLen == 128;
+    };
 
-                rtentry->SetDestination(route->GetDest());
-                rtentry->SetGateway(route->GetGateway());
-                rtentry->SetOutputDevice(m_ipv6->GetNetDevice(interfaceIdx));
-                if (maskLen == 128)
+    if (m_unindexedRoutes == 0)
+    {
+        // The routes of the longest matching prefix, in the order of the
+        // table, unless none is on the requested interface
+        auto visit = [&](uint8_t, const auto& routes) {
+            for (const auto& [j, metric] : routes)
+            {
+                if (consider(j, metric))
                 {
                     break;
                 }
             }
+            return route != nullptr;
+        };
+        m_networkRouteIndex.ForEachMatch(NetworkRouteIndex::GetKey(dst), visit);
+    }
+    else
+    {
+        for (auto it = m_networkRoutes.begin(); it != m_networkRoutes.end(); it++)
+        {
+            if (consider(it->first, it->second))
+            {
+                break;
+            }
         }
     }
 
+    if (route)
+    {
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = Create<Ipv6Route>();
+
+        if (route->GetGateway().IsAny() || !route->GetDest().IsAny())
+        {
+            rtentry->SetSource(m_ipv6->SourceAddressSelection(interfaceIdx, route->GetDest()));
+        }
+        else
+        {
+            // Default route
+            rtentry->SetSource(m_ipv6->SourceAddressSelection(
+                interfaceIdx,
+                route->GetPrefixToUse().IsAny() ? dst : route->GetPrefixToUse()));
+        }
+
+        rtentry->SetDestination(route->GetDest());
+        rtentry->SetGateway(route->GetGateway());
+        rtentry->SetOutputDevice(m_ipv6->GetNetDevice(interfaceIdx));
+    }
+
     if (rtentry)
     {
         NS_LOG_LOGIC("Matching route via " << rtentry->GetDestination() << " (Through "
@@ -475,6 +535,8 @@ Ipv6StaticRouting::DoDispose()
         delete j->first;
     }
     m_networkRoutes.clear();
+    m_networkRouteIndex.Clear();
+    m_unindexedRoutes = 0;
 
     for (auto i = m_multicastRoutes.begin(); i != m_multicastRoutes.end();
          i = m_multicastRoutes.erase(i))
@@ -632,8 +694,7 @@ Ipv6StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
-            delete it->first;
-            m_networkRoutes.erase(it);
+            EraseNetworkRoute(it);
             return;
         }
         tmp++;
@@ -655,8 +716,7 @@ Ipv6StaticRouting::RemoveRoute(Ipv6Address network,
         if (network == rtentry->GetDest() && rtentry->GetInterface() == ifIndex &&
             rtentry->GetPrefixToUse() == prefixToUse)
         {
-            delete it->first;
-            m_networkRoutes.erase(it);
+            EraseNetworkRoute(it);
             return;
         }
     }
@@ -797,8 +857,7 @@ Ipv6StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
@@ -835,8 +894,7 @@ Ipv6StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv6InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkPrefix() == networkMask)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseNetworkRoute(it);
         }
         else
         {
@@ -893,8 +951,7 @@ Ipv6StaticRouting::NotifyRemoveRoute(Ipv6Address dst,
 
             if (dst == entry && prefix == mask && rtentry->GetInterface() == interface)
             {
-                delete j->first;
-                j = m_networkRoutes.erase(j);
+                j = EraseNetworkRoute(j);
             }
             else
             {
@@ -12,6 +12,7 @@
 #include "ipv6-header.h"
 #include "ipv6-routing-protocol.h"
 #include "ipv6.h"
+#include "prefix-trie.h"
 
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
@@ -295,6 +296,23 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
     /// Iterator for container for the multicast routes
     typedef std::list<Ipv6MulticastRoutingTableEntry*>::iterator MulticastRoutesI;
 
+    /// Index of the network routes by destination prefix
+    typedef PrefixTrie<std::pair<Ipv6RoutingTableEntry*, uint32_t>, 16> NetworkRouteIndex;
+
+    /**
+     * @brief Append a route to the forwarding table for network, and index it.
+     * @param route route, owned by the table
+     * @param metric metric of route
+     */
+    void InsertNetworkRoute(Ipv6RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * @brief Remove a route from the forwarding table for network and its index, and delete it.
+     * @param it iterator to the route
+     * @return iterator to the next route
+     */
+    NetworkRoutesI EraseNetworkRoute(NetworkRoutesI it);
+
     /**
      * @brief Checks if a route is already present in the forwarding table.
      * @param route route
@@ -325,6 +343,18 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * @brief the longest prefix match index of the forwarding table for
+     * network, holding the routes whose prefix is contiguous.
+     */
+    NetworkRouteIndex m_networkRouteIndex;
+
+    /**
+     * @brief the number of routes whose prefix is not contiguous, which
+     * are looked up by a linear search of the forwarding table.
+     */
+    uint32_t m_unindexedRoutes;
+
     /**
      * @brief the forwarding table for multicast.
      */
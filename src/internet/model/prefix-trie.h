@@ -0,0 +1,457 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup internet
+ * ns3::PrefixTrie declaration and implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup internet
+ *
+ * @brief A path-compressed binary trie of address prefixes, for the
+ * longest prefix match of the routing tables.
+ *
+ * Each node of the trie is a prefix, with the values (e.g., the routes)
+ * inserted for this prefix, in their order of insertion.  The nodes
+ * without values are kept only where two branches of the trie split, so
+ * that a lookup visits at most one node per distinct prefix length on
+ * the path to the address.  The trie is updated incrementally as the
+ * values are inserted and removed.
+ *
+ * The keys are the bytes of the addresses in network order, e.g., as
+ * returned by GetKey().
+ *
+ * @tparam T The type of the values.
+ * @tparam N The number of bytes of the keys: 4 for IPv4, 16 for IPv6.
+ */
+template <typename T, std::size_t N>
+class PrefixTrie
+{
+  public:
+    /** The key of a prefix or of an address. */
+    using Key = std::array<uint8_t, N>;
+
+    /** The number of bits of the keys. */
+    static constexpr uint8_t BITS = N * 8;
+
+    PrefixTrie();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    PrefixTrie(const PrefixTrie&) = delete;
+    PrefixTrie& operator=(const PrefixTrie&) = delete;
+
+    /**
+     * Insert a value, after the values already inserted for the prefix.
+     *
+     * @param prefix The prefix; the bits after its length are ignored.
+     * @param length The length of the prefix, in bits.
+     * @param value The value.
+     */
+    void Insert(const Key& prefix, uint8_t length, const T& value);
+
+    /**
+     * Remove the first value of a prefix equal to a value.
+     *
+     * @param prefix The prefix; the bits after its length are ignored.
+     * @param length The length of the prefix, in bits.
+     * @param value The value.
+     * @returns true if the value was found.
+     */
+    bool Remove(const Key& prefix, uint8_t length, const T& value);
+
+    /**
+     * Remove the first value of a prefix satisfying a predicate.
+     *
+     * @tparam P The type of the predicate.
+     * @param prefix The prefix; the bits after its length are ignored.
+     * @param length The length of the prefix, in bits.
+     * @param predicate The predicate, called as predicate(value).
+     * @returns true if a value was found.
+     */
+    template <typename P>
+    bool RemoveIf(const Key& prefix, uint8_t length, P predicate);
+
+    /**
+     * Remove all the values.
+     */
+    void Clear();
+
+    /**
+     * @returns The number of values.
+     */
+    std::size_t GetSize() const;
+
+    /**
+     * Visit the prefixes matching an address, from the longest to the
+     * shortest, until the visitor returns true.
+     *
+     * @tparam F The type of the visitor.
+     * @param address The address.
+     * @param visitor The visitor, called as visitor(length, values) for
+     * each matching prefix having values, where values is the vector of
+     * the values of the prefix, in their order of insertion.
+     */
+    template <typename F>
+    void ForEachMatch(const Key& address, F visitor) const;
+
+    /**
+     * @param address An IPv4 address.
+     * @returns The key of the address.
+     */
+    static std::array<uint8_t, 4> GetKey(Ipv4Address address);
+
+    /**
+     * @param mask An IPv4 mask.
+     * @returns The key of the mask.
+     */
+    static std::array<uint8_t, 4> GetKey(Ipv4Mask mask);
+
+    /**
+     * @param address An IPv6 address.
+     * @returns The key of the address.
+     */
+    static std::array<uint8_t, 16> GetKey(Ipv6Address address);
+
+    /**
+     * @param prefix An IPv6 prefix.
+     * @returns The key of the prefix.
+     */
+    static std::array<uint8_t, 16> GetKey(Ipv6Prefix prefix);
+
+    /**
+     * @param mask A mask.
+     * @returns The number of leading ones of the mask, or -1 if the mask
+     * has ones after its first zero.
+     */
+    static int GetContiguousLength(const Key& mask);
+
+  private:
+    /** A node of the trie. */
+    struct Node
+    {
+        Key prefix;                    //!< The prefix, whose bits after its length are zero.
+        uint8_t length;                //!< The length of the prefix, in bits.
+        std::vector<T> values;         //!< The values inserted for the prefix.
+        std::unique_ptr<Node> next[2]; //!< The children, by the bit after the prefix.
+    };
+
+    /**
+     * @param key A key.
+     * @param i The index of a bit, from the most significant one.
+     * @returns The bit.
+     */
+    static uint8_t GetBit(const Key& key, uint8_t i);
+
+    /**
+     * @param key A key.
+     * @param length A length, in bits.
+     * @returns The key with the bits after the length set to zero.
+     */
+    static Key Truncate(const Key& key, uint8_t length);
+
+    /**
+     * @param a A key.
+     * @param b Another key.
+     * @param length The maximum length, in bits.
+     * @returns The number of leading bits of the keys that are equal, at
+     * most the maximum length.
+     */
+    static uint8_t GetCommonLength(const Key& a, const Key& b, uint8_t length);
+
+    /**
+     * Remove a node without values, unless it is the root, if it has at
+     * most one child.
+     *
+     * @param slot The pointer to the node in its parent.
+     */
+    void Compact(std::unique_ptr<Node>& slot);
+
+    std::unique_ptr<Node> m_root; //!< The root of the trie, the prefix of length 0.
+    std::size_t m_size;           //!< The number of values.
+};
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+template <typename T, std::size_t N>
+PrefixTrie<T, N>::PrefixTrie()
+    : m_root(std::make_unique<Node>()),
+      m_size(0)
+{
+    m_root->prefix.fill(0);
+    m_root->length = 0;
+}
+
+template <typename T, std::size_t N>
+void
+PrefixTrie<T, N>::Insert(const Key& prefix, uint8_t length, const T& value)
+{
+    NS_ASSERT(length <= BITS);
+    Key key = Truncate(prefix, length);
+    Node* node = m_root.get();
+    while (node->length != length)
+    {
+        std::unique_ptr<Node>& slot = node->next[GetBit(key, node->length)];
+        if (!slot)
+        {
+            slot = std::make_unique<Node>();
+            slot->prefix = key;
+            slot->length = length;
+            node = slot.get();
+            break;
+        }
+        uint8_t common = GetCommonLength(key, slot->prefix, std::min(length, slot->length));
+        if (common == slot->length)
+        {
+            node = slot.get();
+            continue;
+        }
+        // The prefix branches off in the middle of the edge to the child:
+        // split the edge, with the new prefix or an intermediate node
+        auto split = std::make_unique<Node>();
+        split->prefix = Truncate(key, common);
+        split->length = common;
+        split->next[GetBit(slot->prefix, common)] = std::move(slot);
+        slot = std::move(split);
+        node = slot.get();
+    }
+    node->values.push_back(value);
+    m_size++;
+}
+
+template <typename T, std::size_t N>
+bool
+PrefixTrie<T, N>::Remove(const Key& prefix, uint8_t length, const T& value)
+{
+    return RemoveIf(prefix, length, [&value](const T& v) { return v == value; });
+}
+
+template <typename T, std::size_t N>
+template <typename P>
+bool
+PrefixTrie<T, N>::RemoveIf(const Key& prefix, uint8_t length, P predicate)
+{
+    NS_ASSERT(length <= BITS);
+    Key key = Truncate(prefix, length);
+    // The parent of the node, compacted after the node if it was kept
+    // only for the branch of the node
+    std::unique_ptr<Node>* parent = nullptr;
+    std::unique_ptr<Node>* slot = &m_root;
+    while ((*slot)->length != length)
+    {
+        std::unique_ptr<Node>* child = &(*slot)->next[GetBit(key, (*slot)->length)];
+        if (!*child || (*child)->length > length ||
+            GetCommonLength(key, (*child)->prefix, (*child)->length) != (*child)->length)
+        {
+            return false;
+        }
+        parent = slot;
+        slot = child;
+    }
+    auto& values = (*slot)->values;
+    auto it = std::find_if(values.begin(), values.end(), predicate);
+    if (it == values.end())
+    {
+        return false;
+    }
+    values.erase(it);
+    m_size--;
+    Compact(*slot);
+    if (parent)
+    {
+        Compact(*parent);
+    }
+    return true;
+}
+
+template <typename T, std::size_t N>
+void
+PrefixTrie<T, N>::Clear()
+{
+    m_root->values.clear();
+    m_root->next[0].reset();
+    m_root->next[1].reset();
+    m_size = 0;
+}
+
+template <typename T, std::size_t N>
+std::size_t
+PrefixTrie<T, N>::GetSize() const
+{
+    return m_size;
+}
+
+template <typename T, std::size_t N>
+template <typename F>
+void
+PrefixTrie<T, N>::ForEachMatch(const Key& address, F visitor) const
+{
+    // The nodes on the path to the address, from the shortest prefix
+    const Node* path[BITS + 1];
+    std::size_t n = 0;
+    const Node* node = m_root.get();
+    while (node)
+    {
+        path[n++] = node;
+        if (node->length == BITS)
+        {
+            break;
+        }
+        node = node->next[GetBit(address, node->length)].get();
+        if (node && GetCommonLength(address, node->prefix, node->length) != node->length)
+        {
+            break;
+        }
+    }
+    while (n > 0)
+    {
+        node = path[--n];
+        if (!node->values.empty() && visitor(node->length, node->values))
+        {
+            return;
+        }
+    }
+}
+
+template <typename T, std::size_t N>
+std::array<uint8_t, 4>
+PrefixTrie<T, N>::GetKey(Ipv4Address address)
+{
+    std::array<uint8_t, 4> key;
+    address.Serialize(key.data());
+    return key;
+}
+
+template <typename T, std::size_t N>
+std::array<uint8_t, 4>
+PrefixTrie<T, N>::GetKey(Ipv4Mask mask)
+{
+    return GetKey(Ipv4Address(mask.Get()));
+}
+
+template <typename T, std::size_t N>
+std::array<uint8_t, 16>
+PrefixTrie<T, N>::GetKey(Ipv6Address address)
+{
+    std::array<uint8_t, 16> key;
+    address.GetBytes(key.data());
+    return key;
+}
+
+template <typename T, std::size_t N>
+std::array<uint8_t, 16>
+PrefixTrie<T, N>::GetKey(Ipv6Prefix prefix)
+{
+    std::array<uint8_t, 16> key;
+    prefix.GetBytes(key.data());
+    return key;
+}
+
+template <typename T, std::size_t N>
+int
+PrefixTrie<T, N>::GetContiguousLength(const Key& mask)
+{
+    int length = 0;
+    std::size_t i = 0;
+    for (; i < N && mask[i] == 0xff; i++)
+    {
+        length += 8;
+    }
+    if (i == N)
+    {
+        return length;
+    }
+    int ones = std::countl_one(mask[i]);
+    if (uint8_t(mask[i] << ones) != 0)
+    {
+        return -1;
+    }
+    for (std::size_t j = i + 1; j < N; j++)
+    {
+        if (mask[j] != 0)
+        {
+            return -1;
+        }
+    }
+    return length + ones;
+}
+
+template <typename T, std::size_t N>
+uint8_t
+PrefixTrie<T, N>::GetBit(const Key& key, uint8_t i)
+{
+    return (key[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <typename T, std::size_t N>
+typename PrefixTrie<T, N>::Key
+PrefixTrie<T, N>::Truncate(const Key& key, uint8_t length)
+{
+    Key truncated{};
+    std::size_t bytes = length / 8;
+    std::copy_n(key.begin(), bytes, truncated.begin());
+    if (length % 8)
+    {
+        truncated[bytes] = key[bytes] & uint8_t(0xff << (8 - length % 8));
+    }
+    return truncated;
+}
+
+template <typename T, std::size_t N>
+uint8_t
+PrefixTrie<T, N>::GetCommonLength(const Key& a, const Key& b, uint8_t length)
+{
+    uint8_t common = 0;
+    for (std::size_t i = 0; i < N && common < length; i++)
+    {
+        uint8_t diff = a[i] ^ b[i];
+        if (diff)
+        {
+            common += std::countl_zero(diff);
+            break;
+        }
+        common += 8;
+    }
+    return std::min(common, length);
+}
+
+template <typename T, std::size_t N>
+void
+PrefixTrie<T, N>::Compact(std::unique_ptr<Node>& slot)
+{
+    if (slot == m_root || !slot->values.empty())
+    {
+        return;
+    }
+    if (!slot->next[0] || !slot->next[1])
+    {
+        // Replace the node by its child, if any
+        std::unique_ptr<Node> child = std::move(slot->next[slot->next[0] ? 0 : 1]);
+        slot = std::move(child);
+    }
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
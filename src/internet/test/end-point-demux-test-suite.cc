@@ -0,0 +1,247 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/test.h"
+
+#include <iterator>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup internet-test
+ * Ipv4EndPointDemux and Ipv6EndPointDemux test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check the lookups of the Ipv4EndPointDemux.
+ */
+class Ipv4EndPointDemuxLookupTestCase : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxLookupTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv4EndPointDemuxLookupTestCase::Ipv4EndPointDemuxLookupTestCase()
+    : TestCase("Check the lookups of the IPv4 endpoints")
+{
+}
+
+void
+Ipv4EndPointDemuxLookupTestCase::DoRun()
+{
+    Ipv4EndPointDemux demux;
+    Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface>();
+    Ipv4Address local("10.0.0.1");
+
+    Ipv4EndPoint* listener = demux.Allocate(nullptr, Ipv4Address::GetAny(), 80);
+    NS_TEST_ASSERT_MSG_NE(listener, nullptr, "Listening endpoint not allocated");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, Ipv4Address::GetAny(), 80),
+                          nullptr,
+                          "Duplicated listening endpoint allocated");
+
+    // Connections accepted by the listener
+    std::vector<Ipv4EndPoint*> connections;
+    for (uint16_t i = 0; i < 1000; i++)
+    {
+        Ipv4Address peer(Ipv4Address("10.1.0.0").Get() + i);
+        connections.push_back(demux.Allocate(nullptr, local, 80, peer, 1000 + i));
+        NS_TEST_ASSERT_MSG_NE(connections.back(), nullptr, "Connection not allocated");
+    }
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, local, 80, Ipv4Address("10.1.0.5"), 1005),
+                          nullptr,
+                          "Duplicated connection allocated");
+
+    for (uint16_t i = 0; i < 1000; i += 37)
+    {
+        Ipv4Address peer(Ipv4Address("10.1.0.0").Get() + i);
+        auto endPoints = demux.Lookup(local, 80, peer, 1000 + i, interface);
+        NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connection not found");
+        NS_TEST_EXPECT_MSG_EQ(endPoints.front(), connections[i], "Wrong connection found");
+        NS_TEST_EXPECT_MSG_EQ(demux.SimpleLookup(local, 80, peer, 1000 + i),
+                              connections[i],
+                              "Wrong connection found by SimpleLookup");
+    }
+
+    // Unknown peers and disabled connections fall back to the listener
+    auto endPoints = demux.Lookup(local, 80, Ipv4Address("10.2.0.1"), 1000, interface);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Listener not found");
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), listener, "Wrong endpoint found");
+    connections[3]->SetRxEnabled(false);
+    endPoints = demux.Lookup(local, 80, Ipv4Address("10.1.0.3"), 1003, interface);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Listener not found");
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), listener, "Wrong endpoint found");
+    NS_TEST_EXPECT_MSG_EQ(demux.Lookup(local, 81, Ipv4Address("10.2.0.1"), 1000, interface).size(),
+                          0,
+                          "Endpoint found on a port not in use");
+
+    // A connection removed, or whose peer changes, is no longer found
+    demux.DeAllocate(connections[10]);
+    endPoints = demux.Lookup(local, 80, Ipv4Address("10.1.0.10"), 1010, interface);
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), listener, "Removed connection found");
+    connections[11]->SetPeer(Ipv4Address("10.3.0.1"), 2000);
+    endPoints = demux.Lookup(local, 80, Ipv4Address("10.1.0.11"), 1011, interface);
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), listener, "Connection found under its old peer");
+    endPoints = demux.Lookup(local, 80, Ipv4Address("10.3.0.1"), 2000, interface);
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), connections[11], "Connection not found");
+
+    // An endpoint connected after its allocation, as by Socket::Connect
+    Ipv4EndPoint* client = demux.Allocate(local);
+    NS_TEST_ASSERT_MSG_NE(client, nullptr, "Client endpoint not allocated");
+    client->SetPeer(Ipv4Address("10.4.0.1"), 443);
+    uint16_t clientPort = client->GetLocalPort();
+    endPoints = demux.Lookup(local, clientPort, Ipv4Address("10.4.0.1"), 443, interface);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connected client not found");
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), client, "Wrong endpoint found");
+    endPoints = demux.Lookup(local, clientPort, Ipv4Address("10.4.0.2"), 443, interface);
+    NS_TEST_EXPECT_MSG_EQ(endPoints.size(), 0, "Connected client found for another peer");
+
+    NS_TEST_EXPECT_MSG_EQ(demux.GetAllEndPoints().size(), 1001, "Wrong number of endpoints");
+    NS_TEST_EXPECT_MSG_EQ(demux.GetAllEndPoints().front(), listener, "Endpoints reordered");
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check the allocation of the ephemeral ports of the Ipv4EndPointDemux.
+ */
+class Ipv4EndPointDemuxEphemeralTestCase : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxEphemeralTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv4EndPointDemuxEphemeralTestCase::Ipv4EndPointDemuxEphemeralTestCase()
+    : TestCase("Check the allocation of the IPv4 ephemeral ports")
+{
+}
+
+void
+Ipv4EndPointDemuxEphemeralTestCase::DoRun()
+{
+    Ipv4EndPointDemux demux;
+
+    // The ports are allocated counting up from the first one, skipping the ports in use
+    NS_TEST_ASSERT_MSG_NE(demux.Allocate(nullptr, Ipv4Address::GetAny(), 49155),
+                          nullptr,
+                          "Endpoint not allocated");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(49155), true, "Port in use not found");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49153, "Wrong ephemeral port");
+    Ipv4EndPoint* second = demux.Allocate();
+    NS_TEST_EXPECT_MSG_EQ(second->GetLocalPort(), 49154, "Wrong ephemeral port");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49156, "Port in use allocated");
+    demux.DeAllocate(second);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(49154), false, "Port released still in use");
+
+    // All the ports, then the released ones after wrapping around
+    uint32_t allocated = 3;
+    while (demux.Allocate())
+    {
+        allocated++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(allocated, 65535 - 49152 + 1, "Wrong number of ephemeral ports");
+    auto endPoints = demux.GetAllEndPoints();
+    Ipv4EndPoint* released = *std::next(endPoints.begin(), 1000);
+    uint16_t port = released->GetLocalPort();
+    demux.DeAllocate(released);
+    Ipv4EndPoint* reused = demux.Allocate();
+    NS_TEST_ASSERT_MSG_NE(reused, nullptr, "Released port not allocated");
+    NS_TEST_EXPECT_MSG_EQ(reused->GetLocalPort(), port, "Wrong ephemeral port");
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check the lookups of the Ipv6EndPointDemux.
+ */
+class Ipv6EndPointDemuxLookupTestCase : public TestCase
+{
+  public:
+    Ipv6EndPointDemuxLookupTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv6EndPointDemuxLookupTestCase::Ipv6EndPointDemuxLookupTestCase()
+    : TestCase("Check the lookups of the IPv6 endpoints")
+{
+}
+
+void
+Ipv6EndPointDemuxLookupTestCase::DoRun()
+{
+    Ipv6EndPointDemux demux;
+    Ipv6Address local("2001:db8::1");
+
+    Ipv6EndPoint* listener = demux.Allocate(nullptr, Ipv6Address::GetAny(), 80);
+    NS_TEST_ASSERT_MSG_NE(listener, nullptr, "Listening endpoint not allocated");
+
+    std::vector<Ipv6EndPoint*> connections;
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        uint8_t bytes[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 1};
+        bytes[14] = i >> 8;
+        bytes[15] = i & 0xff;
+        connections.push_back(demux.Allocate(nullptr, local, 80, Ipv6Address(bytes), 1000 + i));
+        NS_TEST_ASSERT_MSG_NE(connections.back(), nullptr, "Connection not allocated");
+    }
+
+    for (uint16_t i = 0; i < 100; i += 7)
+    {
+        auto endPoints = demux.Lookup(local,
+                                      80,
+                                      connections[i]->GetPeerAddress(),
+                                      1000 + i,
+                                      nullptr);
+        NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connection not found");
+        NS_TEST_EXPECT_MSG_EQ(endPoints.front(), connections[i], "Wrong connection found");
+    }
+    auto endPoints = demux.Lookup(local, 80, Ipv6Address("2001:db8::2"), 1000, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Listener not found");
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), listener, "Wrong endpoint found");
+
+    Ipv6EndPoint* client = demux.Allocate(local);
+    NS_TEST_ASSERT_MSG_NE(client, nullptr, "Client endpoint not allocated");
+    NS_TEST_EXPECT_MSG_EQ(client->GetLocalPort(), 49153, "Wrong ephemeral port");
+    client->SetPeer(Ipv6Address("2001:db8::3"), 443);
+    endPoints = demux.Lookup(local, 49153, Ipv6Address("2001:db8::3"), 443, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connected client not found");
+    NS_TEST_EXPECT_MSG_EQ(endPoints.front(), client, "Wrong endpoint found");
+    demux.DeAllocate(client);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(49153), false, "Port released still in use");
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Endpoint demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    EndPointDemuxTestSuite()
+        : TestSuite("end-point-demux", Type::UNIT)
+    {
+        AddTestCase(new Ipv4EndPointDemuxLookupTestCase, TestCase::Duration::QUICK);
+        AddTestCase(new Ipv4EndPointDemuxEphemeralTestCase, TestCase::Duration::QUICK);
+        AddTestCase(new Ipv6EndPointDemuxLookupTestCase, TestCase::Duration::QUICK);
+    }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -10,12 +10,28 @@
  * of the quagga 0.99.7/src/ospfd/ospf_spf.c code which was ported here
  */
 
+#include "ns3/boolean.h"
 #include "ns3/candidate-queue.h"
+#include "ns3/config.h"
 #include "ns3/global-route-manager-impl.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/simple-net-device-helper.h"
 #include "ns3/simulator.h"
+#include "ns3/socket.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <cstdlib> // for rand()
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -204,6 +220,355 @@ GlobalRouteManagerImplTestCase::DoRun()
     // does not crash
 }
 
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check the order in which the CandidateQueue pops the vertices.
+ */
+class CandidateQueueOrderTestCase : public TestCase
+{
+  public:
+    CandidateQueueOrderTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+CandidateQueueOrderTestCase::CandidateQueueOrderTestCase()
+    : TestCase("Check the order of the candidate queue")
+{
+}
+
+void
+CandidateQueueOrderTestCase::DoRun()
+{
+    // The LSAs of four routers and of a network
+    std::vector<GlobalRoutingLSA> lsas(5);
+    for (uint32_t i = 0; i < lsas.size(); i++)
+    {
+        lsas[i].SetLSType(i < 4 ? GlobalRoutingLSA::RouterLSA : GlobalRoutingLSA::NetworkLSA);
+        lsas[i].SetLinkStateId(Ipv4Address(i + 1));
+    }
+    auto push = [&lsas](CandidateQueue& candidate, uint32_t i, uint32_t distance) {
+        auto v = new SPFVertex(&lsas[i]);
+        v->SetDistanceFromRoot(distance);
+        candidate.Push(v);
+        return v;
+    };
+    auto popAll = [](CandidateQueue& candidate) {
+        std::vector<uint32_t> ids;
+        while (candidate.Size())
+        {
+            SPFVertex* v = candidate.Pop();
+            ids.push_back(v->GetVertexId().Get());
+            delete v;
+        }
+        return ids;
+    };
+
+    // By distance, the networks before the routers, then in their order of insertion
+    CandidateQueue candidate;
+    push(candidate, 0, 5);
+    push(candidate, 4, 5);
+    push(candidate, 1, 3);
+    push(candidate, 2, 5);
+    NS_TEST_EXPECT_MSG_EQ(candidate.Top()->GetVertexId(), Ipv4Address(2), "Wrong top vertex");
+    NS_TEST_EXPECT_MSG_EQ(candidate.Find(Ipv4Address(3))->GetDistanceFromRoot(),
+                          5,
+                          "Wrong vertex found");
+    NS_TEST_EXPECT_MSG_EQ(candidate.Find(Ipv4Address(4)), nullptr, "Missing vertex found");
+    NS_TEST_EXPECT_MSG_EQ((popAll(candidate) == std::vector<uint32_t>{2, 5, 1, 3}),
+                          true,
+                          "Wrong order of the vertices");
+
+    // A vertex whose distance decreases comes after the vertices already
+    // at this distance, as with a stable sort of the queue
+    push(candidate, 0, 3);
+    SPFVertex* v1 = push(candidate, 1, 7);
+    push(candidate, 2, 5);
+    SPFVertex* v3 = push(candidate, 3, 4);
+    v1->SetDistanceFromRoot(3);
+    candidate.Update(v1);
+    v3->SetDistanceFromRoot(6);
+    candidate.Update(v3);
+    NS_TEST_EXPECT_MSG_EQ((popAll(candidate) == std::vector<uint32_t>{1, 2, 3, 4}),
+                          true,
+                          "Wrong order of the updated vertices");
+
+    // Reorder after changing several distances
+    std::vector<SPFVertex*> vertices;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        vertices.push_back(push(candidate, i, 10 + i));
+    }
+    vertices[4]->SetDistanceFromRoot(2);
+    vertices[0]->SetDistanceFromRoot(20);
+    vertices[3]->SetDistanceFromRoot(2);
+    candidate.Reorder();
+    NS_TEST_EXPECT_MSG_EQ((popAll(candidate) == std::vector<uint32_t>{5, 4, 2, 3, 1}),
+                          true,
+                          "Wrong order of the reordered vertices");
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check that the routes calculated in parallel, updated
+ * incrementally or stored in compact tables are those of a complete
+ * calculation.
+ */
+class GlobalRoutingUpdateTestCase : public TestCase
+{
+  public:
+    GlobalRoutingUpdateTestCase();
+
+  private:
+    void DoRun() override;
+
+    /// The routes of the nodes, after each change of the topology
+    typedef std::vector<std::vector<std::vector<std::string>>> RoutesHistory;
+
+    /**
+     * Run the changes of the topology, recomputing the routes after each one.
+     *
+     * @param threads The number of threads calculating the routes.
+     * @param incremental Whether the routes are updated incrementally.
+     * @param compact Whether the routes are stored in compact tables.
+     * @returns The routes of the nodes, after each change.
+     */
+    RoutesHistory RunChanges(uint32_t threads, bool incremental, bool compact);
+};
+
+GlobalRoutingUpdateTestCase::GlobalRoutingUpdateTestCase()
+    : TestCase("Check the parallel and incremental calculations of the global routes")
+{
+}
+
+GlobalRoutingUpdateTestCase::RoutesHistory
+GlobalRoutingUpdateTestCase::RunChanges(uint32_t threads, bool incremental, bool compact)
+{
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(threads));
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(incremental));
+    Config::SetDefault("ns3::Ipv4GlobalRouting::CompactRoutes", BooleanValue(compact));
+
+    // A ring of 9 routers linked by point-to-point links, with a shared
+    // network between router 0 and two other routers, and a host attached
+    // to router 5.  There are no equal-cost paths to the shared network,
+    // which SPFNexthopCalculation () does not support.
+    const uint32_t ring = 9;
+    NodeContainer nodes;
+    nodes.Create(ring + 3);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    simple.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper address("10.0.0.0", "255.255.255.252");
+    std::vector<Ipv4InterfaceContainer> links;
+    auto link = [&](uint32_t a, uint32_t b) {
+        links.push_back(address.Assign(simple.Install(NodeContainer(nodes.Get(a), nodes.Get(b)))));
+        address.NewNetwork();
+    };
+    for (uint32_t i = 0; i < ring; i++)
+    {
+        link(i, (i + 1) % ring);
+    }
+    link(5, ring + 2);
+    SimpleNetDeviceHelper shared;
+    Ipv4AddressHelper lanAddress("192.168.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer lan = lanAddress.Assign(
+        shared.Install(NodeContainer(nodes.Get(0), nodes.Get(ring), nodes.Get(ring + 1))));
+
+    auto getRoutes = [&nodes]() {
+        std::vector<std::vector<std::string>> routes;
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            Ptr<Ipv4GlobalRouting> routing = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(
+                nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol());
+            std::vector<std::string> nodeRoutes;
+            for (uint32_t j = 0; j < routing->GetNRoutes(); j++)
+            {
+                std::ostringstream oss;
+                oss << *routing->GetRoute(j);
+                nodeRoutes.push_back(oss.str());
+            }
+            routes.push_back(nodeRoutes);
+        }
+        return routes;
+    };
+
+    RoutesHistory history;
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    history.push_back(getRoutes());
+    auto change = [&](auto action) {
+        action();
+        Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+        history.push_back(getRoutes());
+    };
+    // A link of the ring goes down and up
+    auto [ipv4Down, interfaceDown] = links[2].Get(0);
+    change([&]() { ipv4Down->SetDown(interfaceDown); });
+    change([&]() { ipv4Down->SetUp(interfaceDown); });
+    // A link gets longer, giving equal-cost paths between some routers, and
+    // shorter again
+    auto setMetric = [&links](uint16_t metric) {
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            auto [ipv4, interface] = links[4].Get(i);
+            ipv4->SetMetric(interface, metric);
+        }
+    };
+    change([&]() { setMetric(2); });
+    change([&]() { setMetric(1); });
+    // A router leaves the shared network, then the host leaves
+    auto [ipv4Lan, interfaceLan] = lan.Get(2);
+    change([&]() { ipv4Lan->SetDown(interfaceLan); });
+    auto [ipv4Host, interfaceHost] = links.back().Get(1);
+    change([&]() { ipv4Host->SetDown(interfaceHost); });
+    // Nothing changes
+    change([]() {});
+
+    Simulator::Destroy();
+    return history;
+}
+
+void
+GlobalRoutingUpdateTestCase::DoRun()
+{
+    RoutesHistory expected = RunChanges(1, false, false);
+    NS_TEST_ASSERT_MSG_GT(expected[0][1].size(), 10, "Routes not calculated");
+    for (bool compact : {false, true})
+    {
+        for (uint32_t threads : {1, 4})
+        {
+            for (bool incremental : {false, true})
+            {
+                RoutesHistory history = RunChanges(threads, incremental, compact);
+                NS_TEST_ASSERT_MSG_EQ(history.size(), expected.size(), "Wrong number of changes");
+                for (std::size_t i = 0; i < history.size(); i++)
+                {
+                    for (std::size_t j = 0; j < history[i].size(); j++)
+                    {
+                        std::vector<std::string> routes = history[i][j];
+                        std::vector<std::string> expectedRoutes = expected[i][j];
+                        if (compact)
+                        {
+                            // The compact routes are enumerated by destination
+                            std::sort(routes.begin(), routes.end());
+                            std::sort(expectedRoutes.begin(), expectedRoutes.end());
+                        }
+                        NS_TEST_EXPECT_MSG_EQ((routes == expectedRoutes),
+                                              true,
+                                              "Wrong routes of node "
+                                                  << j << " after change " << i << " with "
+                                                  << threads << " threads, incremental "
+                                                  << incremental << ", compact " << compact);
+                    }
+                }
+            }
+        }
+    }
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(false));
+    Config::SetDefault("ns3::Ipv4GlobalRouting::CompactRoutes", BooleanValue(false));
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check that the routes updated incrementally keep their place in
+ * the routing tables, which decides the route used to a destination
+ * matched by the overlapping prefixes advertised by different routers.
+ */
+class GlobalRoutingOverlapTestCase : public TestCase
+{
+  public:
+    GlobalRoutingOverlapTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Change the metrics of the stub networks of the routers, recomputing
+     * the routes after each change.
+     *
+     * @param incremental Whether the routes are updated incrementally.
+     * @returns The gateway used by the middle router to reach the
+     * overlapping prefixes, after each change.
+     */
+    std::vector<Ipv4Address> RunChanges(bool incremental);
+};
+
+GlobalRoutingOverlapTestCase::GlobalRoutingOverlapTestCase()
+    : TestCase("Check the order of the global routes to overlapping prefixes")
+{
+}
+
+std::vector<Ipv4Address>
+GlobalRoutingOverlapTestCase::RunChanges(bool incremental)
+{
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(incremental));
+
+    // A line of three routers, the outer ones with a stub network: the
+    // middle router has routes to 172.16.0.0/16 through router 0 and to
+    // 172.16.1.0/24 through router 2, and the global routing uses the
+    // first of them in its table to reach 172.16.1.1
+    NodeContainer nodes;
+    nodes.Create(3);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    simple.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper address("10.0.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        address.Assign(simple.Install(NodeContainer(nodes.Get(i), nodes.Get(i + 1))));
+        address.NewNetwork();
+    }
+    SimpleNetDeviceHelper stub;
+    Ipv4AddressHelper wide("172.16.0.0", "255.255.0.0", "0.0.0.1");
+    Ipv4InterfaceContainer stubs = wide.Assign(stub.Install(nodes.Get(0)));
+    Ipv4AddressHelper narrow("172.16.1.0", "255.255.255.0", "0.0.0.2");
+    stubs.Add(narrow.Assign(stub.Install(nodes.Get(2))));
+
+    Ptr<Ipv4RoutingProtocol> routing = nodes.Get(1)->GetObject<Ipv4>()->GetRoutingProtocol();
+    std::vector<Ipv4Address> gateways;
+    auto lookup = [&]() {
+        Ipv4Header header;
+        header.SetDestination(Ipv4Address("172.16.1.1"));
+        Socket::SocketErrno err;
+        Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, nullptr, err);
+        gateways.push_back(route ? route->GetGateway() : Ipv4Address::GetAny());
+    };
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    lookup();
+    // The routes to the stub networks of each outer router are updated
+    for (uint32_t i = 0; i < stubs.GetN(); i++)
+    {
+        auto [ipv4, interface] = stubs.Get(i);
+        ipv4->SetMetric(interface, 2);
+        Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+        lookup();
+    }
+
+    Simulator::Destroy();
+    return gateways;
+}
+
+void
+GlobalRoutingOverlapTestCase::DoRun()
+{
+    std::vector<Ipv4Address> expected = RunChanges(false);
+    NS_TEST_ASSERT_MSG_EQ(expected.size(), 3, "Wrong number of lookups");
+    NS_TEST_EXPECT_MSG_NE(expected[0], Ipv4Address::GetAny(), "No route found");
+    std::vector<Ipv4Address> gateways = RunChanges(true);
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(gateways[i], expected[i], "Wrong gateway after change " << i);
+    }
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(false));
+}
+
 /**
  * @ingroup internet-test
  *
@@ -221,6 +586,9 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite()
     : TestSuite("global-route-manager-impl", Type::UNIT)
 {
     AddTestCase(new GlobalRouteManagerImplTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new CandidateQueueOrderTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new GlobalRoutingUpdateTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new GlobalRoutingOverlapTestCase(), TestCase::Duration::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite
@@ -4,6 +4,7 @@
 
 #include "ns3/boolean.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/compact-route-table.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
@@ -30,6 +31,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <sstream>
 #include <vector>
 
 using namespace ns3;
@@ -1300,6 +1303,227 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check that the compact routing tables route as the regular ones.
+ */
+class Ipv4GlobalRoutingCompactTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingCompactTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * @param routing The routing protocol.
+     * @returns The routes of the routing protocol, sorted.
+     */
+    std::vector<std::string> GetRoutes(Ptr<Ipv4GlobalRouting> routing);
+
+    /**
+     * Check that two routing protocols give the same route to a destination.
+     *
+     * @param regular The routing protocol storing the regular routes.
+     * @param compact The routing protocol storing the compact routes.
+     * @param dest The destination.
+     * @param interface The requested output interface, or 0 for any.
+     */
+    void CheckRoute(Ptr<Ipv4GlobalRouting> regular,
+                    Ptr<Ipv4GlobalRouting> compact,
+                    Ipv4Address dest,
+                    uint32_t interface = 0);
+
+    std::vector<Ptr<NetDevice>> m_devices; //!< The devices of the two nodes
+};
+
+Ipv4GlobalRoutingCompactTestCase::Ipv4GlobalRoutingCompactTestCase()
+    : TestCase("Check the compact global routing tables")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingCompactTestCase::GetRoutes(Ptr<Ipv4GlobalRouting> routing)
+{
+    std::vector<std::string> routes;
+    for (uint32_t i = 0; i < routing->GetNRoutes(); i++)
+    {
+        std::ostringstream oss;
+        oss << routing->GetRouteEntry(i);
+        routes.push_back(oss.str());
+    }
+    std::sort(routes.begin(), routes.end());
+    return routes;
+}
+
+void
+Ipv4GlobalRoutingCompactTestCase::CheckRoute(Ptr<Ipv4GlobalRouting> regular,
+                                             Ptr<Ipv4GlobalRouting> compact,
+                                             Ipv4Address dest,
+                                             uint32_t interface)
+{
+    Ipv4Header header;
+    header.SetDestination(dest);
+    Socket::SocketErrno sockerr;
+    Ptr<NetDevice> regularOif = interface ? m_devices[interface - 1] : nullptr;
+    Ptr<NetDevice> compactOif = interface ? m_devices[interface + 1] : nullptr;
+    Ptr<Ipv4Route> expected = regular->RouteOutput(nullptr, header, regularOif, sockerr);
+    Ptr<Ipv4Route> route = compact->RouteOutput(nullptr, header, compactOif, sockerr);
+    if (!expected)
+    {
+        NS_TEST_EXPECT_MSG_EQ(route, nullptr, "Route found to " << dest);
+        return;
+    }
+    NS_TEST_ASSERT_MSG_NE(route, nullptr, "No route found to " << dest);
+    NS_TEST_EXPECT_MSG_EQ(route->GetGateway(), expected->GetGateway(), "Wrong route to " << dest);
+    NS_TEST_EXPECT_MSG_EQ(route->GetOutputDevice()->GetIfIndex(),
+                          expected->GetOutputDevice()->GetIfIndex(),
+                          "Wrong device to " << dest);
+}
+
+void
+Ipv4GlobalRoutingCompactTestCase::DoRun()
+{
+    // Two identical nodes, one storing the compact routes
+    NodeContainer nodes;
+    nodes.Create(2);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    std::vector<Ptr<Ipv4GlobalRouting>> routings;
+    for (uint32_t n = 0; n < 2; n++)
+    {
+        Ptr<Ipv4> ipv4 = nodes.Get(n)->GetObject<Ipv4>();
+        for (uint32_t i = 1; i <= 2; i++)
+        {
+            Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+            device->SetAddress(Mac48Address::Allocate());
+            nodes.Get(n)->AddDevice(device);
+            m_devices.push_back(device);
+            int32_t interface = ipv4->AddInterface(device);
+            Ipv4Address address(Ipv4Address("10.0.0.1").Get() + (i << 8));
+            ipv4->AddAddress(interface, Ipv4InterfaceAddress(address, Ipv4Mask("/24")));
+            ipv4->SetUp(interface);
+        }
+        routings.push_back(
+            Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(ipv4->GetRoutingProtocol()));
+    }
+    Ptr<Ipv4GlobalRouting> regular = routings[0];
+    Ptr<Ipv4GlobalRouting> compact = routings[1];
+    compact->SetCompactRoutes(true);
+
+    // Networks reached through one or two of a few gateways, some of their
+    // hosts, and an external default route
+    for (Ptr<Ipv4GlobalRouting> routing : routings)
+    {
+        for (uint32_t i = 0; i < 200; i++)
+        {
+            Ipv4Address network(Ipv4Address("172.16.0.0").Get() + (i << 8));
+            uint32_t interface = 1 + i % 2;
+            Ipv4Address gateway(Ipv4Address("10.0.0.2").Get() + (interface << 8) + i % 3);
+            routing->AddNetworkRouteTo(network, Ipv4Mask("/24"), gateway, interface);
+            if (i % 4 == 0)
+            {
+                routing->AddNetworkRouteTo(network,
+                                           Ipv4Mask("/24"),
+                                           Ipv4Address(gateway.Get() + 10),
+                                           interface);
+            }
+            if (i % 5 == 0)
+            {
+                routing->AddHostRouteTo(Ipv4Address(network.Get() + 1), 3 - interface);
+            }
+        }
+        routing->AddASExternalRouteTo("0.0.0.0", Ipv4Mask::GetZero(), "10.0.1.254", 1);
+    }
+    NS_TEST_EXPECT_MSG_EQ(compact->GetNRoutes(), regular->GetNRoutes(), "Wrong number of routes");
+    NS_TEST_EXPECT_MSG_EQ((GetRoutes(compact) == GetRoutes(regular)), true, "Wrong routes");
+
+    // The copies of the compact routes remain valid, unlike the pointers
+    Ipv4RoutingTableEntry firstRoute = compact->GetRouteEntry(0);
+    Ipv4RoutingTableEntry lastRoute = compact->GetRouteEntry(compact->GetNRoutes() - 1);
+    NS_TEST_EXPECT_MSG_EQ(firstRoute.GetDest(),
+                          compact->GetRoute(0)->GetDest(),
+                          "Wrong copy of the first route");
+    NS_TEST_EXPECT_MSG_NE(firstRoute.GetDest(), lastRoute.GetDest(), "Copies of the routes alias");
+
+    auto checkRoutes = [&]() {
+        for (uint32_t i = 0; i < 210; i += 3)
+        {
+            Ipv4Address network(Ipv4Address("172.16.0.0").Get() + (i << 8));
+            for (uint32_t host : {1, 9})
+            {
+                CheckRoute(regular, compact, Ipv4Address(network.Get() + host));
+                CheckRoute(regular, compact, Ipv4Address(network.Get() + host), 1);
+                CheckRoute(regular, compact, Ipv4Address(network.Get() + host), 2);
+            }
+        }
+    };
+    checkRoutes();
+
+    // Routes removed by value, and by number
+    for (Ptr<Ipv4GlobalRouting> routing : routings)
+    {
+        for (uint32_t i = 0; i < 200; i += 4)
+        {
+            Ipv4Address network(Ipv4Address("172.16.0.0").Get() + (i << 8));
+            Ipv4Address gateway(Ipv4Address("10.0.0.2").Get() + ((1 + i % 2) << 8) + i % 3);
+            NS_TEST_EXPECT_MSG_EQ(
+                routing->RemoveNetworkRouteTo(network, Ipv4Mask("/24"), gateway, 1 + i % 2),
+                true,
+                "Route to " << network << " not removed");
+            NS_TEST_EXPECT_MSG_EQ(
+                routing->RemoveNetworkRouteTo(network, Ipv4Mask("/24"), gateway, 1 + i % 2),
+                false,
+                "Route to " << network << " removed twice");
+        }
+        NS_TEST_EXPECT_MSG_EQ(
+            routing->RemoveHostRouteTo("172.16.10.1", Ipv4Address::GetZero(), 2),
+            true,
+            "Host route not removed");
+    }
+    NS_TEST_EXPECT_MSG_EQ((GetRoutes(compact) == GetRoutes(regular)), true, "Wrong routes");
+    checkRoutes();
+    while (compact->GetNRoutes() > 0)
+    {
+        compact->RemoveRoute(0);
+    }
+    NS_TEST_EXPECT_MSG_EQ(GetRoutes(compact).size(), 0, "Routes not removed");
+    Ipv4Header header;
+    header.SetDestination("172.16.0.1");
+    Socket::SocketErrno sockerr;
+    NS_TEST_EXPECT_MSG_EQ(compact->RouteOutput(nullptr, header, nullptr, sockerr),
+                          nullptr,
+                          "Route found after removing all the routes");
+
+    // The tables share the destinations, and store each group of next hops once
+    CompactRouteDestinations destinations;
+    CompactRouteTable first(&destinations);
+    CompactRouteTable second(&destinations);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        Ipv4Address network(Ipv4Address("192.168.0.0").Get() + (i << 2));
+        first.Add(network, Ipv4Mask("/30"), "10.0.1.2", 1);
+        second.Add(network, Ipv4Mask("/30"), "10.0.2.2", 2);
+        second.Add(network, Ipv4Mask("/30"), "10.0.1.2", 1);
+    }
+    NS_TEST_EXPECT_MSG_EQ(destinations.GetN(), 1000, "Destinations not shared");
+    NS_TEST_EXPECT_MSG_EQ(first.GetNGroups(), 2, "Groups of next hops not shared");
+    NS_TEST_EXPECT_MSG_EQ(second.GetNGroups(), 3, "Groups of next hops not shared");
+    NS_TEST_EXPECT_MSG_EQ(second.GetNRoutes(), 2000, "Wrong number of routes");
+    NS_TEST_EXPECT_MSG_EQ(second.GetRoute(1001).GetGateway(),
+                          Ipv4Address("10.0.1.2"),
+                          "Wrong order of the routes");
+    std::vector<Ipv4RoutingTableEntry*> routes;
+    second.GetMatchingRoutes("192.168.0.5", routes);
+    NS_TEST_ASSERT_MSG_EQ(routes.size(), 2, "Wrong number of matching routes");
+    NS_TEST_EXPECT_MSG_EQ(routes[0]->GetDest(), Ipv4Address("192.168.0.4"), "Wrong match");
+    NS_TEST_EXPECT_MSG_EQ(routes[0]->GetGateway(), Ipv4Address("10.0.2.2"), "Wrong match order");
+
+    m_devices.clear();
+    Simulator::Destroy();
+}
+
 /**
  * @ingroup internet-test
  *
@@ -1322,6 +1546,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::Duration::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::Duration::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::Duration::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingCompactTestCase, TestCase::Duration::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
@@ -0,0 +1,328 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/node.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup internet-test
+ * PrefixTrie test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check the matches of a PrefixTrie against a linear search.
+ */
+template <std::size_t N>
+class PrefixTrieMatchTestCase : public TestCase
+{
+  public:
+    PrefixTrieMatchTestCase();
+
+  private:
+    void DoRun() override;
+
+    /// The trie under test
+    using Trie = PrefixTrie<uint32_t, N>;
+
+    /// A prefix, with its value
+    struct Prefix
+    {
+        typename Trie::Key key; //!< the prefix
+        uint8_t length;         //!< the length of the prefix
+        uint32_t value;         //!< the value
+    };
+
+    /**
+     * Check the matches of an address.
+     *
+     * @param trie The trie.
+     * @param prefixes The prefixes of the trie, in their order of insertion.
+     * @param address The address.
+     */
+    void CheckMatches(const Trie& trie,
+                      const std::vector<Prefix>& prefixes,
+                      const typename Trie::Key& address);
+};
+
+template <std::size_t N>
+PrefixTrieMatchTestCase<N>::PrefixTrieMatchTestCase()
+    : TestCase("Check the matches of the prefixes of " + std::to_string(N * 8) + " bits")
+{
+}
+
+template <std::size_t N>
+void
+PrefixTrieMatchTestCase<N>::CheckMatches(const Trie& trie,
+                                         const std::vector<Prefix>& prefixes,
+                                         const typename Trie::Key& address)
+{
+    // The values of the matching prefixes, by decreasing length
+    std::map<uint8_t, std::vector<uint32_t>, std::greater<>> expected;
+    for (const auto& prefix : prefixes)
+    {
+        bool match = true;
+        for (uint8_t i = 0; i < prefix.length && match; i++)
+        {
+            uint8_t bit = 0x80 >> (i % 8);
+            match = (prefix.key[i / 8] & bit) == (address[i / 8] & bit);
+        }
+        if (match)
+        {
+            expected[prefix.length].push_back(prefix.value);
+        }
+    }
+
+    std::map<uint8_t, std::vector<uint32_t>, std::greater<>> matches;
+    uint8_t last = Trie::BITS + 1;
+    trie.ForEachMatch(address, [&](uint8_t length, const std::vector<uint32_t>& values) {
+        NS_TEST_EXPECT_MSG_LT(length, last, "Prefixes not visited from the longest");
+        last = length;
+        matches[length] = values;
+        return false;
+    });
+    NS_TEST_EXPECT_MSG_EQ((matches == expected), true, "Wrong matches");
+
+    // The visit stops at the longest prefix
+    uint32_t visited = 0;
+    trie.ForEachMatch(address, [&visited](uint8_t, const std::vector<uint32_t>&) {
+        visited++;
+        return true;
+    });
+    NS_TEST_EXPECT_MSG_EQ(visited, (expected.empty() ? 0 : 1), "Visit not stopped");
+}
+
+template <std::size_t N>
+void
+PrefixTrieMatchTestCase<N>::DoRun()
+{
+    std::mt19937 rng(1);
+    // A few leading bits, so that the prefixes share long branches
+    auto randomKey = [&rng]() {
+        typename Trie::Key key;
+        for (auto& byte : key)
+        {
+            byte = rng();
+        }
+        key[0] &= 0x03;
+        return key;
+    };
+
+    Trie trie;
+    std::vector<Prefix> prefixes;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        uint8_t length = (i % 10 == 0) ? Trie::BITS : rng() % (Trie::BITS / 2);
+        typename Trie::Key key = (i % 3 == 0 && !prefixes.empty())
+                                     ? prefixes[rng() % prefixes.size()].key
+                                     : randomKey();
+        // The bits after the length are ignored
+        prefixes.push_back({key, length, i});
+        trie.Insert(key, length, i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(trie.GetSize(), prefixes.size(), "Wrong number of values");
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        CheckMatches(trie, prefixes, (i % 2) ? randomKey() : prefixes[i].key);
+    }
+
+    // Remove two thirds of the values, the other ones keeping their order
+    std::vector<Prefix> kept;
+    for (const auto& prefix : prefixes)
+    {
+        if (prefix.value % 3)
+        {
+            NS_TEST_EXPECT_MSG_EQ(trie.Remove(prefix.key, prefix.length, prefix.value),
+                                  true,
+                                  "Value not removed");
+        }
+        else
+        {
+            kept.push_back(prefix);
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(prefixes[1].key, prefixes[1].length, prefixes[1].value),
+                          false,
+                          "Value removed twice");
+    NS_TEST_EXPECT_MSG_EQ(trie.GetSize(), kept.size(), "Wrong number of values");
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        CheckMatches(trie, kept, (i % 2) ? randomKey() : prefixes[i].key);
+    }
+
+    trie.Clear();
+    NS_TEST_EXPECT_MSG_EQ(trie.GetSize(), 0, "Values not cleared");
+    CheckMatches(trie, {}, prefixes[0].key);
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief Check the longest prefix match of Ipv4StaticRouting.
+ */
+class Ipv4StaticRoutingLongestMatchTestCase : public TestCase
+{
+  public:
+    Ipv4StaticRoutingLongestMatchTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check the gateway of the route to a destination.
+     *
+     * @param routing The routing protocol.
+     * @param dest The destination.
+     * @param gateway The expected gateway, or "" if there is no route.
+     * @param oif The output device, if any.
+     */
+    void CheckRoute(Ptr<Ipv4StaticRouting> routing,
+                    std::string dest,
+                    std::string gateway,
+                    Ptr<NetDevice> oif = nullptr);
+};
+
+Ipv4StaticRoutingLongestMatchTestCase::Ipv4StaticRoutingLongestMatchTestCase()
+    : TestCase("Check the longest prefix match of Ipv4StaticRouting")
+{
+}
+
+void
+Ipv4StaticRoutingLongestMatchTestCase::CheckRoute(Ptr<Ipv4StaticRouting> routing,
+                                                  std::string dest,
+                                                  std::string gateway,
+                                                  Ptr<NetDevice> oif)
+{
+    Ipv4Header header;
+    header.SetDestination(Ipv4Address(dest.c_str()));
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, oif, sockerr);
+    if (gateway.empty())
+    {
+        NS_TEST_EXPECT_MSG_EQ(route, nullptr, "Route found to " << dest);
+        return;
+    }
+    NS_TEST_ASSERT_MSG_NE(route, nullptr, "No route found to " << dest);
+    NS_TEST_EXPECT_MSG_EQ(route->GetGateway(),
+                          Ipv4Address(gateway.c_str()),
+                          "Wrong route to " << dest);
+}
+
+void
+Ipv4StaticRoutingLongestMatchTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    std::vector<Ptr<NetDevice>> devices;
+    for (uint32_t i = 1; i <= 2; i++)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(device);
+        devices.push_back(device);
+        int32_t interface = ipv4->AddInterface(device);
+        Ipv4Address address(Ipv4Address("10.0.0.1").Get() + (i << 8));
+        ipv4->AddAddress(interface, Ipv4InterfaceAddress(address, Ipv4Mask("/24")));
+        ipv4->SetUp(interface);
+    }
+
+    Ipv4StaticRoutingHelper helper;
+    Ptr<Ipv4StaticRouting> routing = helper.GetStaticRouting(ipv4);
+    CheckRoute(routing, "172.16.1.1", "");
+
+    routing->SetDefaultRoute(Ipv4Address("10.0.1.254"), 1);
+    routing->AddNetworkRouteTo(Ipv4Address("172.16.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("10.0.1.2"),
+                               1,
+                               5);
+    routing->AddNetworkRouteTo(Ipv4Address("172.16.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("10.0.2.2"),
+                               2,
+                               1);
+    routing->AddNetworkRouteTo(Ipv4Address("172.16.1.0"),
+                               Ipv4Mask("/24"),
+                               Ipv4Address("10.0.1.3"),
+                               1);
+    routing->AddNetworkRouteTo(Ipv4Address("172.16.1.0"),
+                               Ipv4Mask("/24"),
+                               Ipv4Address("10.0.1.4"),
+                               1);
+    routing->AddHostRouteTo(Ipv4Address("172.16.1.1"), Ipv4Address("10.0.2.5"), 2);
+
+    // The longest prefix wins, then the lowest metric, then the last route
+    CheckRoute(routing, "172.16.1.1", "10.0.2.5");
+    CheckRoute(routing, "172.16.1.2", "10.0.1.4");
+    CheckRoute(routing, "172.16.2.1", "10.0.2.2");
+    CheckRoute(routing, "8.8.8.8", "10.0.1.254");
+    CheckRoute(routing, "10.0.2.7", "0.0.0.0");
+    // The longest prefix having a route on the requested interface wins
+    CheckRoute(routing, "172.16.1.2", "10.0.2.2", devices[1]);
+    CheckRoute(routing, "172.16.1.1", "10.0.1.4", devices[0]);
+
+    for (uint32_t i = 0; i < routing->GetNRoutes(); i++)
+    {
+        if (routing->GetRoute(i).GetDest() == Ipv4Address("172.16.1.1"))
+        {
+            routing->RemoveRoute(i);
+            break;
+        }
+    }
+    CheckRoute(routing, "172.16.1.1", "10.0.1.4");
+
+    // A route with a non-contiguous mask, ranked by the length of its mask
+    routing->AddNetworkRouteTo(Ipv4Address("192.168.0.0"),
+                               Ipv4Mask("255.255.0.0"),
+                               Ipv4Address("10.0.1.9"),
+                               1);
+    routing->AddNetworkRouteTo(Ipv4Address("192.0.0.0"),
+                               Ipv4Mask("255.0.255.0"),
+                               Ipv4Address("10.0.2.9"),
+                               2);
+    CheckRoute(routing, "192.168.0.5", "10.0.2.9");
+    CheckRoute(routing, "192.168.1.5", "10.0.1.9");
+    CheckRoute(routing, "172.16.1.2", "10.0.1.4");
+    routing->RemoveRoute(routing->GetNRoutes() - 1);
+    CheckRoute(routing, "192.168.0.5", "10.0.1.9");
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup internet-test
+ *
+ * @brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+  public:
+    PrefixTrieTestSuite()
+        : TestSuite("prefix-trie", Type::UNIT)
+    {
+        AddTestCase(new PrefixTrieMatchTestCase<4>, TestCase::Duration::QUICK);
+        AddTestCase(new PrefixTrieMatchTestCase<16>, TestCase::Duration::QUICK);
+        AddTestCase(new Ipv4StaticRoutingLongestMatchTestCase, TestCase::Duration::QUICK);
+    }
+};
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
@@ -31,11 +31,16 @@
  *
  * One packet is sent from each left leaf node.  The packet sinks on the
  * right leaf nodes output logging information when they receive the packet.
+ *
+ * With --partition, the nodes are created on logical processor 0 and
+ * assigned to the logical processors by a DistributedPartitionHelper,
+ * which cuts the link between n4 and n5.
  */
 
 #include "mpi-test-fixtures.h"
 
 #include "ns3/core-module.h"
+#include "ns3/distributed-partition-helper.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
@@ -61,6 +66,8 @@ main(int argc, char* argv[])
     bool tracing = false;
     bool testing = false;
     bool verbose = false;
+    bool stats = false;
+    bool partition = false;
 
     // Parse command line
     CommandLine cmd(__FILE__);
@@ -69,6 +76,10 @@ main(int argc, char* argv[])
     cmd.AddValue("tracing", "Enable pcap tracing", tracing);
     cmd.AddValue("verbose", "verbose output", verbose);
     cmd.AddValue("test", "Enable regression test output", testing);
+    cmd.AddValue("stats", "Print the synchronization statistics of each rank", stats);
+    cmd.AddValue("partition",
+                 "Assign the nodes to the ranks with a DistributedPartitionHelper",
+                 partition);
     cmd.Parse(argc, argv);
 
     // Distributed simulation setup; by default use granted time window algorithm.
@@ -116,16 +127,17 @@ main(int argc, char* argv[])
 
     // Create router nodes.  Left router
     // with system id 0, right router with
-    // system id 1
+    // system id 1, unless the nodes are partitioned afterwards
+    uint32_t rightSystemId = partition ? 0 : 1;
     NodeContainer routerNodes;
     Ptr<Node> routerNode1 = CreateObject<Node>(0);
-    Ptr<Node> routerNode2 = CreateObject<Node>(1);
+    Ptr<Node> routerNode2 = CreateObject<Node>(rightSystemId);
     routerNodes.Add(routerNode1);
     routerNodes.Add(routerNode2);
 
     // Create leaf nodes on right with system id 1
     NodeContainer rightLeafNodes;
-    rightLeafNodes.Create(4, 1);
+    rightLeafNodes.Create(4, rightSystemId);
 
     PointToPointHelper routerLink;
     routerLink.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
@@ -159,6 +171,20 @@ main(int argc, char* argv[])
         rightRouterDevices.Add(temp.Get(1));
     }
 
+    if (partition)
+    {
+        DistributedPartitionHelper partitionHelper;
+        partitionHelper.Partition(systemCount);
+        partitionHelper.Apply();
+        if (verbose)
+        {
+            partitionHelper.PrintReport(std::cout);
+        }
+    }
+    // Each half of the dumbbell is on a single rank
+    uint32_t leftRank = leftLeafNodes.Get(0)->GetSystemId();
+    uint32_t rightRank = rightLeafNodes.Get(0)->GetSystemId();
+
     InternetStackHelper stack;
     if (nix)
     {
@@ -217,13 +243,13 @@ main(int argc, char* argv[])
 
     if (tracing)
     {
-        if (systemId == 0)
+        if (systemId == leftRank)
         {
             routerLink.EnablePcap("router-left", routerDevices, true);
             leafLink.EnablePcap("leaf-left", leftLeafDevices, true);
         }
 
-        if (systemId == 1)
+        if (systemId == rightRank)
         {
             routerLink.EnablePcap("router-right", routerDevices, true);
             leafLink.EnablePcap("leaf-right", rightLeafDevices, true);
@@ -233,7 +259,7 @@ main(int argc, char* argv[])
     // Create a packet sink on the right leafs to receive packets from left leafs
 
     uint16_t port = 50000;
-    if (systemId == 1)
+    if (systemId == rightRank)
     {
         Address sinkLocalAddress(InetSocketAddress(Ipv4Address::GetAny(), port));
         PacketSinkHelper sinkHelper("ns3::UdpSocketFactory", sinkLocalAddress);
@@ -252,7 +278,7 @@ main(int argc, char* argv[])
     }
 
     // Create the OnOff applications to send
-    if (systemId == 0)
+    if (systemId == leftRank)
     {
         OnOffHelper clientHelper("ns3::UdpSocketFactory", Address());
         clientHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
@@ -272,6 +298,18 @@ main(int argc, char* argv[])
 
     Simulator::Stop(Seconds(5));
     Simulator::Run();
+
+    if (stats)
+    {
+        MpiSynchronizationStats syncStats = MpiInterface::GetSynchronizationStats();
+        std::cout << "Rank " << systemId << ": blocked " << syncStats.blockedCount << " times for "
+                  << syncStats.blockedTime.As(Time::MS) << ", sent " << syncStats.packetsSent
+                  << " packets in " << syncStats.messagesSent << " messages ("
+                  << syncStats.nullMessagesSent << " null, " << syncStats.nullMessagesSkipped
+                  << " skipped), received " << syncStats.packetsReceived << " packets in "
+                  << syncStats.messagesReceived << " messages" << std::endl;
+    }
+
     Simulator::Destroy();
 
     if (testing)
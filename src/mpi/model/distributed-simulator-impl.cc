@@ -26,6 +26,7 @@
 #include "ns3/scheduler.h"
 #include "ns3/simulator.h"
 
+#include <chrono>
 #include <cmath>
 #include <mpi.h>
 
@@ -365,6 +366,7 @@ DistributedSimulatorImpl::Run()
         // completed.
         if (nextTime > m_grantedTime || IsLocalFinished())
         {
+            auto blockedStart = std::chrono::steady_clock::now();
             // Can't process next event, calculate a new LBTS
             // First receive any pending messages
             GrantedTimeWindowMpiInterface::ReceiveMessages();
@@ -424,6 +426,11 @@ DistributedSimulatorImpl::Run()
                     m_grantedTime = smallestTime + m_lookAhead;
                 }
             }
+
+            auto blocked = std::chrono::steady_clock::now() - blockedStart;
+            GrantedTimeWindowMpiInterface::g_stats.blockedTime +=
+                NanoSeconds(std::chrono::duration_cast<std::chrono::nanoseconds>(blocked).count());
+            GrantedTimeWindowMpiInterface::g_stats.blockedCount++;
         }
 
         // Execute next event if it is within the current time window.
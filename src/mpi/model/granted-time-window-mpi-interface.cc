@@ -73,6 +73,7 @@ bool GrantedTimeWindowMpiInterface::g_enabled = false;
 bool GrantedTimeWindowMpiInterface::g_mpiInitCalled = false;
 uint32_t GrantedTimeWindowMpiInterface::g_rxCount = 0;
 uint32_t GrantedTimeWindowMpiInterface::g_txCount = 0;
+MpiSynchronizationStats GrantedTimeWindowMpiInterface::g_stats;
 std::list<SentBuffer> GrantedTimeWindowMpiInterface::g_pendingTx;
 
 MPI_Request* GrantedTimeWindowMpiInterface::g_requests;
@@ -144,6 +145,12 @@ GrantedTimeWindowMpiInterface::GetCommunicator()
     return g_communicator;
 }
 
+MpiSynchronizationStats
+GrantedTimeWindowMpiInterface::GetSynchronizationStats()
+{
+    return g_stats;
+}
+
 void
 GrantedTimeWindowMpiInterface::Enable(int* pargc, char*** pargv)
 {
@@ -179,6 +186,7 @@ GrantedTimeWindowMpiInterface::Enable(MPI_Comm communicator)
     MPI_Comm_size(g_communicator, &mpiSize);
     g_sid = mpiSystemId;
     g_size = mpiSize;
+    g_stats = MpiSynchronizationStats();
 
     g_enabled = true;
     // Post a non-blocking receive for all peers
@@ -234,6 +242,8 @@ GrantedTimeWindowMpiInterface::SendPacket(Ptr<Packet> p,
               g_communicator,
               (i->GetRequest()));
     g_txCount++;
+    g_stats.packetsSent++;
+    g_stats.messagesSent++;
 }
 
 void
@@ -256,6 +266,8 @@ GrantedTimeWindowMpiInterface::ReceiveMessages()
         int count;
         MPI_Get_count(&status, MPI_CHAR, &count);
         g_rxCount++; // Count this receive
+        g_stats.packetsReceived++;
+        g_stats.messagesReceived++;
 
         // Get the meta data first
         auto pTime = reinterpret_cast<uint64_t*>(g_pRxBuffers[index]);
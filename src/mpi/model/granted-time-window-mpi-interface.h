@@ -97,6 +97,7 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
     void Disable() override;
     void SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev) override;
     MPI_Comm GetCommunicator() override;
+    MpiSynchronizationStats GetSynchronizationStats() override;
 
   private:
     /*
@@ -135,6 +136,9 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
     /** Total packets sent. */
     static uint32_t g_txCount;
 
+    /** Synchronization statistics. */
+    static MpiSynchronizationStats g_stats;
+
     /** Has this interface been enabled. */
     static bool g_enabled;
 
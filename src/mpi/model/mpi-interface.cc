@@ -138,6 +138,13 @@ MpiInterface::GetCommunicator()
     return g_parallelCommunicationInterface->GetCommunicator();
 }
 
+MpiSynchronizationStats
+MpiInterface::GetSynchronizationStats()
+{
+    NS_ASSERT(g_parallelCommunicationInterface);
+    return g_parallelCommunicationInterface->GetSynchronizationStats();
+}
+
 void
 MpiInterface::Disable()
 {
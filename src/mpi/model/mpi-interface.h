@@ -15,6 +15,8 @@
 #ifndef NS3_MPI_INTERFACE_H
 #define NS3_MPI_INTERFACE_H
 
+#include "parallel-communication-interface.h"
+
 #include <ns3/nstime.h>
 #include <ns3/packet.h>
 
@@ -32,8 +34,6 @@ namespace ns3
  * @defgroup mpi-tests MPI Distributed Simulation tests
  */
 
-class ParallelCommunicationInterface;
-
 /**
  * @ingroup mpi
  *
@@ -144,6 +144,17 @@ class MpiInterface
      */
     static MPI_Comm GetCommunicator();
 
+    /**
+     * @brief Get the synchronization statistics of this rank.
+     *
+     * The statistics cover the whole simulation run so far: the
+     * wall-clock time spent blocked waiting for the other ranks and the
+     * number of packets and messages exchanged with them.
+     *
+     * @return The synchronization statistics.
+     */
+    static MpiSynchronizationStats GetSynchronizationStats();
+
   private:
     /**
      * Common enable logic.
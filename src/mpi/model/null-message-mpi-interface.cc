@@ -20,6 +20,7 @@
 #include "remote-channel-bundle-manager.h"
 #include "remote-channel-bundle.h"
 
+#include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/node-list.h"
@@ -27,6 +28,7 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <list>
@@ -57,9 +59,13 @@ class NullMessageSentBuffer
      */
     uint8_t* GetBuffer();
     /**
-     * @param buffer pointer to sent buffer
+     * @return size of the sent buffer
      */
-    void SetBuffer(uint8_t* buffer);
+    uint32_t GetSize() const;
+    /**
+     * @param buffer the message to send; its content is moved to this buffer
+     */
+    void SetBuffer(std::vector<uint8_t>& buffer);
     /**
      * @return MPI request
      */
@@ -69,7 +75,7 @@ class NullMessageSentBuffer
     /**
      * Buffer for send.
      */
-    uint8_t* m_buffer;
+    std::vector<uint8_t> m_buffer;
 
     /**
      * MPI request posted for the send.
@@ -81,29 +87,85 @@ class NullMessageSentBuffer
  * maximum MPI message size for easy
  * buffer creation
  */
-const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
+const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 65536;
+
+/**
+ * Size of the message header: the guarantee time and the number of
+ * packets in the message.
+ */
+const uint32_t NULL_MESSAGE_HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t);
+
+/**
+ * Size of the header of each packet in a message: the receive time,
+ * the destination node and device, and the packet size.
+ */
+const uint32_t NULL_MESSAGE_PACKET_HEADER_SIZE = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+
+namespace
+{
+
+/**
+ * @ingroup mpi
+ * Append a value to a message.
+ *
+ * @tparam T \deduced The value type.
+ * @param [in,out] buffer The message.
+ * @param [in] value The value.
+ */
+template <typename T>
+void
+Append(std::vector<uint8_t>& buffer, T value)
+{
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(T));
+    std::memcpy(&buffer[offset], &value, sizeof(T));
+}
+
+/**
+ * @ingroup mpi
+ * Read a value from a message.
+ *
+ * @tparam T The value type.
+ * @param [in,out] data The position in the message, moved past the value.
+ * @return The value.
+ */
+template <typename T>
+T
+Read(const uint8_t*& data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+} // namespace
 
 NullMessageSentBuffer::NullMessageSentBuffer()
 {
-    m_buffer = nullptr;
     m_request = MPI_REQUEST_NULL;
 }
 
 NullMessageSentBuffer::~NullMessageSentBuffer()
 {
-    delete[] m_buffer;
 }
 
 uint8_t*
 NullMessageSentBuffer::GetBuffer()
 {
-    return m_buffer;
+    return m_buffer.data();
+}
+
+uint32_t
+NullMessageSentBuffer::GetSize() const
+{
+    return m_buffer.size();
 }
 
 void
-NullMessageSentBuffer::SetBuffer(uint8_t* buffer)
+NullMessageSentBuffer::SetBuffer(std::vector<uint8_t>& buffer)
 {
-    m_buffer = buffer;
+    m_buffer.swap(buffer);
 }
 
 MPI_Request*
@@ -119,6 +181,8 @@ bool NullMessageMpiInterface::g_enabled = false;
 bool NullMessageMpiInterface::g_mpiInitCalled = false;
 
 std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
+std::unordered_map<uint32_t, std::vector<uint8_t>> NullMessageMpiInterface::g_txBatches;
+MpiSynchronizationStats NullMessageMpiInterface::g_stats;
 
 MPI_Comm NullMessageMpiInterface::g_communicator = MPI_COMM_WORLD;
 bool NullMessageMpiInterface::g_freeCommunicator = false;
@@ -170,6 +234,12 @@ NullMessageMpiInterface::GetCommunicator()
     return g_communicator;
 }
 
+MpiSynchronizationStats
+NullMessageMpiInterface::GetSynchronizationStats()
+{
+    return g_stats;
+}
+
 bool
 NullMessageMpiInterface::IsEnabled()
 {
@@ -210,6 +280,7 @@ NullMessageMpiInterface::Enable(MPI_Comm communicator)
 
     g_sid = mpiSystemId;
     g_size = mpiSize;
+    g_stats = MpiSynchronizationStats();
 
     g_enabled = true;
 
@@ -233,6 +304,7 @@ NullMessageMpiInterface::InitializeSendReceiveBuffers()
         Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(rank);
         if (bundle)
         {
+            g_txBatches[rank].resize(NULL_MESSAGE_HEADER_SIZE);
             g_pRxBuffers[index] = new char[NULL_MESSAGE_MAX_MPI_MSG_SIZE];
             MPI_Irecv(g_pRxBuffers[index],
                       NULL_MESSAGE_MAX_MPI_MSG_SIZE,
@@ -256,74 +328,113 @@ NullMessageMpiInterface::SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t
     // Find the system id for the destination node
     Ptr<Node> destNode = NodeList::GetNode(node);
     uint32_t nodeSysId = destNode->GetSystemId();
-
-    NullMessageSentBuffer sendBuf;
-    g_pendingTx.push_back(sendBuf);
-    auto iter = g_pendingTx.rbegin(); // Points to the last element
+    Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(nodeSysId);
+    NS_ASSERT(bundle);
+    NS_ABORT_MSG_IF(rxTime < bundle->GetSentGuaranteeTime(),
+                    "Packet to rank " << nodeSysId << " received at " << rxTime.As(Time::S)
+                                      << ", before the guarantee time "
+                                      << bundle->GetSentGuaranteeTime().As(Time::S)
+                                      << "; did a channel delay decrease?");
 
     uint32_t serializedSize = p->GetSerializedSize();
-    uint32_t bufferSize = serializedSize + (2 * sizeof(uint64_t)) + (2 * sizeof(uint32_t));
-    auto buffer = new uint8_t[bufferSize];
-    iter->SetBuffer(buffer);
-    // Add the time, dest node and dest device
-    uint64_t t = rxTime.GetInteger();
-    auto pTime = reinterpret_cast<uint64_t*>(buffer);
-    *pTime++ = t;
-
-    Time guarantee_update =
-        NullMessageSimulatorImpl::GetInstance()->CalculateGuaranteeTime(nodeSysId);
-    *pTime++ = guarantee_update.GetTimeStep();
-
-    auto pData = reinterpret_cast<uint32_t*>(pTime);
-    *pData++ = node;
-    *pData++ = dev;
-    // Serialize the packet
-    p->Serialize(reinterpret_cast<uint8_t*>(pData), serializedSize);
+    uint32_t recordSize = NULL_MESSAGE_PACKET_HEADER_SIZE + serializedSize;
+    NS_ABORT_MSG_IF(NULL_MESSAGE_HEADER_SIZE + recordSize > NULL_MESSAGE_MAX_MPI_MSG_SIZE,
+                    "Packet of " << serializedSize << " bytes too large for an MPI message");
 
-    MPI_Isend(reinterpret_cast<void*>(iter->GetBuffer()),
-              bufferSize,
-              MPI_CHAR,
-              nodeSysId,
-              0,
-              g_communicator,
-              (iter->GetRequest()));
+    std::vector<uint8_t>& batch = g_txBatches[nodeSysId];
+    if (batch.size() + recordSize > NULL_MESSAGE_MAX_MPI_MSG_SIZE)
+    {
+        // The current event may still send packets at this time
+        SendBatch(Simulator::Now() + bundle->GetDelay(), bundle);
+    }
 
-    NullMessageSimulatorImpl::GetInstance()->RescheduleNullMessageEvent(nodeSysId);
+    // Add the time, dest node, dest device and size
+    Append<uint64_t>(batch, rxTime.GetInteger());
+    Append<uint32_t>(batch, node);
+    Append<uint32_t>(batch, dev);
+    Append<uint32_t>(batch, serializedSize);
+    // Serialize the packet
+    std::size_t offset = batch.size();
+    batch.resize(offset + serializedSize);
+    p->Serialize(&batch[offset], serializedSize);
+
+    uint32_t nPackets;
+    std::memcpy(&nPackets, &batch[sizeof(uint64_t)], sizeof(nPackets));
+    nPackets++;
+    std::memcpy(&batch[sizeof(uint64_t)], &nPackets, sizeof(nPackets));
+    g_stats.packetsSent++;
+
+    NullMessageSimulatorImpl* impl = NullMessageSimulatorImpl::GetInstance();
+    if (nPackets >= impl->m_maxBatchPackets)
+    {
+        SendBatch(Simulator::Now() + bundle->GetDelay(), bundle);
+        impl->RescheduleNullMessageEvent(bundle);
+    }
 }
 
 void
-NullMessageMpiInterface::SendNullMessage(const Time& guarantee_update,
-                                         Ptr<RemoteChannelBundle> bundle)
+NullMessageMpiInterface::SendBatch(const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle)
 {
     NS_LOG_FUNCTION(guarantee_update.GetTimeStep() << bundle);
 
     NS_ASSERT(g_enabled);
 
-    NullMessageSentBuffer sendBuf;
-    g_pendingTx.push_back(sendBuf);
-    auto iter = g_pendingTx.rbegin(); // Points to the last element
-
-    uint32_t bufferSize = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
-    auto buffer = new uint8_t[bufferSize];
-    iter->SetBuffer(buffer);
-    // Add the time, dest node and dest device
-    auto pTime = reinterpret_cast<uint64_t*>(buffer);
-    *pTime++ = 0;
-    *pTime++ = guarantee_update.GetInteger();
-    auto pData = reinterpret_cast<uint32_t*>(pTime);
-    *pData++ = 0;
-    *pData++ = 0;
-
     // Find the system id for the destination MPI rank
     uint32_t nodeSysId = bundle->GetSystemId();
 
-    MPI_Isend(reinterpret_cast<void*>(iter->GetBuffer()),
-              bufferSize,
+    std::vector<uint8_t>& batch = g_txBatches[nodeSysId];
+    NS_ASSERT(batch.size() >= NULL_MESSAGE_HEADER_SIZE);
+    uint32_t nPackets;
+    std::memcpy(&nPackets, &batch[sizeof(uint64_t)], sizeof(nPackets));
+    uint64_t guarantee = guarantee_update.GetInteger();
+    std::memcpy(&batch[0], &guarantee, sizeof(guarantee));
+
+    g_pendingTx.emplace_back();
+    NullMessageSentBuffer& sendBuf = g_pendingTx.back();
+    sendBuf.SetBuffer(batch);
+
+    MPI_Isend(reinterpret_cast<void*>(sendBuf.GetBuffer()),
+              sendBuf.GetSize(),
               MPI_CHAR,
               nodeSysId,
               0,
               g_communicator,
-              (iter->GetRequest()));
+              sendBuf.GetRequest());
+
+    // Start the next batch
+    batch.clear();
+    batch.resize(NULL_MESSAGE_HEADER_SIZE);
+
+    bundle->SetSentGuaranteeTime(guarantee_update);
+    g_stats.messagesSent++;
+    if (nPackets == 0)
+    {
+        g_stats.nullMessagesSent++;
+    }
+}
+
+void
+NullMessageMpiInterface::FlushBatches()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    NullMessageSimulatorImpl* impl = NullMessageSimulatorImpl::GetInstance();
+    for (const auto& [rank, batch] : g_txBatches)
+    {
+        if (batch.size() > NULL_MESSAGE_HEADER_SIZE)
+        {
+            Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(rank);
+            SendBatch(impl->CalculateGuaranteeTime(rank), bundle);
+            impl->RescheduleNullMessageEvent(bundle);
+        }
+    }
+}
+
+bool
+NullMessageMpiInterface::HasBatchedPackets(uint32_t systemId)
+{
+    auto it = g_txBatches.find(systemId);
+    return it != g_txBatches.end() && it->second.size() > NULL_MESSAGE_HEADER_SIZE;
 }
 
 void
@@ -382,30 +493,29 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
             MPI_Get_count(&status, MPI_CHAR, &count);
 
             // Get the meta data first
-            auto pTime = reinterpret_cast<uint64_t*>(g_pRxBuffers[index]);
-            uint64_t time = *pTime++;
-            uint64_t guaranteeUpdate = *pTime++;
-
-            auto pData = reinterpret_cast<uint32_t*>(pTime);
-            uint32_t node = *pData++;
-            uint32_t dev = *pData++;
-
-            Time rxTime(time);
+            auto data = reinterpret_cast<const uint8_t*>(g_pRxBuffers[index]);
+            NS_ASSERT(count >= static_cast<int>(NULL_MESSAGE_HEADER_SIZE));
+            auto guaranteeUpdate = Read<uint64_t>(data);
+            auto nPackets = Read<uint32_t>(data);
 
-            // rxtime == 0 means this is a Null Message
-            if (rxTime.IsStrictlyPositive())
+            // A message without packets is a Null Message
+            for (uint32_t i = 0; i < nPackets; ++i)
             {
-                count -= sizeof(time) + sizeof(guaranteeUpdate) + sizeof(node) + sizeof(dev);
+                Time rxTime(Read<uint64_t>(data));
+                auto node = Read<uint32_t>(data);
+                auto dev = Read<uint32_t>(data);
+                auto size = Read<uint32_t>(data);
 
-                Ptr<Packet> p = Create<Packet>(reinterpret_cast<uint8_t*>(pData), count, true);
+                Ptr<Packet> p = Create<Packet>(data, size, true);
+                data += size;
 
                 // Find the correct node/device to schedule receive event
                 Ptr<Node> pNode = NodeList::GetNode(node);
                 Ptr<MpiReceiver> pMpiRec = nullptr;
                 uint32_t nDevices = pNode->GetNDevices();
-                for (uint32_t i = 0; i < nDevices; ++i)
+                for (uint32_t j = 0; j < nDevices; ++j)
                 {
-                    Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
+                    Ptr<NetDevice> pThisDev = pNode->GetDevice(j);
                     if (pThisDev->GetIfIndex() == dev)
                     {
                         pMpiRec = pThisDev->GetObject<MpiReceiver>();
@@ -421,6 +531,9 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
                                                pMpiRec,
                                                p);
             }
+            NS_ASSERT(data == reinterpret_cast<const uint8_t*>(g_pRxBuffers[index]) + count);
+            g_stats.messagesReceived++;
+            g_stats.packetsReceived += nPackets;
 
             // Update guarantee time for both packet receives and Null Messages.
             Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(status.MPI_SOURCE);
@@ -494,6 +607,7 @@ NullMessageMpiInterface::Disable()
         delete[] g_requests;
 
         g_pendingTx.clear();
+        g_txBatches.clear();
 
         if (g_freeCommunicator)
         {
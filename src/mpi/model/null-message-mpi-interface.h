@@ -22,6 +22,8 @@
 
 #include <list>
 #include <mpi.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -59,6 +61,7 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
     void Disable() override;
     void SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev) override;
     MPI_Comm GetCommunicator() override;
+    MpiSynchronizationStats GetSynchronizationStats() override;
 
   private:
     /*
@@ -71,24 +74,35 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
     friend ns3::NullMessageSimulatorImpl;
 
     /**
-     * @brief Send a Null Message to across the specified bundle.
+     * @brief Send the packets batched for a bundle, together with a
+     * guarantee time update.
      *
-     * Null Messages are sent when a packet has not been sent across
-     * this bundle in order to allow time advancement on the remote
-     * MPI task.
+     * The packets sent to a remote MPI task are batched in a single
+     * message, which is only sent when the batch is full, when the
+     * Null Message event of the bundle expires, or when this task is
+     * about to block; the guarantee time update is piggy-backed on the
+     * batch.  A message carrying no packet is a Null Message: it is
+     * sent to allow time advancement on the remote MPI task.
      *
      * @param [in] guaranteeUpdate Lower bound time on the next
      * possible event from this MPI task to the remote MPI task across
      * the bundle.  Remote task may execute events up to this time.
      *
      * @param [in] bundle The bundle of links between two ranks.
+     */
+    static void SendBatch(const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
+    /**
+     * Send the batched packets of all the bundles.  This must be
+     * called between two events.
+     */
+    static void FlushBatches();
+    /**
+     * Check whether packets are batched for a remote task.
      *
-     * @internal The Null Message MPI buffer format uses the same packet
-     * metadata format as sending a normal packet with the time,
-     * destination node, and destination device set to zero.  Using the
-     * same packet metadata simplifies receive logic.
+     * @param [in] systemId The remote system id.
+     * @return \c true if packets are waiting to be sent.
      */
-    static void SendNullMessage(const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
+    static bool HasBatchedPackets(uint32_t systemId);
     /**
      * Non-blocking check for received messages complete.  Will
      * receive all messages that are queued up locally.
@@ -150,6 +164,15 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
     /** List of pending non-blocking sends. */
     static std::list<NullMessageSentBuffer> g_pendingTx;
 
+    /**
+     * The packets batched for each remote task, after room for the
+     * message header.
+     */
+    static std::unordered_map<uint32_t, std::vector<uint8_t>> g_txBatches;
+
+    /** Synchronization statistics. */
+    static MpiSynchronizationStats g_stats;
+
     /** MPI communicator being used for ns-3 tasks. */
     static MPI_Comm g_communicator;
 
@@ -29,7 +29,9 @@
 #include <ns3/ptr.h>
 #include <ns3/scheduler.h>
 #include <ns3/simulator.h>
+#include <ns3/uinteger.h>
 
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
@@ -56,7 +58,12 @@ NullMessageSimulatorImpl::GetTypeId()
                           "Null Message scheduler tuning parameter",
                           DoubleValue(1.0),
                           MakeDoubleAccessor(&NullMessageSimulatorImpl::m_schedulerTune),
-                          MakeDoubleChecker<double>(0.01, 1.0));
+                          MakeDoubleChecker<double>(0.01, 1.0))
+            .AddAttribute("MaxBatchPackets",
+                          "Maximum number of packets sent to a remote rank in a single message",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&NullMessageSimulatorImpl::m_maxBatchPackets),
+                          MakeUintegerChecker<uint32_t>(1));
     return tid;
 }
 
@@ -277,17 +284,6 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent(Ptr<RemoteChannelBundle> bu
                                            PeekPointer(bundle)));
 }
 
-void
-NullMessageSimulatorImpl::RescheduleNullMessageEvent(uint32_t nodeSysId)
-{
-    NS_LOG_FUNCTION(this << nodeSysId);
-
-    Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(nodeSysId);
-    NS_ASSERT(bundle);
-
-    RescheduleNullMessageEvent(bundle);
-}
-
 void
 NullMessageSimulatorImpl::Run()
 {
@@ -314,6 +310,8 @@ NullMessageSimulatorImpl::Run()
             HandleArrivingMessagesBlocking();
         }
     }
+
+    NullMessageMpiInterface::FlushBatches();
 }
 
 void
@@ -334,7 +332,15 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking()
 {
     NS_LOG_FUNCTION(this);
 
+    // The remote tasks may be waiting for the batched packets
+    NullMessageMpiInterface::FlushBatches();
+
+    auto blockedStart = std::chrono::steady_clock::now();
     NullMessageMpiInterface::ReceiveMessagesBlocking();
+    auto blocked = std::chrono::steady_clock::now() - blockedStart;
+    NullMessageMpiInterface::g_stats.blockedTime +=
+        NanoSeconds(std::chrono::duration_cast<std::chrono::nanoseconds>(blocked).count());
+    NullMessageMpiInterface::g_stats.blockedCount++;
 
     CalculateSafeTime();
 
@@ -559,8 +565,19 @@ NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bundle)
 {
     NS_LOG_FUNCTION(this << bundle);
 
+    // Follow the changes of the link delays
+    bundle->UpdateDelay();
+
     Time time = Min(Next(), GetSafeTime()) + bundle->GetDelay();
-    NullMessageMpiInterface::SendNullMessage(time, bundle);
+    if (NullMessageMpiInterface::HasBatchedPackets(bundle->GetSystemId()) ||
+        time > bundle->GetSentGuaranteeTime())
+    {
+        NullMessageMpiInterface::SendBatch(time, bundle);
+    }
+    else
+    {
+        NullMessageMpiInterface::g_stats.nullMessagesSkipped++;
+    }
 
     ScheduleNullMessageEvent(bundle);
 }
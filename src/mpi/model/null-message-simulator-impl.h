@@ -141,14 +141,6 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      */
     void RescheduleNullMessageEvent(Ptr<RemoteChannelBundle> bundle);
 
-    /**
-     * @param nodeSysId SystemID to reschedule null event for
-     *
-     * Reschedule Null Message event for the RemoteChannelBundle to the
-     * task nodeSysId.  Existing event will be canceled.
-     */
-    void RescheduleNullMessageEvent(uint32_t nodeSysId);
-
     /**
      * @param systemId SystemID to compute guarantee time for
      *
@@ -164,8 +156,10 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      * @param bundle remote channel bundle to schedule an event for.
      *
      * Null message event handler.   Scheduled to send a null message
-     * for the specified bundle at regular intervals.   Will canceled
-     * and rescheduled when packets are sent.
+     * for the specified bundle at regular intervals, together with the
+     * packets batched for the bundle.   Will canceled and rescheduled
+     * when packets are sent.  The null message is skipped if it would
+     * not advance the guarantee time of the remote task.
      */
     void NullMessageEventHandler(RemoteChannelBundle* bundle);
 
@@ -216,6 +210,13 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      */
     double m_schedulerTune;
 
+    /**
+     * Maximum number of packets sent to a remote task in a single
+     * message.  The packets are batched until the batch is full, the
+     * Null Message event of the bundle expires, or this task blocks.
+     */
+    uint32_t m_maxBatchPackets;
+
     /** Singleton instance. */
     static NullMessageSimulatorImpl* g_instance;
 };
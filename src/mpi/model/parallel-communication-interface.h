@@ -10,7 +10,8 @@
 /**
  * @file
  * @ingroup mpi
- * Declaration of class ns3::ParallelCommunicationInterface.
+ * Declaration of class ns3::ParallelCommunicationInterface and
+ * struct ns3::MpiSynchronizationStats.
  */
 
 #ifndef NS3_PARALLEL_COMMUNICATION_INTERFACE_H
@@ -28,6 +29,27 @@
 namespace ns3
 {
 
+/**
+ * @ingroup mpi
+ *
+ * @brief Synchronization statistics of a rank.
+ *
+ * The time a rank spends blocked waiting for the other ranks is the
+ * overhead of the parallel simulation; the message counters show how
+ * much of the traffic between the ranks only carries time updates.
+ */
+struct MpiSynchronizationStats
+{
+    Time blockedTime;                /**< Wall-clock time spent waiting for the other ranks. */
+    uint64_t blockedCount{0};        /**< Number of times the rank waited. */
+    uint64_t packetsSent{0};         /**< Number of packets sent to other ranks. */
+    uint64_t packetsReceived{0};     /**< Number of packets received from other ranks. */
+    uint64_t messagesSent{0};        /**< Number of MPI messages sent. */
+    uint64_t messagesReceived{0};    /**< Number of MPI messages received. */
+    uint64_t nullMessagesSent{0};    /**< Number of messages sent carrying no packet. */
+    uint64_t nullMessagesSkipped{0}; /**< Number of null messages not sent as redundant. */
+};
+
 /**
  * @ingroup mpi
  *
@@ -90,6 +112,10 @@ class ParallelCommunicationInterface
      * @copydoc MpiInterface::GetCommunicator
      */
     virtual MPI_Comm GetCommunicator() = 0;
+    /**
+     * @copydoc MpiInterface::GetSynchronizationStats
+     */
+    virtual MpiSynchronizationStats GetSynchronizationStats() = 0;
 
   private:
 };
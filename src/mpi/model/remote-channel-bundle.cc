@@ -36,6 +36,7 @@ RemoteChannelBundle::GetTypeId()
 RemoteChannelBundle::RemoteChannelBundle()
     : m_remoteSystemId(UINT32_MAX),
       m_guaranteeTime(0),
+      m_sentGuaranteeTime(0),
       m_delay(Time::Max())
 {
 }
@@ -43,6 +44,7 @@ RemoteChannelBundle::RemoteChannelBundle()
 RemoteChannelBundle::RemoteChannelBundle(const uint32_t remoteSystemId)
     : m_remoteSystemId(remoteSystemId),
       m_guaranteeTime(0),
+      m_sentGuaranteeTime(0),
       m_delay(Time::Max())
 {
 }
@@ -74,12 +76,37 @@ RemoteChannelBundle::SetGuaranteeTime(Time time)
     m_guaranteeTime = time;
 }
 
+Time
+RemoteChannelBundle::GetSentGuaranteeTime() const
+{
+    return m_sentGuaranteeTime;
+}
+
+void
+RemoteChannelBundle::SetSentGuaranteeTime(Time time)
+{
+    m_sentGuaranteeTime = time;
+}
+
 Time
 RemoteChannelBundle::GetDelay() const
 {
     return m_delay;
 }
 
+void
+RemoteChannelBundle::UpdateDelay()
+{
+    Time delay = Time::Max();
+    for (const auto& element : m_channels)
+    {
+        TimeValue value;
+        element.second->GetAttribute("Delay", value);
+        delay = ns3::Min(delay, value.Get());
+    }
+    m_delay = delay;
+}
+
 void
 RemoteChannelBundle::SetEventId(EventId id)
 {
@@ -101,7 +128,7 @@ RemoteChannelBundle::GetSize() const
 void
 RemoteChannelBundle::Send(Time time)
 {
-    NullMessageMpiInterface::SendNullMessage(time, this);
+    NullMessageMpiInterface::SendBatch(time, this);
 }
 
 std::ostream&
@@ -87,12 +87,33 @@ class RemoteChannelBundle : public Object
      */
     void SetGuaranteeTime(Time time);
 
+    /**
+     * Get the guarantee time last sent to the remote task.  No packet
+     * may be sent across this bundle with a receive time less than this.
+     * @return The guarantee time last sent.
+     */
+    Time GetSentGuaranteeTime() const;
+
+    /**
+     * Set the guarantee time sent to the remote task.  This should be
+     * called after a packet batch or Null Message is sent.
+     *
+     * @param time The guarantee time.
+     */
+    void SetSentGuaranteeTime(Time time);
+
     /**
      * Get the minimum delay along any channel in this bundle
      * @return The minimum delay.
      */
     Time GetDelay() const;
 
+    /**
+     * Update the minimum delay from the current delays of the channels,
+     * so that the lookahead follows the changes of the link delays.
+     */
+    void UpdateDelay();
+
     /**
      * Set the event ID of the Null Message send event currently scheduled
      * for this channel.
@@ -114,11 +135,10 @@ class RemoteChannelBundle : public Object
     std::size_t GetSize() const;
 
     /**
-     * Send Null Message to the remote task associated with this bundle.
-     * Message will be delivered at current simulation time + the time
-     * passed in.
+     * Send Null Message to the remote task associated with this bundle,
+     * together with any batched packet.
      *
-     * @param time The delay from now when the null message should be received.
+     * @param time The guarantee time sent to the remote task.
      */
     void Send(Time time);
 
@@ -150,6 +170,12 @@ class RemoteChannelBundle : public Object
      */
     Time m_guaranteeTime;
 
+    /**
+     * Guarantee time last sent to MPI task remote_rank across the
+     * outgoing Channels.
+     */
+    Time m_sentGuaranteeTime;
+
     /**
      * Delay for this Channel bundle, which is
      * the min link delay over all incoming channels;
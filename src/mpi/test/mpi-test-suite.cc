@@ -142,6 +142,11 @@ static MpiTestSuite g_mpiSimple2("mpi-example-simple-2",
                                  "simple-distributed",
                                  NS_TEST_SOURCEDIR,
                                  2);
+static MpiTestSuite g_mpiSimple2Partition("mpi-example-simple-2-partition",
+                                          "simple-distributed",
+                                          NS_TEST_SOURCEDIR,
+                                          2,
+                                          "--partition");
 static MpiTestSuite g_mpiThird2("mpi-example-third-2", "third-distributed", NS_TEST_SOURCEDIR, 2);
 
 /* Tests using NullMessageSimulatorImpl */
@@ -0,0 +1,366 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/**
+ * @file
+ * @ingroup mtp
+ * Implementation of class ns3::LogicalProcess.
+ */
+
+#include "logical-process.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/event-impl.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LogicalProcess");
+
+LogicalProcess::LogicalProcess(uint32_t id, Ptr<Scheduler> events)
+    : m_id(id),
+      m_events(events),
+      m_currentUid(EventId::UID::INVALID),
+      m_currentTs(0),
+      m_currentContext(0xffffffff),
+      m_eventCount(0),
+      m_packetUid(0),
+      m_windowEnd{0, 0, 0},
+      m_calls(0),
+      m_currentLogged(false)
+{
+    NS_LOG_FUNCTION(this << id);
+}
+
+LogicalProcess::~LogicalProcess()
+{
+    NS_LOG_FUNCTION(this);
+    for (const auto& ev : m_heldBack)
+    {
+        ev.event->Unref();
+    }
+    for (const auto& msg : m_mailbox)
+    {
+        msg.event->Unref();
+    }
+    while (!m_events->IsEmpty())
+    {
+        Scheduler::Event next = m_events->RemoveNext();
+        next.impl->Unref();
+    }
+    m_events = nullptr;
+}
+
+uint32_t
+LogicalProcess::GetId() const
+{
+    return m_id;
+}
+
+void
+LogicalProcess::SetScheduler(Ptr<Scheduler> events)
+{
+    NS_LOG_FUNCTION(this << events);
+    while (!m_events->IsEmpty())
+    {
+        events->Insert(m_events->RemoveNext());
+    }
+    m_events = events;
+}
+
+EventId
+LogicalProcess::Insert(uint64_t ts, uint32_t context, uint32_t uid, EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = uid;
+    m_events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+LogicalProcess::InsertEvent(const Scheduler::Event& ev)
+{
+    m_events->Insert(ev);
+}
+
+EventId
+LogicalProcess::Schedule(uint64_t ts, uint32_t context, EventImpl* event, bool tracked)
+{
+    uint32_t call = NextCall();
+    if (ts < m_windowEnd.m_ts)
+    {
+        return Insert(ts, context, PROVISIONAL_UID + call, event);
+    }
+    // The event may be preceded by events that other LPs are scheduling
+    // in this window: it can only be inserted once its uid is known.
+    m_heldBack.push_back({ts, context, call, event, tracked});
+    if (tracked)
+    {
+        m_heldBackUids[event] = HELD_BACK_UID;
+    }
+    return EventId(event, ts, context, HELD_BACK_UID);
+}
+
+void
+LogicalProcess::Send(uint64_t ts,
+                     uint32_t context,
+                     EventImpl* event,
+                     const LogicalProcess* sender,
+                     uint32_t call)
+{
+    std::unique_lock lock{m_mailboxMutex};
+    m_mailbox.push_back({ts, context, event, sender, call});
+}
+
+uint32_t
+LogicalProcess::NextCall()
+{
+    NS_ABORT_MSG_IF(m_calls == HELD_BACK_UID - PROVISIONAL_UID,
+                    "Too many events scheduled by logical process " << m_id << " in a window");
+    if (!m_currentLogged)
+    {
+        m_callers.push_back({m_currentTs, m_currentUid, m_calls, 0});
+        m_currentLogged = true;
+    }
+    return m_calls++;
+}
+
+void
+LogicalProcess::StartWindow(uint64_t endTs, uint32_t endUid)
+{
+    m_windowEnd.m_ts = endTs;
+    m_windowEnd.m_uid = endUid;
+    m_calls = 0;
+    m_callers.clear();
+}
+
+void
+LogicalProcess::ProcessWindow(SimulatorImpl* impl)
+{
+    while (!m_events->IsEmpty() && m_events->PeekNext().key < m_windowEnd)
+    {
+        ProcessOneEvent(impl);
+    }
+}
+
+uint32_t
+LogicalProcess::NumberCalls(const std::vector<std::unique_ptr<LogicalProcess>>& lps,
+                            uint32_t firstUid)
+{
+    // The LPs ran their events in the order of the sequential run, so
+    // merging their callers by key gives the order of all the calls.
+    // The uid of a caller scheduled in the window is provisional, but
+    // the caller which scheduled it comes first in the same LP, so it
+    // is resolved before the two are compared.
+    typedef std::tuple<uint64_t, uint32_t, std::size_t, std::size_t> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<>> heads;
+    auto push = [&heads, &lps](std::size_t lp, std::size_t i) {
+        const Caller& caller = lps[lp]->m_callers[i];
+        uint32_t uid = caller.uid < PROVISIONAL_UID
+                           ? caller.uid
+                           : lps[lp]->ResolveCall(caller.uid - PROVISIONAL_UID);
+        heads.emplace(caller.ts, uid, lp, i);
+    };
+    for (std::size_t lp = 0; lp < lps.size(); ++lp)
+    {
+        if (!lps[lp]->m_callers.empty())
+        {
+            push(lp, 0);
+        }
+    }
+
+    uint64_t uid = firstUid;
+    while (!heads.empty())
+    {
+        auto [ts, callerUid, lp, i] = heads.top();
+        heads.pop();
+        auto& callers = lps[lp]->m_callers;
+        uint32_t nextCall = i + 1 < callers.size() ? callers[i + 1].firstCall : lps[lp]->m_calls;
+        callers[i].firstUid = uid;
+        uid += nextCall - callers[i].firstCall;
+        if (i + 1 < callers.size())
+        {
+            push(lp, i + 1);
+        }
+    }
+    NS_ABORT_MSG_IF(uid >= PROVISIONAL_UID, "Too many events scheduled in the simulation");
+    return uid;
+}
+
+uint32_t
+LogicalProcess::ResolveCall(uint32_t call) const
+{
+    auto caller = std::upper_bound(m_callers.begin(),
+                                   m_callers.end(),
+                                   call,
+                                   [](uint32_t c, const Caller& x) { return c < x.firstCall; });
+    NS_ASSERT(caller != m_callers.begin());
+    --caller;
+    return caller->firstUid + (call - caller->firstCall);
+}
+
+bool
+LogicalProcess::HasExports() const
+{
+    return !m_heldBack.empty() || !m_mailbox.empty();
+}
+
+void
+LogicalProcess::Deliver()
+{
+    for (const auto& ev : m_heldBack)
+    {
+        uint32_t uid = ResolveCall(ev.call);
+        if (ev.tracked)
+        {
+            auto it = m_heldBackUids.find(ev.event);
+            if (it == m_heldBackUids.end())
+            {
+                // removed before the end of the window
+                ev.event->Unref();
+                continue;
+            }
+            it->second = uid;
+        }
+        Insert(ev.ts, ev.context, uid, ev.event);
+    }
+    m_heldBack.clear();
+
+    std::vector<Message> mailbox;
+    {
+        std::unique_lock lock{m_mailboxMutex};
+        m_mailbox.swap(mailbox);
+    }
+    for (const auto& msg : mailbox)
+    {
+        Insert(msg.ts, msg.context, msg.sender->ResolveCall(msg.call), msg.event);
+    }
+}
+
+bool
+LogicalProcess::IsEmpty() const
+{
+    return m_events->IsEmpty();
+}
+
+Scheduler::EventKey
+LogicalProcess::NextKey() const
+{
+    if (m_events->IsEmpty())
+    {
+        return {static_cast<uint64_t>(std::numeric_limits<int64_t>::max()), 0, 0};
+    }
+    return m_events->PeekNext().key;
+}
+
+void
+LogicalProcess::ProcessOneEvent(SimulatorImpl* impl)
+{
+    Scheduler::Event next = m_events->RemoveNext();
+
+    impl->PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= m_currentTs);
+    m_eventCount++;
+
+    m_currentTs = next.key.m_ts;
+    m_currentContext = next.key.m_context;
+    m_currentUid = next.key.m_uid;
+    m_currentLogged = false;
+    if (!m_heldBackUids.empty() && next.key.m_uid < PROVISIONAL_UID)
+    {
+        m_heldBackUids.erase(next.impl);
+    }
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+Scheduler::Event
+LogicalProcess::RemoveNext()
+{
+    return m_events->RemoveNext();
+}
+
+void
+LogicalProcess::Remove(const EventId& id)
+{
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    if (id.GetUid() == HELD_BACK_UID)
+    {
+        auto it = m_heldBackUids.find(event.impl);
+        NS_ASSERT(it != m_heldBackUids.end());
+        event.key.m_uid = it->second;
+        m_heldBackUids.erase(it);
+        if (event.key.m_uid == HELD_BACK_UID)
+        {
+            // not inserted yet: Deliver() releases it
+            event.impl->Cancel();
+            return;
+        }
+    }
+    m_events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+}
+
+bool
+LogicalProcess::IsExpired(const EventId& id) const
+{
+    if (id.PeekEventImpl() != nullptr && id.GetUid() == HELD_BACK_UID)
+    {
+        return m_heldBackUids.find(id.PeekEventImpl()) == m_heldBackUids.end() ||
+               id.PeekEventImpl()->IsCancelled();
+    }
+    return id.PeekEventImpl() == nullptr || id.GetTs() < m_currentTs ||
+           (id.GetTs() == m_currentTs && id.GetUid() <= m_currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+uint64_t
+LogicalProcess::GetCurrentTs() const
+{
+    return m_currentTs;
+}
+
+void
+LogicalProcess::SetCurrentTs(uint64_t ts)
+{
+    m_currentTs = ts;
+}
+
+uint32_t
+LogicalProcess::GetContext() const
+{
+    return m_currentContext;
+}
+
+uint64_t
+LogicalProcess::GetEventCount() const
+{
+    return m_eventCount;
+}
+
+uint32_t*
+LogicalProcess::GetPacketUidCounter()
+{
+    return &m_packetUid;
+}
+
+} // namespace ns3
@@ -0,0 +1,323 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/**
+ * @file
+ * @ingroup mtp
+ * Declaration of class ns3::LogicalProcess.
+ */
+
+#ifndef NS3_LOGICAL_PROCESS_H
+#define NS3_LOGICAL_PROCESS_H
+
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator-impl.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * @ingroup mtp
+ *
+ * @brief A partition of the simulation owning its own event queue.
+ *
+ * A logical process (LP) holds the events of a set of nodes that are
+ * connected by channels without usable lookahead.  Within a time window
+ * granted by the MultithreadedSimulatorImpl each LP runs independently
+ * of the others, so different LPs can be executed by different threads.
+ *
+ * The events are ordered by timestamp and uid, and the uids must
+ * follow the order in which the events would have been scheduled by
+ * the DefaultSimulatorImpl, i.e., the order of the events scheduling
+ * them, and the order of the calls made by each of these events.  The
+ * LPs cannot know this order while they run in parallel, so the events
+ * scheduled within a window are numbered in two steps:
+ *
+ * - each call is given a provisional number, local to the LP, and the
+ *   events which made calls are logged; the events which will run in
+ *   the same window get a provisional uid, which orders them after the
+ *   events scheduled before the window and among themselves;
+ * - the other events, which are not inserted in the event queue but
+ *   held back, and the events posted by other LPs with Send(), get
+ *   their uid when the window is over: NumberCalls() merges the logs
+ *   of all the LPs in the order of the sequential run, and Deliver()
+ *   inserts the events with the uid resolved by ResolveCall().
+ *
+ * The EventId of a held back event carries a placeholder uid; the uid
+ * of the event in the queue is kept aside until the event has run or
+ * has been removed.
+ */
+class LogicalProcess
+{
+  public:
+    /**
+     * The first provisional uid, given to the events which are
+     * scheduled and run within the same window.  The uids of the
+     * events scheduled between the windows, or numbered at the end of
+     * a window, are lower.
+     */
+    static constexpr uint32_t PROVISIONAL_UID = 0xe0000000;
+    /** The placeholder uid of the events which are held back. */
+    static constexpr uint32_t HELD_BACK_UID = 0xf0000000;
+
+    /**
+     * Constructor.
+     *
+     * @param [in] id The LP identifier; 0 is reserved for the global LP.
+     * @param [in] events The event queue of this LP.
+     */
+    LogicalProcess(uint32_t id, Ptr<Scheduler> events);
+    /** Destructor, discards the pending events. */
+    ~LogicalProcess();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    LogicalProcess(const LogicalProcess&) = delete;
+    LogicalProcess& operator=(const LogicalProcess&) = delete;
+
+    /** @return The LP identifier. */
+    uint32_t GetId() const;
+
+    /**
+     * Replace the event queue, moving the pending events to the new one.
+     *
+     * @param [in] events The new event queue.
+     */
+    void SetScheduler(Ptr<Scheduler> events);
+
+    /**
+     * Insert an event with its final uid in the local event queue.
+     *
+     * Must only be called while no LP is running.
+     *
+     * @param [in] ts The absolute event timestamp.
+     * @param [in] context The event context.
+     * @param [in] uid The event uid.
+     * @param [in] event The event implementation.
+     * @return The id of the scheduled event.
+     */
+    EventId Insert(uint64_t ts, uint32_t context, uint32_t uid, EventImpl* event);
+
+    /**
+     * Insert an event keeping its original key.
+     *
+     * Used to move events between LPs when the partition is built.
+     *
+     * @param [in] ev The event.
+     */
+    void InsertEvent(const Scheduler::Event& ev);
+
+    /**
+     * Schedule a local event from the event currently run by this LP.
+     *
+     * Must only be called by the thread running this LP within a window.
+     *
+     * @param [in] ts The absolute event timestamp.
+     * @param [in] context The event context.
+     * @param [in] event The event implementation.
+     * @param [in] tracked Whether the returned EventId can be used by the
+     *             caller, to Remove() the event or check if it expired.
+     * @return The id of the scheduled event.
+     */
+    EventId Schedule(uint64_t ts, uint32_t context, EventImpl* event, bool tracked);
+
+    /**
+     * Post an event scheduled by another LP.  Thread-safe.
+     *
+     * @param [in] ts The absolute event timestamp.
+     * @param [in] context The event context.
+     * @param [in] event The event implementation.
+     * @param [in] sender The sending LP.
+     * @param [in] call The provisional number of the call at the sender,
+     *             as returned by NextCall().
+     */
+    void Send(uint64_t ts,
+              uint32_t context,
+              EventImpl* event,
+              const LogicalProcess* sender,
+              uint32_t call);
+
+    /**
+     * Give a provisional number to a call made by the current event.
+     *
+     * Must only be called by the thread running this LP within a window.
+     *
+     * @return The number of the call, local to this LP and to the window.
+     */
+    uint32_t NextCall();
+
+    /**
+     * Prepare this LP to run a window.
+     *
+     * The events with a key lower than (\p endTs, \p endUid) are run
+     * by ProcessWindow(); the events scheduled for \p endTs or later
+     * are held back.
+     *
+     * @param [in] endTs The end timestamp of the window.
+     * @param [in] endUid The uid of the first event not to run at \p endTs.
+     */
+    void StartWindow(uint64_t endTs, uint32_t endUid);
+
+    /**
+     * Run the events of the current window.
+     *
+     * @param [in] impl The simulator implementation whose
+     *             SimulatorImpl::PreEventHook() is called.
+     */
+    void ProcessWindow(SimulatorImpl* impl);
+
+    /**
+     * Assign the final uids to the calls made by the LPs in the window,
+     * in the order of the sequential run.
+     *
+     * @param [in] lps The LPs which ran the window.
+     * @param [in] firstUid The first uid to assign.
+     * @return The uid following the last one assigned.
+     */
+    static uint32_t NumberCalls(const std::vector<std::unique_ptr<LogicalProcess>>& lps,
+                                uint32_t firstUid);
+
+    /**
+     * Get the final uid of a call made in the last window.
+     *
+     * Only valid after NumberCalls() and until the next StartWindow().
+     *
+     * @param [in] call The provisional number of the call.
+     * @return The uid assigned to the call.
+     */
+    uint32_t ResolveCall(uint32_t call) const;
+
+    /**
+     * @return \c true if events were held back by this LP, or posted to it,
+     * in the last window.
+     */
+    bool HasExports() const;
+
+    /**
+     * Insert the events held back and the events posted by the other
+     * LPs in the event queue, with their final uid.
+     *
+     * Only valid after NumberCalls() on all the senders.
+     */
+    void Deliver();
+
+    /** @return \c true if the event queue is empty. */
+    bool IsEmpty() const;
+    /**
+     * @return The key of the next event, with the maximum timestep if
+     * the event queue is empty.
+     */
+    Scheduler::EventKey NextKey() const;
+
+    /**
+     * Remove and invoke the next event, updating the current time.
+     *
+     * @param [in] impl The simulator implementation whose
+     *             SimulatorImpl::PreEventHook() is called.
+     */
+    void ProcessOneEvent(SimulatorImpl* impl);
+
+    /**
+     * Remove and extract the next event, without invoking it.
+     *
+     * @return The next event; the caller takes the reference.
+     */
+    Scheduler::Event RemoveNext();
+
+    /**
+     * Remove an event from the event queue.
+     *
+     * @param [in] id The event to remove.
+     */
+    void Remove(const EventId& id);
+
+    /**
+     * Check whether an event owned by this LP has expired.
+     *
+     * @param [in] id The event to check.
+     * @return \c true if the event has run or was cancelled.
+     */
+    bool IsExpired(const EventId& id) const;
+
+    /** @return The timestamp of the current event. */
+    uint64_t GetCurrentTs() const;
+    /**
+     * Set the current time of this LP.
+     *
+     * @param [in] ts The new current timestamp.
+     */
+    void SetCurrentTs(uint64_t ts);
+    /** @return The context of the current event. */
+    uint32_t GetContext() const;
+    /** @return The number of events processed by this LP. */
+    uint64_t GetEventCount() const;
+    /**
+     * @return The counter of the uids of the packets created by the
+     * events of this LP.
+     */
+    uint32_t* GetPacketUidCounter();
+
+  private:
+    /** An event posted by another LP. */
+    struct Message
+    {
+        uint64_t ts;                  /**< Absolute timestamp. */
+        uint32_t context;             /**< Event context. */
+        EventImpl* event;             /**< Event implementation. */
+        const LogicalProcess* sender; /**< Sending LP. */
+        uint32_t call;                /**< Provisional call number at the sender. */
+    };
+
+    /** A local event held back until the end of the window. */
+    struct HeldBack
+    {
+        uint64_t ts;      /**< Absolute timestamp. */
+        uint32_t context; /**< Event context. */
+        uint32_t call;    /**< Provisional call number. */
+        EventImpl* event; /**< Event implementation. */
+        bool tracked;     /**< Whether an EventId was returned. */
+    };
+
+    /** An event of the window which made calls. */
+    struct Caller
+    {
+        uint64_t ts;        /**< Timestamp of the event. */
+        uint32_t uid;       /**< Uid of the event, possibly provisional. */
+        uint32_t firstCall; /**< Provisional number of its first call. */
+        uint32_t firstUid;  /**< Final uid of its first call. */
+    };
+
+    uint32_t m_id;             /**< LP identifier. */
+    Ptr<Scheduler> m_events;   /**< The event queue. */
+    uint32_t m_currentUid;     /**< Uid of the current event. */
+    uint64_t m_currentTs;      /**< Timestamp of the current event. */
+    uint32_t m_currentContext; /**< Context of the current event. */
+    uint64_t m_eventCount;     /**< Number of processed events. */
+    uint32_t m_packetUid;      /**< Next uid of the packets created by this LP. */
+
+    Scheduler::EventKey m_windowEnd;  /**< End of the current window (exclusive). */
+    uint32_t m_calls;                 /**< Calls made in the current window. */
+    bool m_currentLogged;             /**< Whether the current event is in m_callers. */
+    std::vector<Caller> m_callers;    /**< Events which made calls in the window. */
+    std::vector<HeldBack> m_heldBack; /**< Events held back in the window. */
+    /**
+     * The uid in the event queue of the held back events returned
+     * with an EventId, until they run or are removed.  Before Deliver()
+     * the uid is the placeholder one.
+     */
+    std::unordered_map<const EventImpl*, uint32_t> m_heldBackUids;
+
+    std::vector<Message> m_mailbox; /**< Events posted by other LPs. */
+    std::mutex m_mailboxMutex;      /**< Protects m_mailbox. */
+};
+
+} // namespace ns3
+
+#endif /* NS3_LOGICAL_PROCESS_H */
@@ -0,0 +1,692 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/**
+ * @file
+ * @ingroup mtp
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "logical-process.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/packet-allocator.h"
+#include "ns3/packet.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+/**
+ * @ingroup mtp
+ * The LP run by the calling thread, or \c nullptr for the global LP.
+ */
+static thread_local LogicalProcess* g_currentLp = nullptr;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("MaxThreads",
+                          "The maximum number of threads used to run the logical processes, "
+                          "including the main thread. 0 means one per hardware thread.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_maxThreads),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MinLookAhead",
+                          "Point-to-point channels whose delay is smaller than this value "
+                          "are not cut when partitioning the nodes, so that a single short "
+                          "link does not shrink the synchronization window of the whole "
+                          "simulation.",
+                          TimeValue(Time(0)),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_minLookAhead),
+                          MakeTimeChecker());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_stop = false;
+    m_uid = EventId::UID::VALID;
+    m_partitioned = false;
+    m_lookAhead = Time::Max();
+    m_windowEnd = 0;
+    m_delivering = false;
+    m_maxThreads = 0;
+    m_nextLp = 0;
+    m_doneLps = 0;
+    m_round = 0;
+    m_exitWorkers = false;
+    m_mainThreadId = std::this_thread::get_id();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_lps.clear();
+    m_globalLp.reset();
+    m_nodeLp.clear();
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+
+    m_schedulerFactory = schedulerFactory;
+    if (!m_globalLp)
+    {
+        m_globalLp = std::make_unique<LogicalProcess>(0, m_schedulerFactory.Create<Scheduler>());
+        return;
+    }
+    m_globalLp->SetScheduler(m_schedulerFactory.Create<Scheduler>());
+    for (auto& lp : m_lps)
+    {
+        lp->SetScheduler(m_schedulerFactory.Create<Scheduler>());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Partition()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Union-find over the node ids: nodes sharing a channel which cannot
+    // be cut end up in the same set.
+    uint32_t nNodes = NodeList::GetNNodes();
+    std::vector<uint32_t> parent(nNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](uint32_t n) {
+        while (parent[n] != n)
+        {
+            parent[n] = parent[parent[n]];
+            n = parent[n];
+        }
+        return n;
+    };
+
+    /// A channel that can be cut.
+    struct Link
+    {
+        uint32_t a; /**< First node id. */
+        uint32_t b; /**< Second node id. */
+        Time delay; /**< Channel delay. */
+    };
+
+    std::vector<Link> links;
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<Channel> channel = *i;
+        std::vector<uint32_t> nodes;
+        bool pointToPoint = (channel->GetNDevices() == 2);
+        for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+        {
+            Ptr<NetDevice> device = channel->GetDevice(j);
+            nodes.push_back(device->GetNode()->GetId());
+            pointToPoint &= device->IsPointToPoint();
+        }
+
+        TimeValue delay;
+        if (pointToPoint && channel->GetAttributeFailSafe("Delay", delay) &&
+            delay.Get().IsStrictlyPositive() && delay.Get() >= m_minLookAhead)
+        {
+            // Let the channel resolve the nodes of its devices now, rather
+            // than from the LPs, which must not access each other's nodes
+            channel->Initialize();
+            links.push_back({nodes[0], nodes[1], delay.Get()});
+            continue;
+        }
+        for (auto node : nodes)
+        {
+            parent[find(node)] = find(nodes.front());
+        }
+    }
+
+    m_lookAhead = Time::Max();
+    for (const auto& link : links)
+    {
+        if (find(link.a) != find(link.b))
+        {
+            m_lookAhead = Min(m_lookAhead, link.delay);
+        }
+    }
+
+    // Number the LPs by their smallest node id, so that the partition
+    // does not depend on the order of the channels.
+    std::vector<uint32_t> rootLp(nNodes, std::numeric_limits<uint32_t>::max());
+    m_nodeLp.resize(nNodes);
+    for (uint32_t n = 0; n < nNodes; ++n)
+    {
+        uint32_t root = find(n);
+        if (rootLp[root] == std::numeric_limits<uint32_t>::max())
+        {
+            rootLp[root] = m_lps.size();
+            m_lps.push_back(std::make_unique<LogicalProcess>(m_lps.size() + 1,
+                                                             m_schedulerFactory.Create<Scheduler>()));
+            m_lps.back()->SetCurrentTs(m_globalLp->GetCurrentTs());
+        }
+        m_nodeLp[n] = rootLp[root];
+    }
+    m_partitioned = true;
+
+    // Move the events scheduled so far to the LP of their context,
+    // keeping their keys so that the EventIds remain valid.
+    std::vector<Scheduler::Event> global;
+    while (!m_globalLp->IsEmpty())
+    {
+        Scheduler::Event ev = m_globalLp->RemoveNext();
+        LogicalProcess* lp = GetLogicalProcess(ev.key.m_context);
+        if (lp == m_globalLp.get())
+        {
+            global.push_back(ev);
+        }
+        else
+        {
+            lp->InsertEvent(ev);
+        }
+    }
+    for (const auto& ev : global)
+    {
+        m_globalLp->InsertEvent(ev);
+    }
+
+    NS_LOG_INFO("Split " << nNodes << " nodes into " << m_lps.size()
+                         << " logical processes, lookahead " << m_lookAhead);
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetLogicalProcess(uint32_t context) const
+{
+    if (context < m_nodeLp.size())
+    {
+        return m_lps[m_nodeLp[context]].get();
+    }
+    return m_globalLp.get();
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetCurrentLogicalProcess() const
+{
+    return g_currentLp != nullptr ? g_currentLp : m_globalLp.get();
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetEventLogicalProcess(const EventId& id) const
+{
+    LogicalProcess* lp = GetLogicalProcess(id.GetContext());
+    // The queue of another partition LP is modified by its own thread
+    // during the window; an empty EventId is expired whatever its context
+    NS_ABORT_MSG_IF(g_currentLp != nullptr && lp != g_currentLp && lp != m_globalLp.get() &&
+                        id.PeekEventImpl() != nullptr,
+                    "Event of context " << id.GetContext() << " accessed from context "
+                                        << g_currentLp->GetContext()
+                                        << ", in another logical process");
+    return lp;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessLogicalProcesses()
+{
+    while (true)
+    {
+        uint32_t index = m_nextLp.fetch_add(1);
+        if (index >= m_lps.size())
+        {
+            break;
+        }
+        LogicalProcess* lp = m_lps[index].get();
+        if (m_delivering)
+        {
+            lp->Deliver();
+        }
+        else
+        {
+            g_currentLp = lp;
+            Packet::SetThreadUidCounter(lp->GetPacketUidCounter(), lp->GetId());
+            lp->ProcessWindow(this);
+            Packet::SetThreadUidCounter(nullptr, 0);
+            g_currentLp = nullptr;
+        }
+        if (m_doneLps.fetch_add(1) + 1 == m_lps.size())
+        {
+            std::unique_lock lock{m_roundMutex};
+            m_roundEnd.notify_one();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunRound(bool deliver)
+{
+    m_delivering = deliver;
+    m_doneLps = 0;
+    m_nextLp = 0;
+    if (m_workers.empty())
+    {
+        ProcessLogicalProcesses();
+        return;
+    }
+    {
+        std::unique_lock lock{m_roundMutex};
+        m_round++;
+    }
+    m_roundStart.notify_all();
+    ProcessLogicalProcesses();
+    std::unique_lock lock{m_roundMutex};
+    m_roundEnd.wait(lock, [this] { return m_doneLps == m_lps.size(); });
+}
+
+void
+MultithreadedSimulatorImpl::WorkerLoop()
+{
+    uint64_t round = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock{m_roundMutex};
+            m_roundStart.wait(lock, [this, round] { return m_exitWorkers || m_round != round; });
+            if (m_exitWorkers)
+            {
+                return;
+            }
+            round = m_round;
+        }
+        ProcessLogicalProcesses();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StartWorkers()
+{
+    NS_LOG_FUNCTION(this);
+
+    uint32_t nThreads = m_maxThreads;
+    if (nThreads == 0)
+    {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    nThreads = std::min<uint32_t>(nThreads, m_lps.size());
+    m_exitWorkers = false;
+    m_round = 0;
+    // The packets are shared by the threads until they are joined
+    PacketAllocator::SetConcurrent(nThreads > 1);
+    for (uint32_t i = 1; i < nThreads; ++i)
+    {
+        m_workers.emplace_back(&MultithreadedSimulatorImpl::WorkerLoop, this);
+    }
+    NS_LOG_INFO("Running " << m_lps.size() << " logical processes on " << nThreads
+                           << " threads");
+}
+
+void
+MultithreadedSimulatorImpl::StopWorkers()
+{
+    NS_LOG_FUNCTION(this);
+
+    {
+        std::unique_lock lock{m_roundMutex};
+        m_exitWorkers = true;
+    }
+    m_roundStart.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+    PacketAllocator::SetConcurrent(false);
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_mainThreadId = std::this_thread::get_id();
+    if (!m_partitioned)
+    {
+        Partition();
+    }
+    m_stop = false;
+    StartWorkers();
+
+    const uint64_t maxTs = GetMaximumSimulationTime().GetTimeStep();
+    const uint64_t lookAhead = m_lookAhead.GetTimeStep();
+    while (!m_stop)
+    {
+        Scheduler::EventKey next = m_globalLp->NextKey();
+        for (auto& lp : m_lps)
+        {
+            next = std::min(next, lp->NextKey());
+        }
+        if (next.m_ts == maxTs)
+        {
+            break;
+        }
+
+        Scheduler::EventKey global = m_globalLp->NextKey();
+        if (!(next < global))
+        {
+            // Events without a node context may touch any node, so they
+            // are run by the main thread while all the LPs are paused.
+            m_globalLp->ProcessOneEvent(this);
+            continue;
+        }
+
+        // No LP can receive an event earlier than next + lookahead, so
+        // all the events before the end of the window can run in parallel,
+        // up to the next global event.
+        Scheduler::EventKey end{maxTs, 0, 0};
+        if (maxTs - next.m_ts > lookAhead)
+        {
+            end.m_ts = next.m_ts + lookAhead;
+        }
+        end = std::min(end, global);
+        m_windowEnd = end.m_ts;
+        for (auto& lp : m_lps)
+        {
+            lp->StartWindow(end.m_ts, end.m_uid);
+        }
+        RunRound(false);
+
+        // Number the events scheduled in the window for later windows,
+        // and for other LPs, in the order of the sequential run.
+        bool exports = m_globalLp->HasExports();
+        for (auto& lp : m_lps)
+        {
+            exports |= lp->HasExports();
+        }
+        if (exports)
+        {
+            m_uid = LogicalProcess::NumberCalls(m_lps, m_uid);
+            RunRound(true);
+            m_globalLp->Deliver();
+        }
+    }
+
+    StopWorkers();
+
+    // Let Simulator::Now() report the time reached by the most advanced LP.
+    uint64_t currentTs = m_globalLp->GetCurrentTs();
+    for (auto& lp : m_lps)
+    {
+        currentTs = std::max(currentTs, lp->GetCurrentTs());
+    }
+    m_globalLp->SetCurrentTs(currentTs);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    return m_globalLp->IsEmpty() &&
+           std::all_of(m_lps.begin(), m_lps.end(), [](const auto& lp) { return lp->IsEmpty(); });
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_stop = true;
+}
+
+EventId
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+
+    return Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(g_currentLp != nullptr || m_mainThreadId == std::this_thread::get_id(),
+                  "Simulator::Schedule Thread-unsafe invocation!");
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+    LogicalProcess* lp = GetCurrentLogicalProcess();
+    uint64_t ts = lp->GetCurrentTs() + delay.GetTimeStep();
+    if (g_currentLp != nullptr)
+    {
+        return lp->Schedule(ts, lp->GetContext(), event, true);
+    }
+    return lp->Insert(ts, lp->GetContext(), NextUid(), event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    NS_ABORT_MSG_IF(g_currentLp == nullptr && m_mainThreadId != std::this_thread::get_id(),
+                    "MultithreadedSimulatorImpl does not support scheduling events from "
+                    "threads it does not own");
+
+    LogicalProcess* source = GetCurrentLogicalProcess();
+    LogicalProcess* destination = GetLogicalProcess(context);
+    uint64_t ts = source->GetCurrentTs() + delay.GetTimeStep();
+
+    // The main thread runs only while all the LPs are paused, so it can
+    // insert the event directly.
+    if (g_currentLp == nullptr)
+    {
+        destination->Insert(ts, context, NextUid(), event);
+        return;
+    }
+    if (source == destination)
+    {
+        source->Schedule(ts, context, event, false);
+        return;
+    }
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "Event scheduled from context " << source->GetContext() << " to context "
+                                                    << context << " with a delay of " << delay
+                                                    << ", smaller than the lookahead "
+                                                    << m_lookAhead);
+    destination->Send(ts, context, event, source, source->NextCall());
+}
+
+uint32_t
+MultithreadedSimulatorImpl::NextUid()
+{
+    NS_ABORT_MSG_IF(m_uid >= LogicalProcess::PROVISIONAL_UID,
+                    "Too many events scheduled in the simulation");
+    return m_uid++;
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << event);
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << event);
+    NS_ASSERT_MSG(m_mainThreadId == std::this_thread::get_id() && g_currentLp == nullptr,
+                  "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+    EventId id(Ptr<EventImpl>(event, false), m_globalLp->GetCurrentTs(), 0xffffffff, 2);
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(GetCurrentLogicalProcess()->GetCurrentTs());
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    else
+    {
+        return TimeStep(id.GetTs() - GetCurrentLogicalProcess()->GetCurrentTs());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    LogicalProcess* lp = GetEventLogicalProcess(id);
+    if (lp->IsExpired(id))
+    {
+        return;
+    }
+    lp->Remove(id);
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return GetEventLogicalProcess(id)->IsExpired(id);
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return GetCurrentLogicalProcess()->GetContext();
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = m_globalLp->GetEventCount();
+    for (const auto& lp : m_lps)
+    {
+        count += lp->GetEventCount();
+    }
+    return count;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount() const
+{
+    return m_lps.size();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead() const
+{
+    return m_lookAhead;
+}
+
+} // namespace ns3
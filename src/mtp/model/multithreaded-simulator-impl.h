@@ -0,0 +1,246 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/**
+ * @file
+ * @ingroup mtp
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+class LogicalProcess;
+
+/**
+ * @defgroup mtp Multithreaded Simulation
+ *
+ * Parallel execution of a simulation on multiple threads of a single
+ * process, with conservative synchronization based on the delay of the
+ * point-to-point links.
+ */
+
+/**
+ * @ingroup simulator
+ * @ingroup mtp
+ *
+ * @brief Shared-memory parallel simulator implementation using lookahead.
+ *
+ * When Run() is first called the nodes are split into logical
+ * processes (LPs): nodes sharing a channel without lookahead (any
+ * channel other than a point-to-point channel with a positive
+ * \c Delay attribute) end up in the same LP.  Each LP owns its own
+ * event queue and the LPs are executed in parallel by a pool of
+ * threads, in time windows whose length is the smallest delay of
+ * the point-to-point channels connecting different LPs, exactly as
+ * done over MPI by DistributedSimulatorImpl.
+ *
+ * Events without a node context (e.g., those scheduled by the main
+ * program before the simulation starts, or Simulator::Stop()) are
+ * kept in a global LP which is executed by the main thread while all
+ * the other LPs are paused.
+ *
+ * The events are run in the same order as with the DefaultSimulatorImpl,
+ * including the events with the same timestamp.  The packets created by
+ * the events of an LP are numbered by a counter of the LP, with the LP
+ * identifier as the upper 32 bits of their uid (see
+ * Packet::SetThreadUidCounter()), so the packet uids do not depend on
+ * the number of threads either, but differ from those of a sequential
+ * run.
+ *
+ * An event can only be cancelled, removed or checked by the events of
+ * the LP owning it, or by those of the global LP; cancelling the event
+ * of a node of another LP is not supported, and aborts.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Default constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // virtual from SimulatorImpl
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    EventId Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get the number of logical processes the nodes were split into.
+     *
+     * The partition is built on the first call to Run(); before that
+     * this method returns 0.
+     *
+     * @return The number of logical processes, not counting the global one.
+     */
+    uint32_t GetPartitionCount() const;
+
+    /**
+     * Get the lookahead, i.e., the length of the synchronization window.
+     *
+     * @return The lookahead; Time::Max() if the LPs are not connected.
+     */
+    Time GetLookAhead() const;
+
+  private:
+    // Inherited from Object
+    void DoDispose() override;
+
+    /**
+     * Split the nodes into logical processes, compute the lookahead
+     * and move the already scheduled events to the LP owning them.
+     */
+    void Partition();
+
+    /**
+     * Get the LP owning a context.
+     *
+     * @param [in] context The event context, i.e., a node id.
+     * @return The LP; the global LP if the context is not a node.
+     */
+    LogicalProcess* GetLogicalProcess(uint32_t context) const;
+
+    /** @return The LP of the calling thread. */
+    LogicalProcess* GetCurrentLogicalProcess() const;
+
+    /**
+     * Get the LP owning an event, checking that the calling thread may
+     * access it: an LP thread may only access the events of its own LP
+     * and those of the global LP, paused while the LPs run.
+     *
+     * @param [in] id The event.
+     * @return The LP.
+     */
+    LogicalProcess* GetEventLogicalProcess(const EventId& id) const;
+
+    /**
+     * Run the partition LPs in parallel, until the end of their window
+     * or to deliver the events numbered at the end of the window.
+     *
+     * @param [in] deliver Whether to deliver the events rather than
+     *             running the window.
+     */
+    void RunRound(bool deliver);
+
+    /**
+     * Claim and run LPs until none is left in the current round.
+     */
+    void ProcessLogicalProcesses();
+
+    /**
+     * Get the uid of an event scheduled while all the LPs are paused.
+     *
+     * @return The next uid.
+     */
+    uint32_t NextUid();
+
+    /**
+     * Body of the worker threads.
+     */
+    void WorkerLoop();
+
+    /** Start the worker threads. */
+    void StartWorkers();
+    /** Stop and join the worker threads. */
+    void StopWorkers();
+
+    /** Container type for the events to run at Simulator::Destroy(). */
+    typedef std::list<EventId> DestroyEvents;
+
+    /** The container of events to run at Destroy() */
+    DestroyEvents m_destroyEvents;
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+    /**
+     * Next event uid.  The uids follow the order in which the events
+     * would have been scheduled by the DefaultSimulatorImpl.
+     */
+    uint32_t m_uid;
+    /** The scheduler factory, used to create one event queue per LP. */
+    ObjectFactory m_schedulerFactory;
+
+    /**
+     * The LP holding the events without a node context.  It also holds
+     * all the events scheduled before the partition is built.
+     */
+    std::unique_ptr<LogicalProcess> m_globalLp;
+    /** The partition LPs. */
+    std::vector<std::unique_ptr<LogicalProcess>> m_lps;
+    /** LP index (in m_lps) of each node, indexed by node id. */
+    std::vector<uint32_t> m_nodeLp;
+    /** Whether the nodes have been partitioned. */
+    bool m_partitioned;
+    /** Window size. */
+    Time m_lookAhead;
+    /** Point-to-point channels with a smaller delay are not cut. */
+    Time m_minLookAhead;
+
+    /** End timestamp of the current window. */
+    uint64_t m_windowEnd;
+    /** Whether the current round delivers events rather than running them. */
+    bool m_delivering;
+    /** Maximum number of threads, including the main one. */
+    uint32_t m_maxThreads;
+    /** Worker threads. */
+    std::vector<std::thread> m_workers;
+    /** Main execution thread. */
+    std::thread::id m_mainThreadId;
+    /** Index of the next LP to run in the current window. */
+    std::atomic<uint32_t> m_nextLp;
+    /** Number of LPs completed in the current window. */
+    std::atomic<uint32_t> m_doneLps;
+    /** Current window number, used to wake up the workers. */
+    uint64_t m_round;
+    /** Whether the workers must exit. */
+    bool m_exitWorkers;
+    /** Protects m_round and m_exitWorkers. */
+    std::mutex m_roundMutex;
+    /** Notifies the workers about a new window. */
+    std::condition_variable m_roundStart;
+    /** Notifies the main thread about the end of a window. */
+    std::condition_variable m_roundEnd;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
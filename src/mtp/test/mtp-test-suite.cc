@@ -0,0 +1,707 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <tuple>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup mtp-tests
+ * Multithreaded simulator implementation test suite.
+ */
+
+/**
+ * @ingroup mtp
+ * @defgroup mtp-tests Multithreaded simulator implementation tests
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup mtp-tests
+ *
+ * @brief Check that a token-passing workload produces the same events
+ * with the sequential and the multithreaded simulator implementations.
+ *
+ * Twelve nodes are split in four clusters of three nodes sharing a
+ * broadcast SimpleChannel; the clusters are connected in a ring by
+ * point-to-point SimpleChannels with different delays.  Every node
+ * injects a token which then hops between neighbors, scheduling a
+ * local processing event at every hop.
+ */
+class MtpTokenTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param maxThreads The number of threads of the multithreaded run.
+     */
+    MtpTokenTestCase(uint32_t maxThreads);
+
+  private:
+    void DoRun() override;
+
+    /** A token reception: timestamp, token, remaining hops. */
+    typedef std::tuple<int64_t, uint32_t, uint32_t> Record;
+    /** The records of each node, indexed by node id. */
+    typedef std::vector<std::vector<Record>> Trace;
+
+    /**
+     * Build the topology and run the workload.
+     *
+     * @param impl The simulator implementation to use.
+     * @return The trace of the token receptions.
+     */
+    Trace RunScenario(Ptr<SimulatorImpl> impl);
+
+    /**
+     * Receive a token.
+     *
+     * @param node The receiving node id.
+     * @param token The token.
+     * @param hops The number of remaining hops.
+     */
+    void ReceiveToken(uint32_t node, uint32_t token, uint32_t hops);
+
+    /**
+     * Forward a token to a neighbor.
+     *
+     * @param node The forwarding node id.
+     * @param token The token.
+     * @param hops The number of remaining hops.
+     */
+    void ForwardToken(uint32_t node, uint32_t token, uint32_t hops);
+
+    uint32_t m_maxThreads; //!< Number of threads of the multithreaded run.
+    /** Neighbor ids and link delays of each node. */
+    std::vector<std::vector<std::pair<uint32_t, Time>>> m_neighbors;
+    Trace m_trace; //!< The trace of the current run.
+};
+
+MtpTokenTestCase::MtpTokenTestCase(uint32_t maxThreads)
+    : TestCase("Token passing with " + std::to_string(maxThreads) + " threads"),
+      m_maxThreads(maxThreads)
+{
+}
+
+void
+MtpTokenTestCase::ReceiveToken(uint32_t node, uint32_t token, uint32_t hops)
+{
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetContext(), node, "Event run with the wrong context");
+    m_trace[node].emplace_back(Simulator::Now().GetTimeStep(), token, hops);
+    if (hops > 0)
+    {
+        Time processing = NanoSeconds(((token * 7919 + hops * 104729) % 997) + 1);
+        Simulator::Schedule(processing, &MtpTokenTestCase::ForwardToken, this, node, token, hops);
+    }
+}
+
+void
+MtpTokenTestCase::ForwardToken(uint32_t node, uint32_t token, uint32_t hops)
+{
+    const auto& neighbors = m_neighbors[node];
+    const auto& [next, delay] = neighbors[(token + hops) % neighbors.size()];
+    Simulator::ScheduleWithContext(next,
+                                   delay,
+                                   &MtpTokenTestCase::ReceiveToken,
+                                   this,
+                                   next,
+                                   token * 3 + 1,
+                                   hops - 1);
+}
+
+MtpTokenTestCase::Trace
+MtpTokenTestCase::RunScenario(Ptr<SimulatorImpl> impl)
+{
+    Simulator::SetImplementation(impl);
+
+    const uint32_t nClusters = 4;
+    const uint32_t clusterSize = 3;
+    const Time intraDelay = MicroSeconds(100);
+    const std::vector<Time> interDelays{MilliSeconds(2),
+                                        MilliSeconds(3),
+                                        MilliSeconds(5),
+                                        MilliSeconds(7)};
+
+    NodeContainer nodes;
+    nodes.Create(nClusters * clusterSize);
+    m_neighbors.assign(nodes.GetN(), {});
+    m_trace.assign(nodes.GetN(), {});
+
+    for (uint32_t c = 0; c < nClusters; ++c)
+    {
+        auto channel = CreateObject<SimpleChannel>();
+        channel->SetAttribute("Delay", TimeValue(intraDelay));
+        for (uint32_t i = 0; i < clusterSize; ++i)
+        {
+            auto device = CreateObject<SimpleNetDevice>();
+            nodes.Get(c * clusterSize + i)->AddDevice(device);
+            device->SetChannel(channel);
+            for (uint32_t j = 0; j < clusterSize; ++j)
+            {
+                if (i != j)
+                {
+                    m_neighbors[c * clusterSize + i].emplace_back(c * clusterSize + j, intraDelay);
+                }
+            }
+        }
+    }
+    for (uint32_t c = 0; c < nClusters; ++c)
+    {
+        uint32_t a = c * clusterSize;
+        uint32_t b = ((c + 1) % nClusters) * clusterSize + 1;
+        auto channel = CreateObject<SimpleChannel>();
+        channel->SetAttribute("Delay", TimeValue(interDelays[c]));
+        for (auto n : {a, b})
+        {
+            auto device = CreateObjectWithAttributes<SimpleNetDevice>("PointToPointMode",
+                                                                      BooleanValue(true));
+            nodes.Get(n)->AddDevice(device);
+            device->SetChannel(channel);
+        }
+        m_neighbors[a].emplace_back(b, interDelays[c]);
+        m_neighbors[b].emplace_back(a, interDelays[c]);
+    }
+
+    for (uint32_t n = 0; n < nodes.GetN(); ++n)
+    {
+        Simulator::ScheduleWithContext(n,
+                                       MicroSeconds(13 * n),
+                                       &MtpTokenTestCase::ReceiveToken,
+                                       this,
+                                       n,
+                                       n,
+                                       500);
+    }
+    Simulator::Stop(MilliSeconds(400));
+    Simulator::Run();
+
+    auto mtp = DynamicCast<MultithreadedSimulatorImpl>(impl);
+    if (mtp)
+    {
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetPartitionCount(), nClusters, "Unexpected partition");
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetLookAhead(), MilliSeconds(2), "Unexpected lookahead");
+    }
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), MilliSeconds(400), "Simulation did not stop");
+
+    Simulator::Destroy();
+    return m_trace;
+}
+
+void
+MtpTokenTestCase::DoRun()
+{
+    Trace sequential = RunScenario(CreateObject<DefaultSimulatorImpl>());
+
+    auto impl = CreateObjectWithAttributes<MultithreadedSimulatorImpl>(
+        "MaxThreads",
+        UintegerValue(m_maxThreads));
+    Trace parallel = RunScenario(impl);
+
+    auto single = CreateObjectWithAttributes<MultithreadedSimulatorImpl>("MaxThreads",
+                                                                         UintegerValue(1));
+    Trace reference = RunScenario(single);
+
+    NS_TEST_ASSERT_MSG_EQ(parallel.size(), sequential.size(), "Different number of nodes");
+    for (std::size_t n = 0; n < parallel.size(); ++n)
+    {
+        NS_TEST_EXPECT_MSG_GT(sequential[n].size(), 0, "Node " << n << " saw no token");
+        // The run must not depend on the number of threads
+        NS_TEST_EXPECT_MSG_EQ((parallel[n] == reference[n]),
+                              true,
+                              "Node " << n << " trace depends on the number of threads");
+        NS_TEST_EXPECT_MSG_EQ((parallel[n] == sequential[n]),
+                              true,
+                              "Node " << n << " trace differs from the sequential run");
+    }
+}
+
+/**
+ * @ingroup mtp-tests
+ *
+ * @brief Check that simultaneous events are run in the same order with
+ * the sequential and the multithreaded simulator implementations.
+ *
+ * Eight nodes are split in four LPs of two nodes, connected in a ring
+ * by point-to-point SimpleChannels of 1 ms.  Every event schedules
+ * events for its node, for the other node of its LP and for the nodes
+ * of the neighbor LPs, with delays on a coarse grid, so that many
+ * events with the same timestamp are scheduled by different LPs at
+ * different times.  The events also cancel, remove and check the
+ * expiration of the events they scheduled.  A global event schedules
+ * events for all the nodes, and the simulation is stopped at the same
+ * time as some node events.
+ */
+class MtpSimultaneousEventsTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param maxThreads The number of threads of the multithreaded run.
+     */
+    MtpSimultaneousEventsTestCase(uint32_t maxThreads);
+
+  private:
+    void DoRun() override;
+
+    /** An event: timestamp, event id, and a value observed by the event. */
+    typedef std::tuple<int64_t, uint64_t, int64_t> Record;
+    /** The records of each node, indexed by node id. */
+    typedef std::vector<std::vector<Record>> Trace;
+
+    /**
+     * Build the topology and run the workload.
+     *
+     * @param impl The simulator implementation to use.
+     * @param [out] eventCount The number of events run.
+     * @return The trace of the events.
+     */
+    Trace RunScenario(Ptr<SimulatorImpl> impl, uint64_t& eventCount);
+
+    /**
+     * Draw a pseudo-random number from the state of a node.
+     *
+     * @param node The node id.
+     * @param n The number of values.
+     * @return A value between 0 and \p n - 1.
+     */
+    uint32_t Draw(uint32_t node, uint32_t n);
+
+    /**
+     * Handle an event.
+     *
+     * @param node The node id.
+     * @param id The event id.
+     * @param depth The number of generations of events left.
+     */
+    void Handle(uint32_t node, uint64_t id, uint32_t depth);
+
+    /**
+     * Run the global event, scheduling events for all the nodes.
+     */
+    void Global();
+
+    uint32_t m_maxThreads;          //!< Number of threads of the multithreaded run.
+    uint32_t m_lpSize;              //!< Number of nodes of each LP.
+    uint32_t m_nLps;                //!< Number of LPs.
+    std::vector<uint64_t> m_state;  //!< Pseudo-random state of each node.
+    std::vector<uint64_t> m_nextId; //!< Next event id of each node.
+    std::vector<EventId> m_pending; //!< An event scheduled by each node.
+    Trace m_trace;                  //!< The trace of the current run.
+};
+
+MtpSimultaneousEventsTestCase::MtpSimultaneousEventsTestCase(uint32_t maxThreads)
+    : TestCase("Simultaneous events with " + std::to_string(maxThreads) + " threads"),
+      m_maxThreads(maxThreads),
+      m_lpSize(2),
+      m_nLps(4)
+{
+}
+
+uint32_t
+MtpSimultaneousEventsTestCase::Draw(uint32_t node, uint32_t n)
+{
+    m_state[node] = m_state[node] * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (m_state[node] >> 33) % n;
+}
+
+void
+MtpSimultaneousEventsTestCase::Handle(uint32_t node, uint64_t id, uint32_t depth)
+{
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetContext(), node, "Event run with the wrong context");
+    int64_t observed = -1;
+    EventId& pending = m_pending[node];
+    switch (Draw(node, 4))
+    {
+    case 0:
+        observed = pending.IsExpired() ? -2 : Simulator::GetDelayLeft(pending).GetTimeStep();
+        break;
+    case 1:
+        observed = pending.IsExpired() ? -3 : -4;
+        pending.Cancel();
+        break;
+    case 2:
+        observed = pending.IsExpired() ? -5 : -6;
+        pending.Remove();
+        break;
+    default:
+        break;
+    }
+    m_trace[node].emplace_back(Simulator::Now().GetTimeStep(), id, observed);
+    if (depth == 0)
+    {
+        return;
+    }
+
+    uint32_t lp = node / m_lpSize;
+    uint32_t peer = lp * m_lpSize + (node + 1) % m_lpSize;
+    uint32_t remote = ((lp + 1 + 2 * Draw(node, 2)) % m_nLps) * m_lpSize + Draw(node, m_lpSize);
+    for (uint32_t i = Draw(node, 3); i < 3; ++i)
+    {
+        uint64_t child = node * 1000000 + m_nextId[node]++;
+        switch (Draw(node, 3))
+        {
+        case 0:
+            pending = Simulator::Schedule(MicroSeconds(250 * Draw(node, 8)),
+                                          &MtpSimultaneousEventsTestCase::Handle,
+                                          this,
+                                          node,
+                                          child,
+                                          depth - 1);
+            break;
+        case 1:
+            Simulator::ScheduleWithContext(peer,
+                                           MicroSeconds(500 * Draw(node, 4)),
+                                           &MtpSimultaneousEventsTestCase::Handle,
+                                           this,
+                                           peer,
+                                           child,
+                                           depth - 1);
+            break;
+        default:
+            Simulator::ScheduleWithContext(remote,
+                                           MilliSeconds(1 + Draw(node, 3)),
+                                           &MtpSimultaneousEventsTestCase::Handle,
+                                           this,
+                                           remote,
+                                           child,
+                                           depth - 1);
+            break;
+        }
+    }
+}
+
+void
+MtpSimultaneousEventsTestCase::Global()
+{
+    for (uint32_t n = 0; n < m_lpSize * m_nLps; ++n)
+    {
+        Simulator::ScheduleWithContext(n,
+                                       Time(0),
+                                       &MtpSimultaneousEventsTestCase::Handle,
+                                       this,
+                                       n,
+                                       n * 1000000 + m_nextId[n]++,
+                                       6);
+    }
+}
+
+MtpSimultaneousEventsTestCase::Trace
+MtpSimultaneousEventsTestCase::RunScenario(Ptr<SimulatorImpl> impl, uint64_t& eventCount)
+{
+    Simulator::SetImplementation(impl);
+
+    NodeContainer nodes;
+    nodes.Create(m_lpSize * m_nLps);
+    m_state.assign(nodes.GetN(), 0);
+    m_nextId.assign(nodes.GetN(), 0);
+    m_pending.assign(nodes.GetN(), EventId());
+    m_trace.assign(nodes.GetN(), {});
+
+    for (uint32_t lp = 0; lp < m_nLps; ++lp)
+    {
+        auto channel = CreateObject<SimpleChannel>();
+        for (uint32_t i = 0; i < m_lpSize; ++i)
+        {
+            auto device = CreateObject<SimpleNetDevice>();
+            nodes.Get(lp * m_lpSize + i)->AddDevice(device);
+            device->SetChannel(channel);
+        }
+    }
+    for (uint32_t lp = 0; lp < m_nLps; ++lp)
+    {
+        auto channel = CreateObject<SimpleChannel>();
+        channel->SetAttribute("Delay", TimeValue(MilliSeconds(1)));
+        for (auto n : {lp * m_lpSize, ((lp + 1) % m_nLps) * m_lpSize})
+        {
+            auto device = CreateObjectWithAttributes<SimpleNetDevice>("PointToPointMode",
+                                                                      BooleanValue(true));
+            nodes.Get(n)->AddDevice(device);
+            device->SetChannel(channel);
+        }
+    }
+
+    for (uint32_t n = 0; n < nodes.GetN(); ++n)
+    {
+        m_state[n] = n + 1;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            Simulator::ScheduleWithContext(n,
+                                           MicroSeconds(500 * i),
+                                           &MtpSimultaneousEventsTestCase::Handle,
+                                           this,
+                                           n,
+                                           n * 1000000 + m_nextId[n]++,
+                                           8);
+        }
+    }
+    Simulator::Schedule(MilliSeconds(3), &MtpSimultaneousEventsTestCase::Global, this);
+    Simulator::Stop(MilliSeconds(12));
+    Simulator::Run();
+
+    auto mtp = DynamicCast<MultithreadedSimulatorImpl>(impl);
+    if (mtp)
+    {
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetPartitionCount(), m_nLps, "Unexpected partition");
+    }
+    eventCount = Simulator::GetEventCount();
+    Simulator::Destroy();
+    return m_trace;
+}
+
+void
+MtpSimultaneousEventsTestCase::DoRun()
+{
+    uint64_t sequentialCount;
+    Trace sequential = RunScenario(CreateObject<DefaultSimulatorImpl>(), sequentialCount);
+
+    auto impl = CreateObjectWithAttributes<MultithreadedSimulatorImpl>(
+        "MaxThreads",
+        UintegerValue(m_maxThreads));
+    uint64_t parallelCount;
+    Trace parallel = RunScenario(impl, parallelCount);
+
+    NS_TEST_EXPECT_MSG_EQ(parallelCount, sequentialCount, "Different number of events");
+    NS_TEST_ASSERT_MSG_EQ(parallel.size(), sequential.size(), "Different number of nodes");
+    for (std::size_t n = 0; n < parallel.size(); ++n)
+    {
+        NS_TEST_EXPECT_MSG_GT(sequential[n].size(), 100, "Node " << n << " saw too few events");
+        NS_TEST_EXPECT_MSG_EQ((parallel[n] == sequential[n]),
+                              true,
+                              "Node " << n << " trace differs from the sequential run");
+    }
+}
+
+/**
+ * @ingroup mtp-tests
+ *
+ * @brief Check that packets sent over point-to-point links between LPs
+ * are received as in the sequential run, with uids which do not depend
+ * on the number of threads.
+ *
+ * Six nodes are connected in a ring by PointToPointChannels with
+ * different delays, so that every node is an LP.  Every node sends
+ * bursts of packets to both of its neighbors; every received packet is
+ * forwarded to the next node of the ring as a new packet, one byte
+ * shorter, until its size reaches the minimum.
+ */
+class MtpPointToPointTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param maxThreads The number of threads of the multithreaded run.
+     */
+    MtpPointToPointTestCase(uint32_t maxThreads);
+
+  private:
+    void DoRun() override;
+
+    /** A packet reception: timestamp, packet uid, packet size. */
+    typedef std::tuple<int64_t, uint64_t, uint32_t> Record;
+    /** The records of each node, indexed by node id. */
+    typedef std::vector<std::vector<Record>> Trace;
+
+    /**
+     * Build the topology and run the workload.
+     *
+     * @param impl The simulator implementation to use.
+     * @return The trace of the packet receptions.
+     */
+    Trace RunScenario(Ptr<SimulatorImpl> impl);
+
+    /**
+     * Send a burst of packets.
+     *
+     * @param device The sending device.
+     * @param count The number of packets.
+     * @param size The size of the packets.
+     */
+    void SendBurst(Ptr<NetDevice> device, uint32_t count, uint32_t size);
+
+    /**
+     * Receive a packet, and forward it to the next node.
+     *
+     * @param device The receiving device.
+     * @param packet The packet.
+     * @param protocol The protocol number.
+     * @param from The sender address.
+     * @return Always true.
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+
+    uint32_t m_maxThreads; //!< Number of threads of the multithreaded run.
+    uint32_t m_minSize;    //!< Packets of this size are not forwarded.
+    Trace m_trace;         //!< The trace of the current run.
+};
+
+MtpPointToPointTestCase::MtpPointToPointTestCase(uint32_t maxThreads)
+    : TestCase("Point-to-point packets with " + std::to_string(maxThreads) + " threads"),
+      m_maxThreads(maxThreads),
+      m_minSize(100)
+{
+}
+
+void
+MtpPointToPointTestCase::SendBurst(Ptr<NetDevice> device, uint32_t count, uint32_t size)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        device->Send(Create<Packet>(size + i), device->GetBroadcast(), 0x0800);
+    }
+}
+
+bool
+MtpPointToPointTestCase::Receive(Ptr<NetDevice> device,
+                                 Ptr<const Packet> packet,
+                                 uint16_t protocol,
+                                 const Address& from)
+{
+    Ptr<Node> node = device->GetNode();
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetContext(),
+                          node->GetId(),
+                          "Packet received with the wrong context");
+    m_trace[node->GetId()].emplace_back(Simulator::Now().GetTimeStep(),
+                                        packet->GetUid(),
+                                        packet->GetSize());
+    if (packet->GetSize() > m_minSize)
+    {
+        // forward on the other device of the node
+        Ptr<NetDevice> next = node->GetDevice(1 - device->GetIfIndex());
+        next->Send(Create<Packet>(packet->GetSize() - 1), next->GetBroadcast(), protocol);
+    }
+    return true;
+}
+
+MtpPointToPointTestCase::Trace
+MtpPointToPointTestCase::RunScenario(Ptr<SimulatorImpl> impl)
+{
+    Simulator::SetImplementation(impl);
+
+    const uint32_t nNodes = 6;
+    NodeContainer nodes;
+    nodes.Create(nNodes);
+    m_trace.assign(nNodes, {});
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", DataRateValue(DataRate("10Mbps")));
+    for (uint32_t n = 0; n < nNodes; ++n)
+    {
+        p2p.SetChannelAttribute("Delay", TimeValue(MicroSeconds(500 + 300 * n)));
+        p2p.Install(nodes.Get(n), nodes.Get((n + 1) % nNodes));
+    }
+    for (uint32_t n = 0; n < nNodes; ++n)
+    {
+        Ptr<Node> node = nodes.Get(n);
+        for (uint32_t i = 0; i < node->GetNDevices(); ++i)
+        {
+            Ptr<NetDevice> device = node->GetDevice(i);
+            device->SetReceiveCallback(MakeCallback(&MtpPointToPointTestCase::Receive, this));
+            for (uint32_t burst = 0; burst < 5; ++burst)
+            {
+                Simulator::ScheduleWithContext(n,
+                                               MicroSeconds(700 * burst + 37 * n + 11 * i),
+                                               &MtpPointToPointTestCase::SendBurst,
+                                               this,
+                                               device,
+                                               3 + burst,
+                                               m_minSize + 20 + 3 * n);
+            }
+        }
+    }
+    Simulator::Stop(MilliSeconds(100));
+    Simulator::Run();
+
+    auto mtp = DynamicCast<MultithreadedSimulatorImpl>(impl);
+    if (mtp)
+    {
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetPartitionCount(), nNodes, "Unexpected partition");
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetLookAhead(), MicroSeconds(500), "Unexpected lookahead");
+    }
+
+    Simulator::Destroy();
+    return m_trace;
+}
+
+void
+MtpPointToPointTestCase::DoRun()
+{
+    Trace sequential = RunScenario(CreateObject<DefaultSimulatorImpl>());
+
+    auto impl = CreateObjectWithAttributes<MultithreadedSimulatorImpl>(
+        "MaxThreads",
+        UintegerValue(m_maxThreads));
+    Trace parallel = RunScenario(impl);
+
+    auto single = CreateObjectWithAttributes<MultithreadedSimulatorImpl>("MaxThreads",
+                                                                         UintegerValue(1));
+    Trace reference = RunScenario(single);
+
+    NS_TEST_ASSERT_MSG_EQ(parallel.size(), sequential.size(), "Different number of nodes");
+    for (std::size_t n = 0; n < parallel.size(); ++n)
+    {
+        NS_TEST_EXPECT_MSG_GT(sequential[n].size(), 100, "Node " << n << " saw too few packets");
+        // The packet uids must not depend on the number of threads
+        NS_TEST_EXPECT_MSG_EQ((parallel[n] == reference[n]),
+                              true,
+                              "Node " << n << " trace depends on the number of threads");
+        // but they differ from those of the sequential run
+        NS_TEST_ASSERT_MSG_EQ(parallel[n].size(),
+                              sequential[n].size(),
+                              "Node " << n << " received a different number of packets");
+        for (std::size_t i = 0; i < parallel[n].size(); ++i)
+        {
+            NS_TEST_EXPECT_MSG_EQ(std::get<0>(parallel[n][i]),
+                                  std::get<0>(sequential[n][i]),
+                                  "Node " << n << " packet " << i << " received at another time");
+            NS_TEST_EXPECT_MSG_EQ(std::get<2>(parallel[n][i]),
+                                  std::get<2>(sequential[n][i]),
+                                  "Node " << n << " packet " << i << " has another size");
+        }
+    }
+}
+
+/**
+ * @ingroup mtp-tests
+ *
+ * @brief The multithreaded simulator implementation test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite()
+        : TestSuite("mtp", Type::UNIT)
+    {
+        AddTestCase(new MtpTokenTestCase(1), TestCase::Duration::QUICK);
+        AddTestCase(new MtpTokenTestCase(2), TestCase::Duration::QUICK);
+        AddTestCase(new MtpTokenTestCase(4), TestCase::Duration::QUICK);
+        AddTestCase(new MtpSimultaneousEventsTestCase(1), TestCase::Duration::QUICK);
+        AddTestCase(new MtpSimultaneousEventsTestCase(4), TestCase::Duration::QUICK);
+        AddTestCase(new MtpPointToPointTestCase(1), TestCase::Duration::QUICK);
+        AddTestCase(new MtpPointToPointTestCase(4), TestCase::Duration::QUICK);
+    }
+};
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
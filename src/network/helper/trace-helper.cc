@@ -405,6 +405,36 @@ AsciiTraceHelper::DefaultReceiveSinkWithContext(Ptr<OutputStreamWrapper> stream,
                          << std::endl;
 }
 
+BinaryTraceHelper::BinaryTraceHelper()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+BinaryTraceHelper::~BinaryTraceHelper()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+Ptr<BinaryTraceWriter>
+BinaryTraceHelper::CreateFile(std::string filename)
+{
+    NS_LOG_FUNCTION(filename);
+    Ptr<BinaryTraceWriter> file = Create<BinaryTraceWriter>(filename);
+    NS_ABORT_MSG_IF(file->Fail(), "Unable to Open " << filename << " for binary tracing");
+    return file;
+}
+
+void
+BinaryTraceHelper::DefaultSink(Ptr<BinaryTraceWriter> file,
+                               uint32_t node,
+                               uint32_t device,
+                               uint8_t kind,
+                               Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(file << node << device << +kind << p);
+    file->Write(Simulator::Now(), node, device, kind, p->GetUid(), p->GetSize());
+}
+
 void
 PcapHelperForDevice::EnablePcap(std::string prefix,
                                 Ptr<NetDevice> nd,
@@ -673,4 +703,77 @@ AsciiTraceHelperForDevice::EnableAsciiImpl(Ptr<OutputStreamWrapper> stream,
     }
 }
 
+void
+BinaryTraceHelperForDevice::EnableBinary(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd)
+{
+    EnableBinaryInternal(file, nd);
+}
+
+void
+BinaryTraceHelperForDevice::EnableBinary(Ptr<BinaryTraceWriter> file, std::string ndName)
+{
+    Ptr<NetDevice> nd = Names::Find<NetDevice>(ndName);
+    EnableBinary(file, nd);
+}
+
+void
+BinaryTraceHelperForDevice::EnableBinary(Ptr<BinaryTraceWriter> file, NetDeviceContainer d)
+{
+    for (auto i = d.Begin(); i != d.End(); ++i)
+    {
+        EnableBinary(file, *i);
+    }
+}
+
+void
+BinaryTraceHelperForDevice::EnableBinary(Ptr<BinaryTraceWriter> file, NodeContainer n)
+{
+    NetDeviceContainer devs;
+    for (auto i = n.Begin(); i != n.End(); ++i)
+    {
+        Ptr<Node> node = *i;
+        for (uint32_t j = 0; j < node->GetNDevices(); ++j)
+        {
+            devs.Add(node->GetDevice(j));
+        }
+    }
+    EnableBinary(file, devs);
+}
+
+void
+BinaryTraceHelperForDevice::EnableBinary(Ptr<BinaryTraceWriter> file,
+                                         uint32_t nodeid,
+                                         uint32_t deviceid)
+{
+    NodeContainer n = NodeContainer::GetGlobal();
+
+    for (auto i = n.Begin(); i != n.End(); ++i)
+    {
+        Ptr<Node> node = *i;
+        if (node->GetId() != nodeid)
+        {
+            continue;
+        }
+
+        NS_ABORT_MSG_IF(deviceid >= node->GetNDevices(),
+                        "BinaryTraceHelperForDevice::EnableBinary(): Unknown deviceid = "
+                            << deviceid);
+        EnableBinary(file, node->GetDevice(deviceid));
+        return;
+    }
+}
+
+void
+BinaryTraceHelperForDevice::EnableBinaryAll(Ptr<BinaryTraceWriter> file)
+{
+    EnableBinary(file, NodeContainer::GetGlobal());
+}
+
+void
+BinaryTraceHelperForDevice::EnableBinaryAll(std::string filename)
+{
+    BinaryTraceHelper binaryTraceHelper;
+    EnableBinaryAll(binaryTraceHelper.CreateFile(filename));
+}
+
 } // namespace ns3
@@ -11,6 +11,7 @@
 #include "node-container.h"
 
 #include "ns3/assert.h"
+#include "ns3/binary-trace.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/simulator.h"
@@ -605,6 +606,90 @@ AsciiTraceHelper::HookDefaultReceiveSinkWithContext(Ptr<T> object,
                       << tracename << "\"");
 }
 
+/**
+ * @brief Manage binary trace files for device models
+ *
+ * The binary traces record the same events as the ASCII traces, as typed
+ * records written to a single file for all the devices: see
+ * BinaryTraceWriter.
+ */
+class BinaryTraceHelper
+{
+  public:
+    /**
+     * @brief Create a binary trace helper.
+     */
+    BinaryTraceHelper();
+
+    /**
+     * @brief Destroy a binary trace helper.
+     */
+    ~BinaryTraceHelper();
+
+    /**
+     * @brief Create a binary trace file.
+     *
+     * As for the pcap files, the helper forgets about the file, which is
+     * kept alive by the callbacks of the trace sources hooked to it, and
+     * closed when the last of them is destroyed.
+     *
+     * @param filename file name
+     * @returns a smart pointer to the binary trace writer
+     */
+    Ptr<BinaryTraceWriter> CreateFile(std::string filename);
+
+    /**
+     * @brief Hook a trace source to the default trace sink, which records
+     * the events of a device.
+     *
+     * @param object object
+     * @param traceName trace source name
+     * @param file binary trace writer
+     * @param kind kind of the events, see BinaryTraceRecord::Kind
+     * @param device the device of the events
+     */
+    template <typename T>
+    void HookDefaultSink(Ptr<T> object,
+                         std::string traceName,
+                         Ptr<BinaryTraceWriter> file,
+                         uint8_t kind,
+                         Ptr<NetDevice> device);
+
+    /**
+     * @brief The default trace sink, which records an event of a device.
+     *
+     * @param file binary trace writer
+     * @param node the identifier of the node of the device
+     * @param device the index of the device in its node
+     * @param kind kind of the event, see BinaryTraceRecord::Kind
+     * @param p the packet
+     */
+    static void DefaultSink(Ptr<BinaryTraceWriter> file,
+                            uint32_t node,
+                            uint32_t device,
+                            uint8_t kind,
+                            Ptr<const Packet> p);
+};
+
+template <typename T>
+void
+BinaryTraceHelper::HookDefaultSink(Ptr<T> object,
+                                   std::string tracename,
+                                   Ptr<BinaryTraceWriter> file,
+                                   uint8_t kind,
+                                   Ptr<NetDevice> device)
+{
+    bool result = object->TraceConnectWithoutContext(tracename,
+                                                     MakeBoundCallback(&DefaultSink,
+                                                                       file,
+                                                                       device->GetNode()->GetId(),
+                                                                       device->GetIfIndex(),
+                                                                       kind));
+    NS_ASSERT_MSG(result == true,
+                  "BinaryTraceHelper::HookDefaultSink():  Unable to hook \"" << tracename
+                                                                               << "\"");
+}
+
 /**
  * @brief Base class providing common user-level pcap operations for helpers
  * representing net devices.
@@ -951,6 +1036,107 @@ class AsciiTraceHelperForDevice
                          bool explicitFilename);
 };
 
+/**
+ * @brief Base class providing common user-level binary trace operations for
+ * helpers representing net devices.
+ *
+ * The events of all the devices are written to a single binary trace file,
+ * each record identifying its node and device.
+ */
+class BinaryTraceHelperForDevice
+{
+  public:
+    /**
+     * @brief Construct a BinaryTraceHelperForDevice.
+     */
+    BinaryTraceHelperForDevice()
+    {
+    }
+
+    /**
+     * @brief Destroy a BinaryTraceHelperForDevice.
+     */
+    virtual ~BinaryTraceHelperForDevice()
+    {
+    }
+
+    /**
+     * @brief Enable binary trace output on the indicated net device.
+     *
+     * The implementation is expected to hook the trace sources of the
+     * device which provide the events of its ASCII traces, using the
+     * BinaryTraceHelper::HookDefaultSink function or its own sinks, and to
+     * ignore the devices which are not of its type.
+     *
+     * @param file The binary trace writer.
+     * @param nd Net device for which you want to enable tracing.
+     */
+    virtual void EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd) = 0;
+
+    /**
+     * @brief Enable binary trace output on the indicated net device.
+     *
+     * @param file The binary trace writer.
+     * @param nd Net device for which you want to enable tracing.
+     */
+    void EnableBinary(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd);
+
+    /**
+     * @brief Enable binary trace output on the indicated net device using a
+     * device previously named using the ns-3 object name service.
+     *
+     * @param file The binary trace writer.
+     * @param ndName The name of the net device in which you want to enable tracing.
+     */
+    void EnableBinary(Ptr<BinaryTraceWriter> file, std::string ndName);
+
+    /**
+     * @brief Enable binary trace output on each device in the container which
+     * is of the appropriate type.
+     *
+     * @param file The binary trace writer.
+     * @param d container of devices
+     */
+    void EnableBinary(Ptr<BinaryTraceWriter> file, NetDeviceContainer d);
+
+    /**
+     * @brief Enable binary trace output on each device (which is of the
+     * appropriate type) in the nodes provided in the container.
+     *
+     * @param file The binary trace writer.
+     * @param n container of nodes.
+     */
+    void EnableBinary(Ptr<BinaryTraceWriter> file, NodeContainer n);
+
+    /**
+     * @brief Enable binary trace output on the device specified by a global
+     * node-id (of a previously created node) and associated device-id.
+     *
+     * @param file The binary trace writer.
+     * @param nodeid The node identifier/number of the node on which to enable
+     *               binary tracing
+     * @param deviceid The device identifier/index of the device on which to enable
+     *               binary tracing
+     */
+    void EnableBinary(Ptr<BinaryTraceWriter> file, uint32_t nodeid, uint32_t deviceid);
+
+    /**
+     * @brief Enable binary trace output on each device (which is of the
+     * appropriate type) in the set of all nodes created in the simulation.
+     *
+     * @param file The binary trace writer.
+     */
+    void EnableBinaryAll(Ptr<BinaryTraceWriter> file);
+
+    /**
+     * @brief Enable binary trace output on each device (which is of the
+     * appropriate type) in the set of all nodes created in the simulation.
+     *
+     * @param filename The name of the binary trace file to create.
+     */
+    void EnableBinaryAll(std::string filename);
+};
+
 } // namespace ns3
 
 #endif /* TRACE_HELPER_H */
@@ -7,9 +7,13 @@
  */
 #include "buffer.h"
 
+#include "packet-allocator.h"
+
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
 #define LOG_INTERNAL_STATE(y)                                                                      \
     NS_LOG_LOGIC(y << "start=" << m_start << ", end=" << m_end                                     \
                    << ", zero start=" << m_zeroAreaStart << ", zero end=" << m_zeroAreaEnd         \
@@ -43,116 +47,47 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
-uint32_t Buffer::g_recommendedStart = 0;
-#ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long)0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED(x) && !IS_DESTROYED(x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList* Buffer::g_freeList = nullptr;
-Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor()
-{
-    NS_LOG_FUNCTION(this);
-    if (IS_INITIALIZED(g_freeList))
-    {
-        for (auto i = g_freeList->begin(); i != g_freeList->end(); i++)
-        {
-            Buffer::Deallocate(*i);
-        }
-        delete g_freeList;
-        g_freeList = DESTROYED;
-    }
-}
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 
-void
-Buffer::Recycle(Buffer::Data* data)
-{
-    NS_LOG_FUNCTION(data);
-    NS_ASSERT(data->m_count == 0);
-    NS_ASSERT(!IS_UNINITIALIZED(g_freeList));
-    g_maxSize = std::max(g_maxSize, data->m_size);
-    /* feed into free list */
-    if (data->m_size < g_maxSize || IS_DESTROYED(g_freeList) || g_freeList->size() > 1000)
-    {
-        Buffer::Deallocate(data);
-    }
-    else
-    {
-        NS_ASSERT(IS_INITIALIZED(g_freeList));
-        g_freeList->push_back(data);
-    }
-}
+constexpr uint32_t ALLOC_OVER_PROVISION = 100; //!< Additional bytes to over-provision.
 
-Buffer::Data*
-Buffer::Create(uint32_t dataSize)
-{
-    NS_LOG_FUNCTION(dataSize);
-    /* try to find a buffer correctly sized. */
-    if (IS_UNINITIALIZED(g_freeList))
-    {
-        g_freeList = new Buffer::FreeList();
-    }
-    else if (IS_INITIALIZED(g_freeList))
-    {
-        while (!g_freeList->empty())
-        {
-            Buffer::Data* data = g_freeList->back();
-            g_freeList->pop_back();
-            if (data->m_size >= dataSize)
-            {
-                data->m_count = 1;
-                return data;
-            }
-            Buffer::Deallocate(data);
-        }
-    }
-    Buffer::Data* data = Buffer::Allocate(dataSize);
-    NS_ASSERT(data->m_count == 1);
-    return data;
-}
-#else  /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle(Buffer::Data* data)
 {
     NS_LOG_FUNCTION(data);
     NS_ASSERT(data->m_count == 0);
-    Deallocate(data);
+    uint32_t size = data->m_size - 1 + sizeof(Buffer::Data);
+    data->~Data();
+    PacketAllocator::Deallocate(data, size);
 }
 
-Buffer::Data*
-Buffer::Create(uint32_t size)
+Buffer::Holes*
+Buffer::CreateHoles(uint32_t size)
 {
     NS_LOG_FUNCTION(size);
-    return Allocate(size);
+    NS_ASSERT(size >= 1);
+    uint32_t bytes = sizeof(Buffer::Holes) + (size - 1) * sizeof(Buffer::Hole);
+    auto holes = new (PacketAllocator::Allocate(bytes)) Buffer::Holes;
+    holes->m_count.store(1, std::memory_order_relaxed);
+    holes->m_size = size;
+    // use the whole block
+    holes->m_capacity =
+        (PacketAllocator::GetCapacity(bytes) - sizeof(Buffer::Holes)) / sizeof(Buffer::Hole) + 1;
+    return holes;
 }
-#endif /* BUFFER_FREE_LIST */
 
-constexpr uint32_t ALLOC_OVER_PROVISION = 100; //!< Additional bytes to over-provision.
+void
+Buffer::RecycleHoles(Buffer::Holes* holes)
+{
+    NS_LOG_FUNCTION(holes);
+    NS_ASSERT(holes->m_count == 0);
+    uint32_t size = sizeof(Buffer::Holes) + (holes->m_capacity - 1) * sizeof(Buffer::Hole);
+    holes->~Holes();
+    PacketAllocator::Deallocate(holes, size);
+}
 
 Buffer::Data*
-Buffer::Allocate(uint32_t reqSize)
+Buffer::Create(uint32_t reqSize)
 {
     NS_LOG_FUNCTION(reqSize);
     if (reqSize == 0)
@@ -162,22 +97,13 @@ Buffer::Allocate(uint32_t reqSize)
     NS_ASSERT(reqSize >= 1);
     reqSize += ALLOC_OVER_PROVISION;
     uint32_t size = reqSize - 1 + sizeof(Buffer::Data);
-    auto b = new uint8_t[size];
-    auto data = reinterpret_cast<Buffer::Data*>(b);
-    data->m_size = reqSize;
-    data->m_count = 1;
+    auto data = new (PacketAllocator::Allocate(size)) Buffer::Data;
+    // use the whole block
+    data->m_size = PacketAllocator::GetCapacity(size) + 1 - sizeof(Buffer::Data);
+    data->m_count.store(1, std::memory_order_relaxed);
     return data;
 }
 
-void
-Buffer::Deallocate(Buffer::Data* data)
-{
-    NS_LOG_FUNCTION(data);
-    NS_ASSERT(data->m_count == 0);
-    auto buf = reinterpret_cast<uint8_t*>(data);
-    delete[] buf;
-}
-
 Buffer::Buffer()
 {
     NS_LOG_FUNCTION(this);
@@ -214,18 +140,32 @@ Buffer::CheckInternalState() const
     m_zeroAreaEnd <= m_end;
   bool dirtyOk =
     m_start >= m_data->m_dirtyStart &&
-    m_end <= m_data->m_dirtyEnd;
-  bool internalSizeOk = m_end - (m_zeroAreaEnd - m_zeroAreaStart) <= m_data->m_size &&
+    GetInternalEnd() <= m_data->m_dirtyEnd;
+  bool internalSizeOk = m_end - GetZeroAreaSize() <= m_data->m_size &&
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
 
-  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk;
+  bool holesOk = m_holes == nullptr ||
+    (m_holes->m_count > 0 && m_holes->m_size >= 2 &&
+     m_holes->m_holes[0].start == m_zeroAreaStart &&
+     m_holes->m_holes[0].end == m_zeroAreaEnd &&
+     m_holes->m_holes[m_holes->m_size - 1].end <= m_end);
+  for (uint32_t i = 1; holesOk && m_holes != nullptr && i < m_holes->m_size; i++)
+    {
+      const Hole& previous = m_holes->m_holes[i - 1];
+      const Hole& hole = m_holes->m_holes[i];
+      holesOk = previous.end < hole.start && hole.start < hole.end &&
+        hole.shift == previous.shift + previous.end - previous.start;
+    }
+
+  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk && holesOk;
   if (!ok)
     {
       LOG_INTERNAL_STATE ("check " << this <<
                           ", " << (offsetsOk ? "true" : "false") <<
                           ", " << (dirtyOk ? "true" : "false") <<
-                          ", " << (internalSizeOk ? "true" : "false") << " ");
+                          ", " << (internalSizeOk ? "true" : "false") <<
+                          ", " << (holesOk ? "true" : "false") << " ");
     }
   return ok;
 #else
@@ -238,13 +178,14 @@ Buffer::Initialize(uint32_t zeroSize)
 {
     NS_LOG_FUNCTION(this << zeroSize);
     m_data = Buffer::Create(0);
+    m_holes = nullptr;
     m_start = std::min(m_data->m_size, g_recommendedStart);
     m_maxZeroAreaStart = m_start;
     m_zeroAreaStart = m_start;
     m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
     m_end = m_zeroAreaEnd;
-    m_data->m_dirtyStart = m_start;
-    m_data->m_dirtyEnd = m_end;
+    m_data->m_dirtyStart.store(m_start, std::memory_order_relaxed);
+    m_data->m_dirtyEnd.store(m_end, std::memory_order_relaxed);
     NS_ASSERT(CheckInternalState());
 }
 
@@ -255,13 +196,21 @@ Buffer::operator=(const Buffer& o)
     if (m_data != o.m_data)
     {
         // not assignment to self.
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (PacketAllocator::Unref(m_data->m_count))
         {
             Recycle(m_data);
         }
         m_data = o.m_data;
-        m_data->m_count++;
+        PacketAllocator::Ref(m_data->m_count);
+    }
+    if (m_holes != o.m_holes)
+    {
+        if (o.m_holes != nullptr)
+        {
+            PacketAllocator::Ref(o.m_holes->m_count);
+        }
+        SetHoles(nullptr);
+        m_holes = o.m_holes;
     }
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
     m_maxZeroAreaStart = o.m_maxZeroAreaStart;
@@ -278,25 +227,111 @@ Buffer::~Buffer()
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (PacketAllocator::Unref(m_data->m_count))
     {
         Recycle(m_data);
     }
+    SetHoles(nullptr);
 }
 
 uint32_t
 Buffer::GetInternalSize() const
 {
     NS_LOG_FUNCTION(this);
-    return m_zeroAreaStart - m_start + m_end - m_zeroAreaEnd;
+    return m_end - m_start - GetZeroAreaSize();
 }
 
 uint32_t
 Buffer::GetInternalEnd() const
 {
     NS_LOG_FUNCTION(this);
-    return m_end - (m_zeroAreaEnd - m_zeroAreaStart);
+    return m_end - GetZeroAreaSize();
+}
+
+uint32_t
+Buffer::GetZeroAreaSize() const
+{
+    NS_LOG_FUNCTION(this);
+    if (m_holes == nullptr)
+    {
+        return m_zeroAreaEnd - m_zeroAreaStart;
+    }
+    const Hole& last = m_holes->m_holes[m_holes->m_size - 1];
+    return last.shift + last.end - last.start;
+}
+
+void
+Buffer::SetHoles(Holes* holes)
+{
+    NS_LOG_FUNCTION(this << holes);
+    if (m_holes != nullptr && PacketAllocator::Unref(m_holes->m_count))
+    {
+        RecycleHoles(m_holes);
+    }
+    m_holes = nullptr;
+    if (holes == nullptr)
+    {
+        return;
+    }
+    if (holes->m_size >= 1)
+    {
+        m_zeroAreaStart = holes->m_holes[0].start;
+        m_zeroAreaEnd = holes->m_holes[0].end;
+    }
+    if (holes->m_size >= 2)
+    {
+        m_holes = holes;
+    }
+    else
+    {
+        holes->m_count.store(0, std::memory_order_relaxed);
+        RecycleHoles(holes);
+    }
+}
+
+void
+Buffer::MoveHoles(int32_t delta)
+{
+    NS_LOG_FUNCTION(this << delta);
+    if (m_holes == nullptr)
+    {
+        return;
+    }
+    Holes* holes = CreateHoles(m_holes->m_size);
+    for (uint32_t i = 0; i < m_holes->m_size; i++)
+    {
+        const Hole& hole = m_holes->m_holes[i];
+        holes->m_holes[i] = {hole.start + delta, hole.end + delta, hole.shift};
+    }
+    SetHoles(holes);
+}
+
+bool
+Buffer::ClaimAtStart(uint32_t start)
+{
+    NS_LOG_FUNCTION(this << start);
+    if (m_data->m_count.load(std::memory_order_acquire) == 1)
+    {
+        m_data->m_dirtyStart.store(m_start - start, std::memory_order_relaxed);
+        return true;
+    }
+    /* The other buffers sharing the data may belong to other threads:
+     * the bytes before m_start are free only if no buffer has used them
+     * yet, and they must be claimed atomically.
+     */
+    return PacketAllocator::Claim<uint32_t>(m_data->m_dirtyStart, m_start, m_start - start);
+}
+
+bool
+Buffer::ClaimAtEnd(uint32_t end)
+{
+    NS_LOG_FUNCTION(this << end);
+    if (m_data->m_count.load(std::memory_order_acquire) == 1)
+    {
+        m_data->m_dirtyEnd.store(m_end + end, std::memory_order_relaxed);
+        return true;
+    }
+    return PacketAllocator::Claim<uint32_t>(m_data->m_dirtyEnd, m_end, m_end + end);
 }
 
 void
@@ -304,26 +339,21 @@ Buffer::AddAtStart(uint32_t start)
 {
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
-    bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
-    if (m_start >= start && !isDirty)
+    if (m_start >= start && ClaimAtStart(start))
     {
         /* enough space in the buffer and not dirty.
          * To add: |..|
          * Before: |*****---------***|
          * After:  |***..---------***|
          */
-        NS_ASSERT(m_data->m_count == 1 || m_start == m_data->m_dirtyStart);
         m_start -= start;
-        // update dirty area
-        m_data->m_dirtyStart = m_start;
     }
     else
     {
         uint32_t newSize = GetInternalSize() + start;
         Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (PacketAllocator::Unref(m_data->m_count))
         {
             Buffer::Recycle(m_data);
         }
@@ -335,10 +365,11 @@ Buffer::AddAtStart(uint32_t start)
         m_zeroAreaEnd += delta;
         m_end += delta;
         m_start -= start;
+        MoveHoles(delta);
 
         // update dirty area
-        m_data->m_dirtyStart = m_start;
-        m_data->m_dirtyEnd = m_end;
+        m_data->m_dirtyStart.store(m_start, std::memory_order_relaxed);
+        m_data->m_dirtyEnd.store(m_end, std::memory_order_relaxed);
     }
     m_maxZeroAreaStart = std::max(m_maxZeroAreaStart, m_zeroAreaStart);
     LOG_INTERNAL_STATE("add start=" << start << ", ");
@@ -350,26 +381,21 @@ Buffer::AddAtEnd(uint32_t end)
 {
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
-    bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
-    if (GetInternalEnd() + end <= m_data->m_size && !isDirty)
+    if (GetInternalEnd() + end <= m_data->m_size && ClaimAtEnd(end))
     {
         /* enough space in buffer and not dirty
          * Add:    |...|
          * Before: |**----*****|
          * After:  |**----...**|
          */
-        NS_ASSERT(m_data->m_count == 1 || m_end == m_data->m_dirtyEnd);
         m_end += end;
-        // update dirty area.
-        m_data->m_dirtyEnd = m_end;
     }
     else
     {
         uint32_t newSize = GetInternalSize() + end;
         Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (PacketAllocator::Unref(m_data->m_count))
         {
             Buffer::Recycle(m_data);
         }
@@ -381,10 +407,11 @@ Buffer::AddAtEnd(uint32_t end)
         m_end += delta;
         m_start += delta;
         m_end += end;
+        MoveHoles(delta);
 
         // update dirty area
-        m_data->m_dirtyStart = m_start;
-        m_data->m_dirtyEnd = m_end;
+        m_data->m_dirtyStart.store(m_start, std::memory_order_relaxed);
+        m_data->m_dirtyEnd.store(m_end, std::memory_order_relaxed);
     }
     m_maxZeroAreaStart = std::max(m_maxZeroAreaStart, m_zeroAreaStart);
     LOG_INTERNAL_STATE("add end=" << end << ", ");
@@ -396,8 +423,16 @@ Buffer::AddAtEnd(const Buffer& o)
 {
     NS_LOG_FUNCTION(this << &o);
 
-    if (m_data->m_count == 1 && (m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
-        m_end == m_data->m_dirtyEnd && o.m_start == o.m_zeroAreaStart &&
+    if (&o == this)
+    {
+        Buffer copy = o;
+        AddAtEnd(copy);
+        return;
+    }
+
+    if (m_data->m_count.load(std::memory_order_acquire) == 1 && m_holes == nullptr &&
+        (m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
+        m_end == m_data->m_dirtyEnd && o.m_holes == nullptr && o.m_start == o.m_zeroAreaStart &&
         o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
         /**
@@ -412,7 +447,7 @@ Buffer::AddAtEnd(const Buffer& o)
         uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
         m_zeroAreaEnd = m_end + zeroSize;
         m_end = m_zeroAreaEnd;
-        m_data->m_dirtyEnd = m_zeroAreaEnd;
+        m_data->m_dirtyEnd.store(m_zeroAreaEnd, std::memory_order_relaxed);
         uint32_t endData = o.m_end - o.m_zeroAreaEnd;
         AddAtEnd(endData);
         Buffer::Iterator dst = End();
@@ -424,11 +459,63 @@ Buffer::AddAtEnd(const Buffer& o)
         return;
     }
 
-    *this = CreateFullCopy();
-    AddAtEnd(o.GetSize());
-    Buffer::Iterator destStart = End();
-    destStart.Prev(o.GetSize());
-    destStart.Write(o.Begin(), o.End());
+    /* Append the real bytes of o to the real bytes of this buffer,
+     * and the zero areas of o to the zero areas of this buffer.
+     */
+    uint32_t realSize = o.GetInternalSize();
+    AddAtEnd(realSize);
+    memcpy(m_data->m_data + GetInternalEnd() - realSize, o.m_data->m_data + o.m_start, realSize);
+
+    Hole primary = {m_zeroAreaStart, m_zeroAreaEnd, 0};
+    const Hole* holes = m_holes != nullptr ? m_holes->m_holes : &primary;
+    uint32_t size = m_holes != nullptr ? m_holes->m_size : (m_zeroAreaEnd > m_zeroAreaStart);
+    Hole otherPrimary = {o.m_zeroAreaStart, o.m_zeroAreaEnd, 0};
+    const Hole* otherHoles = o.m_holes != nullptr ? o.m_holes->m_holes : &otherPrimary;
+    uint32_t otherSize =
+        o.m_holes != nullptr ? o.m_holes->m_size : (o.m_zeroAreaEnd > o.m_zeroAreaStart);
+    if (otherSize == 0)
+    {
+        NS_ASSERT(CheckInternalState());
+        return;
+    }
+
+    // offset of the first byte of o in this buffer
+    uint32_t start = m_end - realSize;
+    bool merge = size > 0 && holes[size - 1].end == start && otherHoles[0].start == o.m_start;
+    uint32_t zeroSize = GetZeroAreaSize();
+    Holes* newHoles;
+    if (m_holes != nullptr && m_holes->m_count.load(std::memory_order_acquire) == 1 &&
+        size + otherSize - merge <= m_holes->m_capacity)
+    {
+        // the zero areas are not shared: append in place
+        newHoles = m_holes;
+        m_holes = nullptr;
+        newHoles->m_size = size + otherSize - merge;
+    }
+    else
+    {
+        newHoles = CreateHoles(size + otherSize - merge);
+        std::copy(holes, holes + size, newHoles->m_holes);
+    }
+    for (uint32_t i = 0; i < otherSize; i++)
+    {
+        const Hole& hole = otherHoles[i];
+        uint32_t holeStart = start + hole.start - o.m_start;
+        uint32_t holeEnd = start + hole.end - o.m_start;
+        if (i == 0 && merge)
+        {
+            newHoles->m_holes[size - 1].end = holeEnd;
+        }
+        else
+        {
+            newHoles->m_holes[size + i - merge] = {holeStart, holeEnd, zeroSize};
+        }
+        zeroSize += hole.end - hole.start;
+    }
+    m_end = start + o.GetSize();
+    SetHoles(newHoles);
+    m_maxZeroAreaStart = std::max(m_maxZeroAreaStart, m_zeroAreaStart);
+    LOG_INTERNAL_STATE("add buffer, ");
     NS_ASSERT(CheckInternalState());
 }
 
@@ -438,7 +525,49 @@ Buffer::RemoveAtStart(uint32_t start)
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
     uint32_t newStart = m_start + start;
-    if (newStart <= m_zeroAreaStart)
+    if (m_holes != nullptr && newStart > m_zeroAreaStart)
+    {
+        /* remove start of buffer and the zero areas before the new
+         * start: the offsets are moved so that no zero byte is left
+         * before the start.
+         */
+        newStart = std::min(newStart, m_end);
+        const Hole* holes = m_holes->m_holes;
+        const Hole* first = std::upper_bound(holes,
+                                             holes + m_holes->m_size,
+                                             newStart,
+                                             [](uint32_t offset, const Hole& hole) {
+                                                 return offset < hole.end;
+                                             });
+        uint32_t size = holes + m_holes->m_size - first;
+        uint32_t zeroSize = GetZeroAreaSize();
+        if (size > 0)
+        {
+            zeroSize = first->shift + (newStart > first->start ? newStart - first->start : 0);
+        }
+        m_start = newStart - zeroSize;
+        m_end -= zeroSize;
+        if (size == 0)
+        {
+            m_zeroAreaStart = m_start;
+            m_zeroAreaEnd = m_start;
+            SetHoles(nullptr);
+        }
+        else
+        {
+            Holes* newHoles = CreateHoles(size);
+            uint32_t shift = 0;
+            for (uint32_t i = 0; i < size; i++)
+            {
+                uint32_t holeStart = std::max(first[i].start, newStart) - zeroSize;
+                uint32_t holeEnd = first[i].end - zeroSize;
+                newHoles->m_holes[i] = {holeStart, holeEnd, shift};
+                shift += holeEnd - holeStart;
+            }
+            SetHoles(newHoles);
+        }
+    }
+    else if (newStart <= m_zeroAreaStart)
     {
         /* only remove start of buffer
          */
@@ -484,7 +613,33 @@ Buffer::RemoveAtEnd(uint32_t end)
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
     uint32_t newEnd = m_end - std::min(end, m_end - m_start);
-    if (newEnd > m_zeroAreaEnd)
+    if (m_holes != nullptr && newEnd < m_holes->m_holes[m_holes->m_size - 1].end)
+    {
+        /* remove end of buffer and the zero areas after the new end */
+        const Hole* holes = m_holes->m_holes;
+        const Hole* last = std::lower_bound(holes,
+                                            holes + m_holes->m_size,
+                                            newEnd,
+                                            [](const Hole& hole, uint32_t offset) {
+                                                return hole.start < offset;
+                                            });
+        uint32_t size = last - holes;
+        m_end = newEnd;
+        if (size == 0)
+        {
+            m_zeroAreaEnd = newEnd;
+            m_zeroAreaStart = newEnd;
+            SetHoles(nullptr);
+        }
+        else
+        {
+            Holes* newHoles = CreateHoles(size);
+            std::copy(holes, last, newHoles->m_holes);
+            newHoles->m_holes[size - 1].end = std::min(newHoles->m_holes[size - 1].end, newEnd);
+            SetHoles(newHoles);
+        }
+    }
+    else if (newEnd > m_zeroAreaEnd)
     {
         /* remove part of end of buffer */
         m_end = newEnd;
@@ -531,6 +686,14 @@ Buffer::CreateFullCopy() const
 {
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
+    if (m_holes != nullptr)
+    {
+        Buffer tmp;
+        tmp.AddAtStart(GetSize());
+        CopyData(tmp.m_data->m_data + tmp.m_start, GetSize());
+        NS_ASSERT(tmp.CheckInternalState());
+        return tmp;
+    }
     if (m_zeroAreaEnd - m_zeroAreaStart != 0)
     {
         Buffer tmp;
@@ -625,7 +788,16 @@ Buffer::Serialize(uint8_t* buffer, uint32_t maxSize) const
         return 0;
     }
 
-    memcpy(p, m_data->m_data + m_zeroAreaStart, dataEndLength);
+    if (m_holes == nullptr)
+    {
+        memcpy(p, m_data->m_data + m_zeroAreaStart, dataEndLength);
+    }
+    else
+    {
+        // only the first zero area is kept virtual
+        CreateFragment(m_zeroAreaEnd - m_start, dataEndLength)
+            .CopyData(reinterpret_cast<uint8_t*>(p), dataEndLength);
+    }
     // The following line is unnecessary.
     // p += (((dataEndLength + 3) & (~3))/4); // Advance p, insuring 4 byte boundary
 
@@ -702,28 +874,25 @@ void
 Buffer::CopyData(std::ostream* os, uint32_t size) const
 {
     NS_LOG_FUNCTION(this << &os << size);
-    if (size > 0)
+    Hole primary = {m_zeroAreaStart, m_zeroAreaEnd, 0};
+    const Hole* holes = m_holes != nullptr ? m_holes->m_holes : &primary;
+    uint32_t nHoles = m_holes != nullptr ? m_holes->m_size : 1;
+    uint32_t current = m_start;
+    uint32_t end = m_start + std::min(size, GetSize());
+    for (uint32_t i = 0; i <= nHoles && current < end; i++)
     {
-        uint32_t tmpsize = std::min(m_zeroAreaStart - m_start, size);
-        os->write((const char*)(m_data->m_data + m_start), tmpsize);
-        if (size > tmpsize)
+        uint32_t zeroStart = i < nHoles ? std::min(holes[i].start, end) : end;
+        uint32_t zeroEnd = i < nHoles ? std::min(holes[i].end, end) : end;
+        uint32_t shift = i < nHoles ? holes[i].shift : GetZeroAreaSize();
+        os->write((const char*)(m_data->m_data + current - shift), zeroStart - current);
+        uint32_t left = zeroEnd - zeroStart;
+        while (left > 0)
         {
-            size -= m_zeroAreaStart - m_start;
-            tmpsize = std::min(m_zeroAreaEnd - m_zeroAreaStart, size);
-            uint32_t left = tmpsize;
-            while (left > 0)
-            {
-                uint32_t toWrite = std::min(left, g_zeroes.size);
-                os->write(g_zeroes.buffer, toWrite);
-                left -= toWrite;
-            }
-            if (size > tmpsize)
-            {
-                size -= tmpsize;
-                tmpsize = std::min(m_end - m_zeroAreaEnd, size);
-                os->write((const char*)(m_data->m_data + m_zeroAreaStart), tmpsize);
-            }
+            uint32_t toWrite = std::min(left, g_zeroes.size);
+            os->write(g_zeroes.buffer, toWrite);
+            left -= toWrite;
         }
+        current = zeroEnd;
     }
 }
 
@@ -731,34 +900,9 @@ uint32_t
 Buffer::CopyData(uint8_t* buffer, uint32_t size) const
 {
     NS_LOG_FUNCTION(this << &buffer << size);
-    uint32_t originalSize = size;
-    if (size > 0)
-    {
-        uint32_t tmpsize = std::min(m_zeroAreaStart - m_start, size);
-        memcpy(buffer, (const char*)(m_data->m_data + m_start), tmpsize);
-        buffer += tmpsize;
-        size -= tmpsize;
-        if (size > 0)
-        {
-            tmpsize = std::min(m_zeroAreaEnd - m_zeroAreaStart, size);
-            uint32_t left = tmpsize;
-            while (left > 0)
-            {
-                uint32_t toWrite = std::min(left, g_zeroes.size);
-                memcpy(buffer, g_zeroes.buffer, toWrite);
-                left -= toWrite;
-                buffer += toWrite;
-            }
-            size -= tmpsize;
-            if (size > 0)
-            {
-                tmpsize = std::min(m_end - m_zeroAreaEnd, size);
-                memcpy(buffer, (const char*)(m_data->m_data + m_zeroAreaStart), tmpsize);
-                size -= tmpsize;
-            }
-        }
-    }
-    return originalSize - size;
+    size = std::min(size, GetSize());
+    Begin().Read(buffer, size);
+    return size;
 }
 
 /******************************************************
@@ -799,6 +943,18 @@ bool
 Buffer::Iterator::CheckNoZero(uint32_t start, uint32_t end) const
 {
     NS_LOG_FUNCTION(this << &start << &end);
+    if (m_holes != nullptr)
+    {
+        for (uint32_t i = 0; i < m_holes->m_size; i++)
+        {
+            const Hole& hole = m_holes->m_holes[i];
+            if (end > hole.start && start < hole.end && start != end)
+            {
+                return false;
+            }
+        }
+        return start >= m_dataStart && end <= m_dataEnd;
+    }
     return !(start < m_dataStart || end > m_dataEnd ||
              (end > m_zeroStart && start < m_zeroEnd && m_zeroEnd != m_zeroStart && start != end));
 }
@@ -807,41 +963,81 @@ bool
 Buffer::Iterator::Check(uint32_t i) const
 {
     NS_LOG_FUNCTION(this << &i);
+    if (m_holes != nullptr)
+    {
+        return CheckNoZero(i, i + 1) || i == m_dataEnd;
+    }
     return i >= m_dataStart && !(i >= m_zeroStart && i < m_zeroEnd) && i <= m_dataEnd;
 }
 
+uint8_t*
+Buffer::Iterator::SlowGetPointer(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    if (m_holes != nullptr)
+    {
+        MoveWindow();
+    }
+    uint8_t* buffer = GetPointer(size);
+    if (buffer == nullptr && (size == 0 || m_zeroStart == m_zeroEnd))
+    {
+        // the bytes do not overlap the zero area
+        return &m_data[m_current - m_shift];
+    }
+    return buffer;
+}
+
+void
+Buffer::Iterator::MoveWindow()
+{
+    NS_LOG_FUNCTION(this);
+    const Hole* holes = m_holes->m_holes;
+    uint32_t size = m_holes->m_size;
+    const Hole* hole = std::upper_bound(holes,
+                                        holes + size - 1,
+                                        m_current,
+                                        [](uint32_t offset, const Hole& hole) {
+                                            return offset < hole.end;
+                                        });
+    m_zeroStart = hole->start;
+    m_zeroEnd = hole->end;
+    m_shift = hole->shift;
+    m_windowStart = hole == holes ? 0 : (hole - 1)->end;
+    m_windowEnd = hole == holes + size - 1 ? UINT32_MAX : (hole + 1)->start;
+}
+
+uint8_t
+Buffer::Iterator::SlowPeekU8()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_holes != nullptr)
+    {
+        MoveWindow();
+    }
+    if (m_current >= m_zeroStart && m_current < m_zeroEnd)
+    {
+        return 0;
+    }
+    return *GetPointer(1);
+}
+
 void
 Buffer::Iterator::Write(Iterator start, Iterator end)
 {
     NS_LOG_FUNCTION(this << &start << &end);
     NS_ASSERT(start.m_data == end.m_data);
     NS_ASSERT(start.m_current <= end.m_current);
-    NS_ASSERT(start.m_zeroStart == end.m_zeroStart);
-    NS_ASSERT(start.m_zeroEnd == end.m_zeroEnd);
+    NS_ASSERT(start.m_holes == end.m_holes);
     NS_ASSERT(m_data != start.m_data);
     uint32_t size = end.m_current - start.m_current;
     NS_ASSERT_MSG(CheckNoZero(m_current, m_current + size), GetWriteErrorMessage());
-    if (start.m_current <= start.m_zeroStart)
+    uint8_t* to = GetPointer(size);
+    if (to == nullptr)
     {
-        uint32_t toCopy = std::min(size, start.m_zeroStart - start.m_current);
-        memcpy(&m_data[m_current], &start.m_data[start.m_current], toCopy);
-        start.m_current += toCopy;
-        m_current += toCopy;
-        size -= toCopy;
+        to = SlowGetPointer(size);
     }
-    if (start.m_current <= start.m_zeroEnd)
-    {
-        uint32_t toCopy = std::min(size, start.m_zeroEnd - start.m_current);
-        memset(&m_data[m_current], 0, toCopy);
-        start.m_current += toCopy;
-        m_current += toCopy;
-        size -= toCopy;
-    }
-    uint32_t toCopy = std::min(size, start.m_dataEnd - start.m_current);
-    uint8_t* from = &start.m_data[start.m_current - (start.m_zeroEnd - start.m_zeroStart)];
-    uint8_t* to = &m_data[m_current];
-    memcpy(to, from, toCopy);
-    m_current += toCopy;
+    start.Read(to, size);
+    m_current += size;
 }
 
 void
@@ -937,15 +1133,11 @@ void
 Buffer::Iterator::Write(const uint8_t* buffer, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &buffer << size);
-    NS_ASSERT_MSG(CheckNoZero(m_current, size), GetWriteErrorMessage());
-    uint8_t* to;
-    if (m_current <= m_zeroStart)
-    {
-        to = &m_data[m_current];
-    }
-    else
+    NS_ASSERT_MSG(CheckNoZero(m_current, m_current + size), GetWriteErrorMessage());
+    uint8_t* to = GetPointer(size);
+    if (to == nullptr)
     {
-        to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        to = SlowGetPointer(size);
     }
     memcpy(to, buffer, size);
     m_current += size;
@@ -1114,9 +1306,33 @@ void
 Buffer::Iterator::Read(uint8_t* buffer, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &buffer << size);
-    for (uint32_t i = 0; i < size; i++)
+    NS_ASSERT_MSG(m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                  GetReadErrorMessage());
+    while (size > 0)
     {
-        buffer[i] = ReadU8();
+        if (m_current < m_windowStart || m_current >= m_windowEnd)
+        {
+            MoveWindow();
+        }
+        uint32_t toCopy;
+        if (m_current < m_zeroStart)
+        {
+            toCopy = std::min(size, m_zeroStart - m_current);
+            memcpy(buffer, &m_data[m_current - m_shift], toCopy);
+        }
+        else if (m_current < m_zeroEnd)
+        {
+            toCopy = std::min(size, m_zeroEnd - m_current);
+            memset(buffer, 0, toCopy);
+        }
+        else
+        {
+            toCopy = std::min(size, m_windowEnd - m_current);
+            memcpy(buffer, &m_data[m_current - m_shift - (m_zeroEnd - m_zeroStart)], toCopy);
+        }
+        m_current += toCopy;
+        buffer += toCopy;
+        size -= toCopy;
     }
 }
 
@@ -1200,7 +1416,7 @@ Buffer::Iterator::GetWriteErrorMessage() const
     }
     else
     {
-        NS_ASSERT(m_current >= m_zeroStart && m_current < m_zeroEnd);
+        NS_ASSERT(!Check(m_current));
         str = "You have attempted to write inside the payload area of the "
               "buffer. This usually indicates that your Serialize method uses more "
               "buffer space than what your GetSerialized method returned.";
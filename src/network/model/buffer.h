@@ -8,13 +8,13 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
+#include "packet-allocator.h"
+
 #include "ns3/assert.h"
 
+#include <atomic>
 #include <ostream>
 #include <stdint.h>
-#include <vector>
-
-#define BUFFER_FREE_LIST 1
 
 namespace ns3
 {
@@ -47,7 +47,9 @@ namespace ns3
  * safe to modify the content of a BufferData if the modification
  * falls outside of the "dirty area" defined by the BufferData.
  * In every other case, the BufferData must be copied before
- * being modified.
+ * being modified.  The Buffer instances sharing a BufferData may
+ * belong to different threads, so the reference count is atomic and
+ * the dirty area is extended with an atomic compare-and-swap.
  *
  * To understand the way the Buffer::Add and Buffer::Remove methods
  * work, you first need to understand the "virtual offsets" used to
@@ -78,9 +80,26 @@ namespace ns3
  * @endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * Appending a buffer which contains virtual zero bytes to another one
+ * (e.g., when aggregating packets) does not allocate memory for them
+ * either: the zero areas of both buffers are kept, and the buffer then
+ * contains several zero areas, interleaved with real bytes. The first
+ * one is still described by m_zeroAreaStart and m_zeroAreaEnd, and all
+ * of them are recorded in a table of zero areas, Buffer::Holes, which is
+ * shared and reference-counted like Buffer::Data. The table is never
+ * modified once created: the operations which change the zero areas of a
+ * buffer which has several of them (removing a zero area, fragmenting,
+ * appending) create a new table, in a time proportional to the number of
+ * zero areas, while the real bytes stay shared. The real bytes before
+ * each zero area are stored contiguously, so that the real byte of the
+ * virtual offset i is stored at i minus the size of the zero areas
+ * before i.
  */
 class Buffer
 {
+    struct Holes;
+
   public:
     /**
      * @brief iterator in a Buffer instance
@@ -393,6 +412,34 @@ class Buffer
          * @param buffer the buffer this iterator refers to
          */
         inline void Construct(const Buffer* buffer);
+        /**
+         * Get the real bytes at the current position.
+         *
+         * @param size the number of bytes
+         * @returns a pointer to the bytes, or nullptr if the bytes are not
+         *          all real bytes of the zero area window.
+         */
+        inline uint8_t* GetPointer(uint32_t size) const;
+        /**
+         * Get the real bytes at the current position, moving the zero area
+         * window if needed.
+         *
+         * @param size the number of bytes
+         * @returns a pointer to the bytes, or nullptr if they are not all
+         *          real bytes.
+         */
+        uint8_t* SlowGetPointer(uint32_t size);
+        /**
+         * Move the zero area window to the zero area which follows the
+         * current position, or to the last zero area after it.
+         */
+        void MoveWindow();
+        /**
+         * @return the byte at the current position.
+         *
+         * @warning this is the slow version, please use PeekU8 ()
+         */
+        uint8_t SlowPeekU8();
         /**
          * Checks that the [start, end) is not in the "virtual zero area".
          *
@@ -444,14 +491,29 @@ class Buffer
 
         /**
          * offset in virtual bytes from the start of the data buffer to the
-         * start of the "virtual zero area".
+         * start of the "virtual zero area" of the window.
          */
         uint32_t m_zeroStart;
         /**
          * offset in virtual bytes from the start of the data buffer to the
-         * end of the "virtual zero area".
+         * end of the "virtual zero area" of the window.
          */
         uint32_t m_zeroEnd;
+        /**
+         * offset in virtual bytes from the start of the data buffer to the
+         * start of the window, i.e., the end of the previous zero area.
+         * The window covers the real bytes around a single zero area.
+         */
+        uint32_t m_windowStart;
+        /**
+         * offset in virtual bytes from the start of the data buffer to the
+         * end of the window, i.e., the start of the next zero area.
+         */
+        uint32_t m_windowEnd;
+        /**
+         * size of the zero areas before the window.
+         */
+        uint32_t m_shift;
         /**
          * offset in virtual bytes from the start of the data buffer to the
          * start of the data which can be read by this iterator
@@ -472,6 +534,10 @@ class Buffer
          * to this pointer.
          */
         uint8_t* m_data;
+        /**
+         * the zero areas of the buffer if it has more than one, or nullptr.
+         */
+        const Holes* m_holes;
     };
 
     /**
@@ -654,7 +720,7 @@ class Buffer
          * The reference count of an instance of this data structure.
          * Each buffer which references an instance holds a count.
          */
-        uint32_t m_count;
+        std::atomic<uint32_t> m_count;
         /**
          * the size of the m_data field below.
          */
@@ -663,12 +729,12 @@ class Buffer
          * offset from the start of the m_data field below to the
          * start of the area in which user bytes were written.
          */
-        uint32_t m_dirtyStart;
+        std::atomic<uint32_t> m_dirtyStart;
         /**
          * offset from the start of the m_data field below to the
          * end of the area in which user bytes were written.
          */
-        uint32_t m_dirtyEnd;
+        std::atomic<uint32_t> m_dirtyEnd;
         /**
          * The real data buffer holds _at least_ one byte.
          * Its real size is stored in the m_size field.
@@ -676,6 +742,43 @@ class Buffer
         uint8_t m_data[1];
     };
 
+    /**
+     * A virtual zero area of a buffer which has several of them.
+     */
+    struct Hole
+    {
+        uint32_t start; //!< offset to the start of the zero area
+        uint32_t end;   //!< offset to the end of the zero area
+        uint32_t shift; //!< size of the zero areas before this one
+    };
+
+    /**
+     * The zero areas of a buffer which has more than one, sorted by
+     * offset. This data structure is shared by the copies of the buffer,
+     * and is variable-sized like Buffer::Data.
+     */
+    struct Holes
+    {
+        /**
+         * The reference count of an instance of this data structure.
+         * Each buffer which references an instance holds a count.
+         */
+        std::atomic<uint32_t> m_count;
+        /**
+         * the number of zero areas in the m_holes field below.
+         */
+        uint32_t m_size;
+        /**
+         * the number of zero areas which fit in this data structure.
+         */
+        uint32_t m_capacity;
+        /**
+         * The zero areas. There are _at least_ two of them in a buffer,
+         * and the first one is m_zeroAreaStart to m_zeroAreaEnd.
+         */
+        Hole m_holes[1];
+    };
+
     /**
      * @brief Create a full copy of the buffer, including
      * all the internal structures.
@@ -717,6 +820,49 @@ class Buffer
      */
     uint32_t GetInternalEnd() const;
 
+    /**
+     * @brief Get the size of all the zero areas of the buffer.
+     * @returns the number of virtual zero bytes.
+     */
+    uint32_t GetZeroAreaSize() const;
+
+    /**
+     * @brief Replace the zero areas of the buffer
+     *
+     * If the table contains fewer than two zero areas, it is recycled and
+     * its zero area, if any, becomes m_zeroAreaStart to m_zeroAreaEnd.
+     * Otherwise, m_zeroAreaStart and m_zeroAreaEnd are set to the first one.
+     *
+     * @param holes the new zero areas, with a reference count of one which
+     *        is transferred to the buffer, or nullptr.
+     */
+    void SetHoles(Holes* holes);
+
+    /**
+     * @brief Move the zero areas after the data storage has been reallocated
+     * @param delta the offset to add to the zero areas
+     */
+    void MoveHoles(int32_t delta);
+
+    /**
+     * @brief Reserve the free bytes before the start of the buffer
+     *
+     * The bytes can be reserved if the data is not shared, or if no
+     * other buffer sharing the data has reserved them yet.
+     *
+     * @param start the number of bytes to reserve
+     * @returns true if the bytes were reserved, false if the data must be copied
+     */
+    bool ClaimAtStart(uint32_t start);
+
+    /**
+     * @brief Reserve the free bytes after the end of the buffer
+     *
+     * @param end the number of bytes to reserve
+     * @returns true if the bytes were reserved, false if the data must be copied
+     */
+    bool ClaimAtEnd(uint32_t end);
+
     /**
      * @brief Recycle the buffer memory
      * @param data the buffer data storage
@@ -724,23 +870,28 @@ class Buffer
     static void Recycle(Buffer::Data* data);
     /**
      * @brief Create a buffer data storage
+     *
+     * The storage is allocated from the PacketAllocator, and its size
+     * is rounded up to the capacity of the allocated block.
+     *
      * @param size the storage size to create
      * @returns a pointer to the created buffer storage
      */
     static Buffer::Data* Create(uint32_t size);
     /**
-     * @brief Allocate a buffer data storage
-     * @param reqSize the storage size to create
-     * @returns a pointer to the allocated buffer storage
+     * @brief Create a table of zero areas
+     * @param size the number of zero areas
+     * @returns the table, with a reference count of one
      */
-    static Buffer::Data* Allocate(uint32_t reqSize);
+    static Buffer::Holes* CreateHoles(uint32_t size);
     /**
-     * @brief Deallocate the buffer memory
-     * @param data the buffer data storage
+     * @brief Recycle a table of zero areas
+     * @param holes the table
      */
-    static void Deallocate(Buffer::Data* data);
+    static void RecycleHoles(Buffer::Holes* holes);
 
-    Data* m_data; //!< the buffer data storage
+    Data* m_data;   //!< the buffer data storage
+    Holes* m_holes; //!< the zero areas, if the buffer has more than one
 
     /**
      * keep track of the maximum value of m_zeroAreaStart across
@@ -756,9 +907,9 @@ class Buffer
     /**
      * location in a newly-allocated buffer where you should start
      * writing data. i.e., m_start should be initialized to this
-     * value.
+     * value.  Each thread learns its own value.
      */
-    static uint32_t g_recommendedStart;
+    static thread_local uint32_t g_recommendedStart;
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -780,21 +931,6 @@ class Buffer
      * instance from the start of m_data->m_data
      */
     uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-    /// Container for buffer data
-    typedef std::vector<Buffer::Data*> FreeList;
-
-    /// Local static destructor structure
-    struct LocalStaticDestructor
-    {
-        ~LocalStaticDestructor();
-    };
-
-    static uint32_t g_maxSize;                            //!< Max observed data size
-    static FreeList* g_freeList;                          //!< Buffer data container
-    static LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -809,10 +945,14 @@ namespace ns3
 Buffer::Iterator::Iterator()
     : m_zeroStart(0),
       m_zeroEnd(0),
+      m_windowStart(0),
+      m_windowEnd(0),
+      m_shift(0),
       m_dataStart(0),
       m_dataEnd(0),
       m_current(0),
-      m_data(nullptr)
+      m_data(nullptr),
+      m_holes(nullptr)
 {
 }
 
@@ -833,9 +973,17 @@ Buffer::Iterator::Construct(const Buffer* buffer)
 {
     m_zeroStart = buffer->m_zeroAreaStart;
     m_zeroEnd = buffer->m_zeroAreaEnd;
+    m_windowStart = 0;
+    m_windowEnd = UINT32_MAX;
+    m_shift = 0;
     m_dataStart = buffer->m_start;
     m_dataEnd = buffer->m_end;
     m_data = buffer->m_data->m_data;
+    m_holes = buffer->m_holes;
+    if (m_holes != nullptr)
+    {
+        m_windowEnd = m_holes->m_holes[1].start;
+    }
 }
 
 void
@@ -866,52 +1014,55 @@ Buffer::Iterator::Prev(uint32_t delta)
     m_current -= delta;
 }
 
+uint8_t*
+Buffer::Iterator::GetPointer(uint32_t size) const
+{
+    if (m_current + size <= m_zeroStart && m_current >= m_windowStart)
+    {
+        return &m_data[m_current - m_shift];
+    }
+    else if (m_current >= m_zeroEnd && m_current + size <= m_windowEnd)
+    {
+        return &m_data[m_current - m_shift - (m_zeroEnd - m_zeroStart)];
+    }
+    return nullptr;
+}
+
 void
 Buffer::Iterator::WriteU8(uint8_t data)
 {
     NS_ASSERT_MSG(Check(m_current), GetWriteErrorMessage());
 
-    if (m_current < m_zeroStart)
-    {
-        m_data[m_current] = data;
-        m_current++;
-    }
-    else
+    uint8_t* buffer = GetPointer(1);
+    if (buffer == nullptr)
     {
-        m_data[m_current - (m_zeroEnd - m_zeroStart)] = data;
-        m_current++;
+        buffer = SlowGetPointer(1);
     }
+    *buffer = data;
+    m_current++;
 }
 
 void
 Buffer::Iterator::WriteU8(uint8_t data, uint32_t len)
 {
     NS_ASSERT_MSG(CheckNoZero(m_current, m_current + len), GetWriteErrorMessage());
-    if (m_current <= m_zeroStart)
-    {
-        std::memset(&(m_data[m_current]), data, len);
-        m_current += len;
-    }
-    else
+    uint8_t* buffer = GetPointer(len);
+    if (buffer == nullptr)
     {
-        uint8_t* buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
-        std::memset(buffer, data, len);
-        m_current += len;
+        buffer = SlowGetPointer(len);
     }
+    std::memset(buffer, data, len);
+    m_current += len;
 }
 
 void
 Buffer::Iterator::WriteHtonU16(uint16_t data)
 {
     NS_ASSERT_MSG(CheckNoZero(m_current, m_current + 2), GetWriteErrorMessage());
-    uint8_t* buffer;
-    if (m_current + 2 <= m_zeroStart)
+    uint8_t* buffer = GetPointer(2);
+    if (buffer == nullptr)
     {
-        buffer = &m_data[m_current];
-    }
-    else
-    {
-        buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        buffer = SlowGetPointer(2);
     }
     buffer[0] = (data >> 8) & 0xff;
     buffer[1] = (data >> 0) & 0xff;
@@ -923,14 +1074,10 @@ Buffer::Iterator::WriteHtonU32(uint32_t data)
 {
     NS_ASSERT_MSG(CheckNoZero(m_current, m_current + 4), GetWriteErrorMessage());
 
-    uint8_t* buffer;
-    if (m_current + 4 <= m_zeroStart)
-    {
-        buffer = &m_data[m_current];
-    }
-    else
+    uint8_t* buffer = GetPointer(4);
+    if (buffer == nullptr)
     {
-        buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        buffer = SlowGetPointer(4);
     }
     buffer[0] = (data >> 24) & 0xff;
     buffer[1] = (data >> 16) & 0xff;
@@ -942,16 +1089,8 @@ Buffer::Iterator::WriteHtonU32(uint32_t data)
 uint16_t
 Buffer::Iterator::ReadNtohU16()
 {
-    uint8_t* buffer;
-    if (m_current + 2 <= m_zeroStart)
-    {
-        buffer = &m_data[m_current];
-    }
-    else if (m_current >= m_zeroEnd)
-    {
-        buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
-    }
-    else
+    uint8_t* buffer = GetPointer(2);
+    if (buffer == nullptr)
     {
         return SlowReadNtohU16();
     }
@@ -966,16 +1105,8 @@ Buffer::Iterator::ReadNtohU16()
 uint32_t
 Buffer::Iterator::ReadNtohU32()
 {
-    uint8_t* buffer;
-    if (m_current + 4 <= m_zeroStart)
-    {
-        buffer = &m_data[m_current];
-    }
-    else if (m_current >= m_zeroEnd)
-    {
-        buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
-    }
-    else
+    uint8_t* buffer = GetPointer(4);
+    if (buffer == nullptr)
     {
         return SlowReadNtohU32();
     }
@@ -996,20 +1127,16 @@ Buffer::Iterator::PeekU8()
 {
     NS_ASSERT_MSG(m_current >= m_dataStart && m_current < m_dataEnd, GetReadErrorMessage());
 
-    if (m_current < m_zeroStart)
+    uint8_t* buffer = GetPointer(1);
+    if (buffer != nullptr)
     {
-        uint8_t data = m_data[m_current];
-        return data;
+        return *buffer;
     }
-    else if (m_current < m_zeroEnd)
+    else if (m_current >= m_zeroStart && m_current < m_zeroEnd)
     {
         return 0;
     }
-    else
-    {
-        uint8_t data = m_data[m_current - (m_zeroEnd - m_zeroStart)];
-        return data;
-    }
+    return SlowPeekU8();
 }
 
 uint8_t
@@ -1043,13 +1170,18 @@ Buffer::Iterator::Read(Buffer::Iterator start, uint32_t size)
 
 Buffer::Buffer(const Buffer& o)
     : m_data(o.m_data),
+      m_holes(o.m_holes),
       m_maxZeroAreaStart(o.m_zeroAreaStart),
       m_zeroAreaStart(o.m_zeroAreaStart),
       m_zeroAreaEnd(o.m_zeroAreaEnd),
       m_start(o.m_start),
       m_end(o.m_end)
 {
-    m_data->m_count++;
+    PacketAllocator::Ref(m_data->m_count);
+    if (m_holes != nullptr)
+    {
+        PacketAllocator::Ref(m_holes->m_count);
+    }
     NS_ASSERT(CheckInternalState());
 }
 
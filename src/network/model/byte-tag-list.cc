@@ -7,14 +7,14 @@
  */
 #include "byte-tag-list.h"
 
+#include "packet-allocator.h"
+
 #include "ns3/log.h"
 
+#include <atomic>
 #include <cstring>
 #include <limits>
-#include <vector>
 
-#define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max())
 
 namespace ns3
@@ -31,39 +31,12 @@ NS_LOG_COMPONENT_DEFINE("ByteTagList");
  */
 struct ByteTagListData
 {
-    uint32_t size;   //!< size of the data
-    uint32_t count;  //!< use counter (for smart deallocation)
-    uint32_t dirty;  //!< number of bytes actually in use
-    uint8_t data[4]; //!< data
+    uint32_t size;               //!< size of the data
+    std::atomic<uint32_t> count; //!< use counter (for smart deallocation)
+    std::atomic<uint32_t> dirty; //!< number of bytes actually in use
+    uint8_t data[4];             //!< data
 };
 
-#ifdef USE_FREE_LIST
-/**
- * @ingroup packet
- *
- * @brief Container class for struct ByteTagListData
- *
- * Internal use only.
- */
-static class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
-{
-  public:
-    ~ByteTagListDataFreeList();
-} g_freeList; //!< Container for struct ByteTagListData
-
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList()
-{
-    NS_LOG_FUNCTION(this);
-    for (auto i = begin(); i != end(); i++)
-    {
-        auto buffer = (uint8_t*)(*i);
-        delete[] buffer;
-    }
-}
-#endif /* USE_FREE_LIST */
-
 ByteTagList::Iterator::Item::Item(TagBuffer buf_)
     : buf(buf_)
 {
@@ -156,7 +129,7 @@ ByteTagList::ByteTagList(const ByteTagList& o)
     NS_LOG_FUNCTION(this << &o);
     if (m_data != nullptr)
     {
-        m_data->count++;
+        PacketAllocator::Ref(m_data->count);
     }
 }
 
@@ -176,7 +149,7 @@ ByteTagList::operator=(const ByteTagList& o)
     m_used = o.m_used;
     if (m_data != nullptr)
     {
-        m_data->count++;
+        PacketAllocator::Ref(m_data->count);
     }
     return *this;
 }
@@ -200,7 +173,7 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_data = Allocate(spaceNeeded);
         m_used = 0;
     }
-    else if (m_data->size < spaceNeeded || (m_data->count != 1 && m_data->dirty != m_used))
+    else if (m_data->size < spaceNeeded || !ClaimAtEnd(spaceNeeded))
     {
         ByteTagListData* newData = Allocate(spaceNeeded);
         std::memcpy(&newData->data, &m_data->data, m_used);
@@ -221,7 +194,7 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_maxEnd = end - m_adjustment;
     }
     m_used = spaceNeeded;
-    m_data->dirty = m_used;
+    m_data->dirty.store(m_used, std::memory_order_relaxed);
     return tag;
 }
 
@@ -338,69 +311,30 @@ ByteTagList::AddAtStart(int32_t prependOffset)
     *this = list;
 }
 
-#ifdef USE_FREE_LIST
-
-ByteTagListData*
-ByteTagList::Allocate(uint32_t size)
-{
-    NS_LOG_FUNCTION(this << size);
-    while (!g_freeList.empty())
-    {
-        ByteTagListData* data = g_freeList.back();
-        g_freeList.pop_back();
-        NS_ASSERT(data != nullptr);
-        if (data->size >= size)
-        {
-            data->count = 1;
-            data->dirty = 0;
-            return data;
-        }
-        auto buffer = (uint8_t*)data;
-        delete[] buffer;
-    }
-    auto buffer = new uint8_t[std::max(size, g_maxSize) + sizeof(ByteTagListData) - 4];
-    auto data = (ByteTagListData*)buffer;
-    data->count = 1;
-    data->size = size;
-    data->dirty = 0;
-    return data;
-}
-
-void
-ByteTagList::Deallocate(ByteTagListData* data)
+bool
+ByteTagList::ClaimAtEnd(uint32_t end)
 {
-    NS_LOG_FUNCTION(this << data);
-    if (data == nullptr)
+    NS_LOG_FUNCTION(this << end);
+    if (m_data->count.load(std::memory_order_acquire) == 1)
     {
-        return;
-    }
-    g_maxSize = std::max(g_maxSize, data->size);
-    data->count--;
-    if (data->count == 0)
-    {
-        if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
-        {
-            auto buffer = (uint8_t*)data;
-            delete[] buffer;
-        }
-        else
-        {
-            g_freeList.push_back(data);
-        }
+        return true;
     }
+    /* The data is shared, possibly with other threads: the bytes after
+     * m_used are free only if no other list has used them yet.
+     */
+    return PacketAllocator::Claim<uint32_t>(m_data->dirty, m_used, end);
 }
 
-#else /* USE_FREE_LIST */
-
 ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    uint8_t* buffer = new uint8_t[size + sizeof(ByteTagListData) - 4];
-    ByteTagListData* data = (ByteTagListData*)buffer;
-    data->count = 1;
-    data->size = size;
-    data->dirty = 0;
+    uint32_t bytes = size + sizeof(ByteTagListData) - 4;
+    auto data = new (PacketAllocator::Allocate(bytes)) ByteTagListData;
+    // use the whole block
+    data->size = PacketAllocator::GetCapacity(bytes) - sizeof(ByteTagListData) + 4;
+    data->count.store(1, std::memory_order_relaxed);
+    data->dirty.store(0, std::memory_order_relaxed);
     return data;
 }
 
@@ -408,20 +342,18 @@ void
 ByteTagList::Deallocate(ByteTagListData* data)
 {
     NS_LOG_FUNCTION(this << data);
-    if (data == 0)
+    if (data == nullptr)
     {
         return;
     }
-    data->count--;
-    if (data->count == 0)
+    if (PacketAllocator::Unref(data->count))
     {
-        uint8_t* buffer = (uint8_t*)data;
-        delete[] buffer;
+        uint32_t bytes = data->size + sizeof(ByteTagListData) - 4;
+        data->~ByteTagListData();
+        PacketAllocator::Deallocate(data, bytes);
     }
 }
 
-#endif /* USE_FREE_LIST */
-
 uint32_t
 ByteTagList::GetSerializedSize() const
 {
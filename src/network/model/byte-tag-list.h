@@ -272,6 +272,18 @@ class ByteTagList
      */
     void Deallocate(ByteTagListData* data);
 
+    /**
+     * @brief Reserve the bytes after the ones used in the shared data
+     *
+     * The bytes are available if the data is not shared, or if no
+     * other list sharing the data, possibly in another thread, has used
+     * them yet.
+     *
+     * @param end the end of the bytes to reserve
+     * @returns true if the bytes were reserved, false if the data must be copied
+     */
+    bool ClaimAtEnd(uint32_t end);
+
     int32_t m_minStart;      //!< minimal start offset
     int32_t m_maxEnd;        //!< maximal end offset
     int32_t m_adjustment;    //!< adjustment to byte tag offsets
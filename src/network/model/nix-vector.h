@@ -14,6 +14,8 @@
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
 
+#include <vector>
+
 namespace ns3
 {
 
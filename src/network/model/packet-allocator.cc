@@ -0,0 +1,434 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "packet-allocator.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup packet
+ * ns3::PacketAllocator implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PacketAllocator");
+
+namespace
+{
+
+/** The number of size classes, from MIN_BLOCK_SIZE to MAX_BLOCK_SIZE. */
+constexpr uint32_t N_SIZE_CLASSES = 23;
+
+/** The capacity of the blocks cached by each free list, in bytes. */
+constexpr std::size_t MAX_CACHED_BYTES = 512 * 1024;
+
+/** The minimum number of blocks cached by each free list. */
+constexpr uint32_t MIN_CACHED_BLOCKS = 16;
+
+/**
+ * Get the size class of a request.
+ *
+ * The size classes are the powers of two and the midpoints between
+ * them: 32, 48, 64, 96, 128, ...
+ *
+ * @param [in] size The requested size, at most MAX_BLOCK_SIZE.
+ * @returns The index of the size class.
+ */
+uint32_t
+GetSizeClass(std::size_t size)
+{
+    if (size <= PacketAllocator::MIN_BLOCK_SIZE)
+    {
+        return 0;
+    }
+    // 2^(k-1) < size <= 2^k, with k >= 6
+    uint32_t k = std::bit_width(size - 1);
+    uint32_t index = 2 * (k - 5);
+    if (size <= (std::size_t{3} << (k - 2)))
+    {
+        index--;
+    }
+    return index;
+}
+
+/**
+ * Get the size of the blocks of a size class.
+ *
+ * @param [in] index The index of the size class.
+ * @returns The size of the blocks.
+ */
+constexpr std::size_t
+GetClassSize(uint32_t index)
+{
+    return (index % 2 == 0 ? std::size_t{PacketAllocator::MIN_BLOCK_SIZE} : std::size_t{48})
+           << (index / 2);
+}
+
+static_assert(GetClassSize(N_SIZE_CLASSES - 1) == PacketAllocator::MAX_BLOCK_SIZE,
+              "Wrong number of size classes");
+
+/** The maximum number of blocks cached by the free list of each size class. */
+constexpr auto g_maxCachedBlocks = [] {
+    std::array<uint32_t, N_SIZE_CLASSES> limits{};
+    for (uint32_t i = 0; i < N_SIZE_CLASSES; ++i)
+    {
+        limits[i] = std::max<uint32_t>(MIN_CACHED_BLOCKS, MAX_CACHED_BYTES / GetClassSize(i));
+    }
+    return limits;
+}();
+
+/**
+ * A counter updated by a single thread, and read by any thread.
+ *
+ * The owner thread does not need an atomic read-modify-write.
+ */
+class Counter
+{
+  public:
+    /**
+     * Add to the counter.
+     *
+     * @param [in] n The value to add, modulo 2^64.
+     */
+    void Add(uint64_t n)
+    {
+        m_value.store(m_value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the counter.
+     *
+     * @returns The value of the counter.
+     */
+    uint64_t Get() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> m_value{0}; //!< The value of the counter.
+};
+
+/** The counters of a thread. */
+struct Counters
+{
+    Counter allocations;       //!< Number of blocks allocated.
+    Counter deallocations;     //!< Number of blocks freed.
+    Counter cacheHits;         //!< Allocations served from a free list.
+    Counter systemAllocations; //!< Allocations served by the system allocator.
+    Counter allocatedBytes;    //!< Capacity of the blocks allocated.
+    Counter freedBytes;        //!< Capacity of the blocks freed.
+    Counter cachedBlocks;      //!< Number of blocks held in the free lists.
+    Counter cachedBytes;       //!< Capacity of the blocks held in the free lists.
+};
+
+/** The free lists of a thread. */
+struct ThreadCache
+{
+    /** A free block, linked through its first bytes. */
+    struct FreeBlock
+    {
+        FreeBlock* next; //!< The next free block of the size class.
+    };
+
+    std::array<FreeBlock*, N_SIZE_CLASSES> freeLists{}; //!< The free blocks of each size class.
+    std::array<uint32_t, N_SIZE_CLASSES> lengths{};     //!< The number of free blocks.
+    Counters counters;                                  //!< The statistics of the thread.
+};
+
+/** The statistics of the threads. */
+struct Registry
+{
+    std::mutex mutex;                 //!< Protects the other fields.
+    std::vector<ThreadCache*> caches; //!< The free lists of the running threads.
+    Counters retired;                 //!< The counters of the exited threads.
+};
+
+/**
+ * Get the registry of the threads.
+ *
+ * The registry is never destroyed, as packets may be freed by the
+ * static destructors of other compilation units.
+ *
+ * @returns The registry.
+ */
+Registry&
+GetRegistry()
+{
+    static auto registry = new Registry;
+    return *registry;
+}
+
+/**
+ * Add counters to another set of counters.
+ *
+ * @param [in,out] to The counters to update.
+ * @param [in] from The counters to add.
+ */
+void
+AddCounters(Counters& to, const Counters& from)
+{
+    to.allocations.Add(from.allocations.Get());
+    to.deallocations.Add(from.deallocations.Get());
+    to.cacheHits.Add(from.cacheHits.Get());
+    to.systemAllocations.Add(from.systemAllocations.Get());
+    to.allocatedBytes.Add(from.allocatedBytes.Get());
+    to.freedBytes.Add(from.freedBytes.Get());
+    to.cachedBlocks.Add(from.cachedBlocks.Get());
+    to.cachedBytes.Add(from.cachedBytes.Get());
+}
+
+/**
+ * Release the blocks of the free lists of a thread.
+ *
+ * @param [in] cache The free lists.
+ */
+void
+FlushCache(ThreadCache& cache)
+{
+    for (uint32_t i = 0; i < N_SIZE_CLASSES; ++i)
+    {
+        while (cache.freeLists[i] != nullptr)
+        {
+            ThreadCache::FreeBlock* block = cache.freeLists[i];
+            cache.freeLists[i] = block->next;
+            ::operator delete(block);
+        }
+        cache.counters.cachedBlocks.Add(-uint64_t{cache.lengths[i]});
+        cache.counters.cachedBytes.Add(-uint64_t{cache.lengths[i] * GetClassSize(i)});
+        cache.lengths[i] = 0;
+    }
+}
+
+/** The free lists of the calling thread, or nullptr if not created yet or destroyed. */
+thread_local ThreadCache* t_cache = nullptr;
+
+/** Whether the free lists of the calling thread have been destroyed. */
+thread_local bool t_exited = false;
+
+/** Owns the free lists of a thread, and releases them when the thread exits. */
+class ThreadCacheOwner
+{
+  public:
+    ThreadCacheOwner()
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.caches.push_back(&m_cache);
+        t_cache = &m_cache;
+    }
+
+    ~ThreadCacheOwner()
+    {
+        t_cache = nullptr;
+        t_exited = true;
+        FlushCache(m_cache);
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        AddCounters(registry.retired, m_cache.counters);
+        registry.caches.erase(std::find(registry.caches.begin(), registry.caches.end(), &m_cache));
+    }
+
+    /**
+     * Get the free lists.
+     *
+     * @returns The free lists of the thread.
+     */
+    ThreadCache* Get()
+    {
+        return &m_cache;
+    }
+
+  private:
+    ThreadCache m_cache; //!< The free lists.
+};
+
+/** The owner of the free lists of the calling thread, created on first use. */
+thread_local ThreadCacheOwner t_owner;
+
+/**
+ * Get the free lists of the calling thread.
+ *
+ * @returns The free lists, or nullptr once the thread is exiting.
+ */
+inline ThreadCache*
+GetCache()
+{
+    if (t_cache == nullptr && !t_exited)
+    {
+        return t_owner.Get();
+    }
+    return t_cache;
+}
+
+/**
+ * Record an operation of a thread without free lists.
+ *
+ * @param [in] allocation Whether a block was allocated or freed.
+ * @param [in] capacity The capacity of the block.
+ */
+void
+RecordUncached(bool allocation, std::size_t capacity)
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    if (allocation)
+    {
+        registry.retired.allocations.Add(1);
+        registry.retired.systemAllocations.Add(1);
+        registry.retired.allocatedBytes.Add(capacity);
+    }
+    else
+    {
+        registry.retired.deallocations.Add(1);
+        registry.retired.freedBytes.Add(capacity);
+    }
+}
+
+} // namespace
+
+bool PacketAllocator::m_concurrent = false;
+
+void*
+PacketAllocator::Allocate(std::size_t size)
+{
+    ThreadCache* cache = GetCache();
+    if (size > MAX_BLOCK_SIZE || cache == nullptr)
+    {
+        std::size_t capacity = GetCapacity(size);
+        if (cache == nullptr)
+        {
+            RecordUncached(true, capacity);
+        }
+        else
+        {
+            cache->counters.allocations.Add(1);
+            cache->counters.systemAllocations.Add(1);
+            cache->counters.allocatedBytes.Add(capacity);
+        }
+        return ::operator new(capacity);
+    }
+
+    uint32_t index = GetSizeClass(size);
+    std::size_t capacity = GetClassSize(index);
+    Counters& counters = cache->counters;
+    counters.allocations.Add(1);
+    counters.allocatedBytes.Add(capacity);
+    ThreadCache::FreeBlock* block = cache->freeLists[index];
+    if (block != nullptr)
+    {
+        cache->freeLists[index] = block->next;
+        cache->lengths[index]--;
+        counters.cacheHits.Add(1);
+        counters.cachedBlocks.Add(-1);
+        counters.cachedBytes.Add(-capacity);
+        return block;
+    }
+    counters.systemAllocations.Add(1);
+    return ::operator new(capacity);
+}
+
+void
+PacketAllocator::Deallocate(void* block, std::size_t size)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+    ThreadCache* cache = GetCache();
+    if (cache == nullptr)
+    {
+        RecordUncached(false, GetCapacity(size));
+        ::operator delete(block);
+        return;
+    }
+
+    Counters& counters = cache->counters;
+    counters.deallocations.Add(1);
+    if (size > MAX_BLOCK_SIZE)
+    {
+        counters.freedBytes.Add(size);
+        ::operator delete(block);
+        return;
+    }
+    uint32_t index = GetSizeClass(size);
+    std::size_t capacity = GetClassSize(index);
+    counters.freedBytes.Add(capacity);
+    if (cache->lengths[index] >= g_maxCachedBlocks[index])
+    {
+        ::operator delete(block);
+        return;
+    }
+    auto freeBlock = static_cast<ThreadCache::FreeBlock*>(block);
+    freeBlock->next = cache->freeLists[index];
+    cache->freeLists[index] = freeBlock;
+    cache->lengths[index]++;
+    counters.cachedBlocks.Add(1);
+    counters.cachedBytes.Add(capacity);
+}
+
+std::size_t
+PacketAllocator::GetCapacity(std::size_t size)
+{
+    if (size > MAX_BLOCK_SIZE)
+    {
+        return size;
+    }
+    return GetClassSize(GetSizeClass(size));
+}
+
+void
+PacketAllocator::Trim()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    if (t_cache != nullptr)
+    {
+        FlushCache(*t_cache);
+    }
+}
+
+PacketAllocator::Statistics
+PacketAllocator::GetStatistics()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    Counters total;
+    AddCounters(total, registry.retired);
+    for (const auto cache : registry.caches)
+    {
+        AddCounters(total, cache->counters);
+    }
+
+    Statistics statistics;
+    statistics.allocations = total.allocations.Get();
+    statistics.deallocations = total.deallocations.Get();
+    statistics.cacheHits = total.cacheHits.Get();
+    statistics.systemAllocations = total.systemAllocations.Get();
+    statistics.bytesInUse = total.allocatedBytes.Get() - total.freedBytes.Get();
+    statistics.cachedBlocks = total.cachedBlocks.Get();
+    statistics.cachedBytes = total.cachedBytes.Get();
+    statistics.threads = registry.caches.size();
+    return statistics;
+}
+
+void
+PacketAllocator::SetConcurrent(bool concurrent)
+{
+    NS_LOG_FUNCTION(concurrent);
+    m_concurrent = concurrent;
+}
+
+} // namespace ns3
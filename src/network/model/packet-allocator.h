@@ -0,0 +1,201 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @file
+ * @ingroup packet
+ * ns3::PacketAllocator declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup packet
+ *
+ * @brief Size-classed, per-thread allocator of the packet data structures.
+ *
+ * The Packet objects and the storage of their Buffer, PacketMetadata,
+ * ByteTagList and PacketTagList are allocated from this allocator.
+ * Requests are rounded up to a size class (32, 48, 64, 96, 128, ...
+ * bytes: powers of two and their midpoints, up to 64 KiB) and freed
+ * blocks are kept in a free list per size class, so that a packet
+ * created after another one of similar size reuses its memory, and
+ * the unused tail of a block is available to the data structure which
+ * requested it (see GetCapacity()).
+ *
+ * The free lists are private to each thread, so that the threads of a
+ * parallel simulator (see ns3::MultithreadedSimulatorImpl) allocate and
+ * release packets without any synchronization: a block freed by
+ * another thread than the one which allocated it simply moves to the
+ * free lists of the former.  The free lists are bounded, and released
+ * when their thread exits.  Larger blocks are directly allocated from
+ * the system.
+ *
+ * The data structures allocated for the packets are shared by the
+ * copies of a packet, and are released with reference counts.  These
+ * are only updated with atomic read-modify-write operations while the
+ * packets may be shared by several threads (see SetConcurrent()), so
+ * that sequential simulations do not pay for them.
+ */
+class PacketAllocator
+{
+  public:
+    /** The allocation statistics, aggregated over all the threads. */
+    struct Statistics
+    {
+        uint64_t allocations;       //!< Number of blocks allocated.
+        uint64_t deallocations;     //!< Number of blocks freed.
+        uint64_t cacheHits;         //!< Allocations served from a free list.
+        uint64_t systemAllocations; //!< Allocations served by the system allocator.
+        uint64_t bytesInUse;        //!< Capacity of the allocated blocks not yet freed.
+        uint64_t cachedBlocks;      //!< Number of blocks held in the free lists.
+        uint64_t cachedBytes;       //!< Capacity of the blocks held in the free lists.
+        uint32_t threads;           //!< Number of threads with free lists.
+    };
+
+    /** The size of the smallest size class. */
+    static constexpr uint32_t MIN_BLOCK_SIZE = 32;
+    /** The size of the largest size class. */
+    static constexpr uint32_t MAX_BLOCK_SIZE = 65536;
+
+    /**
+     * Allocate a block.
+     *
+     * The block is aligned for any fundamental type.
+     *
+     * @param [in] size The requested size, in bytes.
+     * @returns The block, of at least GetCapacity(size) bytes.
+     */
+    static void* Allocate(std::size_t size);
+
+    /**
+     * Free a block.
+     *
+     * @param [in] block The block, or nullptr.
+     * @param [in] size The size requested when the block was allocated,
+     *             or any other size with the same capacity.
+     */
+    static void Deallocate(void* block, std::size_t size);
+
+    /**
+     * Get the usable size of the blocks allocated for a request.
+     *
+     * @param [in] size The requested size, in bytes.
+     * @returns The size of the size class of the request, or the request
+     *          itself when it is larger than MAX_BLOCK_SIZE.
+     */
+    static std::size_t GetCapacity(std::size_t size);
+
+    /**
+     * Release the blocks cached by the calling thread to the system.
+     */
+    static void Trim();
+
+    /**
+     * Get the allocation statistics.
+     *
+     * The counters of the other threads are read while they may be
+     * updated, and are therefore only approximate while packets are
+     * being allocated concurrently.
+     *
+     * @returns The statistics of all the threads, including the ones
+     *          which have exited.
+     */
+    static Statistics GetStatistics();
+
+    /**
+     * Set whether the packets may be shared by several threads.
+     *
+     * This must be set before the threads of a parallel simulator start,
+     * and cleared after they have stopped.
+     *
+     * @param [in] concurrent Whether the packets may be shared by several
+     *             threads.
+     */
+    static void SetConcurrent(bool concurrent);
+
+    /**
+     * Increment the reference count of a packet data structure.
+     *
+     * @param [in] count The reference count.
+     */
+    static void Ref(std::atomic<uint32_t>& count);
+
+    /**
+     * Decrement the reference count of a packet data structure.
+     *
+     * @param [in] count The reference count.
+     * @returns true if the last reference was released.
+     */
+    static bool Unref(std::atomic<uint32_t>& count);
+
+    /**
+     * Extend the area of a shared packet data structure used by its
+     * copies, if no other copy has extended it yet.
+     *
+     * @param [in] bound The bound of the used area.
+     * @param [in] expected The bound known to the copy.
+     * @param [in] desired The new bound.
+     * @returns true if the area was extended.
+     */
+    template <typename T>
+    static bool Claim(std::atomic<T>& bound, T expected, T desired);
+
+  private:
+    /** Whether the packets may be shared by several threads. */
+    static bool m_concurrent;
+};
+
+inline void
+PacketAllocator::Ref(std::atomic<uint32_t>& count)
+{
+    if (m_concurrent)
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+inline bool
+PacketAllocator::Unref(std::atomic<uint32_t>& count)
+{
+    if (m_concurrent)
+    {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    uint32_t value = count.load(std::memory_order_relaxed) - 1;
+    count.store(value, std::memory_order_relaxed);
+    return value == 0;
+}
+
+template <typename T>
+bool
+PacketAllocator::Claim(std::atomic<T>& bound, T expected, T desired)
+{
+    if (m_concurrent)
+    {
+        return bound.compare_exchange_strong(expected, desired, std::memory_order_relaxed);
+    }
+    if (bound.load(std::memory_order_relaxed) != expected)
+    {
+        return false;
+    }
+    bound.store(desired, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
@@ -9,6 +9,7 @@
 
 #include "buffer.h"
 #include "header.h"
+#include "packet-allocator.h"
 #include "trailer.h"
 
 #include "ns3/assert.h"
@@ -17,6 +18,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -25,20 +27,9 @@ NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableCompact = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
-
-PacketMetadata::DataFreeList::~DataFreeList()
-{
-    NS_LOG_FUNCTION(this);
-    for (auto i = begin(); i != end(); i++)
-    {
-        PacketMetadata::Deallocate(*i);
-    }
-    PacketMetadata::m_enable = false;
-}
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
 
 void
 PacketMetadata::Enable()
@@ -62,15 +53,29 @@ PacketMetadata::EnableChecking()
     m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableCompact()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    Enable();
+    m_enableCompact = true;
+}
+
+void
+PacketMetadata::DisableCompact()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_enableCompact = false;
+}
+
 void
 PacketMetadata::ReserveCopy(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
     PacketMetadata::Data* newData = PacketMetadata::Create(m_used + size);
     memcpy(newData->m_data, m_data->m_data, m_used);
-    newData->m_dirtyEnd = m_used;
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    newData->m_dirtyEnd.store(m_used, std::memory_order_relaxed);
+    if (PacketAllocator::Unref(m_data->m_count))
     {
         PacketMetadata::Recycle(m_data);
     }
@@ -93,18 +98,31 @@ PacketMetadata::Reserve(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
     NS_ASSERT(m_data != nullptr);
-    if (m_data->m_size >= m_used + size &&
-        (m_head == 0xffff || m_data->m_count == 1 || m_data->m_dirtyEnd == m_used))
-    {
-        /* enough room, not dirty. */
-    }
-    else
+    if (!ClaimAtEnd(size))
     {
         /* (enough room and dirty) or (not enough room) */
         ReserveCopy(size);
     }
 }
 
+bool
+PacketMetadata::ClaimAtEnd(uint32_t n)
+{
+    NS_LOG_FUNCTION(this << n);
+    if (m_used + n > m_data->m_size)
+    {
+        return false;
+    }
+    if (m_data->m_count.load(std::memory_order_acquire) == 1)
+    {
+        return true;
+    }
+    /* The data is shared, possibly with other threads: the room after
+     * m_used is available only if no one has used it yet.
+     */
+    return PacketAllocator::Claim<uint16_t>(m_data->m_dirtyEnd, m_used, m_used + n);
+}
+
 bool
 PacketMetadata::IsSharedPointerOk(uint16_t pointer) const
 {
@@ -334,7 +352,7 @@ PacketMetadata::UpdateTail(uint16_t written)
     NS_ASSERT(m_head != 0xffff);
     NS_ASSERT(written >= 8);
     m_used += written;
-    m_data->m_dirtyEnd = m_used;
+    m_data->m_dirtyEnd.store(m_used, std::memory_order_relaxed);
 }
 
 void
@@ -360,7 +378,7 @@ PacketMetadata::UpdateHead(uint16_t written)
     NS_ASSERT(m_head != 0xffff);
     NS_ASSERT(written >= 8);
     m_used += written;
-    m_data->m_dirtyEnd = m_used;
+    m_data->m_dirtyEnd.store(m_used, std::memory_order_relaxed);
 }
 
 uint16_t
@@ -373,8 +391,7 @@ PacketMetadata::AddSmall(const PacketMetadata::SmallItem* item)
     uint32_t typeUidSize = GetUleb128Size(item->typeUid);
     uint32_t sizeSize = GetUleb128Size(item->size);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2;
-    if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+    if (!ClaimAtEnd(n))
     {
         ReserveCopy(n);
     }
@@ -410,8 +427,7 @@ PacketMetadata::AddBig(uint32_t next,
     uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
-    if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+    if (!ClaimAtEnd(n))
     {
         ReserveCopy(n);
     }
@@ -464,7 +480,7 @@ PacketMetadata::ReplaceTail(PacketMetadata::SmallItem* item,
     uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
-    if (available >= n && m_data->m_count == 1)
+    if (available >= n && m_data->m_count.load(std::memory_order_acquire) == 1)
     {
         uint8_t* buffer = &m_data->m_data[m_tail];
         Append16(item->next, buffer);
@@ -483,7 +499,7 @@ PacketMetadata::ReplaceTail(PacketMetadata::SmallItem* item,
         buffer += fragEndSize;
         Append32(extraItem->packetUid, buffer);
         m_used = std::max(m_used, static_cast<uint32_t>(buffer - &m_data->m_data[0]));
-        m_data->m_dirtyEnd = m_used;
+        m_data->m_dirtyEnd.store(m_used, std::memory_order_relaxed);
         return;
     }
 
@@ -492,7 +508,7 @@ PacketMetadata::ReplaceTail(PacketMetadata::SmallItem* item,
      */
 
     // create a copy of the packet without its tail.
-    PacketMetadata h(m_packetUid, 0);
+    PacketMetadata h = CreateDecoded(m_packetUid);
     uint16_t current = m_head;
     while (current != 0xffff && current != m_tail)
     {
@@ -556,73 +572,26 @@ PacketMetadata::Data*
 PacketMetadata::Create(uint32_t size)
 {
     NS_LOG_FUNCTION(size);
-    NS_LOG_LOGIC("create size=" << size << ", max=" << m_maxSize);
-    if (size > m_maxSize)
-    {
-        m_maxSize = size;
-    }
-    while (!m_freeList.empty())
-    {
-        PacketMetadata::Data* data = m_freeList.back();
-        m_freeList.pop_back();
-        if (data->m_size >= size)
-        {
-            NS_LOG_LOGIC("create found size=" << data->m_size);
-            data->m_count = 1;
-            return data;
-        }
-        NS_LOG_LOGIC("create dealloc size=" << data->m_size);
-        PacketMetadata::Deallocate(data);
-    }
-    NS_LOG_LOGIC("create alloc size=" << m_maxSize);
-    return PacketMetadata::Allocate(m_maxSize);
+    size = std::max<uint32_t>(size, PACKET_METADATA_DATA_M_DATA_SIZE);
+    uint32_t bytes = sizeof(Data) + size - PACKET_METADATA_DATA_M_DATA_SIZE;
+    auto data = new (PacketAllocator::Allocate(bytes)) PacketMetadata::Data;
+    // use the whole block
+    data->m_size = PacketAllocator::GetCapacity(bytes) - sizeof(Data) +
+                   PACKET_METADATA_DATA_M_DATA_SIZE;
+    data->m_count.store(1, std::memory_order_relaxed);
+    data->m_dirtyEnd.store(0, std::memory_order_relaxed);
+    NS_LOG_LOGIC("create size=" << size << ", allocated=" << data->m_size);
+    return data;
 }
 
 void
 PacketMetadata::Recycle(PacketMetadata::Data* data)
 {
     NS_LOG_FUNCTION(data);
-    if (!m_enable)
-    {
-        PacketMetadata::Deallocate(data);
-        return;
-    }
-    NS_LOG_LOGIC("recycle size=" << data->m_size << ", list=" << m_freeList.size());
     NS_ASSERT(data->m_count == 0);
-    if (m_freeList.size() > 1000 || data->m_size < m_maxSize)
-    {
-        PacketMetadata::Deallocate(data);
-    }
-    else
-    {
-        m_freeList.push_back(data);
-    }
-}
-
-PacketMetadata::Data*
-PacketMetadata::Allocate(uint32_t n)
-{
-    NS_LOG_FUNCTION(n);
-    uint32_t size = sizeof(Data);
-    if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
-    {
-        n = PACKET_METADATA_DATA_M_DATA_SIZE;
-    }
-    size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-    auto buf = new uint8_t[size];
-    auto data = (PacketMetadata::Data*)buf;
-    data->m_size = n;
-    data->m_count = 1;
-    data->m_dirtyEnd = 0;
-    return data;
-}
-
-void
-PacketMetadata::Deallocate(PacketMetadata::Data* data)
-{
-    NS_LOG_FUNCTION(data);
-    auto buf = (uint8_t*)data;
-    delete[] buf;
+    uint32_t bytes = sizeof(Data) + data->m_size - PACKET_METADATA_DATA_M_DATA_SIZE;
+    data->~Data();
+    PacketAllocator::Deallocate(data, bytes);
 }
 
 PacketMetadata
@@ -641,7 +610,6 @@ PacketMetadata::AddHeader(const Header& header, uint32_t size)
     NS_LOG_FUNCTION(this << &header << size);
     uint32_t uid = header.GetInstanceTypeId().GetUid() << 1;
     DoAddHeader(uid, size);
-    NS_ASSERT(IsStateOk());
 }
 
 void
@@ -653,16 +621,28 @@ PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        Record(ADD_HEADER, uid, size);
+        return;
+    }
+    AddHeaderItem(uid, size, m_chunkUid);
+    m_chunkUid++;
+}
 
+void
+PacketMetadata::AddHeaderItem(uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+    NS_LOG_FUNCTION(this << uid << size << chunkUid);
     PacketMetadata::SmallItem item;
     item.next = m_head;
     item.prev = 0xffff;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = chunkUid;
     uint16_t written = AddSmall(&item);
     UpdateHead(written);
+    NS_ASSERT(IsStateOk());
 }
 
 void
@@ -675,6 +655,35 @@ PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        if (m_chain != nullptr && m_chain->m_operation == ADD_HEADER &&
+            m_chain->m_typeUid == uid && m_chain->m_size == size)
+        {
+            // the header added last is removed: drop its node
+            Node* prev = m_chain->m_prev;
+            if (prev != nullptr)
+            {
+                PacketAllocator::Ref(prev->m_count);
+            }
+            ReleaseChain(m_chain);
+            m_chain = prev;
+            return;
+        }
+        if (m_enableChecking)
+        {
+            Decode().RemoveHeaderItem(uid, size);
+        }
+        Record(REMOVE_HEADER, uid, size);
+        return;
+    }
+    RemoveHeaderItem(uid, size);
+}
+
+void
+PacketMetadata::RemoveHeaderItem(uint32_t uid, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << uid << size);
     PacketMetadata::SmallItem item;
     PacketMetadata::ExtraItem extraItem;
     uint32_t read = ReadItems(m_head, &item, &extraItem);
@@ -720,13 +729,25 @@ PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        Record(ADD_TRAILER, uid, size);
+        return;
+    }
+    AddTrailerItem(uid, size, m_chunkUid);
+    m_chunkUid++;
+}
+
+void
+PacketMetadata::AddTrailerItem(uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+    NS_LOG_FUNCTION(this << uid << size << chunkUid);
     PacketMetadata::SmallItem item;
     item.next = 0xffff;
     item.prev = m_tail;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = chunkUid;
     uint16_t written = AddSmall(&item);
     UpdateTail(written);
     NS_ASSERT(IsStateOk());
@@ -742,6 +763,35 @@ PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        if (m_chain != nullptr && m_chain->m_operation == ADD_TRAILER &&
+            m_chain->m_typeUid == uid && m_chain->m_size == size)
+        {
+            // the trailer added last is removed: drop its node
+            Node* prev = m_chain->m_prev;
+            if (prev != nullptr)
+            {
+                PacketAllocator::Ref(prev->m_count);
+            }
+            ReleaseChain(m_chain);
+            m_chain = prev;
+            return;
+        }
+        if (m_enableChecking)
+        {
+            Decode().RemoveTrailerItem(uid, size);
+        }
+        Record(REMOVE_TRAILER, uid, size);
+        return;
+    }
+    RemoveTrailerItem(uid, size);
+}
+
+void
+PacketMetadata::RemoveTrailerItem(uint32_t uid, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << uid << size);
     PacketMetadata::SmallItem item;
     PacketMetadata::ExtraItem extraItem;
     uint32_t read = ReadItems(m_tail, &item, &extraItem);
@@ -786,6 +836,35 @@ PacketMetadata::AddAtEnd(const PacketMetadata& o)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        if (m_chain == nullptr)
+        {
+            // We have no items so 'AddAtEnd' is
+            // equivalent to self-assignment.
+            *this = o;
+            return;
+        }
+        Node* other = o.m_chain;
+        if (o.m_data != nullptr)
+        {
+            other = (o.m_head != 0xffff) ? CreateSnapshot(o) : nullptr;
+        }
+        else if (other != nullptr)
+        {
+            PacketAllocator::Ref(other->m_count);
+        }
+        if (other != nullptr)
+        {
+            Record(ADD_AT_END, 0, 0, other, o.m_packetUid);
+        }
+        return;
+    }
+    if (o.m_data == nullptr)
+    {
+        AddAtEnd(o.Decode());
+        return;
+    }
     if (m_tail == 0xffff)
     {
         // We have no items so 'AddAtEnd' is
@@ -873,7 +952,14 @@ PacketMetadata::RemoveAtStart(uint32_t start)
         m_metadataSkipped = true;
         return;
     }
-    NS_ASSERT(m_data != nullptr);
+    if (m_data == nullptr)
+    {
+        if (start > 0)
+        {
+            Record(REMOVE_AT_START, 0, start);
+        }
+        return;
+    }
     uint32_t leftToRemove = start;
     uint16_t current = m_head;
     while (current != 0xffff && leftToRemove > 0)
@@ -899,7 +985,7 @@ PacketMetadata::RemoveAtStart(uint32_t start)
         else
         {
             // fragment the list item.
-            PacketMetadata fragment(m_packetUid, 0);
+            PacketMetadata fragment = CreateDecoded(m_packetUid);
             extraItem.fragmentStart += leftToRemove;
             leftToRemove = 0;
             uint16_t written = fragment.AddBig(0xffff, fragment.m_tail, &item, &extraItem);
@@ -934,7 +1020,14 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
         m_metadataSkipped = true;
         return;
     }
-    NS_ASSERT(m_data != nullptr);
+    if (m_data == nullptr)
+    {
+        if (end > 0)
+        {
+            Record(REMOVE_AT_END, 0, end);
+        }
+        return;
+    }
 
     uint32_t leftToRemove = end;
     uint16_t current = m_tail;
@@ -961,7 +1054,7 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
         else
         {
             // fragment the list item.
-            PacketMetadata fragment(m_packetUid, 0);
+            PacketMetadata fragment = CreateDecoded(m_packetUid);
             NS_ASSERT(extraItem.fragmentEnd > leftToRemove);
             extraItem.fragmentEnd -= leftToRemove;
             leftToRemove = 0;
@@ -988,6 +1081,152 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
     NS_ASSERT(IsStateOk());
 }
 
+void
+PacketMetadata::Record(Operation operation,
+                       uint32_t uid,
+                       uint32_t size,
+                       Node* other,
+                       uint64_t otherUid)
+{
+    NS_LOG_FUNCTION(this << static_cast<uint32_t>(operation) << uid << size << other << otherUid);
+    auto node = new (PacketAllocator::Allocate(sizeof(Node))) Node;
+    node->m_count.store(1, std::memory_order_relaxed);
+    node->m_length = 1;
+    node->m_operation = operation;
+    node->m_chunkUid = 0;
+    if (operation == ADD_HEADER || operation == ADD_TRAILER)
+    {
+        node->m_chunkUid = m_chunkUid;
+        m_chunkUid++;
+    }
+    node->m_typeUid = uid;
+    node->m_size = size;
+    node->m_packetUid = otherUid;
+    // the node takes over the reference to the previous node
+    node->m_prev = m_chain;
+    node->m_other = other;
+    node->m_snapshot = nullptr;
+    if (m_chain != nullptr)
+    {
+        node->m_length += m_chain->m_length;
+    }
+    if (other != nullptr)
+    {
+        node->m_length += other->m_length;
+    }
+    m_chain = node;
+
+    if (node->m_length > MAX_CHAIN_LENGTH)
+    {
+        // bound the cost of decoding
+        Node* snapshot = CreateSnapshot(Decode());
+        ReleaseChain(m_chain);
+        m_chain = snapshot;
+    }
+}
+
+PacketMetadata
+PacketMetadata::Decode() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(m_data == nullptr);
+    return Replay(m_chain, m_packetUid);
+}
+
+PacketMetadata
+PacketMetadata::Replay(const Node* chain, uint64_t uid)
+{
+    NS_LOG_FUNCTION(chain << uid);
+    std::vector<const Node*> nodes;
+    const Node* node = chain;
+    while (node != nullptr && node->m_operation != SNAPSHOT)
+    {
+        nodes.push_back(node);
+        node = node->m_prev;
+    }
+    PacketMetadata decoded = (node != nullptr) ? *node->m_snapshot : CreateDecoded(uid);
+
+    for (auto it = nodes.rbegin(); it != nodes.rend(); it++)
+    {
+        node = *it;
+        switch (node->m_operation)
+        {
+        case ADD_HEADER:
+            decoded.AddHeaderItem(node->m_typeUid, node->m_size, node->m_chunkUid);
+            break;
+        case REMOVE_HEADER:
+            decoded.RemoveHeaderItem(node->m_typeUid, node->m_size);
+            break;
+        case ADD_TRAILER:
+            decoded.AddTrailerItem(node->m_typeUid, node->m_size, node->m_chunkUid);
+            break;
+        case REMOVE_TRAILER:
+            decoded.RemoveTrailerItem(node->m_typeUid, node->m_size);
+            break;
+        case ADD_AT_END:
+            decoded.AddAtEnd(Replay(node->m_other, node->m_packetUid));
+            break;
+        case REMOVE_AT_START:
+            decoded.RemoveAtStart(node->m_size);
+            break;
+        case REMOVE_AT_END:
+            decoded.RemoveAtEnd(node->m_size);
+            break;
+        case SNAPSHOT:
+            NS_ASSERT(false);
+            break;
+        }
+    }
+    return decoded;
+}
+
+PacketMetadata
+PacketMetadata::CreateDecoded(uint64_t uid)
+{
+    NS_LOG_FUNCTION(uid);
+    PacketMetadata decoded(uid, 0);
+    if (decoded.m_data == nullptr)
+    {
+        decoded.m_data = PacketMetadata::Create(10);
+        memset(decoded.m_data->m_data, 0xff, 4);
+    }
+    return decoded;
+}
+
+PacketMetadata::Node*
+PacketMetadata::CreateSnapshot(const PacketMetadata& decoded)
+{
+    NS_LOG_FUNCTION(&decoded);
+    NS_ASSERT(decoded.m_data != nullptr);
+    auto node = new (PacketAllocator::Allocate(sizeof(Node))) Node;
+    node->m_count.store(1, std::memory_order_relaxed);
+    node->m_length = 1;
+    node->m_operation = SNAPSHOT;
+    node->m_chunkUid = 0;
+    node->m_typeUid = 0;
+    node->m_size = 0;
+    node->m_packetUid = decoded.m_packetUid;
+    node->m_prev = nullptr;
+    node->m_other = nullptr;
+    node->m_snapshot = new PacketMetadata(decoded);
+    return node;
+}
+
+void
+PacketMetadata::ReleaseChain(Node* chain)
+{
+    NS_LOG_FUNCTION(chain);
+    while (chain != nullptr && PacketAllocator::Unref(chain->m_count))
+    {
+        Node* prev = chain->m_prev;
+        ReleaseChain(chain->m_other);
+        delete chain->m_snapshot;
+        chain->~Node();
+        PacketAllocator::Deallocate(chain, sizeof(Node));
+        chain = prev;
+    }
+}
+
 uint32_t
 PacketMetadata::GetTotalSize() const
 {
@@ -1033,6 +1272,12 @@ PacketMetadata::ItemIterator::ItemIterator(const PacketMetadata* metadata, Buffe
       m_hasReadTail(false)
 {
     NS_LOG_FUNCTION(this << metadata << &buffer);
+    if (metadata->m_data == nullptr)
+    {
+        m_decoded = std::make_shared<const PacketMetadata>(metadata->Decode());
+        m_metadata = m_decoded.get();
+        m_current = m_metadata->m_head;
+    }
 }
 
 bool
@@ -1117,6 +1362,10 @@ PacketMetadata::GetSerializedSize() const
     {
         return totalSize;
     }
+    if (m_data == nullptr)
+    {
+        return Decode().GetSerializedSize();
+    }
 
     PacketMetadata::SmallItem item;
     PacketMetadata::ExtraItem extraItem;
@@ -1150,6 +1399,10 @@ uint32_t
 PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
 {
     NS_LOG_FUNCTION(this << &buffer << maxSize);
+    if (m_data == nullptr)
+    {
+        return Decode().Serialize(buffer, maxSize);
+    }
     uint8_t* start = buffer;
 
     buffer = AddToRawU64(m_packetUid, start, buffer, maxSize);
@@ -1256,6 +1509,15 @@ uint32_t
 PacketMetadata::Deserialize(const uint8_t* buffer, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &buffer << size);
+    if (m_data == nullptr)
+    {
+        PacketMetadata decoded = CreateDecoded(m_packetUid);
+        uint32_t result = decoded.Deserialize(buffer, size);
+        m_packetUid = decoded.m_packetUid;
+        ReleaseChain(m_chain);
+        m_chain = (decoded.m_head != 0xffff) ? CreateSnapshot(decoded) : nullptr;
+        return result;
+    }
     const uint8_t* start = buffer;
     uint32_t desSize = size - 4;
 
@@ -9,12 +9,15 @@
 #define PACKET_METADATA_H
 
 #include "buffer.h"
+#include "packet-allocator.h"
 
 #include "ns3/assert.h"
 #include "ns3/callback.h"
 #include "ns3/type-id.h"
 
+#include <atomic>
 #include <limits>
+#include <memory>
 #include <stdint.h>
 #include <vector>
 
@@ -65,6 +68,18 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When the compact representation is enabled (see EnableCompact()),
+ * the items are not maintained as the packet is modified. Each
+ * operation is instead recorded as a PacketMetadata::Node, which
+ * points to the node of the previous operation: the copies of a
+ * packet share the nodes of their common history, and a node is
+ * never modified once created, so that two copies never have to
+ * copy their metadata when they diverge. The items are only
+ * decoded, by replaying the operations, when the metadata is
+ * iterated over, serialized, or checked, and a chain which has
+ * grown too long is replaced by a snapshot of its items. Such
+ * metadata have no Data.
  */
 class PacketMetadata
 {
@@ -148,6 +163,8 @@ class PacketMetadata
         uint16_t m_current;               //!< current position
         uint32_t m_offset;                //!< offset
         bool m_hasReadTail;               //!< true if the metadata tail has been read
+        /** metadata decoded from a compact metadata, pointed to by m_metadata */
+        std::shared_ptr<const PacketMetadata> m_decoded;
     };
 
     /**
@@ -158,6 +175,22 @@ class PacketMetadata
      * @brief Enable the packet metadata checking
      */
     static void EnableChecking();
+    /**
+     * @brief Enable the packet metadata, in the compact representation
+     *
+     * The metadata of the packets created afterwards is recorded as
+     * a chain of operations shared between the packet copies, and
+     * decoded only when needed.
+     */
+    static void EnableCompact();
+    /**
+     * @brief Use the default representation for the metadata of the
+     * packets created afterwards
+     *
+     * The packet metadata remains enabled, and the existing packets
+     * keep their representation.
+     */
+    static void DisableCompact();
 
     /**
      * @brief Constructor
@@ -415,11 +448,11 @@ class PacketMetadata
     struct Data
     {
         /** number of references to this struct Data instance. */
-        uint32_t m_count;
+        std::atomic<uint32_t> m_count;
         /** size (in bytes) of m_data buffer below */
         uint32_t m_size;
         /** max of the m_used field over all objects which reference this struct Data instance */
-        uint16_t m_dirtyEnd;
+        std::atomic<uint16_t> m_dirtyEnd;
         /** variable-sized buffer of bytes */
         uint8_t m_data[PACKET_METADATA_DATA_M_DATA_SIZE];
     };
@@ -499,15 +532,57 @@ class PacketMetadata
     };
 
     /**
-     * @brief Class to hold all the metadata
+     * The operations recorded by the nodes of a compact metadata chain
      */
-    class DataFreeList : public std::vector<Data*>
+    enum Operation : uint8_t
     {
-      public:
-        ~DataFreeList();
+        ADD_HEADER,      //!< header or payload added at the start
+        REMOVE_HEADER,   //!< header removed from the start
+        ADD_TRAILER,     //!< trailer added at the end
+        REMOVE_TRAILER,  //!< trailer removed from the end
+        ADD_AT_END,      //!< metadata of another packet appended
+        REMOVE_AT_START, //!< bytes removed from the start
+        REMOVE_AT_END,   //!< bytes removed from the end
+        SNAPSHOT         //!< items of the metadata, decoded
+    };
+
+    /**
+     * @brief Node of a compact metadata chain
+     *
+     * The node records an operation performed on the metadata
+     * decoded from its previous nodes. It is reference-counted,
+     * and never modified once created.
+     */
+    struct Node
+    {
+        /** number of references to this node */
+        std::atomic<uint32_t> m_count;
+        /** number of nodes replayed to decode the chain ending with this node */
+        uint32_t m_length;
+        /** operation recorded */
+        Operation m_operation;
+        /** chunk uid of the header or trailer added */
+        uint16_t m_chunkUid;
+        /** type uid of the header or trailer, stored as in SmallItem::typeUid */
+        uint32_t m_typeUid;
+        /** size of the header or trailer, or number of bytes removed */
+        uint32_t m_size;
+        /** uid of the packet whose metadata is appended by ADD_AT_END */
+        uint64_t m_packetUid;
+        /** previous node, or nullptr */
+        Node* m_prev;
+        /** chain of the metadata appended by ADD_AT_END */
+        Node* m_other;
+        /** decoded metadata of a SNAPSHOT */
+        PacketMetadata* m_snapshot;
     };
 
-    friend DataFreeList::~DataFreeList();
+    /**
+     * The length of a compact metadata chain above which it is
+     * replaced by a snapshot.
+     */
+    static constexpr uint32_t MAX_CHAIN_LENGTH = 64;
+
     /// Friend class
     friend class ItemIterator;
 
@@ -600,6 +675,17 @@ class PacketMetadata
      * @param n space to reserve
      */
     void ReserveCopy(uint32_t n);
+    /**
+     * @brief Reserve space at the end of the shared data, if available
+     *
+     * The space is available if the data is large enough, and either not
+     * shared or not yet used by any other metadata sharing it, which may
+     * belong to another thread.
+     *
+     * @param n space to reserve
+     * @returns true if the space was reserved, false if the data must be copied
+     */
+    bool ClaimAtEnd(uint32_t n);
 
     /**
      * @brief Get the total size used by the metadata
@@ -623,6 +709,78 @@ class PacketMetadata
      * @param size header serialized size
      */
     void DoAddHeader(uint32_t uid, uint32_t size);
+    /**
+     * @brief Add an header item to the linked list
+     * @param uid header's uid to add
+     * @param size header serialized size
+     * @param chunkUid header's chunk uid
+     */
+    void AddHeaderItem(uint32_t uid, uint32_t size, uint16_t chunkUid);
+    /**
+     * @brief Remove the header item at the head of the linked list
+     * @param uid header's uid to remove
+     * @param size header serialized size
+     */
+    void RemoveHeaderItem(uint32_t uid, uint32_t size);
+    /**
+     * @brief Add a trailer item to the linked list
+     * @param uid trailer's uid to add
+     * @param size trailer serialized size
+     * @param chunkUid trailer's chunk uid
+     */
+    void AddTrailerItem(uint32_t uid, uint32_t size, uint16_t chunkUid);
+    /**
+     * @brief Remove the trailer item at the tail of the linked list
+     * @param uid trailer's uid to remove
+     * @param size trailer serialized size
+     */
+    void RemoveTrailerItem(uint32_t uid, uint32_t size);
+
+    /**
+     * @brief Record an operation at the end of the compact metadata chain
+     * @param operation the operation
+     * @param uid the type uid of the header or trailer
+     * @param size the size of the header or trailer, or the number of bytes removed
+     * @param other the chain appended by ADD_AT_END, whose reference is taken over
+     * @param otherUid the uid of the packet appended by ADD_AT_END
+     */
+    void Record(Operation operation,
+                uint32_t uid,
+                uint32_t size,
+                Node* other = nullptr,
+                uint64_t otherUid = 0);
+    /**
+     * @brief Decode the compact metadata
+     * @returns the metadata, in the default representation
+     */
+    PacketMetadata Decode() const;
+    /**
+     * @brief Replay the operations of a compact metadata chain
+     * @param chain the last node of the chain, or nullptr
+     * @param uid the packet uid of the metadata
+     * @returns the decoded metadata, in the default representation
+     */
+    static PacketMetadata Replay(const Node* chain, uint64_t uid);
+    /**
+     * @brief Create an empty metadata in the default representation
+     * @param uid the packet uid
+     * @returns the metadata
+     */
+    static PacketMetadata CreateDecoded(uint64_t uid);
+    /**
+     * @brief Create a snapshot node
+     * @param decoded the metadata, in the default representation
+     * @returns the node, with one reference
+     */
+    static Node* CreateSnapshot(const PacketMetadata& decoded);
+    /**
+     * @brief Release a reference to the last node of a chain
+     *
+     * The nodes which are no longer referenced are freed.
+     *
+     * @param chain the last node of the chain, or nullptr
+     */
+    static void ReleaseChain(Node* chain);
     /**
      * @brief Check if the metadata state is ok
      * @returns true if the internal state is ok
@@ -648,25 +806,18 @@ class PacketMetadata
     static void Recycle(PacketMetadata::Data* data);
     /**
      * @brief Create a buffer data storage
+     *
+     * The storage is allocated from the PacketAllocator, and its size
+     * is rounded up to the capacity of the allocated block.
+     *
      * @param size the storage size to create
      * @returns a pointer to the created buffer storage
      */
     static PacketMetadata::Data* Create(uint32_t size);
-    /**
-     * @brief Allocate a buffer data storage
-     * @param n the storage size to create
-     * @returns a pointer to the allocated buffer storage
-     */
-    static PacketMetadata::Data* Allocate(uint32_t n);
-    /**
-     * @brief Deallocate the buffer memory
-     * @param data the buffer data storage
-     */
-    static void Deallocate(PacketMetadata::Data* data);
 
-    static DataFreeList m_freeList; //!< the metadata data storage
-    static bool m_enable;           //!< Enable the packet metadata
-    static bool m_enableChecking;   //!< Enable the packet metadata checking
+    static bool m_enable;         //!< Enable the packet metadata
+    static bool m_enableChecking; //!< Enable the packet metadata checking
+    static bool m_enableCompact;  //!< Use the compact representation for new metadata
 
     /**
      * Set to true when adding metadata to a packet is skipped because
@@ -675,10 +826,10 @@ class PacketMetadata
      */
     static bool m_metadataSkipped;
 
-    static uint32_t m_maxSize;  //!< maximum metadata size
-    static uint16_t m_chunkUid; //!< Chunk Uid
+    static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
-    Data* m_data; //!< Metadata storage
+    Data* m_data;  //!< Metadata storage, or nullptr if compact
+    Node* m_chain; //!< Last node of the compact metadata chain
     /*
        head -(next)-> tail
          ^             |
@@ -696,13 +847,17 @@ namespace ns3
 {
 
 PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
-    : m_data(PacketMetadata::Create(10)),
+    : m_data(m_enableCompact ? nullptr : PacketMetadata::Create(10)),
+      m_chain(nullptr),
       m_head(0xffff),
       m_tail(0xffff),
       m_used(0),
       m_packetUid(uid)
 {
-    memset(m_data->m_data, 0xff, 4);
+    if (m_data != nullptr)
+    {
+        memset(m_data->m_data, 0xff, 4);
+    }
     if (size > 0)
     {
         DoAddHeader(0, size);
@@ -711,14 +866,21 @@ PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
 
 PacketMetadata::PacketMetadata(const PacketMetadata& o)
     : m_data(o.m_data),
+      m_chain(o.m_chain),
       m_head(o.m_head),
       m_tail(o.m_tail),
       m_used(o.m_used),
       m_packetUid(o.m_packetUid)
 {
-    NS_ASSERT(m_data != nullptr);
-    NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
-    m_data->m_count++;
+    if (m_data != nullptr)
+    {
+        NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
+        PacketAllocator::Ref(m_data->m_count);
+    }
+    if (m_chain != nullptr)
+    {
+        PacketAllocator::Ref(m_chain->m_count);
+    }
 }
 
 PacketMetadata&
@@ -727,15 +889,24 @@ PacketMetadata::operator=(const PacketMetadata& o)
     if (m_data != o.m_data)
     {
         // not self assignment
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (m_data != nullptr && PacketAllocator::Unref(m_data->m_count))
         {
             PacketMetadata::Recycle(m_data);
         }
         m_data = o.m_data;
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count++;
+        if (m_data != nullptr)
+        {
+            PacketAllocator::Ref(m_data->m_count);
+        }
+    }
+    if (m_chain != o.m_chain)
+    {
+        if (o.m_chain != nullptr)
+        {
+            PacketAllocator::Ref(o.m_chain->m_count);
+        }
+        PacketMetadata::ReleaseChain(m_chain);
+        m_chain = o.m_chain;
     }
     m_head = o.m_head;
     m_tail = o.m_tail;
@@ -746,12 +917,14 @@ PacketMetadata::operator=(const PacketMetadata& o)
 
 PacketMetadata::~PacketMetadata()
 {
-    NS_ASSERT(m_data != nullptr);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (m_data != nullptr && PacketAllocator::Unref(m_data->m_count))
     {
         PacketMetadata::Recycle(m_data);
     }
+    if (m_chain != nullptr)
+    {
+        PacketMetadata::ReleaseChain(m_chain);
+    }
 }
 
 } // namespace ns3
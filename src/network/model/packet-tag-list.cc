@@ -13,6 +13,7 @@
 
 #include "packet-tag-list.h"
 
+#include "packet-allocator.h"
 #include "tag-buffer.h"
 #include "tag.h"
 
@@ -33,14 +34,23 @@ PacketTagList::CreateTagData(size_t dataSize)
                   "Requested TagData size " << dataSize << " exceeds maximum "
                                             << std::numeric_limits<decltype(TagData::size)>::max());
 
-    void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
+    void* p = PacketAllocator::Allocate(sizeof(TagData) + dataSize - 1);
+    // The matching free is in DestroyTagData
 
     auto tag = new (p) TagData;
+    tag->count.store(1, std::memory_order_relaxed);
     tag->size = dataSize;
     return tag;
 }
 
+void
+PacketTagList::DestroyTagData(TagData* tag)
+{
+    std::size_t size = sizeof(TagData) + tag->size - 1;
+    tag->~TagData();
+    PacketAllocator::Deallocate(tag, size);
+}
+
 bool
 PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
 {
@@ -63,7 +73,7 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     // Search from the head of the list until we find tid or a merge
     while (cur != nullptr)
     {
-        if (cur->count > 1)
+        if (cur->count.load(std::memory_order_acquire) > 1)
         {
             // found merge
             NS_LOG_INFO("found initial merge before tid");
@@ -108,9 +118,11 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
         return found;
     }
 
-    // At this point cur is a merge, but untested for tid
+    // At this point cur is a merge, but untested for tid.  The other
+    // lists sharing it may be released concurrently by other threads,
+    // so its count may have dropped to 1 since: cur is then only
+    // unlinked after it has been copied.
     NS_ASSERT(cur != nullptr);
-    NS_ASSERT(cur->count > 1);
 
     /*
        Walk the remainder of the list, copying, until we find tid
@@ -138,23 +150,20 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     while (/* cur && */ cur->tid != tid)
     {
         NS_ASSERT(cur != nullptr);
-        NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
         TagData* copy = CreateTagData(cur->size);
         copy->tid = cur->tid;
-        copy->count = 1;
         copy->size = cur->size;
         memcpy(copy->data, cur->data, copy->size);
-        copy->next = cur->next; // merge into tail
-        copy->next->count++;    // mark new merge
-        *prevNext = copy;       // point prior list at copy
-        prevNext = &copy->next; // advance
+        copy->next = cur->next;                                    // merge into tail
+        PacketAllocator::Ref(copy->next->count); // mark new merge
+        *prevNext = copy;                                          // point prior list at copy
+        prevNext = &copy->next;                                    // advance
+        Unlink(cur);                                               // unmerge cur
         cur = copy->next;
     }
     // Sanity check:
     NS_ASSERT(cur != nullptr);  // cur should be non-zero
     NS_ASSERT(cur->tid == tid); // cur->tid should be tid
-    NS_ASSERT(cur->count > 1);  // cur should be a merge
 
     // link around tid, removing it from our list
     found = (this->*Writer)(tag, false, cur, prevNext);
@@ -184,19 +193,18 @@ PacketTagList::RemoveWriter(Tag& tag,
     if (preMerge)
     {
         // found tid before first merge, so delete cur
-        cur->~TagData();
-        std::free(cur);
+        DestroyTagData(cur);
     }
     else
     {
         // cur is always a merge at this point
-        // unmerge cur, since we linked around it already
-        cur->count--;
         if (cur->next != nullptr)
         {
             // there's a next, so make it a merge
-            cur->next->count++;
+            PacketAllocator::Ref(cur->next->count);
         }
+        // unmerge cur, since we linked around it already
+        Unlink(cur);
     }
     return found;
 }
@@ -232,17 +240,16 @@ PacketTagList::ReplaceWriter(Tag& tag,
     {
         // cur is always a merge at this point
         // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
         TagData* copy = CreateTagData(tag.GetSerializedSize());
         copy->tid = tag.GetInstanceTypeId();
-        copy->count = 1;
         tag.Serialize(TagBuffer(copy->data, copy->data + copy->size));
         copy->next = cur->next; // merge into tail
         if (copy->next != nullptr)
         {
-            copy->next->count++; // mark new merge
+            PacketAllocator::Ref(copy->next->count); // mark new merge
         }
         *prevNext = copy; // point prior list at copy
+        Unlink(cur);      // unmerge cur
     }
     return found;
 }
@@ -259,7 +266,6 @@ PacketTagList::Add(const Tag& tag) const
                           << tag.GetInstanceTypeId().GetName());
     }
     TagData* head = CreateTagData(tag.GetSerializedSize());
-    head->count = 1;
     head->next = nullptr;
     head->tid = tag.GetInstanceTypeId();
     head->next = m_next;
@@ -412,7 +418,6 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
         NS_LOG_INFO("Deserializing tag of type " << tid);
 
         TagData* newTag = CreateTagData(tagSize);
-        newTag->count = 1;
         newTag->next = nullptr;
         newTag->tid = tid;
 
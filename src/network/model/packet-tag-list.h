@@ -13,8 +13,11 @@
 \brief  Defines a linked list of Packet tags, including copy-on-write semantics.
 */
 
+#include "packet-allocator.h"
+
 #include "ns3/type-id.h"
 
+#include <atomic>
 #include <ostream>
 #include <stdint.h>
 
@@ -130,11 +133,11 @@ class PacketTagList
      */
     struct TagData
     {
-        TagData* next;   //!< Pointer to next in list
-        uint32_t count;  //!< Number of incoming links
-        TypeId tid;      //!< Type of the tag serialized into #data
-        uint32_t size;   //!< Size of the \c data buffer
-        uint8_t data[1]; //!< Serialization buffer
+        TagData* next;               //!< Pointer to next in list
+        std::atomic<uint32_t> count; //!< Number of incoming links
+        TypeId tid;                  //!< Type of the tag serialized into #data
+        uint32_t size;               //!< Size of the \c data buffer
+        uint8_t data[1];             //!< Serialization buffer
     };
 
     /**
@@ -238,10 +241,28 @@ class PacketTagList
      * large enough to serialize dataSize bytes from a Tag.
      *
      * @param [in] dataSize The serialized size of the Tag.
-     * @returns The newly constructed TagData object.
+     * @returns The newly constructed TagData object, with one link.
      */
     static TagData* CreateTagData(size_t dataSize);
 
+    /**
+     * Destroy and free a TagData struct.
+     *
+     * @param [in] tag The TagData object.
+     */
+    static void DestroyTagData(TagData* tag);
+
+    /**
+     * Remove a link to a TagData, and free it and its successors which
+     * are not linked anymore.
+     *
+     * The lists sharing the successors may belong to other threads, so
+     * the last link to a TagData is found with an atomic decrement.
+     *
+     * @param [in] cur The TagData object, or nullptr.
+     */
+    static inline void Unlink(TagData* cur);
+
     /**
      * Typedef of method function pointer for copy-on-write operations
      *
@@ -315,7 +336,7 @@ PacketTagList::PacketTagList(const PacketTagList& o)
 {
     if (m_next != nullptr)
     {
-        m_next->count++;
+        PacketAllocator::Ref(m_next->count);
     }
 }
 
@@ -331,7 +352,7 @@ PacketTagList::operator=(const PacketTagList& o)
     m_next = o.m_next;
     if (m_next != nullptr)
     {
-        m_next->count++;
+        PacketAllocator::Ref(m_next->count);
     }
     return *this;
 }
@@ -342,28 +363,20 @@ PacketTagList::~PacketTagList()
 }
 
 void
-PacketTagList::RemoveAll()
+PacketTagList::Unlink(TagData* cur)
 {
-    TagData* prev = nullptr;
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    while (cur != nullptr && PacketAllocator::Unref(cur->count))
     {
-        cur->count--;
-        if (cur->count > 0)
-        {
-            break;
-        }
-        if (prev != nullptr)
-        {
-            prev->~TagData();
-            std::free(prev);
-        }
-        prev = cur;
-    }
-    if (prev != nullptr)
-    {
-        prev->~TagData();
-        std::free(prev);
+        TagData* next = cur->next;
+        DestroyTagData(cur);
+        cur = next;
     }
+}
+
+void
+PacketTagList::RemoveAll()
+{
+    Unlink(m_next);
     m_next = nullptr;
 }
 
@@ -7,6 +7,8 @@
  */
 #include "packet.h"
 
+#include "packet-allocator.h"
+
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -21,6 +23,17 @@ NS_LOG_COMPONENT_DEFINE("Packet");
 
 uint32_t Packet::m_globalUid = 0;
 
+/**
+ * @ingroup packet
+ * The counter of the packet uids of the calling thread, if not the global one.
+ */
+static thread_local uint32_t* g_threadUidCounter = nullptr;
+/**
+ * @ingroup packet
+ * The upper 32 bits of the packet uids given by g_threadUidCounter.
+ */
+static thread_local uint32_t g_threadUidPrefix = 0;
+
 TypeId
 ByteTagIterator::Item::GetTypeId() const
 {
@@ -129,16 +142,32 @@ Packet::Packet()
     : m_buffer(),
       m_byteTagList(),
       m_packetTagList(),
-      /* The upper 32 bits of the packet id in
-       * metadata is for the system id. For non-
-       * distributed simulations, this is simply
-       * zero.  The lower 32 bits are for the
-       * global UID
-       */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, 0),
+      m_metadata(NextUid(), 0),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
+}
+
+uint64_t
+Packet::NextUid()
+{
+    if (g_threadUidCounter != nullptr)
+    {
+        return static_cast<uint64_t>(g_threadUidPrefix) << 32 | (*g_threadUidCounter)++;
+    }
+    /* The upper 32 bits of the packet id in
+     * metadata is for the system id. For non-
+     * distributed simulations, this is simply
+     * zero.  The lower 32 bits are for the
+     * global UID
+     */
+    return static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid++;
+}
+
+void
+Packet::SetThreadUidCounter(uint32_t* counter, uint32_t prefix)
+{
+    g_threadUidCounter = counter;
+    g_threadUidPrefix = prefix;
 }
 
 Packet::Packet(const Packet& o)
@@ -150,6 +179,18 @@ Packet::Packet(const Packet& o)
     o.m_nixVector ? m_nixVector = o.m_nixVector->Copy() : m_nixVector = nullptr;
 }
 
+void*
+Packet::operator new(std::size_t size)
+{
+    return PacketAllocator::Allocate(size);
+}
+
+void
+Packet::operator delete(void* packet, std::size_t size)
+{
+    PacketAllocator::Deallocate(packet, size);
+}
+
 Packet&
 Packet::operator=(const Packet& o)
 {
@@ -169,16 +210,9 @@ Packet::Packet(uint32_t size)
     : m_buffer(size),
       m_byteTagList(),
       m_packetTagList(),
-      /* The upper 32 bits of the packet id in
-       * metadata is for the system id. For non-
-       * distributed simulations, this is simply
-       * zero.  The lower 32 bits are for the
-       * global UID
-       */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(NextUid(), size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const uint8_t* buffer, uint32_t size, bool magic)
@@ -196,16 +230,9 @@ Packet::Packet(const uint8_t* buffer, uint32_t size)
     : m_buffer(),
       m_byteTagList(),
       m_packetTagList(),
-      /* The upper 32 bits of the packet id in
-       * metadata is for the system id. For non-
-       * distributed simulations, this is simply
-       * zero.  The lower 32 bits are for the
-       * global UID
-       */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(NextUid(), size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
     m_buffer.AddAtStart(size);
     Buffer::Iterator i = m_buffer.Begin();
     i.Write(buffer, size);
@@ -588,6 +615,13 @@ Packet::EnablePrinting()
     PacketMetadata::Enable();
 }
 
+void
+Packet::EnableCompactPrinting()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    PacketMetadata::EnableCompact();
+}
+
 void
 Packet::EnableChecking()
 {
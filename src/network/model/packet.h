@@ -243,6 +243,18 @@ class Packet : public SimpleRefCount<Packet>
      * @return the copied object
      */
     Packet& operator=(const Packet& o);
+    /**
+     * @brief Allocate a packet from the PacketAllocator
+     * @param size the size of the packet object
+     * @return the memory of the packet
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * @brief Return the memory of a packet to the PacketAllocator
+     * @param packet the memory of the packet
+     * @param size the size of the packet object
+     */
+    static void operator delete(void* packet, std::size_t size);
     /**
      * @brief Create a packet with a zero-filled payload.
      *
@@ -514,6 +526,18 @@ class Packet : public SimpleRefCount<Packet>
      * simulation setup and before any packet is created.
      */
     static void EnablePrinting();
+    /**
+     * @brief Enable printing packets metadata, recorded in a compact form.
+     *
+     * Same as EnablePrinting, but the metadata is recorded as a chain
+     * of the header and trailer operations, which is shared between
+     * the copies of a packet and decoded only when a packet is printed
+     * or its metadata iterated over. This keeps the cost of the metadata
+     * small and constant, so that it can be left enabled in long runs.
+     *
+     * \sa PacketMetadata::EnableCompact
+     */
+    static void EnableCompactPrinting();
     /**
      * @brief Enable packets metadata checking.
      *
@@ -526,6 +550,22 @@ class Packet : public SimpleRefCount<Packet>
      */
     static void EnableChecking();
 
+    /**
+     * @brief Select the counter giving the uid of the packets created by
+     * the calling thread.
+     *
+     * By default, the lower 32 bits of the uids come from a global
+     * counter, and the upper 32 bits are the system id.  A parallel
+     * simulator implementation running logical processes on a pool of
+     * threads gives each logical process its own counter, and its
+     * identifier as the upper 32 bits, so that the threads do not share
+     * the global counter and the uids do not depend on their interleaving.
+     *
+     * @param [in] counter The counter, or nullptr to use the shared one.
+     * @param [in] prefix The upper 32 bits of the uids given by \p counter.
+     */
+    static void SetThreadUidCounter(uint32_t* counter, uint32_t prefix);
+
     /**
      * @brief Returns number of bytes required for packet
      * serialization.
@@ -776,6 +816,12 @@ class Packet : public SimpleRefCount<Packet>
      */
     uint32_t Deserialize(const uint8_t* buffer, uint32_t size);
 
+    /**
+     * @brief Get the uid of a new packet.
+     * @returns the next uid of the counter of the calling thread.
+     */
+    static uint64_t NextUid();
+
     Buffer m_buffer;               //!< the packet buffer (it's actual contents)
     ByteTagList m_byteTagList;     //!< the ByteTag list
     PacketTagList m_packetTagList; //!< the packet's Tag list
@@ -0,0 +1,218 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/binary-trace.h"
+#include "ns3/pcap-writer.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup network-test
+ * Binary trace test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Check that the records written to a binary trace are read back.
+ */
+class BinaryTraceRoundTripTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     *
+     * @param compress Whether the blocks are compressed.
+     */
+    BinaryTraceRoundTripTestCase(bool compress);
+
+  private:
+    void DoRun() override;
+
+    bool m_compress; //!< Whether the blocks are compressed.
+};
+
+BinaryTraceRoundTripTestCase::BinaryTraceRoundTripTestCase(bool compress)
+    : TestCase(std::string("Check the round trip of the records, ") +
+               (compress ? "compressed" : "uncompressed")),
+      m_compress(compress)
+{
+}
+
+void
+BinaryTraceRoundTripTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("binary-trace.nsbt");
+
+    // Several full blocks and a partial one, flushed when the writer is destroyed
+    const uint32_t blockSize = 100;
+    std::vector<BinaryTraceRecord> records;
+    for (uint32_t i = 0; i < 1050; i++)
+    {
+        records.push_back({1000000 * int64_t(i / 3),
+                           i % 7,
+                           i % 2,
+                           uint8_t(i % BinaryTraceRecord::N_KINDS),
+                           (uint64_t(1) << 40) + i,
+                           40 + i});
+    }
+    {
+        auto writer = Create<BinaryTraceWriter>(filename, blockSize, m_compress);
+        NS_TEST_ASSERT_MSG_EQ(writer->Fail(), false, "Unable to create " << filename);
+        for (std::size_t i = 0; i < records.size(); i++)
+        {
+            if (i % 2)
+            {
+                writer->Write(records[i]);
+            }
+            else
+            {
+                const auto& r = records[i];
+                writer->Write(NanoSeconds(r.time), r.node, r.device, r.kind, r.uid, r.size);
+            }
+        }
+    }
+
+    BinaryTraceReader reader(filename);
+    NS_TEST_ASSERT_MSG_EQ(reader.Fail(), false, "Unable to read " << filename);
+    const std::vector<std::string> columns{"time_ns", "node", "device", "kind", "uid", "size"};
+    NS_TEST_EXPECT_MSG_EQ((reader.GetColumnNames() == columns), true, "Wrong schema");
+    NS_TEST_EXPECT_MSG_EQ(reader.GetKindName(BinaryTraceRecord::DEQUEUE),
+                          "dequeue",
+                          "Wrong kind name");
+
+    // The records are read back block by block, then record by record
+    BinaryTraceBlock block;
+    NS_TEST_ASSERT_MSG_EQ(reader.ReadBlock(block), true, "First block not read");
+    NS_TEST_EXPECT_MSG_EQ(block.GetSize(), blockSize, "Wrong size of the block");
+    NS_TEST_EXPECT_MSG_EQ(block.times[blockSize - 1],
+                          records[blockSize - 1].time,
+                          "Wrong time in the block");
+    std::size_t i = blockSize;
+    BinaryTraceRecord record;
+    while (reader.Read(record))
+    {
+        NS_TEST_ASSERT_MSG_LT(i, records.size(), "Too many records");
+        NS_TEST_EXPECT_MSG_EQ(record.time, records[i].time, "Wrong time of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.node, records[i].node, "Wrong node of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.device, records[i].device, "Wrong device of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(+record.kind, +records[i].kind, "Wrong kind of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.uid, records[i].uid, "Wrong uid of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.size, records[i].size, "Wrong size of record " << i);
+        i++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(i, records.size(), "Records missing");
+    NS_TEST_EXPECT_MSG_EQ(reader.Fail(), false, "Trace reported as corrupted");
+
+    // The compressed blocks are much smaller than the uncompressed ones
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    std::size_t fileSize = file.tellg();
+    if (m_compress && PcapWriter::IsCompressionSupported())
+    {
+        NS_TEST_EXPECT_MSG_LT(fileSize, records.size() * 29 / 2, "Blocks not compressed");
+    }
+    else
+    {
+        NS_TEST_EXPECT_MSG_GT(fileSize, records.size() * 29, "Blocks compressed");
+    }
+
+    remove(filename.c_str());
+}
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Check that the invalid binary traces are reported.
+ */
+class BinaryTraceInvalidTestCase : public TestCase
+{
+  public:
+    BinaryTraceInvalidTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+BinaryTraceInvalidTestCase::BinaryTraceInvalidTestCase()
+    : TestCase("Check that the invalid binary traces are reported")
+{
+}
+
+void
+BinaryTraceInvalidTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("invalid.nsbt");
+
+    BinaryTraceReader missing(filename);
+    NS_TEST_EXPECT_MSG_EQ(missing.Fail(), true, "Missing file not reported");
+
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "not a binary trace";
+    }
+    BinaryTraceReader notTrace(filename);
+    NS_TEST_EXPECT_MSG_EQ(notTrace.Fail(), true, "Invalid file not reported");
+
+    // Truncate the last block of a trace
+    {
+        auto writer = Create<BinaryTraceWriter>(filename, 10);
+        for (uint32_t i = 0; i < 15; i++)
+        {
+            writer->Write(Seconds(i), 0, 0, BinaryTraceRecord::TRANSMIT, i, 100);
+        }
+    }
+    std::vector<char> bytes;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size() - 10);
+    }
+    BinaryTraceReader truncated(filename);
+    NS_TEST_EXPECT_MSG_EQ(truncated.Fail(), false, "Schema not read");
+    BinaryTraceRecord record;
+    uint32_t n = 0;
+    while (truncated.Read(record))
+    {
+        n++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(n, 10, "Wrong number of records before the truncated block");
+    NS_TEST_EXPECT_MSG_EQ(truncated.Fail(), true, "Truncated block not reported");
+
+    remove(filename.c_str());
+}
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Binary trace TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+  public:
+    BinaryTraceTestSuite();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite()
+    : TestSuite("binary-trace", Type::UNIT)
+{
+    AddTestCase(new BinaryTraceRoundTripTestCase(false), TestCase::Duration::QUICK);
+    AddTestCase(new BinaryTraceRoundTripTestCase(true), TestCase::Duration::QUICK);
+    AddTestCase(new BinaryTraceInvalidTestCase(), TestCase::Duration::QUICK);
+}
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
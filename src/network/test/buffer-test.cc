@@ -8,9 +8,12 @@
 
 #include "ns3/buffer.h"
 #include "ns3/double.h"
+#include "ns3/packet-allocator.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/test.h"
 
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -384,6 +387,203 @@ BufferTest::DoRun()
     NS_TEST_ASSERT_MSG_EQ(val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * Check buffers with several virtual zero areas, created by appending
+ * buffers which contain virtual zero bytes.
+ */
+class BufferZeroAreasTest : public TestCase
+{
+  private:
+    /**
+     * Checks the buffer content
+     * @param b The buffer to check
+     * @param expected The bytes that should be in the buffer
+     * @param msg The message to report
+     */
+    void CheckContent(const Buffer& b, const std::vector<uint8_t>& expected, std::string msg);
+
+  public:
+    void DoRun() override;
+    BufferZeroAreasTest();
+};
+
+BufferZeroAreasTest::BufferZeroAreasTest()
+    : TestCase("Buffer with several zero areas")
+{
+}
+
+void
+BufferZeroAreasTest::CheckContent(const Buffer& b,
+                                  const std::vector<uint8_t>& expected,
+                                  std::string msg)
+{
+    NS_TEST_ASSERT_MSG_EQ(b.GetSize(), expected.size(), msg << ": wrong size");
+    std::vector<uint8_t> copied(expected.size());
+    NS_TEST_ASSERT_MSG_EQ(b.CopyData(copied.data(), copied.size()),
+                          expected.size(),
+                          msg << ": wrong size copied");
+    NS_TEST_EXPECT_MSG_EQ((copied == expected), true, msg << ": wrong bytes copied");
+
+    std::ostringstream oss;
+    b.CopyData(&oss, b.GetSize());
+    NS_TEST_EXPECT_MSG_EQ((oss.str() == std::string(expected.begin(), expected.end())),
+                          true,
+                          msg << ": wrong bytes copied to a stream");
+
+    bool ok = true;
+    Buffer::Iterator i = b.Begin();
+    for (uint32_t j = 0; j < expected.size(); j++)
+    {
+        ok = ok && i.ReadU8() == expected[j];
+    }
+    NS_TEST_EXPECT_MSG_EQ(ok, true, msg << ": wrong bytes read");
+    ok = true;
+    i = b.Begin();
+    for (uint32_t j = 0; j + 2 <= expected.size(); j += 2)
+    {
+        ok = ok && i.ReadNtohU16() == ((expected[j] << 8) | expected[j + 1]);
+    }
+    NS_TEST_EXPECT_MSG_EQ(ok, true, msg << ": wrong bytes read in network order");
+    i = b.End();
+    i.Prev(b.GetSize());
+    ok = i.IsStart();
+    for (uint32_t j = 0; j < expected.size(); j++)
+    {
+        ok = ok && i.PeekU8() == expected[j];
+        i.Next();
+    }
+    NS_TEST_EXPECT_MSG_EQ(ok, true, msg << ": wrong bytes peeked");
+
+    std::vector<uint8_t> serialized(b.GetSerializedSize());
+    NS_TEST_ASSERT_MSG_EQ(b.Serialize(serialized.data(), serialized.size()),
+                          1,
+                          msg << ": serialization failed");
+    Buffer deserialized(0, false);
+    // the size includes the length field written by Packet::Serialize
+    deserialized.Deserialize(serialized.data(), serialized.size() + 4);
+    NS_TEST_EXPECT_MSG_EQ((std::vector<uint8_t>(deserialized.PeekData(),
+                                                deserialized.PeekData() + expected.size()) ==
+                           expected),
+                          true,
+                          msg << ": wrong bytes deserialized");
+}
+
+void
+BufferZeroAreasTest::DoRun()
+{
+    const uint32_t nSubframes = 32;
+    const uint32_t payloadSize = 1400;
+    std::vector<uint8_t> expected;
+    auto before = PacketAllocator::GetStatistics();
+    {
+        // An aggregate of subframes, each one made of a header, a zero
+        // payload and a trailer
+        Buffer aggregate;
+        for (uint32_t k = 0; k < nSubframes; k++)
+        {
+            Buffer subframe(payloadSize + k);
+            subframe.AddAtStart(3);
+            Buffer::Iterator i = subframe.Begin();
+            i.WriteU8(0xaa);
+            i.WriteHtonU16(k);
+            subframe.AddAtEnd(1);
+            i = subframe.End();
+            i.Prev();
+            i.WriteU8(k);
+            aggregate.AddAtEnd(subframe);
+
+            expected.insert(expected.end(), {0xaa, 0, static_cast<uint8_t>(k)});
+            expected.insert(expected.end(), payloadSize + k, 0);
+            expected.push_back(k);
+        }
+        auto after = PacketAllocator::GetStatistics();
+        NS_TEST_EXPECT_MSG_LT(after.bytesInUse - before.bytesInUse,
+                              payloadSize * 4,
+                              "The zero payloads have been allocated");
+        CheckContent(aggregate, expected, "aggregate");
+
+        // Fragments, including ones which start or end in a zero area
+        uint32_t subframeSize = payloadSize + 4;
+        for (uint32_t start : {0U, 1U, 3U, 100U, subframeSize - 1, subframeSize + 2})
+        {
+            for (uint32_t length : {0U, 1U, 5U, 2 * subframeSize + 7, 5 * subframeSize})
+            {
+                Buffer fragment = aggregate.CreateFragment(start, length);
+                std::ostringstream msg;
+                msg << "fragment " << start << "+" << length;
+                CheckContent(fragment,
+                             std::vector<uint8_t>(expected.begin() + start,
+                                                  expected.begin() + start + length),
+                             msg.str());
+            }
+        }
+
+        // Fragments appended back together
+        Buffer rebuilt;
+        for (uint32_t start = 0; start < aggregate.GetSize(); start += 1000)
+        {
+            uint32_t length = std::min<uint32_t>(1000, aggregate.GetSize() - start);
+            rebuilt.AddAtEnd(aggregate.CreateFragment(start, length));
+        }
+        CheckContent(rebuilt, expected, "rebuilt");
+
+        // The subframes of the aggregate
+        Buffer remaining = aggregate;
+        for (uint32_t k = 0; k < nSubframes; k++)
+        {
+            Buffer::Iterator i = remaining.Begin();
+            NS_TEST_EXPECT_MSG_EQ(i.ReadU8(), 0xaa, "Wrong first header byte");
+            NS_TEST_EXPECT_MSG_EQ(i.ReadNtohU16(), k, "Wrong subframe header");
+            i.Next(payloadSize + k);
+            NS_TEST_EXPECT_MSG_EQ(i.ReadU8(), k, "Wrong subframe trailer");
+            remaining.RemoveAtStart(payloadSize + k + 4);
+        }
+        NS_TEST_EXPECT_MSG_EQ(remaining.GetSize(), 0, "Wrong remaining size");
+
+        // The trailers removed one by one, from the end
+        remaining = aggregate;
+        std::vector<uint8_t> left = expected;
+        for (uint32_t k = nSubframes; k-- > nSubframes - 3;)
+        {
+            remaining.RemoveAtEnd(1);
+            left.pop_back();
+            CheckContent(remaining, left, "without trailer");
+            remaining.RemoveAtEnd(payloadSize + k + 3);
+            left.resize(left.size() - payloadSize - k - 3);
+            CheckContent(remaining, left, "without subframe");
+        }
+
+        // Headers written over the ones of the aggregate
+        remaining = Buffer();
+        aggregate.AddAtStart(2);
+        Buffer::Iterator i = aggregate.Begin();
+        i.WriteHtonU16(0x1234);
+        for (uint32_t k = 0; k < nSubframes; k++)
+        {
+            i.WriteU8(0xbb);
+            i.WriteHtonU16(k + 1);
+            i.Next(payloadSize + k);
+            i.WriteU8(k + 1);
+        }
+        std::vector<uint8_t> modified = {0x12, 0x34};
+        for (uint32_t k = 0; k < nSubframes; k++)
+        {
+            modified.insert(modified.end(), {0xbb, 0, static_cast<uint8_t>(k + 1)});
+            modified.insert(modified.end(), payloadSize + k, 0);
+            modified.push_back(k + 1);
+        }
+        CheckContent(aggregate, modified, "modified");
+
+        Buffer other;
+        other.AddAtStart(aggregate.GetSize());
+        other.Begin().Write(aggregate.Begin(), aggregate.End());
+        CheckContent(other, modified, "written");
+    }
+}
+
 /**
  * @ingroup network-test
  * @ingroup tests
@@ -400,6 +600,7 @@ BufferTestSuite::BufferTestSuite()
     : TestSuite("buffer", Type::UNIT)
 {
     AddTestCase(new BufferTest, TestCase::Duration::QUICK);
+    AddTestCase(new BufferZeroAreasTest, TestCase::Duration::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
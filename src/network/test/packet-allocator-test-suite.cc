@@ -0,0 +1,212 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/flow-id-tag.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/packet-allocator.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup network-test
+ * PacketAllocator test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Check the size classes and the free lists of the PacketAllocator.
+ */
+class PacketAllocatorFreeListTestCase : public TestCase
+{
+  public:
+    PacketAllocatorFreeListTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PacketAllocatorFreeListTestCase::PacketAllocatorFreeListTestCase()
+    : TestCase("Check the size classes and the free lists")
+{
+}
+
+void
+PacketAllocatorFreeListTestCase::DoRun()
+{
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(1), 32, "Wrong smallest size class");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(33), 48, "Wrong size class");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(48), 48, "Wrong size class");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(49), 64, "Wrong size class");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(1500), 1536, "Wrong size class");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(65536), 65536, "Wrong largest size class");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetCapacity(70000), 70000, "Wrong large block");
+
+    // Run in a new thread, so that its free lists start empty
+    auto before = PacketAllocator::GetStatistics();
+    std::atomic<bool> reused = false;
+    std::thread thread([&reused]() {
+        void* first = PacketAllocator::Allocate(1000);
+        PacketAllocator::Deallocate(first, 1000);
+        void* second = PacketAllocator::Allocate(1020);
+        reused = (first == second);
+        void* large = PacketAllocator::Allocate(100000);
+        PacketAllocator::Deallocate(large, 100000);
+        PacketAllocator::Deallocate(second, 1020);
+    });
+    thread.join();
+    auto after = PacketAllocator::GetStatistics();
+
+    NS_TEST_EXPECT_MSG_EQ(reused, true, "Block of the same size class not reused");
+    NS_TEST_EXPECT_MSG_EQ(after.allocations - before.allocations, 3, "Wrong allocations");
+    NS_TEST_EXPECT_MSG_EQ(after.deallocations - before.deallocations, 3, "Wrong deallocations");
+    NS_TEST_EXPECT_MSG_EQ(after.cacheHits - before.cacheHits, 1, "Wrong cache hits");
+    NS_TEST_EXPECT_MSG_EQ(after.systemAllocations - before.systemAllocations,
+                          2,
+                          "Wrong system allocations");
+    NS_TEST_EXPECT_MSG_EQ(after.bytesInUse, before.bytesInUse, "Blocks leaked");
+    NS_TEST_EXPECT_MSG_EQ(after.cachedBlocks,
+                          before.cachedBlocks,
+                          "Free lists not released at thread exit");
+    NS_TEST_EXPECT_MSG_EQ(after.threads, before.threads, "Exited thread still registered");
+}
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Check that copies of a packet can be modified by concurrent threads.
+ *
+ * The copies share the buffer and the tag lists of the original packet,
+ * and each thread adds its own headers, padding and tags to them, as the
+ * threads of a parallel simulator do while PacketAllocator::SetConcurrent()
+ * is set.
+ */
+class PacketAllocatorConcurrencyTestCase : public TestCase
+{
+  public:
+    PacketAllocatorConcurrencyTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PacketAllocatorConcurrencyTestCase::PacketAllocatorConcurrencyTestCase()
+    : TestCase("Check concurrent modifications of packet copies")
+{
+}
+
+void
+PacketAllocatorConcurrencyTestCase::DoRun()
+{
+    const uint32_t nThreads = 4;
+    const uint32_t nCopies = 2000;
+    const uint32_t payloadSize = 100;
+
+    std::vector<uint8_t> payload(payloadSize);
+    for (uint32_t i = 0; i < payloadSize; ++i)
+    {
+        payload[i] = i;
+    }
+    Ptr<Packet> original = Create<Packet>(payload.data(), payloadSize);
+    original->AddPacketTag(FlowIdTag(1000));
+    original->AddByteTag(FlowIdTag(1000));
+    LlcSnapHeader header;
+    header.SetType(0xffff);
+    original->AddHeader(header);
+
+    std::atomic<uint32_t> errors = 0;
+    std::vector<std::thread> threads;
+    PacketAllocator::SetConcurrent(true);
+    for (uint32_t t = 0; t < nThreads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            std::vector<Ptr<Packet>> copies;
+            for (uint32_t i = 0; i < nCopies; ++i)
+            {
+                Ptr<Packet> copy = original->Copy();
+                LlcSnapHeader mine;
+                mine.SetType(t * nCopies + i);
+                copy->AddHeader(mine);
+                copy->AddPaddingAtEnd(t + 1);
+                FlowIdTag flowId(t);
+                copy->ReplacePacketTag(flowId);
+                copy->AddByteTag(FlowIdTag(t));
+                copies.push_back(copy);
+            }
+            for (uint32_t i = 0; i < nCopies; ++i)
+            {
+                Ptr<Packet> copy = copies[i];
+                std::vector<uint8_t> bytes(copy->GetSize());
+                copy->CopyData(bytes.data(), bytes.size());
+                bool ok = bytes.size() == 2 * header.GetSerializedSize() + payloadSize + t + 1;
+                for (uint32_t j = 0; ok && j < payloadSize; ++j)
+                {
+                    ok = bytes[2 * header.GetSerializedSize() + j] == j;
+                }
+                LlcSnapHeader mine;
+                copy->RemoveHeader(mine);
+                LlcSnapHeader theirs;
+                copy->RemoveHeader(theirs);
+                ok = ok && mine.GetType() == t * nCopies + i && theirs.GetType() == 0xffff;
+
+                FlowIdTag tag;
+                ok = ok && copy->RemovePacketTag(tag) && tag.GetFlowId() == t;
+                ok = ok && !copy->PeekPacketTag(tag);
+                uint32_t byteTags = 0;
+                for (auto it = copy->GetByteTagIterator(); it.HasNext();)
+                {
+                    it.Next().GetTag(tag);
+                    byteTags += (tag.GetFlowId() == t || tag.GetFlowId() == 1000);
+                }
+                ok = ok && byteTags == 2;
+                errors += !ok;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    PacketAllocator::SetConcurrent(false);
+
+    NS_TEST_EXPECT_MSG_EQ(errors, 0, "Packet copies corrupted by other threads");
+    LlcSnapHeader theirs;
+    original->RemoveHeader(theirs);
+    NS_TEST_EXPECT_MSG_EQ(theirs.GetType(), 0xffff, "Original packet modified");
+    NS_TEST_EXPECT_MSG_EQ(original->GetSize(), payloadSize, "Original packet modified");
+    FlowIdTag tag;
+    NS_TEST_EXPECT_MSG_EQ(original->PeekPacketTag(tag), true, "Packet tag of the original lost");
+    NS_TEST_EXPECT_MSG_EQ(tag.GetFlowId(), 1000, "Packet tag of the original modified");
+}
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief PacketAllocator TestSuite
+ */
+class PacketAllocatorTestSuite : public TestSuite
+{
+  public:
+    PacketAllocatorTestSuite();
+};
+
+PacketAllocatorTestSuite::PacketAllocatorTestSuite()
+    : TestSuite("packet-allocator", Type::UNIT)
+{
+    AddTestCase(new PacketAllocatorFreeListTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new PacketAllocatorConcurrencyTestCase(), TestCase::Duration::QUICK);
+}
+
+static PacketAllocatorTestSuite
+    g_packetAllocatorTestSuite; //!< Static variable for test initialization
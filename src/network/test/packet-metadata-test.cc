@@ -315,7 +315,11 @@ HistoryTrailer<N>::Deserialize(Buffer::Iterator start)
 class PacketMetadataTest : public TestCase
 {
   public:
-    PacketMetadataTest();
+    /**
+     * Constructor
+     * @param compact whether to test the compact metadata
+     */
+    PacketMetadataTest(bool compact);
     ~PacketMetadataTest() override;
     /**
      * Checks the packet header and trailer history
@@ -324,9 +328,13 @@ class PacketMetadataTest : public TestCase
      * @param ... The variable arguments
      */
     void CheckHistory(Ptr<Packet> p, uint32_t n, ...);
+    void DoSetup() override;
     void DoRun() override;
+    void DoTeardown() override;
 
   private:
+    bool m_compact; //!< whether to test the compact metadata
+
     /**
      * Adds an header to the packet
      * @param p The packet
@@ -335,8 +343,9 @@ class PacketMetadataTest : public TestCase
     Ptr<Packet> DoAddHeader(Ptr<Packet> p);
 };
 
-PacketMetadataTest::PacketMetadataTest()
-    : TestCase("Packet metadata")
+PacketMetadataTest::PacketMetadataTest(bool compact)
+    : TestCase(compact ? "Compact packet metadata" : "Packet metadata"),
+      m_compact(compact)
 {
 }
 
@@ -466,10 +475,27 @@ PacketMetadataTest::DoAddHeader(Ptr<Packet> p)
 }
 
 void
-PacketMetadataTest::DoRun()
+PacketMetadataTest::DoSetup()
+{
+    if (m_compact)
+    {
+        PacketMetadata::EnableCompact();
+    }
+    else
+    {
+        PacketMetadata::Enable();
+    }
+}
+
+void
+PacketMetadataTest::DoTeardown()
 {
-    PacketMetadata::Enable();
+    PacketMetadata::DisableCompact();
+}
 
+void
+PacketMetadataTest::DoRun()
+{
     Ptr<Packet> p = Create<Packet>(0);
     Ptr<Packet> p1 = Create<Packet>(0);
 
@@ -858,6 +884,25 @@ PacketMetadataTest::DoRun()
     CHECK_HISTORY(p, 2, 2, 11);
     REM_HEADER(p, 2);
     CHECK_HISTORY(p, 1, 11);
+
+    // long history, with a copy in the middle
+    p = Create<Packet>(100);
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        ADD_HEADER(p, 10);
+        ADD_TRAILER(p, 4);
+        p->RemoveAtStart(10);
+        REM_TRAILER(p, 4);
+        if (i == 100)
+        {
+            p1 = p->Copy();
+        }
+    }
+    CHECK_HISTORY(p, 1, 100);
+    CHECK_HISTORY(p1, 1, 100);
+    p->AddAtEnd(p1);
+    ADD_HEADER(p, 7);
+    CHECK_HISTORY(p, 3, 7, 100, 100);
     REM_HEADER(p3, 2);
     CHECK_HISTORY(p3, 1, 11);
 
@@ -885,7 +930,8 @@ class PacketMetadataTestSuite : public TestSuite
 PacketMetadataTestSuite::PacketMetadataTestSuite()
     : TestSuite("packet-metadata", Type::UNIT)
 {
-    AddTestCase(new PacketMetadataTest, TestCase::Duration::QUICK);
+    AddTestCase(new PacketMetadataTest(false), TestCase::Duration::QUICK);
+    AddTestCase(new PacketMetadataTest(true), TestCase::Duration::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -6,13 +6,20 @@
 
 #include "ns3/log.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcap-writer.h"
 #include "ns3/test.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace ns3;
 
@@ -1364,6 +1371,266 @@ DiffTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * Read the content of a file.
+ *
+ * @param filename The name of the file.
+ * @returns The bytes of the file, decompressed if its name ends with ".gz".
+ */
+static std::vector<uint8_t>
+ReadFileBytes(const std::string& filename)
+{
+    std::vector<uint8_t> bytes;
+#ifdef HAVE_ZLIB
+    if (filename.ends_with(".gz"))
+    {
+        gzFile file = gzopen(filename.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return bytes;
+        }
+        uint8_t chunk[4096];
+        int n;
+        while ((n = gzread(file, chunk, sizeof(chunk))) > 0)
+        {
+            bytes.insert(bytes.end(), chunk, chunk + n);
+        }
+        gzclose(file);
+        return bytes;
+    }
+#endif
+    std::ifstream file(filename, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return bytes;
+}
+
+/**
+ * Get a field of a file.
+ *
+ * @tparam T The type of the field.
+ * @param bytes The bytes of the file.
+ * @param offset The offset of the field.
+ * @returns The field, in the byte order of the running system, or 0 past
+ *          the end of the file.
+ */
+template <typename T = uint32_t>
+static T
+GetField(const std::vector<uint8_t>& bytes, std::size_t offset)
+{
+    T value = 0;
+    if (offset + sizeof(value) <= bytes.size())
+    {
+        std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    }
+    return value;
+}
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Test case to make sure that the batched writes, possibly
+ * asynchronous or compressed, produce the same file as the direct writes.
+ */
+class BatchedWriteTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param async Whether the batches are written by the background thread.
+     * @param compress Whether the file is compressed.
+     */
+    BatchedWriteTestCase(bool async, bool compress);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Write the known packets many times to a file.
+     *
+     * @param f The file, not opened yet.
+     * @param filename The name of the file.
+     */
+    void WritePackets(PcapFile& f, const std::string& filename);
+
+    bool m_async;    //!< Whether the batches are written by the background thread.
+    bool m_compress; //!< Whether the file is compressed.
+};
+
+BatchedWriteTestCase::BatchedWriteTestCase(bool async, bool compress)
+    : TestCase(std::string("Check batched ") + (async ? "asynchronous " : "") +
+               (compress ? "compressed " : "") + "writes"),
+      m_async(async),
+      m_compress(compress)
+{
+}
+
+void
+BatchedWriteTestCase::WritePackets(PcapFile& f, const std::string& filename)
+{
+    f.Open(filename, std::ios::out);
+    NS_TEST_ASSERT_MSG_EQ(f.Fail(),
+                          false,
+                          "Open (" << filename << ", \"std::ios::out\") returns error");
+    f.Init(1, N_PACKET_BYTES);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        const PacketEntry& p = knownPackets[i % N_KNOWN_PACKETS];
+        f.Write(p.tsSec + i, p.tsUsec, (const uint8_t*)p.data, p.origLen);
+        NS_TEST_EXPECT_MSG_EQ(f.Fail(), false, "Write must not fail");
+    }
+    f.Close();
+}
+
+void
+BatchedWriteTestCase::DoRun()
+{
+    if (m_compress && !PcapWriter::IsCompressionSupported())
+    {
+        return;
+    }
+
+    std::string direct = CreateTempDirFilename("direct.pcap");
+    PcapFile f1;
+    WritePackets(f1, direct);
+
+    // Small batches, to write many of them
+    std::string batched = CreateTempDirFilename("batched.pcap");
+    PcapFile f2;
+    f2.EnableBatching(100, m_async, m_compress);
+    WritePackets(f2, batched);
+    if (m_compress)
+    {
+        NS_TEST_EXPECT_MSG_EQ(CheckFileExists(batched),
+                              false,
+                              "Compressed file written without the .gz extension");
+        batched += ".gz";
+    }
+
+    std::vector<uint8_t> expected = ReadFileBytes(direct);
+    NS_TEST_ASSERT_MSG_EQ(expected.size(),
+                          24 + 1000 * (16 + N_PACKET_BYTES),
+                          "Wrong size of the file written directly");
+    NS_TEST_EXPECT_MSG_EQ((ReadFileBytes(batched) == expected),
+                          true,
+                          "Batched writes differ from the direct writes");
+
+    uint32_t sec = 0;
+    uint32_t usec = 0;
+    uint32_t packets = 0;
+    if (!m_compress)
+    {
+        bool diff = PcapFile::Diff(direct, batched, sec, usec, packets);
+        NS_TEST_EXPECT_MSG_EQ(diff, false, "PcapDiff(direct, batched) must be false");
+        NS_TEST_EXPECT_MSG_EQ(packets, 1000, "Wrong number of batched packets");
+    }
+
+    PcapFile f3;
+    f3.EnableBatching(100, m_async, m_compress);
+    f3.Open(CreateTempDirFilename("missing/batched.pcap"), std::ios::out);
+    NS_TEST_EXPECT_MSG_EQ(f3.Fail(), true, "Open of a file in a missing directory must fail");
+}
+
+/**
+ * @ingroup network-test
+ * @ingroup tests
+ *
+ * @brief Test case to make sure that several files can be multiplexed
+ * as the interfaces of a shared pcapng file.
+ */
+class SharedFileTestCase : public TestCase
+{
+  public:
+    SharedFileTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SharedFileTestCase::SharedFileTestCase()
+    : TestCase("Check that several files can share a pcapng file")
+{
+}
+
+void
+SharedFileTestCase::DoRun()
+{
+    std::string shared = CreateTempDirFilename("shared.pcapng");
+    std::string names[2] = {CreateTempDirFilename("first.pcap"),
+                            CreateTempDirFilename("second.pcap")};
+    PcapFile files[2];
+    for (uint32_t j = 0; j < 2; ++j)
+    {
+        files[j].EnableBatching(100, true);
+        files[j].SetSharedFile(shared);
+        files[j].Open(names[j], std::ios::out);
+        NS_TEST_ASSERT_MSG_EQ(files[j].Fail(), false, "Open of a shared file returns error");
+    }
+    files[0].Init(1, N_PACKET_BYTES);
+    files[1].Init(105, 65535, PcapFile::ZONE_DEFAULT, false, true);
+    for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+        const PacketEntry& p = knownPackets[i];
+        files[i % 2].Write(p.tsSec, p.tsUsec, (const uint8_t*)p.data, sizeof(p.data));
+    }
+    files[0].Close();
+    files[1].Close();
+    NS_TEST_EXPECT_MSG_EQ(CheckFileExists(names[0]), false, "Shared file created separately");
+
+    std::vector<uint8_t> bytes = ReadFileBytes(shared);
+    NS_TEST_ASSERT_MSG_EQ(GetField(bytes, 0), 0x0a0d0d0a, "Missing section header block");
+    NS_TEST_ASSERT_MSG_EQ(GetField(bytes, 8), 0x1a2b3c4d, "Wrong byte order magic");
+    std::size_t offset = GetField(bytes, 4);
+
+    for (uint32_t j = 0; j < 2; ++j)
+    {
+        NS_TEST_ASSERT_MSG_EQ(GetField(bytes, offset), 1, "Missing interface description block");
+        NS_TEST_EXPECT_MSG_EQ(GetField<uint16_t>(bytes, offset + 8),
+                              (j == 0 ? 1 : 105),
+                              "Wrong link type of interface " << j);
+        NS_TEST_EXPECT_MSG_EQ(GetField(bytes, offset + 12),
+                              (j == 0 ? N_PACKET_BYTES : 65535),
+                              "Wrong snap length of interface " << j);
+        NS_TEST_EXPECT_MSG_EQ(GetField<uint16_t>(bytes, offset + 16),
+                              2,
+                              "Missing name option of interface " << j);
+        NS_TEST_EXPECT_MSG_EQ(GetField<uint16_t>(bytes, offset + 18),
+                              names[j].size(),
+                              "Wrong name length of interface " << j);
+        NS_TEST_EXPECT_MSG_EQ(std::string(bytes.begin() + offset + 20,
+                                          bytes.begin() + offset + 20 + names[j].size()),
+                              names[j],
+                              "Wrong name of interface " << j);
+        offset += GetField(bytes, offset + 4);
+    }
+
+    for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+        const PacketEntry& p = knownPackets[i];
+        uint32_t interfaceId = i % 2;
+        uint64_t timestamp = interfaceId == 0 ? p.tsSec * 1000000ULL + p.tsUsec
+                                              : p.tsSec * 1000000000ULL + p.tsUsec;
+        uint32_t inclLen = interfaceId == 0 ? N_PACKET_BYTES : sizeof(p.data);
+        NS_TEST_ASSERT_MSG_EQ(GetField(bytes, offset), 6, "Missing enhanced packet block " << i);
+        NS_TEST_EXPECT_MSG_EQ(GetField(bytes, offset + 8), interfaceId, "Wrong interface " << i);
+        NS_TEST_EXPECT_MSG_EQ(GetField(bytes, offset + 12),
+                              (timestamp >> 32),
+                              "Wrong timestamp of packet " << i);
+        NS_TEST_EXPECT_MSG_EQ(GetField(bytes, offset + 16),
+                              (timestamp & 0xffffffff),
+                              "Wrong timestamp of packet " << i);
+        NS_TEST_EXPECT_MSG_EQ(GetField(bytes, offset + 20), inclLen, "Wrong length " << i);
+        NS_TEST_EXPECT_MSG_EQ(GetField(bytes, offset + 24), sizeof(p.data), "Wrong length " << i);
+        NS_TEST_ASSERT_MSG_EQ((offset + 28 + inclLen <= bytes.size()), true, "Truncated file");
+        NS_TEST_EXPECT_MSG_EQ(std::memcmp(bytes.data() + offset + 28, p.data, inclLen),
+                              0,
+                              "Wrong data of packet " << i);
+        offset += GetField(bytes, offset + 4);
+    }
+    NS_TEST_EXPECT_MSG_EQ(offset, bytes.size(), "Unexpected blocks at the end of the file");
+}
+
 /**
  * @ingroup network-test
  * @ingroup tests
@@ -1387,6 +1654,10 @@ PcapFileTestSuite::PcapFileTestSuite()
     AddTestCase(new RecordHeaderTestCase, TestCase::Duration::QUICK);
     AddTestCase(new ReadFileTestCase, TestCase::Duration::QUICK);
     AddTestCase(new DiffTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new BatchedWriteTestCase(false, false), TestCase::Duration::QUICK);
+    AddTestCase(new BatchedWriteTestCase(true, false), TestCase::Duration::QUICK);
+    AddTestCase(new BatchedWriteTestCase(true, true), TestCase::Duration::QUICK);
+    AddTestCase(new SharedFileTestCase, TestCase::Duration::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,497 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "binary-trace.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <array>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @file
+ * @ingroup network
+ * ns3::BinaryTraceWriter and ns3::BinaryTraceReader implementations.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("BinaryTrace");
+
+namespace
+{
+
+/** The magic bytes starting a binary trace file. */
+const char FILE_MAGIC[8] = {'n', 's', '3', 'b', 't', 'r', 'c', '\0'};
+/** The version of the format of the binary trace files. */
+const uint32_t VERSION = 1;
+/** Identifies the byte order of the writing system. */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+/** The magic number starting a block. */
+const uint32_t BLOCK_MAGIC = 0x6b6c6274;
+
+/** The block codecs. */
+enum Codec : uint32_t
+{
+    CODEC_NONE = 0, //!< Uncompressed block.
+    CODEC_ZLIB = 1, //!< Block compressed with zlib.
+};
+
+/** The columns of the records, in the order of the blocks: name and type. */
+const std::array<std::pair<const char*, const char*>, 6> COLUMNS = {{
+    {"time_ns", "int64"},
+    {"node", "uint32"},
+    {"device", "uint32"},
+    {"kind", "uint8"},
+    {"uid", "uint64"},
+    {"size", "uint32"},
+}};
+
+/** The size of a record in an uncompressed block. */
+const uint32_t RECORD_SIZE = 8 + 4 + 4 + 1 + 8 + 4;
+
+/**
+ * Append a value to a buffer, in the byte order of the running system.
+ *
+ * @tparam T The type of the value.
+ * @param buffer The buffer.
+ * @param value The value.
+ */
+template <typename T>
+void
+Put(std::vector<uint8_t>& buffer, T value)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * Append a string to a buffer, preceded by its 16-bit length.
+ *
+ * @param buffer The buffer.
+ * @param s The string, of less than 64 KiB.
+ */
+void
+PutString(std::vector<uint8_t>& buffer, const std::string& s)
+{
+    Put(buffer, static_cast<uint16_t>(s.size()));
+    buffer.insert(buffer.end(), s.begin(), s.end());
+}
+
+/**
+ * Append a column to a buffer.
+ *
+ * @tparam T The type of the values.
+ * @param buffer The buffer.
+ * @param column The values.
+ */
+template <typename T>
+void
+PutColumn(std::vector<uint8_t>& buffer, const std::vector<T>& column)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(column.data());
+    buffer.insert(buffer.end(), bytes, bytes + column.size() * sizeof(T));
+}
+
+/**
+ * Read a column from a buffer.
+ *
+ * @tparam T The type of the values.
+ * @param p The buffer, advanced past the column.
+ * @param n The number of values.
+ * @param column The values.
+ */
+template <typename T>
+void
+GetColumn(const uint8_t*& p, std::size_t n, std::vector<T>& column)
+{
+    column.resize(n);
+    std::memcpy(column.data(), p, n * sizeof(T));
+    p += n * sizeof(T);
+}
+
+/**
+ * Read a value from a file.
+ *
+ * @tparam T The type of the value.
+ * @param file The file.
+ * @param value The value.
+ * @returns true if the value was read.
+ */
+template <typename T>
+bool
+Get(std::istream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+/**
+ * Read a string, preceded by its 16-bit length, from a file.
+ *
+ * @param file The file.
+ * @param s The string.
+ * @returns true if the string was read.
+ */
+bool
+GetString(std::istream& file, std::string& s)
+{
+    uint16_t length;
+    if (!Get(file, length))
+    {
+        return false;
+    }
+    s.resize(length);
+    return static_cast<bool>(file.read(s.data(), length));
+}
+
+} // namespace
+
+std::string
+BinaryTraceRecord::GetKindName(uint8_t kind)
+{
+    switch (kind)
+    {
+    case ENQUEUE:
+        return "enqueue";
+    case DEQUEUE:
+        return "dequeue";
+    case DROP:
+        return "drop";
+    case RECEIVE:
+        return "receive";
+    case TRANSMIT:
+        return "transmit";
+    default:
+        return std::to_string(kind);
+    }
+}
+
+std::size_t
+BinaryTraceBlock::GetSize() const
+{
+    return times.size();
+}
+
+void
+BinaryTraceBlock::Append(const BinaryTraceRecord& record)
+{
+    times.push_back(record.time);
+    nodes.push_back(record.node);
+    devices.push_back(record.device);
+    kinds.push_back(record.kind);
+    uids.push_back(record.uid);
+    sizes.push_back(record.size);
+}
+
+BinaryTraceRecord
+BinaryTraceBlock::Get(std::size_t i) const
+{
+    return {times[i], nodes[i], devices[i], kinds[i], uids[i], sizes[i]};
+}
+
+void
+BinaryTraceBlock::Clear()
+{
+    times.clear();
+    nodes.clear();
+    devices.clear();
+    kinds.clear();
+    uids.clear();
+    sizes.clear();
+}
+
+BinaryTraceWriter::BinaryTraceWriter(const std::string& filename, uint32_t blockSize, bool compress)
+    : m_file(filename, std::ios::out | std::ios::binary | std::ios::trunc),
+      m_blockSize(blockSize > 0 ? blockSize : 1),
+      m_compress(compress)
+{
+    NS_LOG_FUNCTION(this << filename << blockSize << compress);
+    WriteSchema();
+}
+
+BinaryTraceWriter::~BinaryTraceWriter()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+void
+BinaryTraceWriter::WriteSchema()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<uint8_t> schema(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    Put(schema, VERSION);
+    Put(schema, BYTE_ORDER_MAGIC);
+    Put(schema, static_cast<uint32_t>(COLUMNS.size()));
+    for (const auto& [name, type] : COLUMNS)
+    {
+        PutString(schema, name);
+        PutString(schema, type);
+    }
+    Put(schema, static_cast<uint32_t>(BinaryTraceRecord::N_KINDS));
+    for (uint8_t kind = 0; kind < BinaryTraceRecord::N_KINDS; ++kind)
+    {
+        PutString(schema, BinaryTraceRecord::GetKindName(kind));
+    }
+    m_file.write(reinterpret_cast<const char*>(schema.data()), schema.size());
+}
+
+void
+BinaryTraceWriter::Write(Time time,
+                         uint32_t node,
+                         uint32_t device,
+                         uint8_t kind,
+                         uint64_t uid,
+                         uint32_t size)
+{
+    Write({time.GetNanoSeconds(), node, device, kind, uid, size});
+}
+
+void
+BinaryTraceWriter::Write(const BinaryTraceRecord& record)
+{
+    std::lock_guard lock(m_mutex);
+    NS_ASSERT_MSG(m_file.is_open(), "Record written to a closed binary trace");
+    m_block.Append(record);
+    if (m_block.GetSize() >= m_blockSize)
+    {
+        WriteBlock();
+    }
+}
+
+void
+BinaryTraceWriter::WriteBlock()
+{
+    std::size_t n = m_block.GetSize();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Delta-encode the times, which are mostly increasing by small steps
+    for (std::size_t i = n - 1; i > 0; --i)
+    {
+        m_block.times[i] -= m_block.times[i - 1];
+    }
+    std::vector<uint8_t> raw;
+    raw.reserve(n * RECORD_SIZE);
+    PutColumn(raw, m_block.times);
+    PutColumn(raw, m_block.nodes);
+    PutColumn(raw, m_block.devices);
+    PutColumn(raw, m_block.kinds);
+    PutColumn(raw, m_block.uids);
+    PutColumn(raw, m_block.sizes);
+    m_block.Clear();
+
+    uint32_t codec = CODEC_NONE;
+    const std::vector<uint8_t>* stored = &raw;
+#ifdef HAVE_ZLIB
+    std::vector<uint8_t> compressed;
+    if (m_compress)
+    {
+        uLongf compressedSize = compressBound(raw.size());
+        compressed.resize(compressedSize);
+        if (compress2(compressed.data(), &compressedSize, raw.data(), raw.size(), Z_BEST_SPEED) ==
+            Z_OK)
+        {
+            compressed.resize(compressedSize);
+            codec = CODEC_ZLIB;
+            stored = &compressed;
+        }
+    }
+#endif
+
+    std::vector<uint8_t> header;
+    Put(header, BLOCK_MAGIC);
+    Put(header, static_cast<uint32_t>(n));
+    Put(header, codec);
+    Put(header, static_cast<uint32_t>(raw.size()));
+    Put(header, static_cast<uint32_t>(stored->size()));
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_file.write(reinterpret_cast<const char*>(stored->data()), stored->size());
+}
+
+void
+BinaryTraceWriter::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    std::lock_guard lock(m_mutex);
+    WriteBlock();
+    m_file.flush();
+}
+
+void
+BinaryTraceWriter::Close()
+{
+    NS_LOG_FUNCTION(this);
+    std::lock_guard lock(m_mutex);
+    if (m_file.is_open())
+    {
+        WriteBlock();
+        m_file.close();
+    }
+}
+
+bool
+BinaryTraceWriter::Fail() const
+{
+    return m_file.fail();
+}
+
+BinaryTraceReader::BinaryTraceReader(const std::string& filename)
+    : m_file(filename, std::ios::in | std::ios::binary),
+      m_failed(false),
+      m_next(0)
+{
+    NS_LOG_FUNCTION(this << filename);
+    char magic[sizeof(FILE_MAGIC)];
+    uint32_t version = 0;
+    uint32_t byteOrder = 0;
+    uint32_t nColumns = 0;
+    if (!m_file.read(magic, sizeof(magic)) || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 ||
+        !Get(m_file, version) || version != VERSION || !Get(m_file, byteOrder) ||
+        byteOrder != BYTE_ORDER_MAGIC || !Get(m_file, nColumns) || nColumns != COLUMNS.size())
+    {
+        m_failed = true;
+        return;
+    }
+    for (const auto& [name, type] : COLUMNS)
+    {
+        std::string columnName;
+        std::string columnType;
+        if (!GetString(m_file, columnName) || !GetString(m_file, columnType) ||
+            columnType != type)
+        {
+            m_failed = true;
+            return;
+        }
+        m_columnNames.push_back(columnName);
+    }
+    uint32_t nKinds = 0;
+    if (!Get(m_file, nKinds) || nKinds > 256)
+    {
+        m_failed = true;
+        return;
+    }
+    m_kindNames.resize(nKinds);
+    for (auto& kindName : m_kindNames)
+    {
+        if (!GetString(m_file, kindName))
+        {
+            m_failed = true;
+            return;
+        }
+    }
+}
+
+bool
+BinaryTraceReader::Fail() const
+{
+    return m_failed;
+}
+
+const std::vector<std::string>&
+BinaryTraceReader::GetColumnNames() const
+{
+    return m_columnNames;
+}
+
+std::string
+BinaryTraceReader::GetKindName(uint8_t kind) const
+{
+    return kind < m_kindNames.size() ? m_kindNames[kind] : std::to_string(kind);
+}
+
+bool
+BinaryTraceReader::ReadBlock(BinaryTraceBlock& block)
+{
+    NS_LOG_FUNCTION(this);
+    block.Clear();
+    if (m_failed)
+    {
+        return false;
+    }
+    uint32_t magic;
+    if (!Get(m_file, magic))
+    {
+        // End of the file, unless it ends with a truncated block
+        m_failed = m_file.gcount() != 0;
+        return false;
+    }
+    uint32_t n = 0;
+    uint32_t codec = 0;
+    uint32_t rawSize = 0;
+    uint32_t storedSize = 0;
+    if (magic != BLOCK_MAGIC || !Get(m_file, n) || !Get(m_file, codec) || !Get(m_file, rawSize) ||
+        !Get(m_file, storedSize) || rawSize != static_cast<uint64_t>(n) * RECORD_SIZE)
+    {
+        m_failed = true;
+        return false;
+    }
+    std::vector<uint8_t> stored(storedSize);
+    if (!m_file.read(reinterpret_cast<char*>(stored.data()), storedSize))
+    {
+        m_failed = true;
+        return false;
+    }
+
+    std::vector<uint8_t> raw;
+    if (codec == CODEC_NONE && storedSize == rawSize)
+    {
+        raw = std::move(stored);
+    }
+#ifdef HAVE_ZLIB
+    else if (codec == CODEC_ZLIB)
+    {
+        raw.resize(rawSize);
+        uLongf size = rawSize;
+        if (uncompress(raw.data(), &size, stored.data(), storedSize) != Z_OK || size != rawSize)
+        {
+            m_failed = true;
+            return false;
+        }
+    }
+#endif
+    else
+    {
+        m_failed = true;
+        return false;
+    }
+
+    const uint8_t* p = raw.data();
+    GetColumn(p, n, block.times);
+    GetColumn(p, n, block.nodes);
+    GetColumn(p, n, block.devices);
+    GetColumn(p, n, block.kinds);
+    GetColumn(p, n, block.uids);
+    GetColumn(p, n, block.sizes);
+    for (std::size_t i = 1; i < n; ++i)
+    {
+        block.times[i] += block.times[i - 1];
+    }
+    return true;
+}
+
+bool
+BinaryTraceReader::Read(BinaryTraceRecord& record)
+{
+    while (m_next >= m_block.GetSize())
+    {
+        m_next = 0;
+        if (!ReadBlock(m_block))
+        {
+            return false;
+        }
+    }
+    record = m_block.Get(m_next++);
+    return true;
+}
+
+} // namespace ns3
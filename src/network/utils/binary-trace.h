@@ -0,0 +1,243 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+
+#include <fstream>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup network
+ * ns3::BinaryTraceWriter and ns3::BinaryTraceReader declarations.
+ */
+
+namespace ns3
+{
+
+/**
+ * @brief A record of a binary trace: an event of a packet in a device.
+ */
+struct BinaryTraceRecord
+{
+    /** The kinds of events, as the first character of the ASCII trace lines. */
+    enum Kind : uint8_t
+    {
+        ENQUEUE = 0, //!< '+': packet enqueued in the transmit queue
+        DEQUEUE,     //!< '-': packet dequeued from the transmit queue
+        DROP,        //!< 'd': packet dropped
+        RECEIVE,     //!< 'r': packet received
+        TRANSMIT,    //!< 't': packet transmitted
+        N_KINDS      //!< number of kinds
+    };
+
+    int64_t time;    //!< time of the event, in nanoseconds
+    uint32_t node;   //!< identifier of the node
+    uint32_t device; //!< index of the device in the node
+    uint8_t kind;    //!< kind of the event
+    uint64_t uid;    //!< unique identifier of the packet
+    uint32_t size;   //!< size of the packet, in bytes
+
+    /**
+     * @param kind A kind of events.
+     * @returns The name of the kind, e.g., "enqueue".
+     */
+    static std::string GetKindName(uint8_t kind);
+};
+
+/**
+ * @brief A block of records of a binary trace, stored column by column.
+ */
+struct BinaryTraceBlock
+{
+    std::vector<int64_t> times;    //!< the times of the events, in nanoseconds
+    std::vector<uint32_t> nodes;   //!< the identifiers of the nodes
+    std::vector<uint32_t> devices; //!< the indexes of the devices
+    std::vector<uint8_t> kinds;    //!< the kinds of the events
+    std::vector<uint64_t> uids;    //!< the unique identifiers of the packets
+    std::vector<uint32_t> sizes;   //!< the sizes of the packets
+
+    /**
+     * @returns The number of records of the block.
+     */
+    std::size_t GetSize() const;
+
+    /**
+     * Append a record to the block.
+     *
+     * @param record The record.
+     */
+    void Append(const BinaryTraceRecord& record);
+
+    /**
+     * @param i The index of a record of the block.
+     * @returns The record.
+     */
+    BinaryTraceRecord Get(std::size_t i) const;
+
+    /**
+     * Remove all the records of the block.
+     */
+    void Clear();
+};
+
+/**
+ * @brief Writer of a binary trace file.
+ *
+ * A binary trace is a compact alternative to the ASCII traces: instead
+ * of formatting each event as a line of text, a typed record of the
+ * time, node, device, kind of event, packet uid and packet size is
+ * appended to a block.  The records are stored column by column in the
+ * blocks, the times being delta-encoded, and each full block is
+ * compressed with zlib (if available) and appended to the file.  The
+ * file starts with the schema of the records, i.e., the names and types
+ * of the columns, and the names of the kinds of events.  The files are
+ * read by BinaryTraceReader, and converted to CSV by the
+ * binary-trace-convert program of the utils directory.
+ *
+ * The records can be written concurrently by several threads (see
+ * ns3::MultithreadedSimulatorImpl); the file is flushed when the last
+ * reference to the writer is released.
+ */
+class BinaryTraceWriter : public SimpleRefCount<BinaryTraceWriter>
+{
+  public:
+    /** The default number of records of a block. */
+    static constexpr uint32_t BLOCK_SIZE_DEFAULT = 8192;
+
+    /**
+     * Create a binary trace file, and write its schema.
+     *
+     * @param filename The name of the file.
+     * @param blockSize The number of records of the blocks.
+     * @param compress Whether the blocks are compressed, if ns-3 is built with zlib.
+     */
+    BinaryTraceWriter(const std::string& filename,
+                      uint32_t blockSize = BLOCK_SIZE_DEFAULT,
+                      bool compress = true);
+
+    /** Destructor, which closes the file. */
+    ~BinaryTraceWriter();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    BinaryTraceWriter(const BinaryTraceWriter&) = delete;
+    BinaryTraceWriter& operator=(const BinaryTraceWriter&) = delete;
+
+    /**
+     * Write a record.
+     *
+     * @param time The time of the event.
+     * @param node The identifier of the node.
+     * @param device The index of the device in the node.
+     * @param kind The kind of the event, see BinaryTraceRecord::Kind.
+     * @param uid The unique identifier of the packet.
+     * @param size The size of the packet, in bytes.
+     */
+    void Write(Time time, uint32_t node, uint32_t device, uint8_t kind, uint64_t uid, uint32_t size);
+
+    /**
+     * Write a record.
+     *
+     * @param record The record.
+     */
+    void Write(const BinaryTraceRecord& record);
+
+    /**
+     * Write the current block to the file, even if not full.
+     */
+    void Flush();
+
+    /**
+     * Flush and close the file.  Records can no longer be written.
+     */
+    void Close();
+
+    /**
+     * @returns true if the file could not be created or written.
+     */
+    bool Fail() const;
+
+  private:
+    /**
+     * Write the schema at the start of the file.
+     */
+    void WriteSchema();
+
+    /**
+     * Write the current block to the file, with the lock held.
+     */
+    void WriteBlock();
+
+    std::mutex m_mutex;       //!< Protects the other fields.
+    std::ofstream m_file;     //!< The file.
+    uint32_t m_blockSize;     //!< The number of records of the blocks.
+    bool m_compress;          //!< Whether the blocks are compressed.
+    BinaryTraceBlock m_block; //!< The records not written yet.
+};
+
+/**
+ * @brief Reader of a binary trace file, written by BinaryTraceWriter.
+ */
+class BinaryTraceReader
+{
+  public:
+    /**
+     * Open a binary trace file, and read its schema.
+     *
+     * @param filename The name of the file.
+     */
+    BinaryTraceReader(const std::string& filename);
+
+    /**
+     * @returns true if the file could not be opened, is not a binary trace
+     * of a supported version, or is corrupted.
+     */
+    bool Fail() const;
+
+    /**
+     * @returns The names of the columns of the records, e.g., "time_ns".
+     */
+    const std::vector<std::string>& GetColumnNames() const;
+
+    /**
+     * @param kind A kind of events.
+     * @returns The name of the kind in the schema of the file.
+     */
+    std::string GetKindName(uint8_t kind) const;
+
+    /**
+     * Read the next block of records.
+     *
+     * @param [out] block The records.
+     * @returns false at the end of the file, or if the block is corrupted.
+     */
+    bool ReadBlock(BinaryTraceBlock& block);
+
+    /**
+     * Read the next record.
+     *
+     * @param [out] record The record.
+     * @returns false at the end of the file, or if the record is corrupted.
+     */
+    bool Read(BinaryTraceRecord& record);
+
+  private:
+    std::ifstream m_file;                   //!< The file.
+    bool m_failed;                          //!< Whether the file is unreadable.
+    std::vector<std::string> m_columnNames; //!< The names of the columns.
+    std::vector<std::string> m_kindNames;   //!< The names of the kinds of events.
+    BinaryTraceBlock m_block;               //!< The block read by Read().
+    std::size_t m_next;                     //!< The next record of the block read by Read().
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_H */
@@ -10,6 +10,7 @@
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "ns3/log.h"
+#include "ns3/string.h"
 #include "ns3/uinteger.h"
 
 namespace ns3
@@ -37,7 +38,32 @@ PcapFileWrapper::GetTypeId()
                           "microseconds(default).",
                           BooleanValue(false),
                           MakeBooleanAccessor(&PcapFileWrapper::m_nanosecMode),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute("BatchSize",
+                          "Size in bytes of the batches of records written to the file, "
+                          "or 0 to write each record directly (default), unless one of "
+                          "AsyncWrite, Compress or SharedFile is set.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&PcapFileWrapper::m_batchSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("AsyncWrite",
+                          "Whether the batches of records are written by a background thread.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PcapFileWrapper::m_asyncWrite),
+                          MakeBooleanChecker())
+            .AddAttribute("Compress",
+                          "Whether the file is compressed with gzip, and the .gz extension "
+                          "added to its name.  Requires ns-3 to be built with zlib.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PcapFileWrapper::m_compress),
+                          MakeBooleanChecker())
+            .AddAttribute("SharedFile",
+                          "Name of a pcapng file into which the records are written, as the "
+                          "packets of an interface named after the file, or empty to write "
+                          "each file separately (default).",
+                          StringValue(""),
+                          MakeStringAccessor(&PcapFileWrapper::m_sharedFile),
+                          MakeStringChecker());
     return tid;
 }
 
@@ -84,6 +110,14 @@ void
 PcapFileWrapper::Open(const std::string& filename, std::ios::openmode mode)
 {
     NS_LOG_FUNCTION(this << filename << mode);
+    if (m_batchSize > 0 || m_asyncWrite || m_compress || !m_sharedFile.empty())
+    {
+        m_file.EnableBatching(m_batchSize, m_asyncWrite, m_compress);
+        if (!m_sharedFile.empty())
+        {
+            m_file.SetSharedFile(m_sharedFile);
+        }
+    }
     m_file.Open(filename, mode);
 }
 
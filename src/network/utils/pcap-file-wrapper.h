@@ -26,6 +26,12 @@ namespace ns3
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * The files opened for writing only are written according to the
+ * "BatchSize", "AsyncWrite", "Compress" and "SharedFile" attributes, see
+ * PcapFile::EnableBatching() and PcapFile::SetSharedFile().  Setting their
+ * default values, e.g. before calling PcapHelperForDevice::EnablePcapAll(),
+ * applies them to all the captures of a simulation.
  */
 class PcapFileWrapper : public Object
 {
@@ -211,9 +217,13 @@ class PcapFileWrapper : public Object
     uint32_t GetDataLinkType();
 
   private:
-    PcapFile m_file;    //!< Pcap file
-    uint32_t m_snapLen; //!< max length of saved packets
-    bool m_nanosecMode; //!< Timestamps in nanosecond mode
+    PcapFile m_file;          //!< Pcap file
+    uint32_t m_snapLen;       //!< max length of saved packets
+    bool m_nanosecMode;       //!< Timestamps in nanosecond mode
+    uint32_t m_batchSize;     //!< Size of the batches of records, 0 to write them directly
+    bool m_asyncWrite;        //!< Batches written by a background thread
+    bool m_compress;          //!< File compressed with gzip
+    std::string m_sharedFile; //!< Shared pcapng file, empty if not shared
 };
 
 } // namespace ns3
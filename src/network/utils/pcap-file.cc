@@ -8,6 +8,8 @@
 
 #include "pcap-file.h"
 
+#include "pcap-writer.h"
+
 #include "ns3/assert.h"
 #include "ns3/buffer.h"
 #include "ns3/build-profile.h"
@@ -17,8 +19,10 @@
 #include "ns3/log.h"
 #include "ns3/packet.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 //
 // This file is used as part of the ns-3 test framework, so please refrain from
@@ -40,10 +44,84 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2; /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4; /**< Minor version of supported pcap file format */
 
+const uint32_t FILE_HEADER_SIZE = 24;   /**< Size of the pcap file header */
+const uint32_t RECORD_HEADER_SIZE = 16; /**< Size of the pcap record header */
+
+const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;   /**< Type of pcapng section header blocks */
+const uint32_t PCAPNG_INTERFACE = 0x00000001;        /**< Type of pcapng interface blocks */
+const uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;  /**< Type of pcapng enhanced packet blocks */
+const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d; /**< Identifies the byte order of pcapng */
+const uint16_t PCAPNG_IF_NAME = 2;                   /**< Code of the pcapng if_name option */
+const uint16_t PCAPNG_IF_TSRESOL = 9;                /**< Code of the pcapng if_tsresol option */
+const uint32_t PCAPNG_PACKET_HEADER_SIZE = 28;       /**< Size of a pcapng packet header */
+
+namespace
+{
+
+/**
+ * Store a value in a record, in the byte order of the running system.
+ *
+ * @tparam T The type of the value.
+ * @param p The bytes of the record.
+ * @param value The value.
+ * @returns The bytes following the value.
+ */
+template <typename T>
+uint8_t*
+Put(uint8_t* p, T value)
+{
+    std::memcpy(p, &value, sizeof(T));
+    return p + sizeof(T);
+}
+
+/**
+ * @param length A length, in bytes.
+ * @returns The length padded to 32 bits, as the pcapng fields are.
+ */
+uint32_t
+Pad(uint32_t length)
+{
+    return (length + 3) & ~3U;
+}
+
+/**
+ * @param filename The name of a file.
+ * @returns The name of the file, with the ".gz" extension added if not present.
+ */
+std::string
+GetCompressedName(const std::string& filename)
+{
+    return filename.ends_with(".gz") ? filename : filename + ".gz";
+}
+
+/**
+ * @returns The pcapng section header block, of unspecified section length.
+ */
+std::vector<uint8_t>
+GetSectionHeader()
+{
+    const uint32_t blockLen = 28;
+    std::vector<uint8_t> block(blockLen);
+    uint8_t* p = Put(block.data(), PCAPNG_SECTION_HEADER);
+    p = Put(p, blockLen);
+    p = Put(p, PCAPNG_BYTE_ORDER_MAGIC);
+    p = Put(p, uint16_t{1});
+    p = Put(p, uint16_t{0});
+    p = Put(p, int64_t{-1});
+    Put(p, blockLen);
+    return block;
+}
+
+} // namespace
+
 PcapFile::PcapFile()
     : m_file(),
       m_swapMode(false),
-      m_nanosecMode(false)
+      m_nanosecMode(false),
+      m_batchSize(0),
+      m_async(false),
+      m_compress(false),
+      m_interfaceId(0)
 {
     NS_LOG_FUNCTION(this);
     FatalImpl::RegisterStream(&m_file);
@@ -60,6 +138,10 @@ bool
 PcapFile::Fail() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_writer)
+    {
+        return m_writer->Fail();
+    }
     return m_file.fail();
 }
 
@@ -81,6 +163,12 @@ void
 PcapFile::Close()
 {
     NS_LOG_FUNCTION(this);
+    if (m_writer)
+    {
+        // The last file sharing the writer flushes it
+        m_writer.reset();
+        return;
+    }
     m_file.close();
 }
 
@@ -196,12 +284,6 @@ void
 PcapFile::WriteFileHeader()
 {
     NS_LOG_FUNCTION(this);
-    //
-    // If we're initializing the file, we need to write the pcap file header
-    // at the start of the file.
-    //
-    m_file.seekp(0, std::ios::beg);
-
     //
     // We have the ability to write out the pcap file header in a foreign endian
     // format, so we need a temp place to swap on the way out.
@@ -224,6 +306,26 @@ PcapFile::WriteFileHeader()
         headerOut = &header;
     }
 
+    if (m_writer)
+    {
+        uint8_t* p = m_writer->BeginRecord(FILE_HEADER_SIZE);
+        p = Put(p, headerOut->m_magicNumber);
+        p = Put(p, headerOut->m_versionMajor);
+        p = Put(p, headerOut->m_versionMinor);
+        p = Put(p, headerOut->m_zone);
+        p = Put(p, headerOut->m_sigFigs);
+        p = Put(p, headerOut->m_snapLen);
+        Put(p, headerOut->m_type);
+        m_writer->EndRecord();
+        return;
+    }
+
+    //
+    // If we're initializing the file, we need to write the pcap file header
+    // at the start of the file.
+    //
+    m_file.seekp(0, std::ios::beg);
+
     //
     // Watch out for memory alignment differences between machines, so write
     // them all individually.
@@ -316,6 +418,63 @@ PcapFile::ReadAndVerifyFileHeader()
     }
 }
 
+void
+PcapFile::WriteInterfaceDescription()
+{
+    NS_LOG_FUNCTION(this);
+    //
+    // The interface is named after the file, and its timestamps are in
+    // microseconds (10^-6 s) or nanoseconds (10^-9 s).
+    //
+    uint32_t nameLen = std::min<std::size_t>(m_filename.size(), 0xffff);
+    uint32_t nameOptionLen = nameLen > 0 ? 4 + Pad(nameLen) : 0;
+    uint32_t blockLen = 16 + nameOptionLen + 8 + 4 + 4;
+
+    uint8_t* start = m_writer->BeginRecord(blockLen);
+    m_interfaceId = m_writer->AllocateInterfaceId();
+    uint8_t* p = Put(start, PCAPNG_INTERFACE);
+    p = Put(p, blockLen);
+    p = Put(p, static_cast<uint16_t>(m_fileHeader.m_type));
+    p = Put(p, uint16_t{0});
+    p = Put(p, m_fileHeader.m_snapLen);
+    if (nameLen > 0)
+    {
+        p = Put(p, PCAPNG_IF_NAME);
+        p = Put(p, static_cast<uint16_t>(nameLen));
+        std::memcpy(p, m_filename.data(), nameLen);
+        p += Pad(nameLen);
+    }
+    p = Put(p, PCAPNG_IF_TSRESOL);
+    p = Put(p, uint16_t{1});
+    p = Put(p, static_cast<uint8_t>(m_nanosecMode ? 9 : 6));
+    p += 3;
+    p = Put(p, uint32_t{0}); // opt_endofopt
+    Put(p, blockLen);
+    m_writer->EndRecord();
+}
+
+void
+PcapFile::EnableBatching(uint32_t batchSize, bool async, bool compress)
+{
+    NS_LOG_FUNCTION(this << batchSize << async << compress);
+    NS_ASSERT_MSG(!m_writer, "Batching must be enabled before the file is opened");
+    m_batchSize = batchSize > 0 ? batchSize : PcapWriter::BATCH_SIZE_DEFAULT;
+    m_async = async;
+    m_compress = compress;
+}
+
+void
+PcapFile::SetSharedFile(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    NS_ASSERT_MSG(!m_writer, "The shared file must be set before the file is opened");
+    m_sharedFile = filename;
+    if (m_batchSize == 0)
+    {
+        m_batchSize = PcapWriter::BATCH_SIZE_DEFAULT;
+    }
+}
+
 void
 PcapFile::Open(const std::string& filename, std::ios::openmode mode)
 {
@@ -328,6 +487,27 @@ PcapFile::Open(const std::string& filename, std::ios::openmode mode)
     mode |= std::ios::binary;
 
     m_filename = filename;
+    if (m_batchSize > 0 && (mode & std::ios::in) == 0)
+    {
+        if (m_sharedFile.empty())
+        {
+            m_writer = std::make_shared<PcapWriter>(m_compress ? GetCompressedName(filename)
+                                                               : filename,
+                                                    m_batchSize,
+                                                    m_async,
+                                                    m_compress);
+        }
+        else
+        {
+            m_writer = PcapWriter::GetShared(m_compress ? GetCompressedName(m_sharedFile)
+                                                        : m_sharedFile,
+                                             m_batchSize,
+                                             m_async,
+                                             m_compress,
+                                             GetSectionHeader());
+        }
+        return;
+    }
     m_file.open(filename, mode);
     if (mode & std::ios::in)
     {
@@ -395,6 +575,19 @@ PcapFile::Init(uint32_t dataLinkType,
     //
     m_swapMode = swapMode || bigEndian;
 
+    if (m_writer && !m_sharedFile.empty())
+    {
+        //
+        // The pcapng files are written in the byte order of the running
+        // system, which readers identify from the section header.
+        //
+        WriteInterfaceDescription();
+        return;
+    }
+    if (m_writer)
+    {
+        m_writer->Truncate();
+    }
     WriteFileHeader();
 }
 
@@ -429,10 +622,58 @@ PcapFile::WritePacketHeader(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     return inclLen;
 }
 
+uint8_t*
+PcapFile::BeginRecord(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t& inclLen)
+{
+    NS_LOG_FUNCTION(this << tsSec << tsUsec << totalLen);
+    inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+
+    if (m_sharedFile.empty())
+    {
+        PcapRecordHeader header;
+        header.m_tsSec = tsSec;
+        header.m_tsUsec = tsUsec;
+        header.m_inclLen = inclLen;
+        header.m_origLen = totalLen;
+
+        if (m_swapMode)
+        {
+            Swap(&header, &header);
+        }
+
+        uint8_t* p = m_writer->BeginRecord(RECORD_HEADER_SIZE + inclLen);
+        p = Put(p, header.m_tsSec);
+        p = Put(p, header.m_tsUsec);
+        p = Put(p, header.m_inclLen);
+        return Put(p, header.m_origLen);
+    }
+
+    uint64_t timestamp = tsSec * (m_nanosecMode ? 1000000000ULL : 1000000ULL) + tsUsec;
+    uint32_t blockLen = PCAPNG_PACKET_HEADER_SIZE + Pad(inclLen) + 4;
+    uint8_t* p = m_writer->BeginRecord(blockLen);
+    p = Put(p, PCAPNG_ENHANCED_PACKET);
+    p = Put(p, blockLen);
+    p = Put(p, m_interfaceId);
+    p = Put(p, static_cast<uint32_t>(timestamp >> 32));
+    p = Put(p, static_cast<uint32_t>(timestamp));
+    p = Put(p, inclLen);
+    p = Put(p, totalLen);
+    Put(p + Pad(inclLen), blockLen);
+    return p;
+}
+
 void
 PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, const uint8_t* const data, uint32_t totalLen)
 {
     NS_LOG_FUNCTION(this << tsSec << tsUsec << &data << totalLen);
+    if (m_writer)
+    {
+        uint32_t inclLen;
+        uint8_t* record = BeginRecord(tsSec, tsUsec, totalLen, inclLen);
+        std::memcpy(record, data, inclLen);
+        m_writer->EndRecord();
+        return;
+    }
     uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, totalLen);
     m_file.write((const char*)data, inclLen);
     NS_BUILD_DEBUG(m_file.flush());
@@ -442,6 +683,14 @@ void
 PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << tsSec << tsUsec << p);
+    if (m_writer)
+    {
+        uint32_t inclLen;
+        uint8_t* record = BeginRecord(tsSec, tsUsec, p->GetSize(), inclLen);
+        p->CopyData(record, inclLen);
+        m_writer->EndRecord();
+        return;
+    }
     uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, p->GetSize());
     p->CopyData(&m_file, inclLen);
     NS_BUILD_DEBUG(m_file.flush());
@@ -453,11 +702,23 @@ PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, const Header& header, Ptr<const
     NS_LOG_FUNCTION(this << tsSec << tsUsec << &header << p);
     uint32_t headerSize = header.GetSerializedSize();
     uint32_t totalSize = headerSize + p->GetSize();
-    uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, totalSize);
 
     Buffer headerBuffer;
     headerBuffer.AddAtStart(headerSize);
     header.Serialize(headerBuffer.Begin());
+
+    if (m_writer)
+    {
+        uint32_t inclLen;
+        uint8_t* record = BeginRecord(tsSec, tsUsec, totalSize, inclLen);
+        uint32_t toCopy = std::min(headerSize, inclLen);
+        headerBuffer.CopyData(record, toCopy);
+        p->CopyData(record + toCopy, inclLen - toCopy);
+        m_writer->EndRecord();
+        return;
+    }
+
+    uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, totalSize);
     uint32_t toCopy = std::min(headerSize, inclLen);
     headerBuffer.CopyData(&m_file, toCopy);
     inclLen -= toCopy;
@@ -12,6 +12,7 @@
 #include "ns3/ptr.h"
 
 #include <fstream>
+#include <memory>
 #include <stdint.h>
 #include <string>
 
@@ -20,6 +21,7 @@ namespace ns3
 
 class Packet;
 class Header;
+class PcapWriter;
 
 /**
  * @brief A class representing a pcap file
@@ -27,6 +29,13 @@ class Header;
  * A class representing a pcap file.  This allows easy creation, writing and
  * reading of files composed of stored packets; which may be viewed using
  * standard tools.
+ *
+ * Files opened for writing only can be written through a PcapWriter,
+ * see EnableBatching(): the records are then batched in memory,
+ * optionally compressed with gzip, and written by a background thread.
+ * Several files can also be multiplexed as the interfaces of a single
+ * pcapng file, see SetSharedFile().  Otherwise, each record is directly
+ * written to the file.
  */
 class PcapFile
 {
@@ -52,6 +61,29 @@ class PcapFile
      */
     void Clear();
 
+    /**
+     * Write the records of the files opened for writing only through a
+     * PcapWriter.  Must be called before Open().
+     *
+     * @param batchSize The size of the batches of records, in bytes, or 0 for
+     * PcapWriter::BATCH_SIZE_DEFAULT.
+     * @param async Whether the batches are written by a background thread.
+     * @param compress Whether the file is compressed with gzip.  The ".gz"
+     * extension is then added to the name of the file, unless already present.
+     */
+    void EnableBatching(uint32_t batchSize, bool async = false, bool compress = false);
+
+    /**
+     * Write the records of the files opened for writing only as the packets
+     * of an interface of a pcapng file, shared by all the files opened with
+     * the same shared file name.  The interface is named after the file
+     * passed to Open(), which is not created, and is described by Init().
+     * Must be called before Open(), and enables batching if not enabled yet.
+     *
+     * @param filename The name of the pcapng file.
+     */
+    void SetSharedFile(const std::string& filename);
+
     /**
      * Create a new pcap file or open an existing pcap file.  Semantics are
      * similar to the stdc++ io stream classes, but differ in that
@@ -362,11 +394,33 @@ class PcapFile
      */
     void ReadAndVerifyFileHeader();
 
+    /**
+     * @brief Write a pcapng interface description block
+     */
+    void WriteInterfaceDescription();
+    /**
+     * @brief Start a record in the writer, and write its header
+     *
+     * @param tsSec Time stamp (seconds part)
+     * @param tsUsec Time stamp (microseconds part)
+     * @param totalLen total packet length
+     * @param inclLen [out] the length of the packet to write in the record
+     * @returns the bytes of the packet data in the record, until PcapWriter::EndRecord()
+     */
+    uint8_t* BeginRecord(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t& inclLen);
+
     std::string m_filename;      //!< file name
     std::fstream m_file;         //!< file stream
     PcapFileHeader m_fileHeader; //!< file header
     bool m_swapMode;             //!< swap mode
     bool m_nanosecMode;          //!< nanosecond timestamp mode
+
+    uint32_t m_batchSize;                 //!< size of the batches of records, 0 if not batched
+    bool m_async;                         //!< whether the batches are written asynchronously
+    bool m_compress;                      //!< whether the file is compressed with gzip
+    std::string m_sharedFile;             //!< shared pcapng file, empty if not shared
+    std::shared_ptr<PcapWriter> m_writer; //!< writer of the records, if batched
+    uint32_t m_interfaceId;               //!< interface of the records in the shared file
 };
 
 } // namespace ns3
@@ -0,0 +1,419 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "pcap-writer.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <unordered_set>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @file
+ * @ingroup network
+ * ns3::PcapWriter implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PcapWriter");
+
+/**
+ * @brief The background thread writing the batches of the asynchronous writers.
+ *
+ * The thread is started by the first batch submitted, and stopped when
+ * the program exits, after all the writers still alive are flushed.  The
+ * batches submitted afterwards are written synchronously.
+ */
+class PcapWriterThread
+{
+  public:
+    /** The maximum size of the batches queued for writing, in bytes. */
+    static constexpr std::size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+    /**
+     * Get the background thread.
+     *
+     * The thread is never destroyed, as writers may be closed by the
+     * static destructors of other compilation units.
+     *
+     * @returns The background thread.
+     */
+    static PcapWriterThread& Get()
+    {
+        static auto thread = new PcapWriterThread;
+        return *thread;
+    }
+
+    /**
+     * Register a writer, to flush it at exit.
+     *
+     * @param [in] writer The writer.
+     */
+    void Register(PcapWriter* writer)
+    {
+        std::lock_guard lock(m_mutex);
+        m_writers.insert(writer);
+    }
+
+    /**
+     * Unregister a closed writer.
+     *
+     * @param [in] writer The writer.
+     */
+    void Unregister(PcapWriter* writer)
+    {
+        std::lock_guard lock(m_mutex);
+        m_writers.erase(writer);
+    }
+
+    /**
+     * Queue a batch for writing, waiting for room in the queue if needed.
+     *
+     * @param [in] writer The writer of the batch.
+     * @param [in] batch The batch.
+     */
+    void Submit(PcapWriter* writer, std::vector<uint8_t>&& batch)
+    {
+        std::unique_lock lock(m_mutex);
+        m_done.wait(lock, [this] { return m_queuedBytes < MAX_QUEUED_BYTES || m_stopped; });
+        if (m_stopped)
+        {
+            lock.unlock();
+            writer->WriteBatch(batch);
+            return;
+        }
+        if (!m_thread.joinable())
+        {
+            m_thread = std::thread(&PcapWriterThread::Run, this);
+        }
+        m_queuedBytes += batch.size();
+        writer->m_pending++;
+        m_jobs.push_back({writer, std::move(batch)});
+        m_ready.notify_one();
+    }
+
+    /**
+     * Wait until the batches of a writer are written.
+     *
+     * @param [in] writer The writer.
+     */
+    void Wait(PcapWriter* writer)
+    {
+        std::unique_lock lock(m_mutex);
+        m_done.wait(lock, [writer] { return writer->m_pending == 0; });
+    }
+
+    /**
+     * Flush the writers still alive, and stop the thread.
+     */
+    void Shutdown()
+    {
+        std::vector<PcapWriter*> writers;
+        {
+            std::lock_guard lock(m_mutex);
+            writers.assign(m_writers.begin(), m_writers.end());
+        }
+        for (auto writer : writers)
+        {
+            writer->Flush();
+        }
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopped = true;
+            m_ready.notify_one();
+            m_done.notify_all();
+        }
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+  private:
+    /** A batch queued for writing. */
+    struct Job
+    {
+        PcapWriter* writer;         //!< The writer of the batch.
+        std::vector<uint8_t> batch; //!< The batch.
+    };
+
+    /**
+     * Write the queued batches, until the thread is stopped.
+     */
+    void Run()
+    {
+        std::unique_lock lock(m_mutex);
+        while (true)
+        {
+            m_ready.wait(lock, [this] { return !m_jobs.empty() || m_stopped; });
+            if (m_jobs.empty())
+            {
+                return;
+            }
+            Job job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            lock.unlock();
+            job.writer->WriteBatch(job.batch);
+            lock.lock();
+            m_queuedBytes -= job.batch.size();
+            job.writer->m_pending--;
+            m_done.notify_all();
+        }
+    }
+
+    std::mutex m_mutex;                        //!< Protects the other fields.
+    std::condition_variable m_ready;           //!< Signals a new job, or the stop of the thread.
+    std::condition_variable m_done;            //!< Signals a written job.
+    std::deque<Job> m_jobs;                    //!< The queued batches.
+    std::size_t m_queuedBytes{0};              //!< The size of the queued batches.
+    bool m_stopped{false};                     //!< Whether the thread has been stopped.
+    std::thread m_thread;                      //!< The thread.
+    std::unordered_set<PcapWriter*> m_writers; //!< The writers still alive.
+};
+
+namespace
+{
+
+/** Flushes the writers and stops the background thread when the program exits. */
+struct PcapWriterShutdown
+{
+    ~PcapWriterShutdown()
+    {
+        PcapWriterThread::Get().Shutdown();
+    }
+} g_pcapWriterShutdown; //!< Flushes the writers at exit.
+
+/** The writers of the shared files. */
+struct SharedWriters
+{
+    std::mutex mutex;                                         //!< Protects the writers.
+    std::map<std::string, std::weak_ptr<PcapWriter>> writers; //!< The writers, by file name.
+};
+
+/**
+ * Get the writers of the shared files.
+ *
+ * @returns The writers, never destroyed.
+ */
+SharedWriters&
+GetSharedWriters()
+{
+    static auto shared = new SharedWriters;
+    return *shared;
+}
+
+} // namespace
+
+PcapWriter::PcapWriter(const std::string& filename, uint32_t batchSize, bool async, bool compress)
+    : m_filename(filename),
+      m_batchSize(batchSize),
+      m_async(async),
+      m_compress(compress),
+      m_closed(false),
+      m_failed(false),
+      m_nextInterfaceId(0),
+      m_pending(0)
+{
+    NS_LOG_FUNCTION(this << filename << batchSize << async << compress);
+    NS_ABORT_MSG_IF(compress && !IsCompressionSupported(),
+                    "Compressed captures require ns-3 to be built with zlib");
+    m_batch.reserve(batchSize);
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    m_failed = !file;
+    PcapWriterThread::Get().Register(this);
+}
+
+PcapWriter::~PcapWriter()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+    PcapWriterThread::Get().Unregister(this);
+}
+
+std::shared_ptr<PcapWriter>
+PcapWriter::GetShared(const std::string& filename,
+                      uint32_t batchSize,
+                      bool async,
+                      bool compress,
+                      const std::vector<uint8_t>& header)
+{
+    NS_LOG_FUNCTION(filename << batchSize << async << compress << header.size());
+    SharedWriters& shared = GetSharedWriters();
+    std::lock_guard lock(shared.mutex);
+    std::shared_ptr<PcapWriter> writer = shared.writers[filename].lock();
+    if (!writer)
+    {
+        writer = std::make_shared<PcapWriter>(filename, batchSize, async, compress);
+        std::copy(header.begin(), header.end(), writer->BeginRecord(header.size()));
+        writer->EndRecord();
+        shared.writers[filename] = writer;
+    }
+    return writer;
+}
+
+bool
+PcapWriter::IsCompressionSupported()
+{
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint8_t*
+PcapWriter::BeginRecord(uint32_t size)
+{
+    m_mutex.lock();
+    NS_ASSERT_MSG(!m_closed, "Record added to closed capture " << m_filename);
+    if (!m_batch.empty() && m_batch.size() + size > m_batchSize)
+    {
+        Submit();
+    }
+    std::size_t offset = m_batch.size();
+    m_batch.resize(offset + size);
+    return m_batch.data() + offset;
+}
+
+void
+PcapWriter::EndRecord()
+{
+    if (m_batch.size() >= m_batchSize)
+    {
+        Submit();
+    }
+    m_mutex.unlock();
+}
+
+uint32_t
+PcapWriter::AllocateInterfaceId()
+{
+    return m_nextInterfaceId++;
+}
+
+void
+PcapWriter::Truncate()
+{
+    NS_LOG_FUNCTION(this);
+    PcapWriterThread::Get().Wait(this);
+    std::lock_guard lock(m_mutex);
+    m_batch.clear();
+    m_nextInterfaceId = 0;
+    std::ofstream file(m_filename, std::ios::binary | std::ios::trunc);
+    m_failed = !file;
+}
+
+void
+PcapWriter::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    {
+        std::lock_guard lock(m_mutex);
+        Submit();
+    }
+    PcapWriterThread::Get().Wait(this);
+}
+
+void
+PcapWriter::Close()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_closed)
+    {
+        return;
+    }
+    Flush();
+    m_closed = true;
+}
+
+bool
+PcapWriter::Fail() const
+{
+    return m_failed;
+}
+
+const std::string&
+PcapWriter::GetFilename() const
+{
+    return m_filename;
+}
+
+void
+PcapWriter::Submit()
+{
+    if (m_batch.empty())
+    {
+        return;
+    }
+    if (m_async)
+    {
+        std::vector<uint8_t> batch;
+        batch.reserve(m_batchSize);
+        std::swap(batch, m_batch);
+        PcapWriterThread::Get().Submit(this, std::move(batch));
+    }
+    else
+    {
+        WriteBatch(m_batch);
+        m_batch.clear();
+    }
+}
+
+void
+PcapWriter::WriteBatch(const std::vector<uint8_t>& batch)
+{
+    // No logging here: this method is called by the background thread.
+    const uint8_t* data = batch.data();
+    std::size_t size = batch.size();
+#ifdef HAVE_ZLIB
+    std::vector<uint8_t> compressed;
+    if (m_compress)
+    {
+        // Each batch is a gzip member of its own (RFC 1952, section 2.2)
+        z_stream stream{};
+        if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) !=
+            Z_OK)
+        {
+            m_failed = true;
+            return;
+        }
+        compressed.resize(deflateBound(&stream, size));
+        stream.next_in = const_cast<Bytef*>(data);
+        stream.avail_in = size;
+        stream.next_out = compressed.data();
+        stream.avail_out = compressed.size();
+        int status = deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+        if (status != Z_STREAM_END)
+        {
+            m_failed = true;
+            return;
+        }
+        data = compressed.data();
+        size = compressed.size();
+    }
+#endif
+    std::ofstream file(m_filename, std::ios::binary | std::ios::app);
+    file.write(reinterpret_cast<const char*>(data), size);
+    if (!file)
+    {
+        m_failed = true;
+    }
+}
+
+} // namespace ns3
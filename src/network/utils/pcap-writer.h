@@ -0,0 +1,172 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef PCAP_WRITER_H
+#define PCAP_WRITER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup network
+ * ns3::PcapWriter declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @brief Batched writer of the records of a capture file.
+ *
+ * The records are appended to an in-memory batch, and each full batch
+ * is appended to the file, which is opened only for the duration of
+ * the write: thousands of captures can thus be written concurrently
+ * without keeping thousands of files open.
+ *
+ * In asynchronous mode, the full batches are handed to a background
+ * thread, shared by all the writers, which compresses and writes them
+ * while the simulation goes on.  The batches queued for writing are
+ * bounded, so that a simulation producing records faster than they can
+ * be written is slowed down instead of exhausting the memory.
+ *
+ * In compressed mode, each batch is written as a gzip member, so that
+ * the file can be read by zcat, Wireshark or tcpdump as any gzip file.
+ *
+ * The records are written in the order in which they were added, even
+ * by different threads (see ns3::MultithreadedSimulatorImpl): a record
+ * is added between a call to BeginRecord() and EndRecord(), which hold
+ * the lock of the writer.  The writers still alive when the program
+ * exits are flushed.
+ */
+class PcapWriter
+{
+  public:
+    /** The default size of the batches, in bytes. */
+    static constexpr uint32_t BATCH_SIZE_DEFAULT = 1024 * 1024;
+
+    /**
+     * Create a writer, and truncate its file.
+     *
+     * @param [in] filename The name of the file.
+     * @param [in] batchSize The size of the batches, in bytes.
+     * @param [in] async Whether the batches are written by the background thread.
+     * @param [in] compress Whether the file is compressed with gzip.
+     */
+    PcapWriter(const std::string& filename, uint32_t batchSize, bool async, bool compress);
+
+    /** Destructor, which closes the writer. */
+    ~PcapWriter();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    PcapWriter(const PcapWriter&) = delete;
+    PcapWriter& operator=(const PcapWriter&) = delete;
+
+    /**
+     * Get the writer of a file shared by several captures.
+     *
+     * @param [in] filename The name of the file.
+     * @param [in] batchSize The size of the batches, in bytes.
+     * @param [in] async Whether the batches are written by the background thread.
+     * @param [in] compress Whether the file is compressed with gzip.
+     * @param [in] header The record written first when the writer is created.
+     * @returns The writer of the file, created if no writer of the same
+     *          file is alive.
+     */
+    static std::shared_ptr<PcapWriter> GetShared(const std::string& filename,
+                                                 uint32_t batchSize,
+                                                 bool async,
+                                                 bool compress,
+                                                 const std::vector<uint8_t>& header);
+
+    /**
+     * @returns true if the gzip compression is available in this build.
+     */
+    static bool IsCompressionSupported();
+
+    /**
+     * Start a record, and lock the writer until EndRecord() is called.
+     *
+     * @param [in] size The size of the record, in bytes.
+     * @returns The zero-filled bytes of the record, which remain valid
+     *          until EndRecord() is called.
+     */
+    uint8_t* BeginRecord(uint32_t size);
+
+    /**
+     * End the record started by BeginRecord(), and unlock the writer.
+     */
+    void EndRecord();
+
+    /**
+     * Allocate the next identifier of the interfaces of a pcapng file.
+     *
+     * Must be called between BeginRecord() and EndRecord(), so that the
+     * interfaces are described in the file in the order of their identifiers.
+     *
+     * @returns The identifier, starting from 0.
+     */
+    uint32_t AllocateInterfaceId();
+
+    /**
+     * Discard the records and truncate the file.
+     */
+    void Truncate();
+
+    /**
+     * Write the records added so far to the file, and wait until they are written.
+     */
+    void Flush();
+
+    /**
+     * Flush the writer.  Records can no longer be added.
+     */
+    void Close();
+
+    /**
+     * @returns true if the file could not be created or written.
+     */
+    bool Fail() const;
+
+    /**
+     * @returns The name of the file.
+     */
+    const std::string& GetFilename() const;
+
+  private:
+    friend class PcapWriterThread;
+
+    /**
+     * Hand the current batch for writing, with the lock of the writer held.
+     */
+    void Submit();
+
+    /**
+     * Compress a batch and append it to the file.
+     *
+     * Called by the background thread, or by Submit() in synchronous mode.
+     *
+     * @param [in] batch The batch.
+     */
+    void WriteBatch(const std::vector<uint8_t>& batch);
+
+    std::string m_filename;       //!< The name of the file.
+    uint32_t m_batchSize;         //!< The size of the batches, in bytes.
+    bool m_async;                 //!< Whether the batches are written by the background thread.
+    bool m_compress;              //!< Whether the file is compressed with gzip.
+    bool m_closed;                //!< Whether the writer has been closed.
+    std::atomic<bool> m_failed;   //!< Whether the file could not be created or written.
+    std::mutex m_mutex;           //!< Serializes the records, and protects the batch.
+    std::vector<uint8_t> m_batch; //!< The records not handed for writing yet.
+    uint32_t m_nextInterfaceId;   //!< The next identifier of the interfaces.
+    uint32_t m_pending;           //!< Batches queued for the background thread.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_WRITER_H */
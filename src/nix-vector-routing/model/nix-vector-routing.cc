@@ -14,13 +14,19 @@
 #include "nix-vector-routing.h"
 
 #include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/log.h"
 #include "ns3/loopback-net-device.h"
 #include "ns3/names.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <queue>
+#include <thread>
 
 namespace ns3
 {
@@ -30,6 +36,28 @@ NS_LOG_COMPONENT_DEFINE("NixVectorRouting");
 NS_OBJECT_TEMPLATE_CLASS_DEFINE(NixVectorRouting, Ipv4RoutingProtocol);
 NS_OBJECT_TEMPLATE_CLASS_DEFINE(NixVectorRouting, Ipv6RoutingProtocol);
 
+/**
+ * @ingroup nix-vector-routing
+ * @brief Whether the nix-vectors of all the pairs of nodes are precomputed.
+ */
+static GlobalValue g_nixVectorPrecompute(
+    "NixVectorPrecompute",
+    "Precompute the breadth first search trees of all the nodes at the first nix-vector "
+    "lookup, and update them selectively upon topology changes",
+    BooleanValue(false),
+    MakeBooleanChecker());
+
+/**
+ * @ingroup nix-vector-routing
+ * @brief The number of threads precomputing the nix-vectors.
+ */
+static GlobalValue g_nixVectorThreads(
+    "NixVectorThreads",
+    "The number of threads computing the breadth first search trees of the precomputed "
+    "nix-vectors (0 for the number of hardware threads)",
+    UintegerValue(1),
+    MakeUintegerChecker<uint32_t>());
+
 template <typename T>
 bool NixVectorRouting<T>::g_isCacheDirty = false;
 
@@ -44,6 +72,12 @@ template <typename T>
 typename NixVectorRouting<T>::NetDeviceToIpInterfaceMap
     NixVectorRouting<T>::g_netdeviceToIpInterfaceMap;
 
+template <typename T>
+typename NixVectorRouting<T>::NixGraph NixVectorRouting<T>::g_nixGraph;
+
+template <typename T>
+std::vector<std::vector<uint16_t>> NixVectorRouting<T>::g_nixParents;
+
 template <typename T>
 TypeId
 NixVectorRouting<T>::GetTypeId()
@@ -122,6 +156,10 @@ NixVectorRouting<T>::DoDispose()
     m_node = nullptr;
     m_ip = nullptr;
 
+    // The precomputed nix-vectors are dropped with the nodes
+    g_nixGraph = NixGraph();
+    g_nixParents.clear();
+
     T::DoDispose();
 }
 
@@ -157,6 +195,12 @@ NixVectorRouting<T>::FlushGlobalNixRoutingCache() const
     // IP address to node mapping is potentially invalid so clear it.
     // Will be repopulated in lazy evaluation when mapping is needed.
     g_ipAddressToNodeMap.clear();
+
+    // Only the precomputed BFS trees affected by the changes are computed again
+    if (!g_nixParents.empty())
+    {
+        UpdateNixVectorTable();
+    }
 }
 
 template <typename T>
@@ -204,6 +248,24 @@ NixVectorRouting<T>::GetNixVector(Ptr<Node> source, IpAddress dest, Ptr<NetDevic
     }
     else
     {
+        // the nix vectors not constrained to an output
+        // device are built from the precomputed trees
+        BooleanValue precompute;
+        g_nixVectorPrecompute.GetValue(precompute);
+        if (precompute.Get() && !oif)
+        {
+            if (g_nixParents.size() != NodeList::GetNNodes())
+            {
+                UpdateNixVectorTable();
+            }
+            if (BuildNixVectorFromTable(source->GetId(), destNode->GetId(), nixVector))
+            {
+                return nixVector;
+            }
+            NS_LOG_ERROR("No routing path exists");
+            return nullptr;
+        }
+
         // otherwise proceed as normal
         // and build the nix vector
         std::vector<Ptr<Node>> parentVector;
@@ -1270,6 +1332,292 @@ NixVectorRouting<T>::BFS(uint32_t numberOfNodes,
     return false;
 }
 
+template <typename T>
+typename NixVectorRouting<T>::NixGraph
+NixVectorRouting<T>::BuildNixGraph() const
+{
+    NS_LOG_FUNCTION(this);
+
+    NixGraph graph;
+    uint32_t nNodes = NodeList::GetNNodes();
+    graph.bfsNeighbors.resize(nNodes);
+    graph.nixNeighbors.resize(nNodes);
+    for (uint32_t n = 0; n < nNodes; n++)
+    {
+        Ptr<Node> node = NodeList::GetNode(n);
+        Ptr<IpL3Protocol> ip = node->GetObject<IpL3Protocol>();
+        for (uint32_t i = 0; i < node->GetNDevices(); i++)
+        {
+            Ptr<NetDevice> localNetDevice = node->GetDevice(i);
+            Ptr<Channel> channel = localNetDevice->GetChannel();
+            if (!channel)
+            {
+                continue;
+            }
+            NetDeviceContainer netDeviceContainer;
+            GetAdjacentNetDevices(localNetDevice, channel, netDeviceContainer);
+
+            // the neighbors numbered by BuildNixVector
+            if (!localNetDevice->IsBridge())
+            {
+                for (auto iter = netDeviceContainer.Begin(); iter != netDeviceContainer.End();
+                     iter++)
+                {
+                    graph.nixNeighbors[n].push_back((*iter)->GetNode()->GetId());
+                }
+            }
+
+            // the neighbors discovered by BFS
+            if (ip)
+            {
+                int32_t interfaceIndex = ip->GetInterfaceForDevice(localNetDevice);
+                if (interfaceIndex < 0 || !ip->IsUp(interfaceIndex))
+                {
+                    continue;
+                }
+            }
+            if (!localNetDevice->IsLinkUp())
+            {
+                continue;
+            }
+            for (auto iter = netDeviceContainer.Begin(); iter != netDeviceContainer.End(); iter++)
+            {
+                Ptr<IpInterface> remoteIpInterface = GetInterfaceByNetDevice(*iter);
+                if (remoteIpInterface && remoteIpInterface->IsUp())
+                {
+                    graph.bfsNeighbors[n].push_back((*iter)->GetNode()->GetId());
+                }
+            }
+        }
+    }
+    graph.bfsParents.resize(nNodes);
+    for (uint32_t n = 0; n < nNodes; n++)
+    {
+        for (uint32_t neighbor : graph.bfsNeighbors[n])
+        {
+            graph.bfsParents[neighbor].push_back(n);
+        }
+    }
+    return graph;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::NixGraphBFS(const NixGraph& graph,
+                                 uint32_t source,
+                                 std::vector<uint16_t>& parents)
+{
+    // The parents are the same as those found by BFS (), which stops at
+    // the destination after having set the parents of the nodes before it
+    parents.assign(graph.bfsNeighbors.size(), NO_PARENT);
+    std::queue<uint32_t> greyNodeList;
+    greyNodeList.push(source);
+    parents[source] = SOURCE_SLOT;
+    while (!greyNodeList.empty())
+    {
+        uint32_t currNode = greyNodeList.front();
+        greyNodeList.pop();
+        for (uint32_t remoteNode : graph.bfsNeighbors[currNode])
+        {
+            if (parents[remoteNode] == NO_PARENT)
+            {
+                const std::vector<uint32_t>& slots = graph.bfsParents[remoteNode];
+                parents[remoteNode] =
+                    std::find(slots.begin(), slots.end(), currNode) - slots.begin();
+                greyNodeList.push(remoteNode);
+            }
+        }
+    }
+}
+
+template <typename T>
+uint32_t
+NixVectorRouting<T>::GetNixParent(const NixGraph& graph,
+                                  const std::vector<uint16_t>& parents,
+                                  uint32_t node)
+{
+    return graph.bfsParents[node][parents[node]];
+}
+
+template <typename T>
+bool
+NixVectorRouting<T>::IsNixTreeAffected(const NixGraph& oldGraph,
+                                       const NixGraph& graph,
+                                       const std::vector<uint32_t>& changed,
+                                       const std::vector<std::pair<uint32_t, uint32_t>>& added,
+                                       std::vector<uint16_t>& parents)
+{
+    // a node whose parent is no longer among its parents lost its link
+    for (uint32_t node : changed)
+    {
+        if (parents[node] == NO_PARENT || parents[node] == SOURCE_SLOT)
+        {
+            continue;
+        }
+        uint32_t parent = GetNixParent(oldGraph, parents, node);
+        const std::vector<uint32_t>& slots = graph.bfsParents[node];
+        auto it = std::find(slots.begin(), slots.end(), parent);
+        if (it == slots.end())
+        {
+            return true;
+        }
+        parents[node] = it - slots.begin();
+    }
+
+    // the depth of a node in the tree, the nodes not reached being the
+    // deepest; a link added to a node of the same depth as the parent of
+    // its neighbor may be followed by the BFS before the link to this parent
+    constexpr uint32_t NOT_REACHED = std::numeric_limits<uint32_t>::max();
+    auto depth = [&graph, &parents](uint32_t node) {
+        if (parents[node] == NO_PARENT)
+        {
+            return NOT_REACHED;
+        }
+        uint32_t d = 0;
+        for (; parents[node] != SOURCE_SLOT; node = GetNixParent(graph, parents, node))
+        {
+            d++;
+        }
+        return d;
+    };
+    for (const auto& [node, neighbor] : added)
+    {
+        uint32_t d = depth(node);
+        if (d != NOT_REACHED && d + 1 <= depth(neighbor))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::UpdateNixVectorTable() const
+{
+    NS_LOG_FUNCTION(this);
+
+    NixGraph graph = BuildNixGraph();
+    uint32_t nNodes = graph.bfsNeighbors.size();
+
+    for (uint32_t n = 0; n < nNodes; n++)
+    {
+        NS_ABORT_MSG_IF(graph.bfsParents[n].size() >= SOURCE_SLOT,
+                        "NixVectorPrecompute supports up to " << SOURCE_SLOT - 1
+                                                              << " neighbors per node");
+    }
+
+    // all the trees are computed if the nodes changed, or if the BFS
+    // follows the same links in another order, else only those affected
+    // by the links removed or added
+    bool rebuild = g_nixParents.size() != nNodes;
+    std::vector<uint32_t> changed;
+    std::vector<std::pair<uint32_t, uint32_t>> added;
+    for (uint32_t n = 0; n < nNodes && !rebuild; n++)
+    {
+        if (g_nixGraph.bfsParents[n] != graph.bfsParents[n])
+        {
+            changed.push_back(n);
+        }
+        std::vector<uint32_t> before = g_nixGraph.bfsNeighbors[n];
+        std::vector<uint32_t> after = graph.bfsNeighbors[n];
+        if (before == after)
+        {
+            continue;
+        }
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        if (before == after)
+        {
+            rebuild = true;
+        }
+        std::vector<uint32_t> neighbors;
+        std::set_difference(after.begin(),
+                            after.end(),
+                            before.begin(),
+                            before.end(),
+                            std::back_inserter(neighbors));
+        for (uint32_t neighbor : neighbors)
+        {
+            added.emplace_back(n, neighbor);
+        }
+    }
+    g_nixParents.resize(nNodes);
+
+    UintegerValue threadsValue;
+    g_nixVectorThreads.GetValue(threadsValue);
+    uint32_t nThreads = threadsValue.Get();
+    if (nThreads == 0)
+    {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    nThreads = std::max(1U, std::min(nThreads, nNodes));
+
+    // the trees are computed on the graph of node indexes only, so that
+    // the threads do not touch the nodes
+    std::atomic<uint32_t> next(0);
+    std::atomic<uint32_t> nComputed(0);
+    auto work = [&]() {
+        for (uint32_t source = next++; source < nNodes; source = next++)
+        {
+            if (rebuild ||
+                IsNixTreeAffected(g_nixGraph, graph, changed, added, g_nixParents[source]))
+            {
+                NixGraphBFS(graph, source, g_nixParents[source]);
+                nComputed++;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < nThreads; i++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    g_nixGraph = std::move(graph);
+    NS_LOG_LOGIC("Computed " << nComputed << " BFS trees out of " << nNodes << " with "
+                             << nThreads << " threads");
+}
+
+template <typename T>
+bool
+NixVectorRouting<T>::BuildNixVectorFromTable(uint32_t source,
+                                             uint32_t dest,
+                                             Ptr<NixVector> nixVector) const
+{
+    NS_LOG_FUNCTION(this << source << dest << nixVector);
+
+    const std::vector<uint16_t>& parents = g_nixParents[source];
+    if (parents[dest] == NO_PARENT)
+    {
+        return false;
+    }
+
+    // as BuildNixVector (), from the last hop, the index of a node being
+    // its last one among the neighbors of its parent
+    for (uint32_t node = dest; node != source;)
+    {
+        uint32_t parent = GetNixParent(g_nixGraph, parents, node);
+        const std::vector<uint32_t>& neighbors = g_nixGraph.nixNeighbors[parent];
+        uint32_t destId = 0;
+        for (uint32_t i = 0; i < neighbors.size(); i++)
+        {
+            if (neighbors[i] == node)
+            {
+                destId = i;
+            }
+        }
+        nixVector->AddNeighborIndex(destId, nixVector->BitCount(neighbors.size()));
+        node = parent;
+    }
+    return true;
+}
+
 template <typename T>
 void
 NixVectorRouting<T>::PrintRoutingPath(Ptr<Node> source,
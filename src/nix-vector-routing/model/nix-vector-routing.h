@@ -30,8 +30,10 @@
 #include "ns3/node-list.h"
 #include "ns3/nstime.h"
 
+#include <limits>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 // NOLINTBEGIN(modernize-use-override)
 
@@ -49,6 +51,15 @@ namespace ns3
  * @ingroup nix-vector-routing
  * Nix-vector routing protocol
  *
+ * By default, the nix-vector to a destination is built on demand by a
+ * breadth first search (BFS) of the nodes, and cached per node.  If the
+ * global value NixVectorPrecompute is true, the BFS trees of all the
+ * nodes are computed at the first lookup by NixVectorThreads threads, and
+ * kept in a table shared by all the nodes, of one node index per pair of
+ * nodes, from which the nix-vectors are built by walking up the trees.
+ * Upon a topology change, only the trees losing one of their links, or
+ * made shorter by a new link, are computed again.
+ *
  * @internal
  * Since this class is meant to be specialized only by Ipv4RoutingProtocol or
  * Ipv6RoutingProtocol the implementation of this class doesn't need to be
@@ -245,6 +256,83 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
                                       uint32_t nodeIndex,
                                       IpAddress& gatewayIp) const;
 
+    /**
+     * The neighbors of the nodes, by node index, as seen by the BFS and by
+     * the nix indexes.  The graph only holds integers, so that several
+     * threads can search it.
+     */
+    struct NixGraph
+    {
+        /// The nodes discovered from each node by the BFS, in their order of discovery
+        std::vector<std::vector<uint32_t>> bfsNeighbors;
+        /// The neighbors of each node, in the order of their nix indexes
+        std::vector<std::vector<uint32_t>> nixNeighbors;
+        /// The nodes discovering each node by the BFS, whose index in this list is
+        /// the parent slot of the node in the BFS trees
+        std::vector<std::vector<uint32_t>> bfsParents;
+    };
+
+    /**
+     * Build the graph of the neighbors of all the nodes, as found by
+     * BFS () and BuildNixVector ().
+     * @returns the graph
+     */
+    NixGraph BuildNixGraph() const;
+
+    /**
+     * @brief Breadth first search of a graph from a node.
+     * @param [in] graph The graph.
+     * @param [in] source The index of the source node.
+     * @param [out] parents The parent slot of each node in the BFS tree:
+     * SOURCE_SLOT for the source, NO_PARENT for the nodes not reached.
+     */
+    static void NixGraphBFS(const NixGraph& graph, uint32_t source, std::vector<uint16_t>& parents);
+
+    /**
+     * Get the parent of a node in a BFS tree.
+     * @param graph The graph of the tree.
+     * @param parents The parent slots of the nodes in the tree.
+     * @param node The index of a node reached by the tree, other than its source.
+     * @returns the index of the parent of the node
+     */
+    static uint32_t GetNixParent(const NixGraph& graph,
+                                 const std::vector<uint16_t>& parents,
+                                 uint32_t node);
+
+    /**
+     * Check whether a BFS tree is still a BFS tree of a graph whose
+     * links changed, and move the parents of its nodes to their slots in
+     * the new graph.
+     * @param [in] oldGraph The graph of the tree.
+     * @param [in] graph The new graph.
+     * @param [in] changed The nodes whose list of parents changed.
+     * @param [in] added The links added, as (node, neighbor) pairs.
+     * @param [in,out] parents The parent slots of the nodes in the tree.
+     * @returns true if a link of the tree is removed, or an added link
+     * gives a path to a node no longer than its path in the tree, which
+     * the BFS could discover first
+     */
+    static bool IsNixTreeAffected(const NixGraph& oldGraph,
+                                  const NixGraph& graph,
+                                  const std::vector<uint32_t>& changed,
+                                  const std::vector<std::pair<uint32_t, uint32_t>>& added,
+                                  std::vector<uint16_t>& parents);
+
+    /**
+     * Compute the BFS trees of the precomputed nix-vectors, or update
+     * those affected by the changes of the topology.
+     */
+    void UpdateNixVectorTable() const;
+
+    /**
+     * Build a nix-vector from the precomputed BFS trees.
+     * @param [in] source Source Node index
+     * @param [in] dest Destination Node index
+     * @param [out] nixVector the NixVector to be used for routing
+     * @returns true on success, false if there is no path.
+     */
+    bool BuildNixVectorFromTable(uint32_t source, uint32_t dest, Ptr<NixVector> nixVector) const;
+
     /**
      * @brief Breadth first search algorithm.
      * @param [in] numberOfNodes total number of nodes
@@ -506,6 +594,19 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
     typedef std::unordered_map<Ptr<NetDevice>, Ptr<IpInterface>> NetDeviceToIpInterfaceMap;
     static NetDeviceToIpInterfaceMap
         g_netdeviceToIpInterfaceMap; //!< NetDevice pointer to IpInterface pointer map
+
+    /// The parent slot of a node not reached by a BFS
+    static constexpr uint16_t NO_PARENT = std::numeric_limits<uint16_t>::max();
+    /// The parent slot of the source of a BFS
+    static constexpr uint16_t SOURCE_SLOT = NO_PARENT - 1;
+
+    static NixGraph g_nixGraph; //!< Graph of the precomputed nix-vectors
+    /**
+     * BFS trees of the precomputed nix-vectors, by source node: the parent
+     * of each node, as its index in the NixGraph::bfsParents of the node,
+     * so that a tree costs two bytes per node.
+     */
+    static std::vector<std::vector<uint16_t>> g_nixParents;
 };
 
 /**
@@ -6,6 +6,8 @@
  * Author: Ameya Deshpande <ameyanrd@outlook.com>
  */
 
+#include "ns3/boolean.h"
+#include "ns3/config.h"
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/internet-stack-helper.h"
@@ -14,6 +16,7 @@
 #include "ns3/ipv6-address-helper.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/nix-vector-helper.h"
+#include "ns3/nix-vector-routing.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
@@ -21,6 +24,7 @@
 #include "ns3/test.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -49,11 +53,14 @@ using namespace ns3;
  * (Set down the interface of nC on nB-nC channel.)
  * - Test that routing is not possible from nSrc to nDst.
  *
+ * The test is run with the nix-vectors built on demand, and precomputed.
+ *
  * @brief IPv4 Nix-Vector Routing Test
  */
 class NixVectorRoutingTest : public TestCase
 {
     Ptr<Packet> m_receivedPacket; //!< Received packet
+    bool m_precompute;            //!< Whether the nix-vectors are precomputed
 
     /**
      * @brief Send data immediately after being called.
@@ -87,7 +94,12 @@ class NixVectorRoutingTest : public TestCase
 
   public:
     void DoRun() override;
-    NixVectorRoutingTest();
+
+    /**
+     * Constructor
+     * @param precompute Whether the nix-vectors are precomputed.
+     */
+    NixVectorRoutingTest(bool precompute);
 
     /**
      * @brief Receive data.
@@ -98,8 +110,10 @@ class NixVectorRoutingTest : public TestCase
     std::vector<uint32_t> m_receivedPacketSizes; //!< Received packet sizes
 };
 
-NixVectorRoutingTest::NixVectorRoutingTest()
-    : TestCase("three router, two path test")
+NixVectorRoutingTest::NixVectorRoutingTest(bool precompute)
+    : TestCase(std::string("three router, two path test") +
+               (precompute ? " with precomputed nix-vectors" : "")),
+      m_precompute(precompute)
 {
 }
 
@@ -155,6 +169,9 @@ NixVectorRoutingTest::SendData(Time delay, Ptr<Socket> socket, Ipv6Address to)
 void
 NixVectorRoutingTest::DoRun()
 {
+    Config::SetGlobal("NixVectorPrecompute", BooleanValue(m_precompute));
+    Config::SetGlobal("NixVectorThreads", UintegerValue(2));
+
     // Create topology
     NodeContainer nSrcnA;
     NodeContainer nAnB;
@@ -380,6 +397,153 @@ NixVectorRoutingTest::DoRun()
     NS_TEST_EXPECT_MSG_EQ(stringStream2v6.str(), emptyCaches, "The caches should have been empty.");
 
     Simulator::Destroy();
+    Config::SetGlobal("NixVectorPrecompute", BooleanValue(false));
+    Config::SetGlobal("NixVectorThreads", UintegerValue(1));
+}
+
+/**
+ * @ingroup nix-vector-routing-test
+ * @ingroup tests
+ *
+ * The nodes form a ring of 12 nodes with chords, having several shortest
+ * paths between most pairs of nodes.  The paths between all the pairs of
+ * nodes are printed with the nix-vectors built on demand, and with the
+ * precomputed ones, by 1 and 3 threads:
+ * - Test that the paths are the same.
+ * (Set down two interfaces, then set one of them up again.)
+ * - Test that the paths are still the same, the precomputed trees not
+ *   affected by the changes being kept.
+ *
+ * @brief Precomputed IPv4 Nix-Vector Routing Test
+ */
+class NixVectorPrecomputeTest : public TestCase
+{
+  public:
+    NixVectorPrecomputeTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Print the paths between all the pairs of nodes, after each change
+     * of the topology.
+     * @param precompute Whether the nix-vectors are precomputed.
+     * @param threads The number of threads precomputing the nix-vectors.
+     * @returns The paths, by change of the topology.
+     */
+    std::vector<std::vector<std::string>> GetPaths(bool precompute, uint32_t threads);
+};
+
+NixVectorPrecomputeTest::NixVectorPrecomputeTest()
+    : TestCase("precomputed nix-vectors")
+{
+}
+
+std::vector<std::vector<std::string>>
+NixVectorPrecomputeTest::GetPaths(bool precompute, uint32_t threads)
+{
+    Config::SetGlobal("NixVectorPrecompute", BooleanValue(precompute));
+    Config::SetGlobal("NixVectorThreads", UintegerValue(threads));
+
+    const uint32_t nNodes = 12;
+    NodeContainer nodes;
+    nodes.Create(nNodes);
+    InternetStackHelper stack;
+    stack.SetRoutingHelper(Ipv4NixVectorHelper());
+    stack.SetIpv6StackInstall(false);
+    stack.Install(nodes);
+
+    SimpleNetDeviceHelper devHelper;
+    devHelper.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.0.0", "255.255.255.0");
+    std::vector<NetDeviceContainer> links;
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        links.push_back(
+            devHelper.Install(NodeContainer(nodes.Get(i), nodes.Get((i + 1) % nNodes))));
+        if (i % 3 == 0)
+        {
+            links.push_back(
+                devHelper.Install(NodeContainer(nodes.Get(i), nodes.Get((i + 5) % nNodes))));
+        }
+    }
+    for (const auto& link : links)
+    {
+        address.Assign(link);
+        address.NewNetwork();
+    }
+
+    auto setInterface = [](Ptr<NetDevice> device, bool up) {
+        Ptr<Ipv4> ipv4 = device->GetNode()->GetObject<Ipv4>();
+        int32_t ifIndex = ipv4->GetInterfaceForDevice(device);
+        if (up)
+        {
+            ipv4->SetUp(ifIndex);
+        }
+        else
+        {
+            ipv4->SetDown(ifIndex);
+        }
+    };
+
+    std::vector<std::vector<std::string>> paths;
+    for (uint32_t change = 0; change < 4; change++)
+    {
+        if (change == 1)
+        {
+            setInterface(links[1].Get(0), false);
+        }
+        else if (change == 2)
+        {
+            setInterface(links[6].Get(1), false);
+        }
+        else if (change == 3)
+        {
+            setInterface(links[1].Get(0), true);
+        }
+        paths.emplace_back();
+        for (uint32_t s = 0; s < nNodes; s++)
+        {
+            Ptr<Ipv4NixVectorRouting> routing = nodes.Get(s)->GetObject<Ipv4NixVectorRouting>();
+            for (uint32_t d = 0; d < nNodes; d++)
+            {
+                Ipv4Address dest = nodes.Get(d)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+                std::ostringstream stream;
+                routing->PrintRoutingPath(nodes.Get(s),
+                                          dest,
+                                          Create<OutputStreamWrapper>(&stream),
+                                          Time::S);
+                paths.back().push_back(stream.str());
+            }
+        }
+    }
+
+    Simulator::Destroy();
+    Config::SetGlobal("NixVectorPrecompute", BooleanValue(false));
+    Config::SetGlobal("NixVectorThreads", UintegerValue(1));
+    return paths;
+}
+
+void
+NixVectorPrecomputeTest::DoRun()
+{
+    std::vector<std::vector<std::string>> expected = GetPaths(false, 1);
+    for (uint32_t threads : {1, 3})
+    {
+        std::vector<std::vector<std::string>> paths = GetPaths(true, threads);
+        NS_TEST_ASSERT_MSG_EQ(paths.size(), expected.size(), "Wrong number of changes");
+        for (std::size_t change = 0; change < expected.size(); change++)
+        {
+            for (std::size_t i = 0; i < expected[change].size(); i++)
+            {
+                NS_TEST_EXPECT_MSG_EQ(paths[change][i],
+                                      expected[change][i],
+                                      "Precomputed path " << i << " after change " << change
+                                                          << " is incorrect");
+            }
+        }
+    }
 }
 
 /**
@@ -394,7 +558,9 @@ class NixVectorRoutingTestSuite : public TestSuite
     NixVectorRoutingTestSuite()
         : TestSuite("nix-vector-routing", Type::UNIT)
     {
-        AddTestCase(new NixVectorRoutingTest(), TestCase::Duration::QUICK);
+        AddTestCase(new NixVectorRoutingTest(false), TestCase::Duration::QUICK);
+        AddTestCase(new NixVectorRoutingTest(true), TestCase::Duration::QUICK);
+        AddTestCase(new NixVectorPrecomputeTest(), TestCase::Duration::QUICK);
     }
 };
 
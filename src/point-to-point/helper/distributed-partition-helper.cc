@@ -0,0 +1,519 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/**
+ * @file
+ * @ingroup point-to-point
+ * Implementation of class ns3::DistributedPartitionHelper.
+ */
+
+#include "distributed-partition-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/channel-list.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/uinteger.h"
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/point-to-point-remote-channel.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DistributedPartitionHelper");
+
+namespace
+{
+
+/**
+ * Find the representative of a node in a union-find forest.
+ *
+ * @param [in,out] parent The parent of each node.
+ * @param [in] i The node.
+ * @returns The representative of the set of \pname{i}.
+ */
+uint32_t
+Find(std::vector<uint32_t>& parent, uint32_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/**
+ * Merge the sets of two nodes in a union-find forest, keeping the
+ * smallest node as representative so that the result does not depend
+ * on the order of the merges.
+ *
+ * @param [in,out] parent The parent of each node.
+ * @param [in] a The first node.
+ * @param [in] b The second node.
+ */
+void
+Union(std::vector<uint32_t>& parent, uint32_t a, uint32_t b)
+{
+    a = Find(parent, a);
+    b = Find(parent, b);
+    if (a != b)
+    {
+        parent[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+} // namespace
+
+DistributedPartitionHelper::DistributedPartitionHelper()
+    : m_maxImbalance(1.1),
+      m_nRanks(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+DistributedPartitionHelper::SetNodeWeight(Ptr<Node> node, double weight)
+{
+    NS_LOG_FUNCTION(this << node << weight);
+    NS_ABORT_MSG_IF(weight < 0, "The weight of a node cannot be negative");
+    if (m_weights.size() <= node->GetId())
+    {
+        m_weights.resize(node->GetId() + 1, 1.0);
+    }
+    m_weights[node->GetId()] = weight;
+}
+
+void
+DistributedPartitionHelper::SetNodeWeight(NodeContainer nodes, double weight)
+{
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        SetNodeWeight(*i, weight);
+    }
+}
+
+void
+DistributedPartitionHelper::SetMaxImbalance(double imbalance)
+{
+    NS_LOG_FUNCTION(this << imbalance);
+    NS_ABORT_MSG_IF(imbalance < 1, "The load imbalance cannot be lower than 1");
+    m_maxImbalance = imbalance;
+}
+
+void
+DistributedPartitionHelper::Partition(uint32_t nRanks)
+{
+    NS_LOG_FUNCTION(this << nRanks);
+    NS_ABORT_MSG_IF(nRanks == 0, "At least one rank is needed");
+
+    uint32_t nNodes = NodeList::GetNNodes();
+    m_nRanks = nRanks;
+    m_weights.resize(nNodes, 1.0);
+
+    // The point-to-point links with a delay can be cut, the nodes
+    // sharing any other channel are grouped
+    m_links.clear();
+    m_groups.resize(nNodes);
+    std::iota(m_groups.begin(), m_groups.end(), 0);
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<Channel> channel = *i;
+        std::vector<uint32_t> nodes;
+        for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+        {
+            Ptr<NetDevice> device = channel->GetDevice(j);
+            if (device && device->GetNode())
+            {
+                nodes.push_back(device->GetNode()->GetId());
+            }
+        }
+        if (nodes.size() < 2)
+        {
+            continue;
+        }
+        if (channel->GetObject<PointToPointChannel>() && nodes.size() == 2)
+        {
+            TimeValue delay;
+            channel->GetAttribute("Delay", delay);
+            if (delay.Get().IsStrictlyPositive())
+            {
+                m_links.push_back({nodes[0], nodes[1], delay.Get()});
+                continue;
+            }
+        }
+        for (auto node : nodes)
+        {
+            Union(m_groups, nodes[0], node);
+        }
+    }
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        Find(m_groups, i);
+    }
+
+    // Try the delay thresholds from the largest: keeping more links
+    // inside the ranks gives a larger lookahead but fewer, larger
+    // components to balance.
+    std::vector<Time> thresholds;
+    for (const auto& link : m_links)
+    {
+        thresholds.push_back(link.delay);
+    }
+    std::sort(thresholds.begin(), thresholds.end(), std::greater<>());
+    thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+    if (thresholds.empty())
+    {
+        thresholds.push_back(Time(0));
+    }
+
+    double bestImbalance = 0;
+    for (const auto& threshold : thresholds)
+    {
+        std::vector<uint32_t> ranks;
+        PartitionAbove(threshold, ranks);
+        double imbalance = ComputeImbalance(ranks);
+        NS_LOG_INFO("Threshold " << threshold.As(Time::MS) << ": imbalance " << imbalance);
+        if (m_ranks.empty() || imbalance < bestImbalance)
+        {
+            m_ranks = std::move(ranks);
+            bestImbalance = imbalance;
+        }
+        if (bestImbalance <= m_maxImbalance)
+        {
+            break;
+        }
+    }
+
+    m_rankWeights.assign(m_nRanks, 0.0);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        m_rankWeights[m_ranks[i]] += m_weights[i];
+    }
+}
+
+void
+DistributedPartitionHelper::PartitionAbove(Time threshold, std::vector<uint32_t>& ranks) const
+{
+    NS_LOG_FUNCTION(this << threshold);
+
+    uint32_t nNodes = m_groups.size();
+    std::vector<uint32_t> parent = m_groups;
+    for (const auto& link : m_links)
+    {
+        if (link.delay < threshold)
+        {
+            Union(parent, link.a, link.b);
+        }
+    }
+
+    // Number the components by their smallest node
+    std::vector<uint32_t> component(nNodes);
+    std::vector<double> weight;
+    std::map<uint32_t, uint32_t> index;
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        auto [it, inserted] = index.emplace(Find(parent, i), weight.size());
+        if (inserted)
+        {
+            weight.push_back(0);
+        }
+        component[i] = it->second;
+        weight[it->second] += m_weights[i];
+    }
+    uint32_t nComponents = weight.size();
+
+    // The number of cut links between the components
+    std::vector<std::map<uint32_t, uint32_t>> edges(nComponents);
+    for (const auto& link : m_links)
+    {
+        uint32_t a = component[link.a];
+        uint32_t b = component[link.b];
+        if (a != b)
+        {
+            edges[a][b]++;
+            edges[b][a]++;
+        }
+    }
+
+    const uint32_t unassigned = m_nRanks;
+    const uint32_t none = nComponents;
+    std::vector<uint32_t> part(nComponents, unassigned);
+    std::vector<double> partWeight(m_nRanks, 0.0);
+    double total = std::accumulate(weight.begin(), weight.end(), 0.0);
+    double target = total / m_nRanks;
+
+    // Grow each part from the heaviest component left, adding the
+    // component most connected to the part while it gets closer to the
+    // target weight; the last part takes the remaining components.
+    for (uint32_t p = 0; p + 1 < m_nRanks; ++p)
+    {
+        std::map<uint32_t, uint32_t> frontier;
+        uint32_t next = none;
+        for (uint32_t c = 0; c < nComponents; ++c)
+        {
+            if (part[c] == unassigned && (next == none || weight[c] > weight[next]))
+            {
+                next = c;
+            }
+        }
+        while (next != none)
+        {
+            part[next] = p;
+            partWeight[p] += weight[next];
+            frontier.erase(next);
+            for (const auto& [c, n] : edges[next])
+            {
+                if (part[c] == unassigned)
+                {
+                    frontier[c] += n;
+                }
+            }
+            next = none;
+            for (const auto& [c, n] : frontier)
+            {
+                if (next == none || n > frontier[next])
+                {
+                    next = c;
+                }
+            }
+            if (next != none &&
+                std::abs(partWeight[p] + weight[next] - target) >= std::abs(partWeight[p] - target))
+            {
+                next = none;
+            }
+        }
+    }
+    for (uint32_t c = 0; c < nComponents; ++c)
+    {
+        if (part[c] == unassigned)
+        {
+            part[c] = m_nRanks - 1;
+            partWeight[m_nRanks - 1] += weight[c];
+        }
+    }
+
+    // Refine: move the components to the part they have the most links
+    // to, as long as the balance is kept, then move components out of
+    // the heaviest part while this lowers the maximum load.
+    double limit =
+        std::max(m_maxImbalance * target, *std::max_element(partWeight.begin(), partWeight.end()));
+    for (uint32_t pass = 0; pass < 4; ++pass)
+    {
+        bool moved = false;
+        for (uint32_t c = 0; c < nComponents; ++c)
+        {
+            std::map<uint32_t, uint32_t> links;
+            for (const auto& [d, n] : edges[c])
+            {
+                links[part[d]] += n;
+            }
+            uint32_t from = part[c];
+            uint32_t internal = links[from];
+            for (const auto& [to, n] : links)
+            {
+                if (to != from && n > internal && partWeight[to] + weight[c] <= limit &&
+                    partWeight[from] > weight[c])
+                {
+                    part[c] = to;
+                    partWeight[from] -= weight[c];
+                    partWeight[to] += weight[c];
+                    moved = true;
+                    break;
+                }
+            }
+        }
+        if (!moved)
+        {
+            break;
+        }
+    }
+    for (uint32_t moves = 0; moves < nComponents; ++moves)
+    {
+        uint32_t from = std::max_element(partWeight.begin(), partWeight.end()) - partWeight.begin();
+        uint32_t to = std::min_element(partWeight.begin(), partWeight.end()) - partWeight.begin();
+        uint32_t best = none;
+        for (uint32_t c = 0; c < nComponents; ++c)
+        {
+            if (part[c] == from && partWeight[to] + weight[c] < partWeight[from] &&
+                (best == none || weight[c] > weight[best]))
+            {
+                best = c;
+            }
+        }
+        if (best == none || weight[best] == 0)
+        {
+            break;
+        }
+        part[best] = to;
+        partWeight[from] -= weight[best];
+        partWeight[to] += weight[best];
+    }
+
+    ranks.resize(nNodes);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        ranks[i] = part[component[i]];
+    }
+}
+
+double
+DistributedPartitionHelper::ComputeImbalance(const std::vector<uint32_t>& ranks) const
+{
+    std::vector<double> weights(m_nRanks, 0.0);
+    for (std::size_t i = 0; i < ranks.size(); ++i)
+    {
+        weights[ranks[i]] += m_weights[i];
+    }
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    if (total == 0)
+    {
+        return 1;
+    }
+    return *std::max_element(weights.begin(), weights.end()) * m_nRanks / total;
+}
+
+void
+DistributedPartitionHelper::Apply() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(m_ranks.size() != NodeList::GetNNodes(),
+                    "Partition() must be called after building the topology");
+
+    for (uint32_t i = 0; i < m_ranks.size(); ++i)
+    {
+        NodeList::GetNode(i)->SetAttribute("SystemId", UintegerValue(m_ranks[i]));
+    }
+
+#ifdef NS3_MPI
+    if (!MpiInterface::IsEnabled())
+    {
+        return;
+    }
+    // The links which cross the local rank need a remote channel, the
+    // other links a normal one, as built by PointToPointHelper::Install
+    uint32_t systemId = MpiInterface::GetSystemId();
+    std::vector<Ptr<PointToPointChannel>> channels;
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<PointToPointChannel> channel = (*i)->GetObject<PointToPointChannel>();
+        if (channel && channel->GetNDevices() == 2)
+        {
+            channels.push_back(channel);
+        }
+    }
+    for (const auto& channel : channels)
+    {
+        Ptr<PointToPointNetDevice> devA = channel->GetPointToPointDevice(0);
+        Ptr<PointToPointNetDevice> devB = channel->GetPointToPointDevice(1);
+        bool remote = devA->GetNode()->GetSystemId() != systemId ||
+                      devB->GetNode()->GetSystemId() != systemId;
+        if (remote == bool(channel->GetObject<PointToPointRemoteChannel>()))
+        {
+            continue;
+        }
+        TimeValue delay;
+        channel->GetAttribute("Delay", delay);
+        Ptr<PointToPointChannel> replacement;
+        if (remote)
+        {
+            replacement = CreateObject<PointToPointRemoteChannel>();
+            for (const auto& dev : {devA, devB})
+            {
+                if (!dev->GetObject<MpiReceiver>())
+                {
+                    Ptr<MpiReceiver> mpiRec = CreateObject<MpiReceiver>();
+                    mpiRec->SetReceiveCallback(MakeCallback(&PointToPointNetDevice::Receive, dev));
+                    dev->AggregateObject(mpiRec);
+                }
+            }
+        }
+        else
+        {
+            replacement = CreateObject<PointToPointChannel>();
+        }
+        replacement->SetAttribute("Delay", delay);
+        devA->Attach(replacement);
+        devB->Attach(replacement);
+        // The ChannelList cannot drop the replaced channel, so detach its
+        // devices for it not to be taken as a link any more
+        channel->Dispose();
+    }
+#endif
+}
+
+uint32_t
+DistributedPartitionHelper::GetRank(Ptr<Node> node) const
+{
+    NS_ASSERT_MSG(node->GetId() < m_ranks.size(), "Node " << node->GetId() << " not partitioned");
+    return m_ranks[node->GetId()];
+}
+
+double
+DistributedPartitionHelper::GetImbalance() const
+{
+    return ComputeImbalance(m_ranks);
+}
+
+Time
+DistributedPartitionHelper::GetLookahead() const
+{
+    Time lookahead = Time::Max();
+    for (const auto& link : m_links)
+    {
+        if (m_ranks[link.a] != m_ranks[link.b])
+        {
+            lookahead = std::min(lookahead, link.delay);
+        }
+    }
+    return lookahead;
+}
+
+uint32_t
+DistributedPartitionHelper::GetCutLinks() const
+{
+    uint32_t cut = 0;
+    for (const auto& link : m_links)
+    {
+        if (m_ranks[link.a] != m_ranks[link.b])
+        {
+            cut++;
+        }
+    }
+    return cut;
+}
+
+void
+DistributedPartitionHelper::PrintReport(std::ostream& os) const
+{
+    for (uint32_t i = 0; i < m_nRanks; ++i)
+    {
+        os << "Rank " << i << ": " << std::count(m_ranks.begin(), m_ranks.end(), i)
+           << " nodes, load " << m_rankWeights[i] << std::endl;
+    }
+    os << "Imbalance " << GetImbalance() << ", lookahead ";
+    Time lookahead = GetLookahead();
+    if (lookahead == Time::Max())
+    {
+        os << "unbounded";
+    }
+    else
+    {
+        os << lookahead.As(Time::MS);
+    }
+    os << ", " << GetCutLinks() << " cut links" << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,182 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/**
+ * @file
+ * @ingroup point-to-point
+ * Declaration of class ns3::DistributedPartitionHelper.
+ */
+
+#ifndef DISTRIBUTED_PARTITION_HELPER_H
+#define DISTRIBUTED_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * @ingroup point-to-point
+ * @brief Assign the nodes of a topology to the ranks of a distributed
+ * simulation.
+ *
+ * The helper takes the topology built so far (the nodes of the
+ * NodeList and the channels connecting them) and an estimate of the
+ * event load of each node, and computes a partition of the nodes into
+ * ranks which balances the load while keeping the low-delay links
+ * inside the ranks: the lookahead of the distributed simulation is the
+ * smallest delay of the point-to-point links crossing the partition.
+ *
+ * Only the point-to-point links with a positive delay can be cut; the
+ * nodes sharing any other channel are always kept in the same rank.
+ * The helper looks for the largest delay threshold such that keeping
+ * all the links with a smaller delay inside the ranks still gives a
+ * partition whose load imbalance is within SetMaxImbalance(); the
+ * parts are grown along the links, then refined to reduce the number
+ * of cut links.
+ *
+ * The partition is deterministic, so every rank computes the same one.
+ * Apply() sets the SystemId of the nodes and, in an MPI simulation,
+ * replaces the channels of the links crossing the partition by
+ * PointToPointRemoteChannel objects (and the other way round), as
+ * PointToPointHelper::Install would have done had the nodes been
+ * created with these system ids.  The replaced channels are disposed:
+ * they keep their place in the ChannelList, without any device.  It
+ * must be called after building the topology, and before installing the
+ * applications on the local nodes and running the simulation:
+ *
+ * \code{.cc}
+ *   DistributedPartitionHelper partition;
+ *   partition.SetNodeWeight(servers, 4.0);
+ *   partition.Partition(MpiInterface::GetSize());
+ *   partition.Apply();
+ *   partition.PrintReport(std::cout);
+ * \endcode
+ */
+class DistributedPartitionHelper
+{
+  public:
+    /** Constructor. */
+    DistributedPartitionHelper();
+
+    /**
+     * Set the estimated event load of a node.  The default weight of the
+     * nodes is 1.
+     *
+     * @param [in] node The node.
+     * @param [in] weight The relative number of events of the node.
+     */
+    void SetNodeWeight(Ptr<Node> node, double weight);
+
+    /**
+     * Set the estimated event load of several nodes.
+     *
+     * @param [in] nodes The nodes.
+     * @param [in] weight The relative number of events of each node.
+     */
+    void SetNodeWeight(NodeContainer nodes, double weight);
+
+    /**
+     * Set the maximum load imbalance traded for a larger lookahead.
+     *
+     * @param [in] imbalance The maximum ratio between the load of the
+     *             most loaded rank and the mean load; the default is 1.1.
+     */
+    void SetMaxImbalance(double imbalance);
+
+    /**
+     * Compute the partition of the nodes of the NodeList.
+     *
+     * @param [in] nRanks The number of ranks.
+     */
+    void Partition(uint32_t nRanks);
+
+    /**
+     * Set the SystemId of the nodes to their rank, and convert the
+     * point-to-point channels between local and remote channels.
+     */
+    void Apply() const;
+
+    /**
+     * Get the rank of a node in the partition.
+     *
+     * @param [in] node The node.
+     * @returns The rank of the node.
+     */
+    uint32_t GetRank(Ptr<Node> node) const;
+
+    /**
+     * Get the expected load imbalance of the partition.
+     *
+     * @returns The ratio between the load of the most loaded rank and
+     *          the mean load.
+     */
+    double GetImbalance() const;
+
+    /**
+     * Get the lookahead of the partition.
+     *
+     * @returns The smallest delay of the links crossing the partition,
+     *          or Time::Max() if no link crosses it.
+     */
+    Time GetLookahead() const;
+
+    /**
+     * Get the number of links crossing the partition.
+     *
+     * @returns The number of cut links.
+     */
+    uint32_t GetCutLinks() const;
+
+    /**
+     * Print the load of each rank, the imbalance, the lookahead and the
+     * number of cut links.
+     *
+     * @param [in,out] os The output stream.
+     */
+    void PrintReport(std::ostream& os) const;
+
+  private:
+    /** A point-to-point link which can be cut. */
+    struct Link
+    {
+        uint32_t a; /**< First node id. */
+        uint32_t b; /**< Second node id. */
+        Time delay; /**< Link delay. */
+    };
+
+    /**
+     * Partition the nodes keeping the links with a delay smaller than a
+     * threshold inside the ranks.
+     *
+     * @param [in] threshold The delay threshold.
+     * @param [out] ranks The rank of each node.
+     */
+    void PartitionAbove(Time threshold, std::vector<uint32_t>& ranks) const;
+
+    /**
+     * Compute the load imbalance of a partition.
+     *
+     * @param [in] ranks The rank of each node.
+     * @returns The load imbalance.
+     */
+    double ComputeImbalance(const std::vector<uint32_t>& ranks) const;
+
+    std::vector<double> m_weights;      //!< The weight of each node.
+    double m_maxImbalance;              //!< The maximum load imbalance.
+    uint32_t m_nRanks;                  //!< The number of ranks.
+    std::vector<Link> m_links;          //!< The links which can be cut.
+    std::vector<uint32_t> m_groups;     //!< The nodes which cannot be split.
+    std::vector<uint32_t> m_ranks;      //!< The rank of each node.
+    std::vector<double> m_rankWeights;  //!< The load of each rank.
+};
+
+} // namespace ns3
+
+#endif /* DISTRIBUTED_PARTITION_HELPER_H */
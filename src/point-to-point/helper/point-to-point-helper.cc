@@ -216,6 +216,50 @@ PointToPointHelper::EnableAsciiInternal(Ptr<OutputStreamWrapper> stream,
                     MakeBoundCallback(&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void
+PointToPointHelper::EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd)
+{
+    Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice>();
+    if (!device)
+    {
+        NS_LOG_INFO("Device " << device << " not of type ns3::PointToPointNetDevice");
+        return;
+    }
+
+    //
+    // The same events as the ascii traces, without packet printing.
+    //
+    BinaryTraceHelper binaryTraceHelper;
+    binaryTraceHelper.HookDefaultSink<PointToPointNetDevice>(device,
+                                                             "MacRx",
+                                                             file,
+                                                             BinaryTraceRecord::RECEIVE,
+                                                             device);
+
+    Ptr<Queue<Packet>> queue = device->GetQueue();
+    binaryTraceHelper.HookDefaultSink<Queue<Packet>>(queue,
+                                                     "Enqueue",
+                                                     file,
+                                                     BinaryTraceRecord::ENQUEUE,
+                                                     device);
+    binaryTraceHelper.HookDefaultSink<Queue<Packet>>(queue,
+                                                     "Drop",
+                                                     file,
+                                                     BinaryTraceRecord::DROP,
+                                                     device);
+    binaryTraceHelper.HookDefaultSink<Queue<Packet>>(queue,
+                                                     "Dequeue",
+                                                     file,
+                                                     BinaryTraceRecord::DEQUEUE,
+                                                     device);
+
+    binaryTraceHelper.HookDefaultSink<PointToPointNetDevice>(device,
+                                                             "PhyRxDrop",
+                                                             file,
+                                                             BinaryTraceRecord::DROP,
+                                                             device);
+}
+
 NetDeviceContainer
 PointToPointHelper::Install(NodeContainer c)
 {
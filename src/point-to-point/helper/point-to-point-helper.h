@@ -26,10 +26,12 @@ class Node;
  * @brief Build a set of PointToPointNetDevice objects
  *
  * Normally we eschew multiple inheritance, however, the classes
- * PcapUserHelperForDevice and AsciiTraceUserHelperForDevice are
- * "mixins".
+ * PcapUserHelperForDevice, AsciiTraceUserHelperForDevice and
+ * BinaryTraceHelperForDevice are "mixins".
  */
-class PointToPointHelper : public PcapHelperForDevice, public AsciiTraceHelperForDevice
+class PointToPointHelper : public PcapHelperForDevice,
+                           public AsciiTraceHelperForDevice,
+                           public BinaryTraceHelperForDevice
 {
   public:
     /**
@@ -175,6 +177,17 @@ class PointToPointHelper : public PcapHelperForDevice, public AsciiTraceHelperFo
                              Ptr<NetDevice> nd,
                              bool explicitFilename) override;
 
+    /**
+     * @brief Enable binary trace output on the indicated net device.
+     *
+     * NetDevice-specific implementation mechanism for hooking the trace and
+     * writing to the trace file.
+     *
+     * @param file The binary trace writer.
+     * @param nd Net device for which you want to enable tracing.
+     */
+    void EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd) override;
+
     ObjectFactory m_queueFactory;   //!< Queue Factory
     ObjectFactory m_channelFactory; //!< Channel Factory
     ObjectFactory m_deviceFactory;  //!< Device Factory
@@ -85,17 +85,39 @@ PointToPointChannel::TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevic
 
     uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-    Simulator::ScheduleWithContext(m_link[wire].m_dst->GetNode()->GetId(),
+    // The receiving device is only accessed by the event, in its own context
+    Simulator::ScheduleWithContext(GetDestinationNodeId(wire),
                                    txTime + m_delay,
-                                   &PointToPointNetDevice::Receive,
-                                   m_link[wire].m_dst,
+                                   &PointToPointChannel::Deliver,
+                                   this,
+                                   wire,
                                    p->Copy());
 
     // Call the tx anim callback on the net device
-    m_txrxPointToPoint(p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+    if (!m_txrxPointToPoint.IsEmpty())
+    {
+        m_txrxPointToPoint(p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+    }
     return true;
 }
 
+uint32_t
+PointToPointChannel::GetDestinationNodeId(uint32_t wire)
+{
+    if (m_link[wire].m_dstNodeId == UNKNOWN_NODE)
+    {
+        m_link[wire].m_dstNodeId = m_link[wire].m_dst->GetNode()->GetId();
+    }
+    return m_link[wire].m_dstNodeId;
+}
+
+void
+PointToPointChannel::Deliver(uint32_t wire, Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << wire << p);
+    m_link[wire].m_dst->Receive(p);
+}
+
 std::size_t
 PointToPointChannel::GetNDevices() const
 {
@@ -118,6 +140,32 @@ PointToPointChannel::GetDevice(std::size_t i) const
     return GetPointToPointDevice(i);
 }
 
+void
+PointToPointChannel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& link : m_link)
+    {
+        link = Link();
+    }
+    m_nDevices = 0;
+    Channel::DoDispose();
+}
+
+void
+PointToPointChannel::DoInitialize()
+{
+    NS_LOG_FUNCTION(this);
+    for (uint32_t wire = 0; wire < m_nDevices; ++wire)
+    {
+        if (m_link[wire].m_dst && m_link[wire].m_dst->GetNode())
+        {
+            GetDestinationNodeId(wire);
+        }
+    }
+    Channel::DoInitialize();
+}
+
 Time
 PointToPointChannel::GetDelay() const
 {
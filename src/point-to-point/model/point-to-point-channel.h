@@ -91,6 +91,21 @@ class PointToPointChannel : public Channel
     Ptr<NetDevice> GetDevice(std::size_t i) const override;
 
   protected:
+    /**
+     * @brief Detach the devices, so that a channel replaced by another
+     * one no longer refers to them
+     */
+    void DoDispose() override;
+
+    /**
+     * @brief Resolve the node of the destination of each wire
+     *
+     * A parallel simulator implementation initializes the channels it
+     * cuts before running the nodes in parallel, so that transmitting a
+     * packet does not access the node of the receiving device.
+     */
+    void DoInitialize() override;
+
     /**
      * @brief Get the delay associated with this channel
      * @returns Time delay
@@ -141,6 +156,25 @@ class PointToPointChannel : public Channel
     /** Each point to point link has exactly two net devices. */
     static const std::size_t N_DEVICES = 2;
 
+    /**
+     * @brief Get the id of the node receiving on a wire, resolving it
+     * on the first call
+     * @param wire the wire
+     * @returns the node id of the destination of the wire
+     */
+    uint32_t GetDestinationNodeId(uint32_t wire);
+
+    /**
+     * @brief Deliver a packet to the destination of a wire
+     *
+     * Run in the context of the receiving node, so that only the thread
+     * running that node accesses the receiving device.
+     *
+     * @param wire the wire the packet was transmitted on
+     * @param p the packet
+     */
+    void Deliver(uint32_t wire, Ptr<Packet> p);
+
     Time m_delay;           //!< Propagation delay
     std::size_t m_nDevices; //!< Devices of this channel
 
@@ -179,6 +213,9 @@ class PointToPointChannel : public Channel
         PROPAGATING
     };
 
+    /** Node id of a destination which is not resolved yet. */
+    static constexpr uint32_t UNKNOWN_NODE = 0xffffffff;
+
     /**
      * @brief Wire model for the PointToPointChannel
      */
@@ -193,6 +230,8 @@ class PointToPointChannel : public Channel
         WireState m_state{INITIALIZING};  //!< State of the link
         Ptr<PointToPointNetDevice> m_src; //!< First NetDevice
         Ptr<PointToPointNetDevice> m_dst; //!< Second NetDevice
+        /** Node id of the second NetDevice, resolved on the first transmission */
+        uint32_t m_dstNodeId{UNKNOWN_NODE};
     };
 
     Link m_link[N_DEVICES]; //!< Link model
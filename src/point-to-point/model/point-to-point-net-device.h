@@ -320,7 +320,7 @@ class PointToPointNetDevice : public NetDevice
      * transition).  This is a promiscuous trace (which doesn't mean a lot here
      * in the point-to-point device).
      */
-    TracedCallback<Ptr<const Packet>> m_macPromiscRxTrace;
+    OptionalTracedCallback<Ptr<const Packet>> m_macPromiscRxTrace;
 
     /**
      * The trace source fired for packets successfully received by the device
@@ -341,13 +341,13 @@ class PointToPointNetDevice : public NetDevice
      * The trace source fired when a packet begins the transmission process on
      * the medium.
      */
-    TracedCallback<Ptr<const Packet>> m_phyTxBeginTrace;
+    OptionalTracedCallback<Ptr<const Packet>> m_phyTxBeginTrace;
 
     /**
      * The trace source fired when a packet ends the transmission process on
      * the medium.
      */
-    TracedCallback<Ptr<const Packet>> m_phyTxEndTrace;
+    OptionalTracedCallback<Ptr<const Packet>> m_phyTxEndTrace;
 
     /**
      * The trace source fired when the phy layer drops a packet before it tries
@@ -359,13 +359,13 @@ class PointToPointNetDevice : public NetDevice
      * The trace source fired when a packet begins the reception process from
      * the medium -- when the simulated first bit(s) arrive.
      */
-    TracedCallback<Ptr<const Packet>> m_phyRxBeginTrace;
+    OptionalTracedCallback<Ptr<const Packet>> m_phyRxBeginTrace;
 
     /**
      * The trace source fired when a packet ends the reception process from
      * the medium.
      */
-    TracedCallback<Ptr<const Packet>> m_phyRxEndTrace;
+    OptionalTracedCallback<Ptr<const Packet>> m_phyRxEndTrace;
 
     /**
      * The trace source fired when the phy layer drops a packet it has received.
@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/distributed-partition-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <sstream>
+
+/**
+ * @file
+ * @ingroup point-to-point-tests
+ * DistributedPartitionHelper test suite.
+ */
+
+/**
+ * @ingroup point-to-point
+ * @defgroup point-to-point-tests Point-to-point module tests
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup point-to-point-tests
+ *
+ * @brief Check that two clusters joined by a long link are split along
+ * that link.
+ */
+class DistributedPartitionClustersTest : public TestCase
+{
+  public:
+    DistributedPartitionClustersTest();
+
+  private:
+    void DoRun() override;
+};
+
+DistributedPartitionClustersTest::DistributedPartitionClustersTest()
+    : TestCase("Check the partition of two clusters")
+{
+}
+
+void
+DistributedPartitionClustersTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(8);
+    PointToPointHelper p2p;
+    p2p.SetChannelAttribute("Delay", StringValue("1ms"));
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        p2p.Install(nodes.Get(i), nodes.Get(i + 1));
+        p2p.Install(nodes.Get(i + 4), nodes.Get(i + 5));
+    }
+    p2p.Install(nodes.Get(0), nodes.Get(2));
+    p2p.SetChannelAttribute("Delay", StringValue("10ms"));
+    p2p.Install(nodes.Get(3), nodes.Get(4));
+
+    DistributedPartitionHelper partition;
+    partition.Partition(2);
+    NS_TEST_EXPECT_MSG_EQ(partition.GetLookahead(), MilliSeconds(10), "Wrong lookahead");
+    NS_TEST_EXPECT_MSG_EQ(partition.GetCutLinks(), 1, "Wrong number of cut links");
+    NS_TEST_EXPECT_MSG_EQ_TOL(partition.GetImbalance(), 1, 1e-9, "Wrong imbalance");
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(partition.GetRank(nodes.Get(i)),
+                              partition.GetRank(nodes.Get(0)),
+                              "Node " << i << " not with node 0");
+        NS_TEST_EXPECT_MSG_EQ(partition.GetRank(nodes.Get(i + 4)),
+                              partition.GetRank(nodes.Get(4)),
+                              "Node " << i + 4 << " not with node 4");
+    }
+
+    partition.Apply();
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(nodes.Get(i)->GetSystemId(),
+                              partition.GetRank(nodes.Get(i)),
+                              "Wrong system id of node " << i);
+    }
+
+    std::ostringstream oss;
+    partition.PrintReport(oss);
+    NS_TEST_EXPECT_MSG_NE(oss.str().find("Rank 1: 4 nodes, load 4"),
+                          std::string::npos,
+                          "Wrong report " << oss.str());
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup point-to-point-tests
+ *
+ * @brief Check that the lookahead is traded for the balance according
+ * to the maximum imbalance.
+ */
+class DistributedPartitionImbalanceTest : public TestCase
+{
+  public:
+    DistributedPartitionImbalanceTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Build a chain of 4 nodes, with a 5 ms link in the middle, and
+     * partition it in 2 ranks.
+     *
+     * @param [in] maxImbalance The maximum imbalance.
+     * @param [in] lookahead The expected lookahead.
+     * @param [in] imbalance The expected imbalance.
+     */
+    void Check(double maxImbalance, Time lookahead, double imbalance);
+};
+
+DistributedPartitionImbalanceTest::DistributedPartitionImbalanceTest()
+    : TestCase("Check the maximum imbalance of the partition")
+{
+}
+
+void
+DistributedPartitionImbalanceTest::Check(double maxImbalance, Time lookahead, double imbalance)
+{
+    NodeContainer nodes;
+    nodes.Create(4);
+    PointToPointHelper p2p;
+    p2p.SetChannelAttribute("Delay", StringValue("1ms"));
+    p2p.Install(nodes.Get(0), nodes.Get(1));
+    p2p.Install(nodes.Get(2), nodes.Get(3));
+    p2p.SetChannelAttribute("Delay", StringValue("5ms"));
+    p2p.Install(nodes.Get(1), nodes.Get(2));
+
+    DistributedPartitionHelper partition;
+    partition.SetNodeWeight(nodes.Get(0), 3);
+    partition.SetMaxImbalance(maxImbalance);
+    partition.Partition(2);
+    NS_TEST_EXPECT_MSG_EQ(partition.GetLookahead(), lookahead, "Wrong lookahead");
+    NS_TEST_EXPECT_MSG_EQ_TOL(partition.GetImbalance(), imbalance, 1e-9, "Wrong imbalance");
+    NS_TEST_EXPECT_MSG_EQ(partition.GetCutLinks(), 1, "Wrong number of cut links");
+
+    Simulator::Destroy();
+}
+
+void
+DistributedPartitionImbalanceTest::DoRun()
+{
+    // Cutting the 5 ms link gives loads 4 and 2
+    Check(1.5, MilliSeconds(5), 4.0 / 3);
+    // Only isolating node 0 balances the loads
+    Check(1.1, MilliSeconds(1), 1);
+}
+
+/**
+ * @ingroup point-to-point-tests
+ *
+ * @brief TestSuite for DistributedPartitionHelper
+ */
+class DistributedPartitionTestSuite : public TestSuite
+{
+  public:
+    /**
+     * @brief Constructor
+     */
+    DistributedPartitionTestSuite();
+};
+
+DistributedPartitionTestSuite::DistributedPartitionTestSuite()
+    : TestSuite("distributed-partition-helper", Type::UNIT)
+{
+    AddTestCase(new DistributedPartitionClustersTest, TestCase::Duration::QUICK);
+    AddTestCase(new DistributedPartitionImbalanceTest, TestCase::Duration::QUICK);
+}
+
+static DistributedPartitionTestSuite g_distributedPartitionTestSuite; //!< The testsuite
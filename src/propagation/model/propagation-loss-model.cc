@@ -19,6 +19,7 @@
 #include "ns3/string.h"
 
 #include <cmath>
+#include <limits>
 
 namespace ns3
 {
@@ -71,6 +72,61 @@ PropagationLossModel::CalcRxPower(double txPowerDbm,
     return self;
 }
 
+double
+PropagationLossModel::GetMaxRxPower(double txPowerDbm, double distance) const
+{
+    double self = DoGetMaxRxPower(txPowerDbm, distance);
+    if (m_next)
+    {
+        self = m_next->GetMaxRxPower(self, distance);
+    }
+    return self;
+}
+
+double
+PropagationLossModel::GetRange(double txPowerDbm, double rxPowerDbm) const
+{
+    NS_LOG_FUNCTION(this << txPowerDbm << rxPowerDbm);
+    if (GetMaxRxPower(txPowerDbm, 0) < rxPowerDbm)
+    {
+        return 0;
+    }
+    // The bound does not increase with the distance: find a distance
+    // where it is below the power, then bisect
+    const double maxDistance = 1e9;
+    double low = 0;
+    double high = 1;
+    while (GetMaxRxPower(txPowerDbm, high) >= rxPowerDbm)
+    {
+        if (high > maxDistance)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+        low = high;
+        high *= 2;
+    }
+    while (high - low > 1e-3 * high)
+    {
+        double middle = (low + high) / 2;
+        if (GetMaxRxPower(txPowerDbm, middle) < rxPowerDbm)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+    NS_LOG_DEBUG("range=" << high << "m");
+    return high;
+}
+
+double
+PropagationLossModel::DoGetMaxRxPower(double txPowerDbm, double distance) const
+{
+    return std::numeric_limits<double>::infinity();
+}
+
 int64_t
 PropagationLossModel::AssignStreams(int64_t stream)
 {
@@ -272,6 +328,20 @@ FriisPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm - std::max(lossDb, m_minLoss);
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRxPower(double txPowerDbm, double distance) const
+{
+    // The loss increases with the distance
+    if (distance <= 0)
+    {
+        return txPowerDbm - m_minLoss;
+    }
+    double numerator = m_lambda * m_lambda;
+    double denominator = 16 * M_PI * M_PI * distance * distance * m_systemLoss;
+    double lossDb = -10 * log10(numerator / denominator);
+    return txPowerDbm - std::max(lossDb, m_minLoss);
+}
+
 int64_t
 FriisPropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -549,6 +619,21 @@ LogDistancePropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm + rxc;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRxPower(double txPowerDbm, double distance) const
+{
+    if (m_exponent < 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (distance <= m_referenceDistance)
+    {
+        return txPowerDbm - m_referenceLoss;
+    }
+    double pathLossDb = 10 * m_exponent * std::log10(distance / m_referenceDistance);
+    return txPowerDbm - m_referenceLoss - pathLossDb;
+}
+
 int64_t
 LogDistancePropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -648,6 +733,37 @@ ThreeLogDistancePropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm - pathLossDb;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRxPower(double txPowerDbm, double distance) const
+{
+    if (m_exponent0 < 0 || m_exponent1 < 0 || m_exponent2 < 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    // No loss before the first field, then the loss increases with the distance
+    double pathLossDb;
+    if (distance < m_distance0)
+    {
+        pathLossDb = std::min(0.0, m_referenceLoss);
+    }
+    else if (distance < m_distance1)
+    {
+        pathLossDb = m_referenceLoss + 10 * m_exponent0 * std::log10(distance / m_distance0);
+    }
+    else if (distance < m_distance2)
+    {
+        pathLossDb = m_referenceLoss + 10 * m_exponent0 * std::log10(m_distance1 / m_distance0) +
+                     10 * m_exponent1 * std::log10(distance / m_distance1);
+    }
+    else
+    {
+        pathLossDb = m_referenceLoss + 10 * m_exponent0 * std::log10(m_distance1 / m_distance0) +
+                     10 * m_exponent1 * std::log10(m_distance2 / m_distance1) +
+                     10 * m_exponent2 * std::log10(distance / m_distance2);
+    }
+    return txPowerDbm - pathLossDb;
+}
+
 int64_t
 ThreeLogDistancePropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -813,6 +929,12 @@ FixedRssLossModel::DoCalcRxPower(double txPowerDbm,
     return m_rss;
 }
 
+double
+FixedRssLossModel::DoGetMaxRxPower(double txPowerDbm, double distance) const
+{
+    return m_rss;
+}
+
 int64_t
 FixedRssLossModel::DoAssignStreams(int64_t stream)
 {
@@ -943,6 +1065,16 @@ RangePropagationLossModel::DoCalcRxPower(double txPowerDbm,
     }
 }
 
+double
+RangePropagationLossModel::DoGetMaxRxPower(double txPowerDbm, double distance) const
+{
+    if (distance <= m_range)
+    {
+        return txPowerDbm;
+    }
+    return -1000;
+}
+
 int64_t
 RangePropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -90,6 +90,28 @@ class PropagationLossModel : public Object
      */
     double CalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
+    /**
+     * Returns an upper bound of the Rx Power at a given distance or
+     * beyond, taking into account all the PropagationLossModel(s) chained
+     * to the current one.
+     *
+     * @param txPowerDbm current transmission power (in dBm)
+     * @param distance the distance between the source and the destination (in meters)
+     * @returns an upper bound of the reception power (in dBm) of any destination at the
+     * distance or beyond, or infinity if a model of the chain does not provide one
+     */
+    double GetMaxRxPower(double txPowerDbm, double distance) const;
+
+    /**
+     * Returns a distance beyond which the Rx Power is surely below a given
+     * power, as found from GetMaxRxPower ().
+     *
+     * @param txPowerDbm current transmission power (in dBm)
+     * @param rxPowerDbm the reception power (in dBm)
+     * @returns the distance (in meters), or infinity if no distance is found
+     */
+    double GetRange(double txPowerDbm, double rxPowerDbm) const;
+
     /**
      * If this loss model uses objects of type RandomVariableStream,
      * set the stream numbers to the integers starting with the offset
@@ -128,6 +150,19 @@ class PropagationLossModel : public Object
                                  Ptr<MobilityModel> a,
                                  Ptr<MobilityModel> b) const = 0;
 
+    /**
+     * Upper bound of the Rx Power at a given distance or beyond.
+     *
+     * The default implementation returns infinity, e.g., for the models
+     * drawing random variables, which must not be skipped by the users of
+     * the bound.
+     *
+     * @param txPowerDbm current transmission power (in dBm)
+     * @param distance the distance between the source and the destination (in meters)
+     * @returns an upper bound of the reception power (in dBm)
+     */
+    virtual double DoGetMaxRxPower(double txPowerDbm, double distance) const;
+
     Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -294,6 +329,7 @@ class FriisPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    double DoGetMaxRxPower(double txPowerDbm, double distance) const override;
     int64_t DoAssignStreams(int64_t stream) override;
 
     /**
@@ -484,6 +520,7 @@ class LogDistancePropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    double DoGetMaxRxPower(double txPowerDbm, double distance) const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -560,6 +597,7 @@ class ThreeLogDistancePropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    double DoGetMaxRxPower(double txPowerDbm, double distance) const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -677,6 +715,7 @@ class FixedRssLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    double DoGetMaxRxPower(double txPowerDbm, double distance) const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -789,6 +828,7 @@ class RangePropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    double DoGetMaxRxPower(double txPowerDbm, double distance) const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -0,0 +1,219 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "receiver-spatial-index.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @file
+ * @ingroup propagation
+ * ns3::ReceiverSpatialIndex implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ReceiverSpatialIndex");
+
+ReceiverSpatialIndex::ReceiverSpatialIndex()
+    : m_gridValid(false),
+      m_minX(0),
+      m_minY(0),
+      m_cellSize(1),
+      m_nX(0),
+      m_nY(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ReceiverSpatialIndex::~ReceiverSpatialIndex()
+{
+    NS_LOG_FUNCTION(this);
+    Clear();
+}
+
+void
+ReceiverSpatialIndex::Add(Ptr<MobilityModel> mobility)
+{
+    NS_LOG_FUNCTION(this << mobility);
+    uint32_t receiver = m_receivers.size();
+    m_receivers.push_back({mobility, Vector(), -1});
+    if (mobility)
+    {
+        auto [it, inserted] = m_mobilities.try_emplace(PeekPointer(mobility));
+        if (inserted)
+        {
+            mobility->TraceConnectWithoutContext(
+                "CourseChange",
+                MakeCallback(&ReceiverSpatialIndex::NotifyCourseChange, this));
+        }
+        it->second.push_back(receiver);
+    }
+    m_gridValid = false;
+}
+
+void
+ReceiverSpatialIndex::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    for (const auto& [mobility, receivers] : m_mobilities)
+    {
+        m_receivers[receivers.front()].mobility->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&ReceiverSpatialIndex::NotifyCourseChange, this));
+    }
+    m_mobilities.clear();
+    m_receivers.clear();
+    m_unplaced.clear();
+    m_cells.clear();
+    m_gridValid = false;
+}
+
+uint32_t
+ReceiverSpatialIndex::GetN() const
+{
+    return m_receivers.size();
+}
+
+void
+ReceiverSpatialIndex::GetCandidates(const Vector& position,
+                                    double range,
+                                    std::vector<uint32_t>& receivers)
+{
+    NS_LOG_FUNCTION(this << position << range);
+    receivers.clear();
+    if (!(range < std::numeric_limits<double>::infinity()))
+    {
+        for (uint32_t receiver = 0; receiver < m_receivers.size(); receiver++)
+        {
+            receivers.push_back(receiver);
+        }
+        return;
+    }
+    if (!m_gridValid)
+    {
+        BuildGrid();
+    }
+
+    // The horizontal distance is at most the distance, so that the cells
+    // overlapping the square around the position hold all the receivers
+    // within the range
+    int64_t minI = GetCellIndex(position.x - range, m_minX, m_nX);
+    int64_t maxI = GetCellIndex(position.x + range, m_minX, m_nX);
+    int64_t minJ = GetCellIndex(position.y - range, m_minY, m_nY);
+    int64_t maxJ = GetCellIndex(position.y + range, m_minY, m_nY);
+    for (int64_t j = minJ; j <= maxJ; j++)
+    {
+        for (int64_t i = minI; i <= maxI; i++)
+        {
+            for (uint32_t receiver : m_cells[j * m_nX + i])
+            {
+                if (CalculateDistance(m_receivers[receiver].position, position) <= range)
+                {
+                    receivers.push_back(receiver);
+                }
+            }
+        }
+    }
+    receivers.insert(receivers.end(), m_unplaced.begin(), m_unplaced.end());
+    std::sort(receivers.begin(), receivers.end());
+    NS_LOG_LOGIC(receivers.size() << " candidates out of " << m_receivers.size());
+}
+
+void
+ReceiverSpatialIndex::NotifyCourseChange(Ptr<const MobilityModel> mobility)
+{
+    NS_LOG_FUNCTION(this << mobility);
+    if (!m_gridValid)
+    {
+        return;
+    }
+    for (uint32_t receiver : m_mobilities[PeekPointer(mobility)])
+    {
+        Unplace(receiver);
+        Place(receiver);
+    }
+}
+
+void
+ReceiverSpatialIndex::BuildGrid()
+{
+    NS_LOG_FUNCTION(this);
+
+    // About one receiver per cell, over the bounding box of the static receivers
+    double minX = std::numeric_limits<double>::infinity();
+    double minY = minX;
+    double maxX = -minX;
+    double maxY = -minX;
+    uint32_t nStatic = 0;
+    for (const auto& receiver : m_receivers)
+    {
+        if (receiver.mobility && receiver.mobility->GetVelocity() == Vector())
+        {
+            Vector position = receiver.mobility->GetPosition();
+            minX = std::min(minX, position.x);
+            minY = std::min(minY, position.y);
+            maxX = std::max(maxX, position.x);
+            maxY = std::max(maxY, position.y);
+            nStatic++;
+        }
+    }
+    if (nStatic == 0)
+    {
+        minX = minY = maxX = maxY = 0;
+    }
+    double side = std::max({maxX - minX, maxY - minY, 1.0});
+    m_minX = minX;
+    m_minY = minY;
+    m_cellSize = side / std::ceil(std::sqrt(std::max(nStatic, 1U)));
+    m_nX = static_cast<int64_t>((maxX - minX) / m_cellSize) + 1;
+    m_nY = static_cast<int64_t>((maxY - minY) / m_cellSize) + 1;
+    m_cells.assign(m_nX * m_nY, {});
+    m_unplaced.clear();
+    for (uint32_t receiver = 0; receiver < m_receivers.size(); receiver++)
+    {
+        Place(receiver);
+    }
+    m_gridValid = true;
+    NS_LOG_LOGIC(m_nX << "x" << m_nY << " cells of " << m_cellSize << "m for " << nStatic
+                      << " static receivers out of " << m_receivers.size());
+}
+
+void
+ReceiverSpatialIndex::Place(uint32_t receiver)
+{
+    Receiver& r = m_receivers[receiver];
+    if (!r.mobility || r.mobility->GetVelocity() != Vector())
+    {
+        r.cell = -1;
+        m_unplaced.push_back(receiver);
+        return;
+    }
+    r.position = r.mobility->GetPosition();
+    r.cell = GetCellIndex(r.position.y, m_minY, m_nY) * m_nX +
+             GetCellIndex(r.position.x, m_minX, m_nX);
+    m_cells[r.cell].push_back(receiver);
+}
+
+void
+ReceiverSpatialIndex::Unplace(uint32_t receiver)
+{
+    Receiver& r = m_receivers[receiver];
+    auto& receivers = r.cell < 0 ? m_unplaced : m_cells[r.cell];
+    receivers.erase(std::find(receivers.begin(), receivers.end(), receiver));
+}
+
+int64_t
+ReceiverSpatialIndex::GetCellIndex(double x, double min, int64_t n) const
+{
+    double i = std::floor((x - min) / m_cellSize);
+    return static_cast<int64_t>(std::clamp(i, 0.0, static_cast<double>(n - 1)));
+}
+
+} // namespace ns3
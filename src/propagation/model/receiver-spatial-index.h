@@ -0,0 +1,136 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef RECEIVER_SPATIAL_INDEX_H
+#define RECEIVER_SPATIAL_INDEX_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/ptr.h"
+#include "ns3/vector.h"
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup propagation
+ * ns3::ReceiverSpatialIndex declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup propagation
+ *
+ * @brief A uniform grid of the positions of the receivers of a channel,
+ * to find those within a range of a transmitter.
+ *
+ * The receivers are numbered in their order of addition, e.g., the order
+ * of the list of the PHYs of the channel.  The grid is built at the first
+ * search after an addition, with about one receiver per cell, and is
+ * updated upon the course changes of the mobility models of the
+ * receivers.  The receivers moving, i.e., having a non-zero velocity, and
+ * those without a mobility model are not in the grid and are always
+ * returned by the searches.
+ */
+class ReceiverSpatialIndex
+{
+  public:
+    ReceiverSpatialIndex();
+    ~ReceiverSpatialIndex();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    ReceiverSpatialIndex(const ReceiverSpatialIndex&) = delete;
+    ReceiverSpatialIndex& operator=(const ReceiverSpatialIndex&) = delete;
+
+    /**
+     * Add a receiver.
+     *
+     * @param mobility The mobility model of the receiver, or nullptr.
+     */
+    void Add(Ptr<MobilityModel> mobility);
+
+    /**
+     * Remove all the receivers.
+     */
+    void Clear();
+
+    /**
+     * @returns The number of receivers.
+     */
+    uint32_t GetN() const;
+
+    /**
+     * Get the receivers that may be within a range of a position.
+     *
+     * @param position The position.
+     * @param range The range (in meters), or infinity.
+     * @param [out] receivers The numbers of the receivers, in increasing
+     * order: those within the range of the position, the moving ones and
+     * those without a mobility model.
+     */
+    void GetCandidates(const Vector& position, double range, std::vector<uint32_t>& receivers);
+
+  private:
+    /// A receiver
+    struct Receiver
+    {
+        Ptr<MobilityModel> mobility; //!< The mobility model, or nullptr
+        Vector position;             //!< The position, if in the grid
+        int64_t cell;                //!< The cell, or -1 if not in the grid
+    };
+
+    /**
+     * Update the receivers of a mobility model.
+     *
+     * @param mobility The mobility model.
+     */
+    void NotifyCourseChange(Ptr<const MobilityModel> mobility);
+
+    /**
+     * Build the grid from the current positions of the receivers.
+     */
+    void BuildGrid();
+
+    /**
+     * Add a receiver to the grid, or to the receivers not in the grid.
+     *
+     * @param receiver The number of the receiver.
+     */
+    void Place(uint32_t receiver);
+
+    /**
+     * Remove a receiver from the grid, or from the receivers not in the grid.
+     *
+     * @param receiver The number of the receiver.
+     */
+    void Unplace(uint32_t receiver);
+
+    /**
+     * @param x The coordinate.
+     * @param min The minimum coordinate of the grid.
+     * @param n The number of cells of the grid along the coordinate.
+     * @returns The index of the cell of the coordinate, the coordinates out
+     * of the grid being in the cells of its borders.
+     */
+    int64_t GetCellIndex(double x, double min, int64_t n) const;
+
+    std::vector<Receiver> m_receivers; //!< The receivers, by number
+    /// The receivers, by mobility model
+    std::map<const MobilityModel*, std::vector<uint32_t>> m_mobilities;
+    std::vector<uint32_t> m_unplaced;           //!< The receivers not in the grid
+    std::vector<std::vector<uint32_t>> m_cells; //!< The receivers of the cells, by row
+    bool m_gridValid;                           //!< Whether the grid is built
+    double m_minX;                              //!< The minimum x of the grid
+    double m_minY;                              //!< The minimum y of the grid
+    double m_cellSize;                          //!< The side of the cells
+    int64_t m_nX;                               //!< The number of cells along x
+    int64_t m_nY;                               //!< The number of cells along y
+};
+
+} // namespace ns3
+
+#endif /* RECEIVER_SPATIAL_INDEX_H */
@@ -13,6 +13,8 @@
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <cmath>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("PropagationLossModelsTest");
@@ -478,6 +480,76 @@ RangePropagationLossModelTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * @ingroup propagation-tests
+ *
+ * @brief PropagationLossModel::GetRange Test
+ *
+ * Check that the received power is below the given power beyond the
+ * range of a chain of deterministic models, and above it well within the
+ * range, and that no range is found for a random model.
+ */
+class PropagationLossModelRangeTestCase : public TestCase
+{
+  public:
+    PropagationLossModelRangeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PropagationLossModelRangeTestCase::PropagationLossModelRangeTestCase()
+    : TestCase("Test PropagationLossModel::GetRange")
+{
+}
+
+void
+PropagationLossModelRangeTestCase::DoRun()
+{
+    Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+    a->SetPosition(Vector(0, 0, 0));
+    Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+
+    Ptr<LogDistancePropagationLossModel> logDistance =
+        CreateObject<LogDistancePropagationLossModel>();
+    Ptr<PropagationLossModel> friis = CreateObject<FriisPropagationLossModel>();
+    Ptr<ThreeLogDistancePropagationLossModel> threeLogDistance =
+        CreateObject<ThreeLogDistancePropagationLossModel>();
+    Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel>();
+    range->SetAttribute("MaxRange", DoubleValue(1000));
+    std::vector<Ptr<PropagationLossModel>> models{logDistance, friis, threeLogDistance, range};
+    logDistance->SetNext(friis);
+
+    double txPowerDbm = 20;
+    for (double rxPowerDbm : {-60.0, -90.0, -150.0})
+    {
+        for (const auto& model : models)
+        {
+            double distance = model->GetRange(txPowerDbm, rxPowerDbm);
+            NS_TEST_ASSERT_MSG_EQ(std::isfinite(distance), true, "No range found");
+            for (double d : {distance, distance * 1.01, distance * 10})
+            {
+                b->SetPosition(Vector(0, d, 0));
+                NS_TEST_EXPECT_MSG_LT(model->CalcRxPower(txPowerDbm, a, b),
+                                      rxPowerDbm,
+                                      "Received power too high beyond the range " << distance);
+            }
+            b->SetPosition(Vector(0, distance * 0.99, 0));
+            NS_TEST_EXPECT_MSG_GT_OR_EQ(model->CalcRxPower(txPowerDbm, a, b),
+                                        rxPowerDbm,
+                                        "Range " << distance << " too large");
+        }
+    }
+
+    NS_TEST_EXPECT_MSG_EQ_TOL(range->GetRange(txPowerDbm, -10), 1000, 1, "Wrong range");
+
+    logDistance->SetNext(CreateObject<RandomPropagationLossModel>());
+    NS_TEST_EXPECT_MSG_EQ(std::isinf(logDistance->GetRange(txPowerDbm, -90)),
+                          true,
+                          "No range expected with a random model");
+    Simulator::Destroy();
+}
+
 /**
  * @ingroup propagation-tests
  *
@@ -504,6 +576,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite()
     AddTestCase(new LogDistancePropagationLossModelTestCase, TestCase::Duration::QUICK);
     AddTestCase(new MatrixPropagationLossModelTestCase, TestCase::Duration::QUICK);
     AddTestCase(new RangePropagationLossModelTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new PropagationLossModelRangeTestCase, TestCase::Duration::QUICK);
 }
 
 /// Static variable for test initialization
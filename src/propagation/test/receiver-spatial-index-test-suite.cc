@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/receiver-spatial-index.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @ingroup propagation-tests
+ *
+ * @brief ReceiverSpatialIndex Test
+ *
+ * Receivers at random positions, one of them moving and one without a
+ * mobility model, are searched around random positions:
+ * - Test that the candidates are the receivers within range, the moving
+ *   one and the one without a mobility model, in increasing order.
+ * (Move some receivers, stop the moving one.)
+ * - Test that the candidates follow the course changes.
+ */
+class ReceiverSpatialIndexTestCase : public TestCase
+{
+  public:
+    ReceiverSpatialIndexTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check the candidates around random positions against all the receivers.
+     * @param index The index.
+     * @param mobilities The mobility models of the receivers.
+     * @param random The random variable for the positions and ranges.
+     */
+    void CheckCandidates(ReceiverSpatialIndex& index,
+                         const std::vector<Ptr<MobilityModel>>& mobilities,
+                         Ptr<UniformRandomVariable> random);
+};
+
+ReceiverSpatialIndexTestCase::ReceiverSpatialIndexTestCase()
+    : TestCase("Check the candidates found by ReceiverSpatialIndex")
+{
+}
+
+void
+ReceiverSpatialIndexTestCase::CheckCandidates(ReceiverSpatialIndex& index,
+                                              const std::vector<Ptr<MobilityModel>>& mobilities,
+                                              Ptr<UniformRandomVariable> random)
+{
+    std::vector<uint32_t> candidates;
+    for (uint32_t query = 0; query < 50; query++)
+    {
+        Vector position(random->GetValue(-100, 1100), random->GetValue(-100, 1100), 0);
+        double range = random->GetValue(0, 300);
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < mobilities.size(); i++)
+        {
+            if (!mobilities[i] || mobilities[i]->GetVelocity() != Vector() ||
+                CalculateDistance(mobilities[i]->GetPosition(), position) <= range)
+            {
+                expected.push_back(i);
+            }
+        }
+        index.GetCandidates(position, range, candidates);
+        NS_TEST_EXPECT_MSG_EQ((candidates == expected),
+                              true,
+                              "Wrong candidates around " << position << " within " << range);
+    }
+    index.GetCandidates(Vector(), std::numeric_limits<double>::infinity(), candidates);
+    NS_TEST_EXPECT_MSG_EQ(candidates.size(), mobilities.size(), "All the receivers expected");
+}
+
+void
+ReceiverSpatialIndexTestCase::DoRun()
+{
+    auto random = CreateObject<UniformRandomVariable>();
+    random->SetStream(1);
+
+    ReceiverSpatialIndex index;
+    std::vector<Ptr<MobilityModel>> mobilities;
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(
+            Vector(random->GetValue(0, 1000), random->GetValue(0, 1000), random->GetValue(0, 50)));
+        mobilities.push_back(mobility);
+    }
+    // two receivers sharing a mobility model
+    mobilities.push_back(mobilities[10]);
+    auto moving = CreateObject<ConstantVelocityMobilityModel>();
+    moving->SetVelocity(Vector(10, 0, 0));
+    mobilities.push_back(moving);
+    mobilities.push_back(nullptr);
+    for (const auto& mobility : mobilities)
+    {
+        index.Add(mobility);
+    }
+    NS_TEST_EXPECT_MSG_EQ(index.GetN(), mobilities.size(), "Wrong number of receivers");
+    CheckCandidates(index, mobilities, random);
+
+    for (uint32_t i = 0; i < 200; i += 7)
+    {
+        mobilities[i]->SetPosition(Vector(random->GetValue(-500, 1500),
+                                          random->GetValue(-500, 1500),
+                                          random->GetValue(0, 50)));
+    }
+    moving->SetVelocity(Vector());
+    CheckCandidates(index, mobilities, random);
+
+    index.Clear();
+    NS_TEST_EXPECT_MSG_EQ(index.GetN(), 0, "No receiver expected");
+    // the course changes are no longer notified to the index
+    mobilities[0]->SetPosition(Vector());
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup propagation-tests
+ *
+ * @brief ReceiverSpatialIndex TestSuite
+ */
+class ReceiverSpatialIndexTestSuite : public TestSuite
+{
+  public:
+    ReceiverSpatialIndexTestSuite();
+};
+
+ReceiverSpatialIndexTestSuite::ReceiverSpatialIndexTestSuite()
+    : TestSuite("receiver-spatial-index", Type::UNIT)
+{
+    AddTestCase(new ReceiverSpatialIndexTestCase, TestCase::Duration::QUICK);
+}
+
+/// Static variable for test initialization
+static ReceiverSpatialIndexTestSuite g_receiverSpatialIndexTestSuite;
@@ -156,7 +156,8 @@ class MatrixBasedChannelModel : public Object
         mutable double m_cachedRbWidth = 0.0;
 
         /**
-         * Matrix array that holds the precomputed delay sincos
+         * Matrix array that holds the precomputed delay sincos, with the
+         * dimensions #clusters, #RBs
          */
         mutable ComplexMatrixArray m_cachedDelaySincos;
 
@@ -29,6 +29,8 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <utility>
 
 namespace ns3
@@ -69,6 +71,13 @@ RxSpectrumModelInfo::RxSpectrumModelInfo(Ptr<const SpectrumModel> rxSpectrumMode
 {
 }
 
+Ptr<const SpectrumValue>
+ConvertedPsds::Get(SpectrumModelUid_t rxSpectrumModelUid) const
+{
+    auto it = m_psds.find(rxSpectrumModelUid);
+    return it != m_psds.end() ? it->second : nullptr;
+}
+
 MultiModelSpectrumChannel::MultiModelSpectrumChannel()
     : m_numDevices{0}
 {
@@ -81,6 +90,7 @@ MultiModelSpectrumChannel::DoDispose()
     NS_LOG_FUNCTION(this);
     m_txSpectrumModelInfoMap.clear();
     m_rxSpectrumModelInfoMap.clear();
+    m_receiverIndexes.clear();
     SpectrumChannel::DoDispose();
 }
 
@@ -115,6 +125,7 @@ MultiModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
         if (phyIt != rxInfoIterator->second.m_rxPhys.end())
         {
             rxInfoIterator->second.m_rxPhys.erase(phyIt);
+            m_receiverIndexes.erase(rxInfoIterator->first);
             --m_numDevices;
             break; // there should be at most one entry
         }
@@ -238,7 +249,10 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
     NS_LOG_LOGIC("converter map first element: "
                  << txInfoIterator->second.m_spectrumConverterMap.begin()->first);
 
-    std::map<SpectrumModelUid_t, Ptr<SpectrumValue>> convertedPsds{};
+    const auto range = GetReceiverCullingRange(txMobility);
+    std::vector<uint32_t> receivers;
+
+    auto convertedPsds = Create<ConvertedPsds>();
     for (auto rxInfoIterator = m_rxSpectrumModelInfoMap.begin();
          rxInfoIterator != m_rxSpectrumModelInfoMap.end();
          ++rxInfoIterator)
@@ -246,7 +260,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
         const auto rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid();
         NS_LOG_LOGIC("rxSpectrumModelUids " << rxSpectrumModelUid);
 
-        Ptr<SpectrumValue> convertedTxPowerSpectrum;
+        Ptr<const SpectrumValue> convertedTxPowerSpectrum;
         if (txSpectrumModelUid == rxSpectrumModelUid)
         {
             NS_LOG_LOGIC("no spectrum conversion needed");
@@ -265,8 +279,9 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
             }
             convertedTxPowerSpectrum = rxConverterIterator->second.Convert(txParams->psd);
         }
-        convertedPsds.emplace(rxSpectrumModelUid, convertedTxPowerSpectrum);
+        convertedPsds->m_psds.emplace(rxSpectrumModelUid, convertedTxPowerSpectrum);
     }
+    auto txPsd = txParams->psd;
 
     for (auto rxInfoIterator = m_rxSpectrumModelInfoMap.begin();
          rxInfoIterator != m_rxSpectrumModelInfoMap.end();
@@ -274,17 +289,34 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
     {
         const auto rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid();
 
-        if ((txSpectrumModelUid != rxSpectrumModelUid) &&
-            !txInfoIterator->second.m_spectrumConverterMap.contains(rxSpectrumModelUid))
+        const auto convertedPsd = convertedPsds->Get(rxSpectrumModelUid);
+        if (!convertedPsd)
         {
             // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
             continue;
         }
 
-        for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin();
-             rxPhyIterator != rxInfoIterator->second.m_rxPhys.end();
-             ++rxPhyIterator)
+        // the receivers are visited in the order of the list, so that the
+        // receptions are scheduled in the same order whether culled or not
+        const auto& rxPhys = rxInfoIterator->second.m_rxPhys;
+        if (range < std::numeric_limits<double>::infinity())
+        {
+            auto& receiverIndex = m_receiverIndexes[rxSpectrumModelUid];
+            while (receiverIndex.GetN() < rxPhys.size())
+            {
+                receiverIndex.Add(rxPhys[receiverIndex.GetN()]->GetMobility());
+            }
+            receiverIndex.GetCandidates(txMobility->GetPosition(), range, receivers);
+        }
+        else
+        {
+            receivers.resize(rxPhys.size());
+            std::iota(receivers.begin(), receivers.end(), 0);
+        }
+
+        for (auto receiver : receivers)
         {
+            auto rxPhyIterator = rxPhys.begin() + receiver;
             NS_ASSERT_MSG((*rxPhyIterator)->GetRxSpectrumModel()->GetUid() == rxSpectrumModelUid,
                           "SpectrumModel change was not notified to MultiModelSpectrumChannel "
                           "(i.e., AddRx should be called again after model is changed)");
@@ -313,8 +345,11 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                 }
 
                 NS_LOG_LOGIC("copying signal parameters " << txParams);
+                // the copy of the signal parameters copies their PSD, so that
+                // the converted PSD is copied directly instead of the TX PSD
+                txParams->psd = ConstCast<SpectrumValue>(convertedPsd);
                 auto rxParams = txParams->Copy();
-                rxParams->psd = Copy<SpectrumValue>(convertedPsds.at(rxSpectrumModelUid));
+                txParams->psd = txPsd;
                 Time delay{0};
 
                 auto receiverMobility = (*rxPhyIterator)->GetMobility();
@@ -341,7 +376,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                                                    delay,
                                                    &MultiModelSpectrumChannel::StartRx,
                                                    this,
-                                                   txParams->psd,
+                                                   txPsd,
                                                    txAntennaGain,
                                                    rxParams,
                                                    *rxPhyIterator,
@@ -354,7 +389,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                     Simulator::Schedule(delay,
                                         &MultiModelSpectrumChannel::StartRx,
                                         this,
-                                        txParams->psd,
+                                        txPsd,
                                         txAntennaGain,
                                         rxParams,
                                         *rxPhyIterator,
@@ -366,12 +401,11 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
 }
 
 void
-MultiModelSpectrumChannel::StartRx(
-    Ptr<SpectrumValue> txPsd,
-    double txAntennaGain,
-    Ptr<SpectrumSignalParameters> params,
-    Ptr<SpectrumPhy> receiver,
-    const std::map<SpectrumModelUid_t, Ptr<SpectrumValue>>& availableConvertedPsds)
+MultiModelSpectrumChannel::StartRx(Ptr<SpectrumValue> txPsd,
+                                   double txAntennaGain,
+                                   Ptr<SpectrumSignalParameters> params,
+                                   Ptr<SpectrumPhy> receiver,
+                                   Ptr<const ConvertedPsds> availableConvertedPsds)
 {
     NS_LOG_FUNCTION(this);
 
@@ -384,11 +418,13 @@ MultiModelSpectrumChannel::StartRx(
     {
         NS_LOG_LOGIC("SpectrumModelUid changed since TX started");
 
-        const auto itConvertedPsd = availableConvertedPsds.find(phySpectrumModelUid);
-        if (itConvertedPsd != availableConvertedPsds.cend())
+        // the PSD is scaled by the path loss below, so that the converted
+        // PSDs shared by the receivers, and the TX PSD, must be copied
+        const auto convertedPsd = availableConvertedPsds->Get(phySpectrumModelUid);
+        if (convertedPsd)
         {
             NS_LOG_LOGIC("converted PSD already exists for " << phySpectrumModelUid);
-            params->psd = itConvertedPsd->second;
+            params->psd = Copy<SpectrumValue>(convertedPsd);
         }
         else
         {
@@ -404,7 +440,7 @@ MultiModelSpectrumChannel::StartRx(
             if (rxConverterIterator == txInfoIterator->second.m_spectrumConverterMap.cend())
             {
                 // No converter means TX SpectrumModel is orthogonal to current PHY SpectrumModel
-                params->psd = txPsd;
+                params->psd = Copy<SpectrumValue>(txPsd);
             }
             else
             {
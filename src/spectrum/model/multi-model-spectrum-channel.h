@@ -15,6 +15,7 @@
 #include "spectrum-value.h"
 
 #include <ns3/propagation-delay-model.h>
+#include <ns3/receiver-spatial-index.h>
 
 #include <map>
 #include <set>
@@ -76,6 +77,27 @@ class RxSpectrumModelInfo
  */
 typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap_t;
 
+/**
+ * @ingroup spectrum
+ * The PSD of a transmission converted to each RX SpectrumModel.  It is
+ * built once by MultiModelSpectrumChannel::StartTx and shared by all the
+ * receptions of the transmission, which copy the PSDs before modifying
+ * them.
+ */
+class ConvertedPsds : public SimpleRefCount<ConvertedPsds>
+{
+  public:
+    /**
+     * @param rxSpectrumModelUid the uid of the RX SpectrumModel
+     * @return the PSD converted to the RX SpectrumModel, or nullptr if the
+     * TX SpectrumModel is orthogonal to it
+     */
+    Ptr<const SpectrumValue> Get(SpectrumModelUid_t rxSpectrumModelUid) const;
+
+    /// The converted PSDs, by RX SpectrumModel uid
+    std::map<SpectrumModelUid_t, Ptr<const SpectrumValue>> m_psds;
+};
+
 /**
  * @ingroup spectrum
  *
@@ -133,14 +155,14 @@ class MultiModelSpectrumChannel : public SpectrumChannel
      * @param txAntennaGain The antenna gain at the transmitter.
      * @param params The signal parameters.
      * @param receiver A pointer to the receiver SpectrumPhy.
-     * @param availableConvertedPsds available converted PSDs from the TX PSD.
+     * @param availableConvertedPsds available converted PSDs from the TX PSD, shared by all the
+     * receivers.
      */
-    virtual void StartRx(
-        Ptr<SpectrumValue> txPsd,
-        double txAntennaGain,
-        Ptr<SpectrumSignalParameters> params,
-        Ptr<SpectrumPhy> receiver,
-        const std::map<SpectrumModelUid_t, Ptr<SpectrumValue>>& availableConvertedPsds);
+    virtual void StartRx(Ptr<SpectrumValue> txPsd,
+                         double txAntennaGain,
+                         Ptr<SpectrumSignalParameters> params,
+                         Ptr<SpectrumPhy> receiver,
+                         Ptr<const ConvertedPsds> availableConvertedPsds);
 
     /**
      * Data structure holding, for each TX SpectrumModel,  all the
@@ -156,6 +178,12 @@ class MultiModelSpectrumChannel : public SpectrumChannel
      */
     RxSpectrumModelInfoMap_t m_rxSpectrumModelInfoMap;
 
+    /**
+     * Index of the positions of the SpectrumPhy instances of each RX
+     * spectrum model, for the receiver culling.
+     */
+    std::map<SpectrumModelUid_t, ReceiverSpatialIndex> m_receiverIndexes;
+
     /**
      * Number of devices connected to the channel.
      */
@@ -27,6 +27,8 @@
 #include <ns3/simulator.h>
 
 #include <algorithm>
+#include <limits>
+#include <numeric>
 
 namespace ns3
 {
@@ -45,6 +47,7 @@ SingleModelSpectrumChannel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
     m_phyList.clear();
+    m_receiverIndex.Clear();
     m_spectrumModel = nullptr;
     SpectrumChannel::DoDispose();
 }
@@ -68,6 +71,7 @@ SingleModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
     if (it != std::end(m_phyList))
     {
         m_phyList.erase(it);
+        m_receiverIndex.Clear();
     }
 }
 
@@ -113,8 +117,26 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
 
     Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
 
-    for (auto rxPhyIterator = m_phyList.begin(); rxPhyIterator != m_phyList.end(); ++rxPhyIterator)
+    // the receivers are visited in the order of the list, so that the
+    // receptions are scheduled in the same order whether culled or not
+    std::vector<uint32_t> receivers(m_phyList.size());
+    double range = GetReceiverCullingRange(senderMobility);
+    if (range < std::numeric_limits<double>::infinity())
     {
+        while (m_receiverIndex.GetN() < m_phyList.size())
+        {
+            m_receiverIndex.Add(m_phyList[m_receiverIndex.GetN()]->GetMobility());
+        }
+        m_receiverIndex.GetCandidates(senderMobility->GetPosition(), range, receivers);
+    }
+    else
+    {
+        std::iota(receivers.begin(), receivers.end(), 0);
+    }
+
+    for (uint32_t receiver : receivers)
+    {
+        auto rxPhyIterator = m_phyList.begin() + receiver;
         Ptr<NetDevice> rxNetDevice = (*rxPhyIterator)->GetDevice();
         Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
 
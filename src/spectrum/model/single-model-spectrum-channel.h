@@ -12,6 +12,7 @@
 #include "spectrum-channel.h"
 #include "spectrum-model.h"
 
+#include <ns3/receiver-spatial-index.h>
 #include <ns3/traced-callback.h>
 
 namespace ns3
@@ -67,6 +68,12 @@ class SingleModelSpectrumChannel : public SpectrumChannel
      * SpectrumModel that this channel instance is supporting.
      */
     Ptr<const SpectrumModel> m_spectrumModel;
+
+    /**
+     * Index of the positions of the SpectrumPhy instances, for the
+     * receiver culling.
+     */
+    ReceiverSpatialIndex m_receiverIndex;
 };
 
 } // namespace ns3
@@ -9,10 +9,13 @@
 #include "spectrum-channel.h"
 
 #include <ns3/abort.h>
+#include <ns3/boolean.h>
 #include <ns3/double.h>
 #include <ns3/log.h>
 #include <ns3/pointer.h>
 
+#include <limits>
+
 namespace ns3
 {
 
@@ -59,6 +62,22 @@ SpectrumChannel::GetTypeId()
                           DoubleValue(1.0e9),
                           MakeDoubleAccessor(&SpectrumChannel::m_maxLossDb),
                           MakeDoubleChecker<double>())
+            .AddAttribute("ReceiverCulling",
+                          "If true, the receivers too far for the loss of the "
+                          "PropagationLossModel, less ReceiverCullingMaxGain, to be below "
+                          "MaxLossDb are skipped, instead of being scheduled a reception "
+                          "that would be dropped. The Gain and PathLoss traces are not "
+                          "fired for them. This requires a "
+                          "ConstantSpeedPropagationDelayModel, if any.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SpectrumChannel::m_receiverCulling),
+                          MakeBooleanChecker())
+            .AddAttribute("ReceiverCullingMaxGain",
+                          "The maximum sum of the TX and RX antenna gains, in dB, assumed "
+                          "by the receiver culling.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&SpectrumChannel::m_receiverCullingMaxGainDb),
+                          MakeDoubleChecker<double>())
 
             .AddAttribute("PropagationLossModel",
                           "A pointer to the propagation loss model attached to this channel.",
@@ -102,6 +121,20 @@ SpectrumChannel::GetTypeId()
     return tid;
 }
 
+double
+SpectrumChannel::GetReceiverCullingRange(Ptr<const MobilityModel> txMobility) const
+{
+    if (!m_receiverCulling || !txMobility || !m_propagationLoss)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (m_propagationDelay && !DynamicCast<ConstantSpeedPropagationDelayModel>(m_propagationDelay))
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return m_propagationLoss->GetRange(0, -m_maxLossDb - m_receiverCullingMaxGainDb);
+}
+
 void
 SpectrumChannel::AddPropagationLossModel(Ptr<PropagationLossModel> loss)
 {
@@ -34,6 +34,12 @@ class SpectrumValue;
  *
  * Defines the interface for spectrum-aware channel implementations
  *
+ * If the ReceiverCulling attribute is true, the implementations may skip
+ * the receivers too far for the single-frequency loss to be below
+ * MaxLossDb, according to PropagationLossModel::GetRange and assuming
+ * antenna gains of at most ReceiverCullingMaxGain.  These receivers would
+ * not receive the signal anyway, but the `Gain` and `PathLoss` traces are
+ * not fired for them.
  */
 class SpectrumChannel : public Channel
 {
@@ -227,6 +233,15 @@ class SpectrumChannel : public Channel
      */
     virtual int64_t DoAssignStreams(int64_t stream);
 
+    /**
+     * @param txMobility The mobility model of the transmitter, or nullptr.
+     * @returns The distance beyond which the receivers are out of range
+     * for sure, or infinity if they must not be skipped: no culling, no
+     * mobility model or no propagation loss model, or a propagation delay
+     * model other than ConstantSpeedPropagationDelayModel.
+     */
+    double GetReceiverCullingRange(Ptr<const MobilityModel> txMobility) const;
+
     /**
      * The `PathLoss` trace source. Exporting the pointers to the Tx and Rx
      * SpectrumPhy and a pathloss value, in dB.
@@ -258,6 +273,11 @@ class SpectrumChannel : public Channel
      */
     double m_maxLossDb;
 
+    bool m_receiverCulling; //!< Whether the receivers out of range are skipped
+
+    /// The maximum sum of the TX and RX antenna gains [dB], assumed by the culling
+    double m_receiverCullingMaxGainDb;
+
     /**
      * Single-frequency propagation loss model to be used with this channel.
      */
@@ -65,23 +65,28 @@ SpectrumConverter::GetCoefficient(const BandInfo& from, const BandInfo& to) cons
 Ptr<SpectrumValue>
 SpectrumConverter::Convert(Ptr<const SpectrumValue> fvvf) const
 {
-    NS_ASSERT(*(fvvf->GetSpectrumModel()) == *m_fromSpectrumModel);
+    NS_ASSERT(fvvf->GetSpectrumModelUid() == m_fromSpectrumModel->GetUid() ||
+              *(fvvf->GetSpectrumModel()) == *m_fromSpectrumModel);
 
     Ptr<SpectrumValue> tvvf = Create<SpectrumValue>(m_toSpectrumModel);
 
-    auto tvit = tvvf->ValuesBegin();
+    // sparse matrix-vector product over the rows of the conversion matrix,
+    // the sums of each row being in the order of its columns
+    const double* from = fvvf->GetValues().data();
+    const double* coefficients = m_conversionMatrix.data();
+    const size_t* columns = m_conversionColInd.data();
+    double* to = tvvf->GetValues().data();
+    const size_t nRows = m_conversionRowPtr.size();
     size_t i = 0; // Index of conversion coefficient
-
-    for (auto convIt = m_conversionRowPtr.begin(); convIt != m_conversionRowPtr.end(); ++convIt)
+    for (size_t row = 0; row < nRows; row++)
     {
+        const size_t rowEnd = m_conversionRowPtr[row];
         double sum = 0;
-        while (i < *convIt)
+        for (; i < rowEnd; i++)
         {
-            sum += (*fvvf)[m_conversionColInd.at(i)] * m_conversionMatrix.at(i);
-            i++;
+            sum += from[columns[i]] * coefficients[i];
         }
-        *tvit = sum;
-        ++tvit;
+        to[row] = sum;
     }
 
     return tvvf;
@@ -12,19 +12,166 @@
 #include <ns3/log.h>
 #include <ns3/math.h>
 
+#include <algorithm>
+#include <utility>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("SpectrumValue");
 
+namespace
+{
+
+/** Maximum number of free value vectors cached by each thread, per number of bands. */
+constexpr std::size_t VALUES_POOL_MAX_FREE = 64;
+/** Maximum number of distinct numbers of bands cached by each thread. */
+constexpr std::size_t VALUES_POOL_MAX_SIZES = 16;
+
+/**
+ * Whether the value vector pool of the calling thread is destroyed.  This
+ * is trivially destructible, so it remains valid until the thread really
+ * exits, e.g., for the SpectrumValue instances of static storage duration.
+ */
+thread_local bool g_valuesPoolExited = false;
+
+/** The per-thread free value vectors, by number of bands. */
+struct ValuesPool
+{
+    /** Destructor: stop caching the value vectors released afterwards. */
+    ~ValuesPool()
+    {
+        g_valuesPoolExited = true;
+    }
+
+    /// The free value vectors, with their number of bands
+    std::vector<std::pair<std::size_t, std::vector<Values>>> lists;
+};
+
+/** The free value vectors of the calling thread. */
+thread_local ValuesPool g_valuesPool;
+
+/**
+ * Get the free value vectors of a number of bands.
+ *
+ * @param [in] n The number of bands.
+ * @param [in] create Whether to create the list if there is none yet.
+ * @returns The free value vectors, or nullptr.
+ */
+std::vector<Values>*
+GetFreeValues(std::size_t n, bool create)
+{
+    for (auto& [size, values] : g_valuesPool.lists)
+    {
+        if (size == n)
+        {
+            return &values;
+        }
+    }
+    if (!create || g_valuesPool.lists.size() >= VALUES_POOL_MAX_SIZES)
+    {
+        return nullptr;
+    }
+    return &g_valuesPool.lists.emplace_back(n, std::vector<Values>()).second;
+}
+
+/**
+ * Allocate a value vector, from the pool if possible.
+ *
+ * @param [in] n The number of bands.
+ * @returns A vector of n values, of unspecified contents.
+ */
+Values
+AcquireValues(std::size_t n)
+{
+    if (n > 0 && !g_valuesPoolExited)
+    {
+        std::vector<Values>* freeValues = GetFreeValues(n, false);
+        if (freeValues && !freeValues->empty())
+        {
+            Values values = std::move(freeValues->back());
+            freeValues->pop_back();
+            return values;
+        }
+    }
+    return Values(n);
+}
+
+/**
+ * Return a value vector to the pool, if it is not full.
+ *
+ * @param [in,out] values The value vector, left empty if pooled.
+ */
+void
+ReleaseValues(Values& values)
+{
+    if (values.empty() || g_valuesPoolExited)
+    {
+        return;
+    }
+    std::vector<Values>* freeValues = GetFreeValues(values.size(), true);
+    if (freeValues && freeValues->size() < VALUES_POOL_MAX_FREE)
+    {
+        freeValues->push_back(std::move(values));
+    }
+}
+
+} // namespace
+
 SpectrumValue::SpectrumValue()
 {
 }
 
 SpectrumValue::SpectrumValue(Ptr<const SpectrumModel> sof)
     : m_spectrumModel(sof),
-      m_values(sof->GetNumBands())
+      m_values(AcquireValues(sof->GetNumBands()))
 {
+    std::fill(m_values.begin(), m_values.end(), 0.0);
+}
+
+SpectrumValue::SpectrumValue(const SpectrumValue& other)
+    : m_spectrumModel(other.m_spectrumModel),
+      m_values(AcquireValues(other.m_values.size()))
+{
+    std::copy(other.m_values.begin(), other.m_values.end(), m_values.begin());
+}
+
+SpectrumValue::SpectrumValue(SpectrumValue&& other) noexcept
+    : m_spectrumModel(other.m_spectrumModel),
+      m_values(std::move(other.m_values))
+{
+    other.m_values.clear();
+}
+
+SpectrumValue::~SpectrumValue()
+{
+    ReleaseValues(m_values);
+}
+
+SpectrumValue&
+SpectrumValue::operator=(const SpectrumValue& other)
+{
+    if (m_values.size() != other.m_values.size())
+    {
+        ReleaseValues(m_values);
+        m_values = AcquireValues(other.m_values.size());
+    }
+    m_spectrumModel = other.m_spectrumModel;
+    std::copy(other.m_values.begin(), other.m_values.end(), m_values.begin());
+    return *this;
+}
+
+SpectrumValue&
+SpectrumValue::operator=(SpectrumValue&& other) noexcept
+{
+    if (this != &other)
+    {
+        ReleaseValues(m_values);
+        m_spectrumModel = other.m_spectrumModel;
+        m_values = std::move(other.m_values);
+        other.m_values.clear();
+    }
+    return *this;
 }
 
 double&
@@ -90,46 +237,41 @@ SpectrumValue::ConstBandsEnd() const
 void
 SpectrumValue::Add(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 += *it2;
-        ++it1;
-        ++it2;
+        values[i] += xValues[i];
     }
 }
 
 void
 SpectrumValue::Add(double s)
 {
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 += s;
-        ++it1;
+        values[i] += s;
     }
 }
 
 void
 SpectrumValue::Subtract(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 -= *it2;
-        ++it1;
-        ++it2;
+        values[i] -= xValues[i];
     }
 }
 
@@ -142,46 +284,41 @@ SpectrumValue::Subtract(double s)
 void
 SpectrumValue::Multiply(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 *= *it2;
-        ++it1;
-        ++it2;
+        values[i] *= xValues[i];
     }
 }
 
 void
 SpectrumValue::Multiply(double s)
 {
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 *= s;
-        ++it1;
+        values[i] *= s;
     }
 }
 
 void
 SpectrumValue::Divide(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const double* xValues = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 /= *it2;
-        ++it1;
-        ++it2;
+        values[i] /= xValues[i];
     }
 }
 
@@ -189,24 +326,22 @@ void
 SpectrumValue::Divide(double s)
 {
     NS_LOG_FUNCTION(this << s);
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 /= s;
-        ++it1;
+        values[i] /= s;
     }
 }
 
 void
 SpectrumValue::ChangeSign()
 {
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* values = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; i++)
     {
-        *it1 = -(*it1);
-        ++it1;
+        values[i] = -values[i];
     }
 }
 
@@ -366,11 +501,7 @@ Integral(const SpectrumValue& arg)
 Ptr<SpectrumValue>
 SpectrumValue::Copy() const
 {
-    Ptr<SpectrumValue> p = Create<SpectrumValue>(m_spectrumModel);
-    *p = *this;
-    return p;
-
-    //  return Copy<SpectrumValue> (*this)
+    return Create<SpectrumValue>(*this);
 }
 
 /**
@@ -436,6 +567,41 @@ operator+(double lhs, const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator+(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Add(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator+(const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+    rhs.Add(lhs);
+    return std::move(rhs);
+}
+
+SpectrumValue
+operator+(SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+    lhs.Add(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator+(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Add(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator+(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Add(lhs);
+    return std::move(rhs);
+}
+
 SpectrumValue
 operator-(const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
@@ -461,6 +627,42 @@ operator-(double lhs, const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator-(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Subtract(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator-(const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+    rhs.ChangeSign();
+    rhs.Add(lhs);
+    return std::move(rhs);
+}
+
+SpectrumValue
+operator-(SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+    lhs.Subtract(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator-(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Subtract(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator-(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Subtract(lhs);
+    return std::move(rhs);
+}
+
 SpectrumValue
 operator*(const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
@@ -485,6 +687,41 @@ operator*(double lhs, const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator*(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Multiply(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator*(const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+    rhs.Multiply(lhs);
+    return std::move(rhs);
+}
+
+SpectrumValue
+operator*(SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+    lhs.Multiply(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator*(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Multiply(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator*(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Multiply(lhs);
+    return std::move(rhs);
+}
+
 SpectrumValue
 operator/(const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
@@ -509,6 +746,27 @@ operator/(double lhs, const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator/(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Divide(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator/(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Divide(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator/(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Divide(lhs);
+    return std::move(rhs);
+}
+
 SpectrumValue
 operator+(const SpectrumValue& rhs)
 {
@@ -523,6 +781,13 @@ operator-(const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator-(SpectrumValue&& rhs)
+{
+    rhs.ChangeSign();
+    return std::move(rhs);
+}
+
 SpectrumValue
 Pow(double lhs, const SpectrumValue& rhs)
 {
@@ -622,13 +887,7 @@ SpectrumValue::operator/=(double rhs)
 SpectrumValue&
 SpectrumValue::operator=(double rhs)
 {
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
-    {
-        *it1 = rhs;
-        ++it1;
-    }
+    std::fill(m_values.begin(), m_values.end(), rhs);
     return *this;
 }
 
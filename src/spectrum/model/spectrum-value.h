@@ -45,6 +45,14 @@ typedef std::vector<double> Values;
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
+ *
+ * The operators taking a temporary SpectrumValue compute their result in
+ * its storage, so that e.g. (a + b) * c allocates a single SpectrumValue,
+ * and the storage of the destroyed instances is kept in a per-thread pool
+ * for the next ones with the same number of bands.  The component-wise
+ * operations are plain loops over the contiguous values, which the
+ * compiler vectorizes for the target instruction set (see the
+ * NS3_NATIVE_OPTIMIZATIONS build option).
  */
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
@@ -70,6 +78,43 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
 
     SpectrumValue();
 
+    /**
+     * Copy constructor
+     *
+     * @param other the SpectrumValue to copy
+     */
+    SpectrumValue(const SpectrumValue& other);
+
+    /**
+     * Move constructor
+     *
+     * @param other the SpectrumValue to move, left without values
+     */
+    SpectrumValue(SpectrumValue&& other) noexcept;
+
+    /**
+     * Destructor, returning the storage of the values to a per-thread pool
+     * from which the SpectrumValue instances with the same number of bands
+     * are allocated.
+     */
+    ~SpectrumValue();
+
+    /**
+     * Copy assignment operator
+     *
+     * @param other the SpectrumValue to copy
+     * @return a reference to *this
+     */
+    SpectrumValue& operator=(const SpectrumValue& other);
+
+    /**
+     * Move assignment operator
+     *
+     * @param other the SpectrumValue to move, left without values
+     * @return a reference to *this
+     */
+    SpectrumValue& operator=(SpectrumValue&& other) noexcept;
+
     /**
      * Access value at given frequency index
      *
@@ -229,6 +274,56 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator+(double lhs, const SpectrumValue& rhs);
 
+    /**
+     * addition operator, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     * addition operator, reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+    /**
+     * addition operator, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+    /**
+     * addition operator, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, double rhs);
+
+    /**
+     * addition operator, reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(double lhs, SpectrumValue&& rhs);
+
     /**
      *  subtraction operator
      *
@@ -259,6 +354,56 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator-(double lhs, const SpectrumValue& rhs);
 
+    /**
+     * subtraction operator, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     * subtraction operator, reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+    /**
+     * subtraction operator, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+    /**
+     * subtraction operator, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, double rhs);
+
+    /**
+     * subtraction operator, reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(double lhs, SpectrumValue&& rhs);
+
     /**
      *  multiplication component-by-component (Schur product)
      *
@@ -289,6 +434,56 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator*(double lhs, const SpectrumValue& rhs);
 
+    /**
+     * multiplication component-by-component (Schur product), reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     * multiplication component-by-component (Schur product), reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+    /**
+     * multiplication component-by-component (Schur product), reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+    /**
+     * multiplication by a scalar, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, double rhs);
+
+    /**
+     * multiplication of a scalar, reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(double lhs, SpectrumValue&& rhs);
+
     /**
      *  division component-by-component
      *
@@ -319,6 +514,36 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator/(double lhs, const SpectrumValue& rhs);
 
+    /**
+     * division component-by-component, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     * division by a scalar, reusing the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(SpectrumValue&& lhs, double rhs);
+
+    /**
+     * division of a scalar, reusing the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(double lhs, SpectrumValue&& rhs);
+
     /**
      * Compare two spectrum values
      *
@@ -355,6 +580,14 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator-(const SpectrumValue& rhs);
 
+    /**
+     * unary minus operator, reusing the storage of rhs
+     *
+     * @param rhs Right Hand Side of the operator
+     * @return the value of - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& rhs);
+
     /**
      * left shift operator
      *
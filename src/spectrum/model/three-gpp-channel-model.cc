@@ -19,12 +19,16 @@
 #include "ns3/phased-array-model.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
 #include <ns3/simulator.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <map>
 #include <random>
+#include <thread>
+#include <unordered_set>
 
 namespace ns3
 {
@@ -1065,6 +1069,7 @@ static const std::map<std::string, std::map<int, std::array<float, 22>>> NTNRura
 };
 
 ThreeGppChannelModel::ThreeGppChannelModel()
+    : m_lastBatchTime(Time::Min())
 {
     NS_LOG_FUNCTION(this);
     m_uniformRv = CreateObject<UniformRandomVariable>();
@@ -1091,6 +1096,9 @@ ThreeGppChannelModel::DoDispose()
     }
     m_channelMatrixMap.clear();
     m_channelParamsMap.clear();
+    m_batchPairs.clear();
+    m_batchLookupTimes.clear();
+    m_batchPairIndexes.clear();
     m_channelConditionModel = nullptr;
 }
 
@@ -1156,6 +1164,23 @@ ThreeGppChannelModel::GetTypeId()
                           DoubleValue(0.0),
                           MakeDoubleAccessor(&ThreeGppChannelModel::m_vScatt),
                           MakeDoubleChecker<double>(0.0))
+            .AddAttribute("BatchUpdate",
+                          "If true, the channels of the pairs of devices looked up since the "
+                          "last batch update are regenerated together, with GenerateChannels, "
+                          "at the first lookup of a channel to be updated at a given time. "
+                          "The channel parameters are then drawn in the order of the first "
+                          "lookup of the pairs, which changes the channel realizations with "
+                          "respect to the lookups without BatchUpdate, but not their "
+                          "dependence on BatchThreads",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&ThreeGppChannelModel::m_batchUpdate),
+                          MakeBooleanChecker())
+            .AddAttribute("BatchThreads",
+                          "The number of threads computing the channel matrices in "
+                          "GenerateChannels, 0 for the number of hardware threads",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&ThreeGppChannelModel::m_batchThreads),
+                          MakeUintegerChecker<uint32_t>())
 
         ;
     return tid;
@@ -2464,31 +2489,25 @@ ThreeGppChannelModel::AntennaSetupChanged(Ptr<const PhasedArrayModel> aAntenna,
            ((uAntNumElems != chanNumCols) || (sAntNumElems != chanNumRows));
 }
 
-Ptr<const MatrixBasedChannelModel::ChannelMatrix>
-ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
-                                 Ptr<const MobilityModel> bMob,
-                                 Ptr<const PhasedArrayModel> aAntenna,
-                                 Ptr<const PhasedArrayModel> bAntenna)
+Ptr<ThreeGppChannelModel::ThreeGppChannelParams>
+ThreeGppChannelModel::UpdateChannelParams(Ptr<const MobilityModel> aMob,
+                                          Ptr<const MobilityModel> bMob,
+                                          Ptr<const ParamsTable>& table3gpp)
 {
     NS_LOG_FUNCTION(this);
 
     // Compute the channel params key. The key is reciprocal, i.e., key (a, b) = key (b, a)
     uint64_t channelParamsKey =
         GetKey(aMob->GetObject<Node>()->GetId(), bMob->GetObject<Node>()->GetId());
-    // Compute the channel matrix key. The key is reciprocal, i.e., key (a, b) = key (b, a)
-    uint64_t channelMatrixKey = GetKey(aAntenna->GetId(), bAntenna->GetId());
 
     // retrieve the channel condition
     Ptr<const ChannelCondition> condition =
         m_channelConditionModel->GetChannelCondition(aMob, bMob);
 
-    // Check if the channel is present in the map and return it, otherwise
-    // generate a new channel
+    // Check if the channel params are present in the map and return them,
+    // otherwise generate new ones
     bool updateParams = false;
-    bool updateMatrix = false;
     bool notFoundParams = false;
-    bool notFoundMatrix = false;
-    Ptr<ChannelMatrix> channelMatrix;
     Ptr<ThreeGppChannelParams> channelParams;
 
     if (m_channelParamsMap.find(channelParamsKey) != m_channelParamsMap.end())
@@ -2504,7 +2523,7 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     }
 
     // get the 3GPP parameters
-    Ptr<const ParamsTable> table3gpp = GetThreeGppTable(aMob, bMob, condition);
+    table3gpp = GetThreeGppTable(aMob, bMob, condition);
 
     if (notFoundParams || updateParams)
     {
@@ -2521,6 +2540,75 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
         m_channelParamsMap[channelParamsKey] = channelParams;
     }
 
+    return channelParams;
+}
+
+bool
+ThreeGppChannelModel::ChannelNeedsUpdate(Ptr<const MobilityModel> aMob,
+                                         Ptr<const MobilityModel> bMob,
+                                         Ptr<const PhasedArrayModel> aAntenna,
+                                         Ptr<const PhasedArrayModel> bAntenna)
+{
+    NS_LOG_FUNCTION(this);
+
+    auto paramsIt = m_channelParamsMap.find(
+        GetKey(aMob->GetObject<Node>()->GetId(), bMob->GetObject<Node>()->GetId()));
+    auto matrixIt = m_channelMatrixMap.find(GetKey(aAntenna->GetId(), bAntenna->GetId()));
+    if (paramsIt == m_channelParamsMap.end() || matrixIt == m_channelMatrixMap.end())
+    {
+        return true;
+    }
+    Ptr<const ChannelCondition> condition =
+        m_channelConditionModel->GetChannelCondition(aMob, bMob);
+    return ChannelParamsNeedsUpdate(paramsIt->second, condition) ||
+           ChannelMatrixNeedsUpdate(paramsIt->second, matrixIt->second) ||
+           AntennaSetupChanged(aAntenna, bAntenna, matrixIt->second);
+}
+
+Ptr<const MatrixBasedChannelModel::ChannelMatrix>
+ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
+                                 Ptr<const MobilityModel> bMob,
+                                 Ptr<const PhasedArrayModel> aAntenna,
+                                 Ptr<const PhasedArrayModel> bAntenna)
+{
+    NS_LOG_FUNCTION(this);
+
+    // Compute the channel matrix key. The key is reciprocal, i.e., key (a, b) = key (b, a)
+    uint64_t channelMatrixKey = GetKey(aAntenna->GetId(), bAntenna->GetId());
+
+    if (m_batchUpdate)
+    {
+        // remember the pair, and regenerate the channels of all the pairs
+        // at the first lookup of a channel to be updated at this time
+        auto [it, inserted] =
+            m_batchPairIndexes.try_emplace(channelMatrixKey, m_batchPairs.size());
+        if (inserted)
+        {
+            m_batchPairs.push_back({aMob, bMob, aAntenna, bAntenna});
+            m_batchLookupTimes.push_back(Simulator::Now());
+        }
+        else
+        {
+            m_batchLookupTimes[it->second] = Simulator::Now();
+            if (m_lastBatchTime != Simulator::Now() &&
+                ChannelNeedsUpdate(aMob, bMob, aAntenna, bAntenna))
+            {
+                PruneBatchPairs();
+                m_lastBatchTime = Simulator::Now();
+                GenerateChannels(m_batchPairs);
+            }
+        }
+    }
+
+    Ptr<const ParamsTable> table3gpp;
+    Ptr<ThreeGppChannelParams> channelParams = UpdateChannelParams(aMob, bMob, table3gpp);
+
+    // Check if the channel is present in the map and return it, otherwise
+    // generate a new channel
+    bool updateMatrix = false;
+    bool notFoundMatrix = false;
+    Ptr<ChannelMatrix> channelMatrix;
+
     if (m_channelMatrixMap.find(channelMatrixKey) != m_channelMatrixMap.end())
     {
         // channel matrix present in the map
@@ -2553,6 +2641,140 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     return channelMatrix;
 }
 
+void
+ThreeGppChannelModel::PruneBatchPairs()
+{
+    NS_LOG_FUNCTION(this);
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < m_batchPairs.size(); i++)
+    {
+        if (m_batchLookupTimes[i] >= m_lastBatchTime)
+        {
+            m_batchPairs[kept] = std::move(m_batchPairs[i]);
+            m_batchLookupTimes[kept] = m_batchLookupTimes[i];
+            kept++;
+        }
+    }
+    if (kept == m_batchPairs.size())
+    {
+        return;
+    }
+    NS_LOG_LOGIC("forgetting " << m_batchPairs.size() - kept << " pairs");
+    m_batchPairs.resize(kept);
+    m_batchLookupTimes.resize(kept);
+    m_batchPairIndexes.clear();
+    for (std::size_t i = 0; i < kept; i++)
+    {
+        const auto& pair = m_batchPairs[i];
+        m_batchPairIndexes[GetKey(pair.aAntenna->GetId(), pair.bAntenna->GetId())] = i;
+    }
+}
+
+void
+ThreeGppChannelModel::GenerateChannels(const std::vector<ChannelPair>& pairs)
+{
+    NS_LOG_FUNCTION(this << pairs.size());
+
+    NS_ASSERT_MSG(m_frequency > 0.0, "Set the operating frequency first!");
+
+    /// A channel matrix to be computed
+    struct Job
+    {
+        uint64_t key;                            //!< The channel matrix key
+        Ptr<ChannelMatrix> channelMatrix;        //!< The channel matrix
+        Ptr<const ThreeGppChannelParams> params; //!< The channel params
+        Ptr<const ParamsTable> table3gpp;        //!< The 3GPP parameters table
+        Vector sPosition;                        //!< The position of node s
+        Vector uPosition;                        //!< The position of node u
+        const PhasedArrayModel* sAntenna;        //!< The antenna array of node s
+        const PhasedArrayModel* uAntenna;        //!< The antenna array of node u
+    };
+
+    // Update the channel params and find the channel matrices to be updated,
+    // in the order of the pairs as GetChannel would, since the params are
+    // generated with the random variables of the model
+    std::vector<Job> jobs;
+    std::unordered_set<uint64_t> pending;
+    for (const auto& pair : pairs)
+    {
+        Ptr<const ParamsTable> table3gpp;
+        Ptr<ThreeGppChannelParams> channelParams =
+            UpdateChannelParams(pair.aMob, pair.bMob, table3gpp);
+
+        uint64_t channelMatrixKey = GetKey(pair.aAntenna->GetId(), pair.bAntenna->GetId());
+        auto it = m_channelMatrixMap.find(channelMatrixKey);
+        if (pending.contains(channelMatrixKey) ||
+            (it != m_channelMatrixMap.end() &&
+             !ChannelMatrixNeedsUpdate(channelParams, it->second) &&
+             !AntennaSetupChanged(pair.aAntenna, pair.bAntenna, it->second)))
+        {
+            continue;
+        }
+        pending.insert(channelMatrixKey);
+
+        Ptr<ChannelMatrix> channelMatrix = Create<ChannelMatrix>();
+        channelMatrix->m_generatedTime = Simulator::Now();
+        channelMatrix->m_nodeIds = std::make_pair(pair.aMob->GetObject<Node>()->GetId(),
+                                                  pair.bMob->GetObject<Node>()->GetId());
+        // save antenna pair, with the exact order of s and u antennas at the
+        // moment of the channel generation
+        channelMatrix->m_antennaPair =
+            std::make_pair(pair.aAntenna->GetId(), pair.bAntenna->GetId());
+        jobs.push_back({channelMatrixKey,
+                        channelMatrix,
+                        channelParams,
+                        table3gpp,
+                        pair.aMob->GetPosition(),
+                        pair.bMob->GetPosition(),
+                        PeekPointer(pair.aAntenna),
+                        PeekPointer(pair.bAntenna)});
+    }
+
+    // Compute the channel matrices in parallel.  The workers only read the
+    // params, the tables and the antenna arrays, and each of them writes its
+    // own channel matrices, so that the results do not depend on the number
+    // of threads
+    uint32_t nThreads = m_batchThreads;
+    if (nThreads == 0)
+    {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    nThreads = std::max<uint32_t>(1, std::min<std::size_t>(nThreads, jobs.size()));
+    std::atomic<std::size_t> next(0);
+    auto work = [this, &jobs, &next]() {
+        for (std::size_t i = next++; i < jobs.size(); i = next++)
+        {
+            Job& job = jobs[i];
+            ComputeChannelMatrix(*job.params,
+                                 *job.table3gpp,
+                                 job.sPosition,
+                                 job.uPosition,
+                                 *job.sAntenna,
+                                 *job.uAntenna,
+                                 *job.channelMatrix);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < nThreads; t++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // store or replace the channel matrices in the channel map
+    for (auto& job : jobs)
+    {
+        m_channelMatrixMap[job.key] = job.channelMatrix;
+    }
+    NS_LOG_LOGIC(jobs.size() << " channel matrices generated with " << nThreads
+                             << " threads for " << pairs.size() << " pairs");
+}
+
 Ptr<const MatrixBasedChannelModel::ChannelParams>
 ThreeGppChannelModel::GetParams(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob) const
 {
@@ -3241,8 +3463,44 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     // save in which order is generated this matrix
     channelMatrix->m_nodeIds =
         std::make_pair(sMob->GetObject<Node>()->GetId(), uMob->GetObject<Node>()->GetId());
+    ComputeChannelMatrix(*channelParams,
+                         *table3gpp,
+                         sMob->GetPosition(),
+                         uMob->GetPosition(),
+                         *sAntenna,
+                         *uAntenna,
+                         *channelMatrix);
+    const Complex3DVector& hUsn = channelMatrix->m_channel;
+
+    NS_LOG_DEBUG("Husn (sAntenna, uAntenna):" << sAntenna->GetId() << ", " << uAntenna->GetId());
+    for (size_t cIndex = 0; cIndex < hUsn.GetNumPages(); cIndex++)
+    {
+        for (size_t rowIdx = 0; rowIdx < hUsn.GetNumRows(); rowIdx++)
+        {
+            for (size_t colIdx = 0; colIdx < hUsn.GetNumCols(); colIdx++)
+            {
+                NS_LOG_DEBUG(" " << hUsn(rowIdx, colIdx, cIndex) << ",");
+            }
+        }
+    }
+
+    NS_LOG_INFO("size of coefficient matrix (rows, columns, clusters) = ("
+                << hUsn.GetNumRows() << ", " << hUsn.GetNumCols() << ", " << hUsn.GetNumPages()
+                << ")");
+    return channelMatrix;
+}
+
+void
+ThreeGppChannelModel::ComputeChannelMatrix(const ThreeGppChannelParams& channelParams,
+                                           const ParamsTable& table3gpp,
+                                           const Vector& sPosition,
+                                           const Vector& uPosition,
+                                           const PhasedArrayModel& sAntenna,
+                                           const PhasedArrayModel& uAntenna,
+                                           ChannelMatrix& channelMatrix) const
+{
     // check if channelParams structure is generated in direction s-to-u or u-to-s
-    bool isSameDirection = (channelParams->m_nodeIds == channelMatrix->m_nodeIds);
+    bool isSameDirection = (channelParams.m_nodeIds == channelMatrix.m_nodeIds);
 
     MatrixBasedChannelModel::Double2DVector rayAodRadian;
     MatrixBasedChannelModel::Double2DVector rayAoaRadian;
@@ -3255,61 +3513,61 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     // of channel matrix, otherwise we need to flip angles and zeniths of departure and arrival
     if (isSameDirection)
     {
-        rayAodRadian = channelParams->m_rayAodRadian;
-        rayAoaRadian = channelParams->m_rayAoaRadian;
-        rayZodRadian = channelParams->m_rayZodRadian;
-        rayZoaRadian = channelParams->m_rayZoaRadian;
+        rayAodRadian = channelParams.m_rayAodRadian;
+        rayAoaRadian = channelParams.m_rayAoaRadian;
+        rayZodRadian = channelParams.m_rayZodRadian;
+        rayZoaRadian = channelParams.m_rayZoaRadian;
     }
     else
     {
-        rayAodRadian = channelParams->m_rayAoaRadian;
-        rayAoaRadian = channelParams->m_rayAodRadian;
-        rayZodRadian = channelParams->m_rayZoaRadian;
-        rayZoaRadian = channelParams->m_rayZodRadian;
+        rayAodRadian = channelParams.m_rayAoaRadian;
+        rayAoaRadian = channelParams.m_rayAodRadian;
+        rayZodRadian = channelParams.m_rayZoaRadian;
+        rayZoaRadian = channelParams.m_rayZodRadian;
     }
 
     // Step 11: Generate channel coefficients for each cluster n and each receiver
     //  and transmitter element pair u,s.
     // where n is cluster index, u and s are receive and transmit antenna element.
-    size_t uSize = uAntenna->GetNumElems();
-    size_t sSize = sAntenna->GetNumElems();
+    size_t uSize = uAntenna.GetNumElems();
+    size_t sSize = sAntenna.GetNumElems();
 
     // NOTE: Since each of the strongest 2 clusters are divided into 3 sub-clusters,
     // the total cluster will generally be numReducedCLuster + 4.
     // However, it might be that m_cluster1st = m_cluster2nd. In this case the
     // total number of clusters will be numReducedCLuster + 2.
-    uint16_t numOverallCluster = (channelParams->m_cluster1st != channelParams->m_cluster2nd)
-                                     ? channelParams->m_reducedClusterNumber + 4
-                                     : channelParams->m_reducedClusterNumber + 2;
+    uint16_t numOverallCluster = (channelParams.m_cluster1st != channelParams.m_cluster2nd)
+                                     ? channelParams.m_reducedClusterNumber + 4
+                                     : channelParams.m_reducedClusterNumber + 2;
     Complex3DVector hUsn(uSize, sSize, numOverallCluster); // channel coefficient hUsn (u, s, n);
-    NS_ASSERT(channelParams->m_reducedClusterNumber <= channelParams->m_clusterPhase.size());
-    NS_ASSERT(channelParams->m_reducedClusterNumber <= channelParams->m_clusterPower.size());
-    NS_ASSERT(channelParams->m_reducedClusterNumber <=
-              channelParams->m_crossPolarizationPowerRatios.size());
-    NS_ASSERT(channelParams->m_reducedClusterNumber <= rayZoaRadian.size());
-    NS_ASSERT(channelParams->m_reducedClusterNumber <= rayZodRadian.size());
-    NS_ASSERT(channelParams->m_reducedClusterNumber <= rayAoaRadian.size());
-    NS_ASSERT(channelParams->m_reducedClusterNumber <= rayAodRadian.size());
-    NS_ASSERT(table3gpp->m_raysPerCluster <= channelParams->m_clusterPhase[0].size());
-    NS_ASSERT(table3gpp->m_raysPerCluster <=
-              channelParams->m_crossPolarizationPowerRatios[0].size());
-    NS_ASSERT(table3gpp->m_raysPerCluster <= rayZoaRadian[0].size());
-    NS_ASSERT(table3gpp->m_raysPerCluster <= rayZodRadian[0].size());
-    NS_ASSERT(table3gpp->m_raysPerCluster <= rayAoaRadian[0].size());
-    NS_ASSERT(table3gpp->m_raysPerCluster <= rayAodRadian[0].size());
-
-    double x = sMob->GetPosition().x - uMob->GetPosition().x;
-    double y = sMob->GetPosition().y - uMob->GetPosition().y;
+    NS_ASSERT(channelParams.m_reducedClusterNumber <= channelParams.m_clusterPhase.size());
+    NS_ASSERT(channelParams.m_reducedClusterNumber <= channelParams.m_clusterPower.size());
+    NS_ASSERT(channelParams.m_reducedClusterNumber <=
+              channelParams.m_crossPolarizationPowerRatios.size());
+    NS_ASSERT(channelParams.m_reducedClusterNumber <= rayZoaRadian.size());
+    NS_ASSERT(channelParams.m_reducedClusterNumber <= rayZodRadian.size());
+    NS_ASSERT(channelParams.m_reducedClusterNumber <= rayAoaRadian.size());
+    NS_ASSERT(channelParams.m_reducedClusterNumber <= rayAodRadian.size());
+    NS_ASSERT(table3gpp.m_raysPerCluster <= channelParams.m_clusterPhase[0].size());
+    NS_ASSERT(table3gpp.m_raysPerCluster <=
+              channelParams.m_crossPolarizationPowerRatios[0].size());
+    NS_ASSERT(table3gpp.m_raysPerCluster <= rayZoaRadian[0].size());
+    NS_ASSERT(table3gpp.m_raysPerCluster <= rayZodRadian[0].size());
+    NS_ASSERT(table3gpp.m_raysPerCluster <= rayAoaRadian[0].size());
+    NS_ASSERT(table3gpp.m_raysPerCluster <= rayAodRadian[0].size());
+
+    double x = sPosition.x - uPosition.x;
+    double y = sPosition.y - uPosition.y;
     double distance2D = sqrt(x * x + y * y);
     // NOTE we assume hUT = min (height(a), height(b)) and
     // hBS = max (height (a), height (b))
-    double hUt = std::min(sMob->GetPosition().z, uMob->GetPosition().z);
-    double hBs = std::max(sMob->GetPosition().z, uMob->GetPosition().z);
+    double hUt = std::min(sPosition.z, uPosition.z);
+    double hBs = std::max(sPosition.z, uPosition.z);
     // compute the 3D distance using eq. 7.4-1
     double distance3D = std::sqrt(distance2D * distance2D + (hBs - hUt) * (hBs - hUt));
 
-    Angles sAngle(uMob->GetPosition(), sMob->GetPosition());
-    Angles uAngle(sMob->GetPosition(), uMob->GetPosition());
+    Angles sAngle(uPosition, sPosition);
+    Angles uAngle(sPosition, uPosition);
 
     Double2DVector sinCosA; // cached multiplications of sin and cos of the ZoA and AoA angles
     Double2DVector sinSinA; // cached multiplications of sines of the ZoA and AoA angles
@@ -3321,54 +3579,54 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     // contains part of the ray expression, cached as independent from the u- and s-indexes,
     // but calculate it for different polarization angles of s and u
     std::map<std::pair<uint8_t, uint8_t>, Complex2DVector> raysPreComp;
-    for (size_t polSa = 0; polSa < sAntenna->GetNumPols(); ++polSa)
+    for (size_t polSa = 0; polSa < sAntenna.GetNumPols(); ++polSa)
     {
-        for (size_t polUa = 0; polUa < uAntenna->GetNumPols(); ++polUa)
+        for (size_t polUa = 0; polUa < uAntenna.GetNumPols(); ++polUa)
         {
             raysPreComp[std::make_pair(polSa, polUa)] =
-                Complex2DVector(channelParams->m_reducedClusterNumber, table3gpp->m_raysPerCluster);
+                Complex2DVector(channelParams.m_reducedClusterNumber, table3gpp.m_raysPerCluster);
         }
     }
 
     // resize to appropriate dimensions
-    sinCosA.resize(channelParams->m_reducedClusterNumber);
-    sinSinA.resize(channelParams->m_reducedClusterNumber);
-    cosZoA.resize(channelParams->m_reducedClusterNumber);
-    sinCosD.resize(channelParams->m_reducedClusterNumber);
-    sinSinD.resize(channelParams->m_reducedClusterNumber);
-    cosZoD.resize(channelParams->m_reducedClusterNumber);
-    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
-    {
-        sinCosA[nIndex].resize(table3gpp->m_raysPerCluster);
-        sinSinA[nIndex].resize(table3gpp->m_raysPerCluster);
-        cosZoA[nIndex].resize(table3gpp->m_raysPerCluster);
-        sinCosD[nIndex].resize(table3gpp->m_raysPerCluster);
-        sinSinD[nIndex].resize(table3gpp->m_raysPerCluster);
-        cosZoD[nIndex].resize(table3gpp->m_raysPerCluster);
+    sinCosA.resize(channelParams.m_reducedClusterNumber);
+    sinSinA.resize(channelParams.m_reducedClusterNumber);
+    cosZoA.resize(channelParams.m_reducedClusterNumber);
+    sinCosD.resize(channelParams.m_reducedClusterNumber);
+    sinSinD.resize(channelParams.m_reducedClusterNumber);
+    cosZoD.resize(channelParams.m_reducedClusterNumber);
+    for (uint8_t nIndex = 0; nIndex < channelParams.m_reducedClusterNumber; nIndex++)
+    {
+        sinCosA[nIndex].resize(table3gpp.m_raysPerCluster);
+        sinSinA[nIndex].resize(table3gpp.m_raysPerCluster);
+        cosZoA[nIndex].resize(table3gpp.m_raysPerCluster);
+        sinCosD[nIndex].resize(table3gpp.m_raysPerCluster);
+        sinSinD[nIndex].resize(table3gpp.m_raysPerCluster);
+        cosZoD[nIndex].resize(table3gpp.m_raysPerCluster);
     }
     // pre-compute the terms which are independent from uIndex and sIndex
-    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
+    for (uint8_t nIndex = 0; nIndex < channelParams.m_reducedClusterNumber; nIndex++)
     {
-        for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
+        for (uint8_t mIndex = 0; mIndex < table3gpp.m_raysPerCluster; mIndex++)
         {
-            DoubleVector initialPhase = channelParams->m_clusterPhase[nIndex][mIndex];
+            DoubleVector initialPhase = channelParams.m_clusterPhase[nIndex][mIndex];
             NS_ASSERT(4 <= initialPhase.size());
-            double k = channelParams->m_crossPolarizationPowerRatios[nIndex][mIndex];
+            double k = channelParams.m_crossPolarizationPowerRatios[nIndex][mIndex];
 
             // cache the component of the "rays" terms which depend on the random angle of arrivals
             // and departures and initial phases only
-            for (uint8_t polUa = 0; polUa < uAntenna->GetNumPols(); ++polUa)
+            for (uint8_t polUa = 0; polUa < uAntenna.GetNumPols(); ++polUa)
             {
-                auto [rxFieldPatternPhi, rxFieldPatternTheta] = uAntenna->GetElementFieldPattern(
-                    Angles(channelParams->m_rayAoaRadian[nIndex][mIndex],
-                           channelParams->m_rayZoaRadian[nIndex][mIndex]),
+                auto [rxFieldPatternPhi, rxFieldPatternTheta] = uAntenna.GetElementFieldPattern(
+                    Angles(channelParams.m_rayAoaRadian[nIndex][mIndex],
+                           channelParams.m_rayZoaRadian[nIndex][mIndex]),
                     polUa);
-                for (uint8_t polSa = 0; polSa < sAntenna->GetNumPols(); ++polSa)
+                for (uint8_t polSa = 0; polSa < sAntenna.GetNumPols(); ++polSa)
                 {
                     auto [txFieldPatternPhi, txFieldPatternTheta] =
-                        sAntenna->GetElementFieldPattern(
-                            Angles(channelParams->m_rayAodRadian[nIndex][mIndex],
-                                   channelParams->m_rayZodRadian[nIndex][mIndex]),
+                        sAntenna.GetElementFieldPattern(
+                            Angles(channelParams.m_rayAodRadian[nIndex][mIndex],
+                                   channelParams.m_rayZodRadian[nIndex][mIndex]),
                             polSa);
                     raysPreComp[std::make_pair(polSa, polUa)](nIndex, mIndex) =
                         std::complex<double>(cos(initialPhase[0]), sin(initialPhase[0])) *
@@ -3405,21 +3663,21 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     // The following for loops computes the channel coefficients
     // Keeps track of how many sub-clusters have been added up to now
     uint8_t numSubClustersAdded = 0;
-    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
+    for (uint8_t nIndex = 0; nIndex < channelParams.m_reducedClusterNumber; nIndex++)
     {
         for (size_t uIndex = 0; uIndex < uSize; uIndex++)
         {
-            Vector uLoc = uAntenna->GetElementLocation(uIndex);
+            Vector uLoc = uAntenna.GetElementLocation(uIndex);
 
             for (size_t sIndex = 0; sIndex < sSize; sIndex++)
             {
-                Vector sLoc = sAntenna->GetElementLocation(sIndex);
+                Vector sLoc = sAntenna.GetElementLocation(sIndex);
                 // Compute the N-2 weakest cluster, assuming 0 slant angle and a
                 // polarization slant angle configured in the array (7.5-22)
-                if (nIndex != channelParams->m_cluster1st && nIndex != channelParams->m_cluster2nd)
+                if (nIndex != channelParams.m_cluster1st && nIndex != channelParams.m_cluster2nd)
                 {
                     std::complex<double> rays(0, 0);
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
+                    for (uint8_t mIndex = 0; mIndex < table3gpp.m_raysPerCluster; mIndex++)
                     {
                         // lambda_0 is accounted in the antenna spacing uLoc and sLoc.
                         double rxPhaseDiff =
@@ -3433,14 +3691,14 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
                              cosZoD[nIndex][mIndex] * sLoc.z);
                         // NOTE Doppler is computed in the CalcBeamformingGain function and is
                         // simplified to only account for the center angle of each cluster.
-                        rays += raysPreComp[std::make_pair(sAntenna->GetElemPol(sIndex),
-                                                           uAntenna->GetElemPol(uIndex))](nIndex,
+                        rays += raysPreComp[std::make_pair(sAntenna.GetElemPol(sIndex),
+                                                           uAntenna.GetElemPol(uIndex))](nIndex,
                                                                                           mIndex) *
                                 std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
                                 std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
                     }
                     rays *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
+                        sqrt(channelParams.m_clusterPower[nIndex] / table3gpp.m_raysPerCluster);
                     hUsn(uIndex, sIndex, nIndex) = rays;
                 }
                 else //(7.5-28)
@@ -3449,7 +3707,7 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
                     std::complex<double> raysSub2(0, 0);
                     std::complex<double> raysSub3(0, 0);
 
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
+                    for (uint8_t mIndex = 0; mIndex < table3gpp.m_raysPerCluster; mIndex++)
                     {
                         // ZML:Just remind me that the angle offsets for the 3 subclusters were not
                         // generated correctly.
@@ -3464,8 +3722,8 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
                              cosZoD[nIndex][mIndex] * sLoc.z);
 
                         std::complex<double> raySub =
-                            raysPreComp[std::make_pair(sAntenna->GetElemPol(sIndex),
-                                                       uAntenna->GetElemPol(uIndex))](nIndex,
+                            raysPreComp[std::make_pair(sAntenna.GetElemPol(sIndex),
+                                                       uAntenna.GetElemPol(uIndex))](nIndex,
                                                                                       mIndex) *
                             std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
                             std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
@@ -3492,29 +3750,29 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
                         }
                     }
                     raysSub1 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
+                        sqrt(channelParams.m_clusterPower[nIndex] / table3gpp.m_raysPerCluster);
                     raysSub2 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
+                        sqrt(channelParams.m_clusterPower[nIndex] / table3gpp.m_raysPerCluster);
                     raysSub3 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
+                        sqrt(channelParams.m_clusterPower[nIndex] / table3gpp.m_raysPerCluster);
                     hUsn(uIndex, sIndex, nIndex) = raysSub1;
                     hUsn(uIndex,
                          sIndex,
-                         channelParams->m_reducedClusterNumber + numSubClustersAdded) = raysSub2;
+                         channelParams.m_reducedClusterNumber + numSubClustersAdded) = raysSub2;
                     hUsn(uIndex,
                          sIndex,
-                         channelParams->m_reducedClusterNumber + numSubClustersAdded + 1) =
+                         channelParams.m_reducedClusterNumber + numSubClustersAdded + 1) =
                         raysSub3;
                 }
             }
         }
-        if (nIndex == channelParams->m_cluster1st || nIndex == channelParams->m_cluster2nd)
+        if (nIndex == channelParams.m_cluster1st || nIndex == channelParams.m_cluster2nd)
         {
             numSubClustersAdded += 2;
         }
     }
 
-    if (channelParams->m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
+    if (channelParams.m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
     {
         double lambda = 3.0e8 / m_frequency; // the wavelength of the carrier frequency
         std::complex<double> phaseDiffDueToDistance(cos(-2 * M_PI * distance3D / lambda),
@@ -3531,26 +3789,26 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
 
         for (size_t uIndex = 0; uIndex < uSize; uIndex++)
         {
-            Vector uLoc = uAntenna->GetElementLocation(uIndex);
+            Vector uLoc = uAntenna.GetElementLocation(uIndex);
             double rxPhaseDiff = 2 * M_PI *
                                  (sinUAngleIncl * cosUAngleAz * uLoc.x +
                                   sinUAngleIncl * sinUAngleAz * uLoc.y + cosUAngleIncl * uLoc.z);
 
             for (size_t sIndex = 0; sIndex < sSize; sIndex++)
             {
-                Vector sLoc = sAntenna->GetElementLocation(sIndex);
+                Vector sLoc = sAntenna.GetElementLocation(sIndex);
                 std::complex<double> ray(0, 0);
                 double txPhaseDiff =
                     2 * M_PI *
                     (sinSAngleIncl * cosSAngleAz * sLoc.x + sinSAngleIncl * sinSAngleAz * sLoc.y +
                      cosSAngleIncl * sLoc.z);
 
-                auto [rxFieldPatternPhi, rxFieldPatternTheta] = uAntenna->GetElementFieldPattern(
+                auto [rxFieldPatternPhi, rxFieldPatternTheta] = uAntenna.GetElementFieldPattern(
                     Angles(uAngle.GetAzimuth(), uAngle.GetInclination()),
-                    uAntenna->GetElemPol(uIndex));
-                auto [txFieldPatternPhi, txFieldPatternTheta] = sAntenna->GetElementFieldPattern(
+                    uAntenna.GetElemPol(uIndex));
+                auto [txFieldPatternPhi, txFieldPatternTheta] = sAntenna.GetElementFieldPattern(
                     Angles(sAngle.GetAzimuth(), sAngle.GetInclination()),
-                    sAntenna->GetElemPol(sIndex));
+                    sAntenna.GetElemPol(sIndex));
 
                 ray = (rxFieldPatternTheta * txFieldPatternTheta -
                        rxFieldPatternPhi * txFieldPatternPhi) *
@@ -3558,13 +3816,13 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
                       std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
                       std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
 
-                double kLinear = pow(10, channelParams->m_K_factor / 10.0);
+                double kLinear = pow(10, channelParams.m_K_factor / 10.0);
                 // the LOS path should be attenuated if blockage is enabled.
                 hUsn(uIndex, sIndex, 0) =
                     sqrt(1.0 / (kLinear + 1)) * hUsn(uIndex, sIndex, 0) +
                     sqrt(kLinear / (1 + kLinear)) * ray /
                         pow(10,
-                            channelParams->m_attenuation_dB[0] / 10.0); //(7.5-30) for tau = tau1
+                            channelParams.m_attenuation_dB[0] / 10.0); //(7.5-30) for tau = tau1
                 for (size_t nIndex = 1; nIndex < hUsn.GetNumPages(); nIndex++)
                 {
                     hUsn(uIndex, sIndex, nIndex) *=
@@ -3573,24 +3831,7 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
             }
         }
     }
-
-    NS_LOG_DEBUG("Husn (sAntenna, uAntenna):" << sAntenna->GetId() << ", " << uAntenna->GetId());
-    for (size_t cIndex = 0; cIndex < hUsn.GetNumPages(); cIndex++)
-    {
-        for (size_t rowIdx = 0; rowIdx < hUsn.GetNumRows(); rowIdx++)
-        {
-            for (size_t colIdx = 0; colIdx < hUsn.GetNumCols(); colIdx++)
-            {
-                NS_LOG_DEBUG(" " << hUsn(rowIdx, colIdx, cIndex) << ",");
-            }
-        }
-    }
-
-    NS_LOG_INFO("size of coefficient matrix (rows, columns, clusters) = ("
-                << hUsn.GetNumRows() << ", " << hUsn.GetNumCols() << ", " << hUsn.GetNumPages()
-                << ")");
-    channelMatrix->m_channel = hUsn;
-    return channelMatrix;
+    channelMatrix.m_channel = std::move(hUsn);
 }
 
 std::pair<double, double>
@@ -19,6 +19,7 @@
 
 #include <complex.h>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -108,6 +109,35 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
                                         Ptr<const PhasedArrayModel> aAntenna,
                                         Ptr<const PhasedArrayModel> bAntenna) override;
 
+    /**
+     * The devices at the ends of a channel, as passed to GetChannel
+     */
+    struct ChannelPair
+    {
+        Ptr<const MobilityModel> aMob;        //!< mobility model of the a device
+        Ptr<const MobilityModel> bMob;        //!< mobility model of the b device
+        Ptr<const PhasedArrayModel> aAntenna; //!< antenna of the a device
+        Ptr<const PhasedArrayModel> bAntenna; //!< antenna of the b device
+    };
+
+    /**
+     * Generates the channel matrices of several pairs of devices which are
+     * not found in m_channelMatrixMap or have to be updated, as calling
+     * GetChannel for each pair in turn would, then stores them in
+     * m_channelMatrixMap.
+     *
+     * The channel params are updated sequentially, in the order of the pairs,
+     * so that the random variables are drawn in the same order as with
+     * GetChannel.  The channel matrices are then computed in parallel by
+     * BatchThreads threads, the results not depending on their number.  The
+     * antenna arrays are only read by these threads, and must support
+     * concurrent calls of their const methods.  GetNewChannel is not called,
+     * hence not to be used by models overriding it.
+     *
+     * @param pairs the pairs of devices
+     */
+    void GenerateChannels(const std::vector<ChannelPair>& pairs);
+
     /**
      * Looks for the channel params associated to the aMob and bMob pair in
      * m_channelParamsMap. If not found it will return a nullptr.
@@ -308,6 +338,63 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
                                              const Ptr<const MobilityModel> uMob,
                                              Ptr<const PhasedArrayModel> sAntenna,
                                              Ptr<const PhasedArrayModel> uAntenna) const;
+
+    /**
+     * Compute the coefficients of a channel matrix between two nodes s and u,
+     * as GetNewChannel, from the positions of the nodes.  The method does not
+     * access the simulator nor the mobility models, and can be called by
+     * several threads at once.
+     * @param channelParams the channel parameters previously generated for the pair of
+     * nodes s and u
+     * @param table3gpp the 3gpp parameters table
+     * @param sPosition the position of node s
+     * @param uPosition the position of node u
+     * @param sAntenna the antenna array of node s
+     * @param uAntenna the antenna array of node u
+     * @param [in,out] channelMatrix the channel matrix, whose node IDs are set,
+     * to be filled with the channel coefficients
+     */
+    void ComputeChannelMatrix(const ThreeGppChannelParams& channelParams,
+                              const ParamsTable& table3gpp,
+                              const Vector& sPosition,
+                              const Vector& uPosition,
+                              const PhasedArrayModel& sAntenna,
+                              const PhasedArrayModel& uAntenna,
+                              ChannelMatrix& channelMatrix) const;
+
+    /**
+     * Get the channel params of the nodes a and b, and generate them if not
+     * found in m_channelParamsMap or if they have to be updated.
+     * @param aMob the mobility model of node a
+     * @param bMob the mobility model of node b
+     * @param [out] table3gpp the 3gpp parameters table
+     * @return the channel params
+     */
+    Ptr<ThreeGppChannelParams> UpdateChannelParams(Ptr<const MobilityModel> aMob,
+                                                   Ptr<const MobilityModel> bMob,
+                                                   Ptr<const ParamsTable>& table3gpp);
+
+    /**
+     * Check if the channel params or the channel matrix of a pair of devices
+     * are missing or have to be updated, without generating them
+     * @param aMob mobility model of the a device
+     * @param bMob mobility model of the b device
+     * @param aAntenna antenna of the a device
+     * @param bAntenna antenna of the b device
+     * @return true if GetChannel would generate the channel params or matrix
+     */
+    bool ChannelNeedsUpdate(Ptr<const MobilityModel> aMob,
+                            Ptr<const MobilityModel> bMob,
+                            Ptr<const PhasedArrayModel> aAntenna,
+                            Ptr<const PhasedArrayModel> bAntenna);
+
+    /**
+     * Forget the pairs of devices served with batch updates which have not
+     * been looked up since the last batch update, e.g., because one of the
+     * devices is gone, so that they are no longer regenerated nor kept alive
+     */
+    void PruneBatchPairs();
+
     /**
      * Applies the blockage model A described in 3GPP TR 38.901
      * @param channelParams the channel parameters structure
@@ -381,6 +468,15 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
     bool m_portraitMode;           //!< true if portrait mode, false if landscape
     double m_blockerSpeed;         //!< the blocker speed
 
+    // batch generation of the channel matrices
+    bool m_batchUpdate;                    //!< whether GetChannel updates the channels in batch
+    uint32_t m_batchThreads;               //!< the number of threads of GenerateChannels
+    std::vector<ChannelPair> m_batchPairs; //!< the pairs served with batch updates, in order
+    std::vector<Time> m_batchLookupTimes;  //!< the time of the last lookup of each pair
+    std::unordered_map<uint64_t, std::size_t>
+        m_batchPairIndexes; //!< the indexes in m_batchPairs, by channel matrix key
+    Time m_lastBatchTime;   //!< the time of the last batch update
+
     static const uint8_t PHI_INDEX = 0; //!< index of the PHI value in the m_nonSelfBlocking array
     static const uint8_t X_INDEX = 1;   //!< index of the X value in the m_nonSelfBlocking array
     static const uint8_t THETA_INDEX =
@@ -100,6 +100,40 @@ ThreeGppSpectrumPropagationLossModel::GetChannelModelAttribute(const std::string
     m_channelModel->GetAttribute(name, value);
 }
 
+/**
+ * Get the beamforming weights of the elements of the ports of an antenna
+ * array, as computed by CalculateLongTermComponent.
+ *
+ * @param antenna the antenna array
+ * @return a matrix whose columns are the weights of the elements of the ports,
+ * with the dimensions #elements, #ports
+ */
+static ComplexMatrixArray
+GetPortWeights(const PhasedArrayModel& antenna)
+{
+    const PhasedArrayModel::ComplexVector& w = antenna.GetBeamformingVectorRef();
+    ComplexMatrixArray weights(antenna.GetNumElems(), antenna.GetNumPorts());
+    // The sub-array partition model is adopted for TXRU virtualization,
+    // so that the elements of a port are the rows of a sub-array
+    const auto portElems = antenna.GetNumElemsPerPort();
+    const auto hElemsPerPort = antenna.GetHElemsPerPort();
+    for (uint16_t portIdx = 0; portIdx < antenna.GetNumPorts(); portIdx++)
+    {
+        auto start = antenna.ArrayIndexFromPortIndex(portIdx, 0);
+        auto index = start;
+        for (size_t elemIdx = 0; elemIdx < portElems; elemIdx++, index++)
+        {
+            weights(index, portIdx) = w[index - start];
+            if (elemIdx % hElemsPerPort == hElemsPerPort - 1)
+            {
+                // Increment by a factor to reach next column in a port
+                index += antenna.GetNumColumns() - hElemsPerPort;
+            }
+        }
+    }
+    return weights;
+}
+
 Ptr<const MatrixBasedChannelModel::Complex3DVector>
 ThreeGppSpectrumPropagationLossModel::CalcLongTerm(
     Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
@@ -119,26 +153,12 @@ ThreeGppSpectrumPropagationLossModel::CalcLongTerm(
                                       << " s ports: " << sAnt->GetNumPorts()
                                       << " u ports: " << uAnt->GetNumPorts());
     NS_ASSERT_MSG((sAnt != nullptr) && (uAnt != nullptr), "Improper call to the method");
-    size_t numClusters = params->m_channel.GetNumPages();
-    // create and initialize the size of the longTerm 3D matrix
-    Ptr<MatrixBasedChannelModel::Complex3DVector> longTerm =
-        Create<MatrixBasedChannelModel::Complex3DVector>(uAnt->GetNumPorts(),
-                                                         sAnt->GetNumPorts(),
-                                                         numClusters);
     // Calculate long term uW * Husn * sW, the result is a matrix
-    // with the dimensions #uPorts, #sPorts, #cluster
-    for (auto sPortIdx = 0; sPortIdx < sAnt->GetNumPorts(); sPortIdx++)
-    {
-        for (auto uPortIdx = 0; uPortIdx < uAnt->GetNumPorts(); uPortIdx++)
-        {
-            for (size_t cIndex = 0; cIndex < numClusters; cIndex++)
-            {
-                longTerm->Elem(uPortIdx, sPortIdx, cIndex) =
-                    CalculateLongTermComponent(params, sAnt, uAnt, sPortIdx, uPortIdx, cIndex);
-            }
-        }
-    }
-    return longTerm;
+    // with the dimensions #uPorts, #sPorts, #cluster, i.e., the product of
+    // the channel matrix of each cluster by the weights of the ports
+    return Create<MatrixBasedChannelModel::Complex3DVector>(
+        params->m_channel.MultiplyByLeftAndRightMatrix(GetPortWeights(*uAnt).Transpose(),
+                                                       GetPortWeights(*sAnt)));
 }
 
 std::complex<double>
@@ -341,22 +361,30 @@ ThreeGppSpectrumPropagationLossModel::GenSpectrumChannelMatrix(
     size_t numCluster = channelMatrix->m_channel.GetNumPages();
     auto numRb = inPsd->GetValuesN();
 
-    auto directionalLongTerm = isReverse ? longTerm->Transpose() : (*longTerm);
-
-    Ptr<MatrixBasedChannelModel::Complex3DVector> chanSpct =
-        Create<MatrixBasedChannelModel::Complex3DVector>(numRxPorts, numTxPorts, (uint16_t)numRb);
+    // If "params" (ChannelMatrix) and longTerm were computed for the reverse direction (e.g. this
+    // is a DL transmission but params and longTerm were last updated during UL), then the elements
+    // in longTerm start from different offsets.
+    MatrixBasedChannelModel::Complex3DVector reverseLongTerm;
+    if (isReverse)
+    {
+        reverseLongTerm = longTerm->Transpose();
+    }
+    const auto& directionalLongTerm = isReverse ? reverseLongTerm : *longTerm;
+    NS_ASSERT(directionalLongTerm.GetNumRows() == numRxPorts);
+    NS_ASSERT(directionalLongTerm.GetNumCols() == numTxPorts);
+    NS_ASSERT(directionalLongTerm.GetNumPages() >= numCluster);
 
     // Precompute the delay until numRb, numCluster or RB width changes
     // Whenever the channelParams is updated, the number of numRbs, numClusters
     // and RB width (12*SCS) are reset, ensuring these values are updated too
     double rbWidth = inPsd->ConstBandsBegin()->fh - inPsd->ConstBandsBegin()->fl;
 
-    if (channelParams->m_cachedDelaySincos.GetNumRows() != numRb ||
-        channelParams->m_cachedDelaySincos.GetNumCols() != numCluster ||
+    if (channelParams->m_cachedDelaySincos.GetNumRows() != numCluster ||
+        channelParams->m_cachedDelaySincos.GetNumCols() != numRb ||
         channelParams->m_cachedRbWidth != rbWidth)
     {
         channelParams->m_cachedRbWidth = rbWidth;
-        channelParams->m_cachedDelaySincos = ComplexMatrixArray(numRb, numCluster);
+        channelParams->m_cachedDelaySincos = ComplexMatrixArray(numCluster, numRb);
         auto sbit = inPsd->ConstBandsBegin(); // band iterator
         for (unsigned i = 0; i < numRb; i++)
         {
@@ -364,53 +392,47 @@ ThreeGppSpectrumPropagationLossModel::GenSpectrumChannelMatrix(
             for (std::size_t cIndex = 0; cIndex < numCluster; cIndex++)
             {
                 double delay = -2 * M_PI * fsb * (channelParams->m_delay[cIndex]);
-                channelParams->m_cachedDelaySincos(i, cIndex) =
+                channelParams->m_cachedDelaySincos(cIndex, i) =
                     std::complex<double>(cos(delay), sin(delay));
             }
             sbit++;
         }
     }
 
-    // Compute the product between the doppler and the delay sincos
-    auto delaySincosCopy = channelParams->m_cachedDelaySincos;
-    for (size_t iRb = 0; iRb < inPsd->GetValuesN(); iRb++)
+    // Apply the doppler of each cluster to its long term, rather than to its
+    // delay sincos for every RB, the long term of the port pairs being the
+    // rows of a numPorts x numCluster matrix
+    size_t numPorts = numRxPorts * numTxPorts;
+    ComplexMatrixArray dopplerLongTerm(numPorts, numCluster);
+    for (std::size_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
-        for (std::size_t cIndex = 0; cIndex < numCluster; cIndex++)
+        const std::complex<double>* longTermPage = directionalLongTerm.GetPagePtr(cIndex);
+        for (size_t portIdx = 0; portIdx < numPorts; portIdx++)
         {
-            delaySincosCopy(iRb, cIndex) *= doppler[cIndex];
+            dopplerLongTerm(portIdx, cIndex) = longTermPage[portIdx] * doppler[cIndex];
         }
     }
 
-    // If "params" (ChannelMatrix) and longTerm were computed for the reverse direction (e.g. this
-    // is a DL transmission but params and longTerm were last updated during UL), then the elements
-    // in longTerm start from different offsets.
-
+    // Compute the frequency-domain channel matrix, whose page of each RB is
+    // the column of the RB in the numPorts x numRb product of the long term
+    // and the delay sincos
+    ComplexMatrixArray subbandGains = dopplerLongTerm * channelParams->m_cachedDelaySincos;
+    Ptr<MatrixBasedChannelModel::Complex3DVector> chanSpct =
+        Create<MatrixBasedChannelModel::Complex3DVector>(numRxPorts,
+                                                         numTxPorts,
+                                                         numRb,
+                                                         subbandGains.GetValues());
     auto vit = inPsd->ValuesBegin(); // psd iterator
-    size_t iRb = 0;
-    // Compute the frequency-domain channel matrix
-    while (vit != inPsd->ValuesEnd())
+    for (size_t iRb = 0; iRb < numRb; iRb++, vit++)
     {
-        if ((*vit) != 0.00)
+        // Multiply with the square root of the input PSD so that the norm (absolute
+        // value squared) of chanSpct will be the output PSD
+        double sqrtVit = ((*vit) != 0.00) ? sqrt(*vit) : 0.0;
+        std::complex<double>* rbPage = chanSpct->GetPagePtr(iRb);
+        for (size_t portIdx = 0; portIdx < numPorts; portIdx++)
         {
-            auto sqrtVit = sqrt(*vit);
-            for (auto rxPortIdx = 0; rxPortIdx < numRxPorts; rxPortIdx++)
-            {
-                for (auto txPortIdx = 0; txPortIdx < numTxPorts; txPortIdx++)
-                {
-                    std::complex<double> subsbandGain(0.0, 0.0);
-                    for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
-                    {
-                        subsbandGain += directionalLongTerm(rxPortIdx, txPortIdx, cIndex) *
-                                        delaySincosCopy(iRb, cIndex);
-                    }
-                    // Multiply with the square root of the input PSD so that the norm (absolute
-                    // value squared) of chanSpct will be the output PSD
-                    chanSpct->Elem(rxPortIdx, txPortIdx, iRb) = sqrtVit * subsbandGain;
-                }
-            }
+            rbPage[portIdx] *= sqrtVit;
         }
-        vit++;
-        iRb++;
     }
     return chanSpct;
 }
@@ -431,18 +453,9 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm(
     auto sAntenna = isReverse ? bPhasedArrayModel : aPhasedArrayModel;
     auto uAntenna = isReverse ? aPhasedArrayModel : bPhasedArrayModel;
 
-    PhasedArrayModel::ComplexVector sW;
-    PhasedArrayModel::ComplexVector uW;
-    if (!isReverse)
-    {
-        sW = aPhasedArrayModel->GetBeamformingVector();
-        uW = bPhasedArrayModel->GetBeamformingVector();
-    }
-    else
-    {
-        sW = bPhasedArrayModel->GetBeamformingVector();
-        uW = aPhasedArrayModel->GetBeamformingVector();
-    }
+    // the beamforming vectors are only copied if the long term is updated
+    const PhasedArrayModel::ComplexVector& sW = sAntenna->GetBeamformingVectorRef();
+    const PhasedArrayModel::ComplexVector& uW = uAntenna->GetBeamformingVectorRef();
 
     bool update = false;   // indicates whether the long term has to be updated
     bool notFound = false; // indicates if the long term has not been computed yet
@@ -478,8 +491,8 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm(
         Ptr<LongTerm> longTermItem = Create<LongTerm>();
         longTermItem->m_longTerm = longTerm;
         longTermItem->m_channel = channelMatrix;
-        longTermItem->m_sW = std::move(sW);
-        longTermItem->m_uW = std::move(uW);
+        longTermItem->m_sW = sW;
+        longTermItem->m_uW = uW;
         // store the long term to reduce computation load
         // only the small scale fading needs to be updated if the large scale parameters and antenna
         // weights remain unchanged.
@@ -0,0 +1,233 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/net-device.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/test.h>
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief A SpectrumPhy recording the PSD it receives, whose RX SpectrumModel
+ * can change.
+ */
+class MultiModelTestSpectrumPhy : public SpectrumPhy
+{
+  public:
+    /**
+     * Constructor
+     * @param rxSpectrumModel The RX spectrum model.
+     * @param position The position.
+     */
+    MultiModelTestSpectrumPhy(Ptr<const SpectrumModel> rxSpectrumModel, Vector position)
+        : m_rxSpectrumModel(rxSpectrumModel)
+    {
+        m_mobility = CreateObject<ConstantPositionMobilityModel>();
+        m_mobility->SetPosition(position);
+    }
+
+    void SetDevice(Ptr<NetDevice> d) override
+    {
+    }
+
+    Ptr<NetDevice> GetDevice() const override
+    {
+        return nullptr;
+    }
+
+    void SetMobility(Ptr<MobilityModel> m) override
+    {
+        m_mobility = m;
+    }
+
+    Ptr<MobilityModel> GetMobility() const override
+    {
+        return m_mobility;
+    }
+
+    void SetChannel(Ptr<SpectrumChannel> c) override
+    {
+    }
+
+    Ptr<const SpectrumModel> GetRxSpectrumModel() const override
+    {
+        return m_rxSpectrumModel;
+    }
+
+    /**
+     * Set the RX spectrum model.
+     * @param rxSpectrumModel The RX spectrum model.
+     */
+    void SetRxSpectrumModel(Ptr<const SpectrumModel> rxSpectrumModel)
+    {
+        m_rxSpectrumModel = rxSpectrumModel;
+    }
+
+    Ptr<Object> GetAntenna() const override
+    {
+        return nullptr;
+    }
+
+    void StartRx(Ptr<SpectrumSignalParameters> params) override
+    {
+        m_rxPsds.push_back(params->psd);
+        m_rxValues.push_back(*params->psd);
+    }
+
+    std::vector<Ptr<SpectrumValue>> m_rxPsds; //!< The received PSDs
+    std::vector<SpectrumValue> m_rxValues;    //!< The values of the PSDs when received
+
+  private:
+    Ptr<MobilityModel> m_mobility;              //!< The mobility model
+    Ptr<const SpectrumModel> m_rxSpectrumModel; //!< The RX spectrum model
+};
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief Check the PSDs received through a MultiModelSpectrumChannel.
+ *
+ * A PHY transmits over a fine SpectrumModel to PHYs using it or a coarse
+ * one, two of the latter switching to the fine one while the signal
+ * propagates:
+ * - Test that every PHY receives the PSD converted to its current model,
+ *   scaled by its own path loss.
+ * - Test that the received PSDs are distinct objects, not modified by the
+ *   other receptions, and that the transmitted PSD is not modified.
+ */
+class MultiModelSpectrumChannelPsdTestCase : public TestCase
+{
+  public:
+    MultiModelSpectrumChannelPsdTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+MultiModelSpectrumChannelPsdTestCase::MultiModelSpectrumChannelPsdTestCase()
+    : TestCase("Check the PSDs received through MultiModelSpectrumChannel")
+{
+}
+
+void
+MultiModelSpectrumChannelPsdTestCase::DoRun()
+{
+    auto fine = Create<SpectrumModel>(std::vector<double>{1, 2, 3, 4});
+    auto coarse = Create<SpectrumModel>(std::vector<double>{1.5, 3.5});
+
+    auto channel = CreateObject<MultiModelSpectrumChannel>();
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    std::map<Ptr<const SpectrumPhy>, double> pathLosses;
+    channel->TraceConnectWithoutContext(
+        "PathLoss",
+        Callback<void, Ptr<const SpectrumPhy>, Ptr<const SpectrumPhy>, double>(
+            [&pathLosses](Ptr<const SpectrumPhy>, Ptr<const SpectrumPhy> rxPhy, double loss) {
+                pathLosses[rxPhy] = loss;
+            }));
+
+    auto txPhy = Create<MultiModelTestSpectrumPhy>(fine, Vector(0, 0, 0));
+    channel->AddRx(txPhy);
+    std::vector<Ptr<MultiModelTestSpectrumPhy>> rxPhys;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        auto phy = Create<MultiModelTestSpectrumPhy>(i < 2 ? fine : coarse,
+                                                     Vector(100.0 + 20 * i, 0, 0));
+        channel->AddRx(phy);
+        rxPhys.push_back(phy);
+    }
+    // the last two PHYs switch to the TX model after the start of the TX
+    Simulator::Schedule(NanoSeconds(1), [&rxPhys, channel, fine]() {
+        for (uint32_t i = 4; i < 6; i++)
+        {
+            rxPhys[i]->SetRxSpectrumModel(fine);
+            channel->AddRx(rxPhys[i]);
+        }
+    });
+
+    auto txPsd = Create<SpectrumValue>(fine);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        (*txPsd)[i] = 1e-3 * (i + 1);
+    }
+    SpectrumValue txValues = *txPsd;
+    auto params = Create<SpectrumSignalParameters>();
+    params->psd = txPsd;
+    params->duration = MilliSeconds(1);
+    params->txPhy = txPhy;
+    channel->StartTx(params);
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ((*txPsd == txValues), true, "The TX PSD was modified");
+    NS_TEST_EXPECT_MSG_EQ(txPhy->m_rxPsds.size(), 0, "No reception expected by the TX PHY");
+    std::vector<Ptr<SpectrumValue>> rxPsds;
+    for (uint32_t i = 0; i < rxPhys.size(); i++)
+    {
+        const auto& phy = rxPhys[i];
+        NS_TEST_ASSERT_MSG_EQ(phy->m_rxPsds.size(), 1, "Wrong number of receptions of " << i);
+        auto rxPsd = phy->m_rxPsds.front();
+        NS_TEST_EXPECT_MSG_EQ(rxPsd->GetSpectrumModel(),
+                              phy->GetRxSpectrumModel(),
+                              "Wrong SpectrumModel received by " << i);
+        NS_TEST_EXPECT_MSG_EQ((*rxPsd == phy->m_rxValues.front()),
+                              true,
+                              "PSD received by " << i << " modified afterwards");
+        NS_TEST_EXPECT_MSG_EQ((rxPsd != txPsd), true, "TX PSD received by " << i);
+        for (const auto& other : rxPsds)
+        {
+            NS_TEST_EXPECT_MSG_EQ((rxPsd != other), true, "PSD shared by " << i);
+        }
+        rxPsds.push_back(rxPsd);
+
+        SpectrumValue expected = txValues;
+        if (phy->GetRxSpectrumModel() == coarse)
+        {
+            expected = SpectrumValue(coarse);
+            expected[0] = (txValues[0] + txValues[1]) / 2;
+            expected[1] = (txValues[2] + txValues[3]) / 2;
+        }
+        expected *= std::pow(10.0, -pathLosses.at(phy) / 10);
+        for (uint32_t band = 0; band < expected.GetValuesN(); band++)
+        {
+            NS_TEST_EXPECT_MSG_EQ_TOL((*rxPsd)[band],
+                                      expected[band],
+                                      expected[band] * 1e-12,
+                                      "Wrong PSD received by " << i << " in band " << band);
+        }
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief MultiModelSpectrumChannel TestSuite
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+  public:
+    MultiModelSpectrumChannelTestSuite();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite()
+    : TestSuite("multi-model-spectrum-channel", Type::UNIT)
+{
+    AddTestCase(new MultiModelSpectrumChannelPsdTestCase, TestCase::Duration::QUICK);
+}
+
+/// Static variable for test initialization
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite;
@@ -0,0 +1,252 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <ns3/boolean.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/double.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/net-device.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/simulator.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/test.h>
+
+#include <tuple>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief A SpectrumPhy recording the signals it receives.
+ */
+class CullingTestSpectrumPhy : public SpectrumPhy
+{
+  public:
+    /// A reception: the receiver, the time and the received power
+    using Reception = std::tuple<uint32_t, Time, double>;
+
+    /**
+     * Constructor
+     * @param id The number of the PHY.
+     * @param rxSpectrumModel The RX spectrum model.
+     * @param receptions The receptions of all the PHYs.
+     */
+    CullingTestSpectrumPhy(uint32_t id,
+                           Ptr<const SpectrumModel> rxSpectrumModel,
+                           std::vector<Reception>* receptions)
+        : m_id(id),
+          m_rxSpectrumModel(rxSpectrumModel),
+          m_receptions(receptions)
+    {
+    }
+
+    void SetDevice(Ptr<NetDevice> d) override
+    {
+    }
+
+    Ptr<NetDevice> GetDevice() const override
+    {
+        return nullptr;
+    }
+
+    void SetMobility(Ptr<MobilityModel> m) override
+    {
+        m_mobility = m;
+    }
+
+    Ptr<MobilityModel> GetMobility() const override
+    {
+        return m_mobility;
+    }
+
+    void SetChannel(Ptr<SpectrumChannel> c) override
+    {
+    }
+
+    Ptr<const SpectrumModel> GetRxSpectrumModel() const override
+    {
+        return m_rxSpectrumModel;
+    }
+
+    Ptr<Object> GetAntenna() const override
+    {
+        return nullptr;
+    }
+
+    void StartRx(Ptr<SpectrumSignalParameters> params) override
+    {
+        m_receptions->emplace_back(m_id, Simulator::Now(), Sum(*params->psd));
+    }
+
+  private:
+    uint32_t m_id;                              //!< The number of the PHY
+    Ptr<MobilityModel> m_mobility;              //!< The mobility model
+    Ptr<const SpectrumModel> m_rxSpectrumModel; //!< The RX spectrum model
+    std::vector<Reception>* m_receptions;       //!< The receptions of all the PHYs
+};
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief Check that the receiver culling of a spectrum channel only skips
+ * the receivers beyond MaxLossDb.
+ *
+ * A grid of receivers, one of them moving and one without a mobility
+ * model, receive signals with and without culling:
+ * - Test that the receptions are the same.
+ * - Test that the culling skips receivers, the PathLoss trace being fired
+ *   less often.
+ * (Move a receiver, fire its course change, and send again.)
+ */
+class SpectrumReceiverCullingTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * @param channelType The TypeId name of the channel.
+     */
+    SpectrumReceiverCullingTestCase(std::string channelType);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Send signals from several PHYs.
+     * @param culling Whether the receivers are culled.
+     * @param [out] nPathLosses The number of path losses calculated.
+     * @returns The receptions.
+     */
+    std::vector<CullingTestSpectrumPhy::Reception> Run(bool culling, uint32_t& nPathLosses);
+
+    std::string m_channelType; //!< The TypeId name of the channel
+};
+
+SpectrumReceiverCullingTestCase::SpectrumReceiverCullingTestCase(std::string channelType)
+    : TestCase("Check the receiver culling of " + channelType),
+      m_channelType(channelType)
+{
+}
+
+std::vector<CullingTestSpectrumPhy::Reception>
+SpectrumReceiverCullingTestCase::Run(bool culling, uint32_t& nPathLosses)
+{
+    ObjectFactory factory(m_channelType);
+    factory.Set("MaxLossDb", DoubleValue(110));
+    factory.Set("ReceiverCulling", BooleanValue(culling));
+    Ptr<SpectrumChannel> channel = factory.Create<SpectrumChannel>();
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    nPathLosses = 0;
+    channel->TraceConnectWithoutContext(
+        "PathLoss",
+        Callback<void, Ptr<const SpectrumPhy>, Ptr<const SpectrumPhy>, double>(
+            [&nPathLosses](Ptr<const SpectrumPhy>, Ptr<const SpectrumPhy>, double) {
+                nPathLosses++;
+            }));
+
+    auto model = Create<SpectrumModel>(std::vector<double>{2.4e9, 2.41e9});
+    std::vector<CullingTestSpectrumPhy::Reception> receptions;
+    std::vector<Ptr<CullingTestSpectrumPhy>> phys;
+    const uint32_t side = 15;
+    for (uint32_t i = 0; i < side * side + 2; i++)
+    {
+        auto phy = Create<CullingTestSpectrumPhy>(i, model, &receptions);
+        if (i < side * side)
+        {
+            auto mobility = CreateObject<ConstantPositionMobilityModel>();
+            mobility->SetPosition(Vector(40.0 * (i % side), 40.0 * (i / side), 1.5));
+            phy->SetMobility(mobility);
+        }
+        else if (i == side * side)
+        {
+            auto mobility = CreateObject<ConstantVelocityMobilityModel>();
+            mobility->SetPosition(Vector(-500, 100, 1.5));
+            mobility->SetVelocity(Vector(100, 0, 0));
+            phy->SetMobility(mobility);
+        }
+        channel->AddRx(phy);
+        phys.push_back(phy);
+    }
+
+    auto send = [channel, model](Ptr<SpectrumPhy> phy) {
+        return [channel, model, phy]() {
+            auto params = Create<SpectrumSignalParameters>();
+            params->psd = Create<SpectrumValue>(model);
+            (*params->psd)[0] = 1e-3;
+            params->duration = MilliSeconds(1);
+            params->txPhy = phy;
+            channel->StartTx(params);
+        };
+    };
+    for (uint32_t i : {0U, 7U, 112U, 224U})
+    {
+        Simulator::Schedule(Seconds(i / 100.0), send(phys[i]));
+    }
+    // move a receiver from a corner to the opposite one, then transmit from
+    // it and to it
+    Simulator::Schedule(Seconds(3), [&phys]() {
+        phys[14]->GetMobility()->SetPosition(Vector(20, 20, 1.5));
+    });
+    Simulator::Schedule(Seconds(4), send(phys[14]));
+    Simulator::Schedule(Seconds(5), send(phys[0]));
+    Simulator::Run();
+    Simulator::Destroy();
+    return receptions;
+}
+
+void
+SpectrumReceiverCullingTestCase::DoRun()
+{
+    uint32_t nPathLosses;
+    auto expected = Run(false, nPathLosses);
+    uint32_t nCulledPathLosses;
+    auto receptions = Run(true, nCulledPathLosses);
+
+    NS_TEST_ASSERT_MSG_EQ(receptions.size(), expected.size(), "Wrong number of receptions");
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(std::get<0>(receptions[i]),
+                              std::get<0>(expected[i]),
+                              "Wrong receiver of reception " << i);
+        NS_TEST_EXPECT_MSG_EQ(std::get<1>(receptions[i]),
+                              std::get<1>(expected[i]),
+                              "Wrong time of reception " << i);
+        NS_TEST_EXPECT_MSG_EQ(std::get<2>(receptions[i]),
+                              std::get<2>(expected[i]),
+                              "Wrong power of reception " << i);
+    }
+    NS_TEST_EXPECT_MSG_LT(nCulledPathLosses,
+                          nPathLosses / 2,
+                          "The culling should skip most of the receivers");
+}
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief Spectrum channel receiver culling TestSuite
+ */
+class SpectrumReceiverCullingTestSuite : public TestSuite
+{
+  public:
+    SpectrumReceiverCullingTestSuite();
+};
+
+SpectrumReceiverCullingTestSuite::SpectrumReceiverCullingTestSuite()
+    : TestSuite("spectrum-receiver-culling", Type::UNIT)
+{
+    AddTestCase(new SpectrumReceiverCullingTestCase("ns3::SingleModelSpectrumChannel"),
+                TestCase::Duration::QUICK);
+    AddTestCase(new SpectrumReceiverCullingTestCase("ns3::MultiModelSpectrumChannel"),
+                TestCase::Duration::QUICK);
+}
+
+/// Static variable for test initialization
+static SpectrumReceiverCullingTestSuite g_spectrumReceiverCullingTestSuite;
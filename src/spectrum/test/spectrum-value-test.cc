@@ -82,6 +82,93 @@ SpectrumValueTestCase::DoRun()
     NS_TEST_ASSERT_MSG_SPECTRUM_VALUE_EQ_TOL(m_a, m_b, TOLERANCE, "");
 }
 
+/**
+ * @ingroup spectrum-tests
+ *
+ * @brief Spectrum Value temporaries Test
+ *
+ * - Test that the operators computing their result in the storage of a
+ *   temporary give the same values as those copying their operands.
+ * - Test that copies, moves and assignments keep the values.
+ * - Test that the storage of a destroyed SpectrumValue is reused by the
+ *   next one with the same number of bands, initialized to zero.
+ */
+class SpectrumValueTemporariesTestCase : public TestCase
+{
+  public:
+    SpectrumValueTemporariesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SpectrumValueTemporariesTestCase::SpectrumValueTemporariesTestCase()
+    : TestCase("Check the SpectrumValue operators on temporaries and the storage pool")
+{
+}
+
+void
+SpectrumValueTemporariesTestCase::DoRun()
+{
+    auto model = Create<SpectrumModel>(std::vector<double>{1, 2, 3, 4, 5});
+    SpectrumValue v1(model);
+    SpectrumValue v2(model);
+    for (uint32_t i = 0; i < v1.GetValuesN(); i++)
+    {
+        v1[i] = 0.7 * (i + 1);
+        v2[i] = 1.3 / (i + 2);
+    }
+    double d = 0.9;
+    // copy into a temporary
+    auto t = [](const SpectrumValue& v) { return SpectrumValue(v); };
+
+    NS_TEST_EXPECT_MSG_EQ((t(v1) + v2 == v1 + v2), true, "Wrong temporary + value");
+    NS_TEST_EXPECT_MSG_EQ((v1 + t(v2) == v1 + v2), true, "Wrong value + temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) + t(v2) == v1 + v2), true, "Wrong temporary + temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) + d == v1 + d), true, "Wrong temporary + double");
+    NS_TEST_EXPECT_MSG_EQ((d + t(v1) == d + v1), true, "Wrong double + temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) - v2 == v1 - v2), true, "Wrong temporary - value");
+    NS_TEST_EXPECT_MSG_EQ((v1 - t(v2) == v1 - v2), true, "Wrong value - temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) - t(v2) == v1 - v2), true, "Wrong temporary - temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) - d == v1 - d), true, "Wrong temporary - double");
+    NS_TEST_EXPECT_MSG_EQ((d - t(v1) == d - v1), true, "Wrong double - temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) * v2 == v1 * v2), true, "Wrong temporary * value");
+    NS_TEST_EXPECT_MSG_EQ((v1 * t(v2) == v1 * v2), true, "Wrong value * temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) * t(v2) == v1 * v2), true, "Wrong temporary * temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) * d == v1 * d), true, "Wrong temporary * double");
+    NS_TEST_EXPECT_MSG_EQ((d * t(v1) == d * v1), true, "Wrong double * temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) / v2 == v1 / v2), true, "Wrong temporary / value");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) / t(v2) == v1 / v2), true, "Wrong temporary / temporary");
+    NS_TEST_EXPECT_MSG_EQ((t(v1) / d == v1 / d), true, "Wrong temporary / double");
+    NS_TEST_EXPECT_MSG_EQ((d / t(v1) == d / v1), true, "Wrong double / temporary");
+    NS_TEST_EXPECT_MSG_EQ((-t(v1) == -v1), true, "Wrong - temporary");
+    NS_TEST_EXPECT_MSG_EQ(((v1 + v2) * v1 - v2 / d == t(t(v1 + v2) * v1) - t(v2 / d)),
+                          true,
+                          "Wrong chain of temporaries");
+
+    SpectrumValue copy(v1);
+    NS_TEST_EXPECT_MSG_EQ((copy == v1), true, "Wrong copy");
+    SpectrumValue moved(std::move(copy));
+    NS_TEST_EXPECT_MSG_EQ((moved == v1), true, "Wrong move");
+    NS_TEST_EXPECT_MSG_EQ(copy.GetValuesN(), 0, "Values left in a moved SpectrumValue");
+    SpectrumValue other(Create<SpectrumModel>(std::vector<double>{1, 2, 3}));
+    other = v2;
+    NS_TEST_EXPECT_MSG_EQ((other == v2), true, "Wrong copy assignment");
+    NS_TEST_EXPECT_MSG_EQ(other.GetSpectrumModel(), model, "Wrong copied SpectrumModel");
+    other = std::move(moved);
+    NS_TEST_EXPECT_MSG_EQ((other == v1), true, "Wrong move assignment");
+
+    const double* storage;
+    {
+        SpectrumValue released(model);
+        released = 5;
+        storage = released.GetValues().data();
+    }
+    SpectrumValue reused(model);
+    NS_TEST_EXPECT_MSG_EQ(reused.GetValues().data(), storage, "Storage not reused");
+    NS_TEST_EXPECT_MSG_EQ(Norm(reused), 0, "Reused storage not initialized to zero");
+}
+
 /**
  * @ingroup spectrum-tests
  *
@@ -265,6 +352,8 @@ SpectrumValueTestSuite::SpectrumValueTestSuite()
     tv1rs3 = v1 >> 3;
     AddTestCase(new SpectrumValueTestCase(tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"),
                 TestCase::Duration::QUICK);
+
+    AddTestCase(new SpectrumValueTemporariesTestCase, TestCase::Duration::QUICK);
 }
 
 /**
@@ -6,6 +6,7 @@
 
 #include "ns3/abort.h"
 #include "ns3/angles.h"
+#include "ns3/boolean.h"
 #include "ns3/channel-condition-model.h"
 #include "ns3/config.h"
 #include "ns3/constant-position-mobility-model.h"
@@ -996,6 +997,9 @@ ThreeGppSpectrumPropagationLossModelTest::DoRun()
  * Matrix dimension of the resulting matrix are gNBports = 1, UE ports = 1, num Clusters.
  * This long term channel matrix is called matrixC.
  * 5) Checks that matrixB and matrixC are identical.
+ * 6) Checks that the long term channel matrices of dual-polarized arrays with
+ * multiple vertical and horizontal ports are those computed port by port and
+ * cluster by cluster.
  */
 class ThreeGppCalcLongTermMultiPortTest : public TestCase
 {
@@ -1182,6 +1186,75 @@ ThreeGppCalcLongTermMultiPortTest::DoRun()
                           true,
                           "Matrix B and Matrix C should be equal.");
 
+    // create dual-polarized tx and rx antennas with multiple vertical and
+    // horizontal ports
+    Ptr<PhasedArrayModel> txAntenna4 = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(8),
+        "NumRows",
+        UintegerValue(4),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()),
+        "NumVerticalPorts",
+        UintegerValue(2),
+        "NumHorizontalPorts",
+        UintegerValue(2),
+        "IsDualPolarized",
+        BooleanValue(true));
+
+    Ptr<PhasedArrayModel> rxAntenna4 = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(4),
+        "NumRows",
+        UintegerValue(2),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()),
+        "NumVerticalPorts",
+        UintegerValue(1),
+        "NumHorizontalPorts",
+        UintegerValue(2),
+        "IsDualPolarized",
+        BooleanValue(true));
+
+    txAntenna4->SetBeamformingVector(txAntenna4->GetBeamformingVector(completeAngleTxRx));
+    rxAntenna4->SetBeamformingVector(rxAntenna4->GetBeamformingVector(completeAngleRxTx));
+
+    Ptr<const ThreeGppChannelModel::ChannelMatrix> channelMatrixM4 =
+        channelModel->GetChannel(txMob, rxMob, txAntenna4, rxAntenna4);
+    Ptr<const MatrixBasedChannelModel::Complex3DVector> matrixD =
+        threeGppSplm->CalcLongTerm(channelMatrixM4, txAntenna4, rxAntenna4);
+
+    NS_TEST_ASSERT_MSG_EQ(matrixD->GetNumRows(),
+                          rxAntenna4->GetNumPorts(),
+                          "Wrong number of rows of matrix D");
+    NS_TEST_ASSERT_MSG_EQ(matrixD->GetNumCols(),
+                          txAntenna4->GetNumPorts(),
+                          "Wrong number of columns of matrix D");
+    NS_TEST_ASSERT_MSG_EQ(matrixD->GetNumPages(),
+                          channelMatrixM4->m_channel.GetNumPages(),
+                          "Wrong number of pages of matrix D");
+    for (uint16_t sPortIdx = 0; sPortIdx < txAntenna4->GetNumPorts(); sPortIdx++)
+    {
+        for (uint16_t uPortIdx = 0; uPortIdx < rxAntenna4->GetNumPorts(); uPortIdx++)
+        {
+            for (uint16_t cIndex = 0; cIndex < matrixD->GetNumPages(); cIndex++)
+            {
+                std::complex<double> component =
+                    threeGppSplm->CalculateLongTermComponent(channelMatrixM4,
+                                                             txAntenna4,
+                                                             rxAntenna4,
+                                                             sPortIdx,
+                                                             uPortIdx,
+                                                             cIndex);
+                NS_TEST_EXPECT_MSG_LT(std::abs((*matrixD)(uPortIdx, sPortIdx, cIndex) - component),
+                                      1e-9 * std::max(1.0, std::abs(component)),
+                                      "Wrong long term from port " << sPortIdx << " to port "
+                                                                   << uPortIdx << " of cluster "
+                                                                   << cIndex);
+            }
+        }
+    }
+
     Simulator::Run();
     Simulator::Destroy();
 }
@@ -1430,6 +1503,260 @@ ThreeGppMimoPolarizationTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * @ingroup spectrum-tests
+ *
+ * Test case for the batch generation of the channel matrices of the
+ * ThreeGppChannelModel class. The channels between two BSs and four UTs
+ * are generated, then looked up before the update period is exceeded, then
+ * updated:
+ * - with GetChannel for each pair of devices in turn;
+ * - with GenerateChannels, by one or several threads;
+ * - with GetChannel and BatchUpdate, by one or several threads.
+ * It checks that the channel matrices are updated when expected, and that
+ * they are the same in all the cases.
+ */
+class ThreeGppChannelBatchTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelBatchTest();
+
+  private:
+    /// How the channel matrices are generated
+    enum Mode
+    {
+        SEQUENTIAL,     //!< with GetChannel
+        EXPLICIT_BATCH, //!< with GenerateChannels, then GetChannel
+        BATCH_UPDATE,   //!< with GetChannel and BatchUpdate
+    };
+
+    /**
+     * Build the scenario and generate the channel matrices.
+     * @param mode how the channel matrices are generated
+     * @param nThreads the number of threads
+     * @return the channel matrices returned by GetChannel, in order
+     */
+    std::vector<MatrixBasedChannelModel::Complex3DVector> GenerateChannels(Mode mode,
+                                                                           uint32_t nThreads);
+
+    void DoRun() override;
+};
+
+ThreeGppChannelBatchTest::ThreeGppChannelBatchTest()
+    : TestCase("Check the batch generation of the channel matrices of ThreeGppChannelModel")
+{
+}
+
+std::vector<MatrixBasedChannelModel::Complex3DVector>
+ThreeGppChannelBatchTest::GenerateChannels(Mode mode, uint32_t nThreads)
+{
+    uint32_t updatePeriodMs = 100; // update period in ms
+
+    Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel>();
+    channelModel->SetAttribute("Frequency", DoubleValue(28.0e9));
+    channelModel->SetAttribute("Scenario", StringValue("UMa"));
+    channelModel->SetAttribute("ChannelConditionModel",
+                               PointerValue(CreateObject<AlwaysLosChannelConditionModel>()));
+    channelModel->SetAttribute("UpdatePeriod", TimeValue(MilliSeconds(updatePeriodMs)));
+    channelModel->SetAttribute("BatchUpdate", BooleanValue(mode == BATCH_UPDATE));
+    channelModel->SetAttribute("BatchThreads", UintegerValue(nThreads));
+    channelModel->AssignStreams(1);
+
+    // create two BSs and four UTs, with their mobility models and antennas
+    NodeContainer nodes;
+    nodes.Create(6);
+    std::vector<Ptr<MobilityModel>> mobs;
+    std::vector<Ptr<PhasedArrayModel>> antennas;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        bool isBs = (i < 2);
+        Ptr<MobilityModel> mob = CreateObject<ConstantPositionMobilityModel>();
+        mob->SetPosition(isBs ? Vector(200.0 * i, 0.0, 25.0)
+                              : Vector(60.0 * i, 40.0 * i - 150.0, 1.5));
+        nodes.Get(i)->AggregateObject(mob);
+        mobs.push_back(mob);
+        antennas.push_back(CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(isBs ? 4 : 2),
+            "NumRows",
+            UintegerValue(isBs ? 2 : 1),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>())));
+    }
+    std::vector<ThreeGppChannelModel::ChannelPair> pairs;
+    for (uint32_t bs = 0; bs < 2; bs++)
+    {
+        for (uint32_t ut = 2; ut < nodes.GetN(); ut++)
+        {
+            pairs.push_back({mobs[bs], mobs[ut], antennas[bs], antennas[ut]});
+        }
+    }
+    // a channel looked up from its other end
+    pairs.push_back({mobs[3], mobs[0], antennas[3], antennas[0]});
+
+    std::vector<MatrixBasedChannelModel::Complex3DVector> channels;
+    auto getChannels = [&](Time generatedTime, bool batch) {
+        if (mode == EXPLICIT_BATCH)
+        {
+            channelModel->GenerateChannels(pairs);
+        }
+        for (std::size_t i = 0; i < pairs.size(); i++)
+        {
+            const auto& pair = pairs[i];
+            Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix =
+                channelModel->GetChannel(pair.aMob, pair.bMob, pair.aAntenna, pair.bAntenna);
+            NS_TEST_EXPECT_MSG_EQ(channelMatrix->m_generatedTime,
+                                  generatedTime,
+                                  "Wrong generation time of a channel matrix");
+            channels.push_back(channelMatrix->m_channel);
+            if (i == 0)
+            {
+                // check if the first lookup generated the channels of all the pairs
+                bool allGenerated = true;
+                for (const auto& other : pairs)
+                {
+                    Ptr<const MatrixBasedChannelModel::ChannelParams> params =
+                        channelModel->GetParams(other.aMob, other.bMob);
+                    allGenerated &= (params && params->m_generatedTime == generatedTime);
+                }
+                NS_TEST_EXPECT_MSG_EQ(allGenerated,
+                                      batch,
+                                      "Wrong generation of the channels in batch");
+            }
+        }
+    };
+
+    // generate the channel matrices, look them up before the update period is
+    // exceeded, then when it is exceeded
+    Time firstTime = MilliSeconds(1);
+    Time updateTime = firstTime + MilliSeconds(updatePeriodMs + 1);
+    Simulator::Schedule(firstTime, [&]() { getChannels(firstTime, mode == EXPLICIT_BATCH); });
+    Simulator::Schedule(firstTime + MilliSeconds(updatePeriodMs / 2),
+                        [&]() { getChannels(firstTime, true); });
+    Simulator::Schedule(updateTime, [&]() { getChannels(updateTime, mode != SEQUENTIAL); });
+    Simulator::Run();
+    Simulator::Destroy();
+    return channels;
+}
+
+void
+ThreeGppChannelBatchTest::DoRun()
+{
+    auto expected = GenerateChannels(SEQUENTIAL, 1);
+    NS_TEST_ASSERT_MSG_EQ(expected.size(), 27, "Wrong number of channel matrices");
+    NS_TEST_EXPECT_MSG_EQ((expected[0] != expected[18]),
+                          true,
+                          "The channel matrix should have been updated");
+
+    for (auto mode : {EXPLICIT_BATCH, BATCH_UPDATE})
+    {
+        for (uint32_t nThreads : {1, 4})
+        {
+            auto channels = GenerateChannels(mode, nThreads);
+            NS_TEST_ASSERT_MSG_EQ(channels.size(),
+                                  expected.size(),
+                                  "Wrong number of channel matrices");
+            for (std::size_t i = 0; i < expected.size(); i++)
+            {
+                NS_TEST_EXPECT_MSG_EQ((channels[i] == expected[i]),
+                                      true,
+                                      "Different channel matrix " << i << " in mode " << mode
+                                                                  << " with " << nThreads
+                                                                  << " threads");
+            }
+        }
+    }
+}
+
+/**
+ * @ingroup spectrum-tests
+ *
+ * Test case for the pruning of the pairs of devices served with batch
+ * updates by the ThreeGppChannelModel class. The channels between a BS and
+ * two UTs are looked up at every update period, until the second UT is no
+ * longer looked up. It checks that the channel of the second UT is
+ * regenerated once more, by the batch update following its last lookup,
+ * and then no longer.
+ */
+class ThreeGppChannelBatchPruneTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelBatchPruneTest();
+
+  private:
+    void DoRun() override;
+};
+
+ThreeGppChannelBatchPruneTest::ThreeGppChannelBatchPruneTest()
+    : TestCase("Check the pruning of the pairs served with batch updates by ThreeGppChannelModel")
+{
+}
+
+void
+ThreeGppChannelBatchPruneTest::DoRun()
+{
+    uint32_t updatePeriodMs = 100; // update period in ms
+
+    Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel>();
+    channelModel->SetAttribute("Frequency", DoubleValue(28.0e9));
+    channelModel->SetAttribute("Scenario", StringValue("UMa"));
+    channelModel->SetAttribute("ChannelConditionModel",
+                               PointerValue(CreateObject<AlwaysLosChannelConditionModel>()));
+    channelModel->SetAttribute("UpdatePeriod", TimeValue(MilliSeconds(updatePeriodMs)));
+    channelModel->SetAttribute("BatchUpdate", BooleanValue(true));
+    channelModel->AssignStreams(1);
+
+    // create a BS and two UTs, with their mobility models and antennas
+    NodeContainer nodes;
+    nodes.Create(3);
+    std::vector<Ptr<MobilityModel>> mobs;
+    std::vector<Ptr<PhasedArrayModel>> antennas;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<MobilityModel> mob = CreateObject<ConstantPositionMobilityModel>();
+        mob->SetPosition(i == 0 ? Vector(0.0, 0.0, 25.0) : Vector(50.0 * i, 30.0, 1.5));
+        nodes.Get(i)->AggregateObject(mob);
+        mobs.push_back(mob);
+        antennas.push_back(CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(2),
+            "NumRows",
+            UintegerValue(1),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>())));
+    }
+
+    // look up the channel of the first UT, and of the second one if
+    // requested, then check when the channel of the second UT was generated
+    auto lookup = [&](bool second, Time expected) {
+        channelModel->GetChannel(mobs[0], mobs[1], antennas[0], antennas[1]);
+        if (second)
+        {
+            channelModel->GetChannel(mobs[0], mobs[2], antennas[0], antennas[2]);
+        }
+        NS_TEST_EXPECT_MSG_EQ(channelModel->GetParams(mobs[0], mobs[2])->m_generatedTime,
+                              expected,
+                              "Wrong generation time of the channel of the second UT at "
+                                  << Simulator::Now().As(Time::MS));
+    };
+
+    // the second UT is looked up until the second period
+    Time period = MilliSeconds(updatePeriodMs + 1);
+    Simulator::Schedule(period * 0, [&]() { lookup(true, Seconds(0)); });
+    Simulator::Schedule(period * 1, [&]() { lookup(true, period * 1); });
+    Simulator::Schedule(period * 2, [&]() { lookup(false, period * 2); });
+    Simulator::Schedule(period * 3, [&]() { lookup(false, period * 2); });
+    Simulator::Schedule(period * 4, [&]() { lookup(false, period * 2); });
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
 /**
  * @ingroup spectrum-tests
  *
@@ -1457,6 +1784,8 @@ ThreeGppChannelTestSuite::ThreeGppChannelTestSuite()
     AddTestCase(new ThreeGppChannelMatrixUpdateTest(2, 4, 2, 2), TestCase::Duration::QUICK);
     AddTestCase(new ThreeGppChannelMatrixUpdateTest(2, 2, 2, 2), TestCase::Duration::QUICK);
     AddTestCase(new ThreeGppAntennaSetupChangedTest(), TestCase::Duration::QUICK);
+    AddTestCase(new ThreeGppChannelBatchTest(), TestCase::Duration::QUICK);
+    AddTestCase(new ThreeGppChannelBatchPruneTest(), TestCase::Duration::QUICK);
     AddTestCase(new ThreeGppSpectrumPropagationLossModelTest(4, 4, 1, 1),
                 TestCase::Duration::QUICK);
     AddTestCase(new ThreeGppSpectrumPropagationLossModelTest(4, 4, 2, 2),
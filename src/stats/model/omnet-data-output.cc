@@ -13,9 +13,12 @@
 
 #include "ns3/log.h"
 #include "ns3/nstime.h"
+#include "ns3/simulation-replications.h"
 
 #include <cstdlib>
 #include <fstream>
+#include <map>
+#include <sstream>
 
 using namespace ns3;
 
@@ -92,7 +95,9 @@ OmnetDataOutput::Output(DataCollector& dc)
     NS_LOG_FUNCTION(this << &dc);
 
     std::ofstream scalarFile;
-    std::string fn = m_filePrefix + "-" + dc.GetRunLabel() + ".sca";
+    std::string fn = SimulationReplications::GetOutputFileName(
+        "OmnetDataOutput",
+        m_filePrefix + "-" + dc.GetRunLabel() + ".sca");
     scalarFile.open(fn, std::ios_base::out);
 
     /// @todo add timestamp to the runlevel
@@ -135,6 +140,142 @@ OmnetDataOutput::Output(DataCollector& dc)
     // end OmnetDataOutput::Output
 }
 
+/**
+ * Split a line of a scalar file into its words, keeping the quoted
+ * strings together.
+ *
+ * @param line The line.
+ * @returns The words of the line.
+ */
+static std::vector<std::string>
+SplitScalarLine(const std::string& line)
+{
+    std::vector<std::string> words;
+    std::string word;
+    bool quoted = false;
+    for (char c : line)
+    {
+        if (c == '"')
+        {
+            quoted = !quoted;
+        }
+        if (c == ' ' && !quoted)
+        {
+            if (!word.empty())
+            {
+                words.push_back(word);
+                word.clear();
+            }
+            continue;
+        }
+        word += c;
+    }
+    if (!word.empty())
+    {
+        words.push_back(word);
+    }
+    return words;
+}
+
+void
+OmnetDataOutput::MergeReplications(const std::string& output,
+                                   const std::vector<std::string>& inputs)
+{
+    NS_LOG_FUNCTION(output << inputs.size());
+
+    std::vector<std::string> header;
+    std::vector<std::string> keys;
+    std::map<std::string, std::vector<double>> values;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::ifstream is(inputs[i]);
+        std::string line;
+        std::string statistic;
+        while (std::getline(is, line))
+        {
+            std::vector<std::string> words = SplitScalarLine(line);
+            if (words.empty())
+            {
+                continue;
+            }
+            std::string key;
+            std::string value;
+            if ((words[0] == "run" || words[0] == "attr") && i == 0)
+            {
+                header.push_back(line);
+            }
+            else if (words[0] == "scalar" && words.size() == 4)
+            {
+                key = words[1] + " " + words[2];
+                value = words[3];
+            }
+            else if (words[0] == "statistic" && words.size() == 3)
+            {
+                statistic = words[1] + " " + words[2];
+            }
+            else if (words[0] == "field" && words.size() == 3 && !statistic.empty())
+            {
+                // Name the field inside the quotes of the statistic name
+                bool quoted = statistic.back() == '"';
+                key = statistic.substr(0, statistic.size() - quoted) + "." + words[1] +
+                      (quoted ? "\"" : "");
+                value = words[2];
+            }
+            if (key.empty())
+            {
+                continue;
+            }
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+            {
+                value = value.substr(1, value.size() - 2);
+            }
+            char* end;
+            double number = std::strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0')
+            {
+                continue;
+            }
+            auto [it, inserted] = values.emplace(key, std::vector<double>());
+            if (inserted)
+            {
+                keys.push_back(key);
+            }
+            it->second.push_back(number);
+        }
+    }
+
+    std::ofstream os(output);
+    os.precision(12);
+    for (const auto& line : header)
+    {
+        os << line << std::endl;
+    }
+    os << "attr replications " << inputs.size() << std::endl << std::endl;
+    for (const auto& key : keys)
+    {
+        auto summary = SimulationReplications::Summarize(values[key]);
+        os << "statistic " << key << std::endl;
+        os << "field count " << summary.count << std::endl;
+        os << "field mean " << summary.mean << std::endl;
+        os << "field stddev " << summary.stddev << std::endl;
+        os << "field min " << summary.min << std::endl;
+        os << "field max " << summary.max << std::endl;
+        os << "field ci95 " << summary.halfWidth << std::endl;
+    }
+    os << std::endl;
+}
+
+/**
+ * Register the merger of the scalar files of the replications.
+ */
+static struct OmnetDataOutputMergerRegistration
+{
+    OmnetDataOutputMergerRegistration()
+    {
+        SimulationReplications::AddMerger("OmnetDataOutput", &OmnetDataOutput::MergeReplications);
+    }
+} g_omnetDataOutputMergerRegistration; //!< Static variable for registration
+
 OmnetDataOutput::OmnetOutputCallback::OmnetOutputCallback(std::ostream* scalar)
     : m_scalar(scalar)
 {
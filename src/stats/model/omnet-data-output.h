@@ -13,6 +13,9 @@
 
 #include "ns3/nstime.h"
 
+#include <string>
+#include <vector>
+
 namespace ns3
 {
 
@@ -38,6 +41,22 @@ class OmnetDataOutput : public DataOutputInterface
 
     void Output(DataCollector& dc) override;
 
+    /**
+     * Merge the scalar files written by the replications of a simulation.
+     *
+     * Each scalar, and each field of each statistic, of the input files
+     * becomes a statistic of the merged file, with the count, mean,
+     * standard deviation, minimum, maximum and the half width of the 95%
+     * confidence interval ("ci95" field) of its values across the
+     * replications.  The run attributes are copied from the first file.
+     *
+     * @param output The name of the merged file.
+     * @param inputs The names of the files of the replications.
+     * @see SimulationReplications
+     */
+    static void MergeReplications(const std::string& output,
+                                  const std::vector<std::string>& inputs);
+
   protected:
     void DoDispose() override;
 
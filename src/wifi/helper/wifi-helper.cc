@@ -152,6 +152,62 @@ AsciiPhyReceiveSinkWithoutContext(Ptr<OutputStreamWrapper> stream,
                          << " " << fcs << std::endl;
 }
 
+/**
+ * Binary trace PHY transmit sink
+ * @param file the binary trace writer
+ * @param node the identifier of the node
+ * @param device the index of the device in the node
+ * @param p the packet
+ * @param mode the wifi mode
+ * @param preamble the wifi preamble
+ * @param txLevel the transmit power level
+ */
+static void
+BinaryPhyTransmitSink(Ptr<BinaryTraceWriter> file,
+                      uint32_t node,
+                      uint32_t device,
+                      Ptr<const Packet> p,
+                      WifiMode mode,
+                      WifiPreamble preamble,
+                      uint8_t txLevel)
+{
+    NS_LOG_FUNCTION(file << node << device << p << mode << preamble << txLevel);
+    file->Write(Simulator::Now(),
+                node,
+                device,
+                BinaryTraceRecord::TRANSMIT,
+                p->GetUid(),
+                p->GetSize());
+}
+
+/**
+ * Binary trace PHY receive sink
+ * @param file the binary trace writer
+ * @param node the identifier of the node
+ * @param device the index of the device in the node
+ * @param p the packet
+ * @param snr the SNR
+ * @param mode the wifi mode
+ * @param preamble the wifi preamble
+ */
+static void
+BinaryPhyReceiveSink(Ptr<BinaryTraceWriter> file,
+                     uint32_t node,
+                     uint32_t device,
+                     Ptr<const Packet> p,
+                     double snr,
+                     WifiMode mode,
+                     WifiPreamble preamble)
+{
+    NS_LOG_FUNCTION(file << node << device << p << snr << mode << preamble);
+    file->Write(Simulator::Now(),
+                node,
+                device,
+                BinaryTraceRecord::RECEIVE,
+                p->GetUid(),
+                p->GetSize());
+}
+
 WifiPhyHelper::WifiPhyHelper(uint8_t nLinks)
     : m_pcapDlt{PcapHelper::DLT_IEEE802_11},
       m_pcapType{PcapCaptureType::PCAP_PER_PHY}
@@ -958,6 +1014,40 @@ WifiPhyHelper::EnableAsciiInternal(Ptr<OutputStreamWrapper> stream,
     Config::Connect(oss.str(), MakeBoundCallback(&AsciiPhyTransmitSinkWithContext, stream));
 }
 
+void
+WifiPhyHelper::EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd)
+{
+    Ptr<WifiNetDevice> device = nd->GetObject<WifiNetDevice>();
+    if (!device)
+    {
+        NS_LOG_INFO("WifiHelper::EnableBinaryInternal(): Device "
+                    << device << " not of type ns3::WifiNetDevice");
+        return;
+    }
+
+    // The same events as the ASCII traces, for all the links, in a single
+    // file: the records do not tell the links apart.
+    uint32_t nodeid = nd->GetNode()->GetId();
+    uint32_t deviceid = nd->GetIfIndex();
+    std::ostringstream oss;
+    for (uint8_t linkId = 0; linkId < device->GetNPhys(); linkId++)
+    {
+        oss.str("");
+        oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid
+            << "/$ns3::WifiNetDevice/Phys/" << +linkId << "/State/RxOk";
+        Config::ConnectWithoutContext(
+            oss.str(),
+            MakeBoundCallback(&BinaryPhyReceiveSink, file, nodeid, deviceid));
+
+        oss.str("");
+        oss << "/NodeList/" << nodeid << "/DeviceList/" << deviceid
+            << "/$ns3::WifiNetDevice/Phys/" << +linkId << "/State/Tx";
+        Config::ConnectWithoutContext(
+            oss.str(),
+            MakeBoundCallback(&BinaryPhyTransmitSink, file, nodeid, deviceid));
+    }
+}
+
 WifiHelper::~WifiHelper()
 {
 }
@@ -35,7 +35,9 @@ class QueueItem;
  * This base class must be implemented by new PHY implementation which wish to integrate
  * with the \ref ns3::WifiHelper class.
  */
-class WifiPhyHelper : public PcapHelperForDevice, public AsciiTraceHelperForDevice
+class WifiPhyHelper : public PcapHelperForDevice,
+                      public AsciiTraceHelperForDevice,
+                      public BinaryTraceHelperForDevice
 {
   public:
     /**
@@ -381,6 +383,17 @@ class WifiPhyHelper : public PcapHelperForDevice, public AsciiTraceHelperForDevi
                              Ptr<NetDevice> nd,
                              bool explicitFilename) override;
 
+    /**
+     * @brief Enable binary trace output on the indicated net device.
+     *
+     * NetDevice-specific implementation mechanism for hooking the trace and
+     * writing to the trace file.
+     *
+     * @param file The binary trace writer.
+     * @param nd Net device for which you want to enable tracing.
+     */
+    void EnableBinaryInternal(Ptr<BinaryTraceWriter> file, Ptr<NetDevice> nd) override;
+
     PcapHelper::DataLinkType m_pcapDlt; ///< PCAP data link type
     PcapCaptureType m_pcapType;         ///< PCAP capture type
 };
@@ -14,6 +14,8 @@
 #include "wifi-utils.h"
 #include "yans-wifi-phy.h"
 
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/node.h"
@@ -22,6 +24,9 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/simulator.h"
 
+#include <limits>
+#include <numeric>
+
 namespace ns3
 {
 
@@ -46,7 +51,24 @@ YansWifiChannel::GetTypeId()
                           "A pointer to the propagation delay model attached to this channel.",
                           PointerValue(),
                           MakePointerAccessor(&YansWifiChannel::m_delay),
-                          MakePointerChecker<PropagationDelayModel>());
+                          MakePointerChecker<PropagationDelayModel>())
+            .AddAttribute("ReceiverCulling",
+                          "If true, the PHYs too far to receive a PPDU above the "
+                          "ReceiverCullingFloor, according to the propagation loss model, "
+                          "are skipped instead of being scheduled a reception. "
+                          "This requires a ConstantSpeedPropagationDelayModel.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&YansWifiChannel::m_receiverCulling),
+                          MakeBooleanChecker())
+            .AddAttribute("ReceiverCullingFloor",
+                          "The RX power (dBm) below which the PHYs are skipped, if "
+                          "ReceiverCulling is true. It must not be above the RxSensitivity "
+                          "minus the RxGain of any PHY, lowered by 10 log10(20/width) for "
+                          "the PPDUs of channel width below 20 MHz, for the receptions to "
+                          "be unchanged.",
+                          DoubleValue(-101.0),
+                          MakeDoubleAccessor(&YansWifiChannel::m_receiverCullingFloor),
+                          MakeDoubleChecker<dBm_u>());
     return tid;
 }
 
@@ -81,8 +103,25 @@ YansWifiChannel::Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, dBm_u t
     NS_LOG_FUNCTION(this << sender << ppdu << txPower);
     Ptr<MobilityModel> senderMobility = sender->GetMobility();
     NS_ASSERT(senderMobility);
-    for (auto i = m_phyList.begin(); i != m_phyList.end(); i++)
+    // the receivers are visited in the order of the list, so that the
+    // receptions are scheduled in the same order whether culled or not
+    std::vector<uint32_t> receivers(m_phyList.size());
+    double range = GetReceiverCullingRange(txPower);
+    if (range < std::numeric_limits<double>::infinity())
+    {
+        while (m_receiverIndex.GetN() < m_phyList.size())
+        {
+            m_receiverIndex.Add(m_phyList[m_receiverIndex.GetN()]->GetMobility());
+        }
+        m_receiverIndex.GetCandidates(senderMobility->GetPosition(), range, receivers);
+    }
+    else
+    {
+        std::iota(receivers.begin(), receivers.end(), 0);
+    }
+    for (uint32_t receiver : receivers)
     {
+        auto i = m_phyList.begin() + receiver;
         if (sender != (*i))
         {
             // For now don't account for inter channel interference nor channel bonding
@@ -139,6 +178,16 @@ YansWifiChannel::Receive(Ptr<YansWifiPhy> phy, Ptr<const WifiPpdu> ppdu, dBm_u r
     phy->StartReceivePreamble(ppdu, rxPowerW, ppdu->GetTxDuration());
 }
 
+double
+YansWifiChannel::GetReceiverCullingRange(dBm_u txPower) const
+{
+    if (!m_receiverCulling || !DynamicCast<ConstantSpeedPropagationDelayModel>(m_delay))
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return m_loss->GetRange(txPower, m_receiverCullingFloor);
+}
+
 std::size_t
 YansWifiChannel::GetNDevices() const
 {
@@ -12,6 +12,7 @@
 #include "wifi-units.h"
 
 #include "ns3/channel.h"
+#include "ns3/receiver-spatial-index.h"
 
 namespace ns3
 {
@@ -32,6 +33,13 @@ class WifiPpdu;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * If the ReceiverCulling attribute is true, the PHYs that are too far
+ * for the PPDU to reach them above ReceiverCullingFloor, according to
+ * PropagationLossModel::GetRange, are skipped.  They are found from a
+ * ns3::ReceiverSpatialIndex of the PHYs.  The culling requires a
+ * ns3::ConstantSpeedPropagationDelayModel, so that the delays of the
+ * other PHYs do not change.
  */
 class YansWifiChannel : public Channel
 {
@@ -104,9 +112,19 @@ class YansWifiChannel : public Channel
      */
     static void Receive(Ptr<YansWifiPhy> receiver, Ptr<const WifiPpdu> ppdu, dBm_u txPower);
 
+    /**
+     * @param txPower the TX power of a PPDU
+     * @returns the distance beyond which the PPDU is received below
+     * ReceiverCullingFloor, or infinity if the PHYs must not be culled
+     */
+    double GetReceiverCullingRange(dBm_u txPower) const;
+
     PhyList m_phyList;                  //!< List of YansWifiPhys connected to this YansWifiChannel
     Ptr<PropagationLossModel> m_loss;   //!< Propagation loss model
     Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model
+    bool m_receiverCulling;             //!< Whether the PHYs out of range are skipped
+    dBm_u m_receiverCullingFloor;       //!< The RX power below which the PHYs are skipped
+    mutable ReceiverSpatialIndex m_receiverIndex; //!< The index of the positions of the PHYs
 };
 
 } // namespace ns3
@@ -0,0 +1,161 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// This program can be used to benchmark the beamforming gain applied by the
+// ThreeGppSpectrumPropagationLossModel to the signals between two uniform
+// planar arrays of 'rows' x 'columns' elements, over 'rbs' resource blocks.
+// The signals are received with fixed beams, so that the long term
+// component is computed once, then with beams alternating between two
+// directions, so that it is computed for every signal.  By default, 4x8 and
+// 8x16 arrays are benchmarked.
+// Sample usage:  ./ns3 run 'bench-beamforming --rows=8 --columns=16 --signals=1000'
+
+#include "ns3/channel-condition-model.h"
+#include "ns3/command-line.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/isotropic-antenna-model.h"
+#include "ns3/node-container.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/string.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/three-gpp-spectrum-propagation-loss-model.h"
+#include "ns3/uinteger.h"
+#include "ns3/uniform-planar-array.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Time the reception of signals through a ThreeGppSpectrumPropagationLossModel.
+ *
+ * @param rows The number of rows of the arrays.
+ * @param columns The number of columns of the arrays.
+ * @param rbs The number of resource blocks of the signals.
+ * @param signals The number of signals received with fixed and with
+ * alternating beams.
+ */
+void
+RunBench(uint32_t rows, uint32_t columns, uint32_t rbs, uint32_t signals)
+{
+    Ptr<ThreeGppSpectrumPropagationLossModel> lossModel =
+        CreateObject<ThreeGppSpectrumPropagationLossModel>();
+    lossModel->SetChannelModelAttribute("Frequency", DoubleValue(28.0e9));
+    lossModel->SetChannelModelAttribute("Scenario", StringValue("UMa"));
+    lossModel->SetChannelModelAttribute(
+        "ChannelConditionModel",
+        PointerValue(CreateObject<AlwaysLosChannelConditionModel>()));
+
+    // a BS and a moving UT, with their arrays pointing to each other
+    NodeContainer nodes;
+    nodes.Create(2);
+    std::vector<Ptr<ConstantVelocityMobilityModel>> mobs;
+    std::vector<Ptr<PhasedArrayModel>> antennas;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<ConstantVelocityMobilityModel> mob = CreateObject<ConstantVelocityMobilityModel>();
+        nodes.Get(i)->AggregateObject(mob);
+        mobs.push_back(mob);
+        antennas.push_back(CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(columns),
+            "NumRows",
+            UintegerValue(rows),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>())));
+    }
+    mobs[0]->SetPosition(Vector(0.0, 0.0, 25.0));
+    mobs[1]->SetPosition(Vector(100.0, 50.0, 1.5));
+    mobs[1]->SetVelocity(Vector(10.0, 0.0, 0.0));
+    Angles bsToUt(mobs[1]->GetPosition(), mobs[0]->GetPosition());
+    Angles utToBs(mobs[0]->GetPosition(), mobs[1]->GetPosition());
+    std::vector<PhasedArrayModel::ComplexVector> bsBeams = {
+        antennas[0]->GetBeamformingVector(bsToUt),
+        antennas[0]->GetBeamformingVector(
+            Angles(bsToUt.GetAzimuth() + 0.1, bsToUt.GetInclination()))};
+    antennas[0]->SetBeamformingVector(bsBeams[0]);
+    antennas[1]->SetBeamformingVector(antennas[1]->GetBeamformingVector(utToBs));
+
+    // resource blocks of 12 subcarriers of 30 kHz
+    Bands bands;
+    double rbWidth = 12 * 30e3;
+    for (uint32_t i = 0; i < rbs; i++)
+    {
+        double fl = 28.0e9 + i * rbWidth;
+        bands.push_back({fl, fl + rbWidth / 2, fl + rbWidth});
+    }
+    auto params = Create<SpectrumSignalParameters>();
+    params->psd = Create<SpectrumValue>(Create<SpectrumModel>(bands));
+    *params->psd = 1e-9;
+    params->duration = MilliSeconds(1);
+
+    // generate the channel matrix first
+    lossModel->CalcRxPowerSpectralDensity(params, mobs[0], mobs[1], antennas[0], antennas[1]);
+
+    SystemWallClockMs clock;
+    double sum = 0;
+    clock.Start();
+    for (uint32_t i = 0; i < signals; i++)
+    {
+        auto rxParams = lossModel->CalcRxPowerSpectralDensity(params,
+                                                              mobs[0],
+                                                              mobs[1],
+                                                              antennas[0],
+                                                              antennas[1]);
+        sum += (*rxParams->psd)[0];
+    }
+    int64_t ms = clock.End();
+    std::cout << rows << "x" << columns << " fixed beams: " << (ms * 1e6 / signals)
+              << " ns per signal" << std::endl;
+
+    clock.Start();
+    for (uint32_t i = 0; i < signals; i++)
+    {
+        antennas[0]->SetBeamformingVector(bsBeams[(i + 1) % 2]);
+        auto rxParams = lossModel->CalcRxPowerSpectralDensity(params,
+                                                              mobs[0],
+                                                              mobs[1],
+                                                              antennas[0],
+                                                              antennas[1]);
+        sum += (*rxParams->psd)[0];
+    }
+    ms = clock.End();
+    std::cout << rows << "x" << columns << " alternating beams: " << (ms * 1e6 / signals)
+              << " ns per signal (" << sum << ")" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t rows = 0;
+    uint32_t columns = 0;
+    uint32_t rbs = 100;
+    uint32_t signals = 1000;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the beamforming gain of the ThreeGppSpectrumPropagationLossModel");
+    cmd.AddValue("rows", "number of rows of the arrays, 0 for the 4x8 and 8x16 arrays", rows);
+    cmd.AddValue("columns", "number of columns of the arrays", columns);
+    cmd.AddValue("rbs", "number of resource blocks of the signals", rbs);
+    cmd.AddValue("signals", "number of signals received with each beam setup", signals);
+    cmd.Parse(argc, argv);
+
+    std::cout << "Running bench-beamforming with " << rbs << " resource blocks" << std::endl;
+    if (rows == 0)
+    {
+        RunBench(4, 8, rbs, signals);
+        RunBench(8, 16, rbs, signals);
+    }
+    else
+    {
+        RunBench(rows, columns == 0 ? rows : columns, rbs, signals);
+    }
+
+    Simulator::Destroy();
+    return 0;
+}
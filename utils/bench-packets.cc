@@ -11,6 +11,7 @@
 // Sample usage:  ./ns3 run 'bench-packets --n=10000'
 
 #include "ns3/command-line.h"
+#include "ns3/packet-allocator.h"
 #include "ns3/packet-metadata.h"
 #include "ns3/packet.h"
 #include "ns3/system-wall-clock-ms.h"
@@ -21,6 +22,7 @@
 #include <sstream>
 #include <stdlib.h> // for exit ()
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -321,6 +323,55 @@ benchFragment(uint32_t n)
     }
 }
 
+/**
+ * Create an aggregate of subframes, each one made of a header and of a
+ * payload without data, as in a Wi-Fi A-MSDU.
+ *
+ * @param nSubframes the number of subframes
+ * @returns the aggregate
+ */
+static Ptr<Packet>
+CreateAggregate(uint32_t nSubframes)
+{
+    BenchHeader<14> subframeHeader;
+    BenchHeader<8> udp;
+    BenchHeader<20> ipv4;
+    Ptr<Packet> aggregate = Create<Packet>();
+    for (uint32_t j = 0; j < nSubframes; j++)
+    {
+        Ptr<Packet> p = Create<Packet>(1472);
+        p->AddHeader(udp);
+        p->AddHeader(ipv4);
+        p->AddHeader(subframeHeader);
+        aggregate->AddAtEnd(p);
+    }
+    return aggregate;
+}
+
+static void
+benchAggregation(uint32_t n)
+{
+    const uint32_t nSubframes = 64;
+    BenchHeader<14> subframeHeader;
+    BenchHeader<8> udp;
+    BenchHeader<20> ipv4;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> aggregate = CreateAggregate(nSubframes);
+        uint32_t subframeSize = aggregate->GetSize() / nSubframes;
+
+        /* Split the aggregate into its subframes */
+        for (uint32_t j = 0; j < nSubframes; j++)
+        {
+            Ptr<Packet> p = aggregate->CreateFragment(j * subframeSize, subframeSize);
+            p->RemoveHeader(subframeHeader);
+            p->RemoveHeader(ipv4);
+            p->RemoveHeader(udp);
+        }
+    }
+}
+
 static void
 benchByteTags(uint32_t n)
 {
@@ -371,6 +422,7 @@ main(int argc, char* argv[])
     uint32_t n = 0;
     uint32_t minIterations = 1;
     bool enablePrinting = false;
+    bool compactPrinting = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark Packet class");
@@ -379,8 +431,20 @@ main(int argc, char* argv[])
                  "number of subiterations to minimize iteration time over",
                  minIterations);
     cmd.AddValue("enable-printing", "enable packet printing", enablePrinting);
+    cmd.AddValue("compact-printing",
+                 "enable packet printing, with the compact metadata",
+                 compactPrinting);
     cmd.Parse(argc, argv);
 
+    if (compactPrinting)
+    {
+        Packet::EnableCompactPrinting();
+    }
+    else if (enablePrinting)
+    {
+        Packet::EnablePrinting();
+    }
+
     if (n == 0)
     {
         std::cerr << "Error-- number of packets must be specified "
@@ -396,6 +460,18 @@ main(int argc, char* argv[])
     runBench(&benchD, n, minIterations, "Intermixed add/remove headers and tags");
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
+    runBench(&benchAggregation, n, minIterations, "Aggregation of 64 payloads without data");
+
+    // Memory used by aggregates in flight: the payloads are not allocated
+    std::vector<Ptr<Packet>> aggregates;
+    uint64_t bytesInUse = PacketAllocator::GetStatistics().bytesInUse;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        aggregates.push_back(CreateAggregate(64));
+    }
+    bytesInUse = PacketAllocator::GetStatistics().bytesInUse - bytesInUse;
+    std::cout << bytesInUse / aggregates.size() << " bytes per aggregate of "
+              << aggregates[0]->GetSize() << " bytes in flight" << std::endl;
 
     return 0;
 }
@@ -0,0 +1,151 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// This program can be used to benchmark the route lookups of the static
+// and global routing tables, for various numbers of routes 'routes'.
+// With 'linear', a route with a non-contiguous mask is added to the
+// static tables, so that they are searched linearly instead of by their
+// longest prefix match index.  With 'compact', the global routes are
+// stored in compact routing tables.
+// Sample usage:  ./ns3 run 'bench-routing --routes=10000 --lookups=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Time the lookups of a routing protocol.
+ *
+ * @tparam R The type of the routing protocol.
+ * @tparam H The type of the IP header.
+ * @tparam A The type of the addresses.
+ * @param routing The routing protocol.
+ * @param destinations The destinations looked up.
+ * @param lookups The number of lookups.
+ * @param name The name of the routing table.
+ */
+template <typename R, typename H, typename A>
+void
+RunBench(Ptr<R> routing, const std::vector<A>& destinations, uint32_t lookups, std::string name)
+{
+    SystemWallClockMs clock;
+    uint32_t found = 0;
+    H header;
+    Socket::SocketErrno sockerr;
+    clock.Start();
+    for (uint32_t i = 0; i < lookups; i++)
+    {
+        header.SetDestination(destinations[i % destinations.size()]);
+        found += routing->RouteOutput(nullptr, header, nullptr, sockerr) != nullptr;
+    }
+    int64_t ms = clock.End();
+    std::cout << name << ": " << (ms * 1e6 / lookups) << " ns per lookup, " << found << " of "
+              << lookups << " routes found" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nRoutes = 10000;
+    uint32_t lookups = 1000000;
+    bool linear = false;
+    bool compact = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the route lookups of the static and global routing tables");
+    cmd.AddValue("routes", "number of routes of each table", nRoutes);
+    cmd.AddValue("lookups", "number of lookups of each table", lookups);
+    cmd.AddValue("linear", "search the static tables linearly", linear);
+    cmd.AddValue("compact", "store the global routes in compact tables", compact);
+    cmd.Parse(argc, argv);
+
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    device->SetAddress(Mac48Address::Allocate());
+    node->AddDevice(device);
+
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    uint32_t interface = ipv4->AddInterface(device);
+    ipv4->AddAddress(interface, Ipv4InterfaceAddress("192.168.0.1", "255.255.0.0"));
+    ipv4->SetUp(interface);
+    Ptr<Ipv6> ipv6 = node->GetObject<Ipv6>();
+    interface = ipv6->AddInterface(device);
+    ipv6->AddAddress(interface, Ipv6InterfaceAddress("2001:db8::1", Ipv6Prefix(64)));
+    ipv6->SetUp(interface);
+
+    Ptr<Ipv4StaticRouting> staticRouting = Ipv4StaticRoutingHelper().GetStaticRouting(ipv4);
+    Ptr<Ipv4GlobalRouting> globalRouting =
+        Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(ipv4->GetRoutingProtocol());
+    globalRouting->SetCompactRoutes(compact);
+    Ptr<Ipv6StaticRouting> staticRouting6 = Ipv6StaticRoutingHelper().GetStaticRouting(ipv6);
+
+    // Routes to random networks of 10.0.0.0/8, of 16 to 32 bits, and the
+    // destinations in these networks
+    std::mt19937 rng(1);
+    std::vector<Ipv4Address> destinations;
+    std::vector<Ipv6Address> destinations6;
+    for (uint32_t i = 0; i < nRoutes; i++)
+    {
+        uint32_t length = 16 + rng() % 17;
+        uint32_t mask = 0xffffffff << (32 - length);
+        Ipv4Address network((0x0a000000 | (rng() & 0x00ffffff)) & mask);
+        Ipv4Address gateway(0xc0a80000 | (i & 0xffff));
+        staticRouting->AddNetworkRouteTo(network, Ipv4Mask(mask), gateway, 1);
+        if (length == 32)
+        {
+            globalRouting->AddHostRouteTo(network, gateway, 1);
+        }
+        else
+        {
+            globalRouting->AddNetworkRouteTo(network, Ipv4Mask(mask), gateway, 1);
+        }
+        destinations.emplace_back(network.Get() | (rng() & ~mask));
+
+        uint8_t bytes[16] = {0x20, 0x01, 0x0d, 0xb8};
+        for (uint32_t j = 4; j < 16; j++)
+        {
+            bytes[j] = rng();
+        }
+        Ipv6Prefix prefix(uint8_t(48 + rng() % 81));
+        staticRouting6->AddNetworkRouteTo(Ipv6Address(bytes).CombinePrefix(prefix),
+                                          prefix,
+                                          Ipv6Address("2001:db8::2"),
+                                          1);
+        destinations6.emplace_back(bytes);
+    }
+    staticRouting->SetDefaultRoute("192.168.0.2", 1);
+    staticRouting6->SetDefaultRoute("2001:db8::2", 1);
+    if (linear)
+    {
+        staticRouting->AddNetworkRouteTo("172.16.0.0", "255.0.255.0", "192.168.0.3", 1);
+        uint8_t mask[16] = {0xff, 0xff, 0, 0xff};
+        staticRouting6->AddNetworkRouteTo("2001::", Ipv6Prefix(mask), "2001:db8::3", 1);
+    }
+
+    std::cout << "Running bench-routing with " << nRoutes << " routes per table" << std::endl;
+    RunBench<Ipv4StaticRouting, Ipv4Header>(staticRouting, destinations, lookups, "Ipv4Static");
+    RunBench<Ipv4GlobalRouting, Ipv4Header>(globalRouting, destinations, lookups, "Ipv4Global");
+    RunBench<Ipv6StaticRouting, Ipv6Header>(staticRouting6, destinations6, lookups, "Ipv6Static");
+
+    Simulator::Destroy();
+    return 0;
+}
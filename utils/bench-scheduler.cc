@@ -449,6 +449,7 @@ main(int argc, char* argv[])
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
+    bool schedQuad = false;
 
     uint64_t pop = 100000;
     uint64_t total = 1000000;
@@ -474,6 +475,7 @@ main(int argc, char* argv[])
     cmd.AddValue("list", "use ListScheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
+    cmd.AddValue("quad", "use QuaternaryHeapScheduler", schedQuad);
     cmd.AddValue("debug", "enable debugging output", g_debug);
     cmd.AddValue("pop", "event population size", pop);
     cmd.AddValue("total", "total number of events to run", total);
@@ -494,10 +496,10 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedList = schedMap = schedPQ = schedQuad = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ || schedQuad))
     {
         schedMap = true;
     }
@@ -542,6 +544,11 @@ main(int argc, char* argv[])
         factory.SetTypeId("ns3::PriorityQueueScheduler");
         BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
     }
+    if (schedQuad)
+    {
+        factory.SetTypeId("ns3::QuaternaryHeapScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
 
     return 0;
 }
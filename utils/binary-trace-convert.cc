@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+// This program converts a binary trace file, written by the EnableBinary*
+// functions of the device helpers, to CSV (or TSV).
+// Sample usage:  ./ns3 run 'binary-trace-convert --input=trace.nsbt --output=trace.csv'
+
+#include "ns3/binary-trace.h"
+#include "ns3/command-line.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+    std::string format = "csv";
+    bool kindNames = true;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Convert a binary trace file to CSV");
+    cmd.AddValue("input", "the binary trace file", input);
+    cmd.AddValue("output", "the converted file (default: the standard output)", output);
+    cmd.AddValue("format", "the format of the converted file: csv or tsv", format);
+    cmd.AddValue("kind-names", "write the names of the kinds of events, not their ids", kindNames);
+    cmd.Parse(argc, argv);
+
+    if (format != "csv" && format != "tsv")
+    {
+        std::cerr << "Unknown format " << format << std::endl;
+        return 1;
+    }
+    const char separator = (format == "csv") ? ',' : '\t';
+
+    BinaryTraceReader reader(input);
+    if (reader.Fail())
+    {
+        std::cerr << "Unable to read the binary trace file " << input << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!output.empty())
+    {
+        file.open(output);
+        if (!file)
+        {
+            std::cerr << "Unable to create " << output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& os = output.empty() ? std::cout : file;
+
+    const auto& columns = reader.GetColumnNames();
+    for (std::size_t i = 0; i < columns.size(); i++)
+    {
+        os << (i ? std::string(1, separator) : "") << columns[i];
+    }
+    os << '\n';
+
+    // Convert block by block, the records of a block being stored column by column
+    BinaryTraceBlock block;
+    while (reader.ReadBlock(block))
+    {
+        for (std::size_t i = 0; i < block.GetSize(); i++)
+        {
+            os << block.times[i] << separator << block.nodes[i] << separator << block.devices[i]
+               << separator;
+            if (kindNames)
+            {
+                os << reader.GetKindName(block.kinds[i]);
+            }
+            else
+            {
+                os << +block.kinds[i];
+            }
+            os << separator << block.uids[i] << separator << block.sizes[i] << '\n';
+        }
+    }
+
+    if (reader.Fail())
+    {
+        std::cerr << "The binary trace file " << input << " is corrupted" << std::endl;
+        return 1;
+    }
+    return os ? 0 : 1;
+}